@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+import pgenlib
+import numpy as np
+import random
+import sys
+
+def check_equal(actual, expected, desc):
+    if not np.array_equal(actual, expected):
+        print("Batch decode mismatch: " + desc + ".")
+        sys.exit(1)
+
+def main():
+    arg_ct = len(sys.argv)
+    if arg_ct < 2:
+        print("Usage: python3 batch_decode_test.py <.pgen> [thread ct]")
+        print("* Compares the batched read_range()/read_list()/read_dosages_range()/")
+        print("  read_dosages_list() results against one-variant-at-a-time read() and")
+        print("  read_dosages() calls, with and without a sample subset, using 1 and")
+        print("  [thread ct] (default 3) decoder threads.")
+        return
+    thread_ct = 3
+    if arg_ct > 2:
+        thread_ct = int(sys.argv[2])
+    rng = random.Random(1)
+    with pgenlib.PgenReader(bytes(sys.argv[1], 'utf8')) as pf:
+        raw_sample_ct = pf.get_raw_sample_ct()
+        variant_ct = pf.get_variant_ct()
+        subset = np.array(sorted(rng.sample(range(raw_sample_ct), (raw_sample_ct + 2) // 3)), np.uint32)
+        variant_idxs = np.array([rng.randrange(variant_ct) for _ in range(variant_ct // 2)], np.uint32)
+        range_start = variant_ct // 7
+        range_end = variant_ct - variant_ct // 5
+        for sample_subset in (None, subset):
+            pf.change_sample_subset(sample_subset)
+            sample_ct = raw_sample_ct if sample_subset is None else sample_subset.size
+            for allele_idx in (1, 0):
+                expected_geno = np.empty((variant_ct, sample_ct), np.int8)
+                expected_dosage = np.empty((variant_ct, sample_ct), np.float32)
+                for variant_idx in range(variant_ct):
+                    pf.read(variant_idx, expected_geno[variant_idx], allele_idx)
+                    pf.read_dosages(variant_idx, expected_dosage[variant_idx], allele_idx)
+                for cur_thread_ct in (1, thread_ct):
+                    pf.set_thread_ct(cur_thread_ct)
+                    desc_suffix = " (allele_idx=" + str(allele_idx) + ", " + str(sample_ct) + " samples, " + str(cur_thread_ct) + " thread(s))"
+                    geno_buf = np.empty((range_end - range_start, sample_ct), np.int8)
+                    pf.read_range(range_start, range_end, geno_buf, allele_idx)
+                    check_equal(geno_buf, expected_geno[range_start:range_end], "read_range()" + desc_suffix)
+                    geno_buf = np.empty((variant_idxs.size, sample_ct), np.int8)
+                    pf.read_list(variant_idxs, geno_buf, allele_idx)
+                    check_equal(geno_buf, expected_geno[variant_idxs], "read_list()" + desc_suffix)
+                    dosage_buf = np.empty((range_end - range_start, sample_ct), np.float32)
+                    pf.read_dosages_range(range_start, range_end, dosage_buf, allele_idx)
+                    check_equal(dosage_buf, expected_dosage[range_start:range_end], "read_dosages_range()" + desc_suffix)
+                    dosage_buf = np.empty((variant_idxs.size, sample_ct), np.float32)
+                    pf.read_dosages_list(variant_idxs, dosage_buf, allele_idx)
+                    check_equal(dosage_buf, expected_dosage[variant_idxs], "read_dosages_list()" + desc_suffix)
+    print("All batched reads match.")
+
+if __name__ == "__main__":
+    main()
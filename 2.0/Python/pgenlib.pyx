@@ -57,6 +57,15 @@ cdef extern from "../pgenlib_ffi_support.h" namespace "plink2":
     void FloatsToDosage16(const float* floatarr, uint32_t sample_ct, uint32_t hard_call_halfdist, uintptr_t* genoarr, uintptr_t* dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr)
     void DoublesToDosage16(const double* doublearr, uint32_t sample_ct, uint32_t hard_call_halfdist, uintptr_t* genoarr, uintptr_t* dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr)
 
+    cdef struct PgenBatchReaderStruct:
+        pass
+
+    ctypedef enum PgenBatchType:
+        kPgbHardcallInt8
+        kPgbHardcallInt32
+        kPgbDosageFloat
+        kPgbDosageDouble
+
     cdef enum:
         k1LU
     cdef enum:
@@ -150,6 +159,28 @@ cdef extern from "../include/pgenlib_read.h" namespace "plink2":
     BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp)
     BoolErr CleanupPgr(PgenReaderStruct* pgr_ptr, PglErr* reterrp)
 
+    cdef struct PgenSmajReaderStruct:
+        uint32_t variant_ct
+        uint32_t sample_ct
+
+    void PreinitPgsm(PgenSmajReaderStruct* psrp)
+
+    PglErr PgsmInit(const char* fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, PgenSmajReaderStruct* psrp, char* errstr_buf)
+
+    PglErr PgsmGet(uint32_t sample_idx, uint32_t variant_idx_start, uint32_t variant_idx_end, PgenSmajReaderStruct* psrp, uintptr_t* genovec)
+
+    BoolErr CleanupPgsm(PgenSmajReaderStruct* psrp, PglErr* reterrp)
+
+
+cdef extern from "../pgenlib_ffi_support.h" namespace "plink2":
+    void PreinitPgrBatch(PgenBatchReaderStruct* pbrp)
+
+    PglErr PgrBatchInit(const char* fname, uint32_t max_vrec_width, uintptr_t pgr_alloc_cacheline_ct, uint32_t thread_ct, PgenFileInfo* pgfip, PgenReaderStruct* main_pgrp, PgenBatchReaderStruct* pbrp)
+
+    PglErr PgrGetBatch(const uintptr_t* sample_include, PgrSampleSubsetIndexStruct pssi, uint32_t sample_ct, const uint32_t* variant_idxs, uint32_t variant_idx_start, uint32_t variant_ct, uint32_t allele_idx, PgenBatchType batch_type, const void* lookup_table, uintptr_t row_stride, PgenBatchReaderStruct* pbrp, void* result)
+
+    BoolErr CleanupPgrBatch(PgenBatchReaderStruct* pbrp, PglErr* reterrp)
+
 
 cdef extern from "../include/pgenlib_write.h" namespace "plink2":
     cdef cppclass PgenWriterCommon:
@@ -208,6 +239,11 @@ cdef class PgenReader:
     cdef uintptr_t* _multivar_smaj_geno_batch_buf
     cdef uintptr_t* _multivar_smaj_phaseinfo_batch_buf
     cdef uintptr_t* _multivar_smaj_phasepresent_batch_buf
+    # for read_*_range()/read_*_list() variant-major batch decode
+    cdef PgenBatchReaderStruct* _batch_ptr
+    cdef bytes _fname
+    cdef uint32_t _max_vrec_width
+    cdef uintptr_t _pgr_alloc_cacheline_ct
 
     cdef set_sample_subset_internal(self, np.ndarray[np.uint32_t,mode="c",ndim=1] sample_subset):
         cdef uint32_t raw_sample_ct = self._info_ptr[0].raw_sample_ct
@@ -345,6 +381,17 @@ cdef class PgenReader:
         pgr_alloc_iter = &(pgr_alloc_iter[kPglNypTransposeBatch * kPglNypTransposeBatch // 8])
         self._multivar_smaj_phasepresent_batch_buf = <uintptr_t*>pgr_alloc_iter
         # pgr_alloc_iter = &(pgr_alloc_iter[kPglNypTransposeBatch * kPglNypTransposeBatch // 8])
+
+        self._fname = filename
+        self._max_vrec_width = max_vrec_width
+        self._pgr_alloc_cacheline_ct = pgr_alloc_cacheline_ct
+        self._batch_ptr = <PgenBatchReaderStruct*>PyMem_Malloc(sizeof(PgenBatchReaderStruct))
+        if not self._batch_ptr:
+            raise MemoryError()
+        PreinitPgrBatch(self._batch_ptr)
+        reterr = PgrBatchInit(fname, max_vrec_width, pgr_alloc_cacheline_ct, 1, self._info_ptr, self._state_ptr, self._batch_ptr)
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("PgrBatchInit() error " + str(reterr))
         return
 
 
@@ -364,6 +411,19 @@ cdef class PgenReader:
         return ((self._info_ptr[0].gflags & kfPgenGlobalHardcallPhasePresent) != 0)
 
 
+    cpdef set_thread_ct(self, uint32_t thread_ct):
+        if not self._batch_ptr:
+            raise RuntimeError("set_thread_ct() called on closed PgenReader")
+        cdef PglErr reterr = kPglRetSuccess
+        CleanupPgrBatch(self._batch_ptr, &reterr)
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("set_thread_ct() error " + str(reterr))
+        reterr = PgrBatchInit(<const char*>self._fname, self._max_vrec_width, self._pgr_alloc_cacheline_ct, thread_ct, self._info_ptr, self._state_ptr, self._batch_ptr)
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("set_thread_ct() error " + str(reterr))
+        return
+
+
     cpdef read(self, uint32_t variant_idx, np.ndarray geno_int_out, uint32_t allele_idx = 1):
         if variant_idx >= self._info_ptr[0].raw_variant_ct:
             # could have an unsafe mode which doesn't perform this check, but
@@ -463,12 +523,11 @@ cdef class PgenReader:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
             if geno_int8_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_range() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_idx in range(variant_idx_start, variant_idx_end):
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int8_out[(variant_idx - variant_idx_start), 0])
-                GenoarrToBytesMinus9(genovec, subset_size, data_ptr)
+            if variant_idx_ct == 0:
+                return
+            reterr = PgrGetBatch(subset_include_vec, subset_index, subset_size, NULL, variant_idx_start, variant_idx_ct, allele_idx, kPgbHardcallInt8, NULL, geno_int8_out.shape[1], self._batch_ptr, &(geno_int8_out[0, 0]))
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_range() error " + str(reterr))
             return
         if variant_idx_start >= variant_idx_end:
             raise RuntimeError("read_range() variant_idx_start >= variant_idx_end (" + str(variant_idx_start) + ", " + str(variant_idx_end) + ")")
@@ -663,6 +722,15 @@ cdef class PgenReader:
         return
 
 
+    cdef np.ndarray[np.uint32_t,mode="c",ndim=1] check_variant_idxs(self, np.ndarray[np.uint32_t] variant_idxs):
+        cdef np.ndarray[np.uint32_t,mode="c",ndim=1] variant_idxs_c = np.ascontiguousarray(variant_idxs, dtype=np.uint32)
+        cdef uint32_t raw_variant_ct = self._info_ptr[0].raw_variant_ct
+        cdef uint32_t max_variant_idx = variant_idxs_c.max()
+        if max_variant_idx >= raw_variant_ct:
+            raise RuntimeError("read_list() variant index too large (" + str(max_variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
+        return variant_idxs_c
+
+
     cdef read_list_internal8(self, np.ndarray[np.uint32_t] variant_idxs, np.ndarray[np.int8_t,mode="c",ndim=2] geno_int8_out, uint32_t allele_idx = 1, bint sample_maj = 0):
         cdef uint32_t raw_variant_ct = self._info_ptr[0].raw_variant_ct
         cdef const uintptr_t* subset_include_vec = self._subset_include_vec
@@ -675,20 +743,18 @@ cdef class PgenReader:
         cdef uint32_t variant_list_idx
         cdef uint32_t variant_idx
         cdef PglErr reterr
+        cdef np.ndarray[np.uint32_t,mode="c",ndim=1] variant_idxs_c
         if sample_maj == 0:
             if geno_int8_out.shape[0] < variant_idx_ct:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
             if geno_int8_out.shape[1] < subset_size:
                 raise RuntimeError("Variant-major read_list() geno_int_out buffer has too few columns (" + str(geno_int8_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
-            for variant_list_idx in range(variant_idx_ct):
-                variant_idx = variant_idxs[variant_list_idx]
-                if variant_idx >= raw_variant_ct:
-                    raise RuntimeError("read_list() variant index too large (" + str(variant_idx) + "; only " + str(raw_variant_ct) + " in file)")
-                reterr = PgrGet1(subset_include_vec, subset_index, subset_size, variant_idx, allele_idx, pgrp, genovec)
-                if reterr != kPglRetSuccess:
-                    raise RuntimeError("read_range() error " + str(reterr))
-                data_ptr = &(geno_int8_out[variant_list_idx, 0])
-                GenoarrToBytesMinus9(genovec, subset_size, data_ptr)
+            if variant_idx_ct == 0:
+                return
+            variant_idxs_c = self.check_variant_idxs(variant_idxs)
+            reterr = PgrGetBatch(subset_include_vec, subset_index, subset_size, &(variant_idxs_c[0]), 0, variant_idx_ct, allele_idx, kPgbHardcallInt8, NULL, geno_int8_out.shape[1], self._batch_ptr, &(geno_int8_out[0, 0]))
+            if reterr != kPglRetSuccess:
+                raise RuntimeError("read_list() error " + str(reterr))
             return
         if geno_int8_out.shape[0] < subset_size:
             raise RuntimeError("Sample-major read_list() geno_int_out buffer has too few rows (" + str(geno_int8_out.shape[0]) + "; current sample subset has size " + str(subset_size) + ")")
@@ -891,6 +957,40 @@ cdef class PgenReader:
         return
 
 
+    cpdef read_dosages_range(self, uint32_t variant_idx_start, uint32_t variant_idx_end, np.ndarray[np.float32_t,mode="c",ndim=2] floatarr_out, uint32_t allele_idx = 1):
+        cdef uint32_t raw_variant_ct = self._info_ptr[0].raw_variant_ct
+        if variant_idx_end > raw_variant_ct:
+            raise RuntimeError("read_dosages_range() variant_idx_end too large (" + str(variant_idx_end) + "; only " + str(raw_variant_ct) + " in file)")
+        if variant_idx_start >= variant_idx_end:
+            return
+        cdef uint32_t variant_idx_ct = variant_idx_end - variant_idx_start
+        cdef uint32_t subset_size = self._subset_size
+        if floatarr_out.shape[0] < variant_idx_ct:
+            raise RuntimeError("read_dosages_range() floatarr_out buffer has too few rows (" + str(floatarr_out.shape[0]) + "; (variant_idx_end - variant_idx_start) is " + str(variant_idx_ct) + ")")
+        if floatarr_out.shape[1] < subset_size:
+            raise RuntimeError("read_dosages_range() floatarr_out buffer has too few columns (" + str(floatarr_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
+        cdef PglErr reterr = PgrGetBatch(self._subset_include_vec, self._subset_index, subset_size, NULL, variant_idx_start, variant_idx_ct, allele_idx, kPgbDosageFloat, NULL, floatarr_out.shape[1], self._batch_ptr, &(floatarr_out[0, 0]))
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("read_dosages_range() error " + str(reterr))
+        return
+
+
+    cpdef read_dosages_list(self, np.ndarray[np.uint32_t] variant_idxs, np.ndarray[np.float32_t,mode="c",ndim=2] floatarr_out, uint32_t allele_idx = 1):
+        cdef uint32_t variant_idx_ct = <uint32_t>variant_idxs.shape[0]
+        if variant_idx_ct == 0:
+            return
+        cdef uint32_t subset_size = self._subset_size
+        if floatarr_out.shape[0] < variant_idx_ct:
+            raise RuntimeError("read_dosages_list() floatarr_out buffer has too few rows (" + str(floatarr_out.shape[0]) + "; variant_idxs length is " + str(variant_idx_ct) + ")")
+        if floatarr_out.shape[1] < subset_size:
+            raise RuntimeError("read_dosages_list() floatarr_out buffer has too few columns (" + str(floatarr_out.shape[1]) + "; current sample subset has size " + str(subset_size) + ")")
+        cdef np.ndarray[np.uint32_t,mode="c",ndim=1] variant_idxs_c = self.check_variant_idxs(variant_idxs)
+        cdef PglErr reterr = PgrGetBatch(self._subset_include_vec, self._subset_index, subset_size, &(variant_idxs_c[0]), 0, variant_idx_ct, allele_idx, kPgbDosageFloat, NULL, floatarr_out.shape[1], self._batch_ptr, &(floatarr_out[0, 0]))
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("read_dosages_list() error " + str(reterr))
+        return
+
+
     cpdef read_alleles_range(self, uint32_t variant_idx_start, uint32_t variant_idx_end, np.ndarray[np.int32_t,mode="c",ndim=2] allele_int32_out, bint hap_maj = 0):
         # if hap_maj == False, allele_int32_out must have at least
         #   variant_idx_ct rows, 2 * sample_ct columns
@@ -1126,6 +1226,10 @@ cdef class PgenReader:
 
     cpdef close(self):
         cdef PglErr reterr = kPglRetSuccess
+        if self._batch_ptr:
+            CleanupPgrBatch(self._batch_ptr, &reterr)
+            PyMem_Free(self._batch_ptr)
+            self._batch_ptr = NULL
         if self._info_ptr:
             CleanupPgfi(self._info_ptr, &reterr)
             if self._info_ptr[0].vrtypes:
@@ -1150,6 +1254,9 @@ cdef class PgenReader:
 
     def __dealloc__(self):
         cdef PglErr reterr = kPglRetSuccess
+        if self._batch_ptr:
+            CleanupPgrBatch(self._batch_ptr, &reterr)
+            PyMem_Free(self._batch_ptr)
         if self._info_ptr:
             CleanupPgfi(self._info_ptr, &reterr)
             if self._info_ptr[0].vrtypes:
@@ -1164,6 +1271,106 @@ cdef class PgenReader:
 
 
 
+cdef class PgenSmajReader:
+    cdef PgenSmajReaderStruct* _state_ptr
+    cdef uintptr_t* _genovec
+
+    def __cinit__(self, bytes filename, object variant_ct = None,
+                  object raw_sample_ct = None):
+        self._state_ptr = <PgenSmajReaderStruct*>PyMem_Malloc(sizeof(PgenSmajReaderStruct))
+        if not self._state_ptr:
+            raise MemoryError()
+        PreinitPgsm(self._state_ptr)
+        self._genovec = NULL
+        cdef uint32_t cur_variant_ct = 0xffffffffU
+        if variant_ct is not None:
+            cur_variant_ct = variant_ct
+        cdef uint32_t cur_sample_ct = 0xffffffffU
+        if raw_sample_ct is not None:
+            cur_sample_ct = raw_sample_ct
+        cdef char errstr_buf[kPglErrstrBufBlen]
+        if PgsmInit(<const char*>filename, cur_variant_ct, cur_sample_ct, self._state_ptr, errstr_buf) != kPglRetSuccess:
+            raise RuntimeError(errstr_buf[7:])
+        # PgsmGet() loads up to 3 extra leading entries
+        if cachealigned_malloc(DivUp(self._state_ptr[0].variant_ct + 3, kNypsPerVec) * kBytesPerVec, &(self._genovec)):
+            raise MemoryError()
+        return
+
+
+    cpdef __enter__(self):
+        return self
+
+
+    cpdef get_raw_sample_ct(self):
+        return self._state_ptr[0].sample_ct
+
+
+    cpdef get_variant_ct(self):
+        return self._state_ptr[0].variant_ct
+
+
+    cpdef read(self, uint32_t sample_idx, uint32_t variant_idx_start, uint32_t variant_idx_end, np.ndarray geno_int_out):
+        if not self._genovec:
+            raise RuntimeError("read() called on closed PgenSmajReader")
+        if sample_idx >= self._state_ptr[0].sample_ct:
+            raise RuntimeError("read() sample_idx too large (" + str(sample_idx) + "; only " + str(self._state_ptr[0].sample_ct) + " in file)")
+        if (variant_idx_start >= variant_idx_end) or (variant_idx_end > self._state_ptr[0].variant_ct):
+            raise RuntimeError("read() variant range invalid (" + str(variant_idx_start) + ".." + str(variant_idx_end) + "; " + str(self._state_ptr[0].variant_ct) + " variants in file)")
+        if not geno_int_out.flags["C_CONTIGUOUS"]:
+            raise RuntimeError("read() requires geno_int_out to be C-contiguous.")
+        cdef uint32_t variant_ct = variant_idx_end - variant_idx_start
+        if geno_int_out.shape[0] < variant_ct:
+            raise RuntimeError("read() geno_int_out too small (" + str(geno_int_out.shape[0]) + " entries; " + str(variant_ct) + " required)")
+        cdef PglErr reterr = PgsmGet(sample_idx, variant_idx_start, variant_idx_end, self._state_ptr, self._genovec)
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("read() error " + str(reterr))
+        cdef int8_t* data8_ptr
+        cdef int32_t* data32_ptr
+        cdef int64_t* data64_ptr
+        if geno_int_out.dtype == np.int8:
+            data8_ptr = <int8_t*>geno_int_out.data
+            GenoarrToBytesMinus9(self._genovec, variant_ct, data8_ptr)
+        elif geno_int_out.dtype == np.int32:
+            data32_ptr = <int32_t*>geno_int_out.data
+            GenoarrToInt32sMinus9(self._genovec, variant_ct, data32_ptr)
+        elif geno_int_out.dtype == np.int64:
+            data64_ptr = <int64_t*>geno_int_out.data
+            GenoarrToInt64sMinus9(self._genovec, variant_ct, data64_ptr)
+        else:
+            raise RuntimeError("Invalid read() geno_int_out array element type (int8, int32, or int64 expected).")
+        return
+
+
+    cpdef close(self):
+        cdef PglErr reterr = kPglRetSuccess
+        if self._state_ptr:
+            CleanupPgsm(self._state_ptr, &reterr)
+            PyMem_Free(self._state_ptr)
+            self._state_ptr = NULL
+        if self._genovec:
+            aligned_free(self._genovec)
+            self._genovec = NULL
+        if reterr != kPglRetSuccess:
+            raise RuntimeError("close() error " + str(reterr))
+        return
+
+
+    cpdef __exit__(self, exc_type, exc_val, exc_tb):
+        self.close()
+        return
+
+
+    def __dealloc__(self):
+        cdef PglErr reterr = kPglRetSuccess
+        if self._state_ptr:
+            CleanupPgsm(self._state_ptr, &reterr)
+            PyMem_Free(self._state_ptr)
+        if self._genovec:
+            aligned_free(self._genovec)
+        return
+
+
+
 cdef bytes_to_bits_internal(np.ndarray[np.uint8_t,mode="c",cast=True] boolbytes, uint32_t sample_ct, uintptr_t* bitarr):
     BytesToBitsUnsafe(boolbytes, sample_ct, bitarr)
 
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+import pgenlib
+import numpy as np
+import random
+import sys
+
+def main():
+    arg_ct = len(sys.argv)
+    if arg_ct < 2:
+        print("Usage: python3 smaj_round_trip_test.py <.pgen> [range ct]")
+        print("* <.pgen>.smaj must exist (see \"plink2 --make-pgen smaj\").")
+        print("* Compares PgenSmajReader.read() against PgenReader.read_range() for every")
+        print("  sample over the full variant range, and over [range ct] (default 200)")
+        print("  random subranges.")
+        return
+    range_ct = 200
+    if arg_ct > 2:
+        range_ct = int(sys.argv[2])
+    pgen_fname = bytes(sys.argv[1], 'utf8')
+    rng = random.Random(1)
+    with pgenlib.PgenReader(pgen_fname) as pf, pgenlib.PgenSmajReader(pgen_fname + b'.smaj', pf.get_variant_ct(), pf.get_raw_sample_ct()) as sf:
+        sample_ct = pf.get_raw_sample_ct()
+        variant_ct = pf.get_variant_ct()
+        expected = np.empty((sample_ct, variant_ct), np.int8)
+        pf.read_range(0, variant_ct, expected, sample_maj = True)
+        buf = np.empty(variant_ct, np.int8)
+        for sample_idx in range(sample_ct):
+            sf.read(sample_idx, 0, variant_ct, buf)
+            if not np.array_equal(buf, expected[sample_idx]):
+                print("Mismatch for sample " + str(sample_idx) + " over the full variant range.")
+                sys.exit(1)
+        buf32 = np.empty(variant_ct, np.int32)
+        for _ in range(range_ct):
+            sample_idx = rng.randrange(sample_ct)
+            variant_idx_start = rng.randrange(variant_ct)
+            variant_idx_end = rng.randrange(variant_idx_start + 1, variant_ct + 1)
+            cur_ct = variant_idx_end - variant_idx_start
+            sf.read(sample_idx, variant_idx_start, variant_idx_end, buf32)
+            if not np.array_equal(buf32[:cur_ct], expected[sample_idx, variant_idx_start:variant_idx_end]):
+                print("Mismatch for sample " + str(sample_idx) + ", variants [" + str(variant_idx_start) + ", " + str(variant_idx_end) + ").")
+                sys.exit(1)
+    print("All .pgen.smaj reads match.")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+This simulates a hardcall VCF for the dense-dosage loader tests.  Most
+variants are rare, so they're stored as difflists in .pgen files, and about
+a third are near-duplicates of the previous variant, so they get
+LD-compressed.  About 1% of genotypes are missing.
+"""
+
+import argparse
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=300,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=4000,
+                        help="Number of variants.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        prev_alleles = None
+        for vidx in range(cmd_args.variants):
+            if prev_alleles and (rng.random() < 0.3):
+                alleles = [(a1 ^ (rng.random() < 0.01), a2 ^ (rng.random() < 0.01)) for a1, a2 in prev_alleles]
+            else:
+                freq = rng.uniform(0.005, 0.05) if rng.random() < 0.6 else rng.uniform(0.05, 0.5)
+                alleles = [(int(rng.random() < freq), int(rng.random() < freq)) for _ in range(sample_ct)]
+            prev_alleles = alleles
+            gts = ['./.' if rng.random() < 0.01 else '{}/{}'.format(a1, a2) for a1, a2 in alleles]
+            vcf_file.write('1\t{}\tv{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(1000 + 10 * vidx, vidx, '\t'.join(gts)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""
+This recomputes a variance-standardized relationship matrix from an
+"--export A" dosage table and the matching .afreq file, and checks it against
+a "--make-rel bin square" result.  Missing dosages aren't supported.
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-r', '--raw', type=str, required=True,
+                             help="--export A output.")
+    requiredarg.add_argument('-f', '--freq', type=str, required=True,
+                             help=".afreq file.")
+    requiredarg.add_argument('-b', '--relbin', type=str, required=True,
+                             help="--make-rel bin square output.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-4,
+                        help="Absolute tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    with open(cmd_args.freq, 'r') as freq_file:
+        header = freq_file.readline().rstrip('\n').split('\t')
+        ref_col = header.index('REF')
+        freq_col = header.index('ALT_FREQS')
+        variants = [line.rstrip('\n').split('\t') for line in freq_file]
+    with open(cmd_args.raw, 'r') as raw_file:
+        counted_alleles = [col_name.rsplit('_', 1)[1] for col_name in raw_file.readline().rstrip('\n').split('\t')[6:]]
+        sample_rows = [[float(val) for val in line.rstrip('\n').split('\t')[6:]] for line in raw_file]
+    sample_ct = len(sample_rows)
+    variant_ct = len(variants)
+    normed_cols = []
+    for variant_idx, (variant, counted_allele) in enumerate(zip(variants, counted_alleles)):
+        alt_freq = float(variant[freq_col])
+        inv_stdev = 1.0 / math.sqrt(2 * alt_freq * (1.0 - alt_freq))
+        alt_dosages = [row[variant_idx] for row in sample_rows]
+        if counted_allele == variant[ref_col]:
+            alt_dosages = [2.0 - dosage for dosage in alt_dosages]
+        normed_cols.append([(dosage - 2 * alt_freq) * inv_stdev for dosage in alt_dosages])
+    normed_rows = list(zip(*normed_cols))
+    rel = compare_util.read_doubles(cmd_args.relbin)
+    if len(rel) != sample_ct * sample_ct:
+        compare_util.fail('Unexpected .rel.bin size.')
+    for sample_idx1 in range(sample_ct):
+        row1 = normed_rows[sample_idx1]
+        for sample_idx2 in range(sample_idx1 + 1):
+            expected = sum(x * y for x, y in zip(row1, normed_rows[sample_idx2])) / variant_ct
+            if abs(rel[sample_idx1 * sample_ct + sample_idx2] - expected) > cmd_args.tolerance:
+                compare_util.fail('Relationship mismatch for samples ' + str(sample_idx1) + ' and ' + str(sample_idx2) + '.')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Rare and LD-compressed hardcalls: the difflist shortcuts in
+# PgrGetDenseDosageD() must give exactly the same results as the dense .bed
+# path.
+python3 make_vcf.py -o tmp_hc
+$1/plink2 $2 $3 --vcf tmp_hc.vcf --make-pgen --out tmp_hc
+$1/plink2 $2 $3 --vcf tmp_hc.vcf --make-bed --out tmp_hc_bed
+awk 'NR > 1 && NR % 3 != 0 {print $1}' tmp_hc.psam > tmp_hc.keep
+$1/plink2 $2 $3 --pfile tmp_hc --make-rel bin square --out tmp_hc_pgen
+$1/plink2 $2 $3 --bfile tmp_hc_bed --make-rel bin square --out tmp_hc_bed
+cmp tmp_hc_pgen.rel.bin tmp_hc_bed.rel.bin
+$1/plink2 $2 $3 --pfile tmp_hc --keep tmp_hc.keep --make-rel bin square --out tmp_hc_pgen_keep
+$1/plink2 $2 $3 --bfile tmp_hc_bed --keep tmp_hc.keep --make-rel bin square --out tmp_hc_bed_keep
+cmp tmp_hc_pgen_keep.rel.bin tmp_hc_bed_keep.rel.bin
+$1/plink2 $2 $3 --pfile tmp_hc --keep tmp_hc.keep --pca 5 --out tmp_hc_pgen_keep
+$1/plink2 $2 $3 --bfile tmp_hc_bed --keep tmp_hc.keep --pca 5 --out tmp_hc_bed_keep
+diff -q <(cut -f 2- tmp_hc_pgen_keep.eigenvec) <(cut -f 3- tmp_hc_bed_keep.eigenvec)
+
+# Dosages: compare against a direct computation.
+$1/plink2 $2 $3 --dummy 100 1000 0 dosage-freq=0.3 acgt --seed 7 --out tmp_ds
+$1/plink2 $2 $3 --pfile tmp_ds --freq --export A --out tmp_ds
+$1/plink2 $2 $3 --pfile tmp_ds --read-freq tmp_ds.afreq --make-rel bin square --out tmp_ds
+python3 rel_compare.py -r tmp_ds.raw -f tmp_ds.afreq -b tmp_ds.rel.bin
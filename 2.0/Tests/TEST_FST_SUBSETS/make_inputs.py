@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+This simulates a dataset for the --fst subset-counting tests: a VCF with an
+autosome and chrX (mostly rare variants, so many records are stored as
+difflists, plus runs of near-duplicate variants that get LD-compressed, and
+a few multiallelic variants), a .psam with sexes, and a population file with
+two categorical columns.  POP_MANY assigns samples round-robin to 65
+populations; POP_TWO keeps only populations P0 and P1 from POP_MANY, and is
+missing ('NONE') for everyone else.
+"""
+
+import argparse
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=1300,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=3000,
+                        help="Number of variants per chromosome.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    males = [rng.random() < 0.5 for _ in range(sample_ct)]
+    pops = ['P{}'.format(i % 65) for i in range(sample_ct)]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for chrom in ('1', 'X'):
+            prev_alleles = None
+            for vidx in range(cmd_args.variants):
+                pos = 1000 + 10 * vidx
+                alt = 'C'
+                if prev_alleles and (rng.random() < 0.3):
+                    # near-duplicate of the previous variant
+                    alleles = [(a1 ^ (rng.random() < 0.01), a2 ^ (rng.random() < 0.01)) for a1, a2 in prev_alleles]
+                else:
+                    roll = rng.random()
+                    if roll < 0.5:
+                        freq = rng.uniform(0.001, 0.02)
+                    else:
+                        freq = rng.uniform(0.02, 0.5)
+                    alleles = [(int(rng.random() < freq), int(rng.random() < freq)) for _ in range(sample_ct)]
+                    if rng.random() < 0.02:
+                        alt = 'C,G'
+                        alleles = [(a1 * rng.choice((1, 2)), a2 * rng.choice((1, 2))) for a1, a2 in alleles]
+                prev_alleles = None if alt != 'C' else alleles
+                gts = []
+                for sample_idx, (a1, a2) in enumerate(alleles):
+                    if rng.random() < 0.01:
+                        gts.append('.' if (chrom == 'X') and males[sample_idx] else './.')
+                    elif (chrom == 'X') and males[sample_idx]:
+                        gts.append(str(a1))
+                    else:
+                        gts.append('{}/{}'.format(a1, a2))
+                variant_id = '{}:{}'.format(chrom, pos)
+                vcf_file.write('{}\t{}\t{}\tA\t{}\t.\tPASS\t.\tGT\t{}\n'.format(chrom, pos, variant_id, alt, '\t'.join(gts)))
+    with open(cmd_args.out + '.sex', 'w') as sex_file:
+        sex_file.write('#IID\tSEX\n')
+        for iid, is_male in zip(iids, males):
+            sex_file.write('{}\t{}\n'.format(iid, 1 if is_male else 2))
+    with open(cmd_args.out + '.pop', 'w') as pop_file:
+        pop_file.write('#IID\tPOP_MANY\tPOP_TWO\n')
+        for iid, pop in zip(iids, pops):
+            pop_file.write('{}\t{}\t{}\n'.format(iid, pop, pop if pop in ('P0', 'P1') else 'NONE'))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+set -exo pipefail
+
+python3 make_inputs.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --update-sex tmp_data.sex --make-pgen --out tmp_data
+
+# With two populations, biallelic variants are counted with
+# PgrGetCountsMulti(); with 65 populations (more than 64 subsets), they go
+# through the per-sample scatter.  The P0/P1 estimates must be identical.
+for m in hudson wc
+do
+    $1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pop --fst POP_TWO method=$m report-variants --out tmp_two_$m
+    $1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pop --fst POP_MANY method=$m report-variants base=P0 --out tmp_many_$m
+    diff -q tmp_two_$m.P0.P1.fst.var tmp_many_$m.P0.P1.fst.var
+done
+# chrX (hudson only): nonmales and males are separate subsets.
+diff -q tmp_two_hudson.x.P0.P1.fst.var tmp_many_hudson.x.P0.P1.fst.var
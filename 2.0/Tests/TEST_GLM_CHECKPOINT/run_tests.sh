@@ -0,0 +1,48 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# 3000 variants split evenly across chromosomes 1, 2, and X, and samples of
+# both sexes, so a resumed run that misplaces chromosome boundaries produces
+# different chrX results.
+$1/plink2 $2 $3 --dummy 500 3000 0.02 acgt scalar-pheno --seed 7 --out tmp_dummy
+awk 'BEGIN {OFS = "\t"; split("1 2 X", chrs, " ")} /^#/ {print; next} {$1 = chrs[1 + int(vidx / 1000)]; ++vidx; print}' tmp_dummy.pvar > tmp_data.pvar
+awk 'BEGIN {OFS = "\t"} /^#/ {print; next} {$2 = 1 + (NR % 2); print}' tmp_dummy.psam > tmp_data.psam
+cp tmp_dummy.pgen tmp_data.pgen
+
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars checkpoint --out tmp_full
+cmp <(tail -n 1 tmp_full.PHENO1.glm.linear.ckpt) <(printf '3000\t500\t3000\t%s\n' $(wc -c < tmp_full.PHENO1.glm.linear))
+
+# Simulate runs interrupted partway through chromosomes 1 and 2: the journal
+# points at the end of variant k's line, and the output has a partially
+# written line after it.  Resuming must reproduce the uninterrupted output
+# byte-for-byte.
+for k in 700 1500
+do
+    head -n $((k + 1)) tmp_full.PHENO1.glm.linear > tmp_resume.PHENO1.glm.linear
+    offset=$(wc -c < tmp_resume.PHENO1.glm.linear)
+    sed -n $((k + 2))p tmp_full.PHENO1.glm.linear | head -c 20 >> tmp_resume.PHENO1.glm.linear
+    printf '#VARIANT_CT\tSAMPLE_CT\tDONE_CT\tBYTE_OFFSET\n3000\t500\t%s\t%s\n' $k $offset > tmp_resume.PHENO1.glm.linear.ckpt
+    $1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars resume --out tmp_resume
+    grep -q "$k/3000 variants already processed" tmp_resume.log
+    cmp tmp_full.PHENO1.glm.linear tmp_resume.PHENO1.glm.linear
+done
+
+# A completed file is left alone.
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars resume --out tmp_full
+grep -q "is already complete" tmp_full.log
+
+# With loco-ridge, a resumed run must reuse the cross-validation folds of the
+# original run, so --seed is required.
+if $1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars loco-ridge checkpoint --out tmp_loco_noseed; then
+    exit 1
+fi
+grep -q "requires --seed" tmp_loco_noseed.log
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars loco-ridge checkpoint --seed 3 --out tmp_loco_full
+k=1500
+head -n $((k + 1)) tmp_loco_full.PHENO1.glm.linear > tmp_loco_resume.PHENO1.glm.linear
+offset=$(wc -c < tmp_loco_resume.PHENO1.glm.linear)
+printf '#VARIANT_CT\tSAMPLE_CT\tDONE_CT\tBYTE_OFFSET\n3000\t500\t%s\t%s\n' $k $offset > tmp_loco_resume.PHENO1.glm.linear.ckpt
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars loco-ridge resume --seed 3 --out tmp_loco_resume
+grep -q "$k/3000 variants already processed" tmp_loco_resume.log
+cmp tmp_loco_full.PHENO1.glm.linear tmp_loco_resume.PHENO1.glm.linear
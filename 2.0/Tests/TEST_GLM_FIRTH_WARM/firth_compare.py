@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+This checks that two --glm Firth regression reports contain the same
+variants, and that their fits agree to within the given tolerance: the
+log-odds ratios must differ by at most tolerance * LOG(OR)_SE, LOG(OR)_SE
+values must agree to within that relative tolerance, and Z_STAT values to
+within that absolute tolerance.  (P is a function of Z_STAT, and isn't
+compared separately.)
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-a', '--first', type=str, required=True,
+                             help="First --glm report.")
+    requiredarg.add_argument('-b', '--second', type=str, required=True,
+                             help="Second --glm report.")
+    parser.add_argument('-t', '--tolerance', type=float, default=5e-3,
+                        help="Tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    tol = cmd_args.tolerance
+    header1, rows1 = compare_util.read_report(cmd_args.first, True)
+    header2, rows2 = compare_util.read_report(cmd_args.second, True)
+    if header1 != header2:
+        compare_util.fail('Header line mismatch.')
+    if (len(rows1) != len(rows2)) or (not rows1):
+        compare_util.fail('Row count mismatch.')
+    numeric_cols = ('OR', 'LOG(OR)_SE', 'Z_STAT', 'P')
+    for row1, row2 in zip(rows1, rows2):
+        variant_id = row1['ID']
+        for col in header1:
+            if (col not in numeric_cols) and (row1[col] != row2[col]):
+                compare_util.fail(col + ' mismatch for ' + variant_id + '.')
+        if row1['OR'] == 'NA':
+            if any(row2[col] != 'NA' for col in numeric_cols):
+                compare_util.fail('NA mismatch for ' + variant_id + '.')
+            continue
+        se1 = float(row1['LOG(OR)_SE'])
+        if not compare_util.rel_close(se1, float(row2['LOG(OR)_SE']), tol):
+            compare_util.fail('LOG(OR)_SE mismatch for ' + variant_id + ': ' + row1['LOG(OR)_SE'] + ' vs. ' + row2['LOG(OR)_SE'] + '.')
+        if not compare_util.rel_close(math.log(float(row1['OR'])), math.log(float(row2['OR'])), tol, se1):
+            compare_util.fail('OR mismatch for ' + variant_id + ': ' + row1['OR'] + ' vs. ' + row2['OR'] + '.')
+        if not compare_util.rel_close(float(row1['Z_STAT']), float(row2['Z_STAT']), tol, 1.0):
+            compare_util.fail('Z_STAT mismatch for ' + variant_id + ': ' + row1['Z_STAT'] + ' vs. ' + row2['Z_STAT'] + '.')
+
+if __name__ == '__main__':
+    main()
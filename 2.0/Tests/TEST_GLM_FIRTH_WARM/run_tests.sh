@@ -0,0 +1,18 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Case/control phenotype with two continuous covariates, so the covariate-only
+# model has a nontrivial fit to start from.
+$1/plink2 $2 $3 --dummy 800 2000 0.02 acgt --seed 5 --out tmp_data
+awk 'BEGIN {OFS = "\t"; srand(5)} /^#/ {print "#IID", "COV1", "COV2"; next} {print $1, rand(), 2 * rand()}' tmp_data.psam > tmp_data.cov
+
+# 'firth-warm-start' converges to the same optimum as the default cold start,
+# to within a small fraction of a standard error.
+$1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm firth hide-covar --out tmp_cold
+$1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm firth firth-warm-start hide-covar --out tmp_warm
+python3 firth_compare.py -a tmp_cold.PHENO1.glm.firth -b tmp_warm.PHENO1.glm.firth
+
+if $1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm no-firth firth-warm-start hide-covar --out tmp_bad; then
+    exit 1
+fi
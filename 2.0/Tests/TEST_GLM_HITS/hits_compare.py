@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""
+This checks --glm 'hits='/'hits-p='/'sumstats-bin' output against the main
+--glm results file it was derived from.  The .hits file must contain exactly
+the strongest valid primary-test rows (by p-value, ties broken by file order),
+and each .sumstats.bin record must match the corresponding valid primary-test
+row.
+"""
+
+import math
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-m', '--main', type=str, required=True,
+                             help="Main --glm output file.")
+    parser.add_argument('-s', '--hits', type=str,
+                        help=".hits file to validate.")
+    parser.add_argument('-n', '--count', type=int, default=0,
+                        help="hits= value.")
+    parser.add_argument('-p', '--pval', type=float, default=1.0,
+                        help="hits-p= value.")
+    parser.add_argument('-b', '--binary', type=str,
+                        help=".sumstats.bin file to validate.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    _, rows = compare_util.read_report(cmd_args.main, as_dicts=True)
+    rows = [row for row in rows if row['TEST'] == 'ADD' and row['P'] != 'NA']
+    if cmd_args.hits:
+        ranked = sorted(range(len(rows)), key=lambda idx: (float(rows[idx]['P']), idx))
+        expected = [rows[idx] for idx in ranked if float(rows[idx]['P']) <= cmd_args.pval]
+        if cmd_args.count:
+            expected = expected[:cmd_args.count]
+        _, actual = compare_util.read_report(cmd_args.hits, as_dicts=True)
+        if len(actual) != len(expected):
+            compare_util.fail('Hit count mismatch.')
+        for row1, row2 in zip(expected, actual):
+            if row1['ID'] != row2['ID'] or row1['A1'] != row2['A1'] or row1['OBS_CT'] != row2['OBS_CT']:
+                compare_util.fail('Hit variant mismatch.')
+            effect_col = 'BETA' if 'BETA' in row1 else 'OR'
+            if not (compare_util.rel_close(float(row1[effect_col]), float(row2[effect_col]), 1e-5) and compare_util.rel_close(float(row1['P']), float(row2['P']), 1e-5)):
+                compare_util.fail('Hit value mismatch.')
+    if cmd_args.binary:
+        with open(cmd_args.binary, 'rb') as bin_file:
+            data = bin_file.read()
+        if data[:8] != b'PLKGLMSS':
+            compare_util.fail('Bad .sumstats.bin magic.')
+        version, record_size = struct.unpack('=II', data[8:16])
+        if version != 1 or record_size != 32 or (len(data) - 16) != 32 * len(rows):
+            compare_util.fail('.sumstats.bin size mismatch.')
+        for idx, row in enumerate(rows):
+            _, bp, _, _, obs_ct, beta, _, neglog10_p, _ = struct.unpack('=IIHHIfffI', data[16 + 32 * idx:48 + 32 * idx])
+            if bp != int(row['POS']) or obs_ct != int(row['OBS_CT']):
+                compare_util.fail('.sumstats.bin record mismatch.')
+            expected_beta = float(row['BETA']) if 'BETA' in row else math.log(float(row['OR']))
+            if not (compare_util.rel_close(beta, expected_beta, 1e-5, max(abs(expected_beta), 1.0)) and abs(neglog10_p + math.log10(float(row['P']))) <= 1e-5):
+                compare_util.fail('.sumstats.bin value mismatch.')
+
+
+if __name__ == '__main__':
+    main()
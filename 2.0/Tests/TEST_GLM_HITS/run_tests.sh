@@ -0,0 +1,20 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 400 2000 0.02 scalar-pheno acgt --seed 2 --out tmp_data
+
+# hits= with sumstats-bin
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars hits=25 sumstats-bin --out tmp_glm
+python3 hits_compare.py -m tmp_glm.PHENO1.glm.linear -s tmp_glm.PHENO1.glm.linear.hits -n 25 -b tmp_glm.PHENO1.glm.linear.sumstats.bin
+
+# hits-p= alone, and combined with hits=
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars hits-p=0.01 --out tmp_glm_p
+python3 hits_compare.py -m tmp_glm_p.PHENO1.glm.linear -s tmp_glm_p.PHENO1.glm.linear.hits -p 0.01
+$1/plink2 $2 $3 --pfile tmp_data --glm allow-no-covars hits=5 hits-p=0.01 --out tmp_glm_np
+python3 hits_compare.py -m tmp_glm_np.PHENO1.glm.linear -s tmp_glm_np.PHENO1.glm.linear.hits -n 5 -p 0.01
+
+# binary phenotype
+$1/plink2 $2 $3 --dummy 400 2000 0.02 acgt --seed 3 --out tmp_data_cc
+$1/plink2 $2 $3 --pfile tmp_data_cc --glm allow-no-covars firth-fallback hits=25 sumstats-bin --out tmp_glm_cc
+python3 hits_compare.py -m tmp_glm_cc.PHENO1.glm.logistic.hybrid -s tmp_glm_cc.PHENO1.glm.logistic.hybrid.hits -n 25 -b tmp_glm_cc.PHENO1.glm.logistic.hybrid.sumstats.bin
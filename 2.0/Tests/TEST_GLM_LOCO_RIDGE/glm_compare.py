@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+This checks that two --glm linear reports contain the same variants, and that
+their BETA, SE, T_STAT, and P values agree to within the given relative
+tolerance.  (BETA is compared relative to max(|BETA|, SE), and T_STAT
+relative to max(|T_STAT|, 1), since near-zero values are dominated by input
+rounding error.)
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-a', '--first', type=str, required=True,
+                             help="First --glm report.")
+    requiredarg.add_argument('-b', '--second', type=str, required=True,
+                             help="Second --glm report.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-4,
+                        help="Relative tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    header1, rows1 = compare_util.read_report(cmd_args.first)
+    header2, rows2 = compare_util.read_report(cmd_args.second)
+    if header1 != header2:
+        compare_util.fail('Header line mismatch.')
+    if (len(rows1) != len(rows2)) or (not rows1):
+        compare_util.fail('Row count mismatch.')
+    beta_col = header1.index('BETA')
+    se_col = header1.index('SE')
+    t_col = header1.index('T_STAT')
+    p_col = header1.index('P')
+    id_col = header1.index('ID')
+    for row1, row2 in zip(rows1, rows2):
+        for col_idx, (val1, val2) in enumerate(zip(row1, row2)):
+            if col_idx in (beta_col, se_col, t_col, p_col):
+                scale = abs(float(val1))
+                if col_idx == beta_col:
+                    scale = max(scale, float(row1[se_col]))
+                elif col_idx == t_col:
+                    scale = max(scale, 1.0)
+                if not compare_util.rel_close(float(val1), float(val2), cmd_args.tolerance, scale):
+                    compare_util.fail(header1[col_idx] + ' mismatch for ' + row1[id_col] + ': ' + val1 + ' vs. ' + val2 + '.')
+            elif val1 != val2:
+                compare_util.fail(header1[col_idx] + ' mismatch for ' + row1[id_col] + '.')
+
+if __name__ == '__main__':
+    main()
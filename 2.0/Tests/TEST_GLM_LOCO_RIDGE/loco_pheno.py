@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""
+This subtracts each leave-one-chromosome-out offset in a --glm loco-ridge
+.glm.loco file from the original phenotype, and writes the results as one
+phenotype column per chromosome (named <pheno name>_<chrom>).
+"""
+
+import argparse
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-p', '--pheno', type=str, required=True,
+                             help="Phenotype file (#IID and one phenotype column).")
+    requiredarg.add_argument('-l', '--loco', type=str, required=True,
+                             help=".glm.loco file.")
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output phenotype file.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    with open(cmd_args.pheno, 'r') as pheno_file:
+        pheno_name = pheno_file.readline().rstrip('\n').split('\t')[1]
+        phenos = {}
+        for line in pheno_file:
+            iid, val = line.rstrip('\n').split('\t')
+            phenos[iid] = float(val)
+    with open(cmd_args.loco, 'r') as loco_file, open(cmd_args.out, 'w') as out_file:
+        chroms = loco_file.readline().rstrip('\n').split('\t')[1:]
+        out_file.write('#IID\t' + '\t'.join(pheno_name + '_' + chrom for chrom in chroms) + '\n')
+        for line in loco_file:
+            fields = line.rstrip('\n').split('\t')
+            pheno_val = phenos[fields[0]]
+            out_file.write(fields[0] + '\t' + '\t'.join(repr(pheno_val - float(offset)) for offset in fields[1:]) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""
+This simulates a small polygenic dataset for the --glm loco-ridge tests: a
+VCF with three autosomes, and a quantitative phenotype with one covariate.
+Causal variants are spread across all three chromosomes, so each
+leave-one-chromosome-out offset is nonzero.
+"""
+
+import argparse
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=400,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=1500,
+                        help="Number of variants per chromosome.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    cov1 = [rng.gauss(0.0, 1.0) for _ in range(sample_ct)]
+    genetic = [0.0] * sample_ct
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for chrom in ('1', '2', '3'):
+            for vidx in range(cmd_args.variants):
+                pos = 1000 + 10 * vidx
+                freq = rng.uniform(0.05, 0.5)
+                effect = rng.gauss(0.0, 0.15) if rng.random() < 0.1 else 0.0
+                gts = []
+                for sample_idx in range(sample_ct):
+                    if rng.random() < 0.005:
+                        gts.append('./.')
+                        continue
+                    a1 = int(rng.random() < freq)
+                    a2 = int(rng.random() < freq)
+                    genetic[sample_idx] += effect * (a1 + a2)
+                    gts.append('{}/{}'.format(a1, a2))
+                variant_id = '{}:{}'.format(chrom, pos)
+                vcf_file.write('{}\t{}\t{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(chrom, pos, variant_id, '\t'.join(gts)))
+    with open(cmd_args.out + '.pheno', 'w') as pheno_file:
+        pheno_file.write('#IID\tQT\n')
+        for iid, val1, cur_genetic in zip(iids, cov1, genetic):
+            pheno_file.write('{}\t{:.6f}\n'.format(iid, cur_genetic + 0.5 * val1 + rng.gauss(0.0, 1.0)))
+    with open(cmd_args.out + '.cov', 'w') as cov_file:
+        cov_file.write('#IID\tCOV1\n')
+        for iid, val1 in zip(iids, cov1):
+            cov_file.write('{}\t{:.6f}\n'.format(iid, val1))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+set -exo pipefail
+
+python3 make_inputs.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+
+# --glm loco-ridge must match a plain --glm run on the phenotype minus the
+# written offset for each chromosome.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar loco-ridge --out tmp_loco
+python3 loco_pheno.py -p tmp_data.pheno -l tmp_loco.QT.glm.loco -o tmp_offset.pheno
+for c in 1 2 3
+do
+    $1/plink2 $2 $3 --pfile tmp_data --chr $c --pheno tmp_offset.pheno --covar tmp_data.cov --glm hide-covar --out tmp_offset
+    awk -v c=$c 'NR == 1 || $1 == c' tmp_loco.QT.glm.linear > tmp_loco_chr$c.glm.linear
+    python3 glm_compare.py -a tmp_loco_chr$c.glm.linear -b tmp_offset.QT_$c.glm.linear
+done
+
+# The offsets must actually change the results.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar --out tmp_plain
+if python3 glm_compare.py -a tmp_loco.QT.glm.linear -b tmp_plain.QT.glm.linear; then
+    exit 1
+fi
+
+# Cross-validation folds come from --seed: the same seed must reproduce the
+# offsets exactly, and a different one must change them.
+grep -q "Cross-validated lambda" tmp_loco.log
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar loco-ridge --seed 1 --out tmp_seed1a
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar loco-ridge --seed 1 --out tmp_seed1b
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar loco-ridge --seed 2 --out tmp_seed2
+cmp tmp_seed1a.QT.glm.loco tmp_seed1b.QT.glm.loco
+if cmp -s tmp_seed1a.QT.glm.loco tmp_seed2.QT.glm.loco; then
+    exit 1
+fi
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 500 3000 0.02 acgt --seed 12 --out tmp_data
+# Six case/control phenotypes: P1..P3 with no missing values, P4 and P5
+# sharing one missingness pattern, and P6 with its own.  P5 is rare enough
+# that some variants need the Firth fallback.
+awk 'BEGIN {srand(3); OFS = "\t"} NR == 1 {print "#IID", "COV1", "P1", "P2", "P3", "P4", "P5", "P6"} NR > 1 {m1 = (rand() < 0.1)? "NA" : ""; m2 = (rand() < 0.2)? "NA" : ""; print $1, rand(), 1 + (rand() < 0.5), 1 + (rand() < 0.3), 1 + (rand() < 0.5), (m1 == "")? 1 + (rand() < 0.4) : m1, (m1 == "")? 1 + (rand() < 0.01) : m1, (m2 == "")? 1 + (rand() < 0.5) : m2}' tmp_data.psam > tmp_data.phe
+
+# Every phenotype's results from the batched run must match a run on that
+# phenotype alone.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.phe --pheno-name P1-P6 --covar tmp_data.phe --covar-name COV1 --glm hide-covar firth-fallback --out tmp_batch
+grep -q "phenotype 'P1' and 2 others" tmp_batch.log
+grep -q "phenotype 'P4' and 1 other:" tmp_batch.log
+grep -q "phenotype 'P6': " tmp_batch.log
+for i in 1 2 3 4 5 6
+do
+    $1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.phe --pheno-name P$i --covar tmp_data.phe --covar-name COV1 --glm hide-covar firth-fallback --out tmp_single
+    cmp tmp_batch.P$i.glm.logistic.hybrid tmp_single.P$i.glm.logistic.hybrid
+done
+grep -q "Y" <(cut -f 7 tmp_batch.P5.glm.logistic.hybrid)
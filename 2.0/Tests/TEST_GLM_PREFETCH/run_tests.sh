@@ -0,0 +1,43 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Several 65536-variant read blocks, so the read-ahead ring wraps around.
+$1/plink2 $2 $3 --dummy 200 250000 0.02 scalar-pheno pheno-ct=3 dosage-freq=0.1 --seed 4 --out tmp_qt
+$1/plink2 $2 $3 --dummy 200 250000 0.02 pheno-ct=2 --seed 5 --out tmp_cc
+
+# --glm results must not depend on --pgen-prefetch.
+for p in 0 3 8
+do
+    $1/plink2 $2 $3 --pfile tmp_qt --glm allow-no-covars --pgen-prefetch $p --out tmp_qt_$p
+    $1/plink2 $2 $3 --pfile tmp_qt --covar tmp_qt.psam --covar-name PHENO3 --pheno-name PHENO1 --glm hide-covar --pgen-prefetch $p --out tmp_qtcov_$p
+    $1/plink2 $2 $3 --pfile tmp_cc --glm allow-no-covars firth-fallback --pgen-prefetch $p --out tmp_cc_$p
+done
+grep -q "Reading ahead with 8 block buffers" tmp_qt_8.log
+grep -q "Reading ahead with 8 block buffers" tmp_qtcov_8.log
+grep -q "Reading ahead with 8 block buffers" tmp_cc_8.log
+for p in 3 8
+do
+    for i in 1 2 3
+    do
+        diff -q tmp_qt_0.PHENO$i.glm.linear tmp_qt_$p.PHENO$i.glm.linear
+    done
+    diff -q tmp_qtcov_0.PHENO1.glm.linear tmp_qtcov_$p.PHENO1.glm.linear
+    for i in 1 2
+    do
+        diff -q tmp_cc_0.PHENO$i.glm.logistic.hybrid tmp_cc_$p.PHENO$i.glm.logistic.hybrid
+    done
+done
+
+# More phenotypes than fit in one --glm linear subbatch (240): read-ahead
+# buffers must be released between subbatches, so each one gets a full ring.
+$1/plink2 $2 $3 --dummy 100 70000 0.02 scalar-pheno pheno-ct=250 --seed 6 --out tmp_many
+for p in 0 8
+do
+    $1/plink2 $2 $3 --pfile tmp_many --glm allow-no-covars --pgen-prefetch $p --out tmp_many_$p
+done
+test "$(grep -c 'Reading ahead with 8 block buffers' tmp_many_8.log)" -eq 2
+for i in 1 240 241 250
+do
+    diff -q tmp_many_0.PHENO$i.glm.linear tmp_many_8.PHENO$i.glm.linear
+done
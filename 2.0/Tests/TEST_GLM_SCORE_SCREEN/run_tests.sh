@@ -0,0 +1,25 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 600 3000 0.02 acgt --seed 5 --out tmp_data
+awk 'BEGIN {srand(1); OFS = "\t"} NR == 1 {print "#IID", "COV1"} NR > 1 {print $1, rand()}' tmp_data.psam > tmp_data.cov
+
+# Variants passing the screen must get exactly the full logistic/Firth
+# result, and the rest must be flagged.
+for m in firth-fallback firth
+do
+    $1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm hide-covar $m --out tmp_full_$m
+    $1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm hide-covar $m score-screen=0.2 cols=+screen --out tmp_screen_$m
+    $1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm hide-covar $m score-screen=0.2 spa cols=+screen --out tmp_spa_$m
+done
+python3 screen_compare.py -f tmp_full_firth-fallback.PHENO1.glm.logistic.hybrid -s tmp_screen_firth-fallback.PHENO1.glm.logistic.hybrid -p 0.2
+python3 screen_compare.py -f tmp_full_firth-fallback.PHENO1.glm.logistic.hybrid -s tmp_spa_firth-fallback.PHENO1.glm.logistic.hybrid -p 0.2
+python3 screen_compare.py -f tmp_full_firth.PHENO1.glm.firth -s tmp_screen_firth.PHENO1.glm.firth -p 0.2
+python3 screen_compare.py -f tmp_full_firth.PHENO1.glm.firth -s tmp_spa_firth.PHENO1.glm.firth -p 0.2
+
+# The SCREENED? column is opt-in.
+$1/plink2 $2 $3 --pfile tmp_data --covar tmp_data.cov --glm hide-covar firth-fallback score-screen=0.2 --out tmp_default
+if head -n 1 tmp_default.PHENO1.glm.logistic.hybrid | grep -q "SCREENED?"; then
+    exit 1
+fi
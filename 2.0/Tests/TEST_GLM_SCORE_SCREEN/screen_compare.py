@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""
+This checks a --glm score-screen= report against the matching unscreened
+report.  The screened report must have the same rows, with a SCREENED? column
+right before TEST.  Rows with SCREENED?=N must carry exactly the unscreened
+full-regression result; rows with SCREENED?=Y must have score-test p-values
+no smaller than the threshold.  Both kinds of row must be present.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-f', '--full', type=str, required=True,
+                             help="Unscreened --glm report.")
+    requiredarg.add_argument('-s', '--screened', type=str, required=True,
+                             help="--glm report with score-screen= and cols=+screen.")
+    requiredarg.add_argument('-p', '--pthresh', type=float, required=True,
+                             help="score-screen= p-value threshold.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    full_header, full_rows = compare_util.read_report(cmd_args.full)
+    screened_header, screened_rows = compare_util.read_report(cmd_args.screened)
+    screen_col = full_header.index('TEST')
+    if screened_header != full_header[:screen_col] + ['SCREENED?'] + full_header[screen_col:]:
+        compare_util.fail('Unexpected header line in ' + cmd_args.screened + '.')
+    if len(screened_rows) != len(full_rows):
+        compare_util.fail('Row count mismatch.')
+    id_col_ct = full_header.index('A1') + 1
+    p_col = full_header.index('P')
+    passed_ct = 0
+    screened_ct = 0
+    for full_row, screened_row in zip(full_rows, screened_rows):
+        screened_flag = screened_row[screen_col]
+        del screened_row[screen_col]
+        if screened_row[:id_col_ct] != full_row[:id_col_ct]:
+            compare_util.fail('Variant mismatch at ' + full_row[2] + '.')
+        if screened_flag == 'N':
+            if screened_row != full_row:
+                compare_util.fail('Variant ' + full_row[2] + ' passed the screen, but its result differs from the full regression.')
+            passed_ct += 1
+        elif screened_flag == 'Y':
+            if float(screened_row[p_col]) < cmd_args.pthresh:
+                compare_util.fail('Variant ' + full_row[2] + ' was screened out, but its score-test p-value is below the threshold.')
+            screened_ct += 1
+        else:
+            compare_util.fail('Invalid SCREENED? value for ' + full_row[2] + '.')
+    if (not passed_ct) or (not screened_ct):
+        compare_util.fail('Expected both screened and unscreened variants.')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+This simulates a small rare-variant dataset for the --glm set-test tests: a
+VCF, a phenotype file with one quantitative and one case/control phenotype, a
+covariate file, and matching 0-based and 1-based interval-BED set files.
+Sets are windows of consecutive variants with varying lengths, some
+overlapping; there's also a single-variant set and a set that contains no
+variants.  (--dummy can't be used here since its allele frequencies are all
+close to 0.5.)
+"""
+
+import argparse
+import math
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=500,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=2000,
+                        help="Number of variants per chromosome.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    cov1 = [rng.gauss(0.0, 1.0) for _ in range(sample_ct)]
+    cov2 = [rng.randint(0, 3) for _ in range(sample_ct)]
+    liability = [0.3 * x for x in cov1]
+    variants = []
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for chrom in ('1', '2'):
+            for vidx in range(cmd_args.variants):
+                pos = 1000 + 10 * vidx
+                # mostly rare, with some low-frequency and common variants
+                roll = rng.random()
+                if roll < 0.8:
+                    freq = rng.uniform(0.0005, 0.02)
+                elif roll < 0.9:
+                    freq = rng.uniform(0.02, 0.1)
+                else:
+                    freq = rng.uniform(0.1, 0.9)
+                causal = (chrom == '1') and (500 <= vidx < 600) and (rng.random() < 0.5)
+                gts = []
+                for sample_idx in range(sample_ct):
+                    if rng.random() < 0.01:
+                        gts.append('./.')
+                        continue
+                    a1 = int(rng.random() < freq)
+                    a2 = int(rng.random() < freq)
+                    if causal:
+                        liability[sample_idx] += 0.6 * (a1 + a2)
+                    gts.append('{}/{}'.format(a1, a2))
+                variant_id = '{}:{}'.format(chrom, pos)
+                variants.append((chrom, pos, freq))
+                vcf_file.write('{}\t{}\t{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(chrom, pos, variant_id, '\t'.join(gts)))
+    with open(cmd_args.out + '.pheno', 'w') as pheno_file:
+        pheno_file.write('#IID\tQT\tCC\n')
+        for iid, cur_liability in zip(iids, liability):
+            qt = cur_liability + rng.gauss(0.0, 1.0)
+            case_prob = 1.0 / (1.0 + math.exp(1.0 - cur_liability))
+            pheno_file.write('{}\t{:.6f}\t{}\n'.format(iid, qt, 2 if rng.random() < case_prob else 1))
+    with open(cmd_args.out + '.cov', 'w') as cov_file:
+        cov_file.write('#IID\tCOV1\tCOV2\n')
+        for iid, val1, val2 in zip(iids, cov1, cov2):
+            cov_file.write('{}\t{:.6f}\t{}\n'.format(iid, val1, val2))
+
+    sets = []
+    vidx = 0
+    set_idx = 0
+    while vidx + 80 < len(variants):
+        width = rng.randint(10, 80)
+        last_vidx = vidx + width - 1
+        # sets never span chromosomes
+        if variants[last_vidx][0] == variants[vidx][0]:
+            sets.append(('set{}'.format(set_idx), vidx, last_vidx))
+            set_idx += 1
+        # occasionally overlap the previous set
+        vidx += width - rng.choice((0, 0, 0, 5))
+    single_vidx = min(vidx for vidx, variant in enumerate(variants) if variant[2] < 0.01)
+    sets.append(('set_single', single_vidx, single_vidx))
+    with open(cmd_args.out + '.bed1', 'w') as bed1_file, open(cmd_args.out + '.bed0', 'w') as bed0_file:
+        for set_id, first_vidx, last_vidx in sets:
+            chrom = variants[first_vidx][0]
+            start_bp = variants[first_vidx][1]
+            end_bp = variants[last_vidx][1]
+            bed1_file.write('{}\t{}\t{}\t{}\n'.format(chrom, start_bp, end_bp, set_id))
+            bed0_file.write('{}\t{}\t{}\t{}\n'.format(chrom, start_bp - 1, end_bp, set_id))
+        bed1_file.write('1\t1\t999\tset_empty\n')
+        bed0_file.write('1\t0\t999\tset_empty\n')
+
+
+if __name__ == '__main__':
+    main()
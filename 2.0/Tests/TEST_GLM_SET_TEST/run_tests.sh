@@ -0,0 +1,27 @@
+#!/bin/bash
+
+set -exo pipefail
+
+python3 make_inputs.py -o tmp_inputs -s 3
+$1/plink2 $2 $3 --vcf tmp_inputs.vcf --make-pgen --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --export A --out tmp_data
+
+# Quantitative and case/control phenotypes, checked against an independent
+# implementation of the documented method.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_inputs.pheno --covar tmp_inputs.cov --glm set-test-bed1=tmp_inputs.bed1 --out tmp_glm
+python3 set_compare.py -r tmp_data.raw -v tmp_data.pvar -p tmp_inputs.pheno -n QT -c tmp_inputs.cov -b tmp_inputs.bed1 -s tmp_glm.QT.glm.sets
+python3 set_compare.py -r tmp_data.raw -v tmp_data.pvar -p tmp_inputs.pheno -n CC -c tmp_inputs.cov -b tmp_inputs.bed1 -s tmp_glm.CC.glm.sets -l -t 0.0005
+
+# A higher MAF ceiling, with the 0-based set file.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_inputs.pheno --pheno-name QT --covar tmp_inputs.cov --glm set-test-bed0=tmp_inputs.bed0 set-test-max-maf=0.1 --out tmp_glm_maf
+python3 set_compare.py -r tmp_data.raw -v tmp_data.pvar -p tmp_inputs.pheno -n QT -c tmp_inputs.cov -b tmp_inputs.bed1 -s tmp_glm_maf.QT.glm.sets -m 0.1
+
+# Results must not depend on the thread count.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_inputs.pheno --pheno-name QT --covar tmp_inputs.cov --glm set-test-bed0=tmp_inputs.bed0 set-test-max-maf=0.1 --threads 3 --out tmp_glm_maf_t3
+diff -q tmp_glm_maf.QT.glm.sets tmp_glm_maf_t3.QT.glm.sets
+
+# Sets above set-test-max-vct= are skipped with a warning, and reported with
+# NA statistics; the rest are unaffected.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_inputs.pheno --pheno-name QT --covar tmp_inputs.cov --glm set-test-bed1=tmp_inputs.bed1 set-test-max-vct=20 --out tmp_glm_vct
+grep -q "qualifying variants skipped by --glm" tmp_glm_vct.log
+python3 set_compare.py -r tmp_data.raw -v tmp_data.pvar -p tmp_inputs.pheno -n QT -c tmp_inputs.cov -b tmp_inputs.bed1 -s tmp_glm_vct.QT.glm.sets -x 20
@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+"""
+This recomputes --glm set-test-bed1= burden/SKAT/SKAT-O results from an
+--export A .raw file, a covariate file, and the 1-based interval-BED set
+file, and compares them against the .glm.sets output.  The reference follows
+the method described in the --glm documentation: covariate-only null model,
+Beta(1,25) minor-allele-frequency weights, mean-imputed hardcalls, Liu
+kurtosis-matched chi-square p-values for each rho in the SKAT-O grid, and the
+Lee et al. (2012) SKAT-O integral.
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+RHOS = [0.0, 0.01, 0.04, 0.09, 0.25, 0.5, 1.0]
+SKATO_PANEL_CT = 256
+SMALL_EPSILON = 2.0 ** -44
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-r', '--raw', type=str, required=True,
+                             help="--export A .raw file.")
+    requiredarg.add_argument('-v', '--pvar', type=str, required=True,
+                             help=".pvar file.")
+    requiredarg.add_argument('-p', '--pheno', type=str, required=True,
+                             help="Phenotype file.")
+    requiredarg.add_argument('-n', '--pheno-name', type=str, required=True,
+                             help="Phenotype column name.")
+    requiredarg.add_argument('-c', '--covar', type=str, required=True,
+                             help="Covariate file.")
+    requiredarg.add_argument('-b', '--bed1', type=str, required=True,
+                             help="1-based interval-BED set file.")
+    requiredarg.add_argument('-s', '--sets', type=str, required=True,
+                             help=".glm.sets file to validate.")
+    parser.add_argument('-m', '--max-maf', type=float, default=0.01,
+                        help="set-test-max-maf= value.")
+    parser.add_argument('-x', '--max-vct', type=int, default=2000,
+                        help="set-test-max-vct= value.")
+    parser.add_argument('-l', '--logistic', action='store_true',
+                        help="Case/control phenotype.")
+    parser.add_argument('-t', '--tol', type=float, default=0.0001,
+                        help="Relative tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def invert(mat):
+    """
+    Gauss-Jordan inverse of a small nonsingular matrix.
+    """
+    dim = len(mat)
+    aug = [list(row) + [1.0 if i == j else 0.0 for j in range(dim)] for i, row in enumerate(mat)]
+    for col in range(dim):
+        pivot = max(range(col, dim), key=lambda r: abs(aug[r][col]))
+        aug[col], aug[pivot] = aug[pivot], aug[col]
+        pval = aug[col][col]
+        aug[col] = [x / pval for x in aug[col]]
+        for row in range(dim):
+            if row != col:
+                mult = aug[row][col]
+                if mult != 0.0:
+                    aug[row] = [x - mult * y for x, y in zip(aug[row], aug[col])]
+    return [row[dim:] for row in aug]
+
+
+def matmul(aa, bb):
+    bb_t = list(zip(*bb))
+    return [[sum(x * y for x, y in zip(row, col)) for col in bb_t] for row in aa]
+
+
+def gammq(aa, xx):
+    """
+    Regularized upper incomplete gamma function Q(a, x).
+    """
+    if xx <= 0.0:
+        return 1.0
+    gln = math.lgamma(aa)
+    if xx < aa + 1.0:
+        ap = aa
+        term = 1.0 / aa
+        total = term
+        for _ in range(10000):
+            ap += 1.0
+            term *= xx / ap
+            total += term
+            if abs(term) < abs(total) * 1e-16:
+                break
+        return 1.0 - total * math.exp(-xx + aa * math.log(xx) - gln)
+    tiny = 1e-300
+    bb = xx + 1.0 - aa
+    cc = 1.0 / tiny
+    dd = 1.0 / bb
+    hh = dd
+    for i in range(1, 10000):
+        an = -i * (i - aa)
+        bb += 2.0
+        dd = an * dd + bb
+        if abs(dd) < tiny:
+            dd = tiny
+        cc = bb + an / cc
+        if abs(cc) < tiny:
+            cc = tiny
+        dd = 1.0 / dd
+        delta = dd * cc
+        hh *= delta
+        if abs(delta - 1.0) < 1e-16:
+            break
+    return math.exp(-xx + aa * math.log(xx) - gln) * hh
+
+
+def chisq_p(xx, df):
+    return gammq(0.5 * df, 0.5 * xx)
+
+
+def chisq_inv(pval, df):
+    """
+    Inverse of chisq_p(), by bisection.
+    """
+    lo = 0.0
+    hi = max(df, 1.0)
+    while chisq_p(hi, df) > pval:
+        hi *= 2
+    for _ in range(200):
+        mid = 0.5 * (lo + hi)
+        if chisq_p(mid, df) > pval:
+            lo = mid
+        else:
+            hi = mid
+    return 0.5 * (lo + hi)
+
+
+def liu_p(qq, c1, c2, c4):
+    if (not c2 > 0.0) or (not c4 > 0.0):
+        return 1.0, 0.0
+    df = c2 * c2 / c4
+    return chisq_p((qq - c1) * math.sqrt(df / c2) + df, df), df
+
+
+def load_inputs(cmd_args):
+    with open(cmd_args.pvar, 'r') as pvar_file:
+        variants = []
+        for line in pvar_file:
+            if line.startswith('#'):
+                continue
+            fields = line.rstrip('\n').split('\t')
+            variants.append((fields[0], int(fields[1]), fields[2], fields[3], fields[4]))
+    with open(cmd_args.raw, 'r') as raw_file:
+        header = raw_file.readline().split()
+        col_names = header[6:]
+        if len(col_names) != len(variants):
+            compare_util.fail("Error: .raw/.pvar variant count mismatch.")
+        # Convert to ALT allele counts.
+        counts_ref = []
+        for col_name, variant in zip(col_names, variants):
+            if col_name == variant[2] + '_' + variant[4]:
+                counts_ref.append(False)
+            elif col_name == variant[2] + '_' + variant[3]:
+                counts_ref.append(True)
+            else:
+                compare_util.fail("Error: Unexpected .raw column " + col_name + ".")
+        iids = []
+        genos = []
+        for line in raw_file:
+            fields = line.split()
+            iids.append(fields[1])
+            genos.append([None if x == 'NA' else (2 - int(x) if cref else int(x)) for x, cref in zip(fields[6:], counts_ref)])
+    pheno_map = {}
+    with open(cmd_args.pheno, 'r') as pheno_file:
+        header = pheno_file.readline().split()
+        col_idx = header.index(cmd_args.pheno_name)
+        for line in pheno_file:
+            fields = line.split()
+            pheno_map[fields[0]] = float(fields[col_idx])
+    phenos = [pheno_map[iid] for iid in iids]
+    if cmd_args.logistic:
+        phenos = [x - 1.0 for x in phenos]
+    covars = {}
+    with open(cmd_args.covar, 'r') as covar_file:
+        covar_file.readline()
+        for line in covar_file:
+            fields = line.split()
+            covars[fields[0]] = [float(x) for x in fields[1:]]
+    xx = [[1.0] + covars[iid] for iid in iids]
+    # variant-major
+    genos = list(zip(*genos))
+    return variants, phenos, xx, genos
+
+
+def null_model(phenos, xx, logistic):
+    """
+    Returns (residuals, per-sample weights, phi).
+    """
+    sample_ct = len(phenos)
+    pred_ct = len(xx[0])
+    if not logistic:
+        xtx_inv = invert(matmul(list(zip(*xx)), xx))
+        xty = [sum(xx[i][j] * phenos[i] for i in range(sample_ct)) for j in range(pred_ct)]
+        beta = [sum(xtx_inv[j][k] * xty[k] for k in range(pred_ct)) for j in range(pred_ct)]
+        resid = [phenos[i] - sum(beta[j] * xx[i][j] for j in range(pred_ct)) for i in range(sample_ct)]
+        phi = sum(r * r for r in resid) / (sample_ct - pred_ct)
+        return resid, [1.0] * sample_ct, phi
+    beta = [0.0] * pred_ct
+    for _ in range(100):
+        mu = [1.0 / (1.0 + math.exp(-sum(b * x for b, x in zip(beta, row)))) for row in xx]
+        ww = [m * (1.0 - m) for m in mu]
+        xtwx = [[sum(ww[i] * xx[i][j] * xx[i][k] for i in range(sample_ct)) for k in range(pred_ct)] for j in range(pred_ct)]
+        grad = [sum(xx[i][j] * (phenos[i] - mu[i]) for i in range(sample_ct)) for j in range(pred_ct)]
+        step = [sum(r * g for r, g in zip(row, grad)) for row in invert(xtwx)]
+        beta = [b + s for b, s in zip(beta, step)]
+        if max(abs(s) for s in step) < 1e-12:
+            break
+    mu = [1.0 / (1.0 + math.exp(-sum(b * x for b, x in zip(beta, row)))) for row in xx]
+    return [p - m for p, m in zip(phenos, mu)], [m * (1.0 - m) for m in mu], 1.0
+
+
+def set_test(gg, scores, weights, resid_proj, phi):
+    """
+    gg: list of mean-imputed minor-allele dosage vectors.  Returns
+    (burden_z, burden_p, skat_q, skat_p, skato_rho, skato_p, per-rho p-values),
+    or None when the burden variance is zero.
+    """
+    vct = len(gg)
+    ww, xw, xtwx_inv = resid_proj
+    pred_ct = len(xtwx_inv)
+    gwx = [[sum(g[i] * xw[i][j] for i in range(len(g))) for j in range(pred_ct)] for g in gg]
+    ainv_gwx = [[sum(xtwx_inv[j][k] * row[k] for k in range(pred_ct)) for j in range(pred_ct)] for row in gwx]
+    zz = [[0.0] * vct for _ in range(vct)]
+    for r in range(vct):
+        for c in range(vct):
+            gwg = sum(a * w * b for a, w, b in zip(gg[r], ww, gg[c]))
+            sigma = phi * (gwg - sum(x * y for x, y in zip(gwx[r], ainv_gwx[c])))
+            zz[r][c] = sigma * weights[r] * weights[c]
+    wu = [w * u for w, u in zip(weights, scores)]
+    tt = sum(wu)
+    q_skat = sum(x * x for x in wu)
+    row_sums = [sum(row) for row in zz]
+    ss = sum(x * x for x in row_sums)
+    tot = sum(row_sums)
+    if not tot > 0.0:
+        return None
+    burden_z = tt / math.sqrt(tot)
+    burden_p = math.erfc(abs(burden_z) / math.sqrt(2))
+    rho_pvals = []
+    rho_c1s = []
+    rho_c2s = []
+    rho_dfs = []
+    for rho0 in RHOS:
+        rho = min(rho0, 0.999)
+        mm = [[(1.0 - rho) * zz[r][c] + rho * row_sums[r] for c in range(vct)] for r in range(vct)]
+        c1 = sum(mm[r][r] for r in range(vct))
+        c2 = sum(mm[r][c] * mm[c][r] for r in range(vct) for c in range(vct))
+        mm2 = matmul(mm, mm)
+        c4 = sum(mm2[r][c] * mm2[c][r] for r in range(vct) for c in range(vct))
+        pval, df = liu_p((1.0 - rho) * q_skat + rho * tt * tt, c1, c2, c4)
+        rho_pvals.append(pval)
+        rho_c1s.append(c1)
+        rho_c2s.append(c2)
+        rho_dfs.append(df)
+    pmin = min(rho_pvals)
+    skato_p = pmin
+    if vct > 1 and pmin < 1.0:
+        bb = [[zz[r][c] - row_sums[r] * row_sums[c] / tot for c in range(vct)] for r in range(vct)]
+        mu_q = sum(bb[r][r] for r in range(vct))
+        b_ssq = sum(x * x for row in bb for x in row)
+        bb2 = matmul(bb, bb)
+        b2_ssq = sum(x * x for row in bb2 for x in row)
+        szs = sum(row_sums[r] * zz[r][c] * row_sums[c] for r in range(vct) for c in range(vct))
+        if b2_ssq > 0.0 and b_ssq > SMALL_EPSILON * tot * tot:
+            var_q = 2 * b_ssq + 4 * (szs - ss * ss / tot) / tot
+            skato_df = b_ssq * b_ssq / b2_ssq
+            qmins = []
+            taus = []
+            for rho0, df, c1, c2 in zip(RHOS, rho_dfs, rho_c1s, rho_c2s):
+                rho = min(rho0, 0.999)
+                if df > 0.0:
+                    qmins.append((chisq_inv(pmin, df) - df) * math.sqrt(c2 / df) + c1)
+                else:
+                    qmins.append(float('inf'))
+                taus.append(rho * tot + (1.0 - rho) * ss / tot)
+            if var_q > 0.0:
+                q_scale = math.sqrt(2 * skato_df / var_q)
+                t_max = math.sqrt(40.0)
+                hh = t_max / SKATO_PANEL_CT
+                integral = 0.0
+                for pt_idx in range(SKATO_PANEL_CT + 1):
+                    xx = (pt_idx * hh) ** 2
+                    temp_min = min((qmin - tau * xx) / (1.0 - min(rho0, 0.999)) for qmin, tau, rho0 in zip(qmins, taus, RHOS))
+                    temp_q = (temp_min - mu_q) * q_scale + skato_df
+                    upper = chisq_p(temp_q, skato_df) if temp_q > 0.0 else 1.0
+                    if pt_idx == 0 or pt_idx == SKATO_PANEL_CT:
+                        mult = 1.0
+                    else:
+                        mult = 4.0 if pt_idx % 2 else 2.0
+                    integral += mult * upper * math.exp(-0.5 * xx)
+                integral *= (hh / 3) * 2 / math.sqrt(2 * math.pi)
+                skato_p = integral + chisq_p(40.0, 1)
+                skato_p = min(max(skato_p, pmin), min(pmin * len(RHOS), 1.0))
+    best_rho = RHOS[rho_pvals.index(pmin)]
+    return burden_z, burden_p, q_skat, rho_pvals[0], best_rho, skato_p, rho_pvals
+
+
+def close(val1, val2, tol):
+    return compare_util.rel_close(val1, val2, tol, max(abs(val1), abs(val2), 1e-300))
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    variants, phenos, xx, genos = load_inputs(cmd_args)
+    sample_ct = len(phenos)
+    resid, ww, phi = null_model(phenos, xx, cmd_args.logistic)
+    pred_ct = len(xx[0])
+    xw = [[ww[i] * xx[i][j] for j in range(pred_ct)] for i in range(sample_ct)]
+    xtwx_inv = invert(matmul(list(zip(*xx)), xw))
+    resid_proj = (ww, xw, xtwx_inv)
+
+    # per-variant minor-allele dosages, weights, scores
+    kept = {}
+    for vidx, col in enumerate(genos):
+        nm = [g for g in col if g is not None]
+        alt_ct = sum(nm)
+        ref_is_minor = alt_ct > len(nm)
+        mac = 2 * len(nm) - alt_ct if ref_is_minor else alt_ct
+        if mac == 0:
+            continue
+        maf = mac / (2.0 * len(nm))
+        if maf > cmd_args.max_maf:
+            continue
+        dosages = [2 * maf if g is None else ((2 - g) if ref_is_minor else g) for g in col]
+        weight = 25 * (1.0 - maf) ** 24
+        score = sum(d * r for d, r in zip(dosages, resid))
+        kept[vidx] = (dosages, weight, score, mac)
+
+    expected = {}
+    with open(cmd_args.bed1, 'r') as bed_file:
+        for line in bed_file:
+            chrom, start_bp, end_bp, set_id = line.split()[:4]
+            start_bp = int(start_bp)
+            end_bp = int(end_bp)
+            members = [vidx for vidx, variant in enumerate(variants) if variant[0] == chrom and start_bp <= variant[1] <= end_bp and vidx in kept]
+            if not members:
+                continue
+            if len(members) > cmd_args.max_vct:
+                # skipped; NA statistics
+                expected[set_id] = (len(members), sum(kept[vidx][3] for vidx in members), None)
+                continue
+            gg = [kept[vidx][0] for vidx in members]
+            result = set_test(gg, [kept[vidx][2] for vidx in members], [kept[vidx][1] for vidx in members], resid_proj, phi)
+            expected[set_id] = (len(members), sum(kept[vidx][3] for vidx in members), result)
+
+    mismatch_ct = 0
+    seen = set()
+    with open(cmd_args.sets, 'r') as sets_file:
+        header = sets_file.readline().rstrip('\n').split('\t')
+        if header != ['#SET', 'NVAR', 'MAC', 'BURDEN_Z', 'BURDEN_P', 'SKAT_Q', 'SKAT_P', 'SKATO_RHO', 'SKATO_P']:
+            compare_util.fail("Error: Unexpected .glm.sets header.")
+        for line in sets_file:
+            fields = line.rstrip('\n').split('\t')
+            set_id = fields[0]
+            if set_id not in expected:
+                compare_util.fail("Error: Unexpected set " + set_id + ".")
+            seen.add(set_id)
+            nvar, mac, result = expected[set_id]
+            if int(fields[1]) != nvar or int(fields[2]) != mac:
+                compare_util.eprint("Error: NVAR/MAC mismatch for " + set_id + ".")
+                mismatch_ct += 1
+                continue
+            if result is None:
+                if any(x != 'NA' for x in fields[3:]):
+                    compare_util.eprint("Error: Expected NA results for " + set_id + ".")
+                    mismatch_ct += 1
+                continue
+            burden_z, burden_p, q_skat, skat_p, best_rho, skato_p, rho_pvals = result
+            checks = [('BURDEN_Z', burden_z, float(fields[3])),
+                      ('BURDEN_P', burden_p, float(fields[4])),
+                      ('SKAT_Q', q_skat, float(fields[5])),
+                      ('SKAT_P', skat_p, float(fields[6])),
+                      ('SKATO_P', skato_p, float(fields[8]))]
+            for col_name, ref_val, out_val in checks:
+                if not close(ref_val, out_val, cmd_args.tol):
+                    compare_util.eprint("Error: {} mismatch for {} (expected {}, got {}).".format(col_name, set_id, ref_val, out_val))
+                    mismatch_ct += 1
+            # near-ties between rho values can legitimately resolve either
+            # way under floating point error
+            out_rho = float(fields[7])
+            if out_rho not in RHOS or not close(rho_pvals[RHOS.index(out_rho)], min(rho_pvals), cmd_args.tol):
+                compare_util.eprint("Error: SKATO_RHO mismatch for {} (expected {}, got {}).".format(set_id, best_rho, out_rho))
+                mismatch_ct += 1
+            if nvar == 1:
+                if not (close(float(fields[4]), float(fields[6]), cmd_args.tol) and close(float(fields[4]), float(fields[8]), cmd_args.tol)):
+                    compare_util.eprint("Error: Single-variant set " + set_id + " has inconsistent p-values.")
+                    mismatch_ct += 1
+    missing = set(expected) - seen
+    if missing:
+        compare_util.fail("Error: Missing sets: " + ', '.join(sorted(missing)) + ".")
+    if mismatch_ct:
+        sys.exit(1)
+    print("{} sets checked.".format(len(seen)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+This simulates a dataset for the --glm stepwise= tests: a VCF with two
+autosomes and no missing calls, plus a quantitative phenotype with a few
+independent large-effect variants (some of them in LD with neighbors) and one
+covariate.
+"""
+
+import argparse
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=1000,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=300,
+                        help="Number of variants per chromosome.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    cov1 = [rng.gauss(0.0, 1.0) for _ in range(sample_ct)]
+    qt = [0.5 * val for val in cov1]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for chrom in ('1', '2'):
+            alleles = None
+            for vidx in range(cmd_args.variants):
+                if alleles and (rng.random() < 0.7):
+                    # LD with the previous variant
+                    alleles = [(a1 ^ (rng.random() < 0.1), a2 ^ (rng.random() < 0.1)) for a1, a2 in alleles]
+                else:
+                    freq = rng.uniform(0.1, 0.5)
+                    alleles = [(int(rng.random() < freq), int(rng.random() < freq)) for _ in range(sample_ct)]
+                if vidx % 100 == 50:
+                    effect = rng.choice((-0.3, 0.3))
+                    for sample_idx, (a1, a2) in enumerate(alleles):
+                        qt[sample_idx] += effect * (a1 + a2)
+                gts = '\t'.join('{}/{}'.format(a1, a2) for a1, a2 in alleles)
+                vcf_file.write('{}\t{}\t{}:{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(chrom, 1000 + 10 * vidx, chrom, 1000 + 10 * vidx, gts))
+    with open(cmd_args.out + '.pheno', 'w') as pheno_file:
+        pheno_file.write('#IID\tQT\n')
+        for iid, val in zip(iids, qt):
+            pheno_file.write('{}\t{:.6f}\n'.format(iid, val + rng.gauss(0.0, 1.0)))
+    with open(cmd_args.out + '.cov', 'w') as cov_file:
+        cov_file.write('#IID\tCOV1\n')
+        for iid, val in zip(iids, cov1):
+            cov_file.write('{}\t{:.6f}\n'.format(iid, val))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+set -exo pipefail
+
+python3 make_inputs.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm stepwise=1e-4 --out tmp_step
+
+# Each thread updates a fixed candidate range, so the thread count mustn't
+# affect the output.
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm stepwise=1e-4 --threads 1 --out tmp_step_t1
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm stepwise=1e-4 --threads 3 --out tmp_step_t3
+cmp tmp_step_t1.QT.glm.stepwise tmp_step_t3.QT.glm.stepwise
+
+# Replay the selection as a chain of --condition-list runs.
+step_ct=$(($(wc -l < tmp_step.QT.glm.stepwise) - 1))
+test $step_ct -ge 3
+$1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --glm hide-covar --out tmp_cond0
+python3 stepwise_compare.py -s tmp_step.QT.glm.stepwise -g tmp_cond0.QT.glm.linear -k 0 -p 1e-4
+for k in $(seq 1 $step_ct)
+do
+    tail -n +2 tmp_step.QT.glm.stepwise | head -n $k | cut -f 4 > tmp_cond$k.snplist
+    $1/plink2 $2 $3 --pfile tmp_data --pheno tmp_data.pheno --covar tmp_data.cov --condition-list tmp_cond$k.snplist --glm hide-covar --out tmp_cond$k
+    python3 stepwise_compare.py -s tmp_step.QT.glm.stepwise -g tmp_cond$k.QT.glm.linear -k $k -p 1e-4
+done
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+This checks one step of a --glm stepwise= run against an ordinary --glm run
+conditioned (with --condition-list) on the variants selected in the earlier
+steps.  Among the variants not yet selected, the one with the smallest
+p-value must be the one selected at this step, with matching statistics; if
+there is no such step, its p-value must not be below the threshold.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-s', '--stepwise', type=str, required=True,
+                             help=".glm.stepwise file.")
+    requiredarg.add_argument('-g', '--glm', type=str, required=True,
+                             help="Conditioned --glm linear report (hide-covar).")
+    requiredarg.add_argument('-k', '--step', type=int, required=True,
+                             help="Number of variants conditioned on.")
+    requiredarg.add_argument('-p', '--pthresh', type=float, required=True,
+                             help="stepwise= p-value threshold.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-4,
+                        help="Relative tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    _, steps = compare_util.read_report(cmd_args.stepwise, as_dicts=True)
+    selected_ids = set(step['ID'] for step in steps[:cmd_args.step])
+    _, glm_rows = compare_util.read_report(cmd_args.glm, as_dicts=True)
+    glm_rows = [row for row in glm_rows if (row['ID'] not in selected_ids) and (row['P'] != 'NA')]
+    best_row = min(glm_rows, key=lambda row: float(row['P']))
+    if cmd_args.step == len(steps):
+        if float(best_row['P']) < cmd_args.pthresh:
+            compare_util.fail('Stepwise selection stopped early: ' + best_row['ID'] + ' has p-value ' + best_row['P'] + '.')
+        return
+    step = steps[cmd_args.step]
+    if best_row['ID'] != step['ID']:
+        compare_util.fail('Step ' + step['STEP'] + ' selected ' + step['ID'] + ', but ' + best_row['ID'] + ' has the smallest conditional p-value.')
+    for col_name in ('A1', 'OBS_CT'):
+        if best_row[col_name] != step[col_name]:
+            compare_util.fail(col_name + ' mismatch at step ' + step['STEP'] + '.')
+    for col_name in ('BETA', 'SE', 'T_STAT', 'P'):
+        expected = float(best_row[col_name])
+        if not compare_util.rel_close(float(step[col_name]), expected, cmd_args.tolerance, abs(expected)):
+            compare_util.fail(col_name + ' mismatch at step ' + step['STEP'] + ': ' + step[col_name] + ' vs. ' + best_row[col_name] + '.')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 800 3000 0.01 --seed 11 --out tmp_data
+for m in "" meanimpute cov
+do
+    $1/plink2 $2 $3 --pfile tmp_data --make-rel $m bin square --out tmp_dense$m
+    $1/plink2 $2 $3 --pfile tmp_data --make-grm-sparse $m --out tmp_sparse$m
+    python3 sparse_compare.py -s tmp_sparse$m.grm.sp -b tmp_dense$m.rel.bin -c 0.05
+done
+$1/plink2 $2 $3 --pfile tmp_data --make-grm-sparse cutoff=0.02 --out tmp_sparse_02
+python3 sparse_compare.py -s tmp_sparse_02.grm.sp -b tmp_dense.rel.bin -c 0.02
+
+# --parallel row ranges must concatenate to the single-run output.
+for i in 1 2 3
+do
+    $1/plink2 $2 $3 --pfile tmp_data --make-grm-sparse --parallel $i 3 --out tmp_par
+done
+cat tmp_par.grm.sp.1 tmp_par.grm.sp.2 tmp_par.grm.sp.3 > tmp_par.grm.sp
+diff -q tmp_sparse.grm.sp tmp_par.grm.sp
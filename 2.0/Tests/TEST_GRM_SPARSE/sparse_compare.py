@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+This checks a --make-grm-sparse .grm.sp file against the matching dense
+"--make-rel bin square" matrix: it must contain exactly the diagonal and the
+lower-triangular entries greater than the cutoff, in row-then-column order,
+with matching values.
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-s', '--sparse', type=str, required=True,
+                             help=".grm.sp file.")
+    requiredarg.add_argument('-b', '--relbin', type=str, required=True,
+                             help="--make-rel bin square output.")
+    requiredarg.add_argument('-c', '--cutoff', type=float, required=True,
+                             help="--make-grm-sparse cutoff.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-5,
+                        help="Relative tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rel = compare_util.read_doubles(cmd_args.relbin)
+    sample_ct = math.isqrt(len(rel))
+    expected = []
+    for row_idx in range(sample_ct):
+        for col_idx in range(row_idx + 1):
+            val = rel[row_idx * sample_ct + col_idx]
+            if (col_idx == row_idx) or (val > cmd_args.cutoff):
+                expected.append((row_idx, col_idx, val))
+    with open(cmd_args.sparse, 'r') as sparse_file:
+        entries = [line.split() for line in sparse_file]
+    if len(entries) != len(expected):
+        compare_util.fail('Expected ' + str(len(expected)) + ' entries, found ' + str(len(entries)) + '.')
+    for entry, (row_idx, col_idx, val) in zip(entries, expected):
+        if (int(entry[0]) != row_idx) or (int(entry[1]) != col_idx):
+            compare_util.fail('Expected entry (' + str(row_idx) + ', ' + str(col_idx) + '), found (' + entry[0] + ', ' + entry[1] + ').')
+        if not compare_util.rel_close(float(entry[2]), val, cmd_args.tolerance, abs(val)):
+            compare_util.fail('Value mismatch for (' + entry[0] + ', ' + entry[1] + ').')
+
+
+if __name__ == '__main__':
+    main()
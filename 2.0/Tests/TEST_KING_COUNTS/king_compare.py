@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+This recomputes the per-pair KING counts (NSNP if present, HETHET, IBS0,
+HET1_HOM2, HET2_HOM1) from an "--export A" table, and checks them against a
+"--make-king-table counts" report with the ibs1 column set.  This verifies whichever
+KING kernel (AVX-512 VPOPCNTDQ or generic) the CPU selected.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-r', '--raw', type=str, required=True,
+                             help="--export A output.")
+    requiredarg.add_argument('-k', '--kin', type=str, required=True,
+                             help="--make-king-table counts output.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def popcount(val):
+    return bin(val).count('1')
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    # one bitset over variants per (sample, genotype)
+    sample_bits = {}
+    _, raw_rows = compare_util.read_report(cmd_args.raw)
+    for fields in raw_rows:
+        bits = [0, 0, 0]
+        for variant_idx, val in enumerate(fields[6:]):
+            if val != 'NA':
+                bits[int(val)] |= 1 << variant_idx
+        sample_bits[fields[1]] = bits
+    header, kin_rows = compare_util.read_report(cmd_args.kin)
+    header[0] = header[0].lstrip('#')
+    col_idxs = [header.index(col_name) for col_name in ('IID1', 'IID2', 'HETHET', 'IBS0', 'HET1_HOM2', 'HET2_HOM1')]
+    nsnp_col_idx = header.index('NSNP') if 'NSNP' in header else None
+    for fields in kin_rows:
+        iid1, iid2, hethet, ibs0, het1hom2, het2hom1 = [fields[col_idx] for col_idx in col_idxs]
+        hom0_1, het_1, hom2_1 = sample_bits[iid1]
+        hom0_2, het_2, hom2_2 = sample_bits[iid2]
+        hom_1 = hom0_1 | hom2_1
+        hom_2 = hom0_2 | hom2_2
+        # the KING "first" sample is the earlier one, i.e. IID2
+        expected = (popcount(het_1 & het_2),
+                    popcount((hom0_1 & hom2_2) | (hom2_1 & hom0_2)),
+                    popcount(hom_1 & het_2),
+                    popcount(het_1 & hom_2))
+        actual = (int(hethet), int(ibs0), int(het1hom2), int(het2hom1))
+        if nsnp_col_idx is not None:
+            expected += (popcount((hom_1 | het_1) & (hom_2 | het_2)),)
+            actual += (int(fields[nsnp_col_idx]),)
+        if expected != actual:
+            compare_util.fail('KING count mismatch for ' + iid1 + ' and ' + iid2 + '.')
+    sample_ct = len(sample_bits)
+    if len(kin_rows) != (sample_ct * (sample_ct - 1)) // 2:
+        compare_util.fail('Unexpected pair count.')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# 600 samples span several 256-sample kernel tiles.
+$1/plink2 $2 $3 --dummy 600 2000 0.02 --seed 12 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --export A --out tmp_data
+
+# With the nsnp column, IncrKingHomhom() is used; without it, IncrKing().
+$1/plink2 $2 $3 --pfile tmp_data --make-king-table counts cols=+ibs1 --out tmp_homhom
+python3 king_compare.py -r tmp_data.raw -k tmp_homhom.kin0
+$1/plink2 $2 $3 --pfile tmp_data --make-king-table counts cols=id,hethet,ibs0,ibs1 --out tmp_nohomhom
+python3 king_compare.py -r tmp_data.raw -k tmp_nohomhom.kin0
+
+# --parallel row ranges must concatenate to the single-run table.
+for i in 1 2 3
+do
+    $1/plink2 $2 $3 --pfile tmp_data --make-king-table counts cols=+ibs1 --parallel $i 3 --out tmp_par
+done
+cat tmp_par.kin0.1 tmp_par.kin0.2 tmp_par.kin0.3 > tmp_par.kin0
+diff -q tmp_homhom.kin0 tmp_par.kin0
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+This simulates a VCF for the --king-screen tests: nuclear families (two
+unrelated parents and two children) plus unrelated singletons, with mostly
+rare variants and some common ones.  Variants are unlinked.
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-f', '--families', type=int, default=30,
+                        help="Number of families.")
+    parser.add_argument('-u', '--unrelated', type=int, default=180,
+                        help="Number of unrelated singletons.")
+    parser.add_argument('-m', '--variants', type=int, default=8000,
+                        help="Number of variants.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    iids = []
+    # (father index, mother index), or None for founders
+    parents = []
+    for fam_idx in range(cmd_args.families):
+        father_idx = len(iids)
+        iids.extend(['f{}_pat'.format(fam_idx), 'f{}_mat'.format(fam_idx)])
+        parents.extend([None, None])
+        for child_idx in range(2):
+            iids.append('f{}_kid{}'.format(fam_idx, child_idx))
+            parents.append((father_idx, father_idx + 1))
+    for sample_idx in range(cmd_args.unrelated):
+        iids.append('u{}'.format(sample_idx))
+        parents.append(None)
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for vidx in range(cmd_args.variants):
+            if rng.random() < 0.8:
+                freq = rng.uniform(0.001, 0.02)
+            else:
+                freq = rng.uniform(0.05, 0.5)
+            haps = []
+            for cur_parents in parents:
+                if cur_parents is None:
+                    haps.append((int(rng.random() < freq), int(rng.random() < freq)))
+                else:
+                    haps.append((rng.choice(haps[cur_parents[0]]), rng.choice(haps[cur_parents[1]])))
+            gts = '\t'.join('./.' if rng.random() < 0.005 else '{}/{}'.format(a1, a2) for a1, a2 in haps)
+            vcf_file.write('1\t{}\tv{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(1000 + 10 * vidx, vidx, gts))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+set -exo pipefail
+
+python3 make_vcf.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+
+# All first-degree pairs share enough rare variants to pass the screen, so
+# the screened results must match the full computation.
+$1/plink2 $2 $3 --pfile tmp_data --make-king-table --king-table-filter 0.177 --out tmp_full
+$1/plink2 $2 $3 --pfile tmp_data --king-screen --make-king-table --king-table-filter 0.177 --out tmp_screen
+diff -q tmp_full.kin0 tmp_screen.kin0
+$1/plink2 $2 $3 --pfile tmp_data --king-cutoff 0.177 --out tmp_full
+$1/plink2 $2 $3 --pfile tmp_data --king-screen --king-cutoff 0.177 --out tmp_screen
+diff -q tmp_full.king.cutoff.in.id tmp_screen.king.cutoff.in.id
+diff -q tmp_full.king.cutoff.out.id tmp_screen.king.cutoff.out.id
+
+# With a low threshold, the screen may drop some (mostly spurious) pairs, but
+# every reported estimate must still be exact.
+$1/plink2 $2 $3 --pfile tmp_data --make-king-table --king-table-filter 0.0442 --out tmp_full_low
+$1/plink2 $2 $3 --pfile tmp_data --king-screen --make-king-table --king-table-filter 0.0442 --out tmp_screen_low
+sort tmp_full_low.kin0 > tmp_full_low_sorted.kin0
+sort tmp_screen_low.kin0 > tmp_screen_low_sorted.kin0
+test "$(comm -13 tmp_full_low_sorted.kin0 tmp_screen_low_sorted.kin0)" = ""
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+This simulates a VCF with three populations for the --pca-project tests.
+Population allele frequencies are drawn around a shared ancestral frequency,
+so the top two principal components are well separated from the rest.  A
+fraction of the variants are triallelic.  There are no missing calls, so the
+.eigenval file is exactly on the loading scale.
+
+<out>.rotated.vcf has the same genotypes, with each variant's allele order
+rotated by one (so the last ALT allele becomes REF).
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=600,
+                        help="Number of samples (assigned to populations in rotation).")
+    parser.add_argument('-m', '--variants', type=int, default=3000,
+                        help="Number of variants.")
+    parser.add_argument('-a', '--multiallelic', type=float, default=0.1,
+                        help="Fraction of triallelic variants.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def draw_allele(rng, freqs):
+    draw = rng.random()
+    for allele_idx, freq in enumerate(freqs):
+        draw -= freq
+        if draw < 0.0:
+            return allele_idx
+    return len(freqs) - 1
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file, open(cmd_args.out + '.rotated.vcf', 'w') as rotated_file:
+        for out_file in (vcf_file, rotated_file):
+            out_file.write('##fileformat=VCFv4.2\n')
+            out_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+            out_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for vidx in range(cmd_args.variants):
+            allele_ct = 3 if rng.random() < cmd_args.multiallelic else 2
+            anc_weights = [rng.uniform(0.2, 1.0) for _ in range(allele_ct)]
+            pop_freqs = []
+            for _ in range(3):
+                weights = [max(0.02, weight + rng.gauss(0.0, 0.15)) for weight in anc_weights]
+                weight_sum = sum(weights)
+                pop_freqs.append([weight / weight_sum for weight in weights])
+            gts = []
+            for sample_idx in range(sample_ct):
+                freqs = pop_freqs[sample_idx % 3]
+                gts.append((draw_allele(rng, freqs), draw_allele(rng, freqs)))
+            alleles = ['A', 'C', 'G'][:allele_ct]
+            rotated_alleles = alleles[-1:] + alleles[:-1]
+            pos = 1000 + 10 * vidx
+            vcf_file.write('1\t{}\tv{}\t{}\t{}\t.\tPASS\t.\tGT\t{}\n'.format(pos, vidx, alleles[0], ','.join(alleles[1:]), '\t'.join('{}/{}'.format(gt1, gt2) for gt1, gt2 in gts)))
+            rotated_file.write('1\t{}\tv{}\t{}\t{}\t.\tPASS\t.\tGT\t{}\n'.format(pos, vidx, rotated_alleles[0], ','.join(rotated_alleles[1:]), '\t'.join('{}/{}'.format((gt1 + 1) % allele_ct, (gt2 + 1) % allele_ct) for gt1, gt2 in gts)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""
+This compares a --pca .eigenvec file against a --pca-project .proj.eigenvec
+file for the same samples, and verifies that the symmetric absolute
+percentage error on each PC is less than the given tolerance.  Unlike
+pca_compare.py, sign flips are NOT tolerated, since projections must land on
+the reference axes.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-1', '--eigenvec', type=str, required=True,
+                             help="Reference .eigenvec file.")
+    requiredarg.add_argument('-2', '--proj', type=str, required=True,
+                             help=".proj.eigenvec file to validate.")
+    requiredarg.add_argument('-t', '--tolerance', type=float, required=True,
+                             help="Maximum allowed SMAE.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    tol = cmd_args.tolerance
+    header1, rows1 = compare_util.read_report(cmd_args.eigenvec)
+    header2, rows2 = compare_util.read_report(cmd_args.proj)
+    if header1 != header2:
+        compare_util.fail('Header mismatch.')
+    if len(rows1) != len(rows2):
+        compare_util.fail('Sample count mismatch.')
+    id_col_ct = 0
+    while not header1[id_col_ct].startswith('PC'):
+        id_col_ct += 1
+    pc_ct = len(header1) - id_col_ct
+    absdiff_sums = [0.0] * pc_ct
+    avgabs_x2_sums = [0.0] * pc_ct
+    for row1, row2 in zip(rows1, rows2):
+        if row1[:id_col_ct] != row2[:id_col_ct]:
+            compare_util.fail('Sample ID mismatch.')
+        for pc_idx in range(pc_ct):
+            val1 = float(row1[id_col_ct + pc_idx])
+            val2 = float(row2[id_col_ct + pc_idx])
+            absdiff_sums[pc_idx] += abs(val2 - val1)
+            avgabs_x2_sums[pc_idx] += abs(val2) + abs(val1)
+    for pc_idx in range(pc_ct):
+        if not compare_util.rel_close(absdiff_sums[pc_idx], 0.0, tol, avgabs_x2_sums[pc_idx] * 0.5):
+            compare_util.fail('PC' + str(pc_idx + 1) + ' projection mismatch.')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Reference samples projected onto their own --pca model must reproduce the
+# .eigenvec exactly (up to floating point error), including sign.
+$1/plink2 $2 $3 --dummy 300 3000 acgt --seed 1 --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --pca 4 model --out tmp_pca
+$1/plink2 $2 $3 --pfile tmp_data --pca-project tmp_pca.eigenvec.model --out tmp_proj
+python3 proj_compare.py -1 tmp_pca.eigenvec -2 tmp_proj.proj.eigenvec -t 0.000002
+
+# Same, after swapping REF and ALT for every variant.
+cat tmp_data.pvar | tail -n +2 | cut -f 3,5 > tmp_alt_alleles.txt
+$1/plink2 $2 $3 --pfile tmp_data --ref-allele force tmp_alt_alleles.txt 2 1 --make-pgen --out tmp_swapped
+$1/plink2 $2 $3 --pfile tmp_swapped --pca-project tmp_pca.eigenvec.model --out tmp_proj_swapped
+python3 proj_compare.py -1 tmp_pca.eigenvec -2 tmp_proj_swapped.proj.eigenvec -t 0.000002
+
+# The streaming solver writes the same kind of model.  Its eigenvectors are
+# only approximate (convergence is slow on unstructured --dummy data), so the
+# tolerance is looser; a sign flip would still produce an error near 2.
+$1/plink2 $2 $3 --pfile tmp_data --pca 4 stream iters=40 model --out tmp_pca_stream
+$1/plink2 $2 $3 --pfile tmp_data --pca-project tmp_pca_stream.eigenvec.model --out tmp_proj_stream
+python3 proj_compare.py -1 tmp_pca_stream.eigenvec -2 tmp_proj_stream.proj.eigenvec -t 0.02
+
+# Three populations with some triallelic variants.  Projecting onto a model
+# after rotating every variant's allele order must also reproduce the
+# .eigenvec; for triallelic variants, this permutes the loading rows.
+python3 make_vcf.py -o tmp_multi
+$1/plink2 $2 $3 --vcf tmp_multi.vcf --make-pgen --out tmp_multi
+$1/plink2 $2 $3 --vcf tmp_multi.rotated.vcf --make-pgen --out tmp_multi_rotated
+$1/plink2 $2 $3 --pfile tmp_multi --pca 4 model --out tmp_pca_multi
+$1/plink2 $2 $3 --pfile tmp_multi_rotated --pca-project tmp_pca_multi.eigenvec.model --out tmp_proj_rotated
+python3 proj_compare.py -1 tmp_pca_multi.eigenvec -2 tmp_proj_rotated.proj.eigenvec -t 0.000002
+
+# 'shrinkage' on held-out samples: the correction factors must follow from
+# the reference eigenvalues, with unit noise variance per variant.
+awk 'NR > 1 && NR % 4 != 0 {print $1}' tmp_multi.psam > tmp_ref.keep
+$1/plink2 $2 $3 --pfile tmp_multi --keep tmp_ref.keep --make-pgen --out tmp_ref
+$1/plink2 $2 $3 --pfile tmp_ref --pca 4 model --out tmp_pca_ref
+$1/plink2 $2 $3 --pfile tmp_multi --remove tmp_ref.keep --pca-project tmp_pca_ref.eigenvec.model --out tmp_plain
+$1/plink2 $2 $3 --pfile tmp_multi --remove tmp_ref.keep --pca-project tmp_pca_ref.eigenvec.model shrinkage --out tmp_shrunk
+python3 shrink_compare.py -e tmp_pca_ref.eigenval -v tmp_ref.pvar -n $(wc -l < tmp_ref.keep) -1 tmp_plain.proj.eigenvec -2 tmp_shrunk.proj.eigenvec -s 2
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+This checks "--pca-project shrinkage" output against an unshrunk projection
+of the same samples.  Expected per-PC correction factors are recomputed from
+the reference .eigenval file with the Lee, Zou & Wright (2010) formulas, using
+unit noise variance per standardized variant; each shrinkage-corrected PC
+must equal the unshrunk PC divided by its factor.  PCs within 1% of the
+detection threshold are skipped, since the factor is ill-conditioned there.
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-e', '--eigenval', type=str, required=True,
+                             help="Reference .eigenval file.")
+    requiredarg.add_argument('-v', '--pvar', type=str, required=True,
+                             help="Reference .pvar file.")
+    requiredarg.add_argument('-n', '--samples', type=int, required=True,
+                             help="Number of reference samples.")
+    requiredarg.add_argument('-1', '--plain', type=str, required=True,
+                             help="Unshrunk .proj.eigenvec file.")
+    requiredarg.add_argument('-2', '--shrunk', type=str, required=True,
+                             help="Shrinkage-corrected .proj.eigenvec file.")
+    parser.add_argument('-s', '--signal-ct', type=int, default=0,
+                        help="Minimum number of PCs above the detection threshold.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-4,
+                        help="Relative tolerance.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    # one model row per biallelic variant, one per allele otherwise
+    row_ct = 0
+    variant_ct = 0
+    _, pvar_rows = compare_util.read_report(cmd_args.pvar)
+    for row in pvar_rows:
+        allele_ct = 1 + len(row[4].split(','))
+        row_ct += 1 if allele_ct == 2 else allele_ct
+        variant_ct += 1
+    noise_variance = variant_ct / row_ct
+    gamma = row_ct / cmd_args.samples
+    bbp_threshold = (1.0 + math.sqrt(gamma)) ** 2
+    with open(cmd_args.eigenval, 'r') as eigenval_file:
+        eigenvals = [float(line) for line in eigenval_file]
+    rhos = []
+    for eigenval in eigenvals:
+        # .eigenval is on the GRM scale, i.e. divided by variant_ct (with no
+        # missing calls)
+        dd = eigenval * variant_ct / (cmd_args.samples * noise_variance)
+        if abs(dd - bbp_threshold) < 0.01 * bbp_threshold:
+            rhos.append(None)
+        elif dd > bbp_threshold:
+            bb = dd + 1.0 - gamma
+            spike = 0.5 * (bb + math.sqrt(bb * bb - 4 * dd))
+            rhos.append((spike - 1.0) / (spike + gamma - 1.0))
+        else:
+            rhos.append(1.0)
+    signal_ct = sum(1 for rho in rhos if (rho is not None) and (rho < 1.0))
+    if signal_ct < cmd_args.signal_ct:
+        compare_util.fail('Expected at least ' + str(cmd_args.signal_ct) + ' PCs above the detection threshold, found ' + str(signal_ct) + '.')
+    header1, plain_rows = compare_util.read_report(cmd_args.plain)
+    header2, shrunk_rows = compare_util.read_report(cmd_args.shrunk)
+    if header1 != header2:
+        compare_util.fail('Header mismatch.')
+    first_pc_col = header1.index('PC1')
+    if len(header1) - first_pc_col != len(rhos):
+        compare_util.fail('PC count mismatch.')
+    if len(plain_rows) != len(shrunk_rows):
+        compare_util.fail('Sample count mismatch.')
+    for pc_idx, rho in enumerate(rhos):
+        if rho is None:
+            continue
+        col_idx = first_pc_col + pc_idx
+        absdiff_sum = 0.0
+        abs_sum = 0.0
+        for row1, row2 in zip(plain_rows, shrunk_rows):
+            if row1[:first_pc_col] != row2[:first_pc_col]:
+                compare_util.fail('Sample ID mismatch.')
+            val1 = float(row1[col_idx])
+            absdiff_sum += abs(float(row2[col_idx]) * rho - val1)
+            abs_sum += abs(val1)
+        if not compare_util.rel_close(absdiff_sum, 0.0, cmd_args.tolerance, abs_sum):
+            compare_util.fail('PC' + str(pc_idx + 1) + ' shrinkage mismatch (expected factor ' + str(rho) + ').')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+This simulates a VCF with three populations for the --pca stream tests.
+Population allele frequencies are drawn around a shared ancestral frequency,
+so the top two principal components are well separated from the rest.
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=300,
+                        help="Number of samples (split evenly between populations).")
+    parser.add_argument('-m', '--variants', type=int, default=3000,
+                        help="Number of variants.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        for vidx in range(cmd_args.variants):
+            anc_freq = rng.uniform(0.1, 0.9)
+            pop_freqs = [min(0.99, max(0.01, anc_freq + rng.gauss(0.0, 0.1))) for _ in range(3)]
+            gts = []
+            for sample_idx in range(sample_ct):
+                freq = pop_freqs[sample_idx % 3]
+                if rng.random() < 0.01:
+                    gts.append('./.')
+                else:
+                    gts.append('{}/{}'.format(int(rng.random() < freq), int(rng.random() < freq)))
+            vcf_file.write('1\t{}\tv{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(1000 + 10 * vidx, vidx, '\t'.join(gts)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""
+This checks one set of --pca results against another: eigenvalues must agree
+to within the given relative tolerance, and each eigenvector must match up to
+sign, with |correlation| of at least 1 - tolerance.  (The approximate
+algorithm scales eigenvalues slightly differently from the exact one, so
+eigenvalues should only be compared between two approximate runs.)
+"""
+
+import math
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-1', '--first', type=str, required=True,
+                             help="First --pca output prefix.")
+    requiredarg.add_argument('-2', '--second', type=str, required=True,
+                             help="Second --pca output prefix.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-3,
+                        help="Relative tolerance.")
+    parser.add_argument('--eigenvec-only', action='store_true',
+                        help="Skip the eigenvalue comparison.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def read_eigenvecs(fname):
+    header, rows = compare_util.read_report(fname)
+    first_pc_col = header.index('PC1')
+    return [[row[0] for row in rows]] + [[float(row[col_idx]) for row in rows] for col_idx in range(first_pc_col, len(header))]
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    if not cmd_args.eigenvec_only:
+        with open(cmd_args.first + '.eigenval', 'r') as eigenval_file:
+            first_eigenvals = [float(line) for line in eigenval_file]
+        with open(cmd_args.second + '.eigenval', 'r') as eigenval_file:
+            second_eigenvals = [float(line) for line in eigenval_file]
+        if len(first_eigenvals) != len(second_eigenvals):
+            compare_util.fail('Eigenvalue count mismatch.')
+        for pc_idx, (first_val, second_val) in enumerate(zip(first_eigenvals, second_eigenvals)):
+            if not compare_util.rel_close(first_val, second_val, cmd_args.tolerance, first_val):
+                compare_util.fail('PC' + str(pc_idx + 1) + ' eigenvalue mismatch: ' + str(first_val) + ' vs. ' + str(second_val) + '.')
+    first_cols = read_eigenvecs(cmd_args.first + '.eigenvec')
+    second_cols = read_eigenvecs(cmd_args.second + '.eigenvec')
+    if len(first_cols) != len(second_cols):
+        compare_util.fail('PC count mismatch.')
+    if first_cols[0] != second_cols[0]:
+        compare_util.fail('Sample ID mismatch.')
+    for pc_idx, (first_vec, second_vec) in enumerate(zip(first_cols[1:], second_cols[1:])):
+        dot = sum(x * y for x, y in zip(first_vec, second_vec))
+        norm_product = math.sqrt(sum(x * x for x in first_vec) * sum(y * y for y in second_vec))
+        if abs(dot) < (1.0 - cmd_args.tolerance) * norm_product:
+            compare_util.fail('PC' + str(pc_idx + 1) + ' eigenvector mismatch (|correlation| ' + str(abs(dot) / norm_product) + ').')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Three populations, so PC1 and PC2 are well separated from the noise PCs.
+python3 make_vcf.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-pgen --out tmp_data
+$1/plink2 $2 $3 --pfile tmp_data --pca 2 --out tmp_exact
+$1/plink2 $2 $3 --pfile tmp_data --pca 2 approx --out tmp_approx
+# "stream" replaces the in-memory approx solver, and should converge to the
+# same subspace.  Eigenvalues are only comparable with the other approximate
+# run, since both scale them the same way; eigenvectors must also match the
+# exact solver's.
+for opts in "" "iters=20" "block-size=4" "iters=25 block-size=16"; do
+  $1/plink2 $2 $3 --pfile tmp_data --pca 2 stream $opts --out tmp_stream
+  python3 pca_compare.py -1 tmp_approx -2 tmp_stream
+  python3 pca_compare.py -1 tmp_exact -2 tmp_stream --eigenvec-only
+done
@@ -0,0 +1,13 @@
+#!/usr/bin/env python3
+"""
+Flips one bit in the last byte of the given file, which is always inside the
+final .pgen variant record (never the header).
+"""
+
+import sys
+
+with open(sys.argv[1], 'r+b') as pgen_file:
+    pgen_file.seek(-1, 2)
+    last_byte = pgen_file.read(1)[0]
+    pgen_file.seek(-1, 2)
+    pgen_file.write(bytes([last_byte ^ 1]))
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+set -exo pipefail
+
+$1/plink2 $2 $3 --dummy 100 70000 0.05 acgt dosage-freq=0.1 --seed 1 --out tmp_data
+
+# intact file verifies, and --validate agrees
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen cksum --out tmp_ck
+test -f tmp_ck.pgen.cksum
+$1/plink2 $2 $3 --pfile tmp_ck --pgen-verify --validate --out tmp_verify
+
+# a single flipped bit must be detected, both with and without mmap.  (The
+# sidecar is copied last since bit rot, unlike a rewrite, doesn't update the
+# .pgen's modification time.)
+cp tmp_ck.pgen tmp_bad.pgen
+python3 corrupt.py tmp_bad.pgen
+cp tmp_ck.pgen.cksum tmp_bad.pgen.cksum
+cp tmp_ck.pvar tmp_bad.pvar
+cp tmp_ck.psam tmp_bad.psam
+if $1/plink2 $2 $3 --pfile tmp_bad --pgen-verify --validate --out tmp_verify_bad; then
+    exit 1
+fi
+grep -q "Checksum mismatch" tmp_verify_bad.log
+if $1/plink2 $2 $3 --pfile tmp_bad --pgen-verify --pgen-mmap --validate --out tmp_verify_bad2; then
+    exit 1
+fi
+grep -q "Checksum mismatch" tmp_verify_bad2.log
+
+# --pgen-verify requires the sidecar
+$1/plink2 $2 $3 --pfile tmp_data --make-pgen --out tmp_nock
+if $1/plink2 $2 $3 --pfile tmp_nock --pgen-verify --validate --out tmp_verify_nock; then
+    exit 1
+fi
+
+# rewriting a .pgen without 'cksum' removes the old sidecar
+$1/plink2 $2 $3 --pfile tmp_data --thin-count 5000 --seed 2 --make-pgen --out tmp_ck
+test ! -e tmp_ck.pgen.cksum
+$1/plink2 $2 $3 --pfile tmp_ck --validate --out tmp_verify_rewrite
+
+# same variant count, .pgen size, and variant index, different contents
+$1/plink2 $2 $3 --dummy 200 3000 0 --seed 1 --make-pgen cksum --out tmp_same
+$1/plink2 $2 $3 --dummy 200 3000 0 --seed 2 --make-pgen --out tmp_same
+test ! -e tmp_same.pgen.cksum
+$1/plink2 $2 $3 --pfile tmp_same --validate --out tmp_verify_same
+
+# if some other program overwrites the .pgen and leaves the sidecar behind, it
+# must be recognized as stale rather than reported as corruption: --validate
+# skips it with a warning, while --pgen-verify rejects it
+$1/plink2 $2 $3 --dummy 200 3000 0 --seed 1 --make-pgen cksum --out tmp_same
+$1/plink2 $2 $3 --dummy 200 3000 0 --seed 2 --make-pgen --out tmp_same2
+cp tmp_same2.pgen tmp_same.pgen
+$1/plink2 $2 $3 --pfile tmp_same --validate --out tmp_verify_same2
+grep -q "Ignoring stale" tmp_verify_same2.log
+if $1/plink2 $2 $3 --pfile tmp_same --pgen-verify --validate --out tmp_verify_same3; then
+    exit 1
+fi
+grep -q "stale checksums" tmp_verify_same3.log
+
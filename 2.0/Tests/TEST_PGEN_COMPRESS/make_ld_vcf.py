@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+This simulates a VCF with strong LD between neighboring variants, so that
+most .pgen records are LD-compressed and pgen_compress's LD-base lookahead has
+choices to make.  Variants come in runs; each variant's haplotypes are copies
+of the previous variant's, with a small fraction flipped.  (--dummy can't be
+used here since its variants are independent.)
+"""
+
+import argparse
+import random
+
+def parse_commandline_args():
+    """
+    Standard command-line parser.
+    """
+    parser = argparse.ArgumentParser(description=__doc__)
+    requiredarg = parser.add_argument_group('Required Arguments')
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output filename.")
+    parser.add_argument('-n', '--samples', type=int, default=333,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=5000,
+                        help="Number of variants.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    hap_ct = 2 * cmd_args.samples
+    with open(cmd_args.out, 'w') as vcf_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join('s{}'.format(i) for i in range(cmd_args.samples)) + '\n')
+        haps = []
+        run_left = 0
+        for vidx in range(cmd_args.variants):
+            if run_left == 0:
+                run_left = rng.randint(5, 60)
+                freq = rng.uniform(0.05, 0.5)
+                haps = [int(rng.random() < freq) for _ in range(hap_ct)]
+                flip_prob = rng.uniform(0.002, 0.05)
+            else:
+                haps = [hap ^ int(rng.random() < flip_prob) for hap in haps]
+            run_left -= 1
+            gts = []
+            for sample_idx in range(cmd_args.samples):
+                if rng.random() < 0.01:
+                    gts.append('./.')
+                else:
+                    gts.append('{}/{}'.format(haps[2 * sample_idx], haps[2 * sample_idx + 1]))
+            vcf_file.write('1\t{}\tv{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(1000 + 10 * vidx, vidx, '\t'.join(gts)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# 140000 variants, so that there are multiple vblocks for the threads to split
+python3 make_ld_vcf.py -n 100 -m 140000 -o tmp_data.vcf
+$1/plink2 $2 $3 --vcf tmp_data.vcf --make-bed --out tmp_data
+
+# Each -l setting picks LD bases differently, and multithreaded runs encode
+# vblocks independently; all must decode back to the input genotypes.
+for l in 0 1 8 64
+do
+    for t in 1 3
+    do
+        $1/pgen_compress -t $t -l $l tmp_data.bed tmp_data_l${l}_t$t.pgen 100
+        $1/pgen_compress -u tmp_data_l${l}_t$t.pgen tmp_data_l${l}_t$t.bed
+        diff -q tmp_data.bed tmp_data_l${l}_t$t.bed
+        cp tmp_data.bim tmp_data_l${l}_t$t.bim
+        cp tmp_data.fam tmp_data_l${l}_t$t.fam
+        $1/plink2 $2 $3 --bpfile tmp_data_l${l}_t$t --make-bed --out tmp_plink2_l${l}_t$t
+        diff -q tmp_data.bed tmp_plink2_l${l}_t$t.bed
+    done
+    diff -q tmp_data_l${l}_t1.pgen tmp_data_l${l}_t3.pgen
+done
+
+# -l 0 is the default.
+$1/pgen_compress tmp_data.bed tmp_data_default.pgen 100
+diff -q tmp_data_l0_t1.pgen tmp_data_default.pgen
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Several 65536-variant read blocks, so the mapping is advanced past block
+# boundaries.  The dosage file exercises variable-width records; the .bed is
+# read through the fixed-width path.
+$1/plink2 $2 $3 --dummy 300 150000 0.02 scalar-pheno pheno-ct=2 dosage-freq=0.1 --seed 7 --out tmp_qt
+$1/plink2 $2 $3 --dummy 300 150000 0.02 --seed 8 --make-bed --out tmp_cc
+
+# Output must not depend on --pgen-mmap.
+for m in 0 1
+do
+    if [ "$m" = "1" ]; then
+        flag=--pgen-mmap
+    else
+        flag=
+    fi
+    $1/plink2 $2 $3 --pfile tmp_qt --freq --out tmp_qt_freq_$m $flag
+    $1/plink2 $2 $3 --pfile tmp_qt --glm allow-no-covars --out tmp_qt_$m $flag
+    $1/plink2 $2 $3 --bfile tmp_cc --freq --out tmp_cc_freq_$m $flag
+    $1/plink2 $2 $3 --bfile tmp_cc --glm allow-no-covars firth-fallback --out tmp_cc_$m $flag
+done
+diff -q tmp_qt_freq_0.afreq tmp_qt_freq_1.afreq
+diff -q tmp_cc_freq_0.afreq tmp_cc_freq_1.afreq
+for i in 1 2
+do
+    diff -q tmp_qt_0.PHENO$i.glm.linear tmp_qt_1.PHENO$i.glm.linear
+done
+diff -q tmp_cc_0.PHENO1.glm.logistic.hybrid tmp_cc_1.PHENO1.glm.logistic.hybrid
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# VCF-derived .pvar, with QUAL/FILTER/INFO columns.
+$1/plink2 $2 $3 --vcf ../TEST_PHASED_VCF/1kg_phase3_chr21_start.vcf.gz --make-pgen --out tmp_vcf
+
+# Several chromosomes (including X/Y/MT) and a CM column.  This .pvar is
+# larger than 128 KiB, so an edit in the middle isn't covered by the
+# first/last 64 KiB hashes.
+$1/plink2 $2 $3 --dummy 50 20000 acgt --seed 1 --out tmp_dummy
+awk 'BEGIN {OFS="\t"} NR == 1 {print $0, "CM"; next} {c = (NR < 8000)? 1 : ((NR < 14000)? 2 : ((NR < 18000)? "X" : ((NR < 19000)? "Y" : "MT"))); $1 = c; print $0, NR * 0.01}' tmp_dummy.pvar > tmp_dummy_cm.pvar
+mv tmp_dummy_cm.pvar tmp_dummy.pvar
+
+# Every output must be identical to the text parse's whether the .pcache is
+# being written or read.
+for f in tmp_vcf tmp_dummy
+do
+    rm -f $f.pvar.pcache
+    $1/plink2 $2 $3 --pfile $f --make-just-pvar --out ${f}_ref
+    $1/plink2 $2 $3 --pfile $f --chr 2,21 --make-just-pvar --out ${f}_ref_chr
+    $1/plink2 $2 $3 --pfile $f --freq --out ${f}_ref
+    $1/plink2 $2 $3 --pfile $f --pvar-cache --make-just-pvar --out ${f}_write
+    test -f $f.pvar.pcache
+    diff -q ${f}_ref.pvar ${f}_write.pvar
+    $1/plink2 $2 $3 --pfile $f --make-just-pvar --out ${f}_cached
+    grep -q "loaded from $f.pvar.pcache" ${f}_cached.log
+    $1/plink2 $2 $3 --pfile $f --chr 2,21 --make-just-pvar --out ${f}_cached_chr
+    $1/plink2 $2 $3 --pfile $f --freq --out ${f}_cached
+    diff -q ${f}_ref.pvar ${f}_cached.pvar
+    diff -q ${f}_ref_chr.pvar ${f}_cached_chr.pvar
+    diff -q ${f}_ref.afreq ${f}_cached.afreq
+done
+
+# A stale .pcache must be ignored: rename one variant in the middle of the
+# file without changing its size.  (The modification time is only compared
+# to the second, so set it explicitly.)
+cp -p tmp_dummy.pvar tmp_dummy_orig.pvar
+sed -i 's/\tsnp10000\t/\tsnq10000\t/' tmp_dummy.pvar
+touch -t 200001010000 tmp_dummy.pvar
+$1/plink2 $2 $3 --pfile tmp_dummy --make-just-pvar --out tmp_stale
+if grep -q "loaded from tmp_dummy.pvar.pcache" tmp_stale.log; then
+    exit 1
+fi
+diff -q tmp_dummy.pvar tmp_stale.pvar
+
+# If the modification time is also restored, only 'full-hash' catches the
+# edit.
+cp -p tmp_dummy_orig.pvar tmp_dummy.pvar
+$1/plink2 $2 $3 --pfile tmp_dummy --pvar-cache full-hash --make-just-pvar --out tmp_full_write
+grep -q "tmp_dummy.pvar.pcache written" tmp_full_write.log
+$1/plink2 $2 $3 --pfile tmp_dummy --make-just-pvar --out tmp_full_cached
+grep -q "loaded from tmp_dummy.pvar.pcache" tmp_full_cached.log
+diff -q tmp_dummy_ref.pvar tmp_full_cached.pvar
+sed -i 's/\tsnp10000\t/\tsnq10000\t/' tmp_dummy.pvar
+touch -r tmp_dummy_orig.pvar tmp_dummy.pvar
+$1/plink2 $2 $3 --pfile tmp_dummy --make-just-pvar --out tmp_full_stale
+if grep -q "loaded from tmp_dummy.pvar.pcache" tmp_full_stale.log; then
+    exit 1
+fi
+diff -q tmp_dummy.pvar tmp_full_stale.pvar
+
+# No .pcache is written when variant-content filters are active.
+rm -f tmp_dummy.pvar.pcache
+$1/plink2 $2 $3 --pfile tmp_dummy --pvar-cache --snps-only --make-just-pvar --out tmp_filtered
+test ! -f tmp_dummy.pvar.pcache
@@ -0,0 +1,89 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Three chromosomes: chr1 spans several 65536-variant frames, chr2 is tiny,
+# and chr3 spans two frames.  Some variants are multiallelic.
+awk 'BEGIN {
+    OFS = "\t";
+    print "#CHROM", "POS", "ID", "REF", "ALT";
+    split("150000 5 70000", chr_cts, " ");
+    for (c = 1; c <= 3; ++c) {
+        for (i = 0; i < chr_cts[c]; ++i) {
+            alt = (i % 97 == 3)? "C,G" : ((i % 1009 == 7)? "C,G,T" : "C");
+            print c, 1000 + 10 * i, "v" c "_" i, "A", alt;
+        }
+    }
+}' > tmp_data.pvar
+$1/plink2 $2 $3 --pvar tmp_data.pvar --make-just-pvar zs vidx --out tmp_indexed
+test -f tmp_indexed.pvar.zst.vidx
+
+# Each filter must produce the same variant set from the indexed .pvar.zst as
+# from the plain-text original.  Both bp ranges straddle frame boundaries.
+for f in tmp_data.pvar tmp_indexed.pvar.zst
+do
+    if [ "$f" = "tmp_data.pvar" ]; then
+        o=ref
+    else
+        o=idx
+    fi
+    $1/plink2 $2 $3 --pvar $f --make-just-pvar --out tmp_${o}_all
+    $1/plink2 $2 $3 --pvar $f --chr 2 --make-just-pvar --out tmp_${o}_chr2
+    $1/plink2 $2 $3 --pvar $f --chr 1,3 --make-just-pvar --out tmp_${o}_chr13
+    $1/plink2 $2 $3 --pvar $f --not-chr 1 --make-just-pvar --out tmp_${o}_notchr1
+    $1/plink2 $2 $3 --pvar $f --chr 1 --from-bp 600000 --to-bp 1400000 --make-just-pvar --out tmp_${o}_range
+    $1/plink2 $2 $3 --pvar $f --chr 3 --from-bp 656350 --to-bp 656360 --make-just-pvar --out tmp_${o}_edge
+done
+for f in all chr2 chr13 notchr1 range edge
+do
+    diff -q tmp_ref_$f.pvar tmp_idx_$f.pvar
+done
+
+# An index belonging to a different file must be ignored.
+$1/plink2 $2 $3 --pvar tmp_data.pvar --chr 1,2 --make-just-pvar zs vidx --out tmp_other
+cp tmp_other.pvar.zst.vidx tmp_indexed.pvar.zst.vidx
+$1/plink2 $2 $3 --pvar tmp_indexed.pvar.zst --chr 1,3 --make-just-pvar --out tmp_stale
+grep -q "doesn't match the current" tmp_stale.log
+diff -q tmp_ref_chr13.pvar tmp_stale.pvar
+
+# Same for a same-size, same-mtime edit.  This .pvar.zst is smaller than the
+# hashed head span, so renaming one ID must be detected; random-looking IDs
+# keep the compressed size stable, but it still depends on the new ID, so the
+# rename is chosen by trying digit substitutions until the size matches.
+awk 'BEGIN {
+    OFS = "\t";
+    print "#CHROM", "POS", "ID", "REF", "ALT";
+    x = 7;
+    for (i = 0; i < 2000; ++i) {
+        x = (x * 48271) % 2147483647;
+        print 1, 1000 + 10 * i, "rs" (100000000 + x % 900000000), "A", "C";
+    }
+}' > tmp_small.pvar
+$1/plink2 $2 $3 --pvar tmp_small.pvar --make-just-pvar zs vidx --out tmp_small
+small_size=$(wc -c < tmp_small.pvar.zst)
+new_id=
+for line in 1000 1500 1900
+do
+    old_id=$(sed -n ${line}p tmp_small.pvar | cut -f 3)
+    for d in 0 1 2 3 4 5 6 7 8 9
+    do
+        cand_id=${old_id%?}$d
+        if [ "$cand_id" = "$old_id" ]; then
+            continue
+        fi
+        sed "${line}s/\t${old_id}\t/\t${cand_id}\t/" tmp_small.pvar > tmp_renamed.pvar
+        $1/plink2 $2 $3 --pvar tmp_renamed.pvar --make-just-pvar zs vidx --out tmp_renamed
+        if [ "$(wc -c < tmp_renamed.pvar.zst)" -eq "$small_size" ]; then
+            new_id=$cand_id
+            break 2
+        fi
+    done
+done
+test -n "$new_id"
+touch -r tmp_small.pvar.zst tmp_mtime_ref
+cp tmp_renamed.pvar.zst tmp_small.pvar.zst
+touch -r tmp_mtime_ref tmp_small.pvar.zst
+$1/plink2 $2 $3 --pvar tmp_small.pvar.zst --make-just-pvar --out tmp_small_stale
+grep -q "doesn't match the current" tmp_small_stale.log
+$1/plink2 $2 $3 --pvar tmp_renamed.pvar --make-just-pvar --out tmp_renamed_ref
+diff -q tmp_renamed_ref.pvar tmp_small_stale.pvar
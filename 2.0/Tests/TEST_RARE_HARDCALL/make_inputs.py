@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+This simulates inputs for the rare-variant hardcall tests: a VCF on two
+autosomes where most variants are rare enough to be stored as difflists in a
+.pgen file (a few with missing calls), a quantitative phenotype and
+covariate, and a --score file with one ALT-allele and one REF-allele column.
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-o', '--out', type=str, required=True,
+                             help="Output prefix.")
+    parser.add_argument('-n', '--samples', type=int, default=2000,
+                        help="Number of samples.")
+    parser.add_argument('-m', '--variants', type=int, default=300,
+                        help="Number of variants per chromosome.")
+    parser.add_argument('-s', '--seed', type=int, default=1,
+                        help="Random seed.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    rng = random.Random(cmd_args.seed)
+    sample_ct = cmd_args.samples
+    iids = ['s{}'.format(i) for i in range(sample_ct)]
+    cov1 = [rng.gauss(0.0, 1.0) for _ in range(sample_ct)]
+    qt = [0.5 * val + rng.gauss(0.0, 1.0) for val in cov1]
+    with open(cmd_args.out + '.vcf', 'w') as vcf_file, open(cmd_args.out + '.score', 'w') as score_file:
+        vcf_file.write('##fileformat=VCFv4.2\n')
+        vcf_file.write('##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">\n')
+        vcf_file.write('#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t' + '\t'.join(iids) + '\n')
+        score_file.write('ID\tA1\tALT_SCORE\tREF_SCORE\n')
+        for chrom in (1, 2):
+            for vidx in range(cmd_args.variants):
+                if rng.random() < 0.8:
+                    freq = rng.uniform(0.0005, 0.01)
+                else:
+                    freq = rng.uniform(0.05, 0.5)
+                alleles = [(int(rng.random() < freq), int(rng.random() < freq)) for _ in range(sample_ct)]
+                missing_rate = 0.002 if rng.random() < 0.05 else 0.0
+                gts = ['./.' if rng.random() < missing_rate else '{}/{}'.format(a1, a2) for a1, a2 in alleles]
+                variant_id = 'v{}_{}'.format(chrom, vidx)
+                vcf_file.write('{}\t{}\t{}\tA\tC\t.\tPASS\t.\tGT\t{}\n'.format(chrom, 1000 + 10 * vidx, variant_id, '\t'.join(gts)))
+                # every tenth variant is scored on its REF allele instead
+                if vidx % 10:
+                    score_file.write('{}\tC\t{:.6f}\t0\n'.format(variant_id, rng.gauss(0.0, 1.0)))
+                else:
+                    score_file.write('{}\tA\t0\t{:.6f}\n'.format(variant_id, rng.gauss(0.0, 1.0)))
+                if rng.random() < 0.02:
+                    effect = rng.gauss(0.0, 2.0)
+                    for sample_idx, (a1, a2) in enumerate(alleles):
+                        qt[sample_idx] += effect * (a1 + a2)
+    with open(cmd_args.out + '.pheno', 'w') as pheno_file:
+        pheno_file.write('#FID\tIID\tQT\tCOV1\n')
+        for iid, qt_val, cov_val in zip(iids, qt, cov1):
+            pheno_file.write('{}\t{}\t{:.6f}\t{:.6f}\n'.format(iid, iid, qt_val, cov_val))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+This checks that two tab-delimited reports have the same header and the same
+rows, with numeric fields (other than those in the key columns) agreeing to
+within the given relative tolerance.  Values smaller in magnitude than the
+absolute floor are compared against the floor instead, since near-zero
+statistics are dominated by summation-order rounding error.
+"""
+
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import compare_util
+
+def parse_commandline_args():
+    parser, requiredarg = compare_util.new_parser(__doc__)
+    requiredarg.add_argument('-a', '--first', type=str, required=True,
+                             help="First report.")
+    requiredarg.add_argument('-b', '--second', type=str, required=True,
+                             help="Second report.")
+    parser.add_argument('-t', '--tolerance', type=float, default=1e-5,
+                        help="Relative tolerance.")
+    parser.add_argument('-f', '--floor', type=float, default=1e-8,
+                        help="Absolute floor for the tolerance scale.")
+    cmd_args = parser.parse_args()
+    return cmd_args
+
+
+def main():
+    cmd_args = parse_commandline_args()
+    header1, rows1 = compare_util.read_report(cmd_args.first)
+    header2, rows2 = compare_util.read_report(cmd_args.second)
+    if header1 != header2:
+        compare_util.fail('Header line mismatch.')
+    if (len(rows1) != len(rows2)) or (not rows1):
+        compare_util.fail('Row count mismatch.')
+    for line_idx, (row1, row2) in enumerate(zip(rows1, rows2), 2):
+        for col_name, val1, val2 in zip(header1, row1, row2):
+            if val1 == val2:
+                continue
+            try:
+                fval1 = float(val1)
+                fval2 = float(val2)
+            except ValueError:
+                compare_util.fail(col_name + ' mismatch on line ' + str(line_idx) + ': ' + val1 + ' vs. ' + val2 + '.')
+            scale = max(abs(fval1), abs(fval2), cmd_args.floor)
+            if not compare_util.rel_close(fval1, fval2, cmd_args.tolerance, scale):
+                compare_util.fail(col_name + ' mismatch on line ' + str(line_idx) + ': ' + val1 + ' vs. ' + val2 + '.')
+
+
+if __name__ == '__main__':
+    main()
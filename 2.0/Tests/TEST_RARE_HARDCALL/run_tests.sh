@@ -0,0 +1,22 @@
+#!/bin/bash
+
+set -exo pipefail
+
+# Rare hardcalls are read as difflists from the .pgen file by --glm linear and
+# --score; the .bed copy of the same genotypes always takes the dense path.
+# Results must agree to within floating-point summation error.
+python3 make_inputs.py -o tmp_data
+$1/plink2 $2 $3 --vcf tmp_data.vcf --double-id --make-bed --out tmp_data_bed
+$1/plink2 $2 $3 --bfile tmp_data_bed --make-pgen --out tmp_data
+awk 'NR > 1 && NR % 4 != 0 {print $1, $2}' tmp_data.pheno > tmp_data.keep
+
+for keep in "" "--keep tmp_data.keep"
+do
+    $1/plink2 $2 $3 --pfile tmp_data $keep --pheno tmp_data.pheno --pheno-name QT --covar tmp_data.pheno --covar-name COV1 --glm hide-covar --out tmp_pgen
+    $1/plink2 $2 $3 --bfile tmp_data_bed $keep --pheno tmp_data.pheno --pheno-name QT --covar tmp_data.pheno --covar-name COV1 --glm hide-covar --out tmp_bed
+    python3 report_compare.py -a tmp_pgen.QT.glm.linear -b tmp_bed.QT.glm.linear
+
+    $1/plink2 $2 $3 --pfile tmp_data $keep --score tmp_data.score 1 2 header-read cols=+scoresums --score-col-nums 3-4 --out tmp_pgen
+    $1/plink2 $2 $3 --bfile tmp_data_bed $keep --score tmp_data.score 1 2 header-read cols=+scoresums --score-col-nums 3-4 --out tmp_bed
+    python3 report_compare.py -a tmp_pgen.sscore -b tmp_bed.sscore
+done
@@ -0,0 +1,58 @@
+"""
+Shared helpers for the TEST_*/ comparison scripts.  Each script puts this
+directory on sys.path before importing it.
+"""
+
+import argparse
+import array
+import sys
+
+def new_parser(description):
+    """
+    Standard command-line parser.  Returns (parser, required-argument group).
+    """
+    parser = argparse.ArgumentParser(description=description)
+    return parser, parser.add_argument_group('Required Arguments')
+
+
+# See https://stackoverflow.com/questions/5574702/how-to-print-to-stderr-in-python .
+def eprint(*args):
+    print(*args, file=sys.stderr)
+
+
+def fail(msg):
+    eprint(msg)
+    sys.exit(1)
+
+
+def read_report(fname, as_dicts=False):
+    """
+    Reads a tab-delimited file with a header line.  Returns (header, rows),
+    where rows are field lists, or header->field dicts when as_dicts is set.
+    """
+    with open(fname, 'r') as report_file:
+        header = report_file.readline().rstrip('\n').split('\t')
+        rows = [line.rstrip('\n').split('\t') for line in report_file]
+    if as_dicts:
+        rows = [dict(zip(header, row)) for row in rows]
+    return header, rows
+
+
+def read_doubles(fname):
+    """
+    Reads a native-endian binary float64 array, e.g. a .rel.bin file.
+    """
+    vals = array.array('d')
+    with open(fname, 'rb') as bin_file:
+        vals.frombytes(bin_file.read())
+    return vals
+
+
+def rel_close(val1, val2, tol, scale=None):
+    """
+    True iff |val1 - val2| <= tol * scale, where scale defaults to
+    max(|val1|, |val2|).
+    """
+    if scale is None:
+        scale = max(abs(val1), abs(val2))
+    return abs(val1 - val2) <= tol * scale
@@ -48,4 +48,119 @@ cd TEST_DOSAGE_ROUND_TRIP
 cd ..
 echo "TEST_DOSAGE_ROUND_TRIP passed."
 
+cd TEST_GLM_PREFETCH
+./run_tests.sh $d $2 $3 > TEST_GLM_PREFETCH.log
+cd ..
+echo "TEST_GLM_PREFETCH passed."
+
+cd TEST_PGEN_COMPRESS
+./run_tests.sh $d $2 $3 > TEST_PGEN_COMPRESS.log
+cd ..
+echo "TEST_PGEN_COMPRESS passed."
+
+cd TEST_PVAR_VIDX
+./run_tests.sh $d $2 $3 > TEST_PVAR_VIDX.log
+cd ..
+echo "TEST_PVAR_VIDX passed."
+
+cd TEST_PVAR_CACHE
+./run_tests.sh $d $2 $3 > TEST_PVAR_CACHE.log
+cd ..
+echo "TEST_PVAR_CACHE passed."
+
+cd TEST_PGEN_MMAP
+./run_tests.sh $d $2 $3 > TEST_PGEN_MMAP.log
+cd ..
+echo "TEST_PGEN_MMAP passed."
+
+cd TEST_GLM_LOGISTIC_BATCH
+./run_tests.sh $d $2 $3 > TEST_GLM_LOGISTIC_BATCH.log
+cd ..
+echo "TEST_GLM_LOGISTIC_BATCH passed."
+
+cd TEST_GLM_CHECKPOINT
+./run_tests.sh $d $2 $3 > TEST_GLM_CHECKPOINT.log
+cd ..
+echo "TEST_GLM_CHECKPOINT passed."
+
+cd TEST_RARE_HARDCALL
+./run_tests.sh $d $2 $3 > TEST_RARE_HARDCALL.log
+cd ..
+echo "TEST_RARE_HARDCALL passed."
+
+cd TEST_FST_SUBSETS
+./run_tests.sh $d $2 $3 > TEST_FST_SUBSETS.log
+cd ..
+echo "TEST_FST_SUBSETS passed."
+
+cd TEST_DENSE_DOSAGE
+./run_tests.sh $d $2 $3 > TEST_DENSE_DOSAGE.log
+cd ..
+echo "TEST_DENSE_DOSAGE passed."
+
+cd TEST_PGEN_CKSUM
+./run_tests.sh $d $2 $3 > TEST_PGEN_CKSUM.log
+cd ..
+echo "TEST_PGEN_CKSUM passed."
+
+cd TEST_GLM_SCORE_SCREEN
+./run_tests.sh $d $2 $3 > TEST_GLM_SCORE_SCREEN.log
+cd ..
+echo "TEST_GLM_SCORE_SCREEN passed."
+
+cd TEST_GLM_LINEAR_BLOCK
+./run_tests.sh $d $2 $3 > TEST_GLM_LINEAR_BLOCK.log
+cd ..
+echo "TEST_GLM_LINEAR_BLOCK passed."
+
+cd TEST_GLM_LOCO_RIDGE
+./run_tests.sh $d $2 $3 > TEST_GLM_LOCO_RIDGE.log
+cd ..
+echo "TEST_GLM_LOCO_RIDGE passed."
+
+cd TEST_GLM_FIRTH_WARM
+./run_tests.sh $d $2 $3 > TEST_GLM_FIRTH_WARM.log
+cd ..
+echo "TEST_GLM_FIRTH_WARM passed."
+
+cd TEST_GLM_STEPWISE
+./run_tests.sh $d $2 $3 > TEST_GLM_STEPWISE.log
+cd ..
+echo "TEST_GLM_STEPWISE passed."
+
+cd TEST_GLM_SET_TEST
+./run_tests.sh $d $2 $3 > TEST_GLM_SET_TEST.log
+cd ..
+echo "TEST_GLM_SET_TEST passed."
+
+cd TEST_GLM_HITS
+./run_tests.sh $d $2 $3 > TEST_GLM_HITS.log
+cd ..
+echo "TEST_GLM_HITS passed."
+
+cd TEST_GRM_SPARSE
+./run_tests.sh $d $2 $3 > TEST_GRM_SPARSE.log
+cd ..
+echo "TEST_GRM_SPARSE passed."
+
+cd TEST_KING_COUNTS
+./run_tests.sh $d $2 $3 > TEST_KING_COUNTS.log
+cd ..
+echo "TEST_KING_COUNTS passed."
+
+cd TEST_KING_SCREEN
+./run_tests.sh $d $2 $3 > TEST_KING_SCREEN.log
+cd ..
+echo "TEST_KING_SCREEN passed."
+
+cd TEST_PCA_STREAM
+./run_tests.sh $d $2 $3 > TEST_PCA_STREAM.log
+cd ..
+echo "TEST_PCA_STREAM passed."
+
+cd TEST_PCA_PROJECT
+./run_tests.sh $d $2 $3 > TEST_PCA_PROJECT.log
+cd ..
+echo "TEST_PCA_PROJECT passed."
+
 echo "All tests passed."
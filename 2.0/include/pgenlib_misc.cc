@@ -951,6 +951,41 @@ void GenoarrCountSubsetFreqs(const uintptr_t* __restrict genoarr, const uintptr_
   genocounts[3] = bothset_ct;
 }
 
+void GenoarrCountSubsetFreqsMulti(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict subset_interleaved_vecs, const uint32_t* __restrict subset_sizes, uint32_t raw_sample_ct, uint32_t subset_ct, uint32_t* __restrict genocounts_multi) {
+  // Same computation as calling GenoarrCountSubsetFreqs() once per subset,
+  // but genoarr is processed in tiles small enough to stay in L1 cache while
+  // all the subset masks are applied to it, so each genoarr vector is only
+  // loaded from memory once.
+  const uint32_t raw_sample_ctv2 = NypCtToVecCt(raw_sample_ct);
+  const uintptr_t subset_stride = BitCtToAlignedWordCt(raw_sample_ct);
+  ZeroU32Arr(4 * S_CAST(uintptr_t, subset_ct), genocounts_multi);
+  for (uint32_t tile_vec_start = 0; tile_vec_start < raw_sample_ctv2; tile_vec_start += kGenoarrCountMultiTileVecCt) {
+    uint32_t tile_sample_ct = raw_sample_ct - tile_vec_start * kNypsPerVec;
+    if (tile_sample_ct > kGenoarrCountMultiTileVecCt * kNypsPerVec) {
+      tile_sample_ct = kGenoarrCountMultiTileVecCt * kNypsPerVec;
+    }
+    const uintptr_t* tile_genoarr = &(genoarr[tile_vec_start * kWordsPerVec]);
+    // one interleaved mask vector covers two genoarr vectors
+    const uintptr_t* tile_interleaved_vec_iter = &(subset_interleaved_vecs[(tile_vec_start / 2) * kWordsPerVec]);
+    uint32_t* genocounts_iter = genocounts_multi;
+    for (uint32_t subset_idx = 0; subset_idx != subset_ct; ++subset_idx) {
+      STD_ARRAY_DECL(uint32_t, 4, tile_genocounts);
+      // tile_genocounts[0] is garbage since sample_ct isn't known here
+      GenoarrCountSubsetFreqs(tile_genoarr, tile_interleaved_vec_iter, tile_sample_ct, 0, tile_genocounts);
+      genocounts_iter[1] += tile_genocounts[1];
+      genocounts_iter[2] += tile_genocounts[2];
+      genocounts_iter[3] += tile_genocounts[3];
+      tile_interleaved_vec_iter = &(tile_interleaved_vec_iter[subset_stride]);
+      genocounts_iter = &(genocounts_iter[4]);
+    }
+  }
+  uint32_t* genocounts_iter = genocounts_multi;
+  for (uint32_t subset_idx = 0; subset_idx != subset_ct; ++subset_idx) {
+    genocounts_iter[0] = subset_sizes[subset_idx] - genocounts_iter[1] - genocounts_iter[2] - genocounts_iter[3];
+    genocounts_iter = &(genocounts_iter[4]);
+  }
+}
+
 void GenoarrCountSubsetFreqs2(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, STD_ARRAY_REF(uint32_t, 4) genocounts) {
   // slower GenoarrCountSubsetFreqs() which does not require
   // sample_include_interleaved_vec to be precomputed.
@@ -1755,6 +1790,84 @@ void InitLookup256x4bx4(void* table256x4bx4) {
   }
 }
 
+// Multiple of kBitsPerWord.  Small enough for a float or double batch to stay
+// in L1 cache between the lookup and the dosage overlay.
+CONSTI32(kDosageOverlayBatchSize, 2048);
+
+void Dosage16ToFloatsRescaled(const uintptr_t* genoarr, const uintptr_t* dosage_present, const uint16_t* dosage_main, float slope, float intercept, float missing_val, uint32_t sample_ct, uint32_t dosage_ct, float* __restrict result) {
+  float lookup_vals[32] ALIGNV16;
+  lookup_vals[0] = intercept;
+  lookup_vals[2] = intercept + slope;
+  lookup_vals[4] = intercept + 2 * slope;
+  lookup_vals[6] = missing_val;
+  InitLookup16x4bx2(lookup_vals);
+  const float dosage_slope = slope * S_CAST(float, 0.00006103515625);
+  const uint16_t* dosage_main_iter = dosage_main;
+  const uint16_t* dosage_main_end = &(dosage_main[dosage_ct]);
+  uint32_t batch_start = 0;
+  while (dosage_main_iter != dosage_main_end) {
+    const uint32_t batch_end = MINV(batch_start + kDosageOverlayBatchSize, sample_ct);
+    GenoarrLookup16x4bx2(&(genoarr[batch_start / kBitsPerWordD2]), lookup_vals, batch_end - batch_start, &(result[batch_start]));
+    const uint32_t widx_end = DivUp(batch_end, kBitsPerWord);
+    for (uint32_t widx = batch_start / kBitsPerWord; widx != widx_end; ++widx) {
+      uintptr_t dosage_present_word = dosage_present[widx];
+      float* result_base = &(result[widx * kBitsPerWord]);
+      while (dosage_present_word) {
+        const uint32_t sample_idx_lowbits = ctzw(dosage_present_word);
+        result_base[sample_idx_lowbits] = S_CAST(float, *dosage_main_iter++) * dosage_slope + intercept;
+        if (dosage_main_iter == dosage_main_end) {
+          break;
+        }
+        dosage_present_word &= dosage_present_word - 1;
+      }
+      if (dosage_main_iter == dosage_main_end) {
+        break;
+      }
+    }
+    batch_start = batch_end;
+  }
+  if (batch_start < sample_ct) {
+    GenoarrLookup16x4bx2(&(genoarr[batch_start / kBitsPerWordD2]), lookup_vals, sample_ct - batch_start, &(result[batch_start]));
+  }
+}
+
+void Dosage16ToDoublesRescaled(const uintptr_t* genoarr, const uintptr_t* dosage_present, const uint16_t* dosage_main, double slope, double intercept, double missing_val, uint32_t sample_ct, uint32_t dosage_ct, double* __restrict result) {
+  double lookup_vals[32] ALIGNV16;
+  lookup_vals[0] = intercept;
+  lookup_vals[2] = intercept + slope;
+  lookup_vals[4] = intercept + 2 * slope;
+  lookup_vals[6] = missing_val;
+  InitLookup16x8bx2(lookup_vals);
+  const double dosage_slope = slope * 0.00006103515625;
+  const uint16_t* dosage_main_iter = dosage_main;
+  const uint16_t* dosage_main_end = &(dosage_main[dosage_ct]);
+  uint32_t batch_start = 0;
+  while (dosage_main_iter != dosage_main_end) {
+    const uint32_t batch_end = MINV(batch_start + kDosageOverlayBatchSize, sample_ct);
+    GenoarrLookup16x8bx2(&(genoarr[batch_start / kBitsPerWordD2]), lookup_vals, batch_end - batch_start, &(result[batch_start]));
+    const uint32_t widx_end = DivUp(batch_end, kBitsPerWord);
+    for (uint32_t widx = batch_start / kBitsPerWord; widx != widx_end; ++widx) {
+      uintptr_t dosage_present_word = dosage_present[widx];
+      double* result_base = &(result[widx * kBitsPerWord]);
+      while (dosage_present_word) {
+        const uint32_t sample_idx_lowbits = ctzw(dosage_present_word);
+        result_base[sample_idx_lowbits] = S_CAST(double, *dosage_main_iter++) * dosage_slope + intercept;
+        if (dosage_main_iter == dosage_main_end) {
+          break;
+        }
+        dosage_present_word &= dosage_present_word - 1;
+      }
+      if (dosage_main_iter == dosage_main_end) {
+        break;
+      }
+    }
+    batch_start = batch_end;
+  }
+  if (batch_start < sample_ct) {
+    GenoarrLookup16x8bx2(&(genoarr[batch_start / kBitsPerWordD2]), lookup_vals, sample_ct - batch_start, &(result[batch_start]));
+  }
+}
+
 void PhaseLookup4b(const uintptr_t* genoarr, const uintptr_t* phasepresent, const uintptr_t* phaseinfo, const void* table56x4bx2, uint32_t sample_ct, void* __restrict result) {
   const uint64_t* table_alias = S_CAST(const uint64_t*, table56x4bx2);
   const uint32_t sample_ctl2_m1 = (sample_ct - 1) / kBitsPerWordD2;
@@ -2854,6 +2967,79 @@ void PglMultiallelicSparseToDenseMiss(const PgenVariant* pgvp, uint32_t sample_c
   }
 }
 
+#ifndef USE_SSE42
+static const uint32_t kCrc32cTable[256] = {
+  0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+  0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+  0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+  0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+  0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+  0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+  0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+  0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+  0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+  0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+  0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+  0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+  0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+  0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+  0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+  0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+  0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+  0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+  0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+  0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+  0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+  0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+  0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+  0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+  0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+  0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+  0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+  0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+  0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+  0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+  0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+  0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+  0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+  0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+  0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+  0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+  0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+  0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+  0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+  0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+  0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+  0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+  0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+#endif
+
+uint32_t Crc32c(uint32_t crc, const void* buf, uintptr_t byte_ct) {
+  const unsigned char* buf_iter = S_CAST(const unsigned char*, buf);
+  crc = ~crc;
+#ifdef USE_SSE42
+#  ifdef __LP64__
+  uint64_t crc64 = crc;
+  for (; byte_ct >= 8; byte_ct -= 8) {
+    uint64_t cur_word;
+    memcpy(&cur_word, buf_iter, 8);
+    crc64 = _mm_crc32_u64(crc64, cur_word);
+    buf_iter = &(buf_iter[8]);
+  }
+  crc = crc64;
+#  endif
+  for (; byte_ct; --byte_ct) {
+    crc = _mm_crc32_u8(crc, *buf_iter++);
+  }
+#else
+  for (; byte_ct; --byte_ct) {
+    crc = kCrc32cTable[(crc ^ (*buf_iter++)) & 0xff] ^ (crc >> 8);
+  }
+#endif
+  return ~crc;
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -242,6 +242,16 @@ void CountSubset3FreqVec6(const VecW* __restrict geno_vvec, const VecW* __restri
 // genoarr vector-alignment preferred.
 void GenoarrCountSubsetFreqs(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict sample_include_interleaved_vec, uint32_t raw_sample_ct, uint32_t sample_ct, STD_ARRAY_REF(uint32_t, 4) genocounts);
 
+// Must be even, and should be a multiple of 6.
+CONSTI32(kGenoarrCountMultiTileVecCt, 120);
+
+// GenoarrCountSubsetFreqs() for subset_ct subsets at once.
+// subset_interleaved_vecs is a sequence of subset_ct FillInterleavedMaskVec()
+// outputs, each BitCtToAlignedWordCt(raw_sample_ct) words long;
+// subset_sizes[] contains the corresponding subset sizes.
+// genocounts_multi[4k..4k+3] are filled with subset k's counts.
+void GenoarrCountSubsetFreqsMulti(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict subset_interleaved_vecs, const uint32_t* __restrict subset_sizes, uint32_t raw_sample_ct, uint32_t subset_ct, uint32_t* __restrict genocounts_multi);
+
 // slower GenoarrCountSubsetFreqs() which does not require
 // sample_include_interleaved_vec to be precomputed
 void GenoarrCountSubsetFreqs2(const uintptr_t* __restrict genoarr, const uintptr_t* __restrict sample_include, uint32_t raw_sample_ct, uint32_t sample_ct, STD_ARRAY_REF(uint32_t, 4) genocounts);
@@ -533,6 +543,16 @@ void InitLookup256x2bx4(void* table256x2bx4);
 
 void InitLookup256x4bx4(void* table256x4bx4);
 
+// Dense dosage expansion: hardcall g is mapped to (intercept + g * slope),
+// missing hardcalls to missing_val, and dosage_main[] entries d (in 1/16384
+// units) to (intercept + d * slope / 16384).  The dosage overlay is applied in
+// cache-sized batches immediately after the corresponding hardcall lookup,
+// instead of in a second pass over result[].
+// Trailing bits of dosage_present may be garbage.
+void Dosage16ToFloatsRescaled(const uintptr_t* genoarr, const uintptr_t* dosage_present, const uint16_t* dosage_main, float slope, float intercept, float missing_val, uint32_t sample_ct, uint32_t dosage_ct, float* __restrict result);
+
+void Dosage16ToDoublesRescaled(const uintptr_t* genoarr, const uintptr_t* dosage_present, const uint16_t* dosage_main, double slope, double intercept, double missing_val, uint32_t sample_ct, uint32_t dosage_ct, double* __restrict result);
+
 void PhaseLookup4b(const uintptr_t* genoarr, const uintptr_t* phasepresent, const uintptr_t* phaseinfo, const void* table56x4bx2, uint32_t sample_ct, void* result);
 
 // [0][0]..[3][0], [17][0], and [19][0] should contain the relevant values
@@ -988,6 +1008,34 @@ void PglMultiallelicSparseToDenseMiss(const PgenVariant* pgvp, uint32_t sample_c
 // given the poor interaction with phased dosages, it's probably better to just
 // think of them as permanently outside PLINK's scope.
 
+// Checksum companion file (.pgen.cksum), optionally written alongside a mode
+// 0x10 .pgen by the --make-pgen/--make-bpgen 'cksum' modifier.  It's kept out
+// of the .pgen itself so that older readers and PgrValidate()'s
+// exact-file-size check are unaffected.  plink2 deletes the sidecar when it
+// rewrites a .pgen without 'cksum', but other tools won't; bytes 4-19 tie the
+// sidecar to the .pgen it was written for, so a leftover one is usually
+// reported as stale rather than as corruption.  (plink2 additionally treats
+// the sidecar as stale when the .pgen was modified after it, since a rewrite
+// can leave the size and variant index unchanged.)
+// Format:
+//   bytes 0-2: magic {0x6c, 0x1b, 0x33}
+//   byte 3: format version (currently 0)
+//   bytes 4-7: little-endian variant_ct
+//   bytes 8-15: little-endian .pgen byte size
+//   bytes 16-19: little-endian CRC32C of the .pgen's variant index (bytes
+//     [12, vblock_fpos[0]), i.e. the vblock offsets, vrtypes, record lengths,
+//     and explicit nonref flags)
+//   remainder: one little-endian uint32 per vblock, the CRC32C of that
+//     vblock's variant records (i.e. bytes [vblock_fpos[i], vblock_fpos[i+1])
+//     of the .pgen, with the final vblock ending at EOF).
+// The header (which the writer backfills) is not covered; PgrValidate()'s
+// structural checks already catch most damage there.
+CONSTI32(kPglCksumHeaderBlen, 20);
+
+// Standard (Castagnoli) CRC32C, uses the SSE4.2 instruction when available.
+// Pass crc=0 for the first chunk, and the previous return value to continue.
+uint32_t Crc32c(uint32_t crc, const void* buf, uintptr_t byte_ct);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
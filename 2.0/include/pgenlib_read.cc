@@ -24,7 +24,10 @@
 #  include <sys/stat.h>  // open(), fstat()
 #  include <sys/mman.h>  // mmap()
 #  include <fcntl.h>  // open()
-#  include <unistd.h>  // fstat()
+#endif
+
+#ifndef _WIN32
+#  include <unistd.h>  // fstat(), pread()
 #endif
 
 #ifdef __cplusplus
@@ -371,6 +374,9 @@ double BiallelicDiploidMinimac3R2(uint64_t alt1_dosage, uint64_t hap_alt1_ssq_x2
 void PreinitPgfi(PgenFileInfo* pgfip) {
   pgfip->shared_ff = nullptr;
   pgfip->block_base = nullptr;
+#ifndef NO_MMAP
+  pgfip->mmap_base = nullptr;
+#endif
   // we want this for proper handling of e.g. sites-only VCFs
   pgfip->nonref_flags = nullptr;
 }
@@ -474,6 +480,9 @@ PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_s
   pgfip->block_base = nullptr;
   // this should force overflow when value is uninitialized.
   pgfip->block_offset = 1LLU << 63;
+#ifndef NO_MMAP
+  pgfip->mmap_base = nullptr;
+#endif
 
   uint64_t fsize;
   const unsigned char* fread_ptr;
@@ -507,10 +516,12 @@ PglErr PgfiInitPhase1(const char* fname, uint32_t raw_variant_ct, uint32_t raw_s
       snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
       return kPglRetReadFail;
     }
+    pgfip->mmap_base = pgfip->block_base;
     // this provided less than a ~5% boost on OS X; mmap still took >80% longer
     // than fread on an 85GB file there
     // try MAP_POPULATE on Linux?
-    // madvise((unsigned char*)(pgfip->block_base), fsize, MADV_SEQUENTIAL);
+    // Since access pattern isn't known yet, MADV_SEQUENTIAL is left to
+    // PgfiMmapAdviseSequential().
     close(file_handle);
     // update (7 Jan 2018): drop support for zero-sample and zero-variant
     // files, not worth the development cost
@@ -811,10 +822,8 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
     assert(shared_ff);
 #else
     if (!shared_ff) {
-      if (unlikely(use_blockload)) {
-        snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPhase2() cannot be called with use_blockload set when PgfiInitPhase1() had use_mmap set.\n");
-        return kPglRetImproperFunctionCall;
-      }
+      // use_blockload is fine here; PgfiMultiread() is just a madvise() call
+      // in mmap mode.
       if ((!(header_ctrl & 192)) || (pgfip->const_vrtype == kPglVrtypePlink1)) {
         return kPglRetSuccess;
       }
@@ -913,10 +922,6 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
   assert(shared_ff);
 #else
   if (!shared_ff) {
-    if (unlikely(use_blockload)) {
-      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: PgfiInitPhase2() cannot be called with use_blockload set when PgfiInitPhase1() had use_mmap set.\n");
-      return kPglRetImproperFunctionCall;
-    }
     fread_ptr = &(pgfip->block_base[12 + 8 * vblock_idx_start]);
     memcpy(&cur_fpos, fread_ptr, sizeof(int64_t));
     fread_ptr = &(fread_ptr[(vblock_ct_m1 + 1 - vblock_idx_start) * sizeof(int64_t)]);
@@ -1415,8 +1420,8 @@ PglErr PgfiInitPhase2(PgenHeaderCtrl header_ctrl, uint32_t allele_cts_already_lo
       } else {
         for (uint32_t cur_vblock_vidx = 0; cur_vblock_vidx != cur_vblock_variant_ct; ++cur_vblock_vidx) {
           const uint32_t cur_allele_ct = fread_ptr[cur_vblock_vidx];
-          allele_idx_offsets_iter[cur_vblock_vidx] = prev_allele_idx_offset;
           prev_allele_idx_offset += cur_allele_ct;
+          allele_idx_offsets_iter[cur_vblock_vidx] = prev_allele_idx_offset;
           if (cur_allele_ct > max_allele_ct) {
             max_allele_ct = cur_allele_ct;
           }
@@ -1575,7 +1580,29 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
   return DivUpU64(max_block_byte_ct, kCacheline);
 }
 
-PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
+#ifndef _WIN32
+static BoolErr PreadChecked(int32_t fd, uint64_t fpos, uintptr_t len, unsigned char* buf) {
+  while (len) {
+    const uintptr_t cur_len = MINV(len, kMaxBytesPerIO);
+    const intptr_t cur_bytes_read = pread(fd, buf, cur_len, fpos);
+    if (unlikely(cur_bytes_read <= 0)) {
+      if (!cur_bytes_read) {
+        // premature eof
+        errno = 0;
+      } else if (errno == EINTR) {
+        continue;
+      }
+      return 1;
+    }
+    buf = &(buf[S_CAST(uintptr_t, cur_bytes_read)]);
+    fpos += S_CAST(uintptr_t, cur_bytes_read);
+    len -= S_CAST(uintptr_t, cur_bytes_read);
+  }
+  return 0;
+}
+#endif
+
+static PglErr MultireadMain(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, uint32_t use_pread, const PgenFileInfo* pgfip, unsigned char* block_base, uint64_t* block_offset_ptr) {
   // we could permit 0, but that encourages lots of unnecessary thread wakeups
   assert(load_variant_ct);
   if (variant_include) {
@@ -1591,8 +1618,13 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
   } else {
     block_offset = GetPgfiFpos(pgfip, variant_uidx_start);
   }
-  pgfip->block_offset = block_offset;
+  *block_offset_ptr = block_offset;
   uint64_t next_read_start_fpos = block_offset;
+#ifdef _WIN32
+  assert(!use_pread);
+#else
+  const int32_t fd = use_pread? fileno(pgfip->shared_ff) : -1;
+#endif
   // break this up into multiple freads whenever this lets us skip an entire
   // disk block
   // (possible todo: make the disk block size a parameter of this function)
@@ -1629,11 +1661,20 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
         break;
       }
     }
+    uintptr_t len = cur_read_end_fpos - cur_read_start_fpos;
+    unsigned char* cur_dst = &(block_base[cur_read_start_fpos - block_offset]);
+#ifndef _WIN32
+    if (use_pread) {
+      if (unlikely(PreadChecked(fd, cur_read_start_fpos, len, cur_dst))) {
+        return kPglRetReadFail;
+      }
+      continue;
+    }
+#endif
     if (unlikely(fseeko(pgfip->shared_ff, cur_read_start_fpos, SEEK_SET))) {
       return kPglRetReadFail;
     }
-    uintptr_t len = cur_read_end_fpos - cur_read_start_fpos;
-    if (unlikely(fread_checked(K_CAST(unsigned char*, &(pgfip->block_base[cur_read_start_fpos - block_offset])), len, pgfip->shared_ff))) {
+    if (unlikely(fread_checked(cur_dst, len, pgfip->shared_ff))) {
       if (feof_unlocked(pgfip->shared_ff)) {
         errno = 0;
       }
@@ -1643,6 +1684,70 @@ PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_sta
   return kPglRetSuccess;
 }
 
+#ifndef NO_MMAP
+static uintptr_t MmapPageMask() {
+  const intptr_t page_size = sysconf(_SC_PAGESIZE);
+  if (page_size <= 0) {
+    return kDiskBlockSize - 1;
+  }
+  return page_size - 1;
+}
+
+// Nothing to copy: the readers decode straight from the mapping.  Just tell
+// the kernel which pages are about to be needed, so that it can start reading
+// them while the previous block is being processed.
+static void MmapMultireadAdvise(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, const PgenFileInfo* pgfip) {
+  if (variant_include) {
+    variant_uidx_start = AdvTo1Bit(variant_include, variant_uidx_start);
+    variant_uidx_end = 1 + FindLast1BitBefore(variant_include, variant_uidx_end);
+  }
+  uint64_t fpos_start;
+  if (pgfip->vrtypes && ((pgfip->vrtypes[variant_uidx_start] & 6) == 2)) {
+    fpos_start = pgfip->var_fpos[GetLdbaseVidx(pgfip->vrtypes, variant_uidx_start)];
+  } else {
+    fpos_start = GetPgfiFpos(pgfip, variant_uidx_start);
+  }
+  fpos_start &= ~S_CAST(uint64_t, MmapPageMask());
+  const uint64_t fpos_end = GetPgfiFpos(pgfip, variant_uidx_end);
+  // advisory, so errors are ignored
+  madvise(K_CAST(unsigned char*, &(pgfip->mmap_base[fpos_start])), fpos_end - fpos_start, MADV_WILLNEED);
+}
+#endif
+
+PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip) {
+#ifndef NO_MMAP
+  if (pgfip->mmap_base) {
+    assert(load_variant_ct);
+    MmapMultireadAdvise(variant_include, variant_uidx_start, variant_uidx_end, pgfip);
+    pgfip->block_base = pgfip->mmap_base;
+    pgfip->block_offset = 0;
+    return kPglRetSuccess;
+  }
+#endif
+  return MultireadMain(variant_include, variant_uidx_start, variant_uidx_end, load_variant_ct, 0, pgfip, K_CAST(unsigned char*, pgfip->block_base), &pgfip->block_offset);
+}
+
+PglErr PgfiMultireadTo(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, const PgenFileInfo* pgfip, unsigned char* block_base, uint64_t* block_offset_ptr) {
+  assert(!PgfiMmapBase(pgfip));
+#ifdef _WIN32
+  const uint32_t use_pread = 0;
+#else
+  const uint32_t use_pread = 1;
+#endif
+  return MultireadMain(variant_include, variant_uidx_start, variant_uidx_end, load_variant_ct, use_pread, pgfip, block_base, block_offset_ptr);
+}
+
+void PgfiMmapAdviseSequential(const PgenFileInfo* pgfip) {
+#ifndef NO_MMAP
+  const unsigned char* mmap_base = pgfip->mmap_base;
+  if (!mmap_base) {
+    return;
+  }
+  const uint64_t fpos_start = GetPgfiFpos(pgfip, 0) & (~S_CAST(uint64_t, MmapPageMask()));
+  madvise(K_CAST(unsigned char*, &(mmap_base[fpos_start])), pgfip->file_size - fpos_start, MADV_SEQUENTIAL);
+#endif
+}
+
 
 void PreinitPgr(PgenReader* pgr_ptr) {
   PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
@@ -3369,6 +3474,56 @@ PglErr PgrGetCounts(const uintptr_t* __restrict sample_include, const uintptr_t*
   return GetBasicGenotypeCounts(sample_include, sample_include_interleaved_vec, GetSicp(pssi), sample_ct, vidx, pgrp, nullptr, genocounts);
 }
 
+PglErr PgrGetCountsMulti(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uintptr_t* __restrict subset_masks, const uintptr_t* __restrict subset_interleaved_vecs, const uint32_t* __restrict subset_sizes, uint32_t subset_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uint32_t* __restrict genocounts_multi) {
+  if (!sample_ct) {
+    ZeroU32Arr(4 * S_CAST(uintptr_t, subset_ct), genocounts_multi);
+    return kPglRetSuccess;
+  }
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  assert(vidx < pgrp->fi.raw_variant_ct);
+  // A difflist entry costs one bit-test per subset, while the dense count
+  // costs ~1/16 operation per sample per subset.  The crossover is flat:
+  // on 8-population --fst runs over 10k-20k samples, divisors between 32 and
+  // 256 were within timing noise of each other, while always taking the dense
+  // path (or always taking the difflist path) was ~30-50% slower.  64 was
+  // best or tied on both the rare-heavy and the log-uniform-MAF dataset.
+  const uint32_t max_simple_difflist_len = sample_ct / 64;
+  uint32_t difflist_common_geno;
+  uint32_t difflist_len;
+  PglErr reterr = ReadDifflistOrGenovecSubsetUnsafe(sample_include, GetSicp(pssi), sample_ct, max_simple_difflist_len, vidx, pgrp, nullptr, nullptr, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (difflist_common_geno == UINT32_MAX) {
+    GenoarrCountSubsetFreqsMulti(genovec, subset_interleaved_vecs, subset_sizes, sample_ct, subset_ct, genocounts_multi);
+    return kPglRetSuccess;
+  }
+  ZeroU32Arr(4 * S_CAST(uintptr_t, subset_ct), genocounts_multi);
+  const uintptr_t subset_stride = BitCtToAlignedWordCt(sample_ct);
+  for (uint32_t difflist_idx = 0; difflist_idx != difflist_len; ++difflist_idx) {
+    const uint32_t sample_idx = difflist_sample_ids[difflist_idx];
+    const uintptr_t sample_widx = sample_idx / kBitsPerWord;
+    const uint32_t sample_shift = sample_idx % kBitsPerWord;
+    uint32_t* genocounts_iter = &(genocounts_multi[GetNyparrEntry(raregeno, difflist_idx)]);
+    const uintptr_t* mask_word_iter = &(subset_masks[sample_widx]);
+    for (uint32_t subset_idx = 0; subset_idx != subset_ct; ++subset_idx) {
+      *genocounts_iter += ((*mask_word_iter) >> sample_shift) & 1;
+      genocounts_iter = &(genocounts_iter[4]);
+      mask_word_iter = &(mask_word_iter[subset_stride]);
+    }
+  }
+  // The difflist never contains common-genotype entries (the
+  // LD-compressed merge drops them), so genocounts_iter[difflist_common_geno]
+  // is still zero here and the sum below only covers rare genotypes.
+  uint32_t* genocounts_iter = genocounts_multi;
+  for (uint32_t subset_idx = 0; subset_idx != subset_ct; ++subset_idx) {
+    const uint32_t rare_geno_ct = genocounts_iter[0] + genocounts_iter[1] + genocounts_iter[2] + genocounts_iter[3];
+    genocounts_iter[difflist_common_geno] = subset_sizes[subset_idx] - rare_geno_ct;
+    genocounts_iter = &(genocounts_iter[4]);
+  }
+  return kPglRetSuccess;
+}
+
 // Ok for nyp_vvec to be unaligned.
 uint32_t CountNypVec6(const VecW* nyp_vvec, uintptr_t nyp_word, uint32_t vec_ct) {
   assert(!(vec_ct % 6));
@@ -7397,6 +7552,109 @@ PglErr PgrGetInv1D(const uintptr_t* __restrict sample_include, PgrSampleSubsetIn
   return kPglRetSuccess;
 }
 
+// Front half of PgrGetDenseDosage{F,D}().  Dosage records are loaded with
+// IMPLPgrGetD(); otherwise, a difflist is returned whenever the record is
+// stored sparsely, so the dense array can be written directly.
+static PglErr ReadDenseDosageInputs(const uintptr_t* __restrict sample_include, const uint32_t* __restrict sample_include_cumulative_popcounts, uint32_t sample_ct, uint32_t vidx, PgenReaderMain* pgrp, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* difflist_common_geno_ptr, uint32_t* difflist_len_ptr, uint32_t* dosage_ct_ptr) {
+  const uint32_t vrtype = GetPgfiVrtype(&(pgrp->fi), vidx);
+  if (VrtypeDosage(vrtype) && dosage_present) {
+    *difflist_common_geno_ptr = UINT32_MAX;
+    return IMPLPgrGetD(sample_include, sample_include_cumulative_popcounts, sample_ct, vidx, pgrp, genovec, dosage_present, dosage_main, dosage_ct_ptr);
+  }
+  *dosage_ct_ptr = 0;
+  return ReadDifflistOrGenovecSubsetUnsafe(sample_include, sample_include_cumulative_popcounts, sample_ct, sample_ct / kPglMaxDifflistLenDivisor, vidx, pgrp, nullptr, nullptr, genovec, difflist_common_geno_ptr, raregeno, difflist_sample_ids, difflist_len_ptr);
+}
+
+static uint32_t CountDenseDosageMissing(const uintptr_t* __restrict raregeno, uint32_t difflist_common_geno, uint32_t difflist_len, uint32_t sample_ct, uint32_t dosage_ct, uintptr_t* __restrict genovec, const uintptr_t* __restrict dosage_present) {
+  if (difflist_common_geno != UINT32_MAX) {
+    if (difflist_common_geno == 3) {
+      return sample_ct - difflist_len;
+    }
+    if (!difflist_len) {
+      return 0;
+    }
+    // raregeno trailing bits may not be zeroed
+    const uint32_t raregeno_ctl2_m1 = (difflist_len - 1) / kBitsPerWordD2;
+    uint32_t missing_ct = 0;
+    for (uint32_t widx = 0; widx != raregeno_ctl2_m1; ++widx) {
+      missing_ct += Popcount01Word(Word11(raregeno[widx]));
+    }
+    return missing_ct + Popcount01Word(bzhi_max(Word11(raregeno[raregeno_ctl2_m1]), 2 * ModNz(difflist_len, kBitsPerWordD2)));
+  }
+  ZeroTrailingNyps(sample_ct, genovec);
+  const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
+  uint32_t missing_ct = 0;
+  if (!dosage_ct) {
+    for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
+      missing_ct += Popcount01Word(Word11(genovec[widx]));
+    }
+    return missing_ct;
+  }
+  const Halfword* dosage_present_alias = R_CAST(const Halfword*, dosage_present);
+  for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
+    const uintptr_t detect_11 = Word11(genovec[widx]);
+    if (detect_11) {
+      missing_ct += PopcountWord(PackWordToHalfword(detect_11) & (~dosage_present_alias[widx]));
+    }
+  }
+  return missing_ct;
+}
+
+static inline void Dosage16ToDenseRescaled(const uintptr_t* __restrict genovec, const uintptr_t* __restrict dosage_present, const uint16_t* dosage_main, float slope, float intercept, float missing_val, uint32_t sample_ct, uint32_t dosage_ct, float* __restrict dense_dosages) {
+  Dosage16ToFloatsRescaled(genovec, dosage_present, dosage_main, slope, intercept, missing_val, sample_ct, dosage_ct, dense_dosages);
+}
+
+static inline void Dosage16ToDenseRescaled(const uintptr_t* __restrict genovec, const uintptr_t* __restrict dosage_present, const uint16_t* dosage_main, double slope, double intercept, double missing_val, uint32_t sample_ct, uint32_t dosage_ct, double* __restrict dense_dosages) {
+  Dosage16ToDoublesRescaled(genovec, dosage_present, dosage_main, slope, intercept, missing_val, sample_ct, dosage_ct, dense_dosages);
+}
+
+// Shared body of PgrGetDenseDosage{F,D}(); T is float or double.
+template <class T> static PglErr PgrGetDenseDosageT(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, T slope, T intercept, T missing_val, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* missing_ct_ptr, T* __restrict dense_dosages) {
+  if (!sample_ct) {
+    if (missing_ct_ptr) {
+      *missing_ct_ptr = 0;
+    }
+    return kPglRetSuccess;
+  }
+  PgenReaderMain* pgrp = GetPgrp(pgr_ptr);
+  assert(vidx < pgrp->fi.raw_variant_ct);
+  uint32_t difflist_common_geno;
+  uint32_t difflist_len;
+  uint32_t dosage_ct;
+  PglErr reterr = ReadDenseDosageInputs(sample_include, GetSicp(pssi), sample_ct, vidx, pgrp, genovec, raregeno, difflist_sample_ids, dosage_present, dosage_main, &difflist_common_geno, &difflist_len, &dosage_ct);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (difflist_common_geno == UINT32_MAX) {
+    Dosage16ToDenseRescaled(genovec, dosage_present, dosage_main, slope, intercept, missing_val, sample_ct, dosage_ct, dense_dosages);
+  } else {
+    T geno_vals[4];
+    geno_vals[0] = intercept;
+    geno_vals[1] = intercept + slope;
+    geno_vals[2] = intercept + 2 * slope;
+    geno_vals[3] = missing_val;
+    const T common_val = geno_vals[difflist_common_geno];
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      dense_dosages[sample_idx] = common_val;
+    }
+    for (uint32_t difflist_idx = 0; difflist_idx != difflist_len; ++difflist_idx) {
+      dense_dosages[difflist_sample_ids[difflist_idx]] = geno_vals[GetNyparrEntry(raregeno, difflist_idx)];
+    }
+  }
+  if (missing_ct_ptr) {
+    *missing_ct_ptr = CountDenseDosageMissing(raregeno, difflist_common_geno, difflist_len, sample_ct, dosage_ct, genovec, dosage_present);
+  }
+  return kPglRetSuccess;
+}
+
+PglErr PgrGetDenseDosageF(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, float slope, float intercept, float missing_val, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* missing_ct_ptr, float* __restrict dense_dosages) {
+  return PgrGetDenseDosageT(sample_include, pssi, sample_ct, vidx, slope, intercept, missing_val, pgr_ptr, genovec, raregeno, difflist_sample_ids, dosage_present, dosage_main, missing_ct_ptr, dense_dosages);
+}
+
+PglErr PgrGetDenseDosageD(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, double slope, double intercept, double missing_val, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* missing_ct_ptr, double* __restrict dense_dosages) {
+  return PgrGetDenseDosageT(sample_include, pssi, sample_ct, vidx, slope, intercept, missing_val, pgr_ptr, genovec, raregeno, difflist_sample_ids, dosage_present, dosage_main, missing_ct_ptr, dense_dosages);
+}
+
 PglErr GetAux1bHetIncr(const unsigned char* fread_end, uint32_t aux1b_mode, uint32_t raw_sample_ct, uint32_t allele_ct, uint32_t raw_10_ct, const unsigned char** fread_pp, uint32_t* __restrict raw_het_ctp) {
   if (aux1b_mode == 15) {
     return kPglRetSuccess;
@@ -10386,6 +10644,247 @@ PglErr PgrValidate(PgenReader* pgr_ptr, uintptr_t* genovec_buf, char* errstr_buf
 }
 
 
+void PreinitPgsm(PgenSmajReader* psrp) {
+  psrp->ff = nullptr;
+}
+
+PglErr PgsmInit(const char* fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, PgenSmajReader* psrp, char* errstr_buf) {
+  psrp->ff = fopen(fname, FOPEN_RB);
+  if (unlikely(!psrp->ff)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  unsigned char header[kPglSmajHeaderBlen];
+  if (unlikely(fread_checked(header, kPglSmajHeaderBlen, psrp->ff))) {
+    if (feof_unlocked(psrp->ff)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is too small to be a valid .pgen.smaj file.\n", fname);
+      return kPglRetMalformedInput;
+    }
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
+    return kPglRetReadFail;
+  }
+  if (unlikely((header[0] != 0x6c) || (header[1] != 0x1b) || (header[2] != 0x30))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is not a .pgen.smaj file (first three bytes don't match the magic number).\n", fname);
+    return kPglRetMalformedInput;
+  }
+  if (unlikely(header[3])) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has an unsupported .pgen.smaj format version.\n", fname);
+    return kPglRetNotYetSupported;
+  }
+  memcpy(&psrp->variant_ct, &(header[4]), sizeof(int32_t));
+  memcpy(&psrp->sample_ct, &(header[8]), sizeof(int32_t));
+  memcpy(&psrp->chunk_variant_ct, &(header[12]), sizeof(int32_t));
+  const uint32_t variant_ct = psrp->variant_ct;
+  const uint32_t sample_ct = psrp->sample_ct;
+  const uint32_t chunk_variant_ct = psrp->chunk_variant_ct;
+  if (unlikely((!variant_ct) || (!sample_ct) || (!chunk_variant_ct) || (chunk_variant_ct % kPglNypTransposeBatch))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has an invalid header.\n", fname);
+    return kPglRetMalformedInput;
+  }
+  if (unlikely(((raw_variant_ct != UINT32_MAX) && (raw_variant_ct != variant_ct)) || ((raw_sample_ct != UINT32_MAX) && (raw_sample_ct != sample_ct)))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s variant/sample counts don't match the .pgen file.\n", fname);
+    return kPglRetInconsistentInput;
+  }
+  const uint32_t full_chunk_ct = variant_ct / chunk_variant_ct;
+  const uint64_t expected_fsize = kPglSmajHeaderBlen + (S_CAST(uint64_t, full_chunk_ct) * (chunk_variant_ct / 4) + DivUp(variant_ct % chunk_variant_ct, 4)) * sample_ct;
+  if (unlikely(fseeko(psrp->ff, 0, SEEK_END))) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
+    return kPglRetReadFail;
+  }
+  if (unlikely(S_CAST(uint64_t, ftello(psrp->ff)) != expected_fsize)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has the wrong size for its header.\n", fname);
+    return kPglRetMalformedInput;
+  }
+  return kPglRetSuccess;
+}
+
+PglErr PgsmGet(uint32_t sample_idx, uint32_t variant_idx_start, uint32_t variant_idx_end, PgenSmajReader* psrp, uintptr_t* __restrict genovec) {
+  const uint32_t variant_ct = psrp->variant_ct;
+  const uint32_t sample_ct = psrp->sample_ct;
+  const uint32_t chunk_variant_ct = psrp->chunk_variant_ct;
+  if (unlikely((sample_idx >= sample_ct) || (variant_idx_start >= variant_idx_end) || (variant_idx_end > variant_ct))) {
+    return kPglRetImproperFunctionCall;
+  }
+  const uint64_t full_chunk_blen = S_CAST(uint64_t, chunk_variant_ct / 4) * sample_ct;
+  // Load [variant_idx_start rounded down to a multiple of 4, variant_idx_end)
+  // as a contiguous byte sequence.  Chunk boundaries are multiples of 4, so
+  // the row segments from consecutive chunks line up.
+  const uint32_t aligned_start = variant_idx_start & (~3U);
+  unsigned char* write_iter = R_CAST(unsigned char*, genovec);
+  for (uint32_t chunk_start = aligned_start; chunk_start < variant_idx_end; ) {
+    const uint32_t chunk_idx = chunk_start / chunk_variant_ct;
+    const uint32_t chunk_vidx_start = chunk_idx * chunk_variant_ct;
+    uint32_t chunk_vidx_end = chunk_vidx_start + chunk_variant_ct;
+    if (chunk_vidx_end > variant_ct) {
+      chunk_vidx_end = variant_ct;
+    }
+    const uint32_t row_blen = DivUp(chunk_vidx_end - chunk_vidx_start, 4);
+    const uint32_t seg_end = MINV(chunk_vidx_end, variant_idx_end);
+    const uint32_t seg_byte_start = (chunk_start - chunk_vidx_start) / 4;
+    const uint32_t seg_blen = DivUp(seg_end - chunk_vidx_start, 4) - seg_byte_start;
+    const uint64_t fpos = kPglSmajHeaderBlen + chunk_idx * full_chunk_blen + S_CAST(uint64_t, sample_idx) * row_blen + seg_byte_start;
+    if (unlikely(fseeko(psrp->ff, fpos, SEEK_SET) || fread_checked(write_iter, seg_blen, psrp->ff))) {
+      return kPglRetReadFail;
+    }
+    write_iter = &(write_iter[seg_blen]);
+    chunk_start = seg_end;
+  }
+  const uint32_t loaded_ct = variant_idx_end - aligned_start;
+  const uint32_t lead_ct = variant_idx_start - aligned_start;
+  const uint32_t loaded_byte_ct = DivUp(loaded_ct, 4);
+  const uint32_t loaded_word_ct = NypCtToWordCt(loaded_ct);
+  // zero-fill the remainder of the last loaded word
+  memset(write_iter, 0, loaded_word_ct * kBytesPerWord - loaded_byte_ct);
+  if (lead_ct) {
+    const uint32_t rshift = 2 * lead_ct;
+    const uint32_t lshift = kBitsPerWord - rshift;
+    for (uint32_t widx = 0; widx + 1 < loaded_word_ct; ++widx) {
+      genovec[widx] = (genovec[widx] >> rshift) | (genovec[widx + 1] << lshift);
+    }
+    genovec[loaded_word_ct - 1] >>= rshift;
+  }
+  ZeroTrailingNyps(variant_idx_end - variant_idx_start, genovec);
+  return kPglRetSuccess;
+}
+
+BoolErr CleanupPgsm(PgenSmajReader* psrp, PglErr* reterrp) {
+  if (!psrp->ff) {
+    return 0;
+  }
+  if (fclose_null(&psrp->ff)) {
+    if (*reterrp == kPglRetSuccess) {
+      *reterrp = kPglRetReadFail;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static PglErr PgfiCrcRange(const PgenFileInfo* pgfip, uint64_t fpos, uint64_t fpos_end, unsigned char* buf, uint32_t* crc_ptr) {
+#ifndef NO_MMAP
+  const unsigned char* mmap_base = pgfip->mmap_base;
+  if (mmap_base) {
+    *crc_ptr = Crc32c(0, &(mmap_base[fpos]), fpos_end - fpos);
+    return kPglRetSuccess;
+  }
+#endif
+#ifdef _WIN32
+  if (unlikely(fseeko(pgfip->shared_ff, fpos, SEEK_SET))) {
+    return kPglRetReadFail;
+  }
+#else
+  const int32_t fd = fileno(pgfip->shared_ff);
+#endif
+  uint32_t crc = 0;
+  while (fpos != fpos_end) {
+    const uintptr_t cur_byte_ct = MINV(fpos_end - fpos, kPglCksumReadBlen);
+#ifdef _WIN32
+    if (unlikely(fread_checked(buf, cur_byte_ct, pgfip->shared_ff))) {
+      return kPglRetReadFail;
+    }
+#else
+    if (unlikely(PreadChecked(fd, fpos, cur_byte_ct, buf))) {
+      return kPglRetReadFail;
+    }
+#endif
+    crc = Crc32c(crc, buf, cur_byte_ct);
+    fpos += cur_byte_ct;
+  }
+  *crc_ptr = crc;
+  return kPglRetSuccess;
+}
+
+PglErr PgfiLoadVblockCrcs(const char* fname, const PgenFileInfo* pgfip, unsigned char* buf, uint32_t* vblock_crcs, char* errstr_buf) {
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  if (unlikely(!pgfip->var_fpos)) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen.cksum files are only defined for variable-width .pgen files.\n");
+    return kPglRetInconsistentInput;
+  }
+  FILE* cksum_infile = fopen(fname, FOPEN_RB);
+  if (!cksum_infile) {
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: Failed to open %s : %s.\n", fname, strerror(errno));
+    return kPglRetOpenFail;
+  }
+  PglErr reterr = kPglRetSuccess;
+  {
+    unsigned char header[kPglCksumHeaderBlen];
+    if (unlikely(fread_checked(header, kPglCksumHeaderBlen, cksum_infile))) {
+      goto PgfiLoadVblockCrcs_ret_READ_OR_FORMAT;
+    }
+    if (unlikely((header[0] != 0x6c) || (header[1] != 0x1b) || (header[2] != 0x33))) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is not a .pgen.cksum file (first three bytes don't match the magic number).\n", fname);
+      reterr = kPglRetMalformedInput;
+      goto PgfiLoadVblockCrcs_ret_1;
+    }
+    if (unlikely(header[3])) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s has an unsupported .pgen.cksum format version.\n", fname);
+      reterr = kPglRetNotYetSupported;
+      goto PgfiLoadVblockCrcs_ret_1;
+    }
+    uint32_t variant_ct;
+    uint64_t pgen_fsize;
+    uint32_t index_crc;
+    memcpy(&variant_ct, &(header[4]), sizeof(int32_t));
+    memcpy(&pgen_fsize, &(header[8]), sizeof(int64_t));
+    memcpy(&index_crc, &(header[16]), sizeof(int32_t));
+    if (unlikely((variant_ct != raw_variant_ct) || (pgen_fsize != pgfip->var_fpos[raw_variant_ct]))) {
+      goto PgfiLoadVblockCrcs_ret_STALE;
+    }
+    uint32_t actual_index_crc;
+    if (unlikely(PgfiCrcRange(pgfip, 12, pgfip->var_fpos[0], buf, &actual_index_crc))) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: .pgen file read failure: %s.\n", strerror(errno));
+      reterr = kPglRetReadFail;
+      goto PgfiLoadVblockCrcs_ret_1;
+    }
+    if (unlikely(index_crc != actual_index_crc)) {
+      goto PgfiLoadVblockCrcs_ret_STALE;
+    }
+    const uint32_t vblock_ct = DivUp(raw_variant_ct, kPglVblockSize);
+    if (unlikely(fread_checked(vblock_crcs, vblock_ct * sizeof(int32_t), cksum_infile))) {
+      goto PgfiLoadVblockCrcs_ret_READ_OR_FORMAT;
+    }
+    if (unlikely(fgetc(cksum_infile) != EOF)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is larger than expected.\n", fname);
+      reterr = kPglRetMalformedInput;
+    }
+  }
+  while (0) {
+  PgfiLoadVblockCrcs_ret_READ_OR_FORMAT:
+    if (feof_unlocked(cksum_infile)) {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s is smaller than expected.\n", fname);
+      reterr = kPglRetMalformedInput;
+    } else {
+      snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s read failure: %s.\n", fname, strerror(errno));
+      reterr = kPglRetReadFail;
+    }
+    break;
+  PgfiLoadVblockCrcs_ret_STALE:
+    snprintf(errstr_buf, kPglErrstrBufBlen, "Error: %s doesn't match the .pgen file (stale checksums?).\n", fname);
+    reterr = kPglRetInconsistentInput;
+    break;
+  }
+ PgfiLoadVblockCrcs_ret_1:
+  fclose(cksum_infile);
+  return reterr;
+}
+
+PglErr PgfiVerifyVblockCrcs(const PgenFileInfo* pgfip, const uint32_t* vblock_crcs, uint32_t vblock_idx_start, uint32_t vblock_idx_end, uint32_t vblock_idx_stride, unsigned char* buf, uint32_t* bad_vblock_idx_ptr) {
+  const uint64_t* var_fpos = pgfip->var_fpos;
+  const uint32_t raw_variant_ct = pgfip->raw_variant_ct;
+  for (uint32_t vblock_idx = vblock_idx_start; vblock_idx < vblock_idx_end; vblock_idx += vblock_idx_stride) {
+    const uint32_t next_vidx = (vblock_idx + 1) * kPglVblockSize;
+    uint32_t crc;
+    if (unlikely(PgfiCrcRange(pgfip, var_fpos[vblock_idx * kPglVblockSize], var_fpos[MINV(next_vidx, raw_variant_ct)], buf, &crc))) {
+      return kPglRetReadFail;
+    }
+    if (crc != vblock_crcs[vblock_idx]) {
+      *bad_vblock_idx_ptr = vblock_idx;
+      return kPglRetMalformedInput;
+    }
+  }
+  return kPglRetSuccess;
+}
+
 BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp) {
   // memory is the responsibility of the caller
   if (pgfip->shared_ff) {
@@ -10396,8 +10895,11 @@ BoolErr CleanupPgfi(PgenFileInfo* pgfip, PglErr* reterrp) {
       }
     }
 #ifndef NO_MMAP
-  } else if (pgfip->block_base != nullptr) {
-    munmap(K_CAST(unsigned char*, pgfip->block_base), pgfip->file_size);
+  } else if (pgfip->mmap_base != nullptr) {
+    // block_base may have been redirected by a block-load caller
+    munmap(K_CAST(unsigned char*, pgfip->mmap_base), pgfip->file_size);
+    pgfip->mmap_base = nullptr;
+    pgfip->block_base = nullptr;
 #endif
   }
   return 0;
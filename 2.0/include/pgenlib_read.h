@@ -112,6 +112,9 @@ typedef struct PgenFileInfoStruct {
   uint64_t block_offset;  // 0 for mmap
 #ifndef NO_MMAP
   uint64_t file_size;
+  // Start of the mapping in mmap mode, nullptr otherwise.  Unlike block_base,
+  // this is never modified by block-load callers.
+  const unsigned char* mmap_base;
 #endif
 } PgenFileInfo;
 
@@ -430,7 +433,9 @@ void PreinitPgfi(PgenFileInfo* pgfip);
 //    doesn't share its inability to handle multiple queries at a time, but
 //    less performant for CPU-heavy operations on the whole genome.
 //
-// To specify mode 1, pass in use_mmap == 1 here.
+// To specify mode 1, pass in use_mmap == 1 here.  use_blockload may be either
+//   0 or 1 during phase2; in the latter case, the block-load interface below
+//   is available, but PgfiMultiread() doesn't copy anything.
 // To specify mode 2, pass in use_mmap == 0 here, and use_blockload == 1 during
 //   phase2.
 // To specify mode 3, pass in use_mmap == 0 here, and use_blockload == 0 during
@@ -452,8 +457,33 @@ uint64_t PgfiMultireadGetCachelineReq(const uintptr_t* variant_include, const Pg
 // IMPORTANT: pgfi.block_offset must be manually copied to each reader for now.
 //   (todo: probably replace pgr.fi with a pointer.  when doing that, need to
 //   ensure multiple per-variant readers still works.)
+// In mmap mode, this just points block_base at the mapping (with
+// block_offset == 0) and issues a madvise(MADV_WILLNEED) hint for the
+// requested range; the readers then decode straight from the page cache.
 PglErr PgfiMultiread(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, PgenFileInfo* pgfip);
 
+// Same as PgfiMultiread(), except the destination buffer is caller-specified
+// and pgfip is not modified; the offset that must be paired with block_base
+// is returned in *block_offset_ptr instead.  pread() is used where available,
+// so this can be called from a dedicated I/O thread while other threads
+// decode from previously loaded buffers.  (On Windows, this falls back to
+// fseeko() + fread() on pgfip->shared_ff, so at most one thread may be
+// reading from the file at a time.)  Not usable in mmap mode.
+PglErr PgfiMultireadTo(const uintptr_t* variant_include, uint32_t variant_uidx_start, uint32_t variant_uidx_end, uint32_t load_variant_ct, const PgenFileInfo* pgfip, unsigned char* block_base, uint64_t* block_offset_ptr);
+
+// nullptr if the file wasn't opened in mmap mode (or NO_MMAP is defined).
+HEADER_INLINE const unsigned char* PgfiMmapBase(const PgenFileInfo* pgfip) {
+#ifdef NO_MMAP
+  return nullptr;
+#else
+  return pgfip->mmap_base;
+#endif
+}
+
+// No-op unless in mmap mode.  Otherwise, applies madvise(MADV_SEQUENTIAL) to
+// the variant records, which is appropriate before a whole-file block-load
+// pass.
+void PgfiMmapAdviseSequential(const PgenFileInfo* pgfip);
 
 void PreinitPgr(PgenReader* pgr_ptr);
 
@@ -559,6 +589,20 @@ PglErr PgrGetDifflistOrGenovec(const uintptr_t* __restrict sample_include, PgrSa
 // genocounts[0] = # hom ref, [1] = # het ref, [2] = two alts, [3] = missing
 PglErr PgrGetCounts(const uintptr_t* __restrict sample_include, const uintptr_t* __restrict sample_include_interleaved_vec, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, STD_ARRAY_REF(uint32_t, 4) genocounts);
 
+// PgrGetCounts() for subset_ct subsets of the sample_ct loaded samples, with
+// the record decoded only once.  Appropriate for stratified reports.
+// * subset_masks is a sequence of subset_ct bitarrays over the loaded
+//   (collapsed) sample indexes, each BitCtToAlignedWordCt(sample_ct) words
+//   long and with trailing bits zeroed.  subset_interleaved_vecs has the
+//   corresponding FillInterleavedMaskVec() outputs, and subset_sizes the
+//   popcounts.  Subsets may overlap.
+// * genovec, raregeno, and difflist_sample_ids are workspace buffers with the
+//   same size requirements as in PgrGetDifflistOrGenovec().
+// * genocounts_multi[4k..4k+3] are filled with subset k's counts.
+// Sparse records are counted straight from the difflist; otherwise, the
+// genovec is counted against all the masks in one cache-blocked pass.
+PglErr PgrGetCountsMulti(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uintptr_t* __restrict subset_masks, const uintptr_t* __restrict subset_interleaved_vecs, const uint32_t* __restrict subset_sizes, uint32_t subset_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uint32_t* __restrict genocounts_multi);
+
 // genocounts[0] = # of hardcalls with two copies of specified allele
 // genocounts[1] = # of hardcalls with exactly one copy of specified allele
 // genocounts[2] = # of hardcalls with no copies
@@ -655,6 +699,21 @@ PglErr PgrGet1D(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex
 
 PglErr PgrGetInv1D(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, AlleleCode allele_idx, PgenReader* pgr_ptr, uintptr_t* __restrict allele_invcountvec, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr);
 
+// Loads the specified variant directly into a dense array, as
+// Dosage16To{Floats,Doubles}Rescaled() would expand PgrGetD() output.  When
+// the variant has no dosage data and its hardcalls are stored as a difflist
+// (possibly LD-compressed), the dense array is written straight from the
+// difflist without expanding a genovec.
+// * genovec, raregeno, and difflist_sample_ids are workspace buffers with the
+//   same size requirements as in PgrGetDifflistOrGenovec().
+// * dosage_present and dosage_main are PgrGetD() workspace buffers; if they're
+//   nullptr, dosage data is ignored.
+// * If missing_ct_ptr is non-null, the number of samples set to missing_val
+//   is saved there.
+PglErr PgrGetDenseDosageF(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, float slope, float intercept, float missing_val, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* missing_ct_ptr, float* __restrict dense_dosages);
+
+PglErr PgrGetDenseDosageD(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, double slope, double intercept, double missing_val, PgenReader* pgr_ptr, uintptr_t* __restrict genovec, uintptr_t* __restrict raregeno, uint32_t* __restrict difflist_sample_ids, uintptr_t* __restrict dosage_present, uint16_t* dosage_main, uint32_t* missing_ct_ptr, double* __restrict dense_dosages);
+
 // When computing either form of imputation-r2, this function requires the
 // variant to be biallelic; PgrGetMDCounts must be called in that multiallelic
 // case.
@@ -697,6 +756,65 @@ PglErr PgrGetMissingness(const uintptr_t* __restrict sample_include, PgrSampleSu
 // missingness_dosage must be vector-aligned
 PglErr PgrGetMissingnessD(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, uint32_t vidx, PgenReader* pgr_ptr, uintptr_t* __restrict missingness_hc, uintptr_t* __restrict missingness_dosage, uintptr_t* __restrict hets, uintptr_t* __restrict genovec_buf);
 
+// Sample-major companion file (.pgen.smaj), optionally written alongside a
+// .pgen by "--make-pgen smaj".  Format:
+//   bytes 0-2: magic {0x6c, 0x1b, 0x30}
+//   byte 3: format version (currently 0)
+//   bytes 4-7, 8-11, 12-15: little-endian variant_ct, sample_ct,
+//     chunk_variant_ct (positive multiple of kPglNypTransposeBatch)
+//   remainder: one block per chunk of chunk_variant_ct variants (the last
+//     chunk may be smaller).  Each block stores sample_ct rows of
+//     DivUp(chunk_size, 4) bytes, holding the sample's PgrGet()-encoded
+//     hardcalls for that chunk; trailing bits of each row are zero.
+// Since block and row offsets are implied by the header, fetching one sample
+// across a variant range reads only ~(range size / 4) bytes.
+CONSTI32(kPglSmajHeaderBlen, 16);
+
+typedef struct PgenSmajReaderStruct {
+  NONCOPYABLE(PgenSmajReaderStruct);
+  FILE* ff;
+  uint32_t variant_ct;
+  uint32_t sample_ct;
+  uint32_t chunk_variant_ct;
+} PgenSmajReader;
+
+void PreinitPgsm(PgenSmajReader* psrp);
+
+// raw_variant_ct and raw_sample_ct can be UINT32_MAX if unknown; otherwise
+// they're checked against the header.
+PglErr PgsmInit(const char* fname, uint32_t raw_variant_ct, uint32_t raw_sample_ct, PgenSmajReader* psrp, char* errstr_buf);
+
+// Loads sample_idx's hardcalls for variants [variant_idx_start,
+// variant_idx_end) into genovec, with entry 0 corresponding to
+// variant_idx_start.  Range must be nonempty.  genovec must have space for
+// (variant_idx_end - variant_idx_start + 3) entries, since up to 3 leading
+// entries are loaded and then shifted out.  Trailing bits are zeroed.
+PglErr PgsmGet(uint32_t sample_idx, uint32_t variant_idx_start, uint32_t variant_idx_end, PgenSmajReader* psrp, uintptr_t* __restrict genovec);
+
+BoolErr CleanupPgsm(PgenSmajReader* psrp, PglErr* reterrp);
+
+CONSTI32(kPglCksumReadBlen, 1 << 22);
+
+// Loads the .pgen.cksum sidecar (see pgenlib_misc.h) into vblock_crcs[],
+// which must have space for DivUp(raw_variant_ct, kPglVblockSize) entries.
+// Returns kPglRetOpenFail if the file doesn't exist, and
+// kPglRetInconsistentInput if it doesn't match pgfip (e.g. the .pgen was
+// rewritten afterward).  errstr_buf is filled in all error cases.
+// The variant index is reread to check the latter, so buf has the same
+// requirements as in PgfiVerifyVblockCrcs() below.
+PglErr PgfiLoadVblockCrcs(const char* fname, const PgenFileInfo* pgfip, unsigned char* buf, uint32_t* vblock_crcs, char* errstr_buf);
+
+// Recomputes the CRCs of vblocks vblock_idx_start, vblock_idx_start +
+// vblock_idx_stride, ... (< vblock_idx_end) and compares them against
+// vblock_crcs[].  On mismatch, *bad_vblock_idx_ptr is set and
+// kPglRetMalformedInput is returned.
+// Reads from the mapping in mmap mode, and otherwise with pread() on
+// pgfip->shared_ff (which must be open), so multiple threads can call this
+// concurrently with disjoint vblock sets.  On Windows, fseeko() + fread() is
+// used instead, so calls must be serialized there.
+// buf must have space for kPglCksumReadBlen bytes (unused in mmap mode).
+PglErr PgfiVerifyVblockCrcs(const PgenFileInfo* pgfip, const uint32_t* vblock_crcs, uint32_t vblock_idx_start, uint32_t vblock_idx_end, uint32_t vblock_idx_stride, unsigned char* buf, uint32_t* bad_vblock_idx_ptr);
+
 
 // error-return iff reterr was success and was changed to kPglRetReadFail (i.e.
 // an error message should be printed).
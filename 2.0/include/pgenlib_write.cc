@@ -62,6 +62,7 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   pwcp->phase_dosage_gflags = phase_dosage_gflags;
 #ifndef NDEBUG
   pwcp->vblock_fpos = nullptr;
+  pwcp->vblock_crcs = nullptr;
   pwcp->vrec_len_buf = nullptr;
   pwcp->vrtype_buf = nullptr;
   pwcp->fwrite_buf = nullptr;
@@ -73,6 +74,10 @@ PglErr PwcInitPhase1(const char* __restrict fname, const uintptr_t* __restrict a
   pwcp->ldbase_difflist_sample_ids = nullptr;
 #endif
   pwcp->vidx = 0;
+  pwcp->force_ldbase = 0;
+  pwcp->crc_vblock_idx = 0;
+  pwcp->crc_running = 0;
+  pwcp->index_crc = 0;
 
   FILE* pgen_outfile = fopen(fname, FOPEN_WB);
   *pgen_outfile_ptr = pgen_outfile;
@@ -124,6 +129,9 @@ uint32_t CountSpgwAllocCachelinesRequired(uint32_t variant_ct, uint32_t sample_c
   const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   uint32_t cachelines_required = Int64CtToCachelineCt(vblock_ct);
 
+  // vblock_crcs
+  cachelines_required += Int32CtToCachelineCt(vblock_ct);
+
   // vrec_len_buf
   // overlapping uint32_t writes used, so (variant_ct * vrec_len_byte_ct) might
   // not be enough
@@ -188,7 +196,8 @@ PglErr SpgwInitPhase1(const char* __restrict fname, const uintptr_t* __restrict
     }
     if (max_alt_ct_p1 > 2) {
       // see comments in middle of MpgwInitPhase1()
-      max_vrec_len += 2 + sizeof(AlleleCode) + GetAux1bAlleleEntryByteCt(max_alt_ct_p1, sample_ct - 1);
+      // (including the bitarray at the front of aux1b)
+      max_vrec_len += 2 + sizeof(AlleleCode) + (sample_ct + 6) / 8 + GetAux1bAlleleEntryByteCt(max_alt_ct_p1, sample_ct - 1);
       // try to permit uncompressed records to be larger than this, only error
       // out when trying to write a larger compressed record.
     }
@@ -234,6 +243,9 @@ void MpgwInitPhase1(const uintptr_t* __restrict allele_idx_offsets, uint32_t var
   const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   uint32_t alloc_base_cacheline_ct = Int64CtToCachelineCt(vblock_ct);
 
+  // vblock_crcs
+  alloc_base_cacheline_ct += Int32CtToCachelineCt(vblock_ct);
+
   // vrtype_buf
   if (phase_dosage_gflags) {
     alloc_base_cacheline_ct += DivUp(variant_ct, kCacheline);
@@ -408,6 +420,8 @@ void PwcInitPhase2(uintptr_t fwrite_cacheline_ct, uint32_t thread_ct, PgenWriter
   }
   pwcs[0]->vblock_fpos = R_CAST(uint64_t*, alloc_iter);
   alloc_iter = &(alloc_iter[Int64CtToCachelineCt(vblock_ct) * kCacheline]);
+  pwcs[0]->vblock_crcs = R_CAST(uint32_t*, alloc_iter);
+  alloc_iter = &(alloc_iter[Int32CtToCachelineCt(vblock_ct) * kCacheline]);
 
   pwcs[0]->vrec_len_buf = alloc_iter;
   alloc_iter = &(alloc_iter[RoundUpPow2(variant_ct * pwcs[0]->vrec_len_byte_ct, kCacheline)]);
@@ -423,6 +437,7 @@ void PwcInitPhase2(uintptr_t fwrite_cacheline_ct, uint32_t thread_ct, PgenWriter
   for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
     if (tidx) {
       pwcs[tidx]->vblock_fpos = pwcs[0]->vblock_fpos;
+      pwcs[tidx]->vblock_crcs = pwcs[0]->vblock_crcs;
       pwcs[tidx]->vrec_len_buf = pwcs[0]->vrec_len_buf;
       pwcs[tidx]->vrtype_buf = pwcs[0]->vrtype_buf;
     }
@@ -854,6 +869,8 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
 
   uintptr_t* ldbase_genovec = pwcp->ldbase_genovec;
   STD_ARRAY_REF(uint32_t, 4) ldbase_genocounts = pwcp->ldbase_genocounts;
+  const uint32_t force_ldbase = pwcp->force_ldbase;
+  pwcp->force_ldbase = 0;
   if (!(vidx % kPglVblockSize)) {
     // beginning of a variant block.  save raw fpos in header; LD compression
     // prohibited.
@@ -861,7 +878,7 @@ uint32_t PwcAppendBiallelicGenovecMain(const uintptr_t* __restrict genovec, uint
     // er, need to use a relative offset in the multithreaded case, absolute
     // position isn't known
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
-  } else if (difflist_len > sample_ctd64) {
+  } else if ((difflist_len > sample_ctd64) && (!force_ldbase)) {
     // do not use LD compression if there are at least this many differences.
     // tune this threshold in the future.
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
@@ -939,10 +956,36 @@ void PwcAppendBiallelicGenovec(const uintptr_t* __restrict genovec, PgenWriterCo
   }
 }
 
+// Folds the byte_ct bytes of variant records at file offset
+// pwcp->vblock_fpos_offset into the vblock CRCs; this may complete several
+// vblocks, and may leave one in progress.
+static void SpgwUpdateVblockCrcs(const unsigned char* buf, uintptr_t byte_ct, PgenWriterCommon* pwcp) {
+  if (!byte_ct) {
+    return;
+  }
+  const uint64_t* vblock_fpos = pwcp->vblock_fpos;
+  uint32_t* vblock_crcs = pwcp->vblock_crcs;
+  const uint32_t last_vblock_idx = (pwcp->vidx - 1) / kPglVblockSize;
+  uint32_t vblock_idx = pwcp->crc_vblock_idx;
+  uint32_t crc = pwcp->crc_running;
+  uint64_t fpos = pwcp->vblock_fpos_offset;
+  for (; vblock_idx != last_vblock_idx; ++vblock_idx) {
+    const uint64_t next_vblock_fpos = vblock_fpos[vblock_idx + 1];
+    const uintptr_t cur_byte_ct = next_vblock_fpos - fpos;
+    vblock_crcs[vblock_idx] = Crc32c(crc, buf, cur_byte_ct);
+    crc = 0;
+    buf = &(buf[cur_byte_ct]);
+    fpos = next_vblock_fpos;
+  }
+  pwcp->crc_running = Crc32c(crc, buf, pwcp->vblock_fpos_offset + byte_ct - fpos);
+  pwcp->crc_vblock_idx = vblock_idx;
+}
+
 BoolErr SpgwFlush(STPgenWriter* spgwp) {
   PgenWriterCommon* pwcp = GetPwcp(spgwp);
   if (pwcp->fwrite_bufp >= &(pwcp->fwrite_buf[kPglFwriteBlockSize])) {
     const uintptr_t cur_byte_ct = pwcp->fwrite_bufp - pwcp->fwrite_buf;
+    SpgwUpdateVblockCrcs(pwcp->fwrite_buf, cur_byte_ct, pwcp);
     FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
     if (unlikely(fwrite_checked(pwcp->fwrite_buf, cur_byte_ct, *pgen_outfilep))) {
       return 1;
@@ -1125,9 +1168,11 @@ uint32_t PwcAppendBiallelicDifflistLimitedMain(const uintptr_t* __restrict rareg
   }
   const uint32_t difflist_viable = (difflist_common_geno != 1) && (difflist_len <= max_difflist_len);
   STD_ARRAY_REF(uint32_t, 4) ldbase_genocounts = pwcp->ldbase_genocounts;
+  const uint32_t force_ldbase = pwcp->force_ldbase;
+  pwcp->force_ldbase = 0;
   if (!(vidx % kPglVblockSize)) {
     pwcp->vblock_fpos[vidx / kPglVblockSize] = pwcp->vblock_fpos_offset + S_CAST(uintptr_t, pwcp->fwrite_bufp - pwcp->fwrite_buf);
-  } else if (difflist_len > sample_ctd64) {
+  } else if ((difflist_len > sample_ctd64) && (!force_ldbase)) {
     const uint32_t ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
     // number of changes between current genovec and LD reference is bounded
     // below by sum(genocounts[x] - ldbase_genocounts[x]) / 2
@@ -2218,6 +2263,7 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
   }
   const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
   fwrite_unlocked(pwcp->vblock_fpos, vblock_ct * sizeof(int64_t), 1, pgen_outfile);
+  uint32_t index_crc = Crc32c(0, pwcp->vblock_fpos, vblock_ct * sizeof(int64_t));
   const unsigned char* vrtype_buf_iter = R_CAST(unsigned char*, pwcp->vrtype_buf);
   const uint32_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
   const unsigned char* vrec_len_buf_iter = pwcp->vrec_len_buf;
@@ -2231,6 +2277,7 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
   for (; ; vrec_len_buf_iter = &(vrec_len_buf_iter[vrec_iter_incr])) {
     if (vrec_len_buf_iter >= vrec_len_buf_last) {
       if (vrec_len_buf_iter > vrec_len_buf_last) {
+        pwcp->index_crc = index_crc;
         return fclose_null(pgen_outfile_ptr)? kPglRetWriteFail : kPglRetSuccess;
       }
       const uint32_t vblock_size = ModNz(variant_ct, kPglVblockSize);
@@ -2240,12 +2287,14 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
     }
     // 4b(i): array of 4-bit or 1-byte vrtypes
     fwrite_unlocked(vrtype_buf_iter, vrtype_buf_iter_incr, 1, pgen_outfile);
+    index_crc = Crc32c(index_crc, vrtype_buf_iter, vrtype_buf_iter_incr);
     vrtype_buf_iter = &(vrtype_buf_iter[vrtype_buf_iter_incr]);
 
     // 4b(ii): array of variant record lengths
     if (unlikely(fwrite_checked(vrec_len_buf_iter, vrec_iter_incr, pgen_outfile))) {
       return kPglRetWriteFail;
     }
+    index_crc = Crc32c(index_crc, vrec_len_buf_iter, vrec_iter_incr);
 
     // 4b(iii): alt allele counts
     // not yet supported
@@ -2255,6 +2304,7 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
       if (unlikely(fwrite_checked(explicit_nonref_flags_iter, nonref_flags_write_byte_ct, pgen_outfile))) {
         return kPglRetWriteFail;
       }
+      index_crc = Crc32c(index_crc, explicit_nonref_flags_iter, nonref_flags_write_byte_ct);
       explicit_nonref_flags_iter = &(explicit_nonref_flags_iter[kPglVblockSize / kBitsPerWord]);
     }
   }
@@ -2263,9 +2313,13 @@ PglErr PwcFinish(PgenWriterCommon* pwcp, FILE** pgen_outfile_ptr) {
 PglErr SpgwFinish(STPgenWriter* spgwp) {
   PgenWriterCommon* pwcp = GetPwcp(spgwp);
   FILE** pgen_outfilep = GetPgenOutfilep(spgwp);
-  if (unlikely(fwrite_checked(pwcp->fwrite_buf, pwcp->fwrite_bufp - pwcp->fwrite_buf, *pgen_outfilep))) {
+  const uintptr_t cur_byte_ct = pwcp->fwrite_bufp - pwcp->fwrite_buf;
+  SpgwUpdateVblockCrcs(pwcp->fwrite_buf, cur_byte_ct, pwcp);
+  pwcp->vblock_crcs[pwcp->crc_vblock_idx] = pwcp->crc_running;
+  if (unlikely(fwrite_checked(pwcp->fwrite_buf, cur_byte_ct, *pgen_outfilep))) {
     return kPglRetWriteFail;
   }
+  pwcp->vblock_fpos_offset += cur_byte_ct;
   return PwcFinish(pwcp, pgen_outfilep);
 }
 
@@ -2279,6 +2333,7 @@ PglErr MpgwFlush(MTPgenWriter* mpgwp) {
     thread_ct = DivUp(variant_ct - vidx, kPglVblockSize);
   }
   uint64_t* vblock_fpos = pwcp->vblock_fpos;
+  uint32_t* vblock_crcs = pwcp->vblock_crcs;
   FILE* pgen_outfile = mpgwp->pgen_outfile;
   const uint32_t vidx_incr = (thread_ct - 1) * kPglVblockSize;
   uint64_t cur_vblock_fpos = ftello(pgen_outfile);
@@ -2286,6 +2341,7 @@ PglErr MpgwFlush(MTPgenWriter* mpgwp) {
     vblock_fpos[(vidx / kPglVblockSize) + tidx] = cur_vblock_fpos;
     PgenWriterCommon* cur_pwcp = mpgwp->pwcs[tidx];
     uintptr_t cur_vblock_byte_ct = cur_pwcp->fwrite_bufp - cur_pwcp->fwrite_buf;
+    vblock_crcs[(vidx / kPglVblockSize) + tidx] = Crc32c(0, cur_pwcp->fwrite_buf, cur_vblock_byte_ct);
     if (unlikely(fwrite_checked(cur_pwcp->fwrite_buf, cur_vblock_byte_ct, pgen_outfile))) {
       return kPglRetWriteFail;
     }
@@ -2297,9 +2353,29 @@ PglErr MpgwFlush(MTPgenWriter* mpgwp) {
     return kPglRetSuccess;
   }
   pwcp->vidx = variant_ct;
+  pwcp->vblock_fpos_offset = cur_vblock_fpos;
   return PwcFinish(pwcp, &(mpgwp->pgen_outfile));
 }
 
+PglErr PwcWriteCksum(const char* cksum_fname, const PgenWriterCommon* pwcp) {
+  FILE* cksum_outfile = fopen(cksum_fname, FOPEN_WB);
+  if (unlikely(!cksum_outfile)) {
+    return kPglRetOpenFail;
+  }
+  const uint32_t variant_ct = pwcp->variant_ct;
+  const uint64_t pgen_fsize = pwcp->vblock_fpos_offset;
+  fwrite_unlocked("l\x1b\x33\x00", 4, 1, cksum_outfile);
+  fwrite_unlocked(&variant_ct, sizeof(int32_t), 1, cksum_outfile);
+  fwrite_unlocked(&pgen_fsize, sizeof(int64_t), 1, cksum_outfile);
+  fwrite_unlocked(&(pwcp->index_crc), sizeof(int32_t), 1, cksum_outfile);
+  const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+  if (unlikely(fwrite_checked(pwcp->vblock_crcs, vblock_ct * sizeof(int32_t), cksum_outfile))) {
+    fclose(cksum_outfile);
+    return kPglRetWriteFail;
+  }
+  return fclose_null(&cksum_outfile)? kPglRetWriteFail : kPglRetSuccess;
+}
+
 BoolErr CleanupSpgw(STPgenWriter* spgwp, PglErr* reterrp) {
   // assume file is open if spgw.pgen_outfile is not null
   // memory is the responsibility of the caller for now
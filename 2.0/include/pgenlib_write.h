@@ -37,6 +37,8 @@ typedef struct PgenWriterCommonStruct {
   // there should be a single copy of these arrays shared by all threads.
   // allele_idx_offsets is read-only.
   uint64_t* vblock_fpos;
+  // CRC32C of each vblock's variant records, for the .pgen.cksum sidecar
+  uint32_t* vblock_crcs;
   unsigned char* vrec_len_buf;
   uintptr_t* vrtype_buf;
   const uintptr_t* allele_idx_offsets;
@@ -48,7 +50,8 @@ typedef struct PgenWriterCommonStruct {
   STD_ARRAY_DECL(uint32_t, 4, ldbase_genocounts);
 
   // should match ftello() return value in singlethreaded case, but be set to
-  // zero in multithreaded case
+  // zero in multithreaded case.  After the final flush, this is the .pgen
+  // byte size in both cases.
   uint64_t vblock_fpos_offset;
 
   // these must hold sample_ct entries
@@ -72,6 +75,19 @@ typedef struct PgenWriterCommonStruct {
   uintptr_t vrec_len_byte_ct;
 
   uint32_t vidx;
+
+  // if set, next biallelic hardcall record is not LD-compressed; see
+  // PwcForceLdbase()
+  uint32_t force_ldbase;
+
+  // singlethreaded writer flushes don't respect vblock boundaries, so the
+  // CRC of the current vblock is carried across them
+  uint32_t crc_vblock_idx;
+  uint32_t crc_running;
+
+  // CRC32C of the variant index (.pgen bytes 12 up to the first variant
+  // record), set by PwcFinish()
+  uint32_t index_crc;
 } PgenWriterCommon;
 
 // Given packed arrays of unphased biallelic genotypes in uncompressed plink2
@@ -166,6 +182,33 @@ PglErr MpgwInitPhase2(const char* __restrict fname, const uintptr_t* __restrict
 // trailing bits of genovec must be zeroed out
 void PwcAppendBiallelicGenovec(const uintptr_t* __restrict genovec, PgenWriterCommon* pwcp);
 
+// Prevents the next variant from being LD-compressed, so that it becomes the
+// LD base for the variants after it.  The writer normally only switches LD
+// bases when a variant can't be LD-compressed at all; a caller with lookahead
+// can use this to switch earlier when that pays off downstream.
+HEADER_INLINE void PwcForceLdbase(PgenWriterCommon* pwcp) {
+  pwcp->force_ldbase = 1;
+}
+
+// vrtype and record length of the most recently appended variant.
+HEADER_INLINE uint32_t PwcGetPrevVrtype(const PgenWriterCommon* pwcp) {
+  const uint32_t vidx = pwcp->vidx - 1;
+  if (!pwcp->phase_dosage_gflags) {
+    return (pwcp->vrtype_buf[vidx / kBitsPerWordD4] >> (4 * (vidx % kBitsPerWordD4))) & 15;
+  }
+  return R_CAST(const unsigned char*, pwcp->vrtype_buf)[vidx];
+}
+
+HEADER_INLINE uint32_t PwcGetPrevVrecLen(const PgenWriterCommon* pwcp) {
+  const uintptr_t vrec_len_byte_ct = pwcp->vrec_len_byte_ct;
+  return SubU32Load(&(pwcp->vrec_len_buf[(pwcp->vidx - 1) * vrec_len_byte_ct]), vrec_len_byte_ct);
+}
+
+// ldbase_genovec and genovec must be vector-aligned, with trailing bits
+// zeroed.  *ld_inv_diff_ctp is the number of differences after inverting
+// genovec (swapping hom ref and hom alt).
+void CountLdAndInvertedLdDiffs(const uintptr_t* __restrict ldbase_genovec, const uintptr_t* __restrict genovec, uint32_t sample_ct, uint32_t* ld_diff_ctp, uint32_t* ld_inv_diff_ctp);
+
 BoolErr SpgwFlush(STPgenWriter* spgwp);
 
 HEADER_INLINE PglErr SpgwAppendBiallelicGenovec(const uintptr_t* __restrict genovec, STPgenWriter* spgwp) {
@@ -325,6 +368,19 @@ PglErr MpgwFlush(MTPgenWriter* mpgwp);
 // plink2
 BoolErr CleanupSpgw(STPgenWriter* spgwp, PglErr* reterrp);
 
+// Writes the .pgen.cksum sidecar (see pgenlib_misc.h).  Must be called after
+// SpgwFinish()/the last MpgwFlush() succeeds, and before the writer's memory
+// is released.  Caller is responsible for printing open-fail error message.
+PglErr PwcWriteCksum(const char* cksum_fname, const PgenWriterCommon* pwcp);
+
+HEADER_INLINE PglErr SpgwWriteCksum(const char* cksum_fname, STPgenWriter* spgwp) {
+  return PwcWriteCksum(cksum_fname, &GET_PRIVATE(*spgwp, pwc));
+}
+
+HEADER_INLINE PglErr MpgwWriteCksum(const char* cksum_fname, MTPgenWriter* mpgwp) {
+  return PwcWriteCksum(cksum_fname, mpgwp->pwcs[0]);
+}
+
 BoolErr CleanupMpgw(MTPgenWriter* mpgwp, PglErr* reterrp);
 
 #ifdef __cplusplus
@@ -670,6 +670,62 @@ double ChisqToP(double chisq, uint32_t df) {
   return gamma_incomplete_imp2(df, chisq * 0.5, 1, nullptr);
 }
 
+double ChisqRealDfToP(double chisq, double df) {
+  // Generic series/continued-fraction split of gamma_incomplete_imp2(),
+  // without the integer and half-integer shortcuts.
+  if (!(chisq > 0.0)) {
+    return 1.0;
+  }
+  const double aa = df * 0.5;
+  const double xx = chisq * 0.5;
+  double prefix;
+  if (aa < 1) {
+    // regularized_gamma_prefix() assumes a == 0.5 when a < 1; use
+    //   z^a e^{-z} / Gamma(a) = (z^{a+1} e^{-z} / Gamma(a+1)) * a / z
+    // instead.
+    prefix = regularized_gamma_prefix(aa + 1, xx) * aa / xx;
+  } else {
+    prefix = regularized_gamma_prefix(aa, xx);
+  }
+  if (prefix == 0.0) {
+    return (xx > aa)? 0.0 : 1.0;
+  }
+  if (xx < aa + 1) {
+    const double lower = prefix * lower_gamma_series(aa, xx, 0) / aa;
+    return (lower < 1.0)? (1.0 - lower) : 0.0;
+  }
+  const double result = prefix * upper_gamma_fraction(aa, xx);
+  return (result < 1.0)? result : 1.0;
+}
+
+double PToChisqRealDf(double pval, double df) {
+  if (pval >= 1.0) {
+    return 0.0;
+  }
+  double lo = 0.0;
+  double hi = df + 10 * sqrt(2 * df) + 10;
+  while (ChisqRealDfToP(hi, df) > pval) {
+    lo = hi;
+    hi *= 2;
+    if (hi > 1e300) {
+      return hi;
+    }
+  }
+  // bisection is plenty fast for the few calls per test this gets
+  for (uint32_t iter_idx = 0; iter_idx != 128; ++iter_idx) {
+    const double mid = 0.5 * (lo + hi);
+    if (ChisqRealDfToP(mid, df) > pval) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+    if (hi - lo <= 1e-10 * hi) {
+      break;
+    }
+  }
+  return 0.5 * (lo + hi);
+}
+
 // ***** end thread-safe ChisqToP *****
 
 
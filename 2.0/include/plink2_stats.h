@@ -31,6 +31,13 @@ double ChisqToP(double chisq, uint32_t df);
 
 double ChisqToLnP(double chisq, uint32_t df);
 
+// Upper tail of the chi-square distribution with non-integer degrees of
+// freedom (df > 0).  ~6 significant digits.
+double ChisqRealDfToP(double chisq, double df);
+
+// Inverse of ChisqRealDfToP(), via bisection.
+double PToChisqRealDf(double pval, double df);
+
 // only handles df=1 and 2 for now, plan to support 4 later
 double PToChisq(double pval, uint32_t df);
 
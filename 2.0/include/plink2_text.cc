@@ -790,6 +790,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
 #endif
   const uint32_t enforced_max_line_blen = basep->enforced_max_line_blen;
   const char* new_fname = nullptr;
+  uint64_t seek_fpos = 0;
   const uint32_t is_token_stream = (enforced_max_line_blen == 0);
   while (1) {
     TxsInterrupt interrupt = kTxsInterruptNone;
@@ -1145,6 +1146,7 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
     // must be in critical section here, or be holding the mutex.
     if (interrupt == kTxsInterruptRetarget) {
       new_fname = syncp->new_fname;
+      seek_fpos = syncp->seek_fpos;
       syncp->interrupt = kTxsInterruptNone;
       syncp->reterr = kPglRetSuccess;
     }
@@ -1167,7 +1169,11 @@ THREAD_FUNC_DECL TextStreamThread(void* raw_arg) {
         }
       } else {
         // See TextFileRewind().
-        rewind(ff);
+        if (!seek_fpos) {
+          rewind(ff);
+        } else if (unlikely(fseeko(ff, seek_fpos, SEEK_SET))) {
+          goto TextStreamThread_READ_FAIL;
+        }
         if (file_type != kFileUncompressed) {
           if (file_type == kFileGzip) {
             rdsp->gz.ds.avail_in = 0;
@@ -1375,6 +1381,7 @@ PglErr TextStreamOpenEx(const char* fname, uint32_t enforced_max_line_blen, uint
     syncp->dst_reallocated = 0;
     syncp->interrupt = kTxsInterruptNone;
     syncp->new_fname = nullptr;
+    syncp->seek_fpos = 0;
 #ifdef _WIN32
     syncp->read_thread = nullptr;
     // apparently this can raise a low-memory exception in older Windows
@@ -1689,7 +1696,7 @@ PglErr TextSkipNz(uintptr_t skip_ct, TextStream* txs_ptr) {
 #endif
 }
 
-PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+static PglErr TextRetargetMain(const char* new_fname, uint64_t seek_fpos, TextStream* txs_ptr) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
   TextStreamSync* syncp = txsp->syncp;
@@ -1724,6 +1731,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   // outweigh disadvantages, but I'll wait till --pmerge development to make a
   // decision since that's the main function that actually cares.
   syncp->new_fname = new_fname;
+  syncp->seek_fpos = seek_fpos;
   SetEvent(syncp->consumer_progress_event);
   LeaveCriticalSection(critical_sectionp);
 #else
@@ -1750,6 +1758,7 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   syncp->dst_reallocated = 0;
   syncp->interrupt = kTxsInterruptRetarget;
   syncp->new_fname = new_fname;
+  syncp->seek_fpos = seek_fpos;
   syncp->consumer_progress_state = 1;
   pthread_cond_signal(consumer_progress_condvarp);
   pthread_mutex_unlock(sync_mutexp);
@@ -1759,6 +1768,15 @@ PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
   return kPglRetSuccess;
 }
 
+PglErr TextRetarget(const char* new_fname, TextStream* txs_ptr) {
+  return TextRetargetMain(new_fname, 0, txs_ptr);
+}
+
+PglErr TextSeek(uint64_t seek_fpos, TextStream* txs_ptr) {
+  assert(TextIsSeekable(txs_ptr));
+  return TextRetargetMain(nullptr, seek_fpos, txs_ptr);
+}
+
 BoolErr CleanupTextStream(TextStream* txs_ptr, PglErr* reterrp) {
   TextStreamMain* txsp = GetTxsp(txs_ptr);
   TextFileBase* basep = &txsp->base;
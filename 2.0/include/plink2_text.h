@@ -365,6 +365,8 @@ typedef struct TextStreamSyncStruct {
   uint32_t dst_reallocated;
   TxsInterrupt interrupt;
   const char* new_fname;
+  // raw file offset to restart from when new_fname is null
+  uint64_t seek_fpos;
 } TextStreamSync;
 
 typedef union {
@@ -608,6 +610,17 @@ HEADER_INLINE PglErr TextRewind(TextStream* txs_ptr) {
   return TextRetarget(nullptr, txs_ptr);
 }
 
+HEADER_INLINE uint32_t TextIsSeekable(const TextStream* txs_ptr) {
+  const FileCompressionType file_type = GET_PRIVATE(*txs_ptr, m).base.file_type;
+  return (file_type == kFileUncompressed) || (file_type == kFileZstd);
+}
+
+// Discards everything loaded so far, and resumes reading at the given raw
+// file offset.  For Zstd files, this must be the start of a frame; it's the
+// caller's responsibility to ensure a line also starts there (e.g. with a
+// .pvar.zst.vidx index).  Only valid when TextIsSeekable() is true.
+PglErr TextSeek(uint64_t seek_fpos, TextStream* txs_ptr);
+
 HEADER_INLINE const char* TextStreamError(const TextStream* txs_ptr) {
   return GET_PRIVATE(*txs_ptr, m).base.errmsg;
 }
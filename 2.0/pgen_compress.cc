@@ -1,51 +1,349 @@
 #include "include/pgenlib_read.h"
 #include "include/pgenlib_write.h"
+#include "include/plink2_thread.h"
 
-// #define SUBSET_TEST
-
-int32_t main(int32_t argc, char** argv) {
 #ifdef __cplusplus
-  using namespace plink2;
+using namespace plink2;
 #endif
+
+// Variant blocks (kPglVblockSize variants each) are independent as far as LD
+// compression is concerned, so each thread re-encodes one block per round
+// into its own MTPgenWriter buffer, and the main thread flushes the blocks in
+// order.
+
+CONSTI32(kMaxLdbaseLookahead, 64);
+
+static const char kVrtypeDescrips[8][32] = {
+  "uncompressed",
+  "1-bit",
+  "LD",
+  "LD, inverted",
+  "difflist, hom ref common",
+  "difflist, het common",
+  "difflist, hom alt common",
+  "difflist, missing common"
+};
+
+// Approximations of the writer's encoding decisions (see
+// PwcAppendBiallelicGenovecMain()), used to rank LD-base choices.
+typedef struct VrecEstimateStruct {
+  // rough size in bytes of the record when LD compression isn't used
+  uint32_t standalone_len;
+  // writer only LD-compresses when there are fewer differences than this
+  uint32_t ld_diff_threshold;
+} VrecEstimate;
+
+void EstimateVrec(const uintptr_t* genovec, uint32_t sample_ct, VrecEstimate* vrec_estimatep) {
+  STD_ARRAY_DECL(uint32_t, 4, genocounts);
+  GenoarrCountFreqsUnsafe(genovec, sample_ct, genocounts);
+  uint32_t most_common_geno = 0;
+  for (uint32_t geno = 1; geno != 4; ++geno) {
+    if (genocounts[geno] > genocounts[most_common_geno]) {
+      most_common_geno = geno;
+    }
+  }
+  uint32_t second_largest_geno_ct = 0;
+  for (uint32_t geno = 0; geno != 4; ++geno) {
+    if ((geno != most_common_geno) && (genocounts[geno] > second_largest_geno_ct)) {
+      second_largest_geno_ct = genocounts[geno];
+    }
+  }
+  const uint32_t difflist_len = sample_ct - genocounts[most_common_geno];
+  const uint32_t rare_2_geno_ct_sum = difflist_len - second_largest_geno_ct;
+  const uint32_t sample_ctd8 = sample_ct / 8;
+  const uint32_t sample_ctd64 = sample_ct / 64;
+  const uint32_t max_difflist_len = MINV(sample_ctd8, sample_ctd8 - 2 * sample_ctd64 + rare_2_geno_ct_sum);
+  const uint32_t difflist_viable = (most_common_geno != 1) && (difflist_len <= max_difflist_len);
+  vrec_estimatep->ld_diff_threshold = 0;
+  if (difflist_len > sample_ctd64) {
+    vrec_estimatep->ld_diff_threshold = difflist_viable? (difflist_len - sample_ctd64) : max_difflist_len;
+  }
+  // difflist entries average 10-11 bits
+  if (difflist_viable) {
+    vrec_estimatep->standalone_len = (difflist_len * 11 + 7) / 8;
+  } else if (rare_2_geno_ct_sum < sample_ct / (2 * kPglMaxDifflistLenDivisor)) {
+    vrec_estimatep->standalone_len = DivUp(sample_ct, CHAR_BIT) + (rare_2_geno_ct_sum * 11 + 7) / 8;
+  } else {
+    vrec_estimatep->standalone_len = NypCtToByteCt(sample_ct);
+  }
+}
+
+// Estimated record size of genovec given LD base ldbase_genovec.
+uint32_t EstimateLdVrecLen(const uintptr_t* ldbase_genovec, const uintptr_t* genovec, uint32_t sample_ct, const VrecEstimate* vrec_estimatep) {
+  uint32_t ld_diff_ct;
+  uint32_t ld_inv_diff_ct;
+  CountLdAndInvertedLdDiffs(ldbase_genovec, genovec, sample_ct, &ld_diff_ct, &ld_inv_diff_ct);
+  const uint32_t diff_ct = MINV(ld_diff_ct, ld_inv_diff_ct);
+  if (diff_ct >= vrec_estimatep->ld_diff_threshold) {
+    return vrec_estimatep->standalone_len;
+  }
+  return (diff_ct * 11 + 7) / 8;
+}
+
+typedef struct CompressCtxStruct {
+  uint32_t sample_ct;
+  uint32_t variant_ct;
+  // 0 = let the writer pick LD bases on its own
+  uint32_t ldbase_lookahead;
+  uint32_t max_simple_difflist_len;
+  uint32_t max_difflist_len;
+  PgrSampleSubsetIndex pssi;
+
+  PgenReader** pgr_ptrs;
+  PgenWriterCommon** pwcs;
+
+  // ldbase_lookahead + 2 genovecs per thread (lookahead ring buffer, followed
+  // by current LD base) when ldbase_lookahead is nonzero, otherwise 1
+  uintptr_t** thread_genovecs;
+  uintptr_t** thread_raregenos;
+  uint32_t** thread_difflist_sample_ids;
+
+  uint64_t* thread_vrtype_cts;  // 16 per thread
+  uint64_t* thread_vrtype_byte_cts;  // 16 per thread
+
+  uint32_t cur_vblock_idx_start;
+
+  PglErr* thread_reterrs;
+  uint32_t* thread_err_vidxs;
+} CompressCtx;
+
+static inline void RecordVrtype(const PgenWriterCommon* pwcp, uint64_t* vrtype_cts, uint64_t* vrtype_byte_cts) {
+  const uint32_t vrtype = PwcGetPrevVrtype(pwcp);
+  vrtype_cts[vrtype] += 1;
+  vrtype_byte_cts[vrtype] += PwcGetPrevVrecLen(pwcp);
+}
+
+PglErr CompressVblockDifflist(uint32_t tidx, uint32_t vidx_start, uint32_t vidx_end, CompressCtx* ctx, uint32_t* err_vidxp) {
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t max_simple_difflist_len = ctx->max_simple_difflist_len;
+  const uint32_t max_difflist_len = ctx->max_difflist_len;
+  const PgrSampleSubsetIndex pssi = ctx->pssi;
+  PgenReader* pgrp = ctx->pgr_ptrs[tidx];
+  PgenWriterCommon* pwcp = ctx->pwcs[tidx];
+  uintptr_t* genovec = ctx->thread_genovecs[tidx];
+  uintptr_t* raregeno = ctx->thread_raregenos[tidx];
+  uint32_t* difflist_sample_ids = ctx->thread_difflist_sample_ids[tidx];
+  uint64_t* vrtype_cts = &(ctx->thread_vrtype_cts[tidx * 16]);
+  uint64_t* vrtype_byte_cts = &(ctx->thread_vrtype_byte_cts[tidx * 16]);
+  for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+    uint32_t difflist_common_geno;
+    uint32_t difflist_len;
+    PglErr reterr = PgrGetDifflistOrGenovec(nullptr, pssi, sample_ct, max_simple_difflist_len, vidx, pgrp, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+    if (unlikely(reterr)) {
+      *err_vidxp = vidx;
+      return reterr;
+    }
+    if (difflist_common_geno == UINT32_MAX) {
+      ZeroTrailingNyps(sample_ct, genovec);
+      PwcAppendBiallelicGenovec(genovec, pwcp);
+    } else if (difflist_len <= max_difflist_len) {
+      ZeroTrailingNyps(difflist_len, raregeno);
+      difflist_sample_ids[difflist_len] = sample_ct;
+      PwcAppendBiallelicDifflistLimited(raregeno, difflist_sample_ids, difflist_common_geno, difflist_len, pwcp);
+    } else {
+      PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, sample_ct, difflist_len, genovec);
+      ZeroTrailingNyps(sample_ct, genovec);
+      PwcAppendBiallelicGenovec(genovec, pwcp);
+    }
+    RecordVrtype(pwcp, vrtype_cts, vrtype_byte_cts);
+  }
+  return kPglRetSuccess;
+}
+
+// Before appending variant v, compare three options over the next
+// ldbase_lookahead variants in the block:
+// 1. keep the current LD base
+// 2. save v without LD compression, so that it becomes the LD base
+// 3. same as 2, but for v+1
+// and force option 2 when its estimated total size is smallest.  The writer
+// on its own only does this when v can't be LD-compressed at all, which lets
+// a stale base linger after LD with it has mostly decayed.
+PglErr CompressVblockLookahead(uint32_t tidx, uint32_t vidx_start, uint32_t vidx_end, CompressCtx* ctx, uint32_t* err_vidxp) {
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t lookahead = ctx->ldbase_lookahead;
+  const uint32_t ring_size = lookahead + 1;
+  const PgrSampleSubsetIndex pssi = ctx->pssi;
+  PgenReader* pgrp = ctx->pgr_ptrs[tidx];
+  PgenWriterCommon* pwcp = ctx->pwcs[tidx];
+  const uintptr_t genovec_stride = NypCtToVecCt(sample_ct) * kWordsPerVec;
+  uintptr_t* ring = ctx->thread_genovecs[tidx];
+  uintptr_t* ldbase_genovec = &(ring[ring_size * genovec_stride]);
+  uint64_t* vrtype_cts = &(ctx->thread_vrtype_cts[tidx * 16]);
+  uint64_t* vrtype_byte_cts = &(ctx->thread_vrtype_byte_cts[tidx * 16]);
+  // per ring slot: standalone estimates, and size estimate when
+  // LD-compressed against the current base (valid iff
+  // base_cost_epochs[slot] == ldbase_epoch)
+  VrecEstimate vrec_estimates[kMaxLdbaseLookahead + 1];
+  uint32_t base_vrec_lens[kMaxLdbaseLookahead + 1];
+  uint32_t base_cost_epochs[kMaxLdbaseLookahead + 1];
+  uint32_t ldbase_epoch = 0;
+  const uint32_t preload_end = MINV(vidx_start + ring_size, vidx_end);
+  for (uint32_t vidx = vidx_start; vidx != preload_end; ++vidx) {
+    const uint32_t slot = (vidx - vidx_start) % ring_size;
+    uintptr_t* cur_genovec = &(ring[slot * genovec_stride]);
+    PglErr reterr = PgrGet(nullptr, pssi, sample_ct, vidx, pgrp, cur_genovec);
+    if (unlikely(reterr)) {
+      *err_vidxp = vidx;
+      return reterr;
+    }
+    ZeroTrailingNyps(sample_ct, cur_genovec);
+    EstimateVrec(cur_genovec, sample_ct, &(vrec_estimates[slot]));
+    base_cost_epochs[slot] = UINT32_MAX;
+  }
+  for (uint32_t vidx = vidx_start; vidx != vidx_end; ++vidx) {
+    const uint32_t slot = (vidx - vidx_start) % ring_size;
+    uintptr_t* cur_genovec = &(ring[slot * genovec_stride]);
+    if (vidx != vidx_start) {
+      if (base_cost_epochs[slot] != ldbase_epoch) {
+        base_vrec_lens[slot] = EstimateLdVrecLen(ldbase_genovec, cur_genovec, sample_ct, &(vrec_estimates[slot]));
+        base_cost_epochs[slot] = ldbase_epoch;
+      }
+      // nothing to decide if the writer won't LD-compress this anyway
+      if (base_vrec_lens[slot] < vrec_estimates[slot].standalone_len) {
+        // Compare rebasing here against (i) keeping the current base
+        // throughout the window, and (ii) rebasing at the next variant
+        // instead.  Without (ii), long windows almost always favor rebasing
+        // immediately, even when a slightly later base is better.
+        uint64_t keep_cost = base_vrec_lens[slot];
+        uint64_t rebase_cost = vrec_estimates[slot].standalone_len;
+        uint64_t defer_cost = UINT64_MAX;
+        const uintptr_t* next_genovec = nullptr;
+        const uint32_t window_end = MINV(vidx + ring_size, vidx_end);
+        for (uint32_t vidx2 = vidx + 1; vidx2 != window_end; ++vidx2) {
+          const uint32_t slot2 = (vidx2 - vidx_start) % ring_size;
+          const uintptr_t* genovec2 = &(ring[slot2 * genovec_stride]);
+          if (base_cost_epochs[slot2] != ldbase_epoch) {
+            base_vrec_lens[slot2] = EstimateLdVrecLen(ldbase_genovec, genovec2, sample_ct, &(vrec_estimates[slot2]));
+            base_cost_epochs[slot2] = ldbase_epoch;
+          }
+          rebase_cost += EstimateLdVrecLen(cur_genovec, genovec2, sample_ct, &(vrec_estimates[slot2]));
+          if (!next_genovec) {
+            next_genovec = genovec2;
+            defer_cost = keep_cost + vrec_estimates[slot2].standalone_len;
+          } else {
+            defer_cost += EstimateLdVrecLen(next_genovec, genovec2, sample_ct, &(vrec_estimates[slot2]));
+          }
+          keep_cost += base_vrec_lens[slot2];
+          if (base_vrec_lens[slot2] == vrec_estimates[slot2].standalone_len) {
+            // if we keep the current base, the writer switches to vidx2 on
+            // its own, so the options converge past this point
+            break;
+          }
+        }
+        if ((rebase_cost < keep_cost) && (rebase_cost <= defer_cost)) {
+          PwcForceLdbase(pwcp);
+        }
+      }
+    }
+    PwcAppendBiallelicGenovec(cur_genovec, pwcp);
+    RecordVrtype(pwcp, vrtype_cts, vrtype_byte_cts);
+    const uint32_t vrtype = PwcGetPrevVrtype(pwcp);
+    if ((vrtype & 6) != 2) {
+      // writer switched to this variant as the LD base
+      memcpy(ldbase_genovec, cur_genovec, genovec_stride * sizeof(intptr_t));
+      ++ldbase_epoch;
+    }
+    // refill slot with the next variant past the window
+    const uint32_t next_vidx = vidx + ring_size;
+    if (next_vidx < vidx_end) {
+      PglErr reterr = PgrGet(nullptr, pssi, sample_ct, next_vidx, pgrp, cur_genovec);
+      if (unlikely(reterr)) {
+        *err_vidxp = next_vidx;
+        return reterr;
+      }
+      ZeroTrailingNyps(sample_ct, cur_genovec);
+      EstimateVrec(cur_genovec, sample_ct, &(vrec_estimates[slot]));
+      base_cost_epochs[slot] = UINT32_MAX;
+    }
+  }
+  return kPglRetSuccess;
+}
+
+void CompressMain(uint32_t tidx, CompressCtx* ctx) {
+  const uint32_t variant_ct = ctx->variant_ct;
+  const uint64_t vidx_start = (ctx->cur_vblock_idx_start + S_CAST(uint64_t, tidx)) * kPglVblockSize;
+  if (vidx_start >= variant_ct) {
+    return;
+  }
+  const uint32_t vidx_end = MINV(vidx_start + kPglVblockSize, variant_ct);
+  PglErr reterr;
+  if (ctx->ldbase_lookahead) {
+    reterr = CompressVblockLookahead(tidx, vidx_start, vidx_end, ctx, &(ctx->thread_err_vidxs[tidx]));
+  } else {
+    reterr = CompressVblockDifflist(tidx, vidx_start, vidx_end, ctx, &(ctx->thread_err_vidxs[tidx]));
+  }
+  ctx->thread_reterrs[tidx] = reterr;
+}
+
+THREAD_FUNC_DECL CompressThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  CompressCtx* ctx = S_CAST(CompressCtx*, arg->sharedp->context);
+  do {
+    CompressMain(tidx, ctx);
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+int32_t main(int32_t argc, char** argv) {
   PglErr reterr = kPglRetSuccess;
   unsigned char* pgfi_alloc = nullptr;
-  unsigned char* pgr_alloc = nullptr;
-  unsigned char* spgw_alloc = nullptr;
+  unsigned char* pgr_allocs = nullptr;
+  unsigned char* mpgw_alloc = nullptr;
+  unsigned char* thread_alloc = nullptr;
   uintptr_t* genovec = nullptr;
-  uintptr_t* raregeno = nullptr;
-  uintptr_t* sample_include = nullptr;
-  uint32_t* sample_include_cumulative_popcounts = nullptr;
-  uint32_t* difflist_sample_ids = nullptr;
+  MTPgenWriter* mpgwp = nullptr;
+  PgenReader* pgrs = nullptr;
+  uint32_t pgr_ct = 0;
   FILE* outfile = nullptr;
   PgenHeaderCtrl header_ctrl;
-  STPgenWriter spgw;
-  uint32_t write_sample_ct;
   PgenFileInfo pgfi;
-  PgenReader pgr;
+  ThreadGroup tg;
   PreinitPgfi(&pgfi);
-  PreinitPgr(&pgr);
-  PreinitSpgw(&spgw);
+  PreinitThreads(&tg);
   {
     const uint32_t use_mmap = 0;
-    if ((argc < 3) || (argc > 5)) {
-      fputs(
-"Usage:\n"
-"pgen_compress <input .bed or .pgen> <output filename> [sample_ct]\n"
-"  (sample_ct is required when loading a .bed file)\n"
-"pgen_compress -u <input .pgen> <output .bed>\n"
-            , stdout);
-      goto main_ret_INVALID_CMDLINE;
+    uint32_t max_thread_ct = 0;
+    uint32_t ldbase_lookahead = 0;
+    uint32_t argi = 1;
+    for (; argi < S_CAST(uint32_t, argc); argi += 2) {
+      const char* flag = argv[argi];
+      if ((flag[0] != '-') || (!flag[1]) || flag[2] || ((flag[1] != 't') && (flag[1] != 'l'))) {
+        break;
+      }
+      if (argi + 1 == S_CAST(uint32_t, argc)) {
+        goto main_ret_USAGE;
+      }
+      if (flag[1] == 't') {
+        if (ScanPosintDefcap(argv[argi + 1], &max_thread_ct)) {
+          goto main_ret_USAGE;
+        }
+      } else {
+        if (ScanUintDefcap(argv[argi + 1], &ldbase_lookahead) || (ldbase_lookahead > kMaxLdbaseLookahead)) {
+          goto main_ret_USAGE;
+        }
+      }
+    }
+    const uint32_t pos_argc = argc - argi;
+    char** pos_argv = &(argv[argi]);
+    if ((pos_argc < 2) || (pos_argc > 4)) {
+      goto main_ret_USAGE;
+    }
+    const uint32_t decompress = (pos_argv[0][0] == '-') && (pos_argv[0][1] == 'u') && (pos_argv[0][2] == '\0');
+    if ((pos_argc == 4) && (!decompress)) {
+      goto main_ret_USAGE;
     }
-    const uint32_t decompress = (argv[1][0] == '-') && (argv[1][1] == 'u') && (argv[1][2] == '\0');
     uint32_t sample_ct = 0xffffffffU;
-    if (S_CAST(uint32_t, argc) == 4 + decompress) {
-      if (ScanPosintDefcap(argv[3 + decompress], &sample_ct)) {
+    if (pos_argc == 3 + decompress) {
+      if (ScanPosintDefcap(pos_argv[2 + decompress], &sample_ct)) {
         goto main_ret_INVALID_CMDLINE;
       }
     }
+    const char* in_fname = pos_argv[decompress];
+    const char* out_fname = pos_argv[1 + decompress];
     char errstr_buf[kPglErrstrBufBlen];
     uintptr_t cur_alloc_cacheline_ct;
-    reterr = PgfiInitPhase1(argv[1 + decompress], 0xffffffffU, sample_ct, use_mmap, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, errstr_buf);
+    reterr = PgfiInitPhase1(in_fname, 0xffffffffU, sample_ct, use_mmap, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, errstr_buf);
     if (reterr) {
       fputs(errstr_buf, stderr);
       goto main_ret_1;
@@ -64,44 +362,64 @@ int32_t main(int32_t argc, char** argv) {
       goto main_ret_NOMEM;
     }
     uint32_t max_vrec_width;
+    uintptr_t pgr_alloc_cacheline_ct;
     // todo: test block-fread
-    reterr = PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &cur_alloc_cacheline_ct, errstr_buf);
+    reterr = PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &pgr_alloc_cacheline_ct, errstr_buf);
     if (reterr) {
       fputs(errstr_buf, stderr);
       goto main_ret_1;
     }
-    if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &pgr_alloc)) {
+    pgr_alloc_cacheline_ct += DivUp(max_vrec_width, kCacheline);
+
+    // one reader per compression thread; decompression is single-threaded
+    uint32_t calc_thread_ct = 1;
+    if (!decompress) {
+      if (!max_thread_ct) {
+        max_thread_ct = NumCpu(nullptr);
+      }
+      calc_thread_ct = MINV(max_thread_ct, DivUp(variant_ct, kPglVblockSize));
+    }
+    pgrs = S_CAST(PgenReader*, malloc(calc_thread_ct * sizeof(PgenReader)));
+    if (!pgrs) {
       goto main_ret_NOMEM;
     }
-
-    // modify this when trying block-fread
-    reterr = PgrInit(use_mmap? nullptr : argv[1 + decompress], max_vrec_width, &pgfi, &pgr, pgr_alloc);
-    if (reterr) {
-      fprintf(stderr, "pgr_init error %u\n", S_CAST(uint32_t, reterr));
-      goto main_ret_1;
+    for (; pgr_ct != calc_thread_ct; ++pgr_ct) {
+      PreinitPgr(&(pgrs[pgr_ct]));
+    }
+    if (cachealigned_malloc(calc_thread_ct * pgr_alloc_cacheline_ct * kCacheline, &pgr_allocs)) {
+      goto main_ret_NOMEM;
+    }
+    for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+      // modify this when trying block-fread
+      reterr = PgrInit(in_fname, max_vrec_width, &pgfi, &(pgrs[tidx]), &(pgr_allocs[tidx * pgr_alloc_cacheline_ct * kCacheline]));
+      if (reterr) {
+        fprintf(stderr, "pgr_init error %u\n", S_CAST(uint32_t, reterr));
+        goto main_ret_1;
+      }
     }
 
-    if (S_CAST(uint32_t, argc) == 4 + decompress) {
+    if (pos_argc == 3 + decompress) {
       printf("%u variant%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s");
     } else {
       printf("%u variant%s and %u sample%s detected.\n", variant_ct, (variant_ct == 1)? "" : "s", sample_ct, (sample_ct == 1)? "" : "s");
     }
-    if (cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec)) {
-      goto main_ret_NOMEM;
-    }
     if (decompress) {
-      outfile = fopen(argv[3], FOPEN_WB);
+      if (cachealigned_malloc(NypCtToVecCt(sample_ct) * kBytesPerVec, &genovec)) {
+        goto main_ret_NOMEM;
+      }
+      outfile = fopen(out_fname, FOPEN_WB);
       if (!outfile) {
         goto main_ret_OPEN_FAIL;
       }
+      PgenReader* pgrp = &(pgrs[0]);
       PgrSampleSubsetIndex pssi;
-      PgrClearSampleSubsetIndex(&pgr, &pssi);
+      PgrClearSampleSubsetIndex(pgrp, &pssi);
       const uintptr_t final_mask = (k1LU << ((sample_ct % kBitsPerWordD2) * 2)) - k1LU;
       const uint32_t final_widx = NypCtToWordCt(sample_ct) - 1;
       const uint32_t variant_byte_ct = (sample_ct + 3) / 4;
       fwrite("l\x1b\x01", 3, 1, outfile);
       for (uint32_t vidx = 0; vidx < variant_ct; ) {
-        reterr = PgrGet(nullptr, pssi, sample_ct, vidx, &pgr, genovec);
+        reterr = PgrGet(nullptr, pssi, sample_ct, vidx, pgrp, genovec);
         if (reterr) {
           fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
           goto main_ret_1;
@@ -123,81 +441,162 @@ int32_t main(int32_t argc, char** argv) {
       printf("\n");
       goto main_ret_1;
     }
-#ifdef SUBSET_TEST
-    // write_sample_ct = sample_ct - 3;
-    write_sample_ct = 3;
-#else
-    write_sample_ct = sample_ct;
+
+    uintptr_t alloc_base_cacheline_ct;
+    uint64_t mpgw_per_thread_cacheline_ct;
+    uint32_t vrec_len_byte_ct;
+    uint64_t vblock_cacheline_ct;
+    MpgwInitPhase1(nullptr, variant_ct, sample_ct, kfPgenGlobal0, &alloc_base_cacheline_ct, &mpgw_per_thread_cacheline_ct, &vrec_len_byte_ct, &vblock_cacheline_ct);
+#ifndef __LP64__
+    if ((mpgw_per_thread_cacheline_ct > (0x7fffffff / kCacheline)) || (vblock_cacheline_ct > (0x7fffffff / kCacheline))) {
+      goto main_ret_NOMEM;
+    }
 #endif
-    uint32_t max_vrec_len;
-    reterr = SpgwInitPhase1(argv[2], nullptr, nullptr, variant_ct, write_sample_ct, 0, kfPgenGlobal0, 2, &spgw, &cur_alloc_cacheline_ct, &max_vrec_len);
+    mpgwp = S_CAST(MTPgenWriter*, malloc(sizeof(MTPgenWriter) + calc_thread_ct * sizeof(intptr_t)));
+    if (!mpgwp) {
+      goto main_ret_NOMEM;
+    }
+    mpgwp->pgen_outfile = nullptr;
+    if (cachealigned_malloc((alloc_base_cacheline_ct + mpgw_per_thread_cacheline_ct * calc_thread_ct) * kCacheline, &mpgw_alloc)) {
+      goto main_ret_NOMEM;
+    }
+    reterr = MpgwInitPhase2(out_fname, nullptr, nullptr, variant_ct, sample_ct, kfPgenGlobal0, 2, vrec_len_byte_ct, vblock_cacheline_ct, calc_thread_ct, mpgw_alloc, mpgwp);
     if (reterr) {
-      fprintf(stderr, "compression phase 1 error %u\n", S_CAST(uint32_t, reterr));
+      fprintf(stderr, "compression phase 2 error %u\n", S_CAST(uint32_t, reterr));
       goto main_ret_1;
     }
-    if (cachealigned_malloc(cur_alloc_cacheline_ct * kCacheline, &spgw_alloc)) {
+
+    CompressCtx ctx;
+    ctx.sample_ct = sample_ct;
+    ctx.variant_ct = variant_ct;
+    ctx.ldbase_lookahead = ldbase_lookahead;
+    ctx.max_simple_difflist_len = sample_ct / kBitsPerWordD2;
+    ctx.max_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
+    PgrClearSampleSubsetIndex(&(pgrs[0]), &ctx.pssi);
+    ctx.pwcs = &(mpgwp->pwcs[0]);
+    const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
+    const uintptr_t genovec_cacheline_ct = NypCtToCachelineCt(sample_ct);
+    const uintptr_t genovecs_cacheline_ct = genovec_cacheline_ct * (ldbase_lookahead? (ldbase_lookahead + 2) : 1);
+    const uintptr_t raregeno_cacheline_ct = NypCtToCachelineCt(max_returned_difflist_len);
+    const uintptr_t difflist_sample_ids_cacheline_ct = Int32CtToCachelineCt(max_returned_difflist_len + 1);
+    const uintptr_t thread_cacheline_ct = genovecs_cacheline_ct + raregeno_cacheline_ct + difflist_sample_ids_cacheline_ct;
+    const uintptr_t ptrs_cacheline_ct = DivUp(calc_thread_ct * sizeof(intptr_t), kCacheline);
+    const uintptr_t stats_cacheline_ct = 2 * Int64CtToCachelineCt(16 * calc_thread_ct);
+    const uintptr_t err_cacheline_ct = 2 * Int32CtToCachelineCt(calc_thread_ct);
+    if (cachealigned_malloc((4 * ptrs_cacheline_ct + stats_cacheline_ct + err_cacheline_ct + thread_cacheline_ct * calc_thread_ct) * kCacheline, &thread_alloc)) {
       goto main_ret_NOMEM;
     }
-    SpgwInitPhase2(max_vrec_len, &spgw, spgw_alloc);
+    unsigned char* alloc_iter = thread_alloc;
+    ctx.pgr_ptrs = R_CAST(PgenReader**, alloc_iter);
+    alloc_iter = &(alloc_iter[ptrs_cacheline_ct * kCacheline]);
+    ctx.thread_genovecs = R_CAST(uintptr_t**, alloc_iter);
+    alloc_iter = &(alloc_iter[ptrs_cacheline_ct * kCacheline]);
+    ctx.thread_raregenos = R_CAST(uintptr_t**, alloc_iter);
+    alloc_iter = &(alloc_iter[ptrs_cacheline_ct * kCacheline]);
+    ctx.thread_difflist_sample_ids = R_CAST(uint32_t**, alloc_iter);
+    alloc_iter = &(alloc_iter[ptrs_cacheline_ct * kCacheline]);
+    ctx.thread_vrtype_cts = R_CAST(uint64_t*, alloc_iter);
+    alloc_iter = &(alloc_iter[Int64CtToCachelineCt(16 * calc_thread_ct) * kCacheline]);
+    ctx.thread_vrtype_byte_cts = R_CAST(uint64_t*, alloc_iter);
+    alloc_iter = &(alloc_iter[Int64CtToCachelineCt(16 * calc_thread_ct) * kCacheline]);
+    ctx.thread_reterrs = R_CAST(PglErr*, alloc_iter);
+    alloc_iter = &(alloc_iter[Int32CtToCachelineCt(calc_thread_ct) * kCacheline]);
+    ctx.thread_err_vidxs = R_CAST(uint32_t*, alloc_iter);
+    alloc_iter = &(alloc_iter[Int32CtToCachelineCt(calc_thread_ct) * kCacheline]);
+    for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+      ctx.pgr_ptrs[tidx] = &(pgrs[tidx]);
+      ctx.thread_genovecs[tidx] = R_CAST(uintptr_t*, alloc_iter);
+      alloc_iter = &(alloc_iter[genovecs_cacheline_ct * kCacheline]);
+      ctx.thread_raregenos[tidx] = R_CAST(uintptr_t*, alloc_iter);
+      alloc_iter = &(alloc_iter[raregeno_cacheline_ct * kCacheline]);
+      ctx.thread_difflist_sample_ids[tidx] = R_CAST(uint32_t*, alloc_iter);
+      alloc_iter = &(alloc_iter[difflist_sample_ids_cacheline_ct * kCacheline]);
+      ctx.thread_reterrs[tidx] = kPglRetSuccess;
+    }
+    ZeroU64Arr(16 * calc_thread_ct, ctx.thread_vrtype_cts);
+    ZeroU64Arr(16 * calc_thread_ct, ctx.thread_vrtype_byte_cts);
 
-    const uint32_t max_simple_difflist_len = sample_ct / kBitsPerWordD2;
-    const uint32_t max_returned_difflist_len = 2 * (sample_ct / kPglMaxDifflistLenDivisor);
-    const uint32_t max_difflist_len = 2 * (write_sample_ct / kPglMaxDifflistLenDivisor);
-    if (cachealigned_malloc(RoundUpPow2((max_returned_difflist_len + 3) / 4, kCacheline), &raregeno) ||
-        cachealigned_malloc(RoundUpPow2((sample_ct + 7) / 8, kCacheline), &sample_include) ||
-        cachealigned_malloc(RoundUpPow2((1 + (sample_ct / kBitsPerWord)) * sizeof(int32_t), kCacheline), &sample_include_cumulative_popcounts) ||
-        cachealigned_malloc(RoundUpPow2((max_returned_difflist_len + 1) * sizeof(int32_t), kCacheline), &difflist_sample_ids)) {
+    const uint32_t last_tidx = calc_thread_ct - 1;
+    if (SetThreadCt0(last_tidx, &tg)) {
       goto main_ret_NOMEM;
     }
-#ifdef SUBSET_TEST
-    fill_ulong_zero(BitCtToWordCt(sample_ct), sample_include);
-    SetBit(123, sample_include);
-    SetBit(127, sample_include);
-    SetBit(320, sample_include);
-    // ClearBit(123, sample_include);
-    // ClearBit(127, sample_include);
-    // ClearBit(320, sample_include);
-#else
-    SetAllBits(sample_ct, sample_include);
-#endif
-    FillCumulativePopcounts(sample_include, 1 + (sample_ct / kBitsPerWord), sample_include_cumulative_popcounts);
-    PgrSampleSubsetIndex pssi;
-    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, &pgr, &pssi);
-    for (uint32_t vidx = 0; vidx < variant_ct; ) {
-      uint32_t difflist_common_geno;
-      uint32_t difflist_len;
-      reterr = PgrGetDifflistOrGenovec(sample_include, pssi, write_sample_ct, max_simple_difflist_len, vidx, &pgr, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
-      if (reterr) {
-        fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
-        goto main_ret_1;
+    SetThreadFuncAndData(CompressThread, &ctx, &tg);
+    const uint32_t vblock_ct = DivUp(variant_ct, kPglVblockSize);
+    for (uint32_t vblock_idx_start = 0; vblock_idx_start < vblock_ct; vblock_idx_start += calc_thread_ct) {
+      ctx.cur_vblock_idx_start = vblock_idx_start;
+      if (vblock_idx_start + calc_thread_ct >= vblock_ct) {
+        DeclareLastThreadBlock(&tg);
       }
-      if (difflist_common_geno == 0xffffffffU) {
-        ZeroTrailingBits(write_sample_ct * 2, genovec);
-        reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
-      } else if (difflist_len <= max_difflist_len) {
-        ZeroTrailingBits(2 * difflist_len, raregeno);
-        difflist_sample_ids[difflist_len] = write_sample_ct;
-        reterr = SpgwAppendBiallelicDifflistLimited(raregeno, difflist_sample_ids, difflist_common_geno, difflist_len, &spgw);
-      } else {
-        PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, write_sample_ct, difflist_len, genovec);
-        ZeroTrailingBits(write_sample_ct * 2, genovec);
-        reterr = SpgwAppendBiallelicGenovec(genovec, &spgw);
+      if (last_tidx) {
+        if (SpawnThreads(&tg)) {
+          fprintf(stderr, "\nthread creation error\n");
+          reterr = kPglRetThreadCreateFail;
+          goto main_ret_1;
+        }
+      }
+      CompressMain(last_tidx, &ctx);
+      if (last_tidx) {
+        JoinThreads(&tg);
       }
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        if (ctx.thread_reterrs[tidx]) {
+          reterr = ctx.thread_reterrs[tidx];
+          fprintf(stderr, "\nread error %u, vidx=%u\n", S_CAST(uint32_t, reterr), ctx.thread_err_vidxs[tidx]);
+          goto main_ret_1;
+        }
+      }
+      reterr = MpgwFlush(mpgwp);
       if (reterr) {
-        fprintf(stderr, "\ncompress/write error %u, vidx=%u\n", S_CAST(uint32_t, reterr), vidx);
+        fprintf(stderr, "\ncompress/write error %u\n", S_CAST(uint32_t, reterr));
         goto main_ret_1;
       }
-      ++vidx;
-      if (!(vidx % 100000)) {
-        printf("\r%u.%um variants compressed.", vidx / 1000000, (vidx / 100000) % 10);
-        fflush(stdout);
+      const uint32_t vidx_end = MINV(S_CAST(uint64_t, vblock_idx_start + calc_thread_ct) * kPglVblockSize, variant_ct);
+      printf("\r%u.%um variants compressed.", vidx_end / 1000000, (vidx_end / 100000) % 10);
+      fflush(stdout);
+    }
+    // last MpgwFlush() call closed the file
+    free(mpgwp);
+    mpgwp = nullptr;
+    printf("\n");
+
+    uint64_t vrtype_cts[16];
+    uint64_t vrtype_byte_cts[16];
+    ZeroU64Arr(16, vrtype_cts);
+    ZeroU64Arr(16, vrtype_byte_cts);
+    uint64_t tot_byte_ct = 0;
+    for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+      for (uint32_t vrtype = 0; vrtype != 16; ++vrtype) {
+        vrtype_cts[vrtype] += ctx.thread_vrtype_cts[tidx * 16 + vrtype];
+        vrtype_byte_cts[vrtype] += ctx.thread_vrtype_byte_cts[tidx * 16 + vrtype];
+        tot_byte_ct += ctx.thread_vrtype_byte_cts[tidx * 16 + vrtype];
+      }
+    }
+    printf("%-28s %12s %16s %7s\n", "record type", "variants", "bytes", "bytes%");
+    for (uint32_t vrtype = 0; vrtype != 8; ++vrtype) {
+      if (!vrtype_cts[vrtype]) {
+        continue;
       }
+      const double byte_pct = tot_byte_ct? ((100.0 * u63tod(vrtype_byte_cts[vrtype])) / u63tod(tot_byte_ct)) : 0.0;
+      printf("%u (%s)%*s %12" PRIu64 " %16" PRIu64 " %6.2f%%\n", vrtype, kVrtypeDescrips[vrtype], S_CAST(int32_t, 24 - strlen(kVrtypeDescrips[vrtype])), "", vrtype_cts[vrtype], vrtype_byte_cts[vrtype], byte_pct);
     }
   }
-  printf("\n");
-
-  SpgwFinish(&spgw);
   while (0) {
+  main_ret_USAGE:
+    fputs(
+"Usage:\n"
+"pgen_compress [-t <thread ct>] [-l <LD-base lookahead>] <input .bed or .pgen>\n"
+"              <output filename> [sample_ct]\n"
+"  (sample_ct is required when loading a .bed file)\n"
+"  -t: number of compression threads (default: number of CPUs).\n"
+"  -l: before LD-compressing a variant, estimate whether switching the LD base\n"
+"      to it would shrink the next <n> records (0-64, default 0).  With the\n"
+"      default, the LD base only switches when LD compression isn't viable.\n"
+"      This is a heuristic: it usually shrinks files with long LD runs, but can\n"
+"      also grow them slightly.\n"
+"pgen_compress -u <input .pgen> <output .bed>\n"
+          , stdout);
+    reterr = kPglRetInvalidCmdline;
+    break;
   main_ret_NOMEM:
     reterr = kPglRetNomem;
     break;
@@ -212,35 +611,35 @@ int32_t main(int32_t argc, char** argv) {
     break;
   }
  main_ret_1:
-  CleanupPgr(&pgr, &reterr);
+  CleanupThreads(&tg);
+  for (uint32_t tidx = 0; tidx != pgr_ct; ++tidx) {
+    CleanupPgr(&(pgrs[tidx]), &reterr);
+  }
 #ifndef NO_MMAP
   CleanupPgfi(&pgfi, &reterr);
 #endif
-  CleanupSpgw(&spgw, &reterr);
+  if (mpgwp) {
+    CleanupMpgw(mpgwp, &reterr);
+    free(mpgwp);
+  }
+  if (pgrs) {
+    free(pgrs);
+  }
   if (pgfi_alloc) {
     aligned_free(pgfi_alloc);
   }
-  if (pgr_alloc) {
-    aligned_free(pgr_alloc);
+  if (pgr_allocs) {
+    aligned_free(pgr_allocs);
   }
-  if (spgw_alloc) {
-    aligned_free(spgw_alloc);
+  if (mpgw_alloc) {
+    aligned_free(mpgw_alloc);
+  }
+  if (thread_alloc) {
+    aligned_free(thread_alloc);
   }
   if (genovec) {
     aligned_free(genovec);
   }
-  if (raregeno) {
-    aligned_free(raregeno);
-  }
-  if (sample_include) {
-    aligned_free(sample_include);
-  }
-  if (sample_include_cumulative_popcounts) {
-    aligned_free(sample_include_cumulative_popcounts);
-  }
-  if (difflist_sample_ids) {
-    aligned_free(difflist_sample_ids);
-  }
   if (outfile) {
     fclose(outfile);
   }
@@ -142,26 +142,10 @@ void GenoarrPhasedToHapCodes(const uintptr_t* genoarr, const uintptr_t* phaseinf
   }
 }
 
-// todo: use GenoarrLookup256x4bx4()
-static const float kGenoToFloat[4] = {0.0, 1.0, 2.0, -9.0};
+static const float kGenoFloatQuads[1024] ALIGNV16 = QUAD_TABLE256(0.0f, 1.0f, 2.0f, -9.0f);
 
 void Dosage16ToFloatsMinus9(const uintptr_t* genoarr, const uintptr_t* dosage_present, const uint16_t* dosage_main, uint32_t sample_ct, uint32_t dosage_ct, float* geno_float) {
-  const uint32_t word_ct_m1 = (sample_ct - 1) / kBitsPerWordD2;
-  float* write_iter = geno_float;
-  uint32_t subgroup_len = kBitsPerWordD2;
-  for (uint32_t widx = 0; ; ++widx) {
-    if (widx >= word_ct_m1) {
-      if (widx > word_ct_m1) {
-        break;
-      }
-      subgroup_len = ModNz(sample_ct, kBitsPerWordD2);
-    }
-    uintptr_t geno_word = genoarr[widx];
-    for (uint32_t uii = 0; uii != subgroup_len; ++uii) {
-      *write_iter++ = kGenoToFloat[geno_word & 3];
-      geno_word >>= 2;
-    }
-  }
+  GenoarrLookup256x4bx4(genoarr, kGenoFloatQuads, sample_ct, geno_float);
   if (dosage_ct) {
     const uint16_t* dosage_main_iter = dosage_main;
     uintptr_t sample_uidx_base = 0;
@@ -577,6 +561,228 @@ void DoublesToDosage16(const double* doublearr, uint32_t sample_ct, uint32_t har
   *dosage_ct_ptr = dosage_main_iter - dosage_main;
 }
 
+void PreinitPgrBatch(PgenBatchReader* pbrp) {
+  pbrp->pgr_ptrs = nullptr;
+  pbrp->alloc = nullptr;
+  pbrp->thread_ct = 0;
+}
+
+PglErr PgrBatchInit(const char* fname, uint32_t max_vrec_width, uintptr_t pgr_alloc_cacheline_ct, uint32_t thread_ct, PgenFileInfo* pgfip, PgenReader* main_pgrp, PgenBatchReader* pbrp) {
+  if (thread_ct > kMaxThreads) {
+    thread_ct = kMaxThreads;
+  } else if (!thread_ct) {
+    thread_ct = 1;
+  }
+  const uint32_t raw_sample_ct = pgfip->raw_sample_ct;
+  const uintptr_t pgr_alloc_byte_ct = pgr_alloc_cacheline_ct * kCacheline;
+  const uintptr_t genovec_byte_ct = NypCtToVecCt(raw_sample_ct) * kBytesPerVec;
+  const uintptr_t dosage_present_byte_ct = BitCtToVecCt(raw_sample_ct) * kBytesPerVec;
+  const uintptr_t dosage_main_byte_ct = DivUp(raw_sample_ct, (2 * kInt32PerVec)) * kBytesPerVec;
+  const uintptr_t ptr_arr_byte_ct = RoundUpPow2(4 * thread_ct * sizeof(intptr_t), kCacheline);
+  const uintptr_t per_thread_byte_ct = RoundUpPow2(sizeof(PgenReader), kCacheline) + pgr_alloc_byte_ct + RoundUpPow2(genovec_byte_ct + dosage_present_byte_ct + dosage_main_byte_ct, kCacheline);
+  unsigned char* alloc_iter;
+  if (unlikely(cachealigned_malloc(ptr_arr_byte_ct + thread_ct * per_thread_byte_ct, &alloc_iter))) {
+    return kPglRetNomem;
+  }
+  pbrp->alloc = alloc_iter;
+  pbrp->pgr_ptrs = R_CAST(PgenReader**, alloc_iter);
+  pbrp->genovecs = R_CAST(uintptr_t**, &(pbrp->pgr_ptrs[thread_ct]));
+  pbrp->dosage_presents = &(pbrp->genovecs[thread_ct]);
+  pbrp->dosage_mains = R_CAST(uint16_t**, &(pbrp->dosage_presents[thread_ct]));
+  alloc_iter = &(alloc_iter[ptr_arr_byte_ct]);
+  pbrp->pgr_ptrs[0] = main_pgrp;
+  pbrp->thread_ct = 1;
+  for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+    if (tidx) {
+      PgenReader* pgrp = R_CAST(PgenReader*, alloc_iter);
+      alloc_iter = &(alloc_iter[RoundUpPow2(sizeof(PgenReader), kCacheline)]);
+      PreinitPgr(pgrp);
+      PgrSetFreadBuf(nullptr, pgrp);
+      const PglErr reterr = PgrInit(fname, max_vrec_width, pgfip, pgrp, alloc_iter);
+      if (unlikely(reterr)) {
+        PglErr dummy = kPglRetSuccess;
+        CleanupPgr(pgrp, &dummy);
+        CleanupPgrBatch(pbrp, &dummy);
+        return reterr;
+      }
+      pbrp->pgr_ptrs[tidx] = pgrp;
+      pbrp->thread_ct = tidx + 1;
+      alloc_iter = &(alloc_iter[pgr_alloc_byte_ct]);
+    } else {
+      alloc_iter = &(alloc_iter[RoundUpPow2(sizeof(PgenReader), kCacheline) + pgr_alloc_byte_ct]);
+    }
+    unsigned char* scratch_iter = alloc_iter;
+    pbrp->genovecs[tidx] = R_CAST(uintptr_t*, scratch_iter);
+    scratch_iter = &(scratch_iter[genovec_byte_ct]);
+    pbrp->dosage_presents[tidx] = R_CAST(uintptr_t*, scratch_iter);
+    scratch_iter = &(scratch_iter[dosage_present_byte_ct]);
+    pbrp->dosage_mains[tidx] = R_CAST(uint16_t*, scratch_iter);
+    alloc_iter = &(alloc_iter[RoundUpPow2(genovec_byte_ct + dosage_present_byte_ct + dosage_main_byte_ct, kCacheline)]);
+  }
+  return kPglRetSuccess;
+}
+
+typedef struct PgrBatchCtxStruct {
+  const uintptr_t* sample_include;
+  PgrSampleSubsetIndex pssi;
+  const uint32_t* variant_idxs;
+  const void* lookup_table;
+  PgenBatchReader* pbrp;
+  unsigned char* result;
+  uintptr_t row_byte_stride;
+  uint32_t sample_ct;
+  uint32_t variant_idx_start;
+  uint32_t variant_ct;
+  uint32_t allele_idx;
+  PgenBatchType batch_type;
+
+  PglErr reterr;
+} PgrBatchCtx;
+
+static PglErr PgrGetBatchChunk(uint32_t tidx, uint32_t thread_ct, const PgrBatchCtx* ctx) {
+  const uintptr_t* sample_include = ctx->sample_include;
+  const PgrSampleSubsetIndex pssi = ctx->pssi;
+  const uint32_t* variant_idxs = ctx->variant_idxs;
+  const void* lookup_table = ctx->lookup_table;
+  const uintptr_t row_byte_stride = ctx->row_byte_stride;
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t variant_idx_start = ctx->variant_idx_start;
+  const uint32_t variant_ct = ctx->variant_ct;
+  const uint32_t allele_idx = ctx->allele_idx;
+  const PgenBatchType batch_type = ctx->batch_type;
+  PgenReader* pgrp = ctx->pbrp->pgr_ptrs[tidx];
+  uintptr_t* genovec = ctx->pbrp->genovecs[tidx];
+  uintptr_t* dosage_present = ctx->pbrp->dosage_presents[tidx];
+  uint16_t* dosage_main = ctx->pbrp->dosage_mains[tidx];
+  const uint32_t row_start = (S_CAST(uint64_t, variant_ct) * tidx) / thread_ct;
+  const uint32_t row_end = (S_CAST(uint64_t, variant_ct) * (tidx + 1)) / thread_ct;
+  unsigned char* write_iter = &(ctx->result[row_start * row_byte_stride]);
+  const uint32_t is_dosage = (batch_type == kPgbDosageFloat) || (batch_type == kPgbDosageDouble);
+  for (uint32_t row_idx = row_start; row_idx != row_end; ++row_idx) {
+    const uint32_t variant_idx = variant_idxs? variant_idxs[row_idx] : (variant_idx_start + row_idx);
+    PglErr reterr;
+    uint32_t dosage_ct = 0;
+    if (!is_dosage) {
+      if (allele_idx == UINT32_MAX) {
+        reterr = PgrGet(sample_include, pssi, sample_ct, variant_idx, pgrp, genovec);
+      } else {
+        reterr = PgrGet1(sample_include, pssi, sample_ct, variant_idx, allele_idx, pgrp, genovec);
+      }
+    } else {
+      if (allele_idx == UINT32_MAX) {
+        reterr = PgrGetD(sample_include, pssi, sample_ct, variant_idx, pgrp, genovec, dosage_present, dosage_main, &dosage_ct);
+      } else {
+        reterr = PgrGet1D(sample_include, pssi, sample_ct, variant_idx, allele_idx, pgrp, genovec, dosage_present, dosage_main, &dosage_ct);
+      }
+    }
+    if (unlikely(reterr)) {
+      return reterr;
+    }
+    switch (batch_type) {
+    case kPgbHardcallInt8:
+      GenoarrToBytesMinus9(genovec, sample_ct, R_CAST(int8_t*, write_iter));
+      break;
+    case kPgbHardcallInt32:
+      GenoarrLookup256x4bx4(genovec, lookup_table, sample_ct, write_iter);
+      break;
+    case kPgbDosageFloat:
+      Dosage16ToFloatsMinus9(genovec, dosage_present, dosage_main, sample_ct, dosage_ct, R_CAST(float*, write_iter));
+      break;
+    case kPgbDosageDouble:
+      Dosage16ToDoubles(S_CAST(const double*, lookup_table), genovec, dosage_present, dosage_main, sample_ct, dosage_ct, R_CAST(double*, write_iter));
+      break;
+    }
+    write_iter = &(write_iter[row_byte_stride]);
+  }
+  return kPglRetSuccess;
+}
+
+THREAD_FUNC_DECL PgrGetBatchThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  PgrBatchCtx* ctx = S_CAST(PgrBatchCtx*, arg->sharedp->context);
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  const PglErr reterr = PgrGetBatchChunk(tidx, thread_ct, ctx);
+  if (unlikely(reterr)) {
+    // any nonzero error is fine to report
+    ctx->reterr = reterr;
+  }
+  THREAD_RETURN;
+}
+
+PglErr PgrGetBatch(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uint32_t* variant_idxs, uint32_t variant_idx_start, uint32_t variant_ct, uint32_t allele_idx, PgenBatchType batch_type, const void* lookup_table, uintptr_t row_stride, PgenBatchReader* pbrp, void* result) {
+  if (!variant_ct) {
+    return kPglRetSuccess;
+  }
+  uintptr_t elem_size = 4;
+  if (batch_type == kPgbHardcallInt8) {
+    elem_size = 1;
+  } else if (batch_type == kPgbDosageDouble) {
+    elem_size = 8;
+  }
+  PgrBatchCtx ctx;
+  ctx.sample_include = sample_include;
+  ctx.pssi = pssi;
+  ctx.variant_idxs = variant_idxs;
+  ctx.lookup_table = lookup_table;
+  ctx.pbrp = pbrp;
+  ctx.result = S_CAST(unsigned char*, result);
+  ctx.row_byte_stride = row_stride * elem_size;
+  ctx.sample_ct = sample_ct;
+  ctx.variant_idx_start = variant_idx_start;
+  ctx.variant_ct = variant_ct;
+  ctx.allele_idx = allele_idx;
+  ctx.batch_type = batch_type;
+  ctx.reterr = kPglRetSuccess;
+  // Readers may share a sample-subset index which changed since their last
+  // use.
+  uint32_t thread_ct = pbrp->thread_ct;
+  for (uint32_t tidx = 1; tidx < thread_ct; ++tidx) {
+    PgrClearLdCache(pbrp->pgr_ptrs[tidx]);
+  }
+  // Not worth spawning threads for tiny batches.
+  const uint32_t max_useful_thread_ct = DivUp(variant_ct, 16);
+  if (thread_ct > max_useful_thread_ct) {
+    thread_ct = max_useful_thread_ct;
+  }
+  if (thread_ct <= 1) {
+    return PgrGetBatchChunk(0, 1, &ctx);
+  }
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  PglErr reterr = kPglRetSuccess;
+  if (unlikely(SetThreadCt(thread_ct, &tg))) {
+    reterr = kPglRetNomem;
+  } else {
+    SetThreadFuncAndData(PgrGetBatchThread, &ctx, &tg);
+    DeclareLastThreadBlock(&tg);
+    if (unlikely(SpawnThreads(&tg))) {
+      reterr = kPglRetThreadCreateFail;
+    } else {
+      JoinThreads(&tg);
+      reterr = ctx.reterr;
+    }
+  }
+  CleanupThreads(&tg);
+  return reterr;
+}
+
+BoolErr CleanupPgrBatch(PgenBatchReader* pbrp, PglErr* reterrp) {
+  uint32_t cleanup_fail = 0;
+  if (pbrp->alloc) {
+    for (uint32_t tidx = 1; tidx < pbrp->thread_ct; ++tidx) {
+      if (CleanupPgr(pbrp->pgr_ptrs[tidx], reterrp)) {
+        cleanup_fail = 1;
+      }
+    }
+    aligned_free(pbrp->alloc);
+    pbrp->alloc = nullptr;
+  }
+  pbrp->pgr_ptrs = nullptr;
+  pbrp->thread_ct = 0;
+  return cleanup_fail;
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -18,6 +18,8 @@
 // along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "include/pgenlib_misc.h"
+#include "include/pgenlib_read.h"
+#include "include/plink2_thread.h"
 
 #ifdef __cplusplus
 namespace plink2 {
@@ -95,6 +97,48 @@ void FloatsToDosage16(const float* floatarr, uint32_t sample_ct, uint32_t hard_c
 
 void DoublesToDosage16(const double* doublearr, uint32_t sample_ct, uint32_t hard_call_halfdist, uintptr_t* genoarr, uintptr_t* dosage_present, uint16_t* dosage_main, uint32_t* dosage_ct_ptr);
 
+// Batched multi-variant decode into a dense variant-major matrix, for callers
+// (Python/R) which would otherwise pay per-variant call and expansion
+// overhead.
+//
+// A PgenBatchReader owns (thread_ct - 1) extra PgenReaders opened on the same
+// PgenFileInfo, plus per-thread genovec/dosage scratch space; the caller's
+// own PgenReader serves as reader 0.  The requested variants are split into
+// thread_ct contiguous chunks, which are decoded concurrently.
+typedef struct PgenBatchReaderStruct {
+  NONCOPYABLE(PgenBatchReaderStruct);
+  PgenReader** pgr_ptrs;
+  uintptr_t** genovecs;
+  uintptr_t** dosage_presents;
+  uint16_t** dosage_mains;
+  unsigned char* alloc;
+  uint32_t thread_ct;
+} PgenBatchReader;
+
+ENUM_U31_DEF_START()
+  kPgbHardcallInt8,  // {0, 1, 2, -9}
+  kPgbHardcallInt32,  // lookup_table must be a GenoarrLookup256x4bx4 table
+  kPgbDosageFloat,  // hardcalls overlaid with dosages; missing = -9
+  kPgbDosageDouble  // lookup_table must be a GenoarrLookup16x8bx2 table
+ENUM_U31_DEF_END(PgenBatchType);
+
+void PreinitPgrBatch(PgenBatchReader* pbrp);
+
+// fname, max_vrec_width and pgr_alloc_cacheline_ct must match what was used
+// to initialize main_pgrp.  thread_ct is capped at kMaxThreads.
+PglErr PgrBatchInit(const char* fname, uint32_t max_vrec_width, uintptr_t pgr_alloc_cacheline_ct, uint32_t thread_ct, PgenFileInfo* pgfip, PgenReader* main_pgrp, PgenBatchReader* pbrp);
+
+// If variant_idxs is nullptr, rows correspond to variant_idx_start,
+// variant_idx_start + 1, ..., variant_idx_start + variant_ct - 1; otherwise
+// row i corresponds to variant_idxs[i].  Variant indexes must already have
+// been validated.  row_stride is in elements, and must be >= sample_ct.
+// allele_idx == UINT32_MAX selects PgrGet()/PgrGetD() semantics (all ALT
+// alleles counted); otherwise PgrGet1()/PgrGet1D() is used.
+PglErr PgrGetBatch(const uintptr_t* __restrict sample_include, PgrSampleSubsetIndex pssi, uint32_t sample_ct, const uint32_t* variant_idxs, uint32_t variant_idx_start, uint32_t variant_ct, uint32_t allele_idx, PgenBatchType batch_type, const void* lookup_table, uintptr_t row_stride, PgenBatchReader* pbrp, void* result);
+
+// Does not touch main_pgrp.
+BoolErr CleanupPgrBatch(PgenBatchReader* pbrp, PglErr* reterrp);
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
@@ -217,6 +217,17 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// SetThreadCt
+void SetThreadCt(List pgen, int thread_ct);
+RcppExport SEXP _pgenlibr_SetThreadCt(SEXP pgenSEXP, SEXP thread_ctSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type pgen(pgenSEXP);
+    Rcpp::traits::input_parameter< int >::type thread_ct(thread_ctSEXP);
+    SetThreadCt(pgen, thread_ct);
+    return R_NilValue;
+END_RCPP
+}
 // NewPvar
 SEXP NewPvar(String filename);
 RcppExport SEXP _pgenlibr_NewPvar(SEXP filenameSEXP) {
@@ -295,6 +306,7 @@ static const R_CallMethodDef CallEntries[] = {
     {"_pgenlibr_ReadList", (DL_FUNC) &_pgenlibr_ReadList, 3},
     {"_pgenlibr_VariantScores", (DL_FUNC) &_pgenlibr_VariantScores, 3},
     {"_pgenlibr_ClosePgen", (DL_FUNC) &_pgenlibr_ClosePgen, 1},
+    {"_pgenlibr_SetThreadCt", (DL_FUNC) &_pgenlibr_SetThreadCt, 2},
     {"_pgenlibr_NewPvar", (DL_FUNC) &_pgenlibr_NewPvar, 1},
     {"_pgenlibr_GetVariantId", (DL_FUNC) &_pgenlibr_GetVariantId, 2},
     {"_pgenlibr_GetVariantsById", (DL_FUNC) &_pgenlibr_GetVariantsById, 2},
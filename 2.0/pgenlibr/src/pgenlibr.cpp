@@ -44,6 +44,8 @@ public:
 
   void ReadList(NumericMatrix buf, IntegerVector variant_subset, bool meanimpute);
 
+  void SetThreadCt(uint32_t thread_ct);
+
   void FillVariantScores(NumericVector result, NumericVector weights, Nullable<IntegerVector> variant_subset);
 
   void Close();
@@ -63,6 +65,12 @@ private:
 
   plink2::PgenVariant _pgv;
 
+  // for ReadIntList() and ReadList()
+  plink2::PgenBatchReader _batch;
+  std::string _fname;
+  uint32_t _max_vrec_width;
+  uintptr_t _pgr_alloc_cacheline_ct;
+
   plink2::VecW* _transpose_batch_buf;
   // kPglNypTransposeBatch (= 256) variants at a time, and then transpose
   uintptr_t* _multivar_vmaj_geno_buf;
@@ -75,12 +83,15 @@ private:
   void SetSampleSubsetInternal(IntegerVector sample_subset_1based);
 
   void ReadAllelesPhasedInternal(int variant_idx);
+
+  void CopyVariantSubsetInternal(IntegerVector variant_subset, std::vector<uint32_t>* variant_idxs);
 };
 
 RPgenReader::RPgenReader() : _info_ptr(nullptr),
                              _allele_idx_offsetsp(nullptr),
                              _nonref_flagsp(nullptr),
                              _state_ptr(nullptr) {
+  plink2::PreinitPgrBatch(&_batch);
 }
 
 void RPgenReader::Load(String filename, Nullable<List> pvar,
@@ -245,6 +256,15 @@ void RPgenReader::Load(String filename, Nullable<List> pvar,
   pgr_alloc_iter = &(pgr_alloc_iter[plink2::kPglNypTransposeBatch * plink2::kPglNypTransposeBatch / 8]);
   _multivar_smaj_phasepresent_batch_buf = reinterpret_cast<uintptr_t*>(pgr_alloc_iter);
   // pgr_alloc_iter = &(pgr_alloc_iter[plink2::kPglNypTransposeBatch * plink2::kPglNypTransposeBatch / 8]);
+
+  _fname = fname;
+  _max_vrec_width = max_vrec_width;
+  _pgr_alloc_cacheline_ct = pgr_alloc_cacheline_ct;
+  reterr = plink2::PgrBatchInit(fname, max_vrec_width, pgr_alloc_cacheline_ct, 1, _info_ptr, _state_ptr, &_batch);
+  if (reterr != plink2::kPglRetSuccess) {
+    sprintf(errstr_buf, "PgrBatchInit() error %d", static_cast<int>(reterr));
+    stop(errstr_buf);
+  }
 }
 
 uint32_t RPgenReader::GetRawSampleCt() const {
@@ -525,14 +545,10 @@ void RPgenReader::ReadAllelesNumeric(NumericMatrix acbuf, Nullable<LogicalVector
   }
 }
 
-void RPgenReader::ReadIntList(IntegerMatrix buf, IntegerVector variant_subset) {
-  if (!_info_ptr) {
-    stop("pgen is closed");
-  }
-  // assume that buf has the correct dimensions
+void RPgenReader::CopyVariantSubsetInternal(IntegerVector variant_subset, std::vector<uint32_t>* variant_idxs) {
   const uintptr_t vsubset_size = variant_subset.size();
   const uint32_t raw_variant_ct = _info_ptr->raw_variant_ct;
-  int32_t* buf_iter = &buf[0];
+  variant_idxs->resize(vsubset_size);
   for (uintptr_t col_idx = 0; col_idx != vsubset_size; ++col_idx) {
     uint32_t variant_idx = variant_subset[col_idx] - 1;
     if (static_cast<uint32_t>(variant_idx) >= raw_variant_ct) {
@@ -540,14 +556,25 @@ void RPgenReader::ReadIntList(IntegerMatrix buf, IntegerVector variant_subset) {
       sprintf(errstr_buf, "variant_subset element out of range (%d; must be 1..%u)", variant_idx + 1, raw_variant_ct);
       stop(errstr_buf);
     }
-    plink2::PglErr reterr = PgrGet(_subset_include_vec, _subset_index, _subset_size, variant_idx, _state_ptr, _pgv.genovec);
-    if (reterr != plink2::kPglRetSuccess) {
-      char errstr_buf[256];
-      sprintf(errstr_buf, "PgrGet() error %d", static_cast<int>(reterr));
-      stop(errstr_buf);
-    }
-    plink2::GenoarrLookup256x4bx4(_pgv.genovec, kGenoRInt32Quads, _subset_size, buf_iter);
-    buf_iter = &(buf_iter[_subset_size]);
+    (*variant_idxs)[col_idx] = variant_idx;
+  }
+}
+
+void RPgenReader::ReadIntList(IntegerMatrix buf, IntegerVector variant_subset) {
+  if (!_info_ptr) {
+    stop("pgen is closed");
+  }
+  // assume that buf has the correct dimensions
+  std::vector<uint32_t> variant_idxs;
+  CopyVariantSubsetInternal(variant_subset, &variant_idxs);
+  if (variant_idxs.empty()) {
+    return;
+  }
+  plink2::PglErr reterr = plink2::PgrGetBatch(_subset_include_vec, _subset_index, _subset_size, &(variant_idxs[0]), 0, variant_idxs.size(), UINT32_MAX, plink2::kPgbHardcallInt32, kGenoRInt32Quads, _subset_size, &_batch, &buf[0]);
+  if (reterr != plink2::kPglRetSuccess) {
+    char errstr_buf[256];
+    sprintf(errstr_buf, "PgrGetBatch() error %d", static_cast<int>(reterr));
+    stop(errstr_buf);
   }
 }
 
@@ -556,16 +583,24 @@ void RPgenReader::ReadList(NumericMatrix buf, IntegerVector variant_subset, bool
     stop("pgen is closed");
   }
   // assume that buf has the correct dimensions
-  const uintptr_t vsubset_size = variant_subset.size();
-  const uint32_t raw_variant_ct = _info_ptr->raw_variant_ct;
-  double* buf_iter = &buf[0];
-  for (uintptr_t col_idx = 0; col_idx != vsubset_size; ++col_idx) {
-    uint32_t variant_idx = variant_subset[col_idx] - 1;
-    if (static_cast<uint32_t>(variant_idx) >= raw_variant_ct) {
+  std::vector<uint32_t> variant_idxs;
+  CopyVariantSubsetInternal(variant_subset, &variant_idxs);
+  const uintptr_t vsubset_size = variant_idxs.size();
+  if (!vsubset_size) {
+    return;
+  }
+  if (!meanimpute) {
+    plink2::PglErr reterr = plink2::PgrGetBatch(_subset_include_vec, _subset_index, _subset_size, &(variant_idxs[0]), 0, vsubset_size, UINT32_MAX, plink2::kPgbDosageDouble, kGenoRDoublePairs, _subset_size, &_batch, &buf[0]);
+    if (reterr != plink2::kPglRetSuccess) {
       char errstr_buf[256];
-      sprintf(errstr_buf, "variant_subset element out of range (%d; must be 1..%u)", variant_idx + 1, raw_variant_ct);
+      sprintf(errstr_buf, "PgrGetBatch() error %d", static_cast<int>(reterr));
       stop(errstr_buf);
     }
+    return;
+  }
+  double* buf_iter = &buf[0];
+  for (uintptr_t col_idx = 0; col_idx != vsubset_size; ++col_idx) {
+    const uint32_t variant_idx = variant_idxs[col_idx];
     uint32_t dosage_ct;
     plink2::PglErr reterr = PgrGetD(_subset_include_vec, _subset_index, _subset_size, variant_idx, _state_ptr, _pgv.genovec, _pgv.dosage_present, _pgv.dosage_main, &dosage_ct);
     if (reterr != plink2::kPglRetSuccess) {
@@ -573,20 +608,30 @@ void RPgenReader::ReadList(NumericMatrix buf, IntegerVector variant_subset, bool
       sprintf(errstr_buf, "PgrGetD() error %d", static_cast<int>(reterr));
       stop(errstr_buf);
     }
-    if (!meanimpute) {
-      plink2::Dosage16ToDoubles(kGenoRDoublePairs, _pgv.genovec, _pgv.dosage_present, _pgv.dosage_main, _subset_size, dosage_ct, buf_iter);
-    } else {
-      plink2::ZeroTrailingNyps(_subset_size, _pgv.genovec);
-      if (plink2::Dosage16ToDoublesMeanimpute(_pgv.genovec, _pgv.dosage_present, _pgv.dosage_main, _subset_size, dosage_ct, buf_iter)) {
-        char errstr_buf[256];
-        sprintf(errstr_buf, "variant %d has only missing dosages", variant_idx + 1);
-        stop(errstr_buf);
-      }
+    plink2::ZeroTrailingNyps(_subset_size, _pgv.genovec);
+    if (plink2::Dosage16ToDoublesMeanimpute(_pgv.genovec, _pgv.dosage_present, _pgv.dosage_main, _subset_size, dosage_ct, buf_iter)) {
+      char errstr_buf[256];
+      sprintf(errstr_buf, "variant %d has only missing dosages", variant_idx + 1);
+      stop(errstr_buf);
     }
     buf_iter = &(buf_iter[_subset_size]);
   }
 }
 
+void RPgenReader::SetThreadCt(uint32_t thread_ct) {
+  if (!_info_ptr) {
+    stop("pgen is closed");
+  }
+  plink2::PglErr reterr = plink2::kPglRetSuccess;
+  plink2::CleanupPgrBatch(&_batch, &reterr);
+  reterr = plink2::PgrBatchInit(_fname.c_str(), _max_vrec_width, _pgr_alloc_cacheline_ct, thread_ct, _info_ptr, _state_ptr, &_batch);
+  if (reterr != plink2::kPglRetSuccess) {
+    char errstr_buf[256];
+    sprintf(errstr_buf, "PgrBatchInit() error %d", static_cast<int>(reterr));
+    stop(errstr_buf);
+  }
+}
+
 void RPgenReader::FillVariantScores(NumericVector result, NumericVector weights, Nullable<IntegerVector> variant_subset) {
   if (!_info_ptr) {
     stop("pgen is closed");
@@ -629,6 +674,10 @@ void RPgenReader::FillVariantScores(NumericVector result, NumericVector weights,
 
 void RPgenReader::Close() {
   // don't bother propagating file close errors for now
+  if (_batch.thread_ct) {
+    plink2::PglErr reterr = plink2::kPglRetSuccess;
+    plink2::CleanupPgrBatch(&_batch, &reterr);
+  }
   if (_info_ptr) {
     CondReleaseRefcountedWptr(&_allele_idx_offsetsp);
     CondReleaseRefcountedWptr(&_nonref_flagsp);
@@ -922,3 +971,15 @@ void ClosePgen(List pgen) {
   XPtr<class RPgenReader> rp = as<XPtr<class RPgenReader> >(pgen[1]);
   rp->Close();
 }
+
+// [[Rcpp::export]]
+void SetThreadCt(List pgen, int thread_ct) {
+  if (strcmp_r_c(pgen[0], "pgen")) {
+    stop("pgen is not a pgen object");
+  }
+  if (thread_ct < 1) {
+    stop("thread_ct must be positive");
+  }
+  XPtr<class RPgenReader> rp = as<XPtr<class RPgenReader> >(pgen[1]);
+  rp->SetThreadCt(thread_ct);
+}
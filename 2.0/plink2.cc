@@ -179,7 +179,8 @@ FLAGSET64_DEF_START()
   kfCommand1Het = (1 << 24),
   kfCommand1Fst = (1 << 25),
   kfCommand1Pmerge = (1 << 26),
-  kfCommand1PgenDiff = (1 << 27)
+  kfCommand1PgenDiff = (1 << 27),
+  kfCommand1PcaProject = (1 << 28)
 FLAGSET64_DEF_END(Command1Flags);
 
 void PgenInfoPrint(const char* pgenname, const PgenFileInfo* pgfip, PgenHeaderCtrl header_ctrl, uint32_t max_allele_ct) {
@@ -290,6 +291,7 @@ typedef struct Plink2CmdlineStruct {
   SortMode sort_vars_mode;
   GrmFlags grm_flags;
   PcaFlags pca_flags;
+  PcaProjFlags pca_proj_flags;
   WriteCovarFlags write_covar_flags;
   PhenoTransformFlags pheno_transform_flags;
   FaFlags fa_flags;
@@ -304,8 +306,11 @@ typedef struct Plink2CmdlineStruct {
   SdiffInfo sdiff_info;
   KingFlags king_flags;
   double king_cutoff;
+  double grm_sparse_cutoff;
   double king_table_filter;
   double king_table_subset_thresh;
+  uint32_t king_screen_max_carrier_ct;
+  uint32_t king_screen_min_shared_ct;
   FreqRptFlags freq_rpt_flags;
   MissingRptFlags missing_rpt_flags;
   GenoCountsFlags geno_counts_flags;
@@ -363,6 +368,8 @@ typedef struct Plink2CmdlineStruct {
   int32_t to_bp;
   int32_t window_bp;
   uint32_t pca_ct;
+  uint32_t pca_iter_ct;
+  uint32_t pca_block_size;
   uint32_t xchr_model;
   uint32_t max_thread_ct;
   uint32_t parallel_idx;
@@ -419,6 +426,7 @@ typedef struct Plink2CmdlineStruct {
   char* loop_cats_phenoname;
   char* fa_fname;
   char* king_table_subset_fname;
+  char* pca_proj_fname;
   char* require_info_flattened;
   char* require_no_info_flattened;
   char* keep_col_match_fname;
@@ -437,7 +445,7 @@ typedef struct Plink2CmdlineStruct {
 
 // er, probably time to just always initialize this...
 uint32_t SingleVariantLoaderIsNeeded(const char* king_cutoff_fprefix, Command1Flags command_flags1, MakePlink2Flags make_plink2_flags, RmDupMode rmdup_mode, double hwe_thresh) {
-  return (command_flags1 & (kfCommand1Exportf | kfCommand1MakeKing | kfCommand1GenoCounts | kfCommand1LdPrune | kfCommand1Validate | kfCommand1Pca | kfCommand1MakeRel | kfCommand1Glm | kfCommand1Score | kfCommand1Ld | kfCommand1Hardy | kfCommand1Sdiff | kfCommand1PgenDiff)) ||
+  return (command_flags1 & (kfCommand1Exportf | kfCommand1MakeKing | kfCommand1GenoCounts | kfCommand1LdPrune | kfCommand1Validate | kfCommand1Pca | kfCommand1MakeRel | kfCommand1Glm | kfCommand1Score | kfCommand1Ld | kfCommand1Hardy | kfCommand1Sdiff | kfCommand1PgenDiff | kfCommand1PcaProject)) ||
     ((command_flags1 & kfCommand1MakePlink2) && (make_plink2_flags & kfMakePgen)) ||
     ((command_flags1 & kfCommand1KingCutoff) && (!king_cutoff_fprefix)) ||
     (rmdup_mode != kRmDup0) ||
@@ -445,8 +453,9 @@ uint32_t SingleVariantLoaderIsNeeded(const char* king_cutoff_fprefix, Command1Fl
 }
 
 
-uint32_t DecentAlleleFreqsAreNeeded(Command1Flags command_flags1, HetFlags het_flags, ScoreFlags score_flags) {
+uint32_t DecentAlleleFreqsAreNeeded(Command1Flags command_flags1, HetFlags het_flags, ScoreFlags score_flags, GlmFlags glm_flags) {
   return (command_flags1 & (kfCommand1Pca | kfCommand1MakeRel)) ||
+    ((command_flags1 & kfCommand1Glm) && (glm_flags & kfGlmLocoRidge)) ||
     ((command_flags1 & kfCommand1Score) && ((!(score_flags & kfScoreNoMeanimpute)) || (score_flags & (kfScoreCenter | kfScoreVarianceStandardize)))) ||
     ((command_flags1 & kfCommand1Het) && (!(het_flags & kfHetSmallSample)));
 }
@@ -875,7 +884,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
       const uint32_t xheader_needed = (pcp->exportf_info.flags & (kfExportfVcf | kfExportfBcf))? 1 : 0;
       const uint32_t qualfilter_needed = xheader_needed || ((pcp->rmdup_mode != kRmDup0) && (pcp->rmdup_mode <= kRmDupExcludeMismatch));
 
-      reterr = LoadPvar(pvarname, pcp->var_filter_exceptions_flattened, pcp->varid_template_str, pcp->varid_multi_template_str, pcp->varid_multi_nonsnp_template_str, pcp->missing_varid_match, pcp->require_info_flattened, pcp->require_no_info_flattened, &(pcp->extract_if_info_expr), &(pcp->exclude_if_info_expr), pcp->misc_flags, pcp->pvar_psam_flags, xheader_needed, qualfilter_needed, pcp->var_min_qual, pcp->splitpar_bound1, pcp->splitpar_bound2, pcp->new_variant_id_max_allele_slen, (pcp->filter_flags / kfFilterSnpsOnly) & 3, !(pcp->dependency_flags & kfFilterNoSplitChr), pcp->filter_min_allele_ct, pcp->filter_max_allele_ct, pcp->max_thread_ct, cip, &max_variant_id_slen, &info_reload_slen, &vpos_sortstatus, &xheader, &variant_include, &variant_bps, &variant_ids_mutable, &allele_idx_offsets, K_CAST(const char***, &allele_storage_mutable), &pvar_qual_present, &pvar_quals, &pvar_filter_present, &pvar_filter_npass, &pvar_filter_storage_mutable, &nonref_flags, &variant_cms, &chr_idxs, &raw_variant_ct, &variant_ct, &max_allele_ct, &max_allele_slen, &xheader_blen, &info_flags, &max_filter_slen);
+      reterr = LoadPvar(pvarname, pcp->var_filter_exceptions_flattened, pcp->varid_template_str, pcp->varid_multi_template_str, pcp->varid_multi_nonsnp_template_str, pcp->missing_varid_match, pcp->require_info_flattened, pcp->require_no_info_flattened, &(pcp->extract_if_info_expr), &(pcp->exclude_if_info_expr), pcp->misc_flags, pcp->pvar_psam_flags, xheader_needed, qualfilter_needed, pcp->var_min_qual, pcp->splitpar_bound1, pcp->splitpar_bound2, pcp->from_bp, pcp->to_bp, pcp->new_variant_id_max_allele_slen, (pcp->filter_flags / kfFilterSnpsOnly) & 3, !(pcp->dependency_flags & kfFilterNoSplitChr), pcp->filter_min_allele_ct, pcp->filter_max_allele_ct, pcp->max_thread_ct, cip, &max_variant_id_slen, &info_reload_slen, &vpos_sortstatus, &xheader, &variant_include, &variant_bps, &variant_ids_mutable, &allele_idx_offsets, K_CAST(const char***, &allele_storage_mutable), &pvar_qual_present, &pvar_quals, &pvar_filter_present, &pvar_filter_npass, &pvar_filter_storage_mutable, &nonref_flags, &variant_cms, &chr_idxs, &raw_variant_ct, &variant_ct, &max_allele_ct, &max_allele_slen, &xheader_blen, &info_flags, &max_filter_slen);
       if (unlikely(reterr)) {
         goto Plink2Core_ret_1;
       }
@@ -962,8 +971,14 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
     if (pgenname[0]) {
       PgenHeaderCtrl header_ctrl;
       uintptr_t cur_alloc_cacheline_ct;
+#ifdef NO_MMAP
+      const uint32_t use_mmap = 0;
+#else
+      const uint32_t use_mmap = (pcp->misc_flags / kfMiscPgenMmap) & 1;
+#endif
+      uint32_t cur_use_mmap = use_mmap;
       while (1) {
-        reterr = PgfiInitPhase1(pgenname, raw_variant_ct, raw_sample_ct, 0, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, g_logbuf);
+        reterr = PgfiInitPhase1(pgenname, raw_variant_ct, raw_sample_ct, cur_use_mmap, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, g_logbuf);
         if (!reterr) {
           break;
         }
@@ -974,6 +989,13 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           logerrputsb();
           goto Plink2Core_ret_1;
         }
+        if (cur_use_mmap) {
+          // Plink1SampleMajorToPgen() needs pgfi.shared_ff.
+          CleanupPgfi(&pgfi, &reterr);
+          cur_use_mmap = 0;
+          continue;
+        }
+        cur_use_mmap = use_mmap;
         char* pgenname_end = memcpya(pgenname, outname, outname_end - outname);
         pgenname_end = strcpya_k(pgenname_end, ".pgen");
         const uint32_t no_vmaj_ext = (pcp->command_flags1 & kfCommand1MakePlink2) && (!pcp->filter_flags) && ((make_plink2_flags & (kfMakePgen | (kfMakePgenFormatBase * 3))) == kfMakePgen);
@@ -1027,6 +1049,13 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         logerrputs("Error: .pgen file contains multiallelic variants, while .pvar does not.\n");
         goto Plink2Core_ret_INCONSISTENT_INPUT;
       }
+      if ((pcp->misc_flags & kfMiscPgenVerify) || (pcp->command_flags1 & kfCommand1Validate)) {
+        // --validate checks the sidecar whenever it's present
+        reterr = VerifyPgenCksum(pgenname, &pgfi, pcp->max_thread_ct, (pcp->misc_flags / kfMiscPgenVerify) & 1);
+        if (unlikely(reterr)) {
+          goto Plink2Core_ret_1;
+        }
+      }
       if (pcp->misc_flags & kfMiscRealRefAlleles) {
         if (unlikely(nonref_flags && (!AllBitsAreOne(nonref_flags, raw_variant_ct)))) {
           // technically a lie, it's okay if a .bed is first converted to .pgen
@@ -1055,7 +1084,8 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         if (unlikely(bigstack_alloc_uc((pgr_alloc_cacheline_ct + DivUp(max_vrec_width, kCacheline)) * kCacheline, &simple_pgr_alloc))) {
           goto Plink2Core_ret_NOMEM;
         }
-        reterr = PgrInit(pgenname, max_vrec_width, &pgfi, &simple_pgr, simple_pgr_alloc);
+        // in mmap mode, this reader also decodes straight from the mapping
+        reterr = PgrInit(PgfiMmapBase(&pgfi)? nullptr : pgenname, max_vrec_width, &pgfi, &simple_pgr, simple_pgr_alloc);
         if (unlikely(reterr)) {
           if (reterr == kPglRetOpenFail) {
             logerrprintfww(kErrprintfFopen, pgenname, strerror(errno));
@@ -1788,7 +1818,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           }
           goto Plink2Core_ret_DEGENERATE_DATA;
         }
-        const uint32_t decent_afreqs_needed = DecentAlleleFreqsAreNeeded(pcp->command_flags1, pcp->het_flags, pcp->score_info.flags);
+        const uint32_t decent_afreqs_needed = DecentAlleleFreqsAreNeeded(pcp->command_flags1, pcp->het_flags, pcp->score_info.flags, pcp->glm_info.flags);
         const uint32_t maj_alleles_needed = MajAllelesAreNeeded(pcp->command_flags1, pcp->pca_flags, pcp->glm_info.flags);
         if (decent_afreqs_needed || maj_alleles_needed || IndecentAlleleFreqsAreNeeded(pcp->command_flags1, pcp->min_maf, pcp->max_maf)) {
           if (unlikely((!pcp->read_freq_fname) && ((sample_ct < 50) || ((!nonfounders) && (founder_ct < 50))) && decent_afreqs_needed && (!(pcp->misc_flags & kfMiscAllowBadFreqs)))) {
@@ -2217,13 +2247,15 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           // "--make-king-table rel-check" aren't used with --king-cutoff or
           // --make-king
           // probable todo: --king-cutoff-table which can use .kin0 as input
-          reterr = CalcKingTableSubset(sample_include, &pii.sii, variant_include, cip, pcp->king_table_subset_fname, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, pcp->king_table_filter, pcp->king_table_subset_thresh, rel_check, pcp->king_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &simple_pgr, outname, outname_end);
+          reterr = CalcKingTableSubset(sample_include, &pii.sii, variant_include, cip, pcp->king_table_subset_fname, nullptr, 0, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, -1, pcp->king_table_filter, pcp->king_table_subset_thresh, rel_check, pcp->king_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &simple_pgr, nullptr, outname, outname_end);
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
         } else {
           if (king_cutoff_fprefix) {
             reterr = KingCutoffBatch(&pii.sii, raw_sample_ct, pcp->king_cutoff, sample_include, king_cutoff_fprefix, &sample_ct);
+          } else if (pcp->king_flags & kfKingScreen) {
+            reterr = CalcKingScreen(&pii.sii, variant_include, cip, raw_sample_ct, raw_variant_ct, variant_ct, pcp->king_cutoff, pcp->king_table_filter, pcp->king_screen_max_carrier_ct, pcp->king_screen_min_shared_ct, pcp->king_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &simple_pgr, sample_include, &sample_ct, outname, outname_end);
           } else {
             reterr = CalcKing(&pii.sii, variant_include, cip, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, pcp->king_cutoff, pcp->king_table_filter, pcp->king_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &pgfi, &simple_pgr, sample_include, &sample_ct, outname, outname_end);
           }
@@ -2250,7 +2282,12 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           }
         }
       }
-      if ((pcp->command_flags1 & kfCommand1MakeRel) || keep_grm) {
+      if (pcp->grm_flags & kfGrmSparse) {
+        reterr = CalcGrmSparse(sample_include, &pii.sii, variant_include, cip, allele_idx_offsets, allele_freqs, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_allele_ct, pcp->grm_flags, pcp->grm_sparse_cutoff, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &simple_pgr, outname, outname_end);
+        if (unlikely(reterr)) {
+          goto Plink2Core_ret_1;
+        }
+      } else if ((pcp->command_flags1 & kfCommand1MakeRel) || keep_grm) {
         reterr = CalcGrm(sample_include, &pii.sii, variant_include, cip, allele_idx_offsets, allele_freqs, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_allele_ct, pcp->grm_flags, pcp->parallel_idx, pcp->parallel_tot, pcp->max_thread_ct, &simple_pgr, outname, outname_end, keep_grm? (&grm) : nullptr);
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
@@ -2332,7 +2369,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
 #ifndef NOLAPACK
       if (pcp->command_flags1 & kfCommand1Pca) {
         // if the GRM is on the stack, this always frees it
-        reterr = CalcPca(sample_include, &pii.sii, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, maj_alleles, allele_freqs, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_allele_ct, max_allele_slen, pcp->pca_ct, pcp->pca_flags, pcp->max_thread_ct, &simple_pgr, sfmtp, grm, outname, outname_end);
+        reterr = CalcPca(sample_include, &pii.sii, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, maj_alleles, allele_freqs, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_allele_ct, max_allele_slen, pcp->pca_ct, pcp->pca_flags, pcp->pca_iter_ct, pcp->pca_block_size, pcp->max_thread_ct, &simple_pgr, sfmtp, grm, outname, outname_end);
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
@@ -2565,6 +2602,18 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           if (unlikely(reterr)) {
             goto Plink2Core_ret_1;
           }
+          if (make_plink2_flags & kfMakePgenSmaj) {
+            reterr = WritePgenSmaj(outname, outname_end);
+            if (unlikely(reterr)) {
+              goto Plink2Core_ret_1;
+            }
+          }
+          if (make_plink2_flags & kfMakePvarVidx) {
+            reterr = WritePvarVidx(pcp->max_thread_ct, outname, outname_end);
+            if (unlikely(reterr)) {
+              goto Plink2Core_ret_1;
+            }
+          }
           // no BigstackReset needed here, since allele_presents only needed
           // if 'trim-alts', and later operations are prohibited in that case
         }
@@ -2636,6 +2685,13 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
         }
       }
 
+      if (pcp->command_flags1 & kfCommand1PcaProject) {
+        reterr = PcaProject(sample_include, &pii.sii, variant_include, cip, variant_ids, allele_idx_offsets, allele_storage, pcp->pca_proj_fname, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_allele_ct, max_variant_id_slen, pcp->pca_proj_flags, pcp->max_thread_ct, &simple_pgr, outname, outname_end);
+        if (unlikely(reterr)) {
+          goto Plink2Core_ret_1;
+        }
+      }
+
       if (pcp->command_flags1 & kfCommand1Score) {
         reterr = ScoreReport(sample_include, &pii.sii, sex_male, pheno_cols, pheno_names, variant_include, cip, variant_ids, allele_idx_offsets, allele_storage, allele_freqs, &(pcp->score_info), raw_sample_ct, sample_ct, pheno_ct, max_pheno_name_blen, raw_variant_ct, variant_ct, max_variant_id_slen, pcp->xchr_model, pcp->max_thread_ct, &simple_pgr, outname, outname_end);
         if (unlikely(reterr)) {
@@ -2655,7 +2711,7 @@ PglErr Plink2Core(const Plink2Cmdline* pcp, MakePlink2Flags make_plink2_flags, c
           logerrputs("Error: --glm + local-pos-cols= requires a sorted .pvar/.bim.  Retry this\ncommand after using --make-pgen/--make-bed + --sort-vars to sort your data.\n");
           goto Plink2Core_ret_INCONSISTENT_INPUT;
         }
-        reterr = GlmMain(sample_include, &pii.sii, sex_nm, sex_male, pheno_cols, pheno_names, covar_cols, covar_names, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, maj_alleles, allele_storage, &(pcp->glm_info), &(pcp->adjust_info), &(pcp->aperm), pcp->glm_local_covar_fname, pcp->glm_local_pvar_fname, pcp->glm_local_psam_fname, raw_sample_ct, sample_ct, pheno_ct, max_pheno_name_blen, covar_ct, max_covar_name_blen, raw_variant_ct, variant_ct, max_variant_id_slen, max_allele_slen, pcp->xchr_model, pcp->ci_size, pcp->vif_thresh, pcp->ln_pfilter, pcp->output_min_ln, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &pgfi, &simple_pgr, outname, outname_end);
+        reterr = GlmMain(sample_include, &pii.sii, sex_nm, sex_male, pheno_cols, pheno_names, covar_cols, covar_names, variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, maj_alleles, allele_freqs, allele_storage, &(pcp->glm_info), &(pcp->adjust_info), &(pcp->aperm), pcp->glm_local_covar_fname, pcp->glm_local_pvar_fname, pcp->glm_local_psam_fname, raw_sample_ct, sample_ct, pheno_ct, max_pheno_name_blen, covar_ct, max_covar_name_blen, raw_variant_ct, variant_ct, max_variant_id_slen, max_allele_slen, pcp->xchr_model, pcp->ci_size, pcp->vif_thresh, pcp->ln_pfilter, pcp->output_min_ln, pcp->max_thread_ct, pgr_alloc_cacheline_ct, &pgfi, &simple_pgr, sfmtp, outname, outname_end);
         if (unlikely(reterr)) {
           goto Plink2Core_ret_1;
         }
@@ -3216,6 +3272,7 @@ int main(int argc, char** argv) {
   pc.loop_cats_phenoname = nullptr;
   pc.fa_fname = nullptr;
   pc.king_table_subset_fname = nullptr;
+  pc.pca_proj_fname = nullptr;
   pc.require_info_flattened = nullptr;
   pc.require_no_info_flattened = nullptr;
   pc.keep_col_match_fname = nullptr;
@@ -3544,13 +3601,17 @@ int main(int argc, char** argv) {
     pc.sort_vars_mode = kSort0;
     pc.grm_flags = kfGrm0;
     pc.pca_flags = kfPca0;
+    pc.pca_proj_flags = kfPcaProj0;
     pc.write_covar_flags = kfWriteCovar0;
     pc.pheno_transform_flags = kfPhenoTransform0;
     pc.fa_flags = kfFa0;
     pc.fam_cols = kfFamCol13456;
     pc.king_flags = kfKing0;
     pc.king_cutoff = -1;
+    pc.grm_sparse_cutoff = 0.05;
     pc.king_table_filter = -DBL_MAX;
+    pc.king_screen_max_carrier_ct = 20;
+    pc.king_screen_min_shared_ct = 2;
     pc.freq_rpt_flags = kfAlleleFreq0;
     pc.missing_rpt_flags = kfMissingRpt0;
     pc.geno_counts_flags = kfGenoCounts0;
@@ -3607,6 +3668,8 @@ int main(int argc, char** argv) {
     pc.to_bp = -1;
     pc.window_bp = -1;
     pc.pca_ct = 0;
+    pc.pca_iter_ct = 10;
+    pc.pca_block_size = 0;
     pc.xchr_model = 2;
     pc.parallel_idx = 0;
     pc.parallel_tot = 1;
@@ -5383,11 +5446,13 @@ int main(int argc, char** argv) {
           pc.command_flags1 |= kfCommand1GenoCounts;
           pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "lm")) {
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 18))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 20))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t explicit_firth_fallback = 0;
           uint32_t glm_allow_no_covars = 0;
+          uint32_t set_max_maf_given = 0;
+          uint32_t set_max_vct_given = 0;
           for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
             const char* cur_modif = argvk[arg_idx + param_idx];
             const uint32_t cur_modif_slen = strlen(cur_modif);
@@ -5429,10 +5494,113 @@ int main(int argc, char** argv) {
               explicit_firth_fallback = 1;
             } else if (strequal_k(cur_modif, "firth", cur_modif_slen)) {
               pc.glm_info.flags |= kfGlmFirth;
+            } else if (strequal_k(cur_modif, "firth-warm-start", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmFirthWarmStart;
             } else if (strequal_k(cur_modif, "firth-residualize", cur_modif_slen)) {
               pc.glm_info.flags |= kfGlmFirthResidualize;
             } else if (strequal_k(cur_modif, "cc-residualize", cur_modif_slen)) {
               pc.glm_info.flags |= kfGlmCcResidualize;
+            } else if (StrStartsWith(cur_modif, "score-screen=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.flags & kfGlmScoreScreen)) {
+                logerrputs("Error: Multiple --glm score-screen= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* thresh_str = &(cur_modif[strlen("score-screen=")]);
+              if (unlikely((!ScantokLn(thresh_str, &pc.glm_info.score_screen_ln_thresh)) || (pc.glm_info.score_screen_ln_thresh == -DBL_MAX) || (pc.glm_info.score_screen_ln_thresh >= 0.0))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm score-screen= p-value threshold '%s' (must be in (0, 1)).\n", thresh_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              pc.glm_info.flags |= kfGlmScoreScreen;
+            } else if (strequal_k(cur_modif, "spa", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmScoreScreenSpa;
+            } else if (strequal_k(cur_modif, "loco-ridge", cur_modif_slen) || StrStartsWith(cur_modif, "loco-ridge=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.flags & kfGlmLocoRidge)) {
+                logerrputs("Error: Multiple --glm loco-ridge modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              if (cur_modif_slen > strlen("loco-ridge")) {
+                const char* h2_str = &(cur_modif[strlen("loco-ridge=")]);
+                if (unlikely((!ScantokDouble(h2_str, &pc.glm_info.loco_ridge_h2)) || (pc.glm_info.loco_ridge_h2 <= 0.0) || (pc.glm_info.loco_ridge_h2 >= 1.0))) {
+                  snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm loco-ridge= heritability '%s' (must be in (0, 1)).\n", h2_str);
+                  goto main_ret_INVALID_CMDLINE_WWA;
+                }
+              }
+              pc.glm_info.flags |= kfGlmLocoRidge;
+            } else if (StrStartsWith(cur_modif, "stepwise=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.flags & kfGlmStepwise)) {
+                logerrputs("Error: Multiple --glm stepwise= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* thresh_str = &(cur_modif[strlen("stepwise=")]);
+              if (unlikely((!ScantokLn(thresh_str, &pc.glm_info.stepwise_ln_thresh)) || (pc.glm_info.stepwise_ln_thresh == -DBL_MAX) || (pc.glm_info.stepwise_ln_thresh >= 0.0))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm stepwise= p-value threshold '%s' (must be in (0, 1)).\n", thresh_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              pc.glm_info.flags |= kfGlmStepwise;
+            } else if (strequal_k(cur_modif, "checkpoint", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmCheckpoint;
+            } else if (strequal_k(cur_modif, "resume", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmCheckpoint | kfGlmResume;
+            } else if (StrStartsWith(cur_modif, "set-test-bed0=", cur_modif_slen) ||
+                       StrStartsWith(cur_modif, "set-test-bed1=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.set_test_fname)) {
+                logerrputs("Error: Multiple --glm set-test-bed{0,1}= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              reterr = AllocFname(&(cur_modif[strlen("set-test-bed0=")]), "glm set-test-bed{0,1}=", 0, &pc.glm_info.set_test_fname);
+              if (unlikely(reterr)) {
+                goto main_ret_1;
+              }
+              pc.glm_info.flags |= kfGlmSetTest;
+              if (cur_modif[strlen("set-test-bed")] == '0') {
+                pc.glm_info.flags |= kfGlmSetTestBed0;
+              }
+            } else if (StrStartsWith(cur_modif, "set-test-max-maf=", cur_modif_slen)) {
+              if (unlikely(set_max_maf_given)) {
+                logerrputs("Error: Multiple --glm set-test-max-maf= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* maf_str = &(cur_modif[strlen("set-test-max-maf=")]);
+              if (unlikely((!ScantokDouble(maf_str, &pc.glm_info.set_max_maf)) || (pc.glm_info.set_max_maf <= 0.0) || (pc.glm_info.set_max_maf > 0.5))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm set-test-max-maf= argument '%s' (must be in (0, 0.5]).\n", maf_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              set_max_maf_given = 1;
+            } else if (StrStartsWith(cur_modif, "set-test-max-vct=", cur_modif_slen)) {
+              if (unlikely(set_max_vct_given)) {
+                logerrputs("Error: Multiple --glm set-test-max-vct= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* ct_str = &(cur_modif[strlen("set-test-max-vct=")]);
+              if (unlikely(ScanPosintDefcapx(ct_str, &pc.glm_info.set_max_vct))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm set-test-max-vct= argument '%s'.\n", ct_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              set_max_vct_given = 1;
+            } else if (StrStartsWith(cur_modif, "hits=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.hits_max_ct)) {
+                logerrputs("Error: Multiple --glm hits= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* ct_str = &(cur_modif[strlen("hits=")]);
+              if (unlikely(ScanPosintDefcapx(ct_str, &pc.glm_info.hits_max_ct))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm hits= argument '%s'.\n", ct_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              pc.glm_info.flags |= kfGlmHits;
+            } else if (StrStartsWith(cur_modif, "hits-p=", cur_modif_slen)) {
+              if (unlikely(pc.glm_info.hits_ln_thresh != 0.0)) {
+                logerrputs("Error: Multiple --glm hits-p= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              const char* thresh_str = &(cur_modif[strlen("hits-p=")]);
+              if (unlikely((!ScantokLn(thresh_str, &pc.glm_info.hits_ln_thresh)) || (pc.glm_info.hits_ln_thresh == -DBL_MAX) || (pc.glm_info.hits_ln_thresh >= 0.0))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm hits-p= p-value threshold '%s' (must be in (0, 1)).\n", thresh_str);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              pc.glm_info.flags |= kfGlmHits;
+            } else if (strequal_k(cur_modif, "sumstats-bin", cur_modif_slen)) {
+              pc.glm_info.flags |= kfGlmSumstatsBin;
             } else if (unlikely(strequal_k(cur_modif, "standard-beta", cur_modif_slen))) {
               logerrputs("Error: --glm 'standard-beta' modifier has been retired.  Use\n--{covar-}variance-standardize instead.\n");
               goto main_ret_INVALID_CMDLINE_A;
@@ -5445,7 +5613,7 @@ int main(int argc, char** argv) {
                 logerrputs("Error: Multiple --glm cols= modifiers.\n");
                 goto main_ret_INVALID_CMDLINE;
               }
-              reterr = ParseColDescriptor(&(cur_modif[5]), "chrom\0pos\0ref\0alt1\0alt\0ax\0a1count\0totallele\0a1countcc\0totallelecc\0gcountcc\0a1freq\0a1freqcc\0machr2\0firth\0test\0nobs\0beta\0orbeta\0se\0ci\0tz\0p\0err\0", "glm", kfGlmColChrom, kfGlmColDefault, 1, &pc.glm_info.cols);
+              reterr = ParseColDescriptor(&(cur_modif[5]), "chrom\0pos\0ref\0alt1\0alt\0ax\0a1count\0totallele\0a1countcc\0totallelecc\0gcountcc\0a1freq\0a1freqcc\0machr2\0firth\0screen\0test\0nobs\0beta\0orbeta\0se\0ci\0tz\0p\0err\0", "glm", kfGlmColChrom, kfGlmColDefault, 1, &pc.glm_info.cols);
               if (unlikely(reterr)) {
                 goto main_ret_1;
               }
@@ -5560,6 +5728,12 @@ int main(int argc, char** argv) {
             logerrputs("Error: Conflicting --glm arguments.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (pc.glm_info.flags & kfGlmFirthWarmStart) {
+            if (unlikely(pc.glm_info.flags & (kfGlmNoFirth | kfGlmFirthResidualize | kfGlmCcResidualize))) {
+              logerrputs("Error: --glm 'firth-warm-start' cannot be used with 'no-firth',\n'firth-residualize', or 'cc-residualize'.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
           if (unlikely((pc.glm_info.flags & (kfGlmSex | kfGlmNoXSex)) == (kfGlmSex | kfGlmNoXSex))) {
             logerrputs("Error: Conflicting --glm arguments.\n");
             goto main_ret_INVALID_CMDLINE_A;
@@ -5594,6 +5768,105 @@ int main(int argc, char** argv) {
               goto main_ret_INVALID_CMDLINE;
             }
           }
+          if (unlikely((pc.glm_info.flags & (kfGlmScoreScreen | kfGlmScoreScreenSpa)) == kfGlmScoreScreenSpa)) {
+            logerrputs("Error: --glm 'spa' must be used with 'score-screen='.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (pc.glm_info.flags & kfGlmScoreScreen) {
+            if (unlikely(!(pc.glm_info.flags & kfGlmHideCovar))) {
+              logerrputs("Error: --glm 'score-screen=' requires 'hide-covar' to be specified as well.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_info.flags & (kfGlmGenotypic | kfGlmHethom | kfGlmDominant | kfGlmRecessive | kfGlmInteraction | kfGlmIntercept))) {
+              logerrputs("Error: --glm 'score-screen=' cannot be used with 'genotypic', 'hethom',\n'dominant', 'recessive', 'interaction', or 'intercept'.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_local_covar_fname)) {
+              logerrputs("Error: --glm 'score-screen=' cannot be used with local covariates.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely((pc.glm_info.flags & kfGlmPerm) || pc.glm_info.mperm_ct)) {
+              logerrputs("Error: --glm 'score-screen=' cannot be used with permutation testing.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
+          if (pc.glm_info.flags & kfGlmLocoRidge) {
+            if (unlikely(pc.glm_info.flags & (kfGlmFirthResidualize | kfGlmCcResidualize | kfGlmScoreScreen))) {
+              logerrputs("Error: --glm 'loco-ridge' cannot be used with 'cc-residualize',\n'firth-residualize', or 'score-screen='.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_local_covar_fname)) {
+              logerrputs("Error: --glm 'loco-ridge' cannot be used with local covariates.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely((pc.glm_info.flags & kfGlmPerm) || pc.glm_info.mperm_ct)) {
+              logerrputs("Error: --glm 'loco-ridge' cannot be used with permutation testing.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
+          if (pc.glm_info.flags & kfGlmStepwise) {
+            if (unlikely(pc.glm_info.flags & (kfGlmGenotypic | kfGlmHethom | kfGlmDominant | kfGlmRecessive | kfGlmInteraction | kfGlmLocoRidge | kfGlmScoreScreen))) {
+              logerrputs("Error: --glm 'stepwise=' cannot be used with 'genotypic', 'hethom', 'dominant',\n'recessive', 'interaction', 'loco-ridge', or 'score-screen='.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_local_covar_fname)) {
+              logerrputs("Error: --glm 'stepwise=' cannot be used with local covariates.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely((pc.glm_info.flags & kfGlmPerm) || pc.glm_info.mperm_ct)) {
+              logerrputs("Error: --glm 'stepwise=' cannot be used with permutation testing.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.adjust_info.flags & kfAdjustColAll)) {
+              logerrputs("Error: --glm 'stepwise=' cannot be used with --adjust.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
+          if (pc.glm_info.flags & kfGlmSetTest) {
+            if (unlikely(pc.glm_info.flags & (kfGlmGenotypic | kfGlmHethom | kfGlmDominant | kfGlmRecessive | kfGlmInteraction | kfGlmLocoRidge | kfGlmStepwise | kfGlmScoreScreen | kfGlmCheckpoint))) {
+              logerrputs("Error: --glm 'set-test-bed{0,1}=' cannot be used with 'genotypic', 'hethom',\n'dominant', 'recessive', 'interaction', 'loco-ridge', 'stepwise=',\n'score-screen=', or 'checkpoint'/'resume'.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_local_covar_fname)) {
+              logerrputs("Error: --glm 'set-test-bed{0,1}=' cannot be used with local covariates.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely((pc.glm_info.flags & kfGlmPerm) || pc.glm_info.mperm_ct)) {
+              logerrputs("Error: --glm 'set-test-bed{0,1}=' cannot be used with permutation testing.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.adjust_info.flags & kfAdjustColAll)) {
+              logerrputs("Error: --glm 'set-test-bed{0,1}=' cannot be used with --adjust.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          } else if (unlikely(set_max_maf_given || set_max_vct_given)) {
+            logerrputs("Error: --glm 'set-test-max-maf=' and 'set-test-max-vct=' must be used with\n'set-test-bed{0,1}='.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (pc.glm_info.flags & (kfGlmHits | kfGlmSumstatsBin)) {
+            if (unlikely(pc.glm_info.flags & (kfGlmStepwise | kfGlmSetTest | kfGlmCheckpoint))) {
+              logerrputs("Error: --glm 'hits='/'hits-p='/'sumstats-bin' cannot be used with 'stepwise=',\n'set-test-bed{0,1}=', or 'checkpoint'/'resume'.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
+          if (pc.glm_info.flags & kfGlmCheckpoint) {
+            if (unlikely(pc.glm_info.flags & kfGlmStepwise)) {
+              logerrputs("Error: --glm 'checkpoint'/'resume' cannot be used with 'stepwise='.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.glm_local_covar_fname)) {
+              logerrputs("Error: --glm 'checkpoint'/'resume' cannot be used with local covariates.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely((pc.glm_info.flags & kfGlmPerm) || pc.glm_info.mperm_ct)) {
+              logerrputs("Error: --glm 'checkpoint'/'resume' cannot be used with permutation testing.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+            if (unlikely(pc.adjust_info.flags & kfAdjustColAll)) {
+              logerrputs("Error: --glm 'checkpoint'/'resume' cannot be used with --adjust.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
+          }
           uint32_t alternate_genotype_col_flags = S_CAST(uint32_t, pc.glm_info.flags & (kfGlmGenotypic | kfGlmHethom | kfGlmDominant | kfGlmRecessive));
           if (alternate_genotype_col_flags) {
             pc.xchr_model = 0;
@@ -6271,6 +6544,35 @@ int main(int argc, char** argv) {
             goto main_ret_INVALID_CMDLINE_WWA;
           }
           pc.command_flags1 |= kfCommand1KingCutoff;
+        } else if (strequal_k_unsafe(flagname_p2, "ing-screen")) {
+          if (unlikely(king_cutoff_fprefix)) {
+            logerrputs("Error: --king-screen cannot be used with a --king-cutoff input fileset.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 2))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
+            const char* cur_modif = argvk[arg_idx + param_idx];
+            const uint32_t cur_modif_slen = strlen(cur_modif);
+            if (StrStartsWith(cur_modif, "max-carriers=", cur_modif_slen)) {
+              const char* max_carriers_start = &(cur_modif[strlen("max-carriers=")]);
+              if (unlikely(ScanPosintCappedx(max_carriers_start, 65535, &pc.king_screen_max_carrier_ct) || (pc.king_screen_max_carrier_ct < 2))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --king-screen max-carriers= argument '%s'.\n", max_carriers_start);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+            } else if (likely(StrStartsWith(cur_modif, "min-shared=", cur_modif_slen))) {
+              const char* min_shared_start = &(cur_modif[strlen("min-shared=")]);
+              if (unlikely(ScanPosintDefcapx(min_shared_start, &pc.king_screen_min_shared_ct))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --king-screen min-shared= argument '%s'.\n", min_shared_start);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+            } else {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --king-screen argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+          }
+          pc.king_flags |= kfKingScreen;
         } else if (strequal_k_unsafe(flagname_p2, "ing-table-filter")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 1))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -6285,6 +6587,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --king-table-subset cannot be used with --king-cutoff.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely(pc.king_flags & kfKingScreen)) {
+            logerrputs("Error: --king-table-subset cannot be used with --king-screen.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
@@ -6577,7 +6883,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-bpgen cannot be used with --keep-autoconv.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 7))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 8))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t varid_semicolon = 0;
@@ -6644,11 +6950,19 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenEraseDosage;
             } else if (strequal_k(cur_modif, "fill-missing-from-dosage", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
+            } else if (strequal_k(cur_modif, "smaj", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenSmaj;
+            } else if (strequal_k(cur_modif, "cksum", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenCksum;
             } else {
               snprintf(g_logbuf, kLogbufSize, "Error: Invalid --make-bpgen argument '%s'.\n", cur_modif);
               goto main_ret_INVALID_CMDLINE_WWA;
             }
           }
+          if (unlikely((make_plink2_flags & kfMakePgenCksum) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-bpgen 'cksum' modifier cannot be used with 'format='.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if ((make_plink2_flags & (kfMakePlink2TrimAlts | kfMakePlink2EraseAlt2Plus)) == (kfMakePlink2TrimAlts | kfMakePlink2EraseAlt2Plus)) {
             logerrputs("Error: --make-bpgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
@@ -6695,7 +7009,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-pgen cannot be used with --keep-autoconv.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 9))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 11))) {
             goto main_ret_INVALID_CMDLINE_A;
           }
           uint32_t explicit_pvar_cols = 0;
@@ -6777,6 +7091,13 @@ int main(int argc, char** argv) {
               make_plink2_flags |= kfMakePgenEraseDosage;
             } else if (strequal_k(cur_modif, "fill-missing-from-dosage", cur_modif_slen)) {
               make_plink2_flags |= kfMakePgenFillMissingFromDosage;
+            } else if (strequal_k(cur_modif, "smaj", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenSmaj;
+            } else if (strequal_k(cur_modif, "cksum", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePgenCksum;
+            } else if (strequal_k(cur_modif, "vidx", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePvarVidx;
+              pc.pvar_psam_flags |= kfPvarZs;
             } else if (likely(StrStartsWith0(cur_modif, "psam-cols=", cur_modif_slen))) {
               if (unlikely(explicit_psam_cols)) {
                 logerrputs("Error: Multiple --make-pgen psam-cols= modifiers.\n");
@@ -6792,6 +7113,10 @@ int main(int argc, char** argv) {
               goto main_ret_INVALID_CMDLINE_WWA;
             }
           }
+          if (unlikely((make_plink2_flags & kfMakePgenCksum) && (make_plink2_flags & (kfMakePgenFormatBase * 3)))) {
+            logerrputs("Error: --make-pgen 'cksum' modifier cannot be used with 'format='.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if ((make_plink2_flags & (kfMakePlink2TrimAlts | kfMakePlink2EraseAlt2Plus)) == (kfMakePlink2TrimAlts | kfMakePlink2EraseAlt2Plus)) {
             logerrputs("Error: --make-pgen 'trim-alts' and 'erase-alt2+' modifiers cannot be used\ntogether.\n");
             goto main_ret_INVALID_CMDLINE_A;
@@ -6860,7 +7185,7 @@ int main(int argc, char** argv) {
             logerrputs("Error: --make-just-... cannot be used with --make-bed/--make-[b]pgen.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 2))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 3))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t explicit_cols = 0;
@@ -6869,6 +7194,9 @@ int main(int argc, char** argv) {
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
               pc.pvar_psam_flags |= kfPvarZs;
+            } else if (strequal_k(cur_modif, "vidx", cur_modif_slen)) {
+              make_plink2_flags |= kfMakePvarVidx;
+              pc.pvar_psam_flags |= kfPvarZs;
             } else if (likely(StrStartsWith0(cur_modif, "cols=", cur_modif_slen))) {
               if (unlikely(explicit_cols)) {
                 logerrputs("Error: Multiple --make-just-pvar cols= modifiers.\n");
@@ -6931,6 +7259,9 @@ int main(int argc, char** argv) {
           } else if (unlikely(pc.king_table_subset_fname)) {
             logerrputs("Error: --make-king cannot be used with --king-table-subset.\n");
             goto main_ret_INVALID_CMDLINE_A;
+          } else if (unlikely(pc.king_flags & kfKingScreen)) {
+            logerrputs("Error: --make-king cannot be used with --king-screen.\n");
+            goto main_ret_INVALID_CMDLINE_A;
           }
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -7011,6 +7342,10 @@ int main(int argc, char** argv) {
                 logerrputs("Error: --make-king-table 'rel-check' modifier cannot be used with\n--king-cutoff.\n");
                 goto main_ret_INVALID_CMDLINE;
               }
+              if (unlikely(pc.king_flags & kfKingScreen)) {
+                logerrputs("Error: --make-king-table 'rel-check' modifier cannot be used with\n--king-screen.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
               pc.king_flags |= kfKingRelCheck;
             } else if (likely(StrStartsWith(cur_modif, "cols=", cur_modif_slen))) {
               if (unlikely(pc.king_flags & kfKingColAll)) {
@@ -7608,9 +7943,48 @@ int main(int argc, char** argv) {
           }
           pc.command_flags1 |= kfCommand1MakeRel;
           pc.dependency_flags |= kfFilterAllReq;
+        } else if (strequal_k_unsafe(flagname_p2, "ake-grm-sparse")) {
+          if (unlikely(pc.command_flags1 & kfCommand1MakeRel)) {
+            logerrputs("Error: --make-grm-sparse cannot be used with --make-grm-list/--make-grm-bin.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 6))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          pc.grm_flags |= kfGrmNoIdHeader | kfGrmSparse;
+          for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
+            const char* cur_modif = argvk[arg_idx + param_idx];
+            const uint32_t cur_modif_slen = strlen(cur_modif);
+            if (strequal_k(cur_modif, "cov", cur_modif_slen)) {
+              pc.grm_flags |= kfGrmCov;
+            } else if (strequal_k(cur_modif, "meanimpute", cur_modif_slen)) {
+              pc.grm_flags |= kfGrmMeanimpute;
+            } else if (strequal_k(cur_modif, "zs", cur_modif_slen)) {
+              pc.grm_flags |= kfGrmSparseZs;
+            } else if (strequal_k(cur_modif, "id-header", cur_modif_slen) ||
+                       strequal_k(cur_modif, "idheader", cur_modif_slen)) {
+              pc.grm_flags &= ~kfGrmNoIdHeader;
+            } else if (strequal_k(cur_modif, "iid-only", cur_modif_slen)) {
+              pc.grm_flags |= kfGrmNoIdHeaderIidOnly;
+            } else if (likely(StrStartsWith(cur_modif, "cutoff=", cur_modif_slen))) {
+              if (unlikely((!ScantokDouble(&(cur_modif[strlen("cutoff=")]), &pc.grm_sparse_cutoff)) || (pc.grm_sparse_cutoff >= 2.0))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --make-grm-sparse cutoff '%s'.\n", &(cur_modif[strlen("cutoff=")]));
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+            } else {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --make-grm-sparse argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+          }
+          if (unlikely((pc.grm_flags & (kfGrmNoIdHeader | kfGrmNoIdHeaderIidOnly)) == kfGrmNoIdHeaderIidOnly)) {
+            logerrputs("Error: --make-grm-sparse 'id-header' and 'iid-only' modifiers cannot be used\ntogether.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
+          pc.command_flags1 |= kfCommand1MakeRel;
+          pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "ake-rel")) {
           if (unlikely(pc.command_flags1 & kfCommand1MakeRel)) {
-            logerrputs("Error: --make-rel cannot be used with --make-grm-list/--make-grm-bin.\n");
+            logerrputs("Error: --make-rel cannot be used with\n--make-grm-list/--make-grm-bin/--make-grm-sparse.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 4))) {
@@ -8240,6 +8614,19 @@ int main(int argc, char** argv) {
             goto main_ret_OPEN_FAIL;
           }
           memcpy(pvarname, fname, slen + 1);
+        } else if (strequal_k_unsafe(flagname_p2, "var-cache")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          if (param_ct) {
+            const char* cur_modif = argvk[arg_idx + 1];
+            if (unlikely(strcmp("full-hash", cur_modif))) {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pvar-cache argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+            pc.misc_flags |= kfMiscPvarCacheFullHash;
+          }
+          pc.misc_flags |= kfMiscPvarCache;
         } else if (strequal_k_unsafe(flagname_p2, "heno")) {
           if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 2))) {
             goto main_ret_INVALID_CMDLINE_2A;
@@ -8314,6 +8701,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --parameters cannot be used with --glm firth-residualize.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely(pc.glm_info.flags & kfGlmScoreScreen)) {
+            logerrputs("Error: --parameters cannot be used with --glm score-screen=.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           reterr = ParseNameRanges(&(argvk[arg_idx]), errstr_append, param_ct, 1, '-', &pc.glm_info.parameters_range_list);
           if (unlikely(reterr)) {
             goto main_ret_1;
@@ -8336,22 +8727,41 @@ int main(int argc, char** argv) {
           logerrputs("Error: --pca requires " PROG_NAME_STR " to be built with LAPACK.\n");
           goto main_ret_INVALID_CMDLINE;
 #endif
-          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 6))) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 10))) {
             goto main_ret_INVALID_CMDLINE_2A;
           }
           uint32_t explicit_scols = 0;
           uint32_t vcols_idx = 0;
+          uint32_t stream_param_present = 0;
           for (uint32_t param_idx = 1; param_idx <= param_ct; ++param_idx) {
             const char* cur_modif = argvk[arg_idx + param_idx];
             const uint32_t cur_modif_slen = strlen(cur_modif);
             if (strequal_k(cur_modif, "approx", cur_modif_slen)) {
               pc.pca_flags |= kfPcaApprox;
+            } else if (strequal_k(cur_modif, "stream", cur_modif_slen)) {
+              pc.pca_flags |= kfPcaApprox | kfPcaStream;
+            } else if (StrStartsWith(cur_modif, "iters=", cur_modif_slen)) {
+              const char* iters_start = &(cur_modif[strlen("iters=")]);
+              if (unlikely(ScanUintCappedx(iters_start, 1000, &pc.pca_iter_ct))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pca iters= argument '%s'.\n", iters_start);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              stream_param_present = 1;
+            } else if (StrStartsWith(cur_modif, "block-size=", cur_modif_slen)) {
+              const char* block_size_start = &(cur_modif[strlen("block-size=")]);
+              if (unlikely(ScanPosintCappedx(block_size_start, 16000, &pc.pca_block_size))) {
+                snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pca block-size= argument '%s'.\n", block_size_start);
+                goto main_ret_INVALID_CMDLINE_WWA;
+              }
+              stream_param_present = 1;
             } else if (strequal_k(cur_modif, "meanimpute", cur_modif_slen)) {
               pc.pca_flags |= kfPcaMeanimpute;
             } else if (strequal_k(cur_modif, "allele-wts", cur_modif_slen)) {
               pc.pca_flags |= kfPcaAlleleWts;
             } else if (strequal_k(cur_modif, "biallelic-var-wts", cur_modif_slen)) {
               pc.pca_flags |= kfPcaBiallelicVarWts;
+            } else if (strequal_k(cur_modif, "model", cur_modif_slen)) {
+              pc.pca_flags |= kfPcaModel;
             } else if (strequal_k(cur_modif, "vzs", cur_modif_slen)) {
               pc.pca_flags |= kfPcaVarZs;
             } else if (StrStartsWith0(cur_modif, "scols=", cur_modif_slen)) {
@@ -8388,8 +8798,14 @@ int main(int argc, char** argv) {
               }
             }
           }
+          if (unlikely(stream_param_present && (!(pc.pca_flags & kfPcaStream)))) {
+            logerrputs("Error: --pca 'iters=' and 'block-size=' modifiers require 'stream'.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (pc.pca_flags & kfPcaApprox) {
-            if (unlikely(pc.pca_ct > 100)) {
+            // streaming subspace iteration doesn't form Krylov powers, so the
+            // overflow concern doesn't apply there
+            if (unlikely((pc.pca_ct > 100) && (!(pc.pca_flags & kfPcaStream)))) {
               // double-precision overflow too likely
               logerrputs("Error: --pca approx does not support more than 100 PCs.\n");
               goto main_ret_INVALID_CMDLINE;
@@ -8400,6 +8816,10 @@ int main(int argc, char** argv) {
               logerrputs("Error: Non-approximate --pca cannot be used with --parallel.\n");
               goto main_ret_INVALID_CMDLINE_A;
             }
+            if (unlikely(pc.grm_flags & kfGrmSparse)) {
+              logerrputs("Error: --make-grm-sparse cannot be used with non-approximate --pca.\n");
+              goto main_ret_INVALID_CMDLINE_A;
+            }
             const uint32_t pca_meanimpute = (pc.pca_flags / kfPcaMeanimpute) & 1;
             if (pc.command_flags1 & kfCommand1MakeRel) {
               if (unlikely(((pc.grm_flags / kfGrmMeanimpute) & 1) != pca_meanimpute)) {
@@ -8419,6 +8839,10 @@ int main(int argc, char** argv) {
           if (!pc.pca_ct) {
             pc.pca_ct = 10;
           }
+          if (unlikely(pc.pca_block_size && (pc.pca_block_size < pc.pca_ct))) {
+            logerrputs("Error: --pca block-size= value cannot be smaller than the PC count.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if (!explicit_scols) {
             pc.pca_flags |= kfPcaScolDefault;
           }
@@ -8463,10 +8887,66 @@ int main(int argc, char** argv) {
           }
           pc.command_flags1 |= kfCommand1Pca;
           pc.dependency_flags |= kfFilterAllReq;
+        } else if (strequal_k_unsafe(flagname_p2, "ca-project")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 1, 3))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          uint32_t explicit_scols = 0;
+          for (uint32_t param_idx = 2; param_idx <= param_ct; ++param_idx) {
+            const char* cur_modif = argvk[arg_idx + param_idx];
+            const uint32_t cur_modif_slen = strlen(cur_modif);
+            if (strequal_k(cur_modif, "shrinkage", cur_modif_slen)) {
+              pc.pca_proj_flags |= kfPcaProjShrink;
+            } else if (StrStartsWith0(cur_modif, "scols=", cur_modif_slen)) {
+              if (unlikely(explicit_scols)) {
+                logerrputs("Error: Multiple --pca-project scols= modifiers.\n");
+                goto main_ret_INVALID_CMDLINE;
+              }
+              reterr = ParseColDescriptor(&(cur_modif[strlen("scols=")]), "maybefid\0fid\0maybesid\0sid\0", "pca-project scols", kfPcaProjScolMaybefid, kfPcaProjScolDefault, 0, &pc.pca_proj_flags);
+              if (unlikely(reterr)) {
+                goto main_ret_1;
+              }
+              explicit_scols = 1;
+            } else {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pca-project argument '%s'.\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+          }
+          if (!explicit_scols) {
+            pc.pca_proj_flags |= kfPcaProjScolDefault;
+          }
+          reterr = AllocFname(argvk[arg_idx + 1], flagname_p, 0, &pc.pca_proj_fname);
+          if (unlikely(reterr)) {
+            goto main_ret_1;
+          }
+          pc.command_flags1 |= kfCommand1PcaProject;
+          pc.dependency_flags |= kfFilterAllReq;
         } else if (strequal_k_unsafe(flagname_p2, "gen-info")) {
           pc.command_flags1 |= kfCommand1PgenInfo;
           pc.dependency_flags |= kfFilterAllReq;
           goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "gen-mmap")) {
+#ifdef NO_MMAP
+          logerrputs("Warning: --pgen-mmap is not supported by this build; ignoring.\n");
+#else
+          pc.misc_flags |= kfMiscPgenMmap;
+#endif
+          goto main_param_zero;
+        } else if (strequal_k_unsafe(flagname_p2, "gen-prefetch")) {
+          if (unlikely(EnforceParamCtRange(argvk[arg_idx], param_ct, 0, 1))) {
+            goto main_ret_INVALID_CMDLINE_2A;
+          }
+          g_pgen_prefetch_ct = 4;
+          if (param_ct) {
+            const char* cur_modif = argvk[arg_idx + 1];
+            if (unlikely(ScanUintCappedx(cur_modif, 64, &g_pgen_prefetch_ct) || (g_pgen_prefetch_ct && (g_pgen_prefetch_ct < 3)))) {
+              snprintf(g_logbuf, kLogbufSize, "Error: Invalid --pgen-prefetch argument '%s' (must be 0 or 3..64).\n", cur_modif);
+              goto main_ret_INVALID_CMDLINE_WWA;
+            }
+          }
+        } else if (strequal_k_unsafe(flagname_p2, "gen-verify")) {
+          pc.misc_flags |= kfMiscPgenVerify;
+          goto main_param_zero;
         } else if (strequal_k_unsafe(flagname_p2, "merge")) {
           if (unlikely(import_flags & kfImportKeepAutoconv)) {
             logerrputs("Error: --pmerge cannot be used with --keep-autoconv.\n");
@@ -9805,6 +10285,10 @@ int main(int argc, char** argv) {
             logerrputs("Error: --tests cannot be used with --glm firth-residualize.\n");
             goto main_ret_INVALID_CMDLINE_A;
           }
+          if (unlikely(pc.glm_info.flags & kfGlmScoreScreen)) {
+            logerrputs("Error: --tests cannot be used with --glm score-screen=.\n");
+            goto main_ret_INVALID_CMDLINE_A;
+          }
           if ((param_ct == 1) && (!strcmp(argvk[arg_idx + 1], "all"))) {
             pc.glm_info.flags |= kfGlmTestsAll;
           } else {
@@ -10408,6 +10892,16 @@ int main(int argc, char** argv) {
       logerrputs("Error: --indiv-sort must be used with --make-[b]pgen/--make-bed/--write-covar\nor dataset merging.\n");
       goto main_ret_INVALID_CMDLINE_A;
     }
+    if (pc.king_flags & kfKingScreen) {
+      if (unlikely(!(pc.command_flags1 & (kfCommand1MakeKing | kfCommand1KingCutoff)))) {
+        logerrputs("Error: --king-screen must be used with --make-king-table or --king-cutoff.\n");
+        goto main_ret_INVALID_CMDLINE_A;
+      }
+      if (unlikely((pc.king_flags & kfKingColAll) && (pc.king_table_filter == -DBL_MAX))) {
+        logerrputs("Error: --king-screen requires --king-table-filter when used with\n--make-king-table.\n");
+        goto main_ret_INVALID_CMDLINE_A;
+      }
+    }
     // may as well permit merge here
     if (unlikely((make_plink2_flags & (kfMakePlink2MMask | kfMakePlink2TrimAlts | kfMakePlink2EraseAlt2Plus | kfMakePgenErasePhase | kfMakePgenEraseDosage)) && (pc.command_flags1 & (~(kfCommand1MakePlink2 | kfCommand1Pmerge))))) {
       logerrputs("Error: When the 'multiallelics=', 'trim-alts', and/or 'erase-...' modifier is\npresent, --make-bed/--make-[b]pgen cannot be combined with other commands.\n(Other filters are fine.)\n");
@@ -10535,6 +11029,12 @@ int main(int argc, char** argv) {
 #  endif
     }
 #endif
+    if (unlikely((!rseeds) && (pc.command_flags1 & kfCommand1Glm) && ((pc.glm_info.flags & (kfGlmLocoRidge | kfGlmCheckpoint)) == (kfGlmLocoRidge | kfGlmCheckpoint)))) {
+      // otherwise a resumed run would draw different cross-validation folds,
+      // and stitch together results from two different null fits
+      logerrputs("Error: --glm 'loco-ridge' + 'checkpoint'/'resume' requires --seed.\n");
+      goto main_ret_INVALID_CMDLINE_A;
+    }
     sfmt_t main_sfmt;
     if (!rseeds) {
       uint32_t seed = S_CAST(uint32_t, time(nullptr));
@@ -10852,6 +11352,7 @@ int main(int argc, char** argv) {
   free_cond(pc.require_no_info_flattened);
   free_cond(pc.require_info_flattened);
   free_cond(pc.king_table_subset_fname);
+  free_cond(pc.pca_proj_fname);
   free_cond(pc.fa_fname);
   free_cond(pc.loop_cats_phenoname);
   free_cond(pc.covar_quantnorm_flattened);
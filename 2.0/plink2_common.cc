@@ -235,46 +235,6 @@ void PopulateDenseDosage(const uintptr_t* genoarr, const uintptr_t* dosage_prese
   }
 }
 
-void PopulateRescaledDosage(const uintptr_t* genoarr, const uintptr_t* dosage_present, const Dosage* dosage_main, double slope, double intercept, double missing_val, uint32_t sample_ct, uint32_t dosage_ct, double* expanded_dosages) {
-  double lookup_vals[32] ALIGNV16;
-  lookup_vals[0] = intercept;
-  lookup_vals[2] = intercept + slope;
-  lookup_vals[4] = intercept + 2 * slope;
-  lookup_vals[6] = missing_val;
-  InitLookup16x8bx2(lookup_vals);
-  GenoarrLookup16x8bx2(genoarr, lookup_vals, sample_ct, expanded_dosages);
-  if (!dosage_ct) {
-    return;
-  }
-  slope *= kRecipDosageMid;
-  uintptr_t sample_uidx_base = 0;
-  uintptr_t cur_bits = dosage_present[0];
-  for (uint32_t dosage_idx = 0; dosage_idx != dosage_ct; ++dosage_idx) {
-    const uintptr_t sample_uidx = BitIter1(dosage_present, &sample_uidx_base, &cur_bits);
-    expanded_dosages[sample_uidx] = dosage_main[dosage_idx] * slope + intercept;
-  }
-}
-
-void PopulateRescaledDosageF(const uintptr_t* genoarr, const uintptr_t* dosage_present, const Dosage* dosage_main, float slope, float intercept, float missing_val, uint32_t sample_ct, uint32_t dosage_ct, float* expanded_dosages) {
-  float lookup_vals[32] ALIGNV16;
-  lookup_vals[0] = intercept;
-  lookup_vals[2] = intercept + slope;
-  lookup_vals[4] = intercept + 2 * slope;
-  lookup_vals[6] = missing_val;
-  InitLookup16x4bx2(lookup_vals);
-  GenoarrLookup16x4bx2(genoarr, lookup_vals, sample_ct, expanded_dosages);
-  if (!dosage_ct) {
-    return;
-  }
-  slope *= S_CAST(float, kRecipDosageMid);
-  uintptr_t sample_uidx_base = 0;
-  uintptr_t cur_bits = dosage_present[0];
-  for (uint32_t dosage_idx = 0; dosage_idx != dosage_ct; ++dosage_idx) {
-    const uintptr_t sample_uidx = BitIter1(dosage_present, &sample_uidx_base, &cur_bits);
-    expanded_dosages[sample_uidx] = dosage_main[dosage_idx] * slope + intercept;
-  }
-}
-
 static_assert(sizeof(AlleleCode) == 1, "AtLeastOneMultiallelicHet() needs to be updated.");
 uint32_t AtLeastOneMultiallelicHet(const PgenVariant* pgvp, uint32_t sample_ct) {
   if (pgvp->patch_01_ct) {
@@ -2970,9 +2930,14 @@ uintptr_t GetMhcWordCt(uintptr_t sample_ct) {
 PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uintptr_t bytes_avail, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uintptr_t per_variant_xalloc_byte_ct, uintptr_t per_alt_allele_xalloc_byte_ct, PgenFileInfo* pgfip, uint32_t* calc_thread_ct_ptr, uintptr_t*** genovecs_ptr, uintptr_t*** mhc_ptr, uintptr_t*** phasepresent_ptr, uintptr_t*** phaseinfo_ptr, uintptr_t*** dosage_present_ptr, Dosage*** dosage_mains_ptr, uintptr_t*** dphase_present_ptr, SDosage*** dphase_delta_ptr, uint32_t* read_block_size_ptr, uintptr_t* max_alt_allele_block_size_ptr, STD_ARRAY_REF(unsigned char*, 2) main_loadbufs, PgenReader*** pgr_pps, uint32_t** read_variant_uidx_starts_ptr) {
   uintptr_t cachelines_avail = bytes_avail / kCacheline;
   uint32_t read_block_size = kPglVblockSize;
-  uint64_t multiread_cacheline_ct;
+  // In mmap mode, the workers decode straight from the mapping, so no load
+  // buffers are needed.
+  const unsigned char* mmap_base = PgfiMmapBase(pgfip);
+  uint64_t multiread_cacheline_ct = 0;
   for (; ; read_block_size /= 2) {
-    multiread_cacheline_ct = PgfiMultireadGetCachelineReq(variant_include, pgfip, variant_ct, read_block_size);
+    if (!mmap_base) {
+      multiread_cacheline_ct = PgfiMultireadGetCachelineReq(variant_include, pgfip, variant_ct, read_block_size);
+    }
     // limit each raw load buffer to 1/4 of remaining workspace
     // if there's an additional per-variant allocation, put it in the same bin
     // as the load buffers
@@ -2996,8 +2961,16 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
     return kPglRetNomem;
   }
 #endif
-  main_loadbufs[0] = S_CAST(unsigned char*, bigstack_alloc_raw(multiread_cacheline_ct * kCacheline));
-  main_loadbufs[1] = S_CAST(unsigned char*, bigstack_alloc_raw(multiread_cacheline_ct * kCacheline));
+  if (mmap_base) {
+    // Callers only use main_loadbufs[] to reset pgfip->block_base, so it's
+    // safe to hand out the read-only mapping here.
+    main_loadbufs[0] = K_CAST(unsigned char*, mmap_base);
+    main_loadbufs[1] = main_loadbufs[0];
+    PgfiMmapAdviseSequential(pgfip);
+  } else {
+    main_loadbufs[0] = S_CAST(unsigned char*, bigstack_alloc_raw(multiread_cacheline_ct * kCacheline));
+    main_loadbufs[1] = S_CAST(unsigned char*, bigstack_alloc_raw(multiread_cacheline_ct * kCacheline));
+  }
   pgfip->block_base = main_loadbufs[0];
   *read_block_size_ptr = read_block_size;
   cachelines_avail -= 2 * (multiread_cacheline_ct + (S_CAST(uint64_t, per_variant_xalloc_byte_ct) * read_block_size) / kCacheline);
@@ -3107,10 +3080,9 @@ PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint
   return kPglRetSuccess;
 }
 
-uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp) {
-  if (IsLastBlock(tgp)) {
-    return 0;
-  }
+// Advances *read_block_idxp to the next read block containing at least one
+// variant_include bit, and returns the number of such variants.
+static uint32_t NextNonemptyReadBlock(const uintptr_t* variant_include, uint32_t raw_variant_ct, uint32_t read_block_size, uint32_t* read_block_idxp, uint32_t* cur_read_block_size_ptr) {
   // This condition ensures the PopcountWords() calls are valid.  If it's
   // ever inconvenient, PopcountBitRange() can be used instead.
   assert((!(read_block_size % kBitsPerVec)) || (raw_variant_ct <= read_block_size));
@@ -3133,10 +3105,477 @@ uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup*
     }
   }
   *read_block_idxp = read_block_idx;
+  *cur_read_block_size_ptr = cur_read_block_size;
+  return cur_block_write_ct;
+}
+
+uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp) {
+  if (IsLastBlock(tgp)) {
+    return 0;
+  }
+  uint32_t cur_read_block_size;
+  const uint32_t cur_block_write_ct = NextNonemptyReadBlock(variant_include, raw_variant_ct, read_block_size, read_block_idxp, &cur_read_block_size);
+  const uint32_t offset = (*read_block_idxp) * read_block_size;
   *reterrp = PgfiMultiread(variant_include, offset, offset + cur_read_block_size, cur_block_write_ct, pgfip);
   return cur_block_write_ct;
 }
 
+uint32_t g_pgen_prefetch_ct = 0;
+
+void PreinitPgenPrefetch(PgenPrefetch* pfp) {
+  pfp->slot_ct = 0;
+  pfp->thread_active = 0;
+#ifndef _WIN32
+  pfp->sync_init_state = 0;
+#endif
+}
+
+THREAD_FUNC_DECL PgenPrefetchThread(void* raw_arg) {
+  PgenPrefetch* pfp = S_CAST(PgenPrefetch*, raw_arg);
+  const uintptr_t* variant_include = pfp->variant_include;
+  const PgenFileInfo* pgfip = pfp->pgfip;
+  const uint32_t raw_variant_ct = pfp->raw_variant_ct;
+  const uint32_t variant_ct = pfp->variant_ct;
+  const uint32_t read_block_size = pfp->read_block_size;
+  const uint32_t slot_ct = pfp->slot_ct;
+#ifdef _WIN32
+  CRITICAL_SECTION* critical_sectionp = &pfp->critical_section;
+  HANDLE reader_progress_event = pfp->reader_progress_event;
+  HANDLE consumer_progress_event = pfp->consumer_progress_event;
+#else
+  pthread_mutex_t* sync_mutexp = &pfp->sync_mutex;
+  pthread_cond_t* reader_progress_condvarp = &pfp->reader_progress_condvar;
+  pthread_cond_t* consumer_progress_condvarp = &pfp->consumer_progress_condvar;
+#endif
+  uint32_t read_block_idx = 0;
+  uint32_t variant_idx = 0;
+  for (uint32_t load_idx = 0; variant_idx != variant_ct; ++load_idx, ++read_block_idx) {
+    // Wait for a free slot.
+    uint32_t interrupt;
+#ifdef _WIN32
+    EnterCriticalSection(critical_sectionp);
+    while (((load_idx - pfp->released_ct) == slot_ct) && (!pfp->interrupt)) {
+      LeaveCriticalSection(critical_sectionp);
+      WaitForSingleObject(consumer_progress_event, INFINITE);
+      EnterCriticalSection(critical_sectionp);
+    }
+    interrupt = pfp->interrupt;
+    LeaveCriticalSection(critical_sectionp);
+#else
+    pthread_mutex_lock(sync_mutexp);
+    while (((load_idx - pfp->released_ct) == slot_ct) && (!pfp->interrupt)) {
+      pthread_cond_wait(consumer_progress_condvarp, sync_mutexp);
+    }
+    interrupt = pfp->interrupt;
+    pthread_mutex_unlock(sync_mutexp);
+#endif
+    if (interrupt) {
+      break;
+    }
+    uint32_t cur_read_block_size;
+    const uint32_t cur_block_write_ct = NextNonemptyReadBlock(variant_include, raw_variant_ct, read_block_size, &read_block_idx, &cur_read_block_size);
+    const uint32_t slot_idx = load_idx % slot_ct;
+    const uint32_t offset = read_block_idx * read_block_size;
+    const PglErr reterr = PgfiMultireadTo(variant_include, offset, offset + cur_read_block_size, cur_block_write_ct, pgfip, pfp->loadbufs[slot_idx], &(pfp->block_offsets[slot_idx]));
+    pfp->read_block_idxs[slot_idx] = read_block_idx;
+    pfp->block_write_cts[slot_idx] = cur_block_write_ct;
+    variant_idx += cur_block_write_ct;
+#ifdef _WIN32
+    EnterCriticalSection(critical_sectionp);
+    if (unlikely(reterr)) {
+      pfp->reterr = reterr;
+    } else {
+      pfp->loaded_ct = load_idx + 1;
+    }
+    LeaveCriticalSection(critical_sectionp);
+    SetEvent(reader_progress_event);
+#else
+    pthread_mutex_lock(sync_mutexp);
+    if (unlikely(reterr)) {
+      pfp->reterr = reterr;
+    } else {
+      pfp->loaded_ct = load_idx + 1;
+    }
+    pthread_cond_signal(reader_progress_condvarp);
+    pthread_mutex_unlock(sync_mutexp);
+#endif
+    if (unlikely(reterr)) {
+      break;
+    }
+  }
+  THREAD_RETURN;
+}
+
+PglErr PgenPrefetchStart(const uintptr_t* variant_include, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t read_block_size, STD_ARRAY_KREF(unsigned char*, 2) main_loadbufs, const PgenFileInfo* pgfip, PgenPrefetch* pfp) {
+  assert(!pfp->thread_active);
+  pfp->slot_ct = 0;
+  // In mmap mode, PgfiMultiread()'s madvise(MADV_WILLNEED) hints already let
+  // the kernel read ahead, without any extra buffers.
+  if ((g_pgen_prefetch_ct < 3) || PgfiMmapBase(pgfip)) {
+    return kPglRetSuccess;
+  }
+  const uintptr_t loadbuf_size = PgfiMultireadGetCachelineReq(variant_include, pgfip, variant_ct, read_block_size) * kCacheline;
+  const uintptr_t slot_overhead = sizeof(intptr_t) + sizeof(int64_t) + 2 * sizeof(int32_t);
+  // Leave a bit of slack for the cacheline-rounding of the per-slot arrays.
+  const uintptr_t bytes_avail = bigstack_left();
+  const uintptr_t extra_slot_ct_max = (bytes_avail < 4 * kCacheline)? 0 : ((bytes_avail - 4 * kCacheline) / (loadbuf_size + slot_overhead + kCacheline));
+  if (!extra_slot_ct_max) {
+    logputs("Note: Insufficient workspace for --pgen-prefetch buffers; reading ahead\nis disabled for this pass.\n");
+    return kPglRetSuccess;
+  }
+  uint32_t slot_ct = g_pgen_prefetch_ct;
+  if (slot_ct - 2 > extra_slot_ct_max) {
+    slot_ct = extra_slot_ct_max + 2;
+  }
+  if (unlikely(bigstack_alloc_ucp(slot_ct, &pfp->loadbufs) ||
+               bigstack_alloc_u64(slot_ct, &pfp->block_offsets) ||
+               bigstack_alloc_u32(slot_ct, &pfp->read_block_idxs) ||
+               bigstack_alloc_u32(slot_ct, &pfp->block_write_cts))) {
+    return kPglRetNomem;
+  }
+  pfp->loadbufs[0] = main_loadbufs[0];
+  pfp->loadbufs[1] = main_loadbufs[1];
+  for (uint32_t slot_idx = 2; slot_idx != slot_ct; ++slot_idx) {
+    if (unlikely(bigstack_alloc_uc(loadbuf_size, &(pfp->loadbufs[slot_idx])))) {
+      return kPglRetNomem;
+    }
+  }
+  pfp->variant_include = variant_include;
+  pfp->pgfip = pgfip;
+  pfp->raw_variant_ct = raw_variant_ct;
+  pfp->variant_ct = variant_ct;
+  pfp->read_block_size = read_block_size;
+  pfp->consumed_ct = 0;
+  pfp->loaded_ct = 0;
+  pfp->released_ct = 0;
+  pfp->interrupt = 0;
+  pfp->reterr = kPglRetSuccess;
+#ifdef _WIN32
+  InitializeCriticalSection(&pfp->critical_section);
+  pfp->reader_progress_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+  if (unlikely(!pfp->reader_progress_event)) {
+    DeleteCriticalSection(&pfp->critical_section);
+    return kPglRetThreadCreateFail;
+  }
+  pfp->consumer_progress_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+  if (unlikely(!pfp->consumer_progress_event)) {
+    DeleteCriticalSection(&pfp->critical_section);
+    CloseHandle(pfp->reader_progress_event);
+    return kPglRetThreadCreateFail;
+  }
+  // slot_ct must be set before the thread is launched.
+  pfp->slot_ct = slot_ct;
+  pfp->read_thread = R_CAST(HANDLE, _beginthreadex(nullptr, kDefaultThreadStack, PgenPrefetchThread, pfp, 0, nullptr));
+  if (unlikely(!pfp->read_thread)) {
+    pfp->slot_ct = 0;
+    DeleteCriticalSection(&pfp->critical_section);
+    CloseHandle(pfp->consumer_progress_event);
+    CloseHandle(pfp->reader_progress_event);
+    return kPglRetThreadCreateFail;
+  }
+#else
+  if (unlikely(pthread_mutex_init(&pfp->sync_mutex, nullptr))) {
+    return kPglRetThreadCreateFail;
+  }
+  pfp->sync_init_state = 1;
+  if (unlikely(pthread_cond_init(&pfp->reader_progress_condvar, nullptr))) {
+    return kPglRetThreadCreateFail;
+  }
+  pfp->sync_init_state = 2;
+  if (unlikely(pthread_cond_init(&pfp->consumer_progress_condvar, nullptr))) {
+    return kPglRetThreadCreateFail;
+  }
+  pfp->sync_init_state = 3;
+  pfp->slot_ct = slot_ct;
+  if (unlikely(pthread_create(&pfp->read_thread, &g_thread_startup.smallstack_thread_attr, PgenPrefetchThread, pfp))) {
+    pfp->slot_ct = 0;
+    return kPglRetThreadCreateFail;
+  }
+#endif
+  pfp->thread_active = 1;
+  // log-only, since this is emitted once per pass
+  snprintf(g_logbuf, kLogbufSize, "--pgen-prefetch: Reading ahead with %u block buffers.\n", slot_ct);
+  logputs_silent(g_logbuf);
+  return kPglRetSuccess;
+}
+
+uint32_t MultireadNonemptyP(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenPrefetch* pfp, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp) {
+  if (!pfp->slot_ct) {
+    return MultireadNonempty(variant_include, tgp, raw_variant_ct, read_block_size, pgfip, read_block_idxp, reterrp);
+  }
+  if (IsLastBlock(tgp)) {
+    return 0;
+  }
+  const uint32_t consume_idx = pfp->consumed_ct;
+  PglErr reterr;
+  // Block (consume_idx - 1) is still being processed by the worker threads,
+  // but everything before it has been joined, so those slots can be reused.
+#ifdef _WIN32
+  EnterCriticalSection(&pfp->critical_section);
+  if (consume_idx > 1) {
+    pfp->released_ct = consume_idx - 1;
+    SetEvent(pfp->consumer_progress_event);
+  }
+  while ((pfp->loaded_ct <= consume_idx) && (!pfp->reterr)) {
+    LeaveCriticalSection(&pfp->critical_section);
+    WaitForSingleObject(pfp->reader_progress_event, INFINITE);
+    EnterCriticalSection(&pfp->critical_section);
+  }
+  reterr = pfp->reterr;
+  LeaveCriticalSection(&pfp->critical_section);
+#else
+  pthread_mutex_lock(&pfp->sync_mutex);
+  if (consume_idx > 1) {
+    pfp->released_ct = consume_idx - 1;
+    pthread_cond_signal(&pfp->consumer_progress_condvar);
+  }
+  while ((pfp->loaded_ct <= consume_idx) && (!pfp->reterr)) {
+    pthread_cond_wait(&pfp->reader_progress_condvar, &pfp->sync_mutex);
+  }
+  reterr = pfp->reterr;
+  pthread_mutex_unlock(&pfp->sync_mutex);
+#endif
+  if (unlikely(reterr)) {
+    *reterrp = reterr;
+    return 0;
+  }
+  const uint32_t slot_idx = consume_idx % pfp->slot_ct;
+  pfp->consumed_ct = consume_idx + 1;
+  pgfip->block_base = pfp->loadbufs[slot_idx];
+  pgfip->block_offset = pfp->block_offsets[slot_idx];
+  *read_block_idxp = pfp->read_block_idxs[slot_idx];
+  *reterrp = kPglRetSuccess;
+  return pfp->block_write_cts[slot_idx];
+}
+
+void CleanupPgenPrefetch(PgenPrefetch* pfp) {
+#ifdef _WIN32
+  if (pfp->thread_active) {
+    EnterCriticalSection(&pfp->critical_section);
+    pfp->interrupt = 1;
+    LeaveCriticalSection(&pfp->critical_section);
+    SetEvent(pfp->consumer_progress_event);
+    WaitForSingleObject(pfp->read_thread, INFINITE);
+    CloseHandle(pfp->read_thread);
+    DeleteCriticalSection(&pfp->critical_section);
+    CloseHandle(pfp->consumer_progress_event);
+    CloseHandle(pfp->reader_progress_event);
+    pfp->thread_active = 0;
+  }
+#else
+  if (pfp->thread_active) {
+    pthread_mutex_lock(&pfp->sync_mutex);
+    pfp->interrupt = 1;
+    pthread_cond_signal(&pfp->consumer_progress_condvar);
+    pthread_mutex_unlock(&pfp->sync_mutex);
+    pthread_join(pfp->read_thread, nullptr);
+    pfp->thread_active = 0;
+  }
+  const uint32_t sync_init_state = pfp->sync_init_state;
+  if (sync_init_state) {
+    pthread_mutex_destroy(&pfp->sync_mutex);
+    if (sync_init_state > 1) {
+      pthread_cond_destroy(&pfp->reader_progress_condvar);
+      if (sync_init_state > 2) {
+        pthread_cond_destroy(&pfp->consumer_progress_condvar);
+      }
+    }
+    pfp->sync_init_state = 0;
+  }
+#endif
+  pfp->slot_ct = 0;
+}
+
+typedef struct VerifyPgenCksumCtxStruct {
+  const PgenFileInfo* pgfip;
+  const uint32_t* vblock_crcs;
+  unsigned char** bufs;
+  uint32_t vblock_ct;
+
+  PglErr* reterrs;
+  int32_t* errnos;
+  uint32_t* bad_vblock_idxs;
+} VerifyPgenCksumCtx;
+
+THREAD_FUNC_DECL VerifyPgenCksumThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  VerifyPgenCksumCtx* ctx = S_CAST(VerifyPgenCksumCtx*, arg->sharedp->context);
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  // vblocks are dealt out round-robin, so the threads sweep the file
+  // together and the disk sees a few nearby sequential streams
+  unsigned char* buf = ctx->bufs? ctx->bufs[tidx] : nullptr;
+  const PglErr reterr = PgfiVerifyVblockCrcs(ctx->pgfip, ctx->vblock_crcs, tidx, ctx->vblock_ct, thread_ct, buf, &(ctx->bad_vblock_idxs[tidx]));
+  ctx->reterrs[tidx] = reterr;
+  if (reterr == kPglRetReadFail) {
+    ctx->errnos[tidx] = errno;
+  }
+  THREAD_RETURN;
+}
+
+// Another program may rewrite the .pgen without knowing about the sidecar,
+// and if the variant index happens to be unchanged, the sidecar can't tell.
+// The sidecar is always written after the .pgen is closed, so a later .pgen
+// modification time catches that case.
+static uint32_t PgenIsNewerThanCksum(const char* pgenname, const char* cksum_fname) {
+#ifdef _WIN32
+  return 0;
+#else
+  struct stat pgen_statbuf;
+  struct stat cksum_statbuf;
+  if (stat(pgenname, &pgen_statbuf) || stat(cksum_fname, &cksum_statbuf)) {
+    return 0;
+  }
+#  ifdef __APPLE__
+  const struct timespec pgen_mtime = pgen_statbuf.st_mtimespec;
+  const struct timespec cksum_mtime = cksum_statbuf.st_mtimespec;
+#  else
+  const struct timespec pgen_mtime = pgen_statbuf.st_mtim;
+  const struct timespec cksum_mtime = cksum_statbuf.st_mtim;
+#  endif
+  return (pgen_mtime.tv_sec > cksum_mtime.tv_sec) || ((pgen_mtime.tv_sec == cksum_mtime.tv_sec) && (pgen_mtime.tv_nsec > cksum_mtime.tv_nsec));
+#endif
+}
+
+PglErr VerifyPgenCksum(const char* pgenname, const PgenFileInfo* pgfip, uint32_t max_thread_ct, uint32_t require_cksum) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  char cksum_fname[kPglFnamesize];
+  {
+    const uint32_t pgenname_slen = strlen(pgenname);
+    if (unlikely(pgenname_slen + 7 > kPglFnamesize)) {
+      logerrputs("Error: .pgen filename too long for .cksum sidecar.\n");
+      goto VerifyPgenCksum_ret_INCONSISTENT_INPUT;
+    }
+    snprintf(memcpya(cksum_fname, pgenname, pgenname_slen), 7, ".cksum");
+    if (!pgfip->var_fpos) {
+      if (unlikely(require_cksum)) {
+        logerrputs("Error: --pgen-verify requires a variable-width .pgen file.\n");
+        goto VerifyPgenCksum_ret_INCONSISTENT_INPUT;
+      }
+      goto VerifyPgenCksum_ret_1;
+    }
+    const uint32_t vblock_ct = DivUp(pgfip->raw_variant_ct, kPglVblockSize);
+    uint32_t* vblock_crcs;
+    if (unlikely(bigstack_alloc_u32(vblock_ct, &vblock_crcs))) {
+      goto VerifyPgenCksum_ret_NOMEM;
+    }
+    // also used by the first verification thread
+    unsigned char* read_buf = nullptr;
+    if (!PgfiMmapBase(pgfip)) {
+      if (unlikely(bigstack_alloc_uc(kPglCksumReadBlen, &read_buf))) {
+        goto VerifyPgenCksum_ret_NOMEM;
+      }
+    }
+    reterr = PgfiLoadVblockCrcs(cksum_fname, pgfip, read_buf, vblock_crcs, g_logbuf);
+    if ((!reterr) && PgenIsNewerThanCksum(pgenname, cksum_fname)) {
+      snprintf(g_logbuf, kLogbufSize, "Error: %s is older than %s (stale checksums?).\n", cksum_fname, pgenname);
+      reterr = kPglRetInconsistentInput;
+    }
+    if (reterr) {
+      if (!require_cksum) {
+        if (reterr == kPglRetOpenFail) {
+          reterr = kPglRetSuccess;
+          goto VerifyPgenCksum_ret_1;
+        }
+        if (reterr == kPglRetInconsistentInput) {
+          // Sidecar left over from an earlier version of the .pgen, which was
+          // since rewritten without 'cksum'.
+          logerrprintfww("Warning: Ignoring stale %s (it doesn't match the .pgen file).\n", cksum_fname);
+          reterr = kPglRetSuccess;
+          goto VerifyPgenCksum_ret_1;
+        }
+      }
+      WordWrapB(0);
+      logerrputsb();
+      goto VerifyPgenCksum_ret_1;
+    }
+    uint32_t thread_ct = MINV(max_thread_ct, vblock_ct);
+    VerifyPgenCksumCtx ctx;
+    ctx.bufs = nullptr;
+    if (read_buf) {
+#ifdef _WIN32
+      // PgfiVerifyVblockCrcs() falls back on fseeko() + fread() here
+      thread_ct = 1;
+#endif
+      const uintptr_t per_thread_byte_ct = kPglCksumReadBlen + sizeof(intptr_t) + 3 * kCacheline;
+      const uint32_t thread_ct_limit = 1 + bigstack_left() / per_thread_byte_ct;
+      if (thread_ct > thread_ct_limit) {
+        thread_ct = thread_ct_limit;
+      }
+      if (unlikely(bigstack_alloc_ucp(thread_ct, &ctx.bufs))) {
+        goto VerifyPgenCksum_ret_NOMEM;
+      }
+      ctx.bufs[0] = read_buf;
+      for (uint32_t tidx = 1; tidx < thread_ct; ++tidx) {
+        if (unlikely(bigstack_alloc_uc(kPglCksumReadBlen, &(ctx.bufs[tidx])))) {
+          goto VerifyPgenCksum_ret_NOMEM;
+        }
+      }
+    }
+    if (unlikely(bigstack_alloc_u32(thread_ct, &ctx.bad_vblock_idxs) ||
+                 bigstack_alloc_i32(thread_ct, &ctx.errnos) ||
+                 BIGSTACK_ALLOC_X(PglErr, thread_ct, &ctx.reterrs))) {
+      goto VerifyPgenCksum_ret_NOMEM;
+    }
+    if (unlikely(SetThreadCt(thread_ct, &tg))) {
+      goto VerifyPgenCksum_ret_NOMEM;
+    }
+    ctx.pgfip = pgfip;
+    ctx.vblock_crcs = vblock_crcs;
+    ctx.vblock_ct = vblock_ct;
+    logprintfww5("Verifying %s checksums (%u thread%s)... ", pgenname, thread_ct, (thread_ct == 1)? "" : "s");
+    fflush(stdout);
+    SetThreadFuncAndData(VerifyPgenCksumThread, &ctx, &tg);
+    DeclareLastThreadBlock(&tg);
+    if (unlikely(SpawnThreads(&tg))) {
+      goto VerifyPgenCksum_ret_THREAD_CREATE_FAIL;
+    }
+    JoinThreads(&tg);
+    uint32_t bad_vblock_idx = UINT32_MAX;
+    for (uint32_t tidx = 0; tidx != thread_ct; ++tidx) {
+      const PglErr cur_reterr = ctx.reterrs[tidx];
+      if (cur_reterr == kPglRetReadFail) {
+        logputs("\n");
+        logerrprintfww(kErrprintfFread, pgenname, strerror(ctx.errnos[tidx]));
+        reterr = kPglRetReadFail;
+        goto VerifyPgenCksum_ret_1;
+      }
+      if (cur_reterr && (ctx.bad_vblock_idxs[tidx] < bad_vblock_idx)) {
+        bad_vblock_idx = ctx.bad_vblock_idxs[tidx];
+      }
+    }
+    if (unlikely(bad_vblock_idx != UINT32_MAX)) {
+      const uint32_t first_vidx = bad_vblock_idx * kPglVblockSize;
+      const uint32_t last_vidx = MINV(first_vidx + kPglVblockSize, pgfip->raw_variant_ct);
+      logputs("\n");
+      logerrprintfww("Error: Checksum mismatch in %s, at variants %u..%u (1-based); the file has been corrupted since it was written.\n", pgenname, first_vidx + 1, last_vidx);
+      goto VerifyPgenCksum_ret_MALFORMED_INPUT;
+    }
+    logprintf("done (%u block%s verified).\n", vblock_ct, (vblock_ct == 1)? "" : "s");
+  }
+  while (0) {
+  VerifyPgenCksum_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  VerifyPgenCksum_ret_MALFORMED_INPUT:
+    reterr = kPglRetMalformedInput;
+    break;
+  VerifyPgenCksum_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  VerifyPgenCksum_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  }
+ VerifyPgenCksum_ret_1:
+  CleanupThreads(&tg);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
 void ExpandMhc(uint32_t sample_ct, uintptr_t* mhc, uintptr_t** patch_01_set_ptr, AlleleCode** patch_01_vals_ptr, uintptr_t** patch_10_set_ptr, AlleleCode** patch_10_vals_ptr) {
   const uint32_t sample_ctl = BitCtToWordCt(sample_ct);
   *patch_01_set_ptr = mhc;
@@ -137,7 +137,11 @@ FLAGSET64_DEF_START()
   kfMiscIidSid = (1LLU << 39),
   kfMiscPhenoIidOnly = (1LLU << 40),
   kfMiscCovarIidOnly = (1LLU << 41),
-  kfMiscAllowBadLd = (1LLU << 42)
+  kfMiscAllowBadLd = (1LLU << 42),
+  kfMiscPvarCache = (1LLU << 43),
+  kfMiscPvarCacheFullHash = (1LLU << 44),
+  kfMiscPgenMmap = (1LLU << 45),
+  kfMiscPgenVerify = (1LLU << 46)
 FLAGSET64_DEF_END(MiscFlags);
 
 FLAGSET64_DEF_START()
@@ -383,10 +387,6 @@ HEADER_INLINE void SetAllDosageArr(uintptr_t entry_ct, Dosage* dosage_arr) {
 // Assumes dense_dosage is allocated up to vector boundary.
 void PopulateDenseDosage(const uintptr_t* genoarr, const uintptr_t* dosage_present, const Dosage* dosage_main, uint32_t sample_ct, uint32_t dosage_ct, Dosage* dense_dosage);
 
-void PopulateRescaledDosage(const uintptr_t* genoarr, const uintptr_t* dosage_present, const Dosage* dosage_main, double slope, double intercept, double missing_val, uint32_t sample_ct, uint32_t dosage_ct, double* expanded_dosages);
-
-void PopulateRescaledDosageF(const uintptr_t* genoarr, const uintptr_t* dosage_present, const Dosage* dosage_main, float slope, float intercept, float missing_val, uint32_t sample_ct, uint32_t dosage_ct, float* expanded_dosages);
-
 // assumes trailing bits of genoarr are zeroed out
 HEADER_INLINE uint32_t AtLeastOneHetUnsafe(const uintptr_t* genoarr, uint32_t sample_ct) {
   const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
@@ -1059,12 +1059,96 @@ uintptr_t GetMhcWordCt(uintptr_t sample_ct);
 
 // sample_ct not relevant if genovecs_ptr == nullptr
 // only possible error is kPglRetNomem for now
+// If pgfip is in mmap mode, no load buffers are allocated; both
+// main_loadbufs[] entries point to the (read-only) mapping instead.
 PglErr PgenMtLoadInit(const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uintptr_t bytes_avail, uintptr_t pgr_alloc_cacheline_ct, uintptr_t thread_xalloc_cacheline_ct, uintptr_t per_variant_xalloc_byte_ct, uintptr_t per_alt_allele_xalloc_byte_ct, PgenFileInfo* pgfip, uint32_t* calc_thread_ct_ptr, uintptr_t*** genovecs_ptr, uintptr_t*** mhc_ptr, uintptr_t*** phasepresent_ptr, uintptr_t*** phaseinfo_ptr, uintptr_t*** dosage_present_ptr, Dosage*** dosage_mains_ptr, uintptr_t*** dphase_present_ptr, SDosage*** dphase_delta_ptr, uint32_t* read_block_size_ptr, uintptr_t* max_alt_allele_block_size_ptr, STD_ARRAY_REF(unsigned char*, 2) main_loadbufs, PgenReader*** pgr_pps, uint32_t** read_variant_uidx_starts_ptr);
 
 // Returns number of variants in current block.  Increases read_block_idx as
 // necessary (to get to a nonempty block).
 uint32_t MultireadNonempty(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp);
 
+// Number of read blocks to keep in flight when --pgen-prefetch is specified;
+// zero = disabled.
+extern uint32_t g_pgen_prefetch_ct;
+
+// Asynchronous read-ahead for the PgenMtLoadInit() + MultireadNonempty()
+// pipeline.  Normally, the main thread loads block k+1 with PgfiMultiread()
+// while the worker threads process block k, so any read taking longer than
+// a block's worth of computation stalls everything.  With a PgenPrefetch
+// active, a dedicated I/O thread instead keeps up to (slot_ct - 2) blocks
+// ahead of the workers, loading them (with pread() where available) into a
+// ring of buffers; MultireadNonemptyP() then just points pgfip->block_base
+// at the next completed buffer, so no copying is involved.
+//
+// Slot buffers [0] and [1] are the main_loadbufs returned by
+// PgenMtLoadInit(); any others are allocated from bigstack by
+// PgenPrefetchStart(), so it should be called after all other allocations
+// for the pass.  The usual variant_include/read_block_size invariants of
+// MultireadNonempty() apply, and the caller must not call PgfiMultiread()
+// itself while the prefetch thread is active.
+typedef struct PgenPrefetchStruct {
+  NONCOPYABLE(PgenPrefetchStruct);
+  // Immutable while the I/O thread is running.
+  const uintptr_t* variant_include;
+  const PgenFileInfo* pgfip;
+  unsigned char** loadbufs;
+  uint64_t* block_offsets;
+  uint32_t* read_block_idxs;
+  uint32_t* block_write_cts;
+  uint32_t raw_variant_ct;
+  uint32_t variant_ct;
+  uint32_t read_block_size;
+  uint32_t slot_ct;  // zero if prefetching is not active
+
+  // Only touched by the consumer.
+  uint32_t consumed_ct;
+
+  // Guarded by the mutex.
+#ifdef _WIN32
+  CRITICAL_SECTION critical_section;
+  HANDLE reader_progress_event;
+  HANDLE consumer_progress_event;
+#else
+  pthread_mutex_t sync_mutex;
+  pthread_cond_t reader_progress_condvar;
+  pthread_cond_t consumer_progress_condvar;
+  uint32_t sync_init_state;
+#endif
+  uint32_t loaded_ct;
+  uint32_t released_ct;
+  uint32_t interrupt;
+  PglErr reterr;
+
+  pthread_t read_thread;
+  uint32_t thread_active;
+} PgenPrefetch;
+
+void PreinitPgenPrefetch(PgenPrefetch* pfp);
+
+// No-op (leaving pfp->slot_ct == 0) when g_pgen_prefetch_ct is zero, pgfip is
+// in mmap mode, or there isn't enough workspace left for a third buffer (the
+// last case is noted in the log).  Slot buffers are not freed by
+// CleanupPgenPrefetch(); callers making multiple passes should reset bigstack
+// between them.
+PglErr PgenPrefetchStart(const uintptr_t* variant_include, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t read_block_size, STD_ARRAY_KREF(unsigned char*, 2) main_loadbufs, const PgenFileInfo* pgfip, PgenPrefetch* pfp);
+
+// Drop-in replacement for MultireadNonempty(); falls back to it when pfp is
+// inactive.  Block k-1 must not be released until its worker threads have
+// been joined, so this assumes the standard loop structure where the next
+// read is requested before the previous block is joined.
+uint32_t MultireadNonemptyP(const uintptr_t* variant_include, const ThreadGroup* tgp, uint32_t raw_variant_ct, uint32_t read_block_size, PgenPrefetch* pfp, PgenFileInfo* pgfip, uint32_t* read_block_idxp, PglErr* reterrp);
+
+// Stops and joins the I/O thread.  Must be called before the slot buffers
+// are released with BigstackReset().
+void CleanupPgenPrefetch(PgenPrefetch* pfp);
+
+// Checks the main .pgen against its .cksum sidecar (see pgenlib_misc.h), with
+// the vblocks split across up to max_thread_ct reader threads.  pgfip must be
+// fully initialized, with shared_ff open unless in mmap mode.  If
+// require_cksum is false, a missing sidecar (or a fixed-width .pgen) is
+// silently skipped, and a stale one is skipped with a warning.
+PglErr VerifyPgenCksum(const char* pgenname, const PgenFileInfo* pgfip, uint32_t max_thread_ct, uint32_t require_cksum);
+
 // Assumes mhc != nullptr, and is vector-aligned.
 void ExpandMhc(uint32_t sample_ct, uintptr_t* mhc, uintptr_t** patch_01_set_ptr, AlleleCode** patch_01_vals_ptr, uintptr_t** patch_10_set_ptr, AlleleCode** patch_10_vals_ptr);
 
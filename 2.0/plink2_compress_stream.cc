@@ -172,6 +172,29 @@ BoolErr CsputsStd(const char* readp, uint32_t byte_ct, CompressStreamState* css_
   return Cswrite(css_ptr, writep_ptr);
 }
 
+BoolErr CswriteEndFrame(CompressStreamState* css_ptr, char** writep_ptr) {
+  if (IsUncompressedCstream(css_ptr)) {
+    return ForceUncompressedCswrite(css_ptr, writep_ptr);
+  }
+  char* overflow_buf = css_ptr->overflow_buf;
+  ZSTD_inBuffer input = {overflow_buf, S_CAST(uintptr_t, (*writep_ptr) - overflow_buf), 0};
+  while (1) {
+    __maybe_unused size_t retval = ZSTD_compressStream2(css_ptr->cctx, &css_ptr->output, &input, ZSTD_e_end);
+    assert(!ZSTD_isError(retval));
+    if (css_ptr->output.pos) {
+      if (unlikely(!fwrite_unlocked(css_ptr->output.dst, css_ptr->output.pos, 1, css_ptr->outfile))) {
+        return 1;
+      }
+      css_ptr->output.pos = 0;
+    }
+    if (!retval) {
+      break;
+    }
+  }
+  *writep_ptr = overflow_buf;
+  return 0;
+}
+
 BoolErr UncompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep) {
   ForceUncompressedCswrite(css_ptr, &writep);
   css_ptr->overflow_buf = nullptr;
@@ -89,6 +89,11 @@ HEADER_INLINE BoolErr Cswrite(CompressStreamState* css_ptr, char** writep_ptr) {
 // assumes overflow_buf has size >= 2 * kCompressStreamBlock.
 BoolErr CsputsStd(const char* readp, uint32_t byte_ct, CompressStreamState* css_ptr, char** writep_ptr);
 
+// Ends the current Zstd frame and flushes everything to the output file, so
+// ftello() afterward returns an offset a decoder can start from.  (Just
+// flushes in the uncompressed case.)
+BoolErr CswriteEndFrame(CompressStreamState* css_ptr, char** writep_ptr);
+
 BoolErr UncompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep);
 
 BoolErr CompressedCswriteCloseNull(CompressStreamState* css_ptr, char* writep);
@@ -174,7 +174,12 @@ void PvarInfoWrite(uint32_t info_pr_flag_present, uint32_t is_pr, char* info_tok
   uint32_t info_token_slen = info_token_end - info_token;
   char* info_token_pr = nullptr;
   if (info_pr_flag_present) {
+    // InfoPrStart() may null-terminate the token, clobbering the line's '\n'
+    // when INFO is the last column; restore it so the next reload still finds
+    // the line boundary.
+    const char info_token_end_char = *info_token_end;
     info_token_pr = InfoPrStart(info_token_slen, info_token);
+    *info_token_end = info_token_end_char;
   }
   char* write_iter = *write_iter_ptr;
   if (is_pr || (!info_token_pr))  {
@@ -5846,19 +5851,11 @@ THREAD_FUNC_DECL MakePgenThread(void* raw_arg) {
       }
       ZeroTrailingNyps(sample_ct, write_genovec);
       // todo: --set-me-missing, --zero-cluster, --fill-missing-with-ref
-      if (spgwp) {
-        if (pwcp->fwrite_bufp >= &(pwcp->fwrite_buf[kPglFwriteBlockSize])) {
-          const uintptr_t cur_byte_ct = pwcp->fwrite_bufp - pwcp->fwrite_buf;
-          if (unlikely(fwrite_checked(pwcp->fwrite_buf, cur_byte_ct, GET_PRIVATE(*spgwp, pgen_outfile)))) {
-            ctx->write_reterr = kPglRetWriteFail;
-            ctx->write_errno = errno;
-            break;
-          }
-          // printf("vblock_fpos_offset: %llu\n", pwcp->vblock_fpos_offset);
-          pwcp->vblock_fpos_offset += cur_byte_ct;
-          // printf("%u %llu\n", write_idx + variant_idx_offset, pwcp->vblock_fpos_offset);
-          pwcp->fwrite_bufp = pwcp->fwrite_buf;
-        }
+      // SpgwFlush() also keeps the running vblock checksum up to date.
+      if (spgwp && unlikely(SpgwFlush(spgwp))) {
+        ctx->write_reterr = kPglRetWriteFail;
+        ctx->write_errno = errno;
+        break;
       }
       if ((!write_rare01_ct) && (!write_rare10_ct)) {
         if ((!is_hphase) && (!write_dphase_ct)) {
@@ -6827,7 +6824,21 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
           }
         }
       }
-      SpgwFinish(ctx.spgwp);
+      reterr = SpgwFinish(ctx.spgwp);
+      if (unlikely(reterr)) {
+        goto MakePgenRobust_ret_1;
+      }
+      if (make_plink2_flags & kfMakePgenCksum) {
+        snprintf(&(outname_end[5]), kMaxOutfnameExtBlen - 5, ".cksum");
+        reterr = SpgwWriteCksum(outname, ctx.spgwp);
+        if (unlikely(reterr)) {
+          goto MakePgenRobust_ret_CKSUM_FAIL;
+        }
+      } else {
+        // don't let a sidecar from an earlier version of this file linger
+        snprintf(&(outname_end[5]), kMaxOutfnameExtBlen - 5, ".cksum");
+        remove(outname);
+      }
       if (pct > 10) {
         putc_unlocked('\b', stdout);
       }
@@ -6839,6 +6850,12 @@ PglErr MakePgenRobust(const uintptr_t* sample_include, const uint32_t* new_sampl
   MakePgenRobust_ret_NOMEM:
     reterr = kPglRetNomem;
     break;
+  MakePgenRobust_ret_CKSUM_FAIL:
+    if (reterr == kPglRetOpenFail) {
+      logputs("\n");
+      logerrprintfww(kErrprintfFopen, outname, strerror(errno));
+    }
+    break;
   MakePgenRobust_ret_PGR_FAIL:
     PgenErrPrintN(reterr);
     break;
@@ -7475,6 +7492,23 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
             goto MakePlink2NoVsort_ret_WRITE_FAIL;
           }
           if (write_idx_end == variant_ct) {
+            if (make_plink2_flags & kfMakePgenCksum) {
+              snprintf(&(outname_end[5]), kMaxOutfnameExtBlen - 5, ".cksum");
+              reterr = MpgwWriteCksum(outname, mpgwp);
+              if (unlikely(reterr)) {
+                mpgwp = nullptr;
+                if (reterr == kPglRetOpenFail) {
+                  logputs("\n");
+                  logerrprintfww(kErrprintfFopen, outname, strerror(errno));
+                }
+                goto MakePlink2NoVsort_ret_1;
+              }
+            } else {
+              // don't let a sidecar from an earlier version of this file
+              // linger
+              snprintf(&(outname_end[5]), kMaxOutfnameExtBlen - 5, ".cksum");
+              remove(outname);
+            }
             mpgwp = nullptr;
             break;
           }
@@ -8515,6 +8549,520 @@ PglErr SampleSortFileMap(const uintptr_t* sample_include, const SampleIdInfo* si
   return reterr;
 }
 
+PglErr WritePgenSmaj(char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  FILE* outfile = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  PgenFileInfo pgfi;
+  PgenReader pgr;
+  PreinitPgfi(&pgfi);
+  PreinitPgr(&pgr);
+  {
+    // Reopen the just-written .pgen instead of threading the transposition
+    // through the MakePlink2 writer loops; this works identically for every
+    // sort/split mode, and the reread is cheap relative to the original pass.
+    snprintf(outname_end, kMaxOutfnameExtBlen, ".pgen");
+    PgenHeaderCtrl header_ctrl;
+    uintptr_t cur_alloc_cacheline_ct;
+    reterr = PgfiInitPhase1(outname, UINT32_MAX, UINT32_MAX, 0, &header_ctrl, &pgfi, &cur_alloc_cacheline_ct, g_logbuf);
+    if (unlikely(reterr)) {
+      WordWrapB(0);
+      logerrputsb();
+      goto WritePgenSmaj_ret_1;
+    }
+    const uint32_t variant_ct = pgfi.raw_variant_ct;
+    const uint32_t sample_ct = pgfi.raw_sample_ct;
+    // The chunk size computation below divides by sample_ct.
+    if (unlikely((!sample_ct) || (!variant_ct))) {
+      logerrprintfww("Error: Cannot write %s.smaj: no %s.\n", outname, sample_ct? "variants" : "samples");
+      goto WritePgenSmaj_ret_DEGENERATE_DATA;
+    }
+    unsigned char* pgfi_alloc;
+    if (unlikely(bigstack_alloc_uc(cur_alloc_cacheline_ct * kCacheline, &pgfi_alloc))) {
+      goto WritePgenSmaj_ret_NOMEM;
+    }
+    if (header_ctrl & 0x30) {
+      if (unlikely(bigstack_alloc_w(variant_ct + 1, &pgfi.allele_idx_offsets))) {
+        goto WritePgenSmaj_ret_NOMEM;
+      }
+    }
+    if ((header_ctrl & 0xc0) == 0xc0) {
+      if (unlikely(bigstack_alloc_w(BitCtToWordCt(variant_ct), &pgfi.nonref_flags))) {
+        goto WritePgenSmaj_ret_NOMEM;
+      }
+    }
+    uintptr_t pgr_alloc_cacheline_ct;
+    uint32_t max_vrec_width;
+    reterr = PgfiInitPhase2(header_ctrl, 0, 0, 0, 0, variant_ct, &max_vrec_width, &pgfi, pgfi_alloc, &pgr_alloc_cacheline_ct, g_logbuf);
+    if (unlikely(reterr)) {
+      WordWrapB(0);
+      logerrputsb();
+      goto WritePgenSmaj_ret_1;
+    }
+    unsigned char* pgr_alloc;
+    if (unlikely(bigstack_alloc_uc((pgr_alloc_cacheline_ct + DivUp(max_vrec_width, kCacheline)) * kCacheline, &pgr_alloc))) {
+      goto WritePgenSmaj_ret_NOMEM;
+    }
+    reterr = PgrInit(outname, max_vrec_width, &pgfi, &pgr, pgr_alloc);
+    if (unlikely(reterr)) {
+      if (reterr == kPglRetOpenFail) {
+        logerrprintfww(kErrprintfFopen, outname, strerror(errno));
+      } else {
+        assert(reterr == kPglRetReadFail);
+        logerrprintfww(kErrprintfFread, outname, rstrerror(errno));
+      }
+      goto WritePgenSmaj_ret_1;
+    }
+    PgrSampleSubsetIndex null_pssi;
+    PgrClearSampleSubsetIndex(&pgr, &null_pssi);
+    const uintptr_t sample_ctaw2 = NypCtToAlignedWordCt(sample_ct);
+    const uint32_t sample_batch_ct = DivUp(sample_ct, kPglNypTransposeBatch);
+    uintptr_t* vmaj_buf;
+    uintptr_t* smaj_batch_buf;
+    VecW* transpose_buf;
+    if (unlikely(bigstack_alloc_w(sample_ctaw2 * kPglNypTransposeBatch, &vmaj_buf) ||
+                 bigstack_alloc_w(kPglNypTransposeBatch * kPglNypTransposeWords, &smaj_batch_buf) ||
+                 bigstack_alloc_v(kPglNypTransposeBufbytes / kBytesPerVec, &transpose_buf))) {
+      goto WritePgenSmaj_ret_NOMEM;
+    }
+    // Largest chunk which fits in the remaining workspace, capped at 2^16
+    // variants so that single-sample range queries never need to skip over
+    // huge blocks.
+    uintptr_t chunk_variant_ct = (bigstack_left() / sample_ct) * 4;
+    if (chunk_variant_ct > 65536) {
+      chunk_variant_ct = 65536;
+    }
+    const uint32_t variant_ct_round = RoundUpPow2(variant_ct, kPglNypTransposeBatch);
+    if (chunk_variant_ct > variant_ct_round) {
+      chunk_variant_ct = variant_ct_round;
+    }
+    chunk_variant_ct = RoundDownPow2(chunk_variant_ct, kPglNypTransposeBatch);
+    if (unlikely(!chunk_variant_ct)) {
+      goto WritePgenSmaj_ret_NOMEM;
+    }
+    const uintptr_t full_row_blen = chunk_variant_ct / 4;
+    unsigned char* chunk_buf;
+    if (unlikely(bigstack_alloc_uc(full_row_blen * sample_ct, &chunk_buf))) {
+      goto WritePgenSmaj_ret_NOMEM;
+    }
+    snprintf(&(outname_end[5]), kMaxOutfnameExtBlen - 5, ".smaj");
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
+      goto WritePgenSmaj_ret_OPEN_FAIL;
+    }
+    unsigned char header[kPglSmajHeaderBlen];
+    header[0] = 0x6c;
+    header[1] = 0x1b;
+    header[2] = 0x30;
+    header[3] = 0;
+    const uint32_t chunk_variant_ct_u32 = chunk_variant_ct;
+    memcpy(&(header[4]), &variant_ct, sizeof(int32_t));
+    memcpy(&(header[8]), &sample_ct, sizeof(int32_t));
+    memcpy(&(header[12]), &chunk_variant_ct_u32, sizeof(int32_t));
+    if (unlikely(fwrite_checked(header, kPglSmajHeaderBlen, outfile))) {
+      goto WritePgenSmaj_ret_WRITE_FAIL;
+    }
+    logprintfww5("Writing %s ... ", outname);
+    fputs("0%", stdout);
+    fflush(stdout);
+    uint32_t pct = 0;
+    uint32_t next_print_variant_idx = variant_ct / 100;
+    for (uint32_t chunk_vidx_start = 0; chunk_vidx_start < variant_ct; chunk_vidx_start += chunk_variant_ct) {
+      uint32_t chunk_vidx_end = chunk_vidx_start + chunk_variant_ct;
+      if (chunk_vidx_end > variant_ct) {
+        chunk_vidx_end = variant_ct;
+      }
+      const uintptr_t row_blen = DivUp(chunk_vidx_end - chunk_vidx_start, 4);
+      for (uint32_t batch_vidx_start = chunk_vidx_start; batch_vidx_start < chunk_vidx_end; batch_vidx_start += kPglNypTransposeBatch) {
+        const uint32_t variant_batch_size = MINV(chunk_vidx_end - batch_vidx_start, kPglNypTransposeBatch);
+        uintptr_t* vmaj_iter = vmaj_buf;
+        for (uint32_t uii = 0; uii != variant_batch_size; ++uii) {
+          reterr = PgrGet(nullptr, null_pssi, sample_ct, batch_vidx_start + uii, &pgr, vmaj_iter);
+          if (unlikely(reterr)) {
+            goto WritePgenSmaj_ret_PGR_FAIL;
+          }
+          vmaj_iter = &(vmaj_iter[sample_ctaw2]);
+        }
+        const uint32_t batch_blen = DivUp(variant_batch_size, 4);
+        unsigned char* write_iter = &(chunk_buf[(batch_vidx_start - chunk_vidx_start) / 4]);
+        uint32_t sample_batch_size = kPglNypTransposeBatch;
+        for (uint32_t sample_batch_idx = 0; sample_batch_idx != sample_batch_ct; ++sample_batch_idx) {
+          if (sample_batch_idx == sample_batch_ct - 1) {
+            sample_batch_size = ModNz(sample_ct, kPglNypTransposeBatch);
+          }
+          TransposeNypblock(&(vmaj_buf[sample_batch_idx * kPglNypTransposeWords]), sample_ctaw2, kPglNypTransposeWords, variant_batch_size, sample_batch_size, smaj_batch_buf, transpose_buf);
+          uintptr_t* smaj_iter = smaj_batch_buf;
+          for (uint32_t uii = 0; uii != sample_batch_size; ++uii) {
+            // TransposeNypblock() doesn't zero trailing bits
+            ZeroTrailingNyps(variant_batch_size, smaj_iter);
+            memcpy(write_iter, smaj_iter, batch_blen);
+            write_iter = &(write_iter[row_blen]);
+            smaj_iter = &(smaj_iter[kPglNypTransposeWords]);
+          }
+        }
+      }
+      if (unlikely(fwrite_checked(chunk_buf, row_blen * sample_ct, outfile))) {
+        goto WritePgenSmaj_ret_WRITE_FAIL;
+      }
+      if (chunk_vidx_end >= next_print_variant_idx) {
+        if (pct > 10) {
+          putc_unlocked('\b', stdout);
+        }
+        pct = (chunk_vidx_end * 100LLU) / variant_ct;
+        printf("\b\b%u%%", pct++);
+        fflush(stdout);
+        next_print_variant_idx = (pct * S_CAST(uint64_t, variant_ct)) / 100;
+      }
+    }
+    if (unlikely(fclose_null(&outfile))) {
+      goto WritePgenSmaj_ret_WRITE_FAIL;
+    }
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\b", stdout);
+    logputs("done.\n");
+  }
+  while (0) {
+  WritePgenSmaj_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  WritePgenSmaj_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  WritePgenSmaj_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  WritePgenSmaj_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  WritePgenSmaj_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+ WritePgenSmaj_ret_1:
+  fclose_cond(outfile);
+  CleanupPgr2(".pgen file", &pgr, &reterr);
+  CleanupPgfi2(".pgen file", &pgfi, &reterr);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+typedef struct PvarVidxWframeStruct {
+  PvarVidxFrame frame;
+  // non-null iff this is the first frame of its chromosome
+  const char* chr_name;
+} PvarVidxWframe;
+
+PglErr WritePvarVidx(uint32_t max_thread_ct, char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  FILE* vidx_file = nullptr;
+  char* tmp_fname = nullptr;
+  char* cswritep = nullptr;
+  uint32_t vidx_created = 0;
+  CompressStreamState css;
+  uintptr_t line_idx = 0;
+  uint32_t index_skipped = 0;
+  PglErr reterr = kPglRetSuccess;
+  TextStream txs;
+  PreinitCstream(&css);
+  PreinitTextStream(&txs);
+  {
+    // Post-pass over the just-written .pvar.zst, like WritePgenSmaj(): this
+    // keeps the frame bookkeeping out of the many .pvar writer loops.
+    const uintptr_t outname_base_slen = outname_end - outname;
+    char* pvar_fname;
+    if (unlikely(bigstack_alloc_c(outname_base_slen + 10, &pvar_fname) ||
+                 bigstack_alloc_c(outname_base_slen + 14, &tmp_fname))) {
+      goto WritePvarVidx_ret_NOMEM;
+    }
+    char* fname_end = memcpya(pvar_fname, outname, outname_base_slen);
+    strcpy_k(fname_end, ".pvar.zst");
+    fname_end = memcpya(tmp_fname, pvar_fname, outname_base_slen + 9);
+    strcpy_k(fname_end, ".tmp");
+    snprintf(outname_end, kMaxOutfnameExtBlen, ".pvar.zst.vidx");
+    reterr = InitCstreamAlloc(tmp_fname, 0, 1, max_thread_ct, 2 * kCompressStreamBlock, &css, &cswritep);
+    if (unlikely(reterr)) {
+      goto WritePvarVidx_ret_1;
+    }
+    reterr = SizeAndInitTextStream(pvar_fname, bigstack_left() / 2, 1, &txs);
+    if (unlikely(reterr)) {
+      goto WritePvarVidx_ret_TSTREAM_FAIL;
+    }
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &vidx_file))) {
+      goto WritePvarVidx_ret_OPEN_FAIL;
+    }
+    vidx_created = 1;
+    unsigned char header[kPvarVidxHeaderSize];
+    memset(header, 0, kPvarVidxHeaderSize);
+    // placeholder, rewritten at the end
+    if (unlikely(fwrite_checked(header, kPvarVidxHeaderSize, vidx_file))) {
+      goto WritePvarVidx_ret_WRITE_FAIL;
+    }
+    logprintfww5("Writing %s ... ", outname);
+    fflush(stdout);
+
+    // Header lines all go in the first frame.
+    uint32_t pos_col_idx = 0;
+    uint32_t alt_col_idx = 0;
+    uint32_t info_col_idx = 0;
+    char* line_iter = TextLineEnd(&txs);
+    while (1) {
+      ++line_idx;
+      if (!TextGetUnsafe2(&txs, &line_iter)) {
+        if (unlikely(TextStreamErrcode2(&txs, &reterr))) {
+          goto WritePvarVidx_ret_TSTREAM_FAIL;
+        }
+        goto WritePvarVidx_ret_NO_CHROM_LINE;
+      }
+      if (line_iter[0] != '#') {
+        goto WritePvarVidx_ret_NO_CHROM_LINE;
+      }
+      char* line_end = AdvPastDelim(line_iter, '\n');
+      if (unlikely(CsputsStd(line_iter, line_end - line_iter, &css, &cswritep))) {
+        goto WritePvarVidx_ret_WRITE_FAIL;
+      }
+      if (tokequal_k(line_iter, "#CHROM")) {
+        const char* token_end = &(line_iter[6]);
+        for (uint32_t col_idx = 1; ; ++col_idx) {
+          const char* token_start = FirstNonTspace(token_end);
+          if (IsEolnKns(*token_start)) {
+            break;
+          }
+          token_end = CurTokenEnd(token_start);
+          const uint32_t token_slen = token_end - token_start;
+          if (strequal_k(token_start, "POS", token_slen)) {
+            pos_col_idx = col_idx;
+          } else if (strequal_k(token_start, "ALT", token_slen)) {
+            alt_col_idx = col_idx;
+          } else if (strequal_k(token_start, "INFO", token_slen)) {
+            info_col_idx = col_idx;
+          }
+        }
+        line_iter = line_end;
+        break;
+      }
+      line_iter = line_end;
+    }
+    if (unlikely((!pos_col_idx) || (!alt_col_idx))) {
+      goto WritePvarVidx_ret_NO_CHROM_LINE;
+    }
+    uint32_t last_col_idx = MAXV(pos_col_idx, alt_col_idx);
+    if (info_col_idx > last_col_idx) {
+      last_col_idx = info_col_idx;
+    }
+    if (unlikely(CswriteEndFrame(&css, &cswritep))) {
+      goto WritePvarVidx_ret_WRITE_FAIL;
+    }
+
+    // Frame records grow up from the bottom of the workspace, chromosome names
+    // grow down from the top.
+    PvarVidxWframe* wframes = R_CAST(PvarVidxWframe*, g_bigstack_base);
+    char* chr_names_bottom = R_CAST(char*, g_bigstack_end);
+    char* const chr_names_top = chr_names_bottom;
+    PvarVidxFrame* cur_frame = nullptr;
+    const char* cur_chr_name = nullptr;
+    uint32_t cur_chr_slen = 0;
+    uint32_t frame_ct = 0;
+    uint32_t frame_variant_ct = 0;
+    uint32_t chr_name_ct = 0;
+    uint32_t variant_ct = 0;
+    uint32_t multiallelic_ct = 0;
+    uint32_t bp_sorted = 1;
+    int32_t last_bp = 0;
+    for (; TextGetUnsafe2(&txs, &line_iter); ++line_iter, ++line_idx) {
+      char* chr_end = CurTokenEnd(line_iter);
+      const uint32_t chr_slen = chr_end - line_iter;
+      const uint32_t same_chr = cur_frame && (chr_slen == cur_chr_slen) && memequal(line_iter, cur_chr_name, chr_slen);
+      if ((!same_chr) || (frame_variant_ct == kPvarVidxFrameVariantCt)) {
+        if (cur_frame) {
+          if (unlikely(CswriteEndFrame(&css, &cswritep))) {
+            goto WritePvarVidx_ret_WRITE_FAIL;
+          }
+        }
+        const char* new_chr_name = nullptr;
+        if (!same_chr) {
+          for (const char* chr_names_iter = chr_names_bottom; chr_names_iter != chr_names_top; ) {
+            const uint32_t prev_chr_slen = strlen(chr_names_iter);
+            if ((prev_chr_slen == chr_slen) && memequal(chr_names_iter, line_iter, chr_slen)) {
+              goto WritePvarVidx_ret_SPLIT_CHR;
+            }
+            chr_names_iter = &(chr_names_iter[prev_chr_slen + 1]);
+          }
+          chr_names_bottom = &(chr_names_bottom[-S_CAST(intptr_t, chr_slen + 1)]);
+          if (unlikely(R_CAST(char*, &(wframes[frame_ct + 1])) > chr_names_bottom)) {
+            goto WritePvarVidx_ret_NOMEM;
+          }
+          memcpyx(chr_names_bottom, line_iter, chr_slen, '\0');
+          new_chr_name = chr_names_bottom;
+          cur_chr_name = chr_names_bottom;
+          cur_chr_slen = chr_slen;
+          ++chr_name_ct;
+          last_bp = 0;
+        } else if (unlikely(R_CAST(char*, &(wframes[frame_ct + 1])) > chr_names_bottom)) {
+          goto WritePvarVidx_ret_NOMEM;
+        }
+        wframes[frame_ct].chr_name = new_chr_name;
+        cur_frame = &(wframes[frame_ct].frame);
+        ++frame_ct;
+        cur_frame->fpos = ftello(css.outfile);
+        cur_frame->variant_idx_start = variant_ct;
+        cur_frame->chr_name_idx = chr_name_ct - 1;
+        cur_frame->bp_min = UINT32_MAX;
+        cur_frame->bp_max = 0;
+        cur_frame->multiallelic_ct = 0;
+        cur_frame->flags = kfPvarVidxFrame0;
+        frame_variant_ct = 0;
+      }
+      char* line_end = AdvToDelim(chr_end, '\n');
+      if (unlikely(CsputsStd(line_iter, 1 + S_CAST(uintptr_t, line_end - line_iter), &css, &cswritep))) {
+        goto WritePvarVidx_ret_WRITE_FAIL;
+      }
+      char* info_token = nullptr;
+      uint32_t info_slen = 0;
+      char* token_end = chr_end;
+      for (uint32_t col_idx = 1; col_idx <= last_col_idx; ++col_idx) {
+        char* token_start = FirstNonTspace(token_end);
+        if (unlikely(IsEolnKns(*token_start))) {
+          goto WritePvarVidx_ret_MISSING_TOKENS;
+        }
+        token_end = CurTokenEnd(token_start);
+        if (col_idx == pos_col_idx) {
+          int32_t cur_bp;
+          if ((!ScanIntAbsDefcap(token_start, &cur_bp)) && (cur_bp >= 0)) {
+            if (cur_bp < last_bp) {
+              bp_sorted = 0;
+            }
+            last_bp = cur_bp;
+            if (S_CAST(uint32_t, cur_bp) < cur_frame->bp_min) {
+              cur_frame->bp_min = cur_bp;
+            }
+            if (S_CAST(uint32_t, cur_bp) > cur_frame->bp_max) {
+              cur_frame->bp_max = cur_bp;
+            }
+          }
+        } else if (col_idx == alt_col_idx) {
+          const uint32_t extra_alt_ct = CountByte(token_start, ',', token_end - token_start);
+          if (extra_alt_ct) {
+            if (extra_alt_ct > 65535) {
+              cur_frame->flags |= kfPvarVidxFrameNoSkip;
+            }
+            const uint32_t entry = (frame_variant_ct << 16) | (extra_alt_ct & 65535);
+            if (unlikely(!fwrite_unlocked(&entry, sizeof(int32_t), 1, vidx_file))) {
+              goto WritePvarVidx_ret_WRITE_FAIL;
+            }
+            cur_frame->multiallelic_ct += 1;
+            ++multiallelic_ct;
+          }
+        } else if (col_idx == info_col_idx) {
+          info_token = token_start;
+          info_slen = token_end - token_start;
+        }
+      }
+      // PrInInfo() may clobber the INFO terminator, so this must come after
+      // the other columns are scanned.
+      if (info_token && PrInInfo(info_slen, info_token)) {
+        cur_frame->flags |= kfPvarVidxFramePr;
+      }
+      line_iter = line_end;
+      ++frame_variant_ct;
+      ++variant_ct;
+    }
+    if (unlikely(TextStreamErrcode2(&txs, &reterr))) {
+      goto WritePvarVidx_ret_TSTREAM_FAIL;
+    }
+    reterr = kPglRetSuccess;
+    if (unlikely(CleanupTextStream2(pvar_fname, &txs, &reterr))) {
+      goto WritePvarVidx_ret_1;
+    }
+    if (unlikely(CswriteCloseNull(&css, cswritep))) {
+      goto WritePvarVidx_ret_WRITE_FAIL;
+    }
+    if (unlikely(rename(tmp_fname, pvar_fname))) {
+      logerrprintfww("Error: Failed to rename %s to %s.\n", tmp_fname, pvar_fname);
+      goto WritePvarVidx_ret_WRITE_FAIL;
+    }
+    PvarFileKey pvar_key;
+    PreinitPvarFileKey(&pvar_key);
+    if (unlikely(PvarFileKeyInit(pvar_fname, &pvar_key))) {
+      logerrprintfww(kErrprintfFread, pvar_fname, rstrerror(errno));
+      reterr = kPglRetReadFail;
+      goto WritePvarVidx_ret_1;
+    }
+    for (uint32_t frame_idx = 0; frame_idx != frame_ct; ++frame_idx) {
+      if (unlikely(!fwrite_unlocked(&(wframes[frame_idx].frame), sizeof(PvarVidxFrame), 1, vidx_file))) {
+        goto WritePvarVidx_ret_WRITE_FAIL;
+      }
+    }
+    for (uint32_t frame_idx = 0; frame_idx != frame_ct; ++frame_idx) {
+      const char* chr_name = wframes[frame_idx].chr_name;
+      if (chr_name) {
+        if (unlikely(!fwrite_unlocked(chr_name, strlen(chr_name) + 1, 1, vidx_file))) {
+          goto WritePvarVidx_ret_WRITE_FAIL;
+        }
+      }
+    }
+    header[0] = 0x6c;
+    header[1] = 0x1b;
+    header[2] = 0x31;
+    header[3] = 1;
+    memcpy(&(header[4]), &variant_ct, sizeof(int32_t));
+    memcpy(&(header[8]), &frame_ct, sizeof(int32_t));
+    memcpy(&(header[12]), &chr_name_ct, sizeof(int32_t));
+    memcpy(&(header[16]), &bp_sorted, sizeof(int32_t));
+    memcpy(&(header[20]), &multiallelic_ct, sizeof(int32_t));
+    PvarFileKeySerialize(&pvar_key, &(header[24]));
+    rewind(vidx_file);
+    if (unlikely(fwrite_checked(header, kPvarVidxHeaderSize, vidx_file) ||
+                 fclose_null(&vidx_file))) {
+      goto WritePvarVidx_ret_WRITE_FAIL;
+    }
+    logputs("done.\n");
+  }
+  while (0) {
+  WritePvarVidx_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  WritePvarVidx_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  WritePvarVidx_ret_TSTREAM_FAIL:
+    TextStreamErrPrint(".pvar.zst file", &txs);
+    break;
+  WritePvarVidx_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  WritePvarVidx_ret_MISSING_TOKENS:
+    logputs("\n");
+    logerrprintfww("Error: Line %" PRIuPTR " of the .pvar.zst has fewer tokens than expected.\n", line_idx);
+    reterr = kPglRetMalformedInput;
+    break;
+  WritePvarVidx_ret_NO_CHROM_LINE:
+    logputs("\n");
+    logerrputs("Warning: Skipping .pvar.zst.vidx, since the .pvar.zst has no #CHROM header line.\n");
+    index_skipped = 1;
+    break;
+  WritePvarVidx_ret_SPLIT_CHR:
+    logputs("\n");
+    logerrputs("Warning: Skipping .pvar.zst.vidx, since the .pvar.zst has a split chromosome.\n(Use --sort-vars to remedy this.)\n");
+    index_skipped = 1;
+    break;
+  }
+ WritePvarVidx_ret_1:
+  CswriteCloseCond(&css, cswritep);
+  fclose_cond(vidx_file);
+  CleanupTextStream2(".pvar.zst file", &txs, &reterr);
+  if (reterr || index_skipped) {
+    if (tmp_fname) {
+      unlink(tmp_fname);
+    }
+    if (vidx_created) {
+      unlink(outname);
+    }
+  }
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
 #ifdef __cplusplus
 }  // namespace plink2
 #endif
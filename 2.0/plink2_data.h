@@ -55,7 +55,10 @@ FLAGSET_DEF_START()
   kfMakePgenFormatBase = (1 << 18), // two bits
   kfMakePgenErasePhase = (1 << 20),
   kfMakePgenEraseDosage = (1 << 21),
-  kfMakePgenFillMissingFromDosage = (1 << 22)
+  kfMakePgenFillMissingFromDosage = (1 << 22),
+  kfMakePgenSmaj = (1 << 23),
+  kfMakePvarVidx = (1 << 24),
+  kfMakePgenCksum = (1 << 25)
 FLAGSET_DEF_END(MakePlink2Flags);
 
 FLAGSET_DEF_START()
@@ -155,6 +158,15 @@ PglErr MakePlink2NoVsort(const uintptr_t* sample_include, const PedigreeIdInfo*
 
 PglErr MakePlink2Vsort(const uintptr_t* sample_include, const PedigreeIdInfo* piip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const uint32_t* new_sample_idx_to_old, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const uintptr_t* allele_presents, const STD_ARRAY_PTR_DECL(AlleleCode, 2, refalt1_select), const uintptr_t* pvar_qual_present, const float* pvar_quals, const uintptr_t* pvar_filter_present, const uintptr_t* pvar_filter_npass, const char* const* pvar_filter_storage, const char* pvar_info_reload, const double* variant_cms, const ChrIdx* chr_idxs, uintptr_t xheader_blen, InfoFlags info_flags, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t max_filter_slen, uint32_t info_reload_slen, uint32_t max_thread_ct, uint32_t hard_call_thresh, uint32_t dosage_erase_thresh, MakePlink2Flags make_plink2_flags, uint32_t use_nsort, PvarPsamFlags pvar_psam_flags, char* xheader, PgenReader* simple_pgrp, char* outname, char* outname_end);
 
+// Writes <outname>.pgen.smaj, a sample-major copy of the hardcalls in
+// <outname>.pgen (see PgenSmajReader in pgenlib_read.h).
+PglErr WritePgenSmaj(char* outname, char* outname_end);
+
+// Rewrites the just-written <outname>.pvar.zst with one Zstd frame per
+// chromosome chunk, and writes the <outname>.pvar.zst.vidx frame index (see
+// plink2_pvar.h).
+PglErr WritePvarVidx(uint32_t max_thread_ct, char* outname, char* outname_end);
+
 PglErr SampleSortFileMap(const uintptr_t* sample_include, const SampleIdInfo* siip, const char* sample_sort_fname, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t** new_sample_idx_to_old_ptr);
 
 #ifdef __cplusplus
@@ -18,6 +18,14 @@
 #include "plink2_compress_stream.h"
 #include "plink2_glm.h"
 #include "plink2_matrix.h"
+#include "plink2_matrix_calc.h"
+#include "plink2_set.h"
+
+#ifdef _WIN32
+#  include <io.h>  // _chsize_s()
+#else
+#  include <unistd.h>  // truncate()
+#endif
 
 #ifdef __LP64__
 #  ifdef __x86_64__
@@ -42,8 +50,16 @@ void InitGlm(GlmInfo* glm_info_ptr) {
   glm_info_ptr->local_bp_col = 0;
   glm_info_ptr->local_first_covar_col = 0;
   glm_info_ptr->max_corr = 0.999;
+  glm_info_ptr->score_screen_ln_thresh = 0.0;
+  glm_info_ptr->loco_ridge_h2 = 0.5;
+  glm_info_ptr->stepwise_ln_thresh = 0.0;
+  glm_info_ptr->set_max_maf = 0.01;
+  glm_info_ptr->set_max_vct = 2000;
+  glm_info_ptr->hits_max_ct = 0;
+  glm_info_ptr->hits_ln_thresh = 0.0;
   glm_info_ptr->condition_varname = nullptr;
   glm_info_ptr->condition_list_fname = nullptr;
+  glm_info_ptr->set_test_fname = nullptr;
   InitRangeList(&(glm_info_ptr->parameters_range_list));
   InitRangeList(&(glm_info_ptr->tests_range_list));
 }
@@ -51,6 +67,7 @@ void InitGlm(GlmInfo* glm_info_ptr) {
 void CleanupGlm(GlmInfo* glm_info_ptr) {
   free_cond(glm_info_ptr->condition_varname);
   free_cond(glm_info_ptr->condition_list_fname);
+  free_cond(glm_info_ptr->set_test_fname);
   CleanupRangeList(&(glm_info_ptr->parameters_range_list));
   CleanupRangeList(&(glm_info_ptr->tests_range_list));
 }
@@ -3120,7 +3137,308 @@ BoolErr FirthRegressionResidualized(const float* yy, const float* xx, const uint
 
 static const float kSmallFloats[4] = {0.0, 1.0, 2.0, 3.0};
 
-BoolErr GlmAllocFillAndTestPhenoCovarsCc(const uintptr_t* sample_include, const uintptr_t* pheno_cc, const uintptr_t* covar_include, const PhenoCol* covar_cols, const char* covar_names, uintptr_t sample_ct, uint32_t domdev_present_p1, uintptr_t covar_ct, uint32_t local_covar_ct, uint32_t covar_max_nonnull_cat_ct, uintptr_t extra_cat_ct, uintptr_t max_covar_name_blen, double max_corr, double vif_thresh, uintptr_t xtx_state, GlmFlags glm_flags, uintptr_t** pheno_cc_collapsed_ptr, uintptr_t** gcount_case_interleaved_vec_ptr, float** pheno_f_ptr, RegressionNmPrecomp** nm_precomp_ptr, float** covars_cmaj_f_ptr, CcResidualizeCtx** cc_residualize_ptr, const char*** cur_covar_names_ptr, GlmErr* glm_err_ptr) {
+// Null-model state for --glm score-screen=.
+typedef struct LogisticScoreScreenStruct {
+  // (1 + predictor_ct) rows of sample_ctav floats: y - mu, followed by W * x
+  // for each null-model predictor.  The first predictor is the intercept, so
+  // the second row is just W.
+  float* resid_wx_pmaj;
+  // fitted null-model case probabilities (only allocated with 'spa')
+  float* mu;
+  // (X^T W X)^{-1}; both halves filled
+  double* xtwx_inv;
+  uint32_t predictor_ct;
+} LogisticScoreScreen;
+
+// Fits the covariate-only logistic model, and fills the rest of
+// *score_screen_ptr.  *score_screen_ptr is set to nullptr if the fit fails, in
+// which case every variant gets the full regression.  Scratch space is taken
+// from the top of bigstack; caller is responsible for resetting it.
+BoolErr LogisticScoreScreenFit(const float* pheno_f, const float* covars_cmaj_f, uint32_t sample_ct, LogisticScoreScreen** score_screen_ptr) {
+  LogisticScoreScreen* score_screen = *score_screen_ptr;
+  const uintptr_t pred_ct = score_screen->predictor_ct;
+  const uintptr_t pred_ctav = RoundUpPow2(pred_ct, kFloatPerFVec);
+  const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+  float* xx;
+  float* coefs;
+  float* ll;
+  float* pp;
+  float* vv;
+  float* hh;
+  float* grad;
+  float* dcoef;
+  double* dbl_2d_buf;
+  MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, bigstack_alloc(pred_ct * kMatrixInvertBuf1CheckedAlloc));
+  if (unlikely((!inv_1d_buf) ||
+               bigstack_alloc_f(sample_ctav * pred_ct, &xx) ||
+               bigstack_calloc_f(pred_ctav, &coefs) ||
+               bigstack_alloc_f(pred_ct * pred_ctav, &ll) ||
+               bigstack_alloc_f(sample_ctav, &pp) ||
+               bigstack_alloc_f(sample_ctav, &vv) ||
+               bigstack_alloc_f(pred_ct * pred_ctav, &hh) ||
+               bigstack_alloc_f(pred_ctav, &grad) ||
+               bigstack_alloc_f(pred_ctav, &dcoef) ||
+               bigstack_alloc_d(pred_ct * MAXV(pred_ct, 3), &dbl_2d_buf))) {
+    return 1;
+  }
+  FillFVec(sample_ct, 1.0, xx);
+  memcpy(&(xx[sample_ctav]), covars_cmaj_f, sample_ctav * (pred_ct - 1) * sizeof(float));
+  uint32_t is_unfinished = 0;
+  if (LogisticRegression(pheno_f, xx, nullptr, sample_ct, pred_ct, coefs, &is_unfinished, ll, pp, vv, hh, grad, dcoef) || is_unfinished) {
+    *score_screen_ptr = nullptr;
+    return 0;
+  }
+  ColMajorFmatrixVectorMultiplyStrided(xx, coefs, sample_ct, sample_ctav, pred_ct, pp);
+  float* resid = score_screen->resid_wx_pmaj;
+  float* ww = &(resid[sample_ctav]);
+  float* mu = score_screen->mu;
+  for (uintptr_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+    const double cur_mu = 1.0 / (1.0 + exp(-S_CAST(double, pp[sample_idx])));
+    resid[sample_idx] = S_CAST(float, S_CAST(double, pheno_f[sample_idx]) - cur_mu);
+    ww[sample_idx] = S_CAST(float, cur_mu * (1.0 - cur_mu));
+    if (mu) {
+      mu[sample_idx] = S_CAST(float, cur_mu);
+    }
+  }
+  const uintptr_t sample_remv = sample_ctav - sample_ct;
+  ZeroFArr(sample_remv, &(resid[sample_ct]));
+  ZeroFArr(sample_remv, &(ww[sample_ct]));
+  if (mu) {
+    ZeroFArr(sample_remv, &(mu[sample_ct]));
+  }
+  for (uintptr_t pred_idx = 1; pred_idx != pred_ct; ++pred_idx) {
+    const float* cur_x = &(xx[pred_idx * sample_ctav]);
+    float* cur_wx = &(ww[pred_idx * sample_ctav]);
+    for (uintptr_t sample_idx = 0; sample_idx != sample_ctav; ++sample_idx) {
+      cur_wx[sample_idx] = ww[sample_idx] * cur_x[sample_idx];
+    }
+  }
+  // X^T W X only needs to be computed once per phenotype, so just use double
+  // precision here.
+  double* xtwx_inv = score_screen->xtwx_inv;
+  for (uintptr_t row_idx = 0; row_idx != pred_ct; ++row_idx) {
+    const float* wx_row = &(ww[row_idx * sample_ctav]);
+    for (uintptr_t col_idx = 0; col_idx <= row_idx; ++col_idx) {
+      const float* x_col = &(xx[col_idx * sample_ctav]);
+      double dxx = 0.0;
+      for (uintptr_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        dxx += S_CAST(double, wx_row[sample_idx]) * S_CAST(double, x_col[sample_idx]);
+      }
+      xtwx_inv[row_idx * pred_ct + col_idx] = dxx;
+    }
+  }
+  if (InvertSymmdefMatrixChecked(pred_ct, xtwx_inv, inv_1d_buf, dbl_2d_buf)) {
+    *score_screen_ptr = nullptr;
+    return 0;
+  }
+  for (uintptr_t row_idx = 0; row_idx != pred_ct; ++row_idx) {
+    for (uintptr_t col_idx = row_idx + 1; col_idx != pred_ct; ++col_idx) {
+      xtwx_inv[row_idx * pred_ct + col_idx] = xtwx_inv[col_idx * pred_ct + row_idx];
+    }
+  }
+  return 0;
+}
+
+// Cumulant generating function of sum_i adj_geno[i] * (y_i - mu_i) under the
+// null, and its first two derivatives, evaluated at tt.
+void ScoreSpaCgf(const float* adj_geno, const float* mu, uint32_t sample_ct, double tt, double* k0_ptr, double* k1_ptr, double* k2_ptr) {
+  double k0 = 0.0;
+  double k1 = 0.0;
+  double k2 = 0.0;
+  for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+    const double cur_geno = S_CAST(double, adj_geno[sample_idx]);
+    const double cur_mu = S_CAST(double, mu[sample_idx]);
+    const double tg = tt * cur_geno;
+    // p(t) = mu * e^{tg} / (1 - mu + mu * e^{tg}), rearranged to avoid
+    // overflow
+    double cur_p;
+    if (tg > 0.0) {
+      const double denom = cur_mu + (1.0 - cur_mu) * exp(-tg);
+      k0 += tg + log(denom);
+      cur_p = cur_mu / denom;
+    } else {
+      const double etg = exp(tg);
+      const double denom = 1.0 - cur_mu + cur_mu * etg;
+      k0 += log(denom);
+      cur_p = cur_mu * etg / denom;
+    }
+    k0 -= tg * cur_mu;
+    k1 += cur_geno * (cur_p - cur_mu);
+    k2 += cur_geno * cur_geno * cur_p * (1.0 - cur_p);
+  }
+  *k0_ptr = k0;
+  *k1_ptr = k1;
+  *k2_ptr = k2;
+}
+
+// Natural log of the saddlepoint-approximated tail probability
+// P(S >= qq) (qq > 0) or P(S <= qq) (qq < 0), using the Barndorff-Nielsen
+// form of the Lugannani-Rice formula.  See Dey R et al. (2017) A Fast and
+// Accurate Algorithm to Test for Binary Phenotypes and Its Application to
+// PheWAS.  Returns 1 on root-finding failure.
+BoolErr ScoreSpaTailLnP(const float* adj_geno, const float* mu, uint32_t sample_ct, double qq, double var, double* ln_tail_ptr) {
+  // Work with uu = sgn * t, so that f(uu) = sgn * K'(sgn * uu) - |qq| is
+  // increasing, and f(0) < 0.
+  const double sgn = (qq > 0.0)? 1.0 : -1.0;
+  const double abs_q = fabs(qq);
+  double k0;
+  double k1;
+  double k2;
+  double lo = 0.0;
+  double hi = abs_q / var;
+  for (uint32_t iter_idx = 0; ; ++iter_idx) {
+    if (iter_idx == 64) {
+      return 1;
+    }
+    ScoreSpaCgf(adj_geno, mu, sample_ct, sgn * hi, &k0, &k1, &k2);
+    if (sgn * k1 >= abs_q) {
+      break;
+    }
+    lo = hi;
+    hi *= 2;
+  }
+  double uu = hi;
+  for (uint32_t iter_idx = 0; ; ++iter_idx) {
+    if (iter_idx == 100) {
+      return 1;
+    }
+    const double ff = sgn * k1 - abs_q;
+    if (ff < 0.0) {
+      lo = uu;
+    } else {
+      hi = uu;
+    }
+    double next_uu = uu - ff / k2;
+    if ((k2 <= 0.0) || (next_uu <= lo) || (next_uu >= hi)) {
+      next_uu = 0.5 * (lo + hi);
+    }
+    const double delta = fabs(next_uu - uu);
+    uu = next_uu;
+    ScoreSpaCgf(adj_geno, mu, sample_ct, sgn * uu, &k0, &k1, &k2);
+    if (delta <= 1e-10 * (1.0 + uu)) {
+      break;
+    }
+  }
+  const double half_ww_sq = uu * abs_q - k0;
+  if ((half_ww_sq <= 0.0) || (k2 <= 0.0)) {
+    return 1;
+  }
+  const double ww = sqrt(2 * half_ww_sq);
+  const double vv = uu * sqrt(k2);
+  const double zz = ww + log(vv / ww) / ww;
+  if (!(zz > 0.0)) {
+    return 1;
+  }
+  // one-sided
+  *ln_tail_ptr = ZscoreToLnP(zz) - 0.6931471805599453;
+  return 0;
+}
+
+// Computes the score test for one biallelic variant against the null model.
+// If its p-value is not below ln_thresh, beta_se[0] and beta_se[1] are filled
+// with the one-step score estimate and a matching standard error, and 1 is
+// returned; otherwise 0 is returned and the full regression should be run.
+// nm_geno has nm_sample_ct entries; missing samples are mean-imputed.
+uint32_t LogisticScoreScreenVariant(const float* nm_geno, const uintptr_t* sample_nm, const float* covars_cmaj, const LogisticScoreScreen* score_screen, uint32_t sample_ct, uint32_t nm_sample_ct, double ln_thresh, float* geno_buf, float* adj_geno_buf, float* dotprod_buf, double* coef_buf, double* beta_se) {
+  const uint32_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+  const uint32_t pred_ct = score_screen->predictor_ct;
+  double geno_sum = 0.0;
+  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+    geno_sum += S_CAST(double, nm_geno[sample_idx]);
+  }
+  // Centering doesn't change the score statistic or its variance (intercept
+  // is in the null model), but it reduces cancellation error.
+  const float geno_mean = S_CAST(float, geno_sum / u31tod(nm_sample_ct));
+  if (nm_sample_ct == sample_ct) {
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      geno_buf[sample_idx] = nm_geno[sample_idx] - geno_mean;
+    }
+  } else {
+    ZeroFArr(sample_ct, geno_buf);
+    uintptr_t sample_uidx_base = 0;
+    uintptr_t sample_nm_bits = sample_nm[0];
+    for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+      const uintptr_t sample_uidx = BitIter1(sample_nm, &sample_uidx_base, &sample_nm_bits);
+      geno_buf[sample_uidx] = nm_geno[sample_idx] - geno_mean;
+    }
+  }
+  ZeroFArr(sample_ctav - sample_ct, &(geno_buf[sample_ct]));
+  const float* resid_wx_pmaj = score_screen->resid_wx_pmaj;
+  ColMajorFvectorMatrixMultiplyStrided(geno_buf, resid_wx_pmaj, sample_ct, sample_ctav, pred_ct + 1, dotprod_buf);
+  const float* ww = &(resid_wx_pmaj[sample_ctav]);
+  for (uint32_t sample_idx = 0; sample_idx != sample_ctav; ++sample_idx) {
+    adj_geno_buf[sample_idx] = ww[sample_idx] * geno_buf[sample_idx];
+  }
+  const double score = S_CAST(double, dotprod_buf[0]);
+  // geno^T W geno; reuse dotprod_buf[0] since the score has been saved
+  ColMajorFvectorMatrixMultiplyStrided(adj_geno_buf, geno_buf, sample_ct, sample_ctav, 1, dotprod_buf);
+  const double gwg = S_CAST(double, dotprod_buf[0]);
+  const double* xtwx_inv = score_screen->xtwx_inv;
+  double proj = 0.0;
+  for (uint32_t row_idx = 0; row_idx != pred_ct; ++row_idx) {
+    const double* xtwx_inv_row = &(xtwx_inv[row_idx * pred_ct]);
+    double dxx = 0.0;
+    for (uint32_t col_idx = 0; col_idx != pred_ct; ++col_idx) {
+      dxx += xtwx_inv_row[col_idx] * S_CAST(double, dotprod_buf[col_idx + 1]);
+    }
+    coef_buf[row_idx] = dxx;
+    proj += dxx * S_CAST(double, dotprod_buf[row_idx + 1]);
+  }
+  const double var = gwg - proj;
+  // Genotype (nearly) collinear with covariates: let the full regression
+  // report the appropriate error code.
+  if (!(var > 1e-7 * gwg)) {
+    return 0;
+  }
+  const double zz = score / sqrt(var);
+  double ln_pval = ZscoreToLnP(zz);
+  uint32_t spa_applied = 0;
+  if (score_screen->mu && (fabs(zz) > 2.0)) {
+    // adj_geno = geno - X (X^T W X)^{-1} X^T W geno
+    const float intercept_coef = S_CAST(float, coef_buf[0]);
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      adj_geno_buf[sample_idx] = geno_buf[sample_idx] - intercept_coef;
+    }
+    for (uint32_t pred_idx = 1; pred_idx != pred_ct; ++pred_idx) {
+      const float cur_coef = S_CAST(float, coef_buf[pred_idx]);
+      const float* cur_covar = &(covars_cmaj[(pred_idx - 1) * sample_ctav]);
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        adj_geno_buf[sample_idx] -= cur_coef * cur_covar[sample_idx];
+      }
+    }
+    double ln_tail1;
+    double ln_tail2;
+    if ((!ScoreSpaTailLnP(adj_geno_buf, score_screen->mu, sample_ct, score, var, &ln_tail1)) &&
+        (!ScoreSpaTailLnP(adj_geno_buf, score_screen->mu, sample_ct, -score, var, &ln_tail2))) {
+      if (ln_tail1 < ln_tail2) {
+        const double tmp = ln_tail1;
+        ln_tail1 = ln_tail2;
+        ln_tail2 = tmp;
+      }
+      ln_pval = ln_tail1 + log1p(exp(ln_tail2 - ln_tail1));
+      if (ln_pval > 0.0) {
+        ln_pval = 0.0;
+      }
+      spa_applied = 1;
+    }
+  }
+  if (ln_pval < ln_thresh) {
+    return 0;
+  }
+  const double beta = score / var;
+  double se = 1.0 / sqrt(var);
+  if (spa_applied) {
+    const double chisq = LnPToChisq(ln_pval);
+    if (chisq > 0.0) {
+      se = fabs(beta) / sqrt(chisq);
+    }
+  }
+  beta_se[0] = beta;
+  beta_se[1] = se;
+  return 1;
+}
+
+BoolErr GlmAllocFillAndTestPhenoCovarsCc(const uintptr_t* sample_include, const uintptr_t* pheno_cc, const uintptr_t* covar_include, const PhenoCol* covar_cols, const char* covar_names, uintptr_t sample_ct, uint32_t domdev_present_p1, uintptr_t covar_ct, uint32_t local_covar_ct, uint32_t covar_max_nonnull_cat_ct, uintptr_t extra_cat_ct, uintptr_t max_covar_name_blen, double max_corr, double vif_thresh, uintptr_t xtx_state, GlmFlags glm_flags, uintptr_t** pheno_cc_collapsed_ptr, uintptr_t** gcount_case_interleaved_vec_ptr, float** pheno_f_ptr, RegressionNmPrecomp** nm_precomp_ptr, float** covars_cmaj_f_ptr, CcResidualizeCtx** cc_residualize_ptr, LogisticScoreScreen** score_screen_ptr, const char*** cur_covar_names_ptr, GlmErr* glm_err_ptr) {
   const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
   const uintptr_t new_covar_ct = covar_ct + extra_cat_ct;
   const uintptr_t new_nonlocal_covar_ct = new_covar_ct - local_covar_ct;
@@ -3132,6 +3450,23 @@ BoolErr GlmAllocFillAndTestPhenoCovarsCc(const uintptr_t* sample_include, const
                bigstack_alloc_kcp(new_covar_ct, cur_covar_names_ptr))) {
       return 1;
   }
+  *score_screen_ptr = nullptr;
+  if (glm_flags & kfGlmScoreScreen) {
+    // local covariates prohibited
+    const uintptr_t pred_ct = new_covar_ct + 1;
+    if (unlikely(BIGSTACK_ALLOC_X(LogisticScoreScreen, 1, score_screen_ptr) ||
+                 bigstack_alloc_f((pred_ct + 1) * sample_ctav, &((*score_screen_ptr)->resid_wx_pmaj)) ||
+                 bigstack_alloc_d(pred_ct * pred_ct, &((*score_screen_ptr)->xtwx_inv)))) {
+      return 1;
+    }
+    (*score_screen_ptr)->mu = nullptr;
+    if (glm_flags & kfGlmScoreScreenSpa) {
+      if (unlikely(bigstack_alloc_f(sample_ctav, &((*score_screen_ptr)->mu)))) {
+        return 1;
+      }
+    }
+    (*score_screen_ptr)->predictor_ct = pred_ct;
+  }
   double* corr_buf = nullptr;
   unsigned char* bigstack_mark = g_bigstack_base;
   *nm_precomp_ptr = nullptr;
@@ -3274,6 +3609,11 @@ BoolErr GlmAllocFillAndTestPhenoCovarsCc(const uintptr_t* sample_include, const
       // probable todo: print fitted coefficients and standard errors to log
     }
   }
+  if (*score_screen_ptr) {
+    if (unlikely(LogisticScoreScreenFit(*pheno_f_ptr, *covars_cmaj_f_ptr, sample_ct, score_screen_ptr))) {
+      return 1;
+    }
+  }
   BigstackReset(bigstack_mark);
   if (gcount_case_interleaved_vec_ptr) {
     if (unlikely(bigstack_alloc_w(sample_ctv * kWordsPerVec, gcount_case_interleaved_vec_ptr))) {
@@ -3285,7 +3625,50 @@ BoolErr GlmAllocFillAndTestPhenoCovarsCc(const uintptr_t* sample_include, const
   return 0;
 }
 
-uintptr_t GetLogisticWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predictor_ct, uint32_t domdev_present_p1, uint32_t max_extra_allele_ct, uint32_t constraint_ct, uint32_t xmain_ct, uint32_t gcount_cc, uint32_t is_sometimes_firth, uint32_t is_cc_residualize) {
+// Fills one phenotype's slot in a --glm logistic subbatch; see the
+// GlmLogisticCtx.subbatch_size comment for the layout.
+void FillPhenoCcSubbatchMember(const uintptr_t* sample_include, const uintptr_t* pheno_cc, uint32_t sample_ct, uintptr_t* pheno_cc_collapsed, uintptr_t* gcount_case_interleaved_vec, float* pheno_f) {
+  CopyBitarrSubset(pheno_cc, sample_include, sample_ct, pheno_cc_collapsed);
+  ZeroTrailingWords(BitCtToWordCt(sample_ct), pheno_cc_collapsed);
+  for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+    pheno_f[sample_idx] = kSmallFloats[IsSet(pheno_cc_collapsed, sample_idx)];
+  }
+  ZeroFArr(RoundUpPow2(sample_ct, kFloatPerFVec) - sample_ct, &(pheno_f[sample_ct]));
+  if (gcount_case_interleaved_vec) {
+    FillInterleavedMaskVec(pheno_cc_collapsed, BitCtToVecCt(sample_ct), gcount_case_interleaved_vec);
+  }
+}
+
+// cand_sample_include must be initialized to the candidate phenotype's
+// starting sample set.  *is_match_ptr is set to 1 iff GlmDetermineCovars()
+// then reproduces the given sample and covariate sets exactly, without any
+// covariate separation, and both cases and controls remain.
+BoolErr GlmCcSubbatchMatch(const uintptr_t* pheno_cc, const uintptr_t* initial_covar_include, const PhenoCol* covar_cols, const uintptr_t* sample_include, const uintptr_t* covar_include, uint32_t raw_sample_ct, uint32_t raw_covar_ctl, uint32_t initial_covar_ct, uint32_t covar_max_nonnull_cat_ct, uint32_t is_sometimes_firth, uint32_t is_always_firth, uint32_t sample_ct, uint32_t covar_ct, uint32_t extra_cat_ct, uintptr_t* cand_sample_include, uintptr_t* cand_covar_include, uint32_t* is_match_ptr) {
+  const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+  *is_match_ptr = 0;
+  uint32_t cand_sample_ct;
+  if (initial_covar_ct) {
+    uint32_t cand_covar_ct = 0;
+    uint32_t cand_extra_cat_ct = 0;
+    uint16_t separation_found = 0;
+    if (unlikely(GlmDetermineCovars(pheno_cc, initial_covar_include, covar_cols, raw_sample_ct, raw_covar_ctl, initial_covar_ct, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, cand_sample_include, cand_covar_include, &cand_sample_ct, &cand_covar_ct, &cand_extra_cat_ct, &separation_found))) {
+      return 1;
+    }
+    if (separation_found || (cand_covar_ct != covar_ct) || (cand_extra_cat_ct != extra_cat_ct) || (covar_ct && (!wordsequal(covar_include, cand_covar_include, raw_covar_ctl)))) {
+      return 0;
+    }
+  } else {
+    cand_sample_ct = PopcountWords(cand_sample_include, raw_sample_ctl);
+  }
+  if ((cand_sample_ct != sample_ct) || (!wordsequal(sample_include, cand_sample_include, raw_sample_ctl))) {
+    return 0;
+  }
+  const uint32_t case_ct = PopcountWordsIntersect(sample_include, pheno_cc, raw_sample_ctl);
+  *is_match_ptr = case_ct && (case_ct != sample_ct);
+  return 0;
+}
+
+uintptr_t GetLogisticWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predictor_ct, uint32_t domdev_present_p1, uint32_t max_extra_allele_ct, uint32_t constraint_ct, uint32_t xmain_ct, uint32_t gcount_cc, uint32_t is_sometimes_firth, uint32_t is_cc_residualize, uint32_t is_loco, uint32_t is_score_screen) {
   // sample_ctav * max_predictor_ct < 2^31, and sample_ct >=
   // biallelic_predictor_ct, so no overflows?
   // could round everything up to multiples of 16 instead of 64
@@ -3359,10 +3742,21 @@ uintptr_t GetLogisticWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predic
     // mean_centered_pmaj_buf = (domdev_present_p1 + max_extra_allele_ct) *
     //   sample_ctav floats
     workspace_size += RoundUpPow2((domdev_present_p1 + max_extra_allele_ct) * sample_ctav * sizeof(float), kCacheline);
-
+  }
+  if (is_cc_residualize || is_loco) {
     // sample_offsets_buf
     workspace_size += RoundUpPow2(sample_ctav * sizeof(float), kCacheline);
   }
+  if (is_score_screen) {
+    // screen_geno_buf, screen_adj_geno_buf = sample_ctav floats
+    workspace_size += 2 * RoundUpPow2(sample_ctav * sizeof(float), kCacheline);
+
+    // screen_dotprod_buf = biallelic_predictor_ct floats
+    workspace_size += RoundUpPow2(biallelic_predictor_ct * sizeof(float), kCacheline);
+
+    // screen_coef_buf = biallelic_predictor_ct doubles
+    workspace_size += RoundUpPow2(biallelic_predictor_ct * sizeof(double), kCacheline);
+  }
   if (constraint_ct) {
     // tmphxs_buf, h_transpose_buf = constraint_ct * max_predictor_ctav floats
     workspace_size += 2 * RoundUpPow2(constraint_ct * max_predictor_ctav * sizeof(float), kCacheline);
@@ -3401,6 +3795,8 @@ typedef struct {
 
   uint16_t firth_fallback;
   uint16_t is_unfinished;
+  // only the score-screen one-step estimate is reported
+  uint32_t score_screened;
   uint32_t case_allele_obs_ct;
   double a1_case_dosage;
 
@@ -3426,6 +3822,75 @@ typedef struct {
   double mach_r2;
 } LinearAuxResult;
 
+// --glm hits=/hits-p=/sumstats-bin support.  Each primary association is
+// offered to a bounded max-heap (worst retained hit on top) as the main
+// results are written, so the strongest hits can be reported in sorted order
+// without a second pass over the full output.
+typedef struct GlmHitStruct {
+  double ln_pval;
+  double beta;
+  double se;
+  uint32_t variant_uidx;
+  uint32_t a1_allele_idx;
+  uint32_t obs_ct;
+  uint32_t is_joint;
+#ifdef __cplusplus
+  bool operator<(const struct GlmHitStruct& rhs) const {
+    if (ln_pval != rhs.ln_pval) {
+      return ln_pval < rhs.ln_pval;
+    }
+    if (variant_uidx != rhs.variant_uidx) {
+      return variant_uidx < rhs.variant_uidx;
+    }
+    return a1_allele_idx < rhs.a1_allele_idx;
+  }
+#endif
+} GlmHit;
+
+// hit heap capacity when only hits-p= is specified
+CONSTI32(kGlmHitsDefaultMaxCt, 1000000);
+
+static const char kGlmSumstatsMagic[8] = {'P', 'L', 'K', 'G', 'L', 'M', 'S', 'S'};
+CONSTI32(kGlmSumstatsVersion, 1);
+
+FLAGSET_DEF_START()
+  kfGlmSumstatsRecord0,
+  kfGlmSumstatsRecordJoint = (1 << 0)
+FLAGSET_DEF_END(GlmSumstatsRecordFlags);
+
+typedef struct GlmSumstatsRecordStruct {
+  uint32_t variant_uidx;
+  uint32_t bp;
+  uint16_t chr_code;
+  uint16_t a1_allele_idx;
+  uint32_t obs_ct;
+  // beta and se are zero for joint tests.
+  float beta;
+  float se;
+  float neglog10_p;
+  uint32_t flags;
+} GlmSumstatsRecord;
+
+static_assert(sizeof(GlmSumstatsRecord) == 32, "GlmSumstatsRecord must be 32 bytes.");
+
+typedef struct GlmHitsStruct {
+  NONCOPYABLE(GlmHitsStruct);
+  const uint32_t* variant_bps;
+  GlmHit* heap;
+  // zero when only the binary file was requested
+  uintptr_t capacity;
+  uintptr_t ct;
+  double ln_thresh;
+  // number of hits offered after the heap filled up; only reported when
+  // capacity_is_default is set, since hits= truncation is intentional
+  uintptr_t overflow_ct;
+  uint32_t capacity_is_default;
+
+  CompressStreamState bin_css;
+  // nullptr unless sumstats-bin was requested
+  char* bin_writep;
+} GlmHits;
+
 typedef struct GlmCtxStruct {
   const uintptr_t* variant_include;
   const ChrInfo* cip;
@@ -3468,6 +3933,20 @@ typedef struct GlmCtxStruct {
   RegressionNmPrecomp* nm_precomp_x;
   RegressionNmPrecomp* nm_precomp_y;
 
+  // --glm loco-ridge: offset row index for each chr_fo_idx.  Only applies to
+  // the main sample set; chrX/chrY segments with their own sample sets are
+  // analyzed without offsets.
+  const uint32_t* loco_chr_fo_slots;
+
+  // --glm checkpoint: journal filename (followed by the temporary filename),
+  // or nullptr if not checkpointing; and the number of leading variants
+  // already written by an earlier run.
+  const char* ckpt_fname;
+  uint32_t ckpt_skip_variant_ct;
+
+  // --glm hits=/hits-p=/sumstats-bin state, or nullptr.
+  GlmHits* hits;
+
   uint32_t cur_block_variant_ct;
 
   PgenReader** pgr_ptrs;
@@ -3477,6 +3956,11 @@ typedef struct GlmCtxStruct {
   Dosage** dosage_mains;
   uint32_t* read_variant_uidx_starts;
 
+  // Only allocated by --glm linear when the .pgen has no dosages; rare
+  // biallelic variants are then loaded as difflists.
+  uintptr_t** raregenos;
+  uint32_t** difflist_sample_id_bufs;
+
   unsigned char** workspace_bufs;
 
   double* block_beta_se;
@@ -3487,6 +3971,11 @@ typedef struct GlmCtxStruct {
 typedef struct GlmLogisticCtxStruct {
   GlmCtx *common;
 
+  // When subbatch_size > 1, pheno_cc/gcount_case_interleaved_vec (stride
+  // BitCtToVecCt(sample_ct) * kWordsPerVec words) and pheno_f (stride
+  // RoundUpPow2(sample_ct, kFloatPerFVec)) hold subbatch_size phenotypes
+  // back-to-back, and likewise for the chrX/chrY versions.
+  uint32_t subbatch_size;
   uintptr_t* pheno_cc;
   uintptr_t* pheno_x_cc;
   uintptr_t* pheno_y_cc;
@@ -3502,11 +3991,26 @@ typedef struct GlmLogisticCtxStruct {
   CcResidualizeCtx* cc_residualize;
   CcResidualizeCtx* cc_residualize_x;
   CcResidualizeCtx* cc_residualize_y;
+  LogisticScoreScreen* score_screen;
+  LogisticScoreScreen* score_screen_x;
+  LogisticScoreScreen* score_screen_y;
+  double score_screen_ln_thresh;
   uint16_t separation_found;
   uint16_t separation_found_x;
   uint16_t separation_found_y;
   float* local_covars_vcmaj_f[2];
   LogisticAuxResult* block_aux;
+  // --glm loco-ridge linear-predictor offsets, one zero-padded row of
+  // RoundUpPow2(sample_ct, kFloatPerFVec) floats per loco_chr_fo_slots value
+  const float* loco_offsets_f;
+  uint32_t loco_slot_ct;
+  // Null-model Firth coefficients (see FitFirthNullModels()), used as the
+  // Firth regression starting point when there are no --parameters, local
+  // covariates, or cc-residualize.  nullptr otherwise.  With loco-ridge,
+  // firth_null_coefs has one block per LOCO slot.
+  float* firth_null_coefs;
+  float* firth_null_coefs_x;
+  float* firth_null_coefs_y;
 } GlmLogisticCtx;
 
 THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
@@ -3553,6 +4057,8 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
   const uintptr_t max_reported_test_ct = common->max_reported_test_ct;
   const uintptr_t local_covar_ct = common->local_covar_ct;
   const uint32_t max_extra_allele_ct = common->max_extra_allele_ct;
+  const double score_screen_ln_thresh = ctx->score_screen_ln_thresh;
+  const uint32_t subbatch_size = ctx->subbatch_size;
   // bugfix (20 Mar 2020): Also need to exclude dominant/recessive.
   const uint32_t beta_se_multiallelic_fused = (!domdev_present) && (!model_dominant) && (!model_recessive) && (!common->tests_flag) && (!add_interactions);
   uintptr_t max_sample_ct = MAXV(common->sample_ct, common->sample_ct_x);
@@ -3585,12 +4091,12 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       allele_bidx = variant_bidx + CountExtraAlleles(variant_include, allele_idx_offsets, common->read_variant_uidx_starts[0], common->read_variant_uidx_starts[tidx], 0);
     }
     if (beta_se_multiallelic_fused) {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * variant_bidx]);
+      beta_se_iter = &(beta_se_iter[(2 * k1LU * subbatch_size) * max_reported_test_ct * variant_bidx]);
     } else {
-      beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct * allele_bidx]);
+      beta_se_iter = &(beta_se_iter[(2 * k1LU * subbatch_size) * max_reported_test_ct * allele_bidx]);
     }
 
-    LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx]);
+    LogisticAuxResult* block_aux_iter = &(ctx->block_aux[allele_bidx * subbatch_size]);
     const float* local_covars_iter = nullptr;
     if (local_covar_ct) {
       // &(nullptr[0]) is okay in C++, but undefined in C
@@ -3609,14 +4115,17 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       const uint32_t is_nonx_haploid = (!is_x) && IsSet(cip->haploid_mask, chr_idx);
       const uintptr_t* cur_sample_include;
       const uint32_t* cur_sample_include_cumulative_popcounts;
-      const uintptr_t* cur_pheno_cc;
-      const uintptr_t* cur_gcount_case_interleaved_vec;
-      const float* cur_pheno;
+      const uintptr_t* cur_pheno_cc_pmaj;
+      const uintptr_t* cur_gcount_case_interleaved_vec_pmaj;
+      const float* cur_pheno_pmaj;
       const RegressionNmPrecomp* nm_precomp;
       const float* cur_covars_cmaj;
       const uintptr_t* cur_parameter_subset;
       const uintptr_t* cur_joint_test_params;
       const CcResidualizeCtx* cur_cc_residualize;
+      const LogisticScoreScreen* cur_score_screen;
+      const float* cur_loco_offsets = nullptr;
+      const float* cur_firth_null_coefs;
       uint32_t cur_sample_ct;
       uint32_t cur_covar_ct;
       uint32_t cur_constraint_ct;
@@ -3624,14 +4133,16 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       if (is_y && common->sample_include_y) {
         cur_sample_include = common->sample_include_y;
         cur_sample_include_cumulative_popcounts = common->sample_include_y_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_y_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_y;
-        cur_pheno = ctx->pheno_y_f;
+        cur_pheno_cc_pmaj = ctx->pheno_y_cc;
+        cur_gcount_case_interleaved_vec_pmaj = ctx->gcount_case_interleaved_vec_y;
+        cur_pheno_pmaj = ctx->pheno_y_f;
         nm_precomp = common->nm_precomp_y;
         cur_covars_cmaj = ctx->covars_cmaj_y_f;
         cur_parameter_subset = common->parameter_subset_y;
         cur_joint_test_params = common->joint_test_params_y;
         cur_cc_residualize = ctx->cc_residualize_y;
+        cur_score_screen = ctx->score_screen_y;
+        cur_firth_null_coefs = ctx->firth_null_coefs_y;
         cur_sample_ct = common->sample_ct_y;
         cur_covar_ct = common->covar_ct_y;
         cur_constraint_ct = common->constraint_ct_y;
@@ -3639,14 +4150,16 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       } else if (is_x && common->sample_include_x) {
         cur_sample_include = common->sample_include_x;
         cur_sample_include_cumulative_popcounts = common->sample_include_x_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_x_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec_x;
-        cur_pheno = ctx->pheno_x_f;
+        cur_pheno_cc_pmaj = ctx->pheno_x_cc;
+        cur_gcount_case_interleaved_vec_pmaj = ctx->gcount_case_interleaved_vec_x;
+        cur_pheno_pmaj = ctx->pheno_x_f;
         nm_precomp = common->nm_precomp_x;
         cur_covars_cmaj = ctx->covars_cmaj_x_f;
         cur_parameter_subset = common->parameter_subset_x;
         cur_joint_test_params = common->joint_test_params_x;
         cur_cc_residualize = ctx->cc_residualize_x;
+        cur_score_screen = ctx->score_screen_x;
+        cur_firth_null_coefs = ctx->firth_null_coefs_x;
         cur_sample_ct = common->sample_ct_x;
         cur_covar_ct = common->covar_ct_x;
         cur_constraint_ct = common->constraint_ct_x;
@@ -3654,22 +4167,31 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       } else {
         cur_sample_include = common->sample_include;
         cur_sample_include_cumulative_popcounts = common->sample_include_cumulative_popcounts;
-        cur_pheno_cc = ctx->pheno_cc;
-        cur_gcount_case_interleaved_vec = ctx->gcount_case_interleaved_vec;
-        cur_pheno = ctx->pheno_f;
+        cur_pheno_cc_pmaj = ctx->pheno_cc;
+        cur_gcount_case_interleaved_vec_pmaj = ctx->gcount_case_interleaved_vec;
+        cur_pheno_pmaj = ctx->pheno_f;
         nm_precomp = common->nm_precomp;
         cur_covars_cmaj = ctx->covars_cmaj_f;
         cur_parameter_subset = common->parameter_subset;
         cur_joint_test_params = common->joint_test_params;
         cur_cc_residualize = ctx->cc_residualize;
+        cur_score_screen = ctx->score_screen;
+        cur_firth_null_coefs = ctx->firth_null_coefs;
         cur_sample_ct = common->sample_ct;
         cur_covar_ct = common->covar_ct;
         cur_constraint_ct = common->constraint_ct;
         cur_is_always_firth = is_always_firth || ctx->separation_found;
+        if (ctx->loco_offsets_f) {
+          const uintptr_t loco_slot = common->loco_chr_fo_slots[chr_fo_idx];
+          cur_loco_offsets = &(ctx->loco_offsets_f[loco_slot * RoundUpPow2(cur_sample_ct, kFloatPerFVec)]);
+          if (cur_firth_null_coefs) {
+            cur_firth_null_coefs = &(cur_firth_null_coefs[loco_slot * subbatch_size * RoundUpPow2(cur_covar_ct + 1, kFloatPerFVec)]);
+          }
+        }
       }
       const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
       const uint32_t sample_ctav = RoundUpPow2(cur_sample_ct, kFloatPerFVec);
-      const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
+      const uintptr_t pheno_cc_stride = BitCtToVecCt(cur_sample_ct) * kWordsPerVec;
       const uint32_t cur_biallelic_predictor_ct_base = 2 + domdev_present + cur_covar_ct * (1 + add_interactions * domdev_present_p1);
       uint32_t cur_biallelic_predictor_ct = cur_biallelic_predictor_ct_base;
       uint32_t literal_covar_ct = cur_covar_ct;
@@ -3733,7 +4255,7 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       uint64_t* machr2_dosage_ssqs = &(machr2_dosage_sums[max_extra_allele_ct + 2]);
       uint32_t* case_one_cts = nullptr;
       uint32_t* case_two_cts = nullptr;
-      if (cur_gcount_case_interleaved_vec && max_extra_allele_ct) {
+      if (cur_gcount_case_interleaved_vec_pmaj && max_extra_allele_ct) {
         case_one_cts = S_CAST(uint32_t*, arena_alloc_raw_rd((max_extra_allele_ct + 2) * sizeof(int32_t) * 2, &workspace_iter));
         case_two_cts = &(case_one_cts[max_extra_allele_ct + 2]);
       }
@@ -3754,6 +4276,8 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
       float* sample_offsets_buf = nullptr;
       if (cur_cc_residualize) {
         mean_centered_pmaj_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float) * (domdev_present_p1 + max_extra_allele_ct), &workspace_iter));
+      }
+      if (cur_cc_residualize || cur_loco_offsets) {
         sample_offsets_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
       }
 
@@ -3776,7 +4300,17 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
         // Rest of this matrix must be updated later, since cur_predictor_ct
         // changes at multiallelic variants.
       }
-      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr));
+      float* screen_geno_buf = nullptr;
+      float* screen_adj_geno_buf = nullptr;
+      float* screen_dotprod_buf = nullptr;
+      double* screen_coef_buf = nullptr;
+      if (cur_score_screen) {
+        screen_geno_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        screen_adj_geno_buf = S_CAST(float*, arena_alloc_raw_rd(sample_ctav * sizeof(float), &workspace_iter));
+        screen_dotprod_buf = S_CAST(float*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(float), &workspace_iter));
+        screen_coef_buf = S_CAST(double*, arena_alloc_raw_rd(cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+      }
+      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLogisticWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, cur_gcount_case_interleaved_vec_pmaj != nullptr, is_sometimes_firth, cur_cc_residualize != nullptr, cur_loco_offsets != nullptr, cur_score_screen != nullptr));
       const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
       const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
       const double* corr_inv = nullptr;
@@ -3834,975 +4368,1024 @@ THREAD_FUNC_DECL GlmLogisticThread(void* raw_arg) {
         if (omitted_alleles) {
           omitted_allele_idx = omitted_alleles[variant_uidx];
         }
-        // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
-        // g_bigstack instead of the thread stack.
-        uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
-        const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
-        ZeroWArr(allele_ctl, const_alleles);
-        const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
-        const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
-        const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kFloatPerFVec);
-        const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
-        // first predictor column: intercept
-        if (!prev_nm) {
-          FillFVec(nm_sample_ct, S_CAST(float, 1.0), nm_predictors_pmaj_buf);
-        }
-        // second predictor column: genotype
-        float* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-        if (main_mutated || main_omitted) {
-          genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
-        }
-        CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
-        const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
-        float* multi_start = nullptr;
-        if (!allele_ct_m2) {
-          if (omitted_allele_idx) {
-            GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
-            // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-            if (pgv.dosage_ct) {
-              BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
-            }
-            const uint32_t uii = genocounts[0];
-            genocounts[0] = genocounts[2];
-            genocounts[2] = uii;
-          }
-          uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
-          uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
-          if (!missing_ct) {
-            GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, genotype_vals);
-            if (pgv.dosage_ct) {
-              uintptr_t sample_idx_base = 0;
-              uintptr_t dosage_present_bits = pgv.dosage_present[0];
-              for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
-                const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
-                const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
-                // 32768 -> 2, 16384 -> 1, 0 -> 0
-                genotype_vals[sample_idx] = kRecipDosageMidf * u31tof(dosage_val);
-                dosage_sum += dosage_val;
-                dosage_ssq += dosage_val * dosage_val;
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
-                if (cur_geno && (cur_geno != 3)) {
-                  const uintptr_t prev_val = cur_geno * kDosageMid;
-                  dosage_sum -= prev_val;
-                  dosage_ssq -= prev_val * prev_val;
-                }
-              }
-            }
+        if ((!allele_ct_m2) && omitted_allele_idx) {
+          GenovecInvertUnsafe(cur_sample_ct, pgv.genovec);
+          // ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+          if (pgv.dosage_ct) {
+            BiallelicDosage16Invert(pgv.dosage_ct, pgv.dosage_main);
+          }
+          const uint32_t uii = genocounts[0];
+          genocounts[0] = genocounts[2];
+          genocounts[2] = uii;
+        }
+        // The genotype columns are re-expanded for each phenotype in the
+        // subbatch, since constant-allele removal and the multiallelic column
+        // swaps below modify them in place.
+        for (uint32_t pheno_idx = 0; pheno_idx != subbatch_size; ++pheno_idx) {
+          const uintptr_t* cur_pheno_cc = &(cur_pheno_cc_pmaj[pheno_idx * pheno_cc_stride]);
+          const uintptr_t* cur_gcount_case_interleaved_vec = nullptr;
+          if (cur_gcount_case_interleaved_vec_pmaj) {
+            cur_gcount_case_interleaved_vec = &(cur_gcount_case_interleaved_vec_pmaj[pheno_idx * pheno_cc_stride]);
+          }
+          const float* cur_pheno = &(cur_pheno_pmaj[pheno_idx * sample_ctav]);
+          const uint32_t cur_case_ct = PopcountWords(cur_pheno_cc, sample_ctl);
+          // Once sizeof(AlleleCode) > 1, we probably want to allocate this from
+          // g_bigstack instead of the thread stack.
+          uintptr_t const_alleles[DivUp(kPglMaxAlleleCt, kBitsPerWord)];
+          const uint32_t allele_ctl = DivUp(allele_ct, kBitsPerWord);
+          ZeroWArr(allele_ctl, const_alleles);
+          const uint32_t nm_sample_ct = cur_sample_ct - missing_ct;
+          const uint32_t nm_sample_ctl = BitCtToWordCt(nm_sample_ct);
+          const uint32_t nm_sample_ctav = RoundUpPow2(nm_sample_ct, kFloatPerFVec);
+          const uint32_t nm_sample_ct_rem = nm_sample_ctav - nm_sample_ct;
+          // first predictor column: intercept
+          if (!prev_nm) {
+            FillFVec(nm_sample_ct, S_CAST(float, 1.0), nm_predictors_pmaj_buf);
           } else {
-            if (!pgv.dosage_ct) {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, genotype_vals);
-            } else {
-              uintptr_t sample_midx_base = 0;
-              uintptr_t sample_nm_bits = sample_nm[0];
-              uint32_t dosage_idx = 0;
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
-                float cur_val;
-                if (IsSet(pgv.dosage_present, sample_midx)) {
-                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
-                  cur_val = kRecipDosageMidf * u31tof(dosage_val);
+            // The column was last filled for all cur_sample_ct samples, so its
+            // trailing elements must be re-zeroed when some are now missing.
+            ZeroFArr(nm_sample_ct_rem, &(nm_predictors_pmaj_buf[nm_sample_ct]));
+          }
+          // second predictor column: genotype
+          float* genotype_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+          if (main_mutated || main_omitted) {
+            genotype_vals = &(nm_predictors_pmaj_buf[expected_predictor_ct * nm_sample_ctav]);
+          }
+          CopyBitarrSubset(cur_pheno_cc, sample_nm, nm_sample_ct, pheno_cc_nm);
+          const uint32_t nm_case_ct = PopcountWords(pheno_cc_nm, nm_sample_ctl);
+          float* multi_start = nullptr;
+          if (!allele_ct_m2) {
+            uint64_t dosage_sum = (genocounts[1] + 2 * genocounts[2]) * 0x4000LLU;
+            uint64_t dosage_ssq = (genocounts[1] + 4LLU * genocounts[2]) * 0x10000000LLU;
+            if (!missing_ct) {
+              GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, genotype_vals);
+              if (pgv.dosage_ct) {
+                uintptr_t sample_idx_base = 0;
+                uintptr_t dosage_present_bits = pgv.dosage_present[0];
+                for (uint32_t dosage_idx = 0; dosage_idx != pgv.dosage_ct; ++dosage_idx) {
+                  const uintptr_t sample_idx = BitIter1(pgv.dosage_present, &sample_idx_base, &dosage_present_bits);
+                  const uint32_t dosage_val = pgv.dosage_main[dosage_idx];
+                  // 32768 -> 2, 16384 -> 1, 0 -> 0
+                  genotype_vals[sample_idx] = kRecipDosageMidf * u31tof(dosage_val);
                   dosage_sum += dosage_val;
                   dosage_ssq += dosage_val * dosage_val;
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_idx);
                   if (cur_geno && (cur_geno != 3)) {
                     const uintptr_t prev_val = cur_geno * kDosageMid;
                     dosage_sum -= prev_val;
                     dosage_ssq -= prev_val * prev_val;
                   }
-                } else {
-                  // cur_geno != 3 guaranteed
-                  cur_val = kSmallFloats[cur_geno];
                 }
-                genotype_vals[sample_idx] = cur_val;
               }
-            }
-          }
-          // Check for constant genotype column.
-          // (Technically, we should recheck later in the chrX no-sex-covariate
-          // --xchr-model 1 corner case.)
-          if (!pgv.dosage_ct) {
-            if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
-              // bugfix (28 Mar 2020): didn't set the bit that actually
-              // mattered last week...
-              const_alleles[0] = 3;
-            }
-          } else if (pgv.dosage_ct == nm_sample_ct) {
-            if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
-              const_alleles[0] = 3;
-            }
-          }
-          machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
-          machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
-          machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
-          machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc
-            STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
-            for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
-              cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
-            }
-          }
-        } else {
-          // multiallelic.
-          // Update (18 Mar 2020): If some but not all alleles have constant
-          // dosages, we remove just those alleles from the regressions;
-          // trim-alts is not necessary to see what's going on with the other
-          // alleles.  To reduce parsing complexity, the number of output lines
-          // is not affected by this; the ones corresponding to the constant
-          // alleles have NA values.
-
-          // dosage_ct == 0 temporarily guaranteed if we reach here.
-          assert(!pgv.dosage_ct);
-          multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
-          ZeroU64Arr(allele_ct, machr2_dosage_sums);
-          ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
-          // postpone multiply for now, since no multiallelic dosages
-          // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
-          // actual sums/ssqs later.
-          machr2_dosage_sums[0] = genocounts[1];
-          machr2_dosage_ssqs[0] = genocounts[0];
-          if (omitted_allele_idx) {
-            // Main genotype column starts as REF.
-            if (!missing_ct) {
-              GenoarrLookup16x4bx2(pgv.genovec, kSmallInvFloatPairs, nm_sample_ct, genotype_vals);
-            } else {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallInvFloats, cur_sample_ct, genotype_vals);
-            }
-          }
-          uint32_t rare_allele_ct = allele_ct_m2;
-          float* alt1_start = nullptr;
-          float* rarealt_start = multi_start;
-          if (omitted_allele_idx != 1) {
-            if (omitted_allele_idx) {
-              alt1_start = multi_start;
-              ZeroFArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
-              rarealt_start = &(rarealt_start[nm_sample_ctav]);
-              --rare_allele_ct;
             } else {
-              alt1_start = genotype_vals;
+              if (!pgv.dosage_ct) {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, genotype_vals);
+              } else {
+                uintptr_t sample_midx_base = 0;
+                uintptr_t sample_nm_bits = sample_nm[0];
+                uint32_t dosage_idx = 0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  const uintptr_t cur_geno = GetNyparrEntry(pgv.genovec, sample_midx);
+                  float cur_val;
+                  if (IsSet(pgv.dosage_present, sample_midx)) {
+                    const uint32_t dosage_val = pgv.dosage_main[dosage_idx++];
+                    cur_val = kRecipDosageMidf * u31tof(dosage_val);
+                    dosage_sum += dosage_val;
+                    dosage_ssq += dosage_val * dosage_val;
+                    if (cur_geno && (cur_geno != 3)) {
+                      const uintptr_t prev_val = cur_geno * kDosageMid;
+                      dosage_sum -= prev_val;
+                      dosage_ssq -= prev_val * prev_val;
+                    }
+                  } else {
+                    // cur_geno != 3 guaranteed
+                    cur_val = kSmallFloats[cur_geno];
+                  }
+                  genotype_vals[sample_idx] = cur_val;
+                }
+              }
             }
-            if (!missing_ct) {
-              GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, alt1_start);
-            } else {
-              GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, alt1_start);
+            // Check for constant genotype column.
+            // (Technically, we should recheck later in the chrX no-sex-covariate
+            // --xchr-model 1 corner case.)
+            if (!pgv.dosage_ct) {
+              if ((genocounts[0] == nm_sample_ct) || (genocounts[1] == nm_sample_ct) || (genocounts[2] == nm_sample_ct)) {
+                // bugfix (28 Mar 2020): didn't set the bit that actually
+                // mattered last week...
+                const_alleles[0] = 3;
+              }
+            } else if (pgv.dosage_ct == nm_sample_ct) {
+              if (DosageIsConstant(dosage_sum, dosage_ssq, nm_sample_ct)) {
+                const_alleles[0] = 3;
+              }
             }
-          }
-          ZeroFArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
-          if (pgv.patch_01_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_01_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
+            machr2_dosage_sums[1 - omitted_allele_idx] = dosage_sum;
+            machr2_dosage_ssqs[1 - omitted_allele_idx] = dosage_ssq;
+            machr2_dosage_sums[omitted_allele_idx] = kDosageMax * S_CAST(uint64_t, nm_sample_ct) - dosage_sum;
+            machr2_dosage_ssqs[omitted_allele_idx] = kDosageMax * (kDosageMax * S_CAST(uint64_t, nm_sample_ct) - 2 * dosage_sum) + dosage_ssq;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc
+              STD_ARRAY_REF(uint32_t, 6) cur_geno_hardcall_cts = block_aux_iter->geno_hardcall_cts;
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, R_CAST(STD_ARRAY_REF(uint32_t, 4), cur_geno_hardcall_cts));
+              for (uint32_t geno_hardcall_idx = 0; geno_hardcall_idx != 3; ++geno_hardcall_idx) {
+                cur_geno_hardcall_cts[3 + geno_hardcall_idx] = genocounts[geno_hardcall_idx] - cur_geno_hardcall_cts[geno_hardcall_idx];
+              }
             }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                alt1_start[sample_idx] = 0.0;
-                machr2_dosage_sums[allele_code] += 1;
+          } else {
+            // multiallelic.
+            // Update (18 Mar 2020): If some but not all alleles have constant
+            // dosages, we remove just those alleles from the regressions;
+            // trim-alts is not necessary to see what's going on with the other
+            // alleles.  To reduce parsing complexity, the number of output lines
+            // is not affected by this; the ones corresponding to the constant
+            // alleles have NA values.
+
+            // dosage_ct == 0 temporarily guaranteed if we reach here.
+            assert(!pgv.dosage_ct);
+            multi_start = &(nm_predictors_pmaj_buf[(expected_predictor_ct - allele_ct_m2) * nm_sample_ctav]);
+            ZeroU64Arr(allele_ct, machr2_dosage_sums);
+            ZeroU64Arr(allele_ct, machr2_dosage_ssqs);
+            // postpone multiply for now, since no multiallelic dosages
+            // Use sums as ones[] and ssqs as twos[] for rarealts; transform to
+            // actual sums/ssqs later.
+            machr2_dosage_sums[0] = genocounts[1];
+            machr2_dosage_ssqs[0] = genocounts[0];
+            if (omitted_allele_idx) {
+              // Main genotype column starts as REF.
+              if (!missing_ct) {
+                GenoarrLookup16x4bx2(pgv.genovec, kSmallInvFloatPairs, nm_sample_ct, genotype_vals);
+              } else {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallInvFloats, cur_sample_ct, genotype_vals);
+              }
+            }
+            uint32_t rare_allele_ct = allele_ct_m2;
+            float* alt1_start = nullptr;
+            float* rarealt_start = multi_start;
+            if (omitted_allele_idx != 1) {
+              if (omitted_allele_idx) {
+                alt1_start = multi_start;
+                ZeroFArr(nm_sample_ct_rem, &(alt1_start[nm_sample_ct]));
+                rarealt_start = &(rarealt_start[nm_sample_ctav]);
+                --rare_allele_ct;
+              } else {
+                alt1_start = genotype_vals;
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                machr2_dosage_sums[allele_code] += 1;
+              if (!missing_ct) {
+                GenoarrLookup16x4bx2(pgv.genovec, kSmallFloatPairs, nm_sample_ct, alt1_start);
+              } else {
+                GenoarrToFloatsRemoveMissing(pgv.genovec, kSmallFloats, cur_sample_ct, alt1_start);
               }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                alt1_start[sample_idx] = 0.0;
-                const uint32_t allele_code = pgv.patch_01_vals[uii];
-                machr2_dosage_sums[allele_code] += 1;
-                if (allele_code == omitted_allele_idx) {
-                  continue;
-                }
-                const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
-                rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
-              }
-            }
-          }
-          uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
-          if (pgv.patch_10_ct) {
-            const uintptr_t* patch_set_nm = pgv.patch_10_set;
-            if (missing_ct) {
-              CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
-              patch_set_nm = tmp_nm;
             }
-            uintptr_t sample_idx_base = 0;
-            uintptr_t cur_bits = patch_set_nm[0];
-            if (!omitted_allele_idx) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+            ZeroFArr(rare_allele_ct * nm_sample_ctav, rarealt_start);
+            if (pgv.patch_01_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_01_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_01_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
                   alt1_start[sample_idx] = 0.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
-                  } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
-                    alt1_start[sample_idx] = 0.0;
-                    machr2_dosage_sums[ac0] += 1;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  rarealt_start[(allele_code - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                  machr2_dosage_sums[allele_code] += 1;
+                }
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  alt1_start[sample_idx] = 0.0;
+                  const uint32_t allele_code = pgv.patch_01_vals[uii];
+                  machr2_dosage_sums[allele_code] += 1;
+                  if (allele_code == omitted_allele_idx) {
+                    continue;
                   }
+                  const uint32_t cur_col = allele_code - 2 - (allele_code > omitted_allele_idx);
+                  rarealt_start[cur_col * nm_sample_ctav + sample_idx] = 1.0;
                 }
               }
-            } else if (omitted_allele_idx == 1) {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
-                const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
-                  machr2_dosage_ssqs[ac0] += 1;
-                } else {
-                  rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
+            }
+            uintptr_t alt1_het_ct = genocounts[1] - pgv.patch_01_ct;
+            if (pgv.patch_10_ct) {
+              const uintptr_t* patch_set_nm = pgv.patch_10_set;
+              if (missing_ct) {
+                CopyBitarrSubset(pgv.patch_10_set, sample_nm, nm_sample_ct, tmp_nm);
+                patch_set_nm = tmp_nm;
+              }
+              uintptr_t sample_idx_base = 0;
+              uintptr_t cur_bits = patch_set_nm[0];
+              if (!omitted_allele_idx) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    alt1_start[sample_idx] = 0.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
-                    machr2_dosage_sums[ac0] += 1;
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      alt1_start[sample_idx] = 0.0;
+                      machr2_dosage_sums[ac0] += 1;
+                    }
                   }
                 }
-              }
-            } else {
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
-                const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
-                const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                if (ac0 == ac1) {
-                  machr2_dosage_ssqs[ac0] += 1;
-                  alt1_start[sample_idx] = 0.0;
-                  if (ac0 != omitted_allele_idx) {
-                    const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                    rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
-                  }
-                } else {
-                  machr2_dosage_sums[ac1] += 1;
-                  if (ac1 != omitted_allele_idx) {
-                    const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
-                    rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
-                  }
-                  if (ac0 == 1) {
-                    ++alt1_het_ct;
-                    alt1_start[sample_idx] = 1.0;
+              } else if (omitted_allele_idx == 1) {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
+                  const AlleleCode ac0 = pgv.patch_10_vals[2 * uii];
+                  const AlleleCode ac1 = pgv.patch_10_vals[2 * uii + 1];
+                  if (ac0 == ac1) {
+                    rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] = 2.0;
+                    machr2_dosage_ssqs[ac0] += 1;
                   } else {
-                    machr2_dosage_sums[ac0] += 1;
-                    alt1_start[sample_idx] = 0.0;
-                    if (ac0 != omitted_allele_idx) {
-                      const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
-                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                    rarealt_start[(ac1 - 2) * nm_sample_ctav + sample_idx] = 1.0;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac0 == 1) {
+                      ++alt1_het_ct;
+                    } else {
+                      rarealt_start[(ac0 - 2) * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      machr2_dosage_sums[ac0] += 1;
                     }
                   }
                 }
-              }
-            }
-          }
-          machr2_dosage_sums[1] = alt1_het_ct;
-          machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
-          if (cur_gcount_case_interleaved_vec) {
-            // gcountcc.  Need case-specific one_cts and two_cts for each
-            // allele.
-            STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
-            GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
-            ZeroU32Arr(allele_ct, case_one_cts);
-            ZeroU32Arr(allele_ct, case_two_cts);
-            uint32_t case_alt1_het_ct = case_hardcall_cts[1];
-            case_one_cts[0] = case_alt1_het_ct;
-            case_two_cts[0] = case_hardcall_cts[0];
-            if (pgv.patch_01_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_01_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
-                  const uint32_t allele_code = pgv.patch_01_vals[uii];
-                  case_one_cts[allele_code] += 1;
-                }
-              }
-              for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
-                case_alt1_het_ct -= case_one_cts[allele_idx];
-              }
-            }
-            uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
-            if (pgv.patch_10_ct) {
-              uintptr_t sample_widx = 0;
-              uintptr_t cur_bits = pgv.patch_10_set[0];
-              for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
-                const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
-                if (cur_pheno_cc[sample_widx] & lowbit) {
+              } else {
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t sample_idx = BitIter1(patch_set_nm, &sample_idx_base, &cur_bits);
                   const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
                   const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
-                  --case_alt1_hom_ct;
                   if (ac0 == ac1) {
-                    case_two_cts[ac0] += 1;
+                    machr2_dosage_ssqs[ac0] += 1;
+                    alt1_start[sample_idx] = 0.0;
+                    if (ac0 != omitted_allele_idx) {
+                      const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                      rarealt_start[ac0_col * nm_sample_ctav + sample_idx] = 2.0;
+                    }
                   } else {
-                    case_one_cts[ac1] += 1;
+                    machr2_dosage_sums[ac1] += 1;
+                    if (ac1 != omitted_allele_idx) {
+                      const uint32_t ac1_col = ac1 - 2 - (ac1 > omitted_allele_idx);
+                      rarealt_start[ac1_col * nm_sample_ctav + sample_idx] = 1.0;
+                    }
                     if (ac0 == 1) {
-                      ++case_alt1_het_ct;
+                      ++alt1_het_ct;
+                      alt1_start[sample_idx] = 1.0;
                     } else {
-                      case_one_cts[ac0] += 1;
+                      machr2_dosage_sums[ac0] += 1;
+                      alt1_start[sample_idx] = 0.0;
+                      if (ac0 != omitted_allele_idx) {
+                        const uint32_t ac0_col = ac0 - 2 - (ac0 > omitted_allele_idx);
+                        rarealt_start[ac0_col * nm_sample_ctav + sample_idx] += S_CAST(float, 1.0);
+                      }
                     }
                   }
                 }
               }
             }
-            case_one_cts[1] = case_alt1_het_ct;
-            case_two_cts[1] = case_alt1_hom_ct;
-            uint32_t nonomitted_allele_idx = 0;
-            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
+            machr2_dosage_sums[1] = alt1_het_ct;
+            machr2_dosage_ssqs[1] = genocounts[2] - pgv.patch_10_ct;
+            if (cur_gcount_case_interleaved_vec) {
+              // gcountcc.  Need case-specific one_cts and two_cts for each
+              // allele.
+              STD_ARRAY_DECL(uint32_t, 4, case_hardcall_cts);
+              GenoarrCountSubsetFreqs(pgv.genovec, cur_gcount_case_interleaved_vec, cur_sample_ct, cur_case_ct, case_hardcall_cts);
+              ZeroU32Arr(allele_ct, case_one_cts);
+              ZeroU32Arr(allele_ct, case_two_cts);
+              uint32_t case_alt1_het_ct = case_hardcall_cts[1];
+              case_one_cts[0] = case_alt1_het_ct;
+              case_two_cts[0] = case_hardcall_cts[0];
+              if (pgv.patch_01_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_01_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_01_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_01_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t allele_code = pgv.patch_01_vals[uii];
+                    case_one_cts[allele_code] += 1;
+                  }
+                }
+                for (uint32_t allele_idx = 2; allele_idx != allele_ct; ++allele_idx) {
+                  case_alt1_het_ct -= case_one_cts[allele_idx];
+                }
+              }
+              uint32_t case_alt1_hom_ct = case_hardcall_cts[2];
+              if (pgv.patch_10_ct) {
+                uintptr_t sample_widx = 0;
+                uintptr_t cur_bits = pgv.patch_10_set[0];
+                for (uint32_t uii = 0; uii != pgv.patch_10_ct; ++uii) {
+                  const uintptr_t lowbit = BitIter1y(pgv.patch_10_set, &sample_widx, &cur_bits);
+                  if (cur_pheno_cc[sample_widx] & lowbit) {
+                    const uint32_t ac0 = pgv.patch_10_vals[2 * uii];
+                    const uint32_t ac1 = pgv.patch_10_vals[2 * uii + 1];
+                    --case_alt1_hom_ct;
+                    if (ac0 == ac1) {
+                      case_two_cts[ac0] += 1;
+                    } else {
+                      case_one_cts[ac1] += 1;
+                      if (ac0 == 1) {
+                        ++case_alt1_het_ct;
+                      } else {
+                        case_one_cts[ac0] += 1;
+                      }
+                    }
+                  }
+                }
+              }
+              case_one_cts[1] = case_alt1_het_ct;
+              case_two_cts[1] = case_alt1_hom_ct;
+              uint32_t nonomitted_allele_idx = 0;
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                const uint32_t one_ct = machr2_dosage_sums[allele_idx];
+                const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
+                const uint32_t case_one_ct = case_one_cts[allele_idx];
+                const uint32_t case_two_ct = case_two_cts[allele_idx];
+                STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
+                dst[0] = nm_case_ct - case_one_ct - case_two_ct;
+                dst[1] = case_one_ct;
+                dst[2] = case_two_ct;
+                dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
+                dst[4] = one_ct - case_one_ct;
+                dst[5] = two_ct - case_two_ct;
+                ++nonomitted_allele_idx;
               }
-              const uint32_t one_ct = machr2_dosage_sums[allele_idx];
-              const uint32_t two_ct = machr2_dosage_ssqs[allele_idx];
-              const uint32_t case_one_ct = case_one_cts[allele_idx];
-              const uint32_t case_two_ct = case_two_cts[allele_idx];
-              STD_ARRAY_REF(uint32_t, 6) dst = block_aux_iter[nonomitted_allele_idx].geno_hardcall_cts;
-              dst[0] = nm_case_ct - case_one_ct - case_two_ct;
-              dst[1] = case_one_ct;
-              dst[2] = case_two_ct;
-              dst[3] = nm_sample_ct - one_ct - two_ct - dst[0];
-              dst[4] = one_ct - case_one_ct;
-              dst[5] = two_ct - case_two_ct;
-              ++nonomitted_allele_idx;
-            }
-          }
-          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-            const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
-            const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
-            machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
-            machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
-            if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
-              SetBit(allele_idx, const_alleles);
-            }
-          }
-        }
-        ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
-        // usually need to save some of {sample_obs_ct, allele_obs_ct,
-        // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
-        // skipped variants
-        // compute them all for now, could conditionally skip later
-        uint32_t allele_obs_ct = nm_sample_ct * 2;
-        uint32_t case_allele_obs_ct = nm_case_ct * 2;
-        if (!is_x) {
-          if (is_nonx_haploid) {
-            allele_obs_ct = nm_sample_ct;
-            case_allele_obs_ct = nm_case_ct;
-            // everything is on 0..1 scale, not 0..2
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              genotype_vals[sample_idx] *= S_CAST(float, 0.5);
-            }
-            const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
-            for (uint32_t uii = 0; uii != high_ct; ++uii) {
-              multi_start[uii] *= S_CAST(float, 0.5);
             }
-          }
-        } else {
-          CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
-          const uintptr_t* male_nm = tmp_nm;
-          const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
-          if (is_xchr_model_1) {
-            // special case: multiply male values by 0.5
-            uintptr_t sample_idx_base = 0;
-            uintptr_t male_nm_bits = male_nm[0];
-            for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
-              const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-              genotype_vals[sample_idx] *= S_CAST(float, 0.5);
-              // could insert multiallelic loop here isntead, but I'm guessing
-              // that's worse due to locality of writes?
+            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+              const uintptr_t one_ct = machr2_dosage_sums[allele_idx];
+              const uintptr_t two_ct = machr2_dosage_ssqs[allele_idx];
+              machr2_dosage_sums[allele_idx] = (one_ct + 2 * two_ct) * 0x4000LLU;
+              machr2_dosage_ssqs[allele_idx] = (one_ct + 4LLU * two_ct) * 0x10000000LLU;
+              if ((one_ct == nm_sample_ct) || (two_ct == nm_sample_ct) || ((!one_ct) && (!two_ct))) {
+                SetBit(allele_idx, const_alleles);
+              }
+            }
+          }
+          ZeroFArr(nm_sample_ct_rem, &(genotype_vals[nm_sample_ct]));
+          // usually need to save some of {sample_obs_ct, allele_obs_ct,
+          // a1_dosage, case_allele_obs_ct, a1_case_dosage, mach_r2 even for
+          // skipped variants
+          // compute them all for now, could conditionally skip later
+          uint32_t allele_obs_ct = nm_sample_ct * 2;
+          uint32_t case_allele_obs_ct = nm_case_ct * 2;
+          if (!is_x) {
+            if (is_nonx_haploid) {
+              allele_obs_ct = nm_sample_ct;
+              case_allele_obs_ct = nm_case_ct;
+              // everything is on 0..1 scale, not 0..2
+              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                genotype_vals[sample_idx] *= S_CAST(float, 0.5);
+              }
+              const uint32_t high_ct = nm_sample_ct * allele_ct_m2;
+              for (uint32_t uii = 0; uii != high_ct; ++uii) {
+                multi_start[uii] *= S_CAST(float, 0.5);
+              }
             }
-            for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-              float* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
-              sample_idx_base = 0;
-              male_nm_bits = male_nm[0];
+          } else {
+            CopyBitarrSubset(sex_male_collapsed, sample_nm, nm_sample_ct, tmp_nm);
+            const uintptr_t* male_nm = tmp_nm;
+            const uint32_t nm_male_ct = PopcountWords(male_nm, nm_sample_ctl);
+            if (is_xchr_model_1) {
+              // special case: multiply male values by 0.5
+              uintptr_t sample_idx_base = 0;
+              uintptr_t male_nm_bits = male_nm[0];
               for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
                 const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
-                cur_start[sample_idx] *= S_CAST(float, 0.5);
+                genotype_vals[sample_idx] *= S_CAST(float, 0.5);
+                // could insert multiallelic loop here isntead, but I'm guessing
+                // that's worse due to locality of writes?
+              }
+              for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                float* cur_start = &(multi_start[extra_allele_idx * nm_sample_ctav]);
+                sample_idx_base = 0;
+                male_nm_bits = male_nm[0];
+                for (uint32_t male_idx = 0; male_idx != nm_male_ct; ++male_idx) {
+                  const uintptr_t sample_idx = BitIter1(male_nm, &sample_idx_base, &male_nm_bits);
+                  cur_start[sample_idx] *= S_CAST(float, 0.5);
+                }
               }
+              allele_obs_ct -= nm_male_ct;
+              case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
             }
-            allele_obs_ct -= nm_male_ct;
-            case_allele_obs_ct -= PopcountWordsIntersect(pheno_cc_nm, male_nm, nm_sample_ctl);
           }
-        }
-        const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
-        uint32_t nonomitted_allele_idx = 0;
-        for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-          if (allele_idx == omitted_allele_idx) {
-            continue;
-          }
-
-          float* geno_col = genotype_vals;
-          if (allele_idx > (!omitted_allele_idx)) {
-            geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
-          }
-          double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
-          if (is_xchr_model_1) {
-            // ugh.
-            a1_dosage = 0.0;
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              a1_dosage += S_CAST(double, geno_col[sample_idx]);
-            }
-          } else {
-            if (is_nonx_haploid) {
-              a1_dosage *= 0.5;
+          const double mach_r2 = MultiallelicDiploidMachR2(machr2_dosage_sums, machr2_dosage_ssqs, nm_sample_ct, allele_ct);
+          uint32_t nonomitted_allele_idx = 0;
+          for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+            if (allele_idx == omitted_allele_idx) {
+              continue;
             }
-          }
-          a1_dosages[allele_idx] = a1_dosage;
 
-          // todo: shortcut if gcountcc computed and no dosages
-          double a1_case_dosage = 0.0;
-          uintptr_t sample_idx_base = 0;
-          uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
-          for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
-            const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
-            a1_case_dosage += S_CAST(double, geno_col[sample_idx]);
-          }
-          a1_case_dosages[allele_idx] = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
-          block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
-          if (!allele_ct_m2) {
-            // Need main_dosage_sum and main_dosage_ssq for now (probably move
-            // this computation in-place later).
+            float* geno_col = genotype_vals;
+            if (allele_idx > (!omitted_allele_idx)) {
+              geno_col = &(nm_predictors_pmaj_buf[(expected_predictor_ct - (allele_ct - allele_idx) + (allele_idx < omitted_allele_idx)) * nm_sample_ctav]);
+            }
+            double a1_dosage = u63tod(machr2_dosage_sums[allele_idx]) * kRecipDosageMid;
             if (is_xchr_model_1) {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = 0.0;
+              // ugh.
+              a1_dosage = 0.0;
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                const double cur_dosage = S_CAST(double, geno_col[sample_idx]);
-                main_dosage_ssq += cur_dosage * cur_dosage;
+                a1_dosage += S_CAST(double, geno_col[sample_idx]);
               }
             } else {
-              main_dosage_sum = a1_dosage;
-              main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
               if (is_nonx_haploid) {
-                main_dosage_ssq *= 0.25;
+                a1_dosage *= 0.5;
               }
             }
-          }
-          block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
+            a1_dosages[allele_idx] = a1_dosage;
 
-          // bugfix (4 Sep 2018): forgot to save this
-          block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
+            // todo: shortcut if gcountcc computed and no dosages
+            double a1_case_dosage = 0.0;
+            uintptr_t sample_idx_base = 0;
+            uintptr_t pheno_cc_nm_bits = pheno_cc_nm[0];
+            for (uint32_t uii = 0; uii != nm_case_ct; ++uii) {
+              const uintptr_t sample_idx = BitIter1(pheno_cc_nm, &sample_idx_base, &pheno_cc_nm_bits);
+              a1_case_dosage += S_CAST(double, geno_col[sample_idx]);
+            }
+            a1_case_dosages[allele_idx] = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].sample_obs_ct = nm_sample_ct;
+            block_aux_iter[nonomitted_allele_idx].allele_obs_ct = allele_obs_ct;
+            if (!allele_ct_m2) {
+              // Need main_dosage_sum and main_dosage_ssq for now (probably move
+              // this computation in-place later).
+              if (is_xchr_model_1) {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = 0.0;
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const double cur_dosage = S_CAST(double, geno_col[sample_idx]);
+                  main_dosage_ssq += cur_dosage * cur_dosage;
+                }
+              } else {
+                main_dosage_sum = a1_dosage;
+                main_dosage_ssq = u63tod(machr2_dosage_ssqs[allele_idx]) * kRecipDosageMidSq;
+                if (is_nonx_haploid) {
+                  main_dosage_ssq *= 0.25;
+                }
+              }
+            }
+            block_aux_iter[nonomitted_allele_idx].a1_dosage = a1_dosage;
 
-          block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
-          block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
-          block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
-          block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
-          ++nonomitted_allele_idx;
-        }
-        // Now free to skip the actual regression if there are too few samples,
-        // or omitted allele corresponds to a zero-variance genotype column.
-        // If another allele has zero variance but the omitted allele does not,
-        // we now salvage as many alleles as we can.
-        GlmErr glm_err = 0;
-        if (nm_sample_ct <= expected_predictor_ct) {
-          // reasonable for this to override CONST_ALLELE
-          glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
-        } else if (IsSet(const_alleles, omitted_allele_idx)) {
-          glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
-        }
-        if (glm_err) {
-          if (missing_ct) {
-            // covariates have not been copied yet, so we can't usually change
-            // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
-            // reason to optimize the zero-covariate case)
-            prev_nm = 0;
+            // bugfix (4 Sep 2018): forgot to save this
+            block_aux_iter[nonomitted_allele_idx].case_allele_obs_ct = case_allele_obs_ct;
+
+            block_aux_iter[nonomitted_allele_idx].a1_case_dosage = a1_case_dosage;
+            block_aux_iter[nonomitted_allele_idx].firth_fallback = 0;
+            block_aux_iter[nonomitted_allele_idx].is_unfinished = 0;
+            block_aux_iter[nonomitted_allele_idx].score_screened = 0;
+            block_aux_iter[nonomitted_allele_idx].mach_r2 = mach_r2;
+            ++nonomitted_allele_idx;
           }
-          uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-          if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-            reported_ct += allele_ct_m2;
+          // Now free to skip the actual regression if there are too few samples,
+          // or omitted allele corresponds to a zero-variance genotype column.
+          // If another allele has zero variance but the omitted allele does not,
+          // we now salvage as many alleles as we can.
+          GlmErr glm_err = 0;
+          if (nm_sample_ct <= expected_predictor_ct) {
+            // reasonable for this to override CONST_ALLELE
+            glm_err = SetGlmErr0(kGlmErrcodeSampleCtLtePredictorCt);
+          } else if (IsSet(const_alleles, omitted_allele_idx)) {
+            glm_err = SetGlmErr0(kGlmErrcodeConstOmittedAllele);
           }
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-              memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-              beta_se_iter[uii * 2 + 1] = -9.0;
+          if (glm_err) {
+            if (missing_ct) {
+              // covariates have not been copied yet, so we can't usually change
+              // prev_nm from 0 to 1 when missing_ct == 0 (and there's little
+              // reason to optimize the zero-covariate case)
+              prev_nm = 0;
             }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
-          }
-        } else {
-          {
-            double omitted_dosage = u63tod(allele_obs_ct);
-            double omitted_case_dosage = u63tod(case_allele_obs_ct);
-            for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-              if (allele_idx == omitted_allele_idx) {
-                continue;
-              }
-              omitted_dosage -= a1_dosages[allele_idx];
-              omitted_case_dosage -= a1_case_dosages[allele_idx];
+            uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+            if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+              reported_ct += allele_ct_m2;
             }
-            a1_dosages[omitted_allele_idx] = omitted_dosage;
-            a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
-          }
-          uint32_t parameter_uidx = 2 + domdev_present;
-          float* nm_predictors_pmaj_istart = nullptr;
-          // only need to do this part once per variant in multiallelic case
-          float* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
-          if (missing_ct || (!prev_nm)) {
-            // fill phenotype
-            uintptr_t sample_midx_base = 0;
-            uintptr_t sample_nm_bits = sample_nm[0];
-            for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-              const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-              nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
-            }
-            // bugfix (13 Oct 2017): must guarantee trailing phenotype values
-            // are valid (exact contents don't matter since they are multiplied
-            // by zero, but they can't be nan)
-            ZeroFArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
-
-            // fill covariates
-            for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
-              // strictly speaking, we don't need cur_covars_cmaj to be
-              // vector-aligned
-              if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
-                continue;
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                beta_se_iter[uii * 2 + 1] = -9.0;
               }
-              const float* cur_covar_col;
-              if (covar_idx < local_covar_ct) {
-                cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-              } else {
-                cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * sample_ctav]);
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+            }
+          } else if (cur_score_screen && (!allele_ct_m2) && LogisticScoreScreenVariant(genotype_vals, sample_nm, cur_covars_cmaj, cur_score_screen, cur_sample_ct, nm_sample_ct, score_screen_ln_thresh, screen_geno_buf, screen_adj_geno_buf, screen_dotprod_buf, screen_coef_buf, beta_se_iter)) {
+            // Score-test p-value didn't pass the screen, so the one-step
+            // estimate is reported instead of running the full regression.
+            block_aux_iter[0].score_screened = 1;
+            if (missing_ct) {
+              prev_nm = 0;
+            }
+            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+          } else {
+            {
+              double omitted_dosage = u63tod(allele_obs_ct);
+              double omitted_case_dosage = u63tod(case_allele_obs_ct);
+              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                if (allele_idx == omitted_allele_idx) {
+                  continue;
+                }
+                omitted_dosage -= a1_dosages[allele_idx];
+                omitted_case_dosage -= a1_case_dosages[allele_idx];
               }
-              sample_midx_base = 0;
-              sample_nm_bits = sample_nm[0];
+              a1_dosages[omitted_allele_idx] = omitted_dosage;
+              a1_case_dosages[omitted_allele_idx] = omitted_case_dosage;
+            }
+            uint32_t parameter_uidx = 2 + domdev_present;
+            float* nm_predictors_pmaj_istart = nullptr;
+            // only need to do this part once per variant in multiallelic case
+            float* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ctav * (parameter_uidx - main_omitted)]);
+            if (missing_ct || (!prev_nm) || (subbatch_size != 1)) {
+              // fill phenotype
+              uintptr_t sample_midx_base = 0;
+              uintptr_t sample_nm_bits = sample_nm[0];
               for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                 const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
+                nm_pheno_buf[sample_idx] = cur_pheno[sample_midx];
               }
-              ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+              // bugfix (13 Oct 2017): must guarantee trailing phenotype values
+              // are valid (exact contents don't matter since they are multiplied
+              // by zero, but they can't be nan)
+              ZeroFArr(nm_sample_ct_rem, &(nm_pheno_buf[nm_sample_ct]));
             }
-            nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
-            prev_nm = !missing_ct;
-          } else {
-            // bugfix (15 Aug 2018): this was not handling --parameters
-            // correctly when a covariate was only needed as part of an
-            // interaction
-            parameter_uidx += cur_covar_ct;
-            nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
-          }
-          const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
-          if (const_allele_ct) {
-            // Must delete constant-allele columns from nm_predictors_pmaj, and
-            // shift later columns back.
-            float* read_iter = genotype_vals;
-            float* write_iter = genotype_vals;
-            for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
-              if (read_allele_idx == omitted_allele_idx) {
-                continue;
+            const float* nm_sample_offsets = cur_loco_offsets;
+            if (cur_loco_offsets && missing_ct) {
+              uintptr_t sample_midx_base = 0;
+              uintptr_t sample_nm_bits = sample_nm[0];
+              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                sample_offsets_buf[sample_idx] = cur_loco_offsets[sample_midx];
               }
-              if (!IsSet(const_alleles, read_allele_idx)) {
-                if (write_iter != read_iter) {
-                  memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(float));
+              ZeroFArr(nm_sample_ct_rem, &(sample_offsets_buf[nm_sample_ct]));
+              nm_sample_offsets = sample_offsets_buf;
+            }
+            if (missing_ct || (!prev_nm)) {
+              // fill covariates
+              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx, ++parameter_uidx) {
+                // strictly speaking, we don't need cur_covars_cmaj to be
+                // vector-aligned
+                if (cur_parameter_subset && (!IsSet(cur_parameter_subset, parameter_uidx))) {
+                  continue;
                 }
-                if (write_iter == genotype_vals) {
-                  write_iter = multi_start;
+                const float* cur_covar_col;
+                if (covar_idx < local_covar_ct) {
+                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
                 } else {
-                  write_iter = &(write_iter[nm_sample_ctav]);
+                  cur_covar_col = &(cur_covars_cmaj[(covar_idx - local_covar_ct) * sample_ctav]);
                 }
-              }
-              if (read_iter == genotype_vals) {
-                read_iter = multi_start;
-              } else {
-                read_iter = &(read_iter[nm_sample_ctav]);
-              }
-            }
-          }
-          const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
-          const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kFloatPerFVec);
-          const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
-          uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
-          for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
-            float* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
-            float* domdev_vals = nullptr;
-            uint32_t is_unfinished = 0;
-            uint32_t is_residualized = 0;
-            // _stop instead of _ct since, in the residualized case, the
-            // intercept (predictor index 0) is not included; we iterate over
-            // the predictor indices in [1, _stop).
-            uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
-            uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
-            uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
-            uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
-            if (extra_regression_ct) {
-              if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
-                glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
-                goto GlmLogisticThread_skip_regression;
-              }
-              ++nonconst_extra_regression_idx;
-              if (nonconst_extra_regression_idx) {
-                float* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
-                for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
-                  float fxx = genotype_vals[uii];
-                  genotype_vals[uii] = swap_target[uii];
-                  swap_target[uii] = fxx;
+                uintptr_t sample_midx_base = 0;
+                uintptr_t sample_nm_bits = sample_nm[0];
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                  *nm_predictors_pmaj_iter++ = cur_covar_col[sample_midx];
                 }
+                ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
               }
-            }
-            if (main_omitted) {
-              // if main_mutated, this will be filled below
-              // if not, this aliases genotype_vals
-              main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
-            } else if (joint_genotypic || joint_hethom) {
-              // in hethom case, do this before clobbering genotype data
-              domdev_vals = &(main_vals[nm_sample_ctav]);
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                if (cur_genotype_val > S_CAST(float, 1.0)) {
-                  cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+              nm_predictors_pmaj_istart = nm_predictors_pmaj_iter;
+              prev_nm = !missing_ct;
+            } else {
+              // bugfix (15 Aug 2018): this was not handling --parameters
+              // correctly when a covariate was only needed as part of an
+              // interaction
+              parameter_uidx += cur_covar_ct;
+              nm_predictors_pmaj_istart = &(nm_predictors_pmaj_iter[literal_covar_ct * nm_sample_ctav]);
+            }
+            const uint32_t const_allele_ct = PopcountWords(const_alleles, allele_ctl);
+            if (const_allele_ct) {
+              // Must delete constant-allele columns from nm_predictors_pmaj, and
+              // shift later columns back.
+              float* read_iter = genotype_vals;
+              float* write_iter = genotype_vals;
+              for (uint32_t read_allele_idx = 0; read_allele_idx != allele_ct; ++read_allele_idx) {
+                if (read_allele_idx == omitted_allele_idx) {
+                  continue;
                 }
-                domdev_vals[sample_idx] = cur_genotype_val;
-              }
-              ZeroFArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
-            }
-            if (model_dominant) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                // 0..1..1
-                if (cur_genotype_val > S_CAST(float, 1.0)) {
-                  cur_genotype_val = 1.0;
+                if (!IsSet(const_alleles, read_allele_idx)) {
+                  if (write_iter != read_iter) {
+                    memcpy(write_iter, read_iter, nm_sample_ctav * sizeof(float));
+                  }
+                  if (write_iter == genotype_vals) {
+                    write_iter = multi_start;
+                  } else {
+                    write_iter = &(write_iter[nm_sample_ctav]);
+                  }
                 }
-                main_vals[sample_idx] = cur_genotype_val;
-              }
-            } else if (model_recessive || joint_hethom) {
-              for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                float cur_genotype_val = genotype_vals[sample_idx];
-                // 0..0..1
-                if (cur_genotype_val < S_CAST(float, 1.0)) {
-                  cur_genotype_val = 0.0;
+                if (read_iter == genotype_vals) {
+                  read_iter = multi_start;
                 } else {
-                  cur_genotype_val -= S_CAST(float, 1.0);
+                  read_iter = &(read_iter[nm_sample_ctav]);
+                }
+              }
+            }
+            const uint32_t cur_predictor_ct = expected_predictor_ct - const_allele_ct;
+            const uint32_t cur_predictor_ctav = RoundUpPow2(cur_predictor_ct, kFloatPerFVec);
+            const uint32_t cur_predictor_ctavp1 = cur_predictor_ctav + 1;
+            uint32_t nonconst_extra_regression_idx = UINT32_MAX;  // deliberate overflow
+            for (uint32_t extra_regression_idx = 0; extra_regression_idx <= extra_regression_ct; ++extra_regression_idx) {
+              float* main_vals = &(nm_predictors_pmaj_buf[nm_sample_ctav]);
+              float* domdev_vals = nullptr;
+              uint32_t is_unfinished = 0;
+              uint32_t is_residualized = 0;
+              // _stop instead of _ct since, in the residualized case, the
+              // intercept (predictor index 0) is not included; we iterate over
+              // the predictor indices in [1, _stop).
+              uint32_t cur_regressed_predictor_stop = cur_predictor_ct;
+              uint32_t cur_regressed_predictor_ctav = cur_predictor_ctav;
+              uint32_t cur_regressed_predictor_ctavp1 = cur_predictor_ctavp1;
+              uint32_t cur_biallelic_regressed_predictor_stop = cur_biallelic_predictor_ct;
+              if (extra_regression_ct) {
+                if (IsSet(const_alleles, extra_regression_idx + (extra_regression_idx >= omitted_allele_idx))) {
+                  glm_err = SetGlmErr0(kGlmErrcodeConstAllele);
+                  goto GlmLogisticThread_skip_regression;
+                }
+                ++nonconst_extra_regression_idx;
+                if (nonconst_extra_regression_idx) {
+                  float* swap_target = &(multi_start[(nonconst_extra_regression_idx - 1) * nm_sample_ctav]);
+                  for (uint32_t uii = 0; uii != nm_sample_ct; ++uii) {
+                    float fxx = genotype_vals[uii];
+                    genotype_vals[uii] = swap_target[uii];
+                    swap_target[uii] = fxx;
+                  }
                 }
-                main_vals[sample_idx] = cur_genotype_val;
               }
-            }
-
-            // fill interaction terms
-            if (add_interactions) {
-              nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
-              for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
-                const float* cur_covar_col;
-                if (covar_idx < local_covar_ct) {
-                  cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
-                } else {
-                  cur_covar_col = &(cur_covars_cmaj[covar_idx * sample_ctav]);
+              if (main_omitted) {
+                // if main_mutated, this will be filled below
+                // if not, this aliases genotype_vals
+                main_vals = &(nm_predictors_pmaj_buf[(cur_predictor_ct + main_mutated) * nm_sample_ctav]);
+              } else if (joint_genotypic || joint_hethom) {
+                // in hethom case, do this before clobbering genotype data
+                domdev_vals = &(main_vals[nm_sample_ctav]);
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  if (cur_genotype_val > S_CAST(float, 1.0)) {
+                    cur_genotype_val = S_CAST(float, 2.0) - cur_genotype_val;
+                  }
+                  domdev_vals[sample_idx] = cur_genotype_val;
                 }
-                if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
-                  uintptr_t sample_midx_base = 0;
-                  uintptr_t sample_nm_bits = sample_nm[0];
-                  for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
-                    const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                    *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
+                ZeroFArr(nm_sample_ct_rem, &(domdev_vals[nm_sample_ct]));
+              }
+              if (model_dominant) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..1..1
+                  if (cur_genotype_val > S_CAST(float, 1.0)) {
+                    cur_genotype_val = 1.0;
                   }
-                  ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                  main_vals[sample_idx] = cur_genotype_val;
                 }
-                ++parameter_uidx;
-                if (domdev_present) {
+              } else if (model_recessive || joint_hethom) {
+                for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                  float cur_genotype_val = genotype_vals[sample_idx];
+                  // 0..0..1
+                  if (cur_genotype_val < S_CAST(float, 1.0)) {
+                    cur_genotype_val = 0.0;
+                  } else {
+                    cur_genotype_val -= S_CAST(float, 1.0);
+                  }
+                  main_vals[sample_idx] = cur_genotype_val;
+                }
+              }
+
+              // fill interaction terms
+              if (add_interactions) {
+                nm_predictors_pmaj_iter = nm_predictors_pmaj_istart;
+                for (uint32_t covar_idx = 0; covar_idx != cur_covar_ct; ++covar_idx) {
+                  const float* cur_covar_col;
+                  if (covar_idx < local_covar_ct) {
+                    cur_covar_col = &(local_covars_iter[covar_idx * max_sample_ct]);
+                  } else {
+                    cur_covar_col = &(cur_covars_cmaj[covar_idx * sample_ctav]);
+                  }
                   if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
                     uintptr_t sample_midx_base = 0;
                     uintptr_t sample_nm_bits = sample_nm[0];
                     for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
                       const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
-                      *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      *nm_predictors_pmaj_iter++ = main_vals[sample_idx] * cur_covar_col[sample_midx];
                     }
                     ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
                   }
                   ++parameter_uidx;
+                  if (domdev_present) {
+                    if ((!cur_parameter_subset) || IsSet(cur_parameter_subset, parameter_uidx)) {
+                      uintptr_t sample_midx_base = 0;
+                      uintptr_t sample_nm_bits = sample_nm[0];
+                      for (uint32_t sample_idx = 0; sample_idx != nm_sample_ct; ++sample_idx) {
+                        const uintptr_t sample_midx = BitIter1(sample_nm, &sample_midx_base, &sample_nm_bits);
+                        *nm_predictors_pmaj_iter++ = domdev_vals[sample_idx] * cur_covar_col[sample_midx];
+                      }
+                      ZeromovFArr(nm_sample_ct_rem, &nm_predictors_pmaj_iter);
+                    }
+                    ++parameter_uidx;
+                  }
                 }
               }
-            }
-            if (corr_inv && prev_nm && (!allele_ct_m2)) {
-              uintptr_t start_pred_idx = 0;
-              if (!(model_dominant || model_recessive || joint_hethom)) {
-                start_pred_idx = domdev_present + 2;
-                semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
-                semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
-              }
-              if (cur_predictor_ct > start_pred_idx) {
-                ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
-                for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
-                }
-              }
-              if (domdev_present) {
-                ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
-                for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
-                  semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
-                }
-                semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
-              }
-              glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
-              if (glm_err) {
-                goto GlmLogisticThread_skip_regression;
-              }
-            } else {
-              glm_err = CheckMaxCorrAndVifF(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, max_corr, vif_thresh, predictor_dotprod_buf, dbl_2d_buf, inverse_corr_buf, inv_1d_buf);
-              if (glm_err) {
-                goto GlmLogisticThread_skip_regression;
-              }
-            }
-            ZeroFArr(cur_predictor_ctav, coef_return);
-            if (!cur_is_always_firth) {
-              // Does any genotype column have zero case or zero control
-              // dosage?  If yes, faster to skip logistic regression than
-              // wait for convergence failure.
-              for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                if (IsSet(const_alleles, allele_idx)) {
-                  continue;
+              if (corr_inv && prev_nm && (!allele_ct_m2)) {
+                uintptr_t start_pred_idx = 0;
+                if (!(model_dominant || model_recessive || joint_hethom)) {
+                  start_pred_idx = domdev_present + 2;
+                  semicomputed_biallelic_xtx[cur_predictor_ct] = main_dosage_sum;
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 1] = main_dosage_ssq;
                 }
-                const double tot_dosage = a1_dosages[allele_idx];
-                const double case_dosage = a1_case_dosages[allele_idx];
-                if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
-                  if (is_sometimes_firth) {
-                    goto GlmLogisticThread_firth_fallback;
+                if (cur_predictor_ct > start_pred_idx) {
+                  ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[nm_sample_ctav]), &(nm_predictors_pmaj_buf[start_pred_idx * nm_sample_ctav]), nm_sample_ct, nm_sample_ctav, cur_predictor_ct - start_pred_idx, &(predictor_dotprod_buf[start_pred_idx]));
+                  for (uint32_t uii = start_pred_idx; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
                   }
-                  glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
-                  goto GlmLogisticThread_skip_regression;
                 }
-              }
-              if (!cur_cc_residualize) {
-                if (LogisticRegression(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroFArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThread_firth_fallback;
+                if (domdev_present) {
+                  ColMajorFvectorMatrixMultiplyStrided(&(nm_predictors_pmaj_buf[2 * nm_sample_ctav]), nm_predictors_pmaj_buf, nm_sample_ct, nm_sample_ctav, cur_predictor_ct, predictor_dotprod_buf);
+                  for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
+                    semicomputed_biallelic_xtx[2 * cur_predictor_ct + uii] = S_CAST(double, predictor_dotprod_buf[uii]);
                   }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                  semicomputed_biallelic_xtx[cur_predictor_ct + 2] = semicomputed_biallelic_xtx[2 * cur_predictor_ct + 1];
+                }
+                glm_err = CheckMaxCorrAndVifNm(semicomputed_biallelic_xtx, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
+                if (glm_err) {
                   goto GlmLogisticThread_skip_regression;
                 }
               } else {
-                if (LogisticRegressionResidualized(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  if (is_sometimes_firth) {
-                    ZeroFArr(cur_predictor_ctav, coef_return);
-                    goto GlmLogisticThread_firth_fallback;
-                  }
-                  glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                glm_err = CheckMaxCorrAndVifF(&(nm_predictors_pmaj_buf[nm_sample_ctav]), cur_predictor_ct - 1, nm_sample_ct, nm_sample_ctav, max_corr, vif_thresh, predictor_dotprod_buf, dbl_2d_buf, inverse_corr_buf, inv_1d_buf);
+                if (glm_err) {
                   goto GlmLogisticThread_skip_regression;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
               }
-              // unlike FirthRegression(), hh_return isn't inverted yet, do
-              // that here
-              for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-                float* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
-                // ZeroFArr(cur_regressed_predictor_stop, gradient_buf);
-                // gradient_buf[pred_uidx] = 1.0;
-                // (y is gradient_buf, x is dcoef_buf)
-                // SolveLinearSystem(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
-                // that works, but doesn't exploit the sparsity of y
-
-                // hh_return does now have vector-aligned rows
-                ZeroFArr(pred_uidx, hh_inv_row);
-
-                float fxx = 1.0;
-                for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
-                  const float* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
-                  for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
-                    fxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+              ZeroFArr(cur_predictor_ctav, coef_return);
+              if (!cur_is_always_firth) {
+                // Does any genotype column have zero case or zero control
+                // dosage?  If yes, faster to skip logistic regression than
+                // wait for convergence failure.
+                for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                  if (IsSet(const_alleles, allele_idx)) {
+                    continue;
                   }
-                  hh_inv_row[row_idx] = fxx / ll_row[row_idx];
-                  fxx = 0.0;
-                }
-                for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
-                  fxx = hh_inv_row[--col_idx];
-                  float* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
-                  for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
-                    fxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                  const double tot_dosage = a1_dosages[allele_idx];
+                  const double case_dosage = a1_case_dosages[allele_idx];
+                  if ((case_dosage == 0.0) || (case_dosage == tot_dosage)) {
+                    if (is_sometimes_firth) {
+                      goto GlmLogisticThread_firth_fallback;
+                    }
+                    glm_err = SetGlmErr1(kGlmErrcodeSeparation, allele_idx);
+                    goto GlmLogisticThread_skip_regression;
                   }
-                  *hh_inv_row_iter = fxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
                 }
-              }
-            } else {
-              if (!is_always_firth) {
-              GlmLogisticThread_firth_fallback:
-                block_aux_iter[extra_regression_idx].firth_fallback = 1;
-                if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                    block_aux_iter[uii].firth_fallback = 1;
+                if (!cur_cc_residualize) {
+                  if (LogisticRegression(nm_pheno_buf, nm_predictors_pmaj_buf, nm_sample_offsets, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroFArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThread_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThread_skip_regression;
+                  }
+                } else {
+                  if (LogisticRegressionResidualized(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, cholesky_decomp_return, pp_buf, sample_variance_buf, hh_return, gradient_buf, dcoef_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    if (is_sometimes_firth) {
+                      ZeroFArr(cur_predictor_ctav, coef_return);
+                      goto GlmLogisticThread_firth_fallback;
+                    }
+                    glm_err = SetGlmErr0(kGlmErrcodeLogisticConvergeFail);
+                    goto GlmLogisticThread_skip_regression;
+                  }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
+                }
+                // unlike FirthRegression(), hh_return isn't inverted yet, do
+                // that here
+                for (uint32_t pred_uidx = is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                  float* hh_inv_row = &(hh_return[pred_uidx * cur_regressed_predictor_ctav]);
+                  // ZeroFArr(cur_regressed_predictor_stop, gradient_buf);
+                  // gradient_buf[pred_uidx] = 1.0;
+                  // (y is gradient_buf, x is dcoef_buf)
+                  // SolveLinearSystem(cholesky_decomp_return, &(gradient_buf[is_residualized]), cur_regressed_predictor_stop - is_residualized, &(hh_inv_row[is_residualized]));
+                  // that works, but doesn't exploit the sparsity of y
+
+                  // hh_return does now have vector-aligned rows
+                  ZeroFArr(pred_uidx, hh_inv_row);
+
+                  float fxx = 1.0;
+                  for (uint32_t row_idx = pred_uidx; row_idx != cur_regressed_predictor_stop; ++row_idx) {
+                    const float* ll_row = &(cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav]);
+                    for (uint32_t col_idx = pred_uidx; col_idx != row_idx; ++col_idx) {
+                      fxx -= ll_row[col_idx] * hh_inv_row[col_idx];
+                    }
+                    hh_inv_row[row_idx] = fxx / ll_row[row_idx];
+                    fxx = 0.0;
+                  }
+                  for (uint32_t col_idx = cur_regressed_predictor_stop; col_idx > is_residualized; ) {
+                    fxx = hh_inv_row[--col_idx];
+                    float* hh_inv_row_iter = &(hh_inv_row[cur_regressed_predictor_stop - 1]);
+                    for (uint32_t row_idx = cur_regressed_predictor_stop - 1; row_idx > col_idx; --row_idx) {
+                      fxx -= cholesky_decomp_return[row_idx * cur_regressed_predictor_ctav + col_idx] * (*hh_inv_row_iter--);
+                    }
+                    *hh_inv_row_iter = fxx / cholesky_decomp_return[col_idx * cur_regressed_predictor_ctavp1];
                   }
-                }
-              }
-              if (!cur_cc_residualize) {
-                if (FirthRegression(nm_pheno_buf, nm_predictors_pmaj_buf, nullptr, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, score_buf, tmpnxk_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThread_skip_regression;
                 }
               } else {
-                if (FirthRegressionResidualized(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, score_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
-                  goto GlmLogisticThread_skip_regression;
+                if (!is_always_firth) {
+                GlmLogisticThread_firth_fallback:
+                  block_aux_iter[extra_regression_idx].firth_fallback = 1;
+                  if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                    for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                      block_aux_iter[uii].firth_fallback = 1;
+                    }
+                  }
+                }
+                if (!cur_cc_residualize) {
+                  if (cur_firth_null_coefs) {
+                    // 'firth-warm-start': coef_return is zero here, and the
+                    // covariates follow the intercept, genotype, and domdev
+                    // columns.  Interaction and extra-allele betas stay zero.
+                    // FirthRegression() stops once the step is within its
+                    // tolerance, which is approached from a different side
+                    // than with a cold start, so results are not
+                    // bit-identical to the default.
+                    const float* cur_null_coefs = &(cur_firth_null_coefs[pheno_idx * RoundUpPow2(cur_covar_ct + 1, kFloatPerFVec)]);
+                    coef_return[0] = cur_null_coefs[0];
+                    memcpy(&(coef_return[2 + domdev_present]), &(cur_null_coefs[1]), cur_covar_ct * sizeof(float));
+                  }
+                  if (FirthRegression(nm_pheno_buf, nm_predictors_pmaj_buf, nm_sample_offsets, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, score_buf, tmpnxk_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThread_skip_regression;
+                  }
+                } else {
+                  if (FirthRegressionResidualized(nm_pheno_buf, nm_predictors_pmaj_buf, sample_nm, cur_cc_residualize, nm_sample_ct, cur_predictor_ct, coef_return, &is_unfinished, hh_return, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, pp_buf, sample_variance_buf, gradient_buf, dcoef_buf, score_buf, tmpnxk_buf, mean_centered_pmaj_buf, sample_offsets_buf)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeFirthConvergeFail);
+                    goto GlmLogisticThread_skip_regression;
+                  }
+                  is_residualized = 1;
+                  cur_regressed_predictor_stop = domdev_present + allele_ct;
+                  cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
+                  cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
+                  cur_biallelic_regressed_predictor_stop = domdev_present + 2;
                 }
-                is_residualized = 1;
-                cur_regressed_predictor_stop = domdev_present + allele_ct;
-                cur_regressed_predictor_ctav = RoundUpPow2(cur_regressed_predictor_stop, kFloatPerFVec);
-                cur_regressed_predictor_ctavp1 = cur_regressed_predictor_ctav + 1;
-                cur_biallelic_regressed_predictor_stop = domdev_present + 2;
-              }
-            }
-            // validParameters() check
-            for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const float hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
-              if ((hh_inv_diag_element < S_CAST(float, 1e-20)) || (!isfinite_f(hh_inv_diag_element))) {
-                glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                goto GlmLogisticThread_skip_regression;
               }
-              // use sample_variance_buf[] to store diagonal square roots
-              sample_variance_buf[pred_uidx] = sqrtf(hh_inv_diag_element);
-            }
-            if (!is_residualized) {
-              sample_variance_buf[0] = sqrtf(hh_return[0]);
-            }
-            for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
-              const float cur_hh_inv_diag_sqrt = S_CAST(float, 0.99999) * sample_variance_buf[pred_uidx];
-              const float* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
-              const float* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
-              for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
-                if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+              // validParameters() check
+              for (uint32_t pred_uidx = 1; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const float hh_inv_diag_element = hh_return[pred_uidx * cur_regressed_predictor_ctavp1];
+                if ((hh_inv_diag_element < S_CAST(float, 1e-20)) || (!isfinite_f(hh_inv_diag_element))) {
                   glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
                   goto GlmLogisticThread_skip_regression;
                 }
+                // use sample_variance_buf[] to store diagonal square roots
+                sample_variance_buf[pred_uidx] = sqrtf(hh_inv_diag_element);
               }
-            }
-            if (is_unfinished) {
-              block_aux_iter[extra_regression_idx].is_unfinished = 1;
-              if (allele_ct_m2 && beta_se_multiallelic_fused) {
-                for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
-                  block_aux_iter[uii].is_unfinished = 1;
-                }
+              if (!is_residualized) {
+                sample_variance_buf[0] = sqrtf(hh_return[0]);
               }
-            }
-            {
-              double* beta_se_iter2 = beta_se_iter;
-              for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
-                // In the multiallelic-fused case, if the first allele is
-                // constant, this writes the beta/se values for the first
-                // nonconstant, non-omitted allele where the results for the
-                // first allele belong.  We correct that at the end of this
-                // block.
-                *beta_se_iter2++ = S_CAST(double, coef_return[pred_uidx]);
-                *beta_se_iter2++ = S_CAST(double, sample_variance_buf[pred_uidx]);
+              for (uint32_t pred_uidx = 1 + is_residualized; pred_uidx != cur_regressed_predictor_stop; ++pred_uidx) {
+                const float cur_hh_inv_diag_sqrt = S_CAST(float, 0.99999) * sample_variance_buf[pred_uidx];
+                const float* hh_inv_row_iter = &(hh_return[pred_uidx * cur_regressed_predictor_ctav + is_residualized]);
+                const float* hh_inv_diag_sqrts_iter = &(sample_variance_buf[is_residualized]);
+                for (uint32_t pred_uidx2 = is_residualized; pred_uidx2 != pred_uidx; ++pred_uidx2) {
+                  if ((*hh_inv_row_iter++) > cur_hh_inv_diag_sqrt * (*hh_inv_diag_sqrts_iter++)) {
+                    glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
+                    goto GlmLogisticThread_skip_regression;
+                  }
+                }
               }
-              if (cur_constraint_ct) {
-                *beta_se_iter2++ = 0.0;
-
-                uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 1.0;
+              if (is_unfinished) {
+                block_aux_iter[extra_regression_idx].is_unfinished = 1;
+                if (allele_ct_m2 && beta_se_multiallelic_fused) {
+                  for (uint32_t uii = 1; uii != allele_ct - 1; ++uii) {
+                    block_aux_iter[uii].is_unfinished = 1;
+                  }
                 }
-                double chisq;
-                if (!LinearHypothesisChisqF(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_predictor_ct, cur_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, outer_buf)) {
-                  *beta_se_iter2++ = chisq;
-                } else {
-                  const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
-                  memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
-                  *beta_se_iter2++ = -9.0;
+              }
+              {
+                double* beta_se_iter2 = beta_se_iter;
+                for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
+                  // In the multiallelic-fused case, if the first allele is
+                  // constant, this writes the beta/se values for the first
+                  // nonconstant, non-omitted allele where the results for the
+                  // first allele belong.  We correct that at the end of this
+                  // block.
+                  *beta_se_iter2++ = S_CAST(double, coef_return[pred_uidx]);
+                  *beta_se_iter2++ = S_CAST(double, sample_variance_buf[pred_uidx]);
                 }
-                // next test may have different alt allele count
-                joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
-                for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
-                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
-                  cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 0.0;
+                if (cur_constraint_ct) {
+                  *beta_se_iter2++ = 0.0;
+
+                  uint32_t joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 1.0;
+                  }
+                  double chisq;
+                  if (!LinearHypothesisChisqF(coef_return, cur_constraints_con_major, hh_return, cur_constraint_ct, cur_predictor_ct, cur_predictor_ctav, &chisq, tmphxs_buf, h_transpose_buf, inner_buf, inverse_corr_buf, inv_1d_buf, dbl_2d_buf, outer_buf)) {
+                    *beta_se_iter2++ = chisq;
+                  } else {
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeRankDeficient);
+                    memcpy(&(beta_se_iter2[-1]), &glm_err2, 8);
+                    *beta_se_iter2++ = -9.0;
+                  }
+                  // next test may have different alt allele count
+                  joint_test_idx = AdvTo1Bit(cur_joint_test_params, 0);
+                  for (uint32_t uii = 1; uii != cur_constraint_ct; ++uii) {
+                    joint_test_idx = AdvTo1Bit(cur_joint_test_params, joint_test_idx + 1);
+                    cur_constraints_con_major[uii * cur_predictor_ct + joint_test_idx] = 0.0;
+                  }
                 }
-              }
-              if (!const_allele_ct) {
-                if (beta_se_multiallelic_fused || (!hide_covar)) {
-                  for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
-                    *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
-                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+                if (!const_allele_ct) {
+                  if (beta_se_multiallelic_fused || (!hide_covar)) {
+                    for (uint32_t extra_allele_idx = 0; extra_allele_idx != allele_ct_m2; ++extra_allele_idx) {
+                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_allele_idx]);
+                    }
+                  }
+                } else if (!beta_se_multiallelic_fused) {
+                  if (!hide_covar) {
+                    // Need to insert some {CONST_ALLELE, -9} entries.
+                    const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
+                    const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
+                    uint32_t extra_read_allele_idx = 0;
+                    for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                      if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
+                        continue;
+                      }
+                      if (IsSet(const_alleles, allele_idx)) {
+                        memcpy(beta_se_iter2, &glm_err2, 8);
+                        beta_se_iter2[1] = -9.0;
+                        beta_se_iter2 = &(beta_se_iter2[2]);
+                      } else {
+                        *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
+                        *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
+                        ++extra_read_allele_idx;
+                      }
+                    }
                   }
-                }
-              } else if (!beta_se_multiallelic_fused) {
-                if (!hide_covar) {
-                  // Need to insert some {CONST_ALLELE, -9} entries.
+                } else {
                   const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                  const uint32_t cur_raw_allele_idx = extra_regression_idx + (extra_regression_idx >= omitted_allele_idx);
-                  uint32_t extra_read_allele_idx = 0;
-                  for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                    if ((allele_idx == omitted_allele_idx) || (allele_idx == cur_raw_allele_idx)) {
-                      continue;
+                  // Special-case first nonconst allele since it's positioned
+                  // discontinuously, and its BETA/SE may already be correctly
+                  // filled.
+                  uint32_t allele_idx = omitted_allele_idx? 0 : 1;
+                  if (IsSet(const_alleles, allele_idx)) {
+                    memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
+                    beta_se_iter[2 * include_intercept + 1] = -9.0;
+                    allele_idx = AdvTo0Bit(const_alleles, 1);
+                    if (allele_idx == omitted_allele_idx) {
+                      allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
                     }
-                    if (IsSet(const_alleles, allele_idx)) {
+                    const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
+                    for (uint32_t uii = 0; uii != skip_ct; ++uii) {
                       memcpy(beta_se_iter2, &glm_err2, 8);
                       beta_se_iter2[1] = -9.0;
                       beta_se_iter2 = &(beta_se_iter2[2]);
-                    } else {
-                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
-                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_regressed_predictor_stop + extra_read_allele_idx]);
-                      ++extra_read_allele_idx;
                     }
+                    *beta_se_iter2++ = S_CAST(double, coef_return[1]);
+                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[1]);
                   }
-                }
-              } else {
-                const GlmErr glm_err2 = SetGlmErr0(kGlmErrcodeConstAllele);
-                // Special-case first nonconst allele since it's positioned
-                // discontinuously, and its BETA/SE may already be correctly
-                // filled.
-                uint32_t allele_idx = omitted_allele_idx? 0 : 1;
-                if (IsSet(const_alleles, allele_idx)) {
-                  memcpy(&(beta_se_iter[2 * include_intercept]), &glm_err2, 8);
-                  beta_se_iter[2 * include_intercept + 1] = -9.0;
-                  allele_idx = AdvTo0Bit(const_alleles, 1);
-                  if (allele_idx == omitted_allele_idx) {
-                    allele_idx = AdvTo0Bit(const_alleles, omitted_allele_idx + 1);
-                  }
-                  const uint32_t skip_ct = allele_idx - 1 - (allele_idx > omitted_allele_idx);
-                  for (uint32_t uii = 0; uii != skip_ct; ++uii) {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  ++allele_idx;
+                  uint32_t nonconst_allele_idx_m1 = 0;
+                  for (; allele_idx != allele_ct; ++allele_idx) {
+                    if (allele_idx == omitted_allele_idx) {
+                      continue;
+                    }
+                    if (!IsSet(const_alleles, allele_idx)) {
+                      *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
+                      *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
+                      ++nonconst_allele_idx_m1;
+                    } else {
+                      memcpy(beta_se_iter2, &glm_err2, 8);
+                      beta_se_iter2[1] = -9.0;
+                      beta_se_iter2 = &(beta_se_iter2[2]);
+                    }
                   }
-                  *beta_se_iter2++ = S_CAST(double, coef_return[1]);
-                  *beta_se_iter2++ = S_CAST(double, sample_variance_buf[1]);
                 }
-                ++allele_idx;
-                uint32_t nonconst_allele_idx_m1 = 0;
-                for (; allele_idx != allele_ct; ++allele_idx) {
-                  if (allele_idx == omitted_allele_idx) {
-                    continue;
+              }
+              while (0) {
+              GlmLogisticThread_skip_regression:
+                {
+                  uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
+                  if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
+                    reported_ct += allele_ct_m2;
                   }
-                  if (!IsSet(const_alleles, allele_idx)) {
-                    *beta_se_iter2++ = S_CAST(double, coef_return[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
-                    *beta_se_iter2++ = S_CAST(double, sample_variance_buf[cur_biallelic_predictor_ct + nonconst_allele_idx_m1]);
-                    ++nonconst_allele_idx_m1;
-                  } else {
-                    memcpy(beta_se_iter2, &glm_err2, 8);
-                    beta_se_iter2[1] = -9.0;
-                    beta_se_iter2 = &(beta_se_iter2[2]);
+                  for (uint32_t uii = 0; uii != reported_ct; ++uii) {
+                    memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
+                    beta_se_iter[uii * 2 + 1] = -9.0;
                   }
                 }
               }
+              beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
             }
-            while (0) {
-            GlmLogisticThread_skip_regression:
-              {
-                uint32_t reported_ct = reported_pred_uidx_biallelic_end + (cur_constraint_ct != 0) - reported_pred_uidx_start;
-                if (allele_ct_m2 && (beta_se_multiallelic_fused || (!hide_covar))) {
-                  reported_ct += allele_ct_m2;
-                }
-                for (uint32_t uii = 0; uii != reported_ct; ++uii) {
-                  memcpy(&(beta_se_iter[uii * 2]), &glm_err, 8);
-                  beta_se_iter[uii * 2 + 1] = -9.0;
-                }
-              }
-            }
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
           }
+          block_aux_iter = &(block_aux_iter[allele_ct - 1]);
         }
-        block_aux_iter = &(block_aux_iter[allele_ct - 1]);
         if (local_covars_iter) {
           local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
         }
@@ -5654,19 +6237,526 @@ PglErr ReadRfmix2Block(const GlmCtx* common, const uint32_t* variant_bps, const
   return kPglRetSuccess;
 }
 
+// --glm checkpoint journal, <output filename>.ckpt: a header line, then
+//   <variant ct> <sample ct> <completed variant ct> <output byte offset>
+// (tab-delimited).  It is replaced via rename() after each block of results
+// has been flushed, so it never refers to partially-written output.
+static const char kGlmCheckpointHeader[] = "#VARIANT_CT\tSAMPLE_CT\tDONE_CT\tBYTE_OFFSET\n";
+
+BoolErr TruncateFile(const char* fname, int64_t byte_ct) {
+#ifdef _WIN32
+  FILE* ff = fopen(fname, "r+b");
+  if (unlikely(!ff)) {
+    return 1;
+  }
+  const int32_t ii = _chsize_s(_fileno(ff), byte_ct);
+  return fclose(ff) || ii;
+#else
+  return (truncate(fname, byte_ct) != 0);
+#endif
+}
+
+// Sets up --glm checkpoint state for one output file.  With 'resume', an
+// earlier run's journal is read: its completed variants are removed from
+// common->variant_include (with common->subset_chr_fo_vidx_start rebuilt to
+// match), and the output file is truncated to the offset where they end.
+// *is_complete_ptr is set if nothing is left to do.
+PglErr GlmCheckpointInit(const char* outname, const ChrInfo* cip, uint32_t raw_variant_ct, uint32_t is_resume, GlmCtx* common, uint32_t* is_complete_ptr) {
+  FILE* infile = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    *is_complete_ptr = 0;
+    const uint32_t outname_slen = strlen(outname);
+    char* ckpt_fname;
+    if (unlikely(bigstack_alloc_c(2 * outname_slen + 16, &ckpt_fname))) {
+      goto GlmCheckpointInit_ret_NOMEM;
+    }
+    char* ckpt_tmp_fname = strcpya_k(memcpya(ckpt_fname, outname, outname_slen), ".ckpt");
+    *ckpt_tmp_fname++ = '\0';
+    strcpy_k(memcpya(ckpt_tmp_fname, ckpt_fname, outname_slen + 5), ".tmp");
+    common->ckpt_fname = ckpt_fname;
+    common->ckpt_skip_variant_ct = 0;
+    if (!is_resume) {
+      goto GlmCheckpointInit_ret_1;
+    }
+    infile = fopen(ckpt_fname, FOPEN_RB);
+    if (!infile) {
+      logprintfww("--glm resume: %s not found; starting %s from the beginning.\n", ckpt_fname, outname);
+      goto GlmCheckpointInit_ret_1;
+    }
+    const uint32_t header_slen = strlen(kGlmCheckpointHeader);
+    const uintptr_t byte_ct = fread_unlocked(g_textbuf, 1, kMaxMediumLine, infile);
+    if (unlikely(ferror_unlocked(infile))) {
+      goto GlmCheckpointInit_ret_READ_FAIL;
+    }
+    g_textbuf[byte_ct] = '\0';
+    uint32_t orig_variant_ct;
+    uint32_t orig_sample_ct;
+    uint32_t done_variant_ct;
+    uintptr_t fpos;
+    const char* read_iter = &(g_textbuf[header_slen]);
+    if (unlikely((byte_ct <= header_slen) || (!memequal(g_textbuf, kGlmCheckpointHeader, header_slen)) ||
+                 ScanmovUintDefcap(&read_iter, &orig_variant_ct) || (*read_iter++ != '\t') ||
+                 ScanmovUintDefcap(&read_iter, &orig_sample_ct) || (*read_iter++ != '\t') ||
+                 ScanmovUintDefcap(&read_iter, &done_variant_ct) || (*read_iter++ != '\t') ||
+                 ScanPosintptr(read_iter, &fpos))) {
+      snprintf(g_logbuf, kLogbufSize, "Error: Invalid --glm checkpoint journal %s .\n", ckpt_fname);
+      goto GlmCheckpointInit_ret_MALFORMED_INPUT_WW;
+    }
+    const uint32_t variant_ct = common->variant_ct;
+    if (unlikely((orig_variant_ct != variant_ct) || (orig_sample_ct != common->sample_ct) || (done_variant_ct > variant_ct))) {
+      snprintf(g_logbuf, kLogbufSize, "Error: --glm checkpoint journal %s was written by a run with different variant/sample filters.\n", ckpt_fname);
+      goto GlmCheckpointInit_ret_INCONSISTENT_INPUT_WW;
+    }
+    if (done_variant_ct == variant_ct) {
+      logprintfww("--glm resume: %s is already complete.\n", outname);
+      *is_complete_ptr = 1;
+      goto GlmCheckpointInit_ret_1;
+    }
+    if (unlikely(TruncateFile(outname, fpos))) {
+      logerrprintfww("Error: Failed to truncate %s for --glm resume.\n", outname);
+      goto GlmCheckpointInit_ret_WRITE_FAIL;
+    }
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    uintptr_t* remaining_variant_include;
+    if (unlikely(bigstack_alloc_w(raw_variant_ctl, &remaining_variant_include))) {
+      goto GlmCheckpointInit_ret_NOMEM;
+    }
+    memcpy(remaining_variant_include, common->variant_include, raw_variant_ctl * sizeof(intptr_t));
+    // clear the first done_variant_ct set bits
+    uintptr_t variant_uidx_base = 0;
+    uintptr_t cur_bits = remaining_variant_include[0];
+    for (uint32_t variant_idx = 0; variant_idx != done_variant_ct; ++variant_idx) {
+      const uint32_t variant_uidx = BitIter1(remaining_variant_include, &variant_uidx_base, &cur_bits);
+      ClearBit(variant_uidx, remaining_variant_include);
+    }
+    // The worker threads use subset_chr_fo_vidx_start[] to find chromosome
+    // boundaries in variant_idx space, so it must be relative to the remaining
+    // variants.
+    if (unlikely(AllocAndFillSubsetChrFoVidxStart(remaining_variant_include, cip, &(common->subset_chr_fo_vidx_start)))) {
+      goto GlmCheckpointInit_ret_NOMEM;
+    }
+    common->variant_include = remaining_variant_include;
+    common->variant_ct = variant_ct - done_variant_ct;
+    common->ckpt_skip_variant_ct = done_variant_ct;
+    logprintfww("--glm resume: %u/%u variant%s already processed for %s.\n", done_variant_ct, variant_ct, (variant_ct == 1)? "" : "s", outname);
+  }
+  while (0) {
+  GlmCheckpointInit_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  GlmCheckpointInit_ret_READ_FAIL:
+    reterr = kPglRetReadFail;
+    break;
+  GlmCheckpointInit_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  GlmCheckpointInit_ret_MALFORMED_INPUT_WW:
+    WordWrapB(0);
+    logerrputsb();
+    reterr = kPglRetMalformedInput;
+    break;
+  GlmCheckpointInit_ret_INCONSISTENT_INPUT_WW:
+    WordWrapB(0);
+    logerrputsb();
+    reterr = kPglRetInconsistentInput;
+    break;
+  }
+ GlmCheckpointInit_ret_1:
+  fclose_cond(infile);
+  return reterr;
+}
+
+// Flushes everything written so far (ending the current Zstd frame, if
+// applicable) and records it in the checkpoint journal.  done_variant_ct is
+// relative to the current run's variant_include.
+PglErr GlmCheckpointUpdate(const GlmCtx* common, uint32_t done_variant_ct, CompressStreamState* css_ptr, char** cswritepp) {
+  FILE* outfile = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    if (unlikely(CswriteEndFrame(css_ptr, cswritepp) || fflush(css_ptr->outfile))) {
+      goto GlmCheckpointUpdate_ret_WRITE_FAIL;
+    }
+    const int64_t fpos = ftello(css_ptr->outfile);
+    const uint32_t skip_variant_ct = common->ckpt_skip_variant_ct;
+    char* write_iter = strcpya(g_textbuf, kGlmCheckpointHeader);
+    write_iter = u32toa_x(skip_variant_ct + common->variant_ct, '\t', write_iter);
+    write_iter = u32toa_x(common->sample_ct, '\t', write_iter);
+    write_iter = u32toa_x(skip_variant_ct + done_variant_ct, '\t', write_iter);
+    write_iter = i64toa(fpos, write_iter);
+    AppendBinaryEoln(&write_iter);
+    const char* ckpt_fname = common->ckpt_fname;
+    const char* ckpt_tmp_fname = &(ckpt_fname[strlen(ckpt_fname) + 1]);
+    if (unlikely(fopen_checked(ckpt_tmp_fname, FOPEN_WB, &outfile))) {
+      goto GlmCheckpointUpdate_ret_OPEN_FAIL;
+    }
+    if (unlikely(fwrite_checked(g_textbuf, write_iter - g_textbuf, outfile) ||
+                 fclose_null(&outfile))) {
+      goto GlmCheckpointUpdate_ret_WRITE_FAIL;
+    }
+    if (unlikely(rename(ckpt_tmp_fname, ckpt_fname))) {
+      logerrprintfww("Error: Failed to rename %s to %s.\n", ckpt_tmp_fname, ckpt_fname);
+      goto GlmCheckpointUpdate_ret_WRITE_FAIL;
+    }
+  }
+  while (0) {
+  GlmCheckpointUpdate_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  GlmCheckpointUpdate_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+  fclose_cond(outfile);
+  return reterr;
+}
+
+// Appends the association to the binary file (if open), and offers it to the
+// hit heap.
+BoolErr GlmHitsAdd(uint32_t variant_uidx, uint32_t chr_idx, uint32_t a1_allele_idx, uint32_t obs_ct, uint32_t is_joint, double beta, double se, double ln_pval, GlmHits* hitsp) {
+  if (hitsp->bin_writep) {
+    GlmSumstatsRecord record;
+    record.variant_uidx = variant_uidx;
+    record.bp = hitsp->variant_bps[variant_uidx];
+    record.chr_code = chr_idx;
+    record.a1_allele_idx = a1_allele_idx;
+    record.obs_ct = obs_ct;
+    if (is_joint) {
+      record.beta = 0.0;
+      record.se = 0.0;
+      record.flags = kfGlmSumstatsRecordJoint;
+    } else {
+      record.beta = S_CAST(float, beta);
+      record.se = S_CAST(float, se);
+      record.flags = kfGlmSumstatsRecord0;
+    }
+    const double neglog10_p = (-kRecipLn10) * ln_pval;
+    record.neglog10_p = (neglog10_p < S_CAST(double, FLT_MAX))? S_CAST(float, neglog10_p) : FLT_MAX;
+    hitsp->bin_writep = memcpya(hitsp->bin_writep, &record, sizeof(GlmSumstatsRecord));
+    if (unlikely(Cswrite(&(hitsp->bin_css), &(hitsp->bin_writep)))) {
+      return 1;
+    }
+  }
+  // Negated comparison so that NaN p-values are never retained.
+  if ((!hitsp->capacity) || (!(ln_pval <= hitsp->ln_thresh))) {
+    return 0;
+  }
+  GlmHit cur_hit;
+  cur_hit.ln_pval = ln_pval;
+  cur_hit.beta = beta;
+  cur_hit.se = se;
+  cur_hit.variant_uidx = variant_uidx;
+  cur_hit.a1_allele_idx = a1_allele_idx;
+  cur_hit.obs_ct = obs_ct;
+  cur_hit.is_joint = is_joint;
+  GlmHit* heap = hitsp->heap;
+  const uintptr_t ct = hitsp->ct;
+  uintptr_t cur_idx;
+  if (ct == hitsp->capacity) {
+    ++hitsp->overflow_ct;
+    if (!(cur_hit < heap[0])) {
+      return 0;
+    }
+    // replace the worst retained hit, then sift down
+    cur_idx = 0;
+    while (1) {
+      uintptr_t child_idx = 2 * cur_idx + 1;
+      if (child_idx >= ct) {
+        break;
+      }
+      if ((child_idx + 1 < ct) && (heap[child_idx] < heap[child_idx + 1])) {
+        ++child_idx;
+      }
+      if (!(cur_hit < heap[child_idx])) {
+        break;
+      }
+      heap[cur_idx] = heap[child_idx];
+      cur_idx = child_idx;
+    }
+  } else {
+    cur_idx = ct;
+    while (cur_idx) {
+      const uintptr_t parent_idx = (cur_idx - 1) / 2;
+      if (!(heap[parent_idx] < cur_hit)) {
+        break;
+      }
+      heap[cur_idx] = heap[parent_idx];
+      cur_idx = parent_idx;
+    }
+    hitsp->ct = ct + 1;
+  }
+  heap[cur_idx] = cur_hit;
+  return 0;
+}
+
+// Allocates the hit heap and opens <outname>.sumstats.bin[.zst], if
+// requested.  outname must currently end in the main output filename;
+// outname_end2 points to its (possible) .zst suffix, and is restored before
+// returning.
+PglErr GlmHitsStart(const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const uint32_t* variant_bps, const GlmInfo* glm_info_ptr, uint32_t raw_variant_ct, uint32_t variant_ct, char* outname, char* outname_end2, GlmHits* hitsp) {
+  PglErr reterr = kPglRetSuccess;
+  {
+    const GlmFlags glm_flags = glm_info_ptr->flags;
+    hitsp->variant_bps = variant_bps;
+    hitsp->heap = nullptr;
+    hitsp->capacity = 0;
+    hitsp->ct = 0;
+    hitsp->ln_thresh = glm_info_ptr->hits_ln_thresh;
+    hitsp->overflow_ct = 0;
+    hitsp->capacity_is_default = 0;
+    hitsp->bin_writep = nullptr;
+    if (glm_flags & kfGlmHits) {
+      uintptr_t capacity = variant_ct + CountExtraAlleles(variant_include, allele_idx_offsets, 0, raw_variant_ct, 0);
+      const uint32_t hits_max_ct = glm_info_ptr->hits_max_ct;
+      if (hits_max_ct) {
+        if (hits_max_ct < capacity) {
+          capacity = hits_max_ct;
+        }
+      } else {
+        // hits-p= alone: keep memory bounded regardless of the test count
+        if (capacity > kGlmHitsDefaultMaxCt) {
+          capacity = kGlmHitsDefaultMaxCt;
+          hitsp->capacity_is_default = 1;
+        }
+      }
+      if (unlikely(BIGSTACK_ALLOC_X(GlmHit, capacity, &(hitsp->heap)))) {
+        goto GlmHitsStart_ret_NOMEM;
+      }
+      hitsp->capacity = capacity;
+    }
+    if (glm_flags & kfGlmSumstatsBin) {
+      const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+      char* fname_iter = strcpya_k(outname_end2, ".sumstats.bin");
+      if (output_zst) {
+        snprintf(fname_iter, 22, ".zst");
+      } else {
+        *fname_iter = '\0';
+      }
+      reterr = InitCstreamAlloc(outname, 0, output_zst, 1, kCompressStreamBlock + kCacheline, &(hitsp->bin_css), &(hitsp->bin_writep));
+      if (output_zst) {
+        snprintf(outname_end2, 22, ".zst");
+      } else {
+        *outname_end2 = '\0';
+      }
+      if (unlikely(reterr)) {
+        goto GlmHitsStart_ret_1;
+      }
+      // .sumstats.bin layout: a 16-byte header (magic, format version,
+      // record size), followed by one fixed-width native-endian
+      // GlmSumstatsRecord per primary test in output order.  When the file is
+      // uncompressed, record i starts at byte 16 + 32 * i, so it can be
+      // memory-mapped directly.
+      char* write_iter = memcpya(hitsp->bin_writep, kGlmSumstatsMagic, 8);
+      const uint32_t header_u32s[2] = {kGlmSumstatsVersion, sizeof(GlmSumstatsRecord)};
+      hitsp->bin_writep = memcpya(write_iter, header_u32s, 8);
+    }
+  }
+  while (0) {
+  GlmHitsStart_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  }
+ GlmHitsStart_ret_1:
+  return reterr;
+}
+
+// Closes the .sumstats.bin file, then sorts the retained hits and writes
+// them to <outname without .zst>.hits[.zst].
+PglErr GlmHitsFinish(const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, GlmFlags glm_flags, uint32_t report_odds_ratio, double output_min_ln, uintptr_t overflow_buf_size, char* outname, char* outname_end2, GlmHits* hitsp) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  CompressStreamState css;
+  char* cswritep = nullptr;
+  PreinitCstream(&css);
+  {
+    const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+    if (hitsp->bin_writep) {
+      char* bin_writep = hitsp->bin_writep;
+      hitsp->bin_writep = nullptr;
+      if (unlikely(CswriteCloseNull(&(hitsp->bin_css), bin_writep))) {
+        goto GlmHitsFinish_ret_WRITE_FAIL;
+      }
+      char* fname_iter = strcpya_k(outname_end2, ".sumstats.bin");
+      if (output_zst) {
+        snprintf(fname_iter, 22, ".zst");
+      }
+      logprintfww("Binary summary statistics written to %s .\n", outname);
+    }
+    if (!hitsp->capacity) {
+      goto GlmHitsFinish_ret_1;
+    }
+    GlmHit* hits = hitsp->heap;
+    const uintptr_t hit_ct = hitsp->ct;
+    STD_SORT(hit_ct, double_cmp, hits);
+    char* fname_iter = strcpya_k(outname_end2, ".hits");
+    if (output_zst) {
+      snprintf(fname_iter, 22, ".zst");
+    } else {
+      *fname_iter = '\0';
+    }
+    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    if (unlikely(reterr)) {
+      goto GlmHitsFinish_ret_1;
+    }
+    const uint32_t report_neglog10p = (glm_flags / kfGlmLog10) & 1;
+    cswritep = strcpya_k(cswritep, "#CHROM\tPOS\tID\tREF\tALT\tA1\tOBS_CT\t");
+    if (report_odds_ratio) {
+      cswritep = strcpya_k(cswritep, "OR\tLOG(OR)_SE\t");
+    } else {
+      cswritep = strcpya_k(cswritep, "BETA\tSE\t");
+    }
+    if (report_neglog10p) {
+      cswritep = strcpya_k(cswritep, "LOG10_");
+    }
+    *cswritep++ = 'P';
+    AppendBinaryEoln(&cswritep);
+    for (uintptr_t hit_idx = 0; hit_idx != hit_ct; ++hit_idx) {
+      const GlmHit* cur_hit = &(hits[hit_idx]);
+      const uint32_t variant_uidx = cur_hit->variant_uidx;
+      cswritep = chrtoa(cip, GetVariantChr(cip, variant_uidx), cswritep);
+      *cswritep++ = '\t';
+      cswritep = u32toa_x(variant_bps[variant_uidx], '\t', cswritep);
+      cswritep = strcpyax(cswritep, variant_ids[variant_uidx], '\t');
+      uintptr_t allele_idx_offset_base = variant_uidx * 2;
+      uint32_t allele_ct = 2;
+      if (allele_idx_offsets) {
+        allele_idx_offset_base = allele_idx_offsets[variant_uidx];
+        allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
+      }
+      const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+      cswritep = strcpyax(cswritep, cur_alleles[0], '\t');
+      for (uint32_t allele_idx = 1; allele_idx != allele_ct; ++allele_idx) {
+        if (unlikely(Cswrite(&css, &cswritep))) {
+          goto GlmHitsFinish_ret_WRITE_FAIL;
+        }
+        cswritep = strcpyax(cswritep, cur_alleles[allele_idx], ',');
+      }
+      cswritep[-1] = '\t';
+      cswritep = strcpyax(cswritep, cur_alleles[cur_hit->a1_allele_idx], '\t');
+      cswritep = u32toa_x(cur_hit->obs_ct, '\t', cswritep);
+      if (cur_hit->is_joint) {
+        cswritep = strcpya_k(cswritep, "NA\tNA\t");
+      } else {
+        cswritep = dtoa_g(report_odds_ratio? exp(cur_hit->beta) : cur_hit->beta, cswritep);
+        *cswritep++ = '\t';
+        cswritep = dtoa_g(cur_hit->se, cswritep);
+        *cswritep++ = '\t';
+      }
+      const double ln_pval = MAXV(cur_hit->ln_pval, output_min_ln);
+      if (report_neglog10p) {
+        cswritep = dtoa_g((-kRecipLn10) * ln_pval, cswritep);
+      } else {
+        cswritep = lntoa_g(ln_pval, cswritep);
+      }
+      AppendBinaryEoln(&cswritep);
+      if (unlikely(Cswrite(&css, &cswritep))) {
+        goto GlmHitsFinish_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(CswriteCloseNull(&css, cswritep))) {
+      goto GlmHitsFinish_ret_WRITE_FAIL;
+    }
+    logprintfww("%" PRIuPTR " top hit%s written to %s .\n", hit_ct, (hit_ct == 1)? "" : "s", outname);
+    if (hitsp->capacity_is_default && hitsp->overflow_ct) {
+      logerrprintfww("Warning: More than %u associations passed the --glm hits-p= threshold; only the strongest %u were retained.  Add 'hits=' to change this limit.\n", kGlmHitsDefaultMaxCt, kGlmHitsDefaultMaxCt);
+    }
+  }
+  while (0) {
+  GlmHitsFinish_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+ GlmHitsFinish_ret_1:
+  CswriteCloseCond(&css, cswritep);
+  // restore main output filename
+  if (glm_flags & kfGlmZs) {
+    snprintf(outname_end2, 22, ".zst");
+  } else {
+    *outname_end2 = '\0';
+  }
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+// Fits the covariate-only Firth model for each subbatch member, so that every
+// per-variant Firth regression can start from the null-model intercept and
+// covariate betas instead of zero.  Coefficients are saved with stride
+// RoundUpPow2(covar_ct + 1, kFloatPerFVec); a member whose fit fails gets
+// all-zero coefficients (i.e. the old cold start).
+// If sample_offsets is non-null, it holds offset_ct zero-padded rows of
+// linear-predictor offsets (the --glm loco-ridge layout), and the null model
+// is fitted once per row, with member pheno_idx of row offset_idx at
+// position offset_idx * subbatch_size + pheno_idx.
+BoolErr FitFirthNullModels(const float* pheno_f, const float* covars_cmaj_f, const float* sample_offsets, uint32_t sample_ct, uint32_t covar_ct, uint32_t subbatch_size, uint32_t offset_ct, float** null_coefs_ptr) {
+  const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+  const uintptr_t pred_ct = covar_ct + 1;
+  const uintptr_t pred_ctav = RoundUpPow2(pred_ct, kFloatPerFVec);
+  if (!sample_offsets) {
+    offset_ct = 1;
+  }
+  if (unlikely(bigstack_calloc_f(pred_ctav * subbatch_size * offset_ct, null_coefs_ptr))) {
+    return 1;
+  }
+  unsigned char* bigstack_mark = g_bigstack_base;
+  float* xx;
+  float* hh;
+  double* half_inverted_buf;
+  double* dbl_2d_buf;
+  float* pp;
+  float* vv;
+  float* grad;
+  float* dcoef;
+  float* ww;
+  float* tmpnxk_buf;
+  MatrixInvertBuf1* inv_1d_buf = S_CAST(MatrixInvertBuf1*, bigstack_alloc(pred_ct * kMatrixInvertBuf1CheckedAlloc));
+  if (unlikely((!inv_1d_buf) ||
+               bigstack_alloc_f(sample_ctav * pred_ct, &xx) ||
+               bigstack_alloc_f(pred_ct * pred_ctav, &hh) ||
+               bigstack_alloc_d(pred_ct * MAXV(pred_ct, 3), &half_inverted_buf) ||
+               bigstack_alloc_d(pred_ct * MAXV(pred_ct, 7), &dbl_2d_buf) ||
+               bigstack_alloc_f(sample_ctav, &pp) ||
+               bigstack_alloc_f(sample_ctav, &vv) ||
+               bigstack_alloc_f(pred_ctav, &grad) ||
+               bigstack_alloc_f(pred_ctav, &dcoef) ||
+               bigstack_alloc_f(sample_ctav, &ww) ||
+               bigstack_alloc_f(sample_ctav * pred_ct, &tmpnxk_buf))) {
+    return 1;
+  }
+  FillFVec(sample_ct, 1.0, xx);
+  memcpy(&(xx[sample_ctav]), covars_cmaj_f, sample_ctav * covar_ct * sizeof(float));
+  for (uint32_t offset_idx = 0; offset_idx != offset_ct; ++offset_idx) {
+    const float* cur_sample_offsets = sample_offsets? (&(sample_offsets[offset_idx * sample_ctav])) : nullptr;
+    for (uint32_t pheno_idx = 0; pheno_idx != subbatch_size; ++pheno_idx) {
+      float* cur_null_coefs = &((*null_coefs_ptr)[(offset_idx * subbatch_size + pheno_idx) * pred_ctav]);
+      uint32_t is_unfinished = 0;
+      if (FirthRegression(&(pheno_f[pheno_idx * sample_ctav]), xx, cur_sample_offsets, sample_ct, pred_ct, cur_null_coefs, &is_unfinished, hh, half_inverted_buf, inv_1d_buf, dbl_2d_buf, pp, vv, grad, dcoef, ww, tmpnxk_buf) || is_unfinished) {
+        ZeroFArr(pred_ctav, cur_null_coefs);
+      }
+    }
+  }
+  BigstackReset(bigstack_mark);
+  return 0;
+}
+
 // only pass the parameters which aren't also needed by the compute threads,
 // for now
 // valid_variants and valid_alleles are a bit redundant, may want to remove the
 // former later, but let's make that decision during/after permutation test
 // implementation
-PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, const char* const* test_names_x, const char* const* test_names_y, const uint32_t* variant_bps, const char* const* variant_ids, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const uint32_t* local_sample_uidx_order, const uintptr_t* local_variant_include, const char* outname, uint32_t raw_variant_ct, uint32_t max_chr_blen, double ci_size, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, uintptr_t overflow_buf_size, uint32_t local_sample_ct, PgenFileInfo* pgfip, GlmLogisticCtx* ctx, TextStream* local_covar_txsp, uintptr_t* valid_variants, uintptr_t* valid_alleles, double* orig_ln_pvals, double* orig_permstat, uintptr_t* valid_allele_ct_ptr) {
+// Each phenotype in a subbatch has its own open output file.
+CONSTI32(kMaxLogisticSubbatchSize, 64);
+static_assert(kMaxLogisticSubbatchSize + 12 <= kMaxOpenFiles, "kMaxLogisticSubbatchSize can't be too close to or larger than kMaxOpenFiles.");
+
+PglErr GlmLogistic(const char* const* cur_pheno_names, const char* const* test_names, const char* const* test_names_x, const char* const* test_names_y, const uint32_t* variant_bps, const char* const* variant_ids, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const uint32_t* local_sample_uidx_order, const uintptr_t* local_variant_include, const char* const* outnames, uint32_t raw_variant_ct, uint32_t max_chr_blen, double ci_size, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, uintptr_t overflow_buf_size, uint32_t local_sample_ct, PgenFileInfo* pgfip, GlmLogisticCtx* ctx, TextStream* local_covar_txsp, uintptr_t* valid_variants, uintptr_t* valid_alleles, double* orig_ln_pvals, double* orig_permstat, uintptr_t* valid_allele_ct_ptr) {
   unsigned char* bigstack_mark = g_bigstack_base;
-  char* cswritep = nullptr;
+  char** cswritep_arr = nullptr;
+  CompressStreamState* css_arr = nullptr;
+  const uint32_t subbatch_size = ctx->subbatch_size;
   PglErr reterr = kPglRetSuccess;
-  CompressStreamState css;
   ThreadGroup tg;
-  PreinitCstream(&css);
+  PgenPrefetch prefetch;
   PreinitThreads(&tg);
+  PreinitPgenPrefetch(&prefetch);
   {
     GlmCtx* common = ctx->common;
     const uintptr_t* variant_include = common->variant_include;
@@ -5723,11 +6813,22 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
 
     const GlmFlags glm_flags = glm_info_ptr->flags;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
-    // forced-singlethreaded
-    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
-    if (unlikely(reterr)) {
-      goto GlmLogistic_ret_1;
+    if (unlikely(bigstack_calloc_cp(subbatch_size, &cswritep_arr) ||
+                 BIGSTACK_ALLOC_X(CompressStreamState, subbatch_size, &css_arr))) {
+      goto GlmLogistic_ret_NOMEM;
+    }
+    for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      PreinitCstream(&(css_arr[fidx]));
+    }
+    for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      // forced-singlethreaded
+      // --glm resume appends to the truncated output file
+      reterr = InitCstreamAlloc(outnames[fidx], common->ckpt_skip_variant_ct != 0, output_zst, 1, overflow_buf_size, &(css_arr[fidx]), &(cswritep_arr[fidx]));
+      if (unlikely(reterr)) {
+        goto GlmLogistic_ret_1;
+      }
     }
+    char* cswritep = cswritep_arr[0];
     const uint32_t report_neglog10p = (glm_flags / kfGlmLog10) & 1;
     const uint32_t add_interactions = (glm_flags / kfGlmInteraction) & 1;
     const uint32_t domdev_present = (glm_flags & (kfGlmGenotypic | kfGlmHethom))? 1 : 0;
@@ -5794,6 +6895,20 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     const uint32_t is_sometimes_firth = !(glm_flags & kfGlmNoFirth);
     const uint32_t is_always_firth = (glm_flags / kfGlmFirth) & 1;
     const uint32_t is_cc_residualize = !!(glm_flags & (kfGlmFirthResidualize | kfGlmCcResidualize));
+    const uint32_t is_score_screen = (glm_flags / kfGlmScoreScreen) & 1;
+    const uint32_t is_loco = (ctx->loco_offsets_f != nullptr);
+    ctx->score_screen_ln_thresh = glm_info_ptr->score_screen_ln_thresh;
+    ctx->firth_null_coefs = nullptr;
+    ctx->firth_null_coefs_x = nullptr;
+    ctx->firth_null_coefs_y = nullptr;
+    if ((glm_flags & kfGlmFirthWarmStart) && (!local_covar_ct) && (!common->parameter_subset)) {
+      // loco-ridge offsets only apply to the main sample set
+      if (unlikely(FitFirthNullModels(ctx->pheno_f, ctx->covars_cmaj_f, ctx->loco_offsets_f, common->sample_ct, covar_ct, subbatch_size, ctx->loco_slot_ct, &ctx->firth_null_coefs) ||
+                   (sample_ct_x && FitFirthNullModels(ctx->pheno_x_f, ctx->covars_cmaj_x_f, nullptr, sample_ct_x, covar_ct_x, subbatch_size, 0, &ctx->firth_null_coefs_x)) ||
+                   (sample_ct_y && FitFirthNullModels(ctx->pheno_y_f, ctx->covars_cmaj_y_f, nullptr, sample_ct_y, covar_ct_y, subbatch_size, 0, &ctx->firth_null_coefs_y)))) {
+        goto GlmLogistic_ret_NOMEM;
+      }
+    }
 
     uint32_t x_code = UINT32_MAXM1;
     uint32_t x_start = 0;
@@ -5827,15 +6942,15 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     const uint32_t xmain_ct = main_mutated + main_omitted;
     const uint32_t gcount_cc_col = glm_cols & kfGlmColGcountcc;
     // workflow is similar to --make-bed
-    uintptr_t workspace_alloc = GetLogisticWorkspaceSize(sample_ct, biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, constraint_ct, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize);
+    uintptr_t workspace_alloc = GetLogisticWorkspaceSize(sample_ct, biallelic_predictor_ct, domdev_present_p1, max_extra_allele_ct, constraint_ct, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize, is_loco, is_score_screen);
     if (sample_ct_x) {
-      const uintptr_t workspace_alloc_x = GetLogisticWorkspaceSize(sample_ct_x, biallelic_predictor_ct_x, domdev_present_p1, max_extra_allele_ct, constraint_ct_x, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize);
+      const uintptr_t workspace_alloc_x = GetLogisticWorkspaceSize(sample_ct_x, biallelic_predictor_ct_x, domdev_present_p1, max_extra_allele_ct, constraint_ct_x, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize, is_loco, is_score_screen);
       if (workspace_alloc_x > workspace_alloc) {
         workspace_alloc = workspace_alloc_x;
       }
     }
     if (sample_ct_y) {
-      const uintptr_t workspace_alloc_y = GetLogisticWorkspaceSize(sample_ct_y, biallelic_predictor_ct_y, domdev_present_p1, max_extra_allele_ct, constraint_ct_y, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize);
+      const uintptr_t workspace_alloc_y = GetLogisticWorkspaceSize(sample_ct_y, biallelic_predictor_ct_y, domdev_present_p1, max_extra_allele_ct, constraint_ct_y, xmain_ct, gcount_cc_col, is_sometimes_firth, is_cc_residualize, is_loco, is_score_screen);
       if (workspace_alloc_y > workspace_alloc) {
         workspace_alloc = workspace_alloc_y;
       }
@@ -5845,11 +6960,11 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     uintptr_t thread_xalloc_cacheline_ct = (workspace_alloc / kCacheline) + 1;
 
     uintptr_t per_variant_xalloc_byte_ct = max_sample_ct * local_covar_ct * sizeof(float);
-    uintptr_t per_alt_allele_xalloc_byte_ct = sizeof(LogisticAuxResult);
+    uintptr_t per_alt_allele_xalloc_byte_ct = sizeof(LogisticAuxResult) * subbatch_size;
     if (beta_se_multiallelic_fused) {
-      per_variant_xalloc_byte_ct += 2 * max_reported_test_ct * sizeof(double);
+      per_variant_xalloc_byte_ct += 2 * max_reported_test_ct * subbatch_size * sizeof(double);
     } else {
-      per_alt_allele_xalloc_byte_ct += 2 * max_reported_test_ct * sizeof(double);
+      per_alt_allele_xalloc_byte_ct += 2 * max_reported_test_ct * subbatch_size * sizeof(double);
     }
     STD_ARRAY_DECL(unsigned char*, 2, main_loadbufs);
     common->thread_mhc = nullptr;
@@ -5867,15 +6982,15 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     double* block_beta_se_bufs[2];
 
     for (uint32_t uii = 0; uii != 2; ++uii) {
-      if (unlikely(BIGSTACK_ALLOC_X(LogisticAuxResult, max_alt_allele_block_size, &(logistic_block_aux_bufs[uii])))) {
+      if (unlikely(BIGSTACK_ALLOC_X(LogisticAuxResult, max_alt_allele_block_size * subbatch_size, &(logistic_block_aux_bufs[uii])))) {
         goto GlmLogistic_ret_NOMEM;
       }
       if (beta_se_multiallelic_fused) {
-        if (unlikely(bigstack_alloc_d(read_block_size * 2 * max_reported_test_ct, &(block_beta_se_bufs[uii])))) {
+        if (unlikely(bigstack_alloc_d(read_block_size * (2 * k1LU) * max_reported_test_ct * subbatch_size, &(block_beta_se_bufs[uii])))) {
           goto GlmLogistic_ret_NOMEM;
         }
       } else {
-        if (unlikely(bigstack_alloc_d(max_alt_allele_block_size * 2 * max_reported_test_ct, &(block_beta_se_bufs[uii])))) {
+        if (unlikely(bigstack_alloc_d(max_alt_allele_block_size * 2 * max_reported_test_ct * subbatch_size, &(block_beta_se_bufs[uii])))) {
           goto GlmLogistic_ret_NOMEM;
         }
       }
@@ -5913,6 +7028,7 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     const uint32_t a1_freq_cc_col = glm_cols & kfGlmColA1freqcc;
     const uint32_t mach_r2_col = glm_cols & kfGlmColMachR2;
     const uint32_t firth_yn_col = (glm_cols & kfGlmColFirthYn) && is_sometimes_firth && (!is_always_firth);
+    const uint32_t screen_yn_col = (glm_cols & kfGlmColScreenYn) && is_score_screen;
     const uint32_t nobs_col = glm_cols & kfGlmColNobs;
     const uint32_t orbeta_col = glm_cols & (kfGlmColBeta | kfGlmColOrbeta);
     const uint32_t report_beta_instead_of_odds_ratio = glm_cols & kfGlmColBeta;
@@ -5969,6 +7085,9 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     if (firth_yn_col) {
       cswritep = strcpya_k(cswritep, "\tFIRTH?");
     }
+    if (screen_yn_col) {
+      cswritep = strcpya_k(cswritep, "\tSCREENED?");
+    }
     if (test_col) {
       cswritep = strcpya_k(cswritep, "\tTEST");
     }
@@ -6016,6 +7135,18 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
       cswritep = strcpya_k(cswritep, "\tERRCODE");
     }
     AppendBinaryEoln(&cswritep);
+    if (common->ckpt_skip_variant_ct) {
+      // header line was already written by the earlier run
+      cswritep = cswritep_arr[0];
+    }
+    {
+      const char* header_start = cswritep_arr[0];
+      const uintptr_t header_blen = cswritep - header_start;
+      cswritep_arr[0] = cswritep;
+      for (uint32_t fidx = 1; fidx != subbatch_size; ++fidx) {
+        cswritep_arr[fidx] = memcpya(cswritep_arr[fidx], header_start, header_blen);
+      }
+    }
 
     // Main workflow:
     // 1. Set n=0, load/skip block 0
@@ -6048,11 +7179,23 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     uint32_t allele_ct = 2;
     uint32_t omitted_allele_idx = 0;
     uintptr_t valid_allele_ct = 0;
-    logprintfww5("--glm %s regression on phenotype '%s': ", is_always_firth? "Firth" : (is_sometimes_firth? "logistic-Firth hybrid" : "logistic"), cur_pheno_name);
+    reterr = PgenPrefetchStart(variant_include, raw_variant_ct, variant_ct, read_block_size, main_loadbufs, pgfip, &prefetch);
+    if (unlikely(reterr)) {
+      if (reterr == kPglRetNomem) {
+        goto GlmLogistic_ret_NOMEM;
+      }
+      goto GlmLogistic_ret_THREAD_CREATE_FAIL;
+    }
+    const char* regression_type_str = is_always_firth? "Firth" : (is_sometimes_firth? "logistic-Firth hybrid" : "logistic");
+    if (subbatch_size == 1) {
+      logprintfww5("--glm %s regression on phenotype '%s': ", regression_type_str, cur_pheno_names[0]);
+    } else {
+      logprintfww5("--glm %s regression on phenotype '%s' and %u other%s: ", regression_type_str, cur_pheno_names[0], subbatch_size - 1, (subbatch_size == 2)? "" : "s");
+    }
     fputs("0%", stdout);
     fflush(stdout);
     for (uint32_t variant_idx = 0; ; ) {
-      const uint32_t cur_block_variant_ct = MultireadNonempty(variant_include, &tg, raw_variant_ct, read_block_size, pgfip, &read_block_idx, &reterr);
+      const uint32_t cur_block_variant_ct = MultireadNonemptyP(variant_include, &tg, raw_variant_ct, read_block_size, &prefetch, pgfip, &read_block_idx, &reterr);
       if (unlikely(reterr)) {
         goto GlmLogistic_ret_PGR_FAIL;
       }
@@ -6143,385 +7286,417 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
             omitted_allele_idx = omitted_alleles[write_variant_uidx];
           }
           const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
-          uint32_t variant_is_valid = 0;
-          uint32_t a1_allele_idx = 0;
-          for (uint32_t nonomitted_allele_idx = 0; nonomitted_allele_idx != allele_ct_m1; ++nonomitted_allele_idx, ++a1_allele_idx) {
-            if (beta_se_multiallelic_fused) {
-              if (!nonomitted_allele_idx) {
-                primary_reported_test_idx = include_intercept;
-              } else {
-                primary_reported_test_idx = cur_biallelic_reported_test_ct + nonomitted_allele_idx - 1;
-              }
-            }
-            if (nonomitted_allele_idx == omitted_allele_idx) {
-              ++a1_allele_idx;
-            }
-            const double primary_beta = beta_se_iter[primary_reported_test_idx * 2];
-            const double primary_se = beta_se_iter[primary_reported_test_idx * 2 + 1];
-            const uint32_t allele_is_valid = (primary_se != -9.0);
-            variant_is_valid |= allele_is_valid;
-            {
-              const LogisticAuxResult* auxp = &(cur_block_aux[allele_bidx]);
-              if (ln_pfilter <= 0.0) {
-                if (!allele_is_valid) {
-                  goto GlmLogistic_allele_iterate;
-                }
-                double permstat;
-                double primary_ln_pval;
-                if (!cur_constraint_ct) {
-                  permstat = fabs(primary_beta / primary_se);
-                  // could precompute a tstat threshold instead
-                  primary_ln_pval = ZscoreToLnP(permstat);
+          for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+            CompressStreamState* cssp = &(css_arr[fidx]);
+            cswritep = cswritep_arr[fidx];
+            uint32_t variant_is_valid = 0;
+            uint32_t a1_allele_idx = 0;
+            for (uint32_t nonomitted_allele_idx = 0; nonomitted_allele_idx != allele_ct_m1; ++nonomitted_allele_idx, ++a1_allele_idx) {
+              if (beta_se_multiallelic_fused) {
+                if (!nonomitted_allele_idx) {
+                  primary_reported_test_idx = include_intercept;
                 } else {
-                  // cur_constraint_ct may be different on chrX/chrY than it is
-                  // on autosomes, so just have permstat be -log(pval) to be
-                  // safe
-                  primary_ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
-                  permstat = -primary_ln_pval;
-                }
-                if (primary_ln_pval > ln_pfilter) {
-                  if (orig_ln_pvals) {
-                    orig_ln_pvals[valid_allele_ct] = primary_ln_pval;
-                  }
-                  if (orig_permstat) {
-                    orig_permstat[valid_allele_ct] = permstat;
-                  }
-                  goto GlmLogistic_allele_iterate;
+                  primary_reported_test_idx = cur_biallelic_reported_test_ct + nonomitted_allele_idx - 1;
                 }
               }
-              uint32_t inner_reported_test_ct = cur_biallelic_reported_test_ct;
-              if (extra_allele_ct) {
-                if (beta_se_multiallelic_fused) {
-                  // in fused case, we're only performing a single multiple
-                  // regression, so list all additive results together,
-                  // possibly with intercept before.
-                  if (!nonomitted_allele_idx) {
-                    inner_reported_test_ct = 1 + include_intercept;
-                  } else if (nonomitted_allele_idx == extra_allele_ct) {
-                    inner_reported_test_ct -= include_intercept;
-                  } else {
-                    inner_reported_test_ct = 1;
-                  }
-                } else if (!hide_covar) {
-                  inner_reported_test_ct += extra_allele_ct;
-                }
+              if (nonomitted_allele_idx == omitted_allele_idx) {
+                ++a1_allele_idx;
               }
-              // possible todo: make number-to-string operations, strlen(),
-              // etc. happen only once per variant.
-              for (uint32_t allele_test_idx = 0; allele_test_idx != inner_reported_test_ct; ++allele_test_idx) {
-                uint32_t test_idx = allele_test_idx;
-                if (beta_se_multiallelic_fused && nonomitted_allele_idx) {
-                  if (!allele_test_idx) {
-                    test_idx = primary_reported_test_idx;
+              const double primary_beta = beta_se_iter[primary_reported_test_idx * 2];
+              const double primary_se = beta_se_iter[primary_reported_test_idx * 2 + 1];
+              const uint32_t allele_is_valid = (primary_se != -9.0);
+              variant_is_valid |= allele_is_valid;
+              {
+                const LogisticAuxResult* auxp = &(cur_block_aux[allele_bidx]);
+                if (common->hits && allele_is_valid) {
+                  double hit_ln_pval;
+                  if (!cur_constraint_ct) {
+                    hit_ln_pval = ZscoreToLnP(primary_beta / primary_se);
                   } else {
-                    // bugfix (26 Jun 2019): only correct to add 1 here in
-                    // include_intercept case
-                    test_idx += include_intercept;
+                    hit_ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
                   }
-                }
-                if (chr_col) {
-                  cswritep = memcpya(cswritep, chr_buf, chr_buf_blen);
-                }
-                if (variant_bps) {
-                  cswritep = u32toa_x(variant_bps[write_variant_uidx], '\t', cswritep);
-                }
-                cswritep = strcpya(cswritep, variant_ids[write_variant_uidx]);
-                if (ref_col) {
-                  *cswritep++ = '\t';
-                  cswritep = strcpya(cswritep, cur_alleles[0]);
-                }
-                if (alt1_col) {
-                  *cswritep++ = '\t';
-                  cswritep = strcpya(cswritep, cur_alleles[1]);
-                }
-                if (alt_col) {
-                  *cswritep++ = '\t';
-                  for (uint32_t tmp_allele_idx = 1; tmp_allele_idx != allele_ct; ++tmp_allele_idx) {
-                    if (unlikely(Cswrite(&css, &cswritep))) {
-                      goto GlmLogistic_ret_WRITE_FAIL;
-                    }
-                    cswritep = strcpyax(cswritep, cur_alleles[tmp_allele_idx], ',');
+                  if (unlikely(GlmHitsAdd(write_variant_uidx, cip->chr_file_order[chr_fo_idx], a1_allele_idx, auxp->sample_obs_ct, cur_constraint_ct != 0, primary_beta, primary_se, hit_ln_pval, common->hits))) {
+                    goto GlmLogistic_ret_WRITE_FAIL;
                   }
-                  --cswritep;
                 }
-                *cswritep++ = '\t';
-                const uint32_t multi_a1 = extra_allele_ct && beta_se_multiallelic_fused && (test_idx != primary_reported_test_idx);
-                if (multi_a1) {
-                  for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
-                    if (allele_idx == omitted_allele_idx) {
-                      continue;
+                if (ln_pfilter <= 0.0) {
+                  if (!allele_is_valid) {
+                    goto GlmLogistic_allele_iterate;
+                  }
+                  double permstat;
+                  double primary_ln_pval;
+                  if (!cur_constraint_ct) {
+                    permstat = fabs(primary_beta / primary_se);
+                    // could precompute a tstat threshold instead
+                    primary_ln_pval = ZscoreToLnP(permstat);
+                  } else {
+                    // cur_constraint_ct may be different on chrX/chrY than it is
+                    // on autosomes, so just have permstat be -log(pval) to be
+                    // safe
+                    primary_ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
+                    permstat = -primary_ln_pval;
+                  }
+                  if (primary_ln_pval > ln_pfilter) {
+                    if (orig_ln_pvals) {
+                      orig_ln_pvals[valid_allele_ct] = primary_ln_pval;
                     }
-                    if (unlikely(Cswrite(&css, &cswritep))) {
-                      goto GlmLogistic_ret_WRITE_FAIL;
+                    if (orig_permstat) {
+                      orig_permstat[valid_allele_ct] = permstat;
                     }
-                    cswritep = strcpyax(cswritep, cur_alleles[allele_idx], ',');
+                    goto GlmLogistic_allele_iterate;
+                  }
+                }
+                uint32_t inner_reported_test_ct = cur_biallelic_reported_test_ct;
+                if (extra_allele_ct) {
+                  if (beta_se_multiallelic_fused) {
+                    // in fused case, we're only performing a single multiple
+                    // regression, so list all additive results together,
+                    // possibly with intercept before.
+                    if (!nonomitted_allele_idx) {
+                      inner_reported_test_ct = 1 + include_intercept;
+                    } else if (nonomitted_allele_idx == extra_allele_ct) {
+                      inner_reported_test_ct -= include_intercept;
+                    } else {
+                      inner_reported_test_ct = 1;
+                    }
+                  } else if (!hide_covar) {
+                    inner_reported_test_ct += extra_allele_ct;
                   }
-                  --cswritep;
-                } else {
-                  cswritep = strcpya(cswritep, cur_alleles[a1_allele_idx]);
                 }
-                if (ax_col) {
-                  *cswritep++ = '\t';
-                  if (beta_se_multiallelic_fused && (test_idx != primary_reported_test_idx)) {
-                    if (unlikely(Cswrite(&css, &cswritep))) {
-                      goto GlmLogistic_ret_WRITE_FAIL;
+                // possible todo: make number-to-string operations, strlen(),
+                // etc. happen only once per variant.
+                for (uint32_t allele_test_idx = 0; allele_test_idx != inner_reported_test_ct; ++allele_test_idx) {
+                  uint32_t test_idx = allele_test_idx;
+                  if (beta_se_multiallelic_fused && nonomitted_allele_idx) {
+                    if (!allele_test_idx) {
+                      test_idx = primary_reported_test_idx;
+                    } else {
+                      // bugfix (26 Jun 2019): only correct to add 1 here in
+                      // include_intercept case
+                      test_idx += include_intercept;
                     }
-                    cswritep = strcpya(cswritep, cur_alleles[omitted_allele_idx]);
-                  } else {
-                    for (uint32_t tmp_allele_idx = 0; tmp_allele_idx != allele_ct; ++tmp_allele_idx) {
-                      if (tmp_allele_idx == a1_allele_idx) {
-                        continue;
-                      }
-                      if (unlikely(Cswrite(&css, &cswritep))) {
+                  }
+                  if (chr_col) {
+                    cswritep = memcpya(cswritep, chr_buf, chr_buf_blen);
+                  }
+                  if (variant_bps) {
+                    cswritep = u32toa_x(variant_bps[write_variant_uidx], '\t', cswritep);
+                  }
+                  cswritep = strcpya(cswritep, variant_ids[write_variant_uidx]);
+                  if (ref_col) {
+                    *cswritep++ = '\t';
+                    cswritep = strcpya(cswritep, cur_alleles[0]);
+                  }
+                  if (alt1_col) {
+                    *cswritep++ = '\t';
+                    cswritep = strcpya(cswritep, cur_alleles[1]);
+                  }
+                  if (alt_col) {
+                    *cswritep++ = '\t';
+                    for (uint32_t tmp_allele_idx = 1; tmp_allele_idx != allele_ct; ++tmp_allele_idx) {
+                      if (unlikely(Cswrite(cssp, &cswritep))) {
+                        cswritep_arr[fidx] = cswritep;
                         goto GlmLogistic_ret_WRITE_FAIL;
                       }
                       cswritep = strcpyax(cswritep, cur_alleles[tmp_allele_idx], ',');
                     }
                     --cswritep;
                   }
-                }
-                if (a1_ct_col) {
                   *cswritep++ = '\t';
-                  if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage, cswritep);
+                  const uint32_t multi_a1 = extra_allele_ct && beta_se_multiallelic_fused && (test_idx != primary_reported_test_idx);
+                  if (multi_a1) {
+                    for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+                      if (allele_idx == omitted_allele_idx) {
+                        continue;
+                      }
+                      if (unlikely(Cswrite(cssp, &cswritep))) {
+                        cswritep_arr[fidx] = cswritep;
+                        goto GlmLogistic_ret_WRITE_FAIL;
+                      }
+                      cswritep = strcpyax(cswritep, cur_alleles[allele_idx], ',');
+                    }
+                    --cswritep;
                   } else {
-                    cswritep = strcpya_k(cswritep, "NA");
+                    cswritep = strcpya(cswritep, cur_alleles[a1_allele_idx]);
                   }
-                }
-                if (tot_allele_col) {
-                  *cswritep++ = '\t';
-                  cswritep = u32toa(auxp->allele_obs_ct, cswritep);
-                }
-                if (a1_ct_cc_col) {
-                  *cswritep++ = '\t';
-                  if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_case_dosage, cswritep);
+                  if (ax_col) {
                     *cswritep++ = '\t';
-                    cswritep = dtoa_g(auxp->a1_dosage - auxp->a1_case_dosage, cswritep);
-                  } else {
-                    cswritep = strcpya_k(cswritep, "NA\tNA");
+                    if (beta_se_multiallelic_fused && (test_idx != primary_reported_test_idx)) {
+                      if (unlikely(Cswrite(cssp, &cswritep))) {
+                        cswritep_arr[fidx] = cswritep;
+                        goto GlmLogistic_ret_WRITE_FAIL;
+                      }
+                      cswritep = strcpya(cswritep, cur_alleles[omitted_allele_idx]);
+                    } else {
+                      for (uint32_t tmp_allele_idx = 0; tmp_allele_idx != allele_ct; ++tmp_allele_idx) {
+                        if (tmp_allele_idx == a1_allele_idx) {
+                          continue;
+                        }
+                        if (unlikely(Cswrite(cssp, &cswritep))) {
+                          cswritep_arr[fidx] = cswritep;
+                          goto GlmLogistic_ret_WRITE_FAIL;
+                        }
+                        cswritep = strcpyax(cswritep, cur_alleles[tmp_allele_idx], ',');
+                      }
+                      --cswritep;
+                    }
                   }
-                }
-                if (tot_allele_cc_col) {
-                  *cswritep++ = '\t';
-                  cswritep = u32toa_x(auxp->case_allele_obs_ct, '\t', cswritep);
-                  cswritep = u32toa(auxp->allele_obs_ct - auxp->case_allele_obs_ct, cswritep);
-                }
-                if (gcount_cc_col) {
-                  if (!multi_a1) {
-                    STD_ARRAY_KREF(uint32_t, 6) cur_geno_hardcall_cts = auxp->geno_hardcall_cts;
-                    for (uint32_t uii = 0; uii != 6; ++uii) {
-                      *cswritep++ = '\t';
-                      cswritep = u32toa(cur_geno_hardcall_cts[uii], cswritep);
+                  if (a1_ct_col) {
+                    *cswritep++ = '\t';
+                    if (!multi_a1) {
+                      cswritep = dtoa_g(auxp->a1_dosage, cswritep);
+                    } else {
+                      cswritep = strcpya_k(cswritep, "NA");
                     }
-                  } else {
-                    cswritep = strcpya_k(cswritep, "\tNA\tNA\tNA\tNA\tNA\tNA");
                   }
-                }
-                if (a1_freq_col) {
-                  *cswritep++ = '\t';
-                  if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), cswritep);
-                  } else {
-                    cswritep = strcpya_k(cswritep, "NA");
+                  if (tot_allele_col) {
+                    *cswritep++ = '\t';
+                    cswritep = u32toa(auxp->allele_obs_ct, cswritep);
                   }
-                }
-                if (a1_freq_cc_col) {
-                  *cswritep++ = '\t';
-                  if (!multi_a1) {
-                    cswritep = dtoa_g(auxp->a1_case_dosage / S_CAST(double, auxp->case_allele_obs_ct), cswritep);
+                  if (a1_ct_cc_col) {
                     *cswritep++ = '\t';
-                    cswritep = dtoa_g((auxp->a1_dosage - auxp->a1_case_dosage) / S_CAST(double, auxp->allele_obs_ct - auxp->case_allele_obs_ct), cswritep);
-                  } else {
-                    cswritep = strcpya_k(cswritep, "NA\tNA");
+                    if (!multi_a1) {
+                      cswritep = dtoa_g(auxp->a1_case_dosage, cswritep);
+                      *cswritep++ = '\t';
+                      cswritep = dtoa_g(auxp->a1_dosage - auxp->a1_case_dosage, cswritep);
+                    } else {
+                      cswritep = strcpya_k(cswritep, "NA\tNA");
+                    }
                   }
-                }
-                if (mach_r2_col) {
-                  *cswritep++ = '\t';
-                  if (!suppress_mach_r2) {
-                    cswritep = dtoa_g(auxp->mach_r2, cswritep);
-                  } else {
-                    cswritep = strcpya_k(cswritep, "NA");
+                  if (tot_allele_cc_col) {
+                    *cswritep++ = '\t';
+                    cswritep = u32toa_x(auxp->case_allele_obs_ct, '\t', cswritep);
+                    cswritep = u32toa(auxp->allele_obs_ct - auxp->case_allele_obs_ct, cswritep);
                   }
-                }
-                if (firth_yn_col) {
-                  *cswritep++ = '\t';
-                  // 'Y' - 'N' = 11
-                  *cswritep++ = 'N' + 11 * auxp->firth_fallback;
-                }
-                if (test_col) {
-                  *cswritep++ = '\t';
-                  if (test_idx < cur_biallelic_reported_test_ct) {
-                    cswritep = strcpya(cswritep, cur_test_names[test_idx]);
-                  } else {
-                    // always use basic dosage for untested alleles
-                    cswritep = strcpya_k(cswritep, "ADD");
-                    if (!beta_se_multiallelic_fused) {
-                      // extra alt allele covariate.
-                      uint32_t test_xallele_idx = test_idx - cur_biallelic_reported_test_ct;
-                      // now we have the 0-based relative position in a list
-                      // with the omitted_allele_idx and a1_allele_idx removed.
-                      // correct this to the absolute index.  (there may be a
-                      // cleaner way to do this with nonomitted_allele_idx?)
-                      if (omitted_allele_idx < a1_allele_idx) {
-                        test_xallele_idx = test_xallele_idx + (test_xallele_idx >= omitted_allele_idx);
-                      }
-                      test_xallele_idx = test_xallele_idx + (test_xallele_idx >= a1_allele_idx);
-                      if (a1_allele_idx < omitted_allele_idx) {
-                        test_xallele_idx = test_xallele_idx + (test_xallele_idx >= omitted_allele_idx);
-                      }
-                      if (!test_xallele_idx) {
-                        cswritep = strcpya_k(cswritep, "_REF");
-                      } else {
-                        cswritep = strcpya_k(cswritep, "_ALT");
-                        cswritep = u32toa(test_xallele_idx, cswritep);
+                  if (gcount_cc_col) {
+                    if (!multi_a1) {
+                      STD_ARRAY_KREF(uint32_t, 6) cur_geno_hardcall_cts = auxp->geno_hardcall_cts;
+                      for (uint32_t uii = 0; uii != 6; ++uii) {
+                        *cswritep++ = '\t';
+                        cswritep = u32toa(cur_geno_hardcall_cts[uii], cswritep);
                       }
+                    } else {
+                      cswritep = strcpya_k(cswritep, "\tNA\tNA\tNA\tNA\tNA\tNA");
                     }
                   }
-                }
-                if (nobs_col) {
-                  *cswritep++ = '\t';
-                  cswritep = u32toa(auxp->sample_obs_ct, cswritep);
-                }
-                double ln_pval = kLnPvalError;
-                double permstat = 0.0;
-                uint32_t test_is_valid;
-                if ((!cur_constraint_ct) || (test_idx != primary_reported_test_idx)) {
-                  double beta = beta_se_iter[2 * test_idx];
-                  double se = beta_se_iter[2 * test_idx + 1];
-                  test_is_valid = (se != -9.0);
-                  if (test_is_valid) {
-                    permstat = beta / se;
-                    ln_pval = ZscoreToLnP(permstat);
+                  if (a1_freq_col) {
+                    *cswritep++ = '\t';
+                    if (!multi_a1) {
+                      cswritep = dtoa_g(auxp->a1_dosage / S_CAST(double, auxp->allele_obs_ct), cswritep);
+                    } else {
+                      cswritep = strcpya_k(cswritep, "NA");
+                    }
                   }
-                  if (orbeta_col) {
+                  if (a1_freq_cc_col) {
                     *cswritep++ = '\t';
-                    if (test_is_valid) {
-                      if (report_beta_instead_of_odds_ratio) {
-                        cswritep = dtoa_g(beta, cswritep);
-                      } else {
-                        cswritep = lntoa_g(beta, cswritep);
-                      }
+                    if (!multi_a1) {
+                      cswritep = dtoa_g(auxp->a1_case_dosage / S_CAST(double, auxp->case_allele_obs_ct), cswritep);
+                      *cswritep++ = '\t';
+                      cswritep = dtoa_g((auxp->a1_dosage - auxp->a1_case_dosage) / S_CAST(double, auxp->allele_obs_ct - auxp->case_allele_obs_ct), cswritep);
+                    } else {
+                      cswritep = strcpya_k(cswritep, "NA\tNA");
+                    }
+                  }
+                  if (mach_r2_col) {
+                    *cswritep++ = '\t';
+                    if (!suppress_mach_r2) {
+                      cswritep = dtoa_g(auxp->mach_r2, cswritep);
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
                   }
-                  if (se_col) {
+                  if (firth_yn_col) {
                     *cswritep++ = '\t';
-                    if (test_is_valid) {
-                      cswritep = dtoa_g(se, cswritep);
+                    // 'Y' - 'N' = 11
+                    *cswritep++ = 'N' + 11 * auxp->firth_fallback;
+                  }
+                  if (screen_yn_col) {
+                    *cswritep++ = '\t';
+                    *cswritep++ = 'N' + 11 * auxp->score_screened;
+                  }
+                  if (test_col) {
+                    *cswritep++ = '\t';
+                    if (test_idx < cur_biallelic_reported_test_ct) {
+                      cswritep = strcpya(cswritep, cur_test_names[test_idx]);
                     } else {
-                      cswritep = strcpya_k(cswritep, "NA");
+                      // always use basic dosage for untested alleles
+                      cswritep = strcpya_k(cswritep, "ADD");
+                      if (!beta_se_multiallelic_fused) {
+                        // extra alt allele covariate.
+                        uint32_t test_xallele_idx = test_idx - cur_biallelic_reported_test_ct;
+                        // now we have the 0-based relative position in a list
+                        // with the omitted_allele_idx and a1_allele_idx removed.
+                        // correct this to the absolute index.  (there may be a
+                        // cleaner way to do this with nonomitted_allele_idx?)
+                        if (omitted_allele_idx < a1_allele_idx) {
+                          test_xallele_idx = test_xallele_idx + (test_xallele_idx >= omitted_allele_idx);
+                        }
+                        test_xallele_idx = test_xallele_idx + (test_xallele_idx >= a1_allele_idx);
+                        if (a1_allele_idx < omitted_allele_idx) {
+                          test_xallele_idx = test_xallele_idx + (test_xallele_idx >= omitted_allele_idx);
+                        }
+                        if (!test_xallele_idx) {
+                          cswritep = strcpya_k(cswritep, "_REF");
+                        } else {
+                          cswritep = strcpya_k(cswritep, "_ALT");
+                          cswritep = u32toa(test_xallele_idx, cswritep);
+                        }
+                      }
                     }
                   }
-                  if (ci_col) {
+                  if (nobs_col) {
                     *cswritep++ = '\t';
+                    cswritep = u32toa(auxp->sample_obs_ct, cswritep);
+                  }
+                  double ln_pval = kLnPvalError;
+                  double permstat = 0.0;
+                  uint32_t test_is_valid;
+                  if ((!cur_constraint_ct) || (test_idx != primary_reported_test_idx)) {
+                    double beta = beta_se_iter[2 * test_idx];
+                    double se = beta_se_iter[2 * test_idx + 1];
+                    test_is_valid = (se != -9.0);
                     if (test_is_valid) {
-                      const double ci_halfwidth = ci_zt * se;
-                      if (report_beta_instead_of_odds_ratio) {
-                        cswritep = dtoa_g(beta - ci_halfwidth, cswritep);
-                        *cswritep++ = '\t';
-                        cswritep = dtoa_g(beta + ci_halfwidth, cswritep);
+                      permstat = beta / se;
+                      ln_pval = ZscoreToLnP(permstat);
+                    }
+                    if (orbeta_col) {
+                      *cswritep++ = '\t';
+                      if (test_is_valid) {
+                        if (report_beta_instead_of_odds_ratio) {
+                          cswritep = dtoa_g(beta, cswritep);
+                        } else {
+                          cswritep = lntoa_g(beta, cswritep);
+                        }
                       } else {
-                        cswritep = lntoa_g(beta - ci_halfwidth, cswritep);
-                        *cswritep++ = '\t';
-                        cswritep = lntoa_g(beta + ci_halfwidth, cswritep);
+                        cswritep = strcpya_k(cswritep, "NA");
+                      }
+                    }
+                    if (se_col) {
+                      *cswritep++ = '\t';
+                      if (test_is_valid) {
+                        cswritep = dtoa_g(se, cswritep);
+                      } else {
+                        cswritep = strcpya_k(cswritep, "NA");
+                      }
+                    }
+                    if (ci_col) {
+                      *cswritep++ = '\t';
+                      if (test_is_valid) {
+                        const double ci_halfwidth = ci_zt * se;
+                        if (report_beta_instead_of_odds_ratio) {
+                          cswritep = dtoa_g(beta - ci_halfwidth, cswritep);
+                          *cswritep++ = '\t';
+                          cswritep = dtoa_g(beta + ci_halfwidth, cswritep);
+                        } else {
+                          cswritep = lntoa_g(beta - ci_halfwidth, cswritep);
+                          *cswritep++ = '\t';
+                          cswritep = lntoa_g(beta + ci_halfwidth, cswritep);
+                        }
+                      } else {
+                        cswritep = strcpya_k(cswritep, "NA\tNA");
+                      }
+                    }
+                    if (z_col) {
+                      *cswritep++ = '\t';
+                      if (test_is_valid) {
+                        cswritep = dtoa_g(permstat, cswritep);
+                      } else {
+                        cswritep = strcpya_k(cswritep, "NA");
+                      }
+                    }
+                  } else {
+                    // joint test: use F-test instead of Wald test
+                    test_is_valid = allele_is_valid;
+                    if (orbeta_col) {
+                      cswritep = strcpya_k(cswritep, "\tNA");
+                    }
+                    if (se_col) {
+                      cswritep = strcpya_k(cswritep, "\tNA");
+                    }
+                    if (ci_col) {
+                      cswritep = strcpya_k(cswritep, "\tNA\tNA");
+                    }
+                    if (z_col) {
+                      *cswritep++ = '\t';
+                      if (test_is_valid) {
+                        cswritep = dtoa_g(primary_se / u31tod(cur_constraint_ct), cswritep);
+                      } else {
+                        cswritep = strcpya_k(cswritep, "NA");
                       }
-                    } else {
-                      cswritep = strcpya_k(cswritep, "NA\tNA");
+                    }
+                    // could avoid recomputing
+                    if (test_is_valid) {
+                      ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
+                      permstat = -ln_pval;
                     }
                   }
-                  if (z_col) {
+                  if (p_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(permstat, cswritep);
+                      if (report_neglog10p) {
+                        double reported_val = (-kRecipLn10) * ln_pval;
+                        cswritep = dtoa_g(reported_val, cswritep);
+                      } else {
+                        double reported_ln = MAXV(ln_pval, output_min_ln);
+                        cswritep = lntoa_g(reported_ln, cswritep);
+                      }
                     } else {
                       cswritep = strcpya_k(cswritep, "NA");
                     }
                   }
-                } else {
-                  // joint test: use F-test instead of Wald test
-                  test_is_valid = allele_is_valid;
-                  if (orbeta_col) {
-                    cswritep = strcpya_k(cswritep, "\tNA");
-                  }
-                  if (se_col) {
-                    cswritep = strcpya_k(cswritep, "\tNA");
-                  }
-                  if (ci_col) {
-                    cswritep = strcpya_k(cswritep, "\tNA\tNA");
-                  }
-                  if (z_col) {
+                  if (err_col) {
                     *cswritep++ = '\t';
                     if (test_is_valid) {
-                      cswritep = dtoa_g(primary_se / u31tod(cur_constraint_ct), cswritep);
+                      if (!auxp->is_unfinished) {
+                        *cswritep++ = '.';
+                      } else {
+                        cswritep = strcpya_k(cswritep, "UNFINISHED");
+                      }
                     } else {
-                      cswritep = strcpya_k(cswritep, "NA");
+                      uint64_t glm_errcode;
+                      memcpy(&glm_errcode, &(beta_se_iter[2 * test_idx]), 8);
+                      cswritep = AppendGlmErrstr(glm_errcode, cswritep);
                     }
                   }
-                  // could avoid recomputing
-                  if (test_is_valid) {
-                    ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
-                    permstat = -ln_pval;
+                  AppendBinaryEoln(&cswritep);
+                  if (unlikely(Cswrite(cssp, &cswritep))) {
+                    cswritep_arr[fidx] = cswritep;
+                    goto GlmLogistic_ret_WRITE_FAIL;
                   }
-                }
-                if (p_col) {
-                  *cswritep++ = '\t';
-                  if (test_is_valid) {
-                    if (report_neglog10p) {
-                      double reported_val = (-kRecipLn10) * ln_pval;
-                      cswritep = dtoa_g(reported_val, cswritep);
-                    } else {
-                      double reported_ln = MAXV(ln_pval, output_min_ln);
-                      cswritep = lntoa_g(reported_ln, cswritep);
+                  if ((test_idx == primary_reported_test_idx) && allele_is_valid) {
+                    if (orig_ln_pvals) {
+                      orig_ln_pvals[valid_allele_ct] = ln_pval;
                     }
-                  } else {
-                    cswritep = strcpya_k(cswritep, "NA");
-                  }
-                }
-                if (err_col) {
-                  *cswritep++ = '\t';
-                  if (test_is_valid) {
-                    if (!auxp->is_unfinished) {
-                      *cswritep++ = '.';
-                    } else {
-                      cswritep = strcpya_k(cswritep, "UNFINISHED");
+                    if (orig_permstat) {
+                      orig_permstat[valid_allele_ct] = permstat;
                     }
-                  } else {
-                    uint64_t glm_errcode;
-                    memcpy(&glm_errcode, &(beta_se_iter[2 * test_idx]), 8);
-                    cswritep = AppendGlmErrstr(glm_errcode, cswritep);
-                  }
-                }
-                AppendBinaryEoln(&cswritep);
-                if (unlikely(Cswrite(&css, &cswritep))) {
-                  goto GlmLogistic_ret_WRITE_FAIL;
-                }
-                if ((test_idx == primary_reported_test_idx) && allele_is_valid) {
-                  if (orig_ln_pvals) {
-                    orig_ln_pvals[valid_allele_ct] = ln_pval;
-                  }
-                  if (orig_permstat) {
-                    orig_permstat[valid_allele_ct] = permstat;
                   }
                 }
               }
+            GlmLogistic_allele_iterate:
+              ++allele_bidx;
+              valid_allele_ct += allele_is_valid;
+              if (valid_alleles && allele_is_valid) {
+                SetBit(allele_idx_offset_base + a1_allele_idx, valid_alleles);
+              }
+              if (!beta_se_multiallelic_fused) {
+                beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+              }
             }
-          GlmLogistic_allele_iterate:
-            ++allele_bidx;
-            valid_allele_ct += allele_is_valid;
-            if (valid_alleles && allele_is_valid) {
-              SetBit(allele_idx_offset_base + a1_allele_idx, valid_alleles);
-            }
-            if (!beta_se_multiallelic_fused) {
+            if (beta_se_multiallelic_fused) {
               beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
             }
+            if ((!variant_is_valid) && valid_alleles) {
+              ClearBit(write_variant_uidx, valid_variants);
+            }
+            cswritep_arr[fidx] = cswritep;
           }
-          if (beta_se_multiallelic_fused) {
-            beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
-          }
-          if ((!variant_is_valid) && valid_alleles) {
-            ClearBit(write_variant_uidx, valid_variants);
+        }
+        if (common->ckpt_fname) {
+          // subbatch_size == 1 here
+          reterr = GlmCheckpointUpdate(common, variant_idx, &(css_arr[0]), &(cswritep_arr[0]));
+          if (unlikely(reterr)) {
+            goto GlmLogistic_ret_1;
           }
         }
       }
@@ -6544,15 +7719,19 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
       // pointers
       pgfip->block_base = main_loadbufs[parity];
     }
-    if (unlikely(CswriteCloseNull(&css, cswritep))) {
-      goto GlmLogistic_ret_WRITE_FAIL;
+    for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      if (unlikely(CswriteCloseNull(&(css_arr[fidx]), cswritep_arr[fidx]))) {
+        goto GlmLogistic_ret_WRITE_FAIL;
+      }
     }
     if (pct > 10) {
       putc_unlocked('\b', stdout);
     }
     fputs("\b\b", stdout);
     logputs("done.\n");
-    logprintf("Results written to %s .\n", outname);
+    for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      logprintf("Results written to %s .\n", outnames[fidx]);
+    }
     *valid_allele_ct_ptr = valid_allele_ct;
   }
   while (0) {
@@ -6576,8 +7755,13 @@ PglErr GlmLogistic(const char* cur_pheno_name, const char* const* test_names, co
     break;
   }
  GlmLogistic_ret_1:
+  CleanupPgenPrefetch(&prefetch);
   CleanupThreads(&tg);
-  CswriteCloseCond(&css, cswritep);
+  if (css_arr) {
+    for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      CswriteCloseCond(&(css_arr[fidx]), cswritep_arr[fidx]);
+    }
+  }
   BigstackReset(bigstack_mark);
   return reterr;
 }
@@ -6612,7 +7796,31 @@ uint32_t GenoarrToDoublesRemoveMissing(const uintptr_t* genoarr, const double* _
   }
 }
 
-uintptr_t GetLinearWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predictor_ct, uint32_t max_extra_allele_ct, uint32_t constraint_ct, uint32_t xmain_ct) {
+// When only the main genotype predictor is reported, biallelic variants with
+// no missing calls which can't use the sparse hardcall algorithm (i.e. usually
+// dosage-containing variants) are queued up, and their genotype x
+// {covariate, phenotype} dot products are evaluated for the whole queue with
+// a single dgemm call; see GlmLinearGemmFlush().
+CONSTI32(kLinearGemmBlockMax, 64);
+
+// Per-thread genotype-block buffer is capped at ~16 MiB.
+CONSTI32(kLinearGemmBlockDoubleCap, 1 << 21);
+
+uint32_t GetLinearGemmBlockSize(uint32_t sample_ct) {
+  const uint32_t block_size = kLinearGemmBlockDoubleCap / sample_ct;
+  if (block_size < 2) {
+    return 0;
+  }
+  return MINV(block_size, kLinearGemmBlockMax);
+}
+
+typedef struct LinearGemmPendingStruct {
+  double* beta_se;
+  double main_dosage_sum;
+  double main_dosage_ssq;
+} LinearGemmPending;
+
+uintptr_t GetLinearWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predictor_ct, uint32_t max_extra_allele_ct, uint32_t constraint_ct, uint32_t xmain_ct, uint32_t gemm_block_size) {
   // sample_ct * max_predictor_ct < 2^31, and max_predictor_ct < sqrt(2^31), so
   // no overflows
 
@@ -6661,9 +7869,127 @@ uintptr_t GetLinearWorkspaceSize(uint32_t sample_ct, uint32_t biallelic_predicto
     // cur_constraints_con_major = constraint_ct * max_predictor_ct doubles
     workspace_size += RoundUpPow2(constraint_ct * max_predictor_ct * sizeof(double), kCacheline);
   }
+  if (gemm_block_size) {
+    // gemm_geno_block = gemm_block_size * sample_ct doubles
+    workspace_size += RoundUpPow2(S_CAST(uintptr_t, gemm_block_size) * sample_ct * sizeof(double), kCacheline);
+
+    // gemm_dotprods = gemm_block_size * biallelic_predictor_ct doubles
+    workspace_size += RoundUpPow2(gemm_block_size * biallelic_predictor_ct * sizeof(double), kCacheline);
+
+    // gemm_pending
+    workspace_size += RoundUpPow2(gemm_block_size * sizeof(LinearGemmPending), kCacheline);
+  }
   return workspace_size;
 }
 
+// Scales xtx_inv = (X^T X)^{-1} by the residual variance, turning it into
+// the coefficient variance-covariance matrix, and performs the
+// validParameters() check.  On success, se_buf[] holds the standard errors.
+static GlmErr LinearScaleVcovAndCheck(const double* xt_y, const double* fitted_coefs, double pheno_ssq, uint32_t sample_ct, uint32_t predictor_ct, double* __restrict xtx_inv, double* __restrict se_buf) {
+  // RSS = y^T y - y^T X (X^T X)^{-1} X^T y
+  //     = pheno_ssq - xt_y * fitted_coefs
+  // s^2 = RSS / df
+  // possible todo: improve numerical stability of this computation in
+  // non-mean-centered phenotype case
+  const double sigma = (pheno_ssq - DotprodxD(xt_y, fitted_coefs, predictor_ct)) / u31tod(sample_ct - predictor_ct);
+  for (uint32_t uii = 0; uii != predictor_ct; ++uii) {
+    double* s_iter = &(xtx_inv[uii * predictor_ct]);
+#ifdef NOLAPACK
+    for (uint32_t ujj = 0; ujj != predictor_ct; ++ujj) {
+      s_iter[ujj] *= sigma;
+    }
+#else
+    for (uint32_t ujj = 0; ujj <= uii; ++ujj) {
+      s_iter[ujj] *= sigma;
+    }
+#endif
+  }
+  // validParameters() check
+  for (uint32_t pred_uidx = 1; pred_uidx != predictor_ct; ++pred_uidx) {
+    const double xtx_inv_diag_element = xtx_inv[pred_uidx * (predictor_ct + 1)];
+    if (xtx_inv_diag_element < 1e-20) {
+      return SetGlmErr0(kGlmErrcodeInvalidResult);
+    }
+    se_buf[pred_uidx] = sqrt(xtx_inv_diag_element);
+  }
+  se_buf[0] = sqrt(xtx_inv[0]);
+  for (uint32_t pred_uidx = 1; pred_uidx != predictor_ct; ++pred_uidx) {
+    const double cur_xtx_inv_diag_sqrt = 0.99999 * se_buf[pred_uidx];
+    const double* xtx_inv_row = &(xtx_inv[pred_uidx * predictor_ct]);
+    for (uint32_t pred_uidx2 = 0; pred_uidx2 != pred_uidx; ++pred_uidx2) {
+      if (xtx_inv_row[pred_uidx2] > cur_xtx_inv_diag_sqrt * se_buf[pred_uidx2]) {
+        return SetGlmErr0(kGlmErrcodeInvalidResult);
+      }
+    }
+  }
+  return 0;
+}
+
+// Finishes a regression whose X^T X is the precomputed covariate-only image
+// extended by the genotype (and, if domdev_present, domdev) rows already
+// written to xtx_inv, with matching xt_y.  Requires no missing samples.  On
+// success, fitted_coefs is filled, xtx_inv holds the variance-covariance
+// matrix, and dbl_2d_buf[] starts with the standard errors.
+static GlmErr LinearSemicomputedRegression(const double* covarx_dotprod_inv, const double* corr_inv, const double* xt_y, uint32_t predictor_ct, uint32_t domdev_present, uint32_t sample_ct, double pheno_ssq, double max_corr, double vif_thresh, double* __restrict xtx_inv, double* __restrict fitted_coefs, double* __restrict semicomputed_biallelic_corr_matrix, double* __restrict semicomputed_biallelic_inv_corr_sqrts, double* __restrict dbl_2d_buf, double* __restrict inverse_corr_buf) {
+  const double sample_ct_recip = 1.0 / u31tod(sample_ct);
+  const double sample_ct_m1_recip = 1.0 / u31tod(sample_ct - 1);
+  const GlmErr glm_err = CheckMaxCorrAndVifNm(xtx_inv, corr_inv, predictor_ct, domdev_present + 1, sample_ct_recip, sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * predictor_ct]), &(dbl_2d_buf[3 * predictor_ct]));
+  if (glm_err) {
+    return glm_err;
+  }
+  const double geno_ssq = xtx_inv[1 + predictor_ct];
+  if (!domdev_present) {
+    xtx_inv[1 + predictor_ct] = xtx_inv[predictor_ct];
+    if (InvertRank1Symm(covarx_dotprod_inv, &(xtx_inv[1 + predictor_ct]), predictor_ct - 1, 1, geno_ssq, dbl_2d_buf, inverse_corr_buf)) {
+      return SetGlmErr0(kGlmErrcodeRankDeficient);
+    }
+  } else {
+    const double domdev_geno_prod = xtx_inv[2 + predictor_ct];
+    const double domdev_ssq = xtx_inv[2 + 2 * predictor_ct];
+    xtx_inv[2 + predictor_ct] = xtx_inv[predictor_ct];
+    xtx_inv[2 + 2 * predictor_ct] = xtx_inv[2 * predictor_ct];
+    if (InvertRank2Symm(covarx_dotprod_inv, &(xtx_inv[2 + predictor_ct]), predictor_ct - 2, predictor_ct, 1, geno_ssq, domdev_geno_prod, domdev_ssq, dbl_2d_buf, inverse_corr_buf, &(inverse_corr_buf[2 * (predictor_ct - 2)]))) {
+      return SetGlmErr0(kGlmErrcodeRankDeficient);
+    }
+  }
+  // need to make sure xtx_inv remains reflected in NOLAPACK case
+  memcpy(xtx_inv, dbl_2d_buf, predictor_ct * predictor_ct * sizeof(double));
+  ReflectMatrix(predictor_ct, xtx_inv);
+  ColMajorVectorMatrixMultiplyStrided(xt_y, xtx_inv, predictor_ct, predictor_ct, predictor_ct, fitted_coefs);
+  return LinearScaleVcovAndCheck(xt_y, fitted_coefs, pheno_ssq, sample_ct, predictor_ct, xtx_inv, dbl_2d_buf);
+}
+
+// Finishes the queued-up regressions.  nm_predictors_pmaj_buf and
+// nm_pheno_buf must be unchanged since the variants were queued; everything
+// after the dot products is shared with GlmLinearThread()'s xtx_image code
+// path via LinearSemicomputedRegression().
+void GlmLinearGemmFlush(const double* nm_predictors_pmaj_buf, const double* nm_pheno_buf, const double* geno_block, const LinearGemmPending* pending, const double* xtx_image, const double* xt_y_image, const double* covarx_dotprod_inv, const double* corr_inv, uint32_t pending_ct, uint32_t sample_ct, uint32_t predictor_ct, double pheno_ssq, double max_corr, double vif_thresh, double* __restrict dotprods, double* __restrict xtx_inv, double* __restrict xt_y, double* __restrict fitted_coefs, double* __restrict semicomputed_biallelic_corr_matrix, double* __restrict semicomputed_biallelic_inv_corr_sqrts, double* __restrict dbl_2d_buf, double* __restrict inverse_corr_buf) {
+  // dotprods[] column p: genotype p x covariates, then genotype p x phenotype
+  const uint32_t nongeno_pred_ct = predictor_ct - 2;
+  if (nongeno_pred_ct) {
+    ColMajorMatrixTransposeMultiplyStrided(&(nm_predictors_pmaj_buf[2 * S_CAST(uintptr_t, sample_ct)]), geno_block, nongeno_pred_ct, sample_ct, pending_ct, sample_ct, sample_ct, predictor_ct, dotprods);
+  }
+  ColMajorMatrixTransposeMultiplyStrided(nm_pheno_buf, geno_block, 1, sample_ct, pending_ct, sample_ct, sample_ct, predictor_ct, &(dotprods[nongeno_pred_ct]));
+  for (uint32_t pending_idx = 0; pending_idx != pending_ct; ++pending_idx) {
+    const double* cur_dotprods = &(dotprods[pending_idx * predictor_ct]);
+    memcpy(xtx_inv, xtx_image, predictor_ct * predictor_ct * sizeof(double));
+    memcpy(xt_y, xt_y_image, predictor_ct * sizeof(double));
+    xt_y[1] = cur_dotprods[nongeno_pred_ct];
+    xtx_inv[predictor_ct] = pending[pending_idx].main_dosage_sum;
+    xtx_inv[predictor_ct + 1] = pending[pending_idx].main_dosage_ssq;
+    memcpy(&(xtx_inv[predictor_ct + 2]), cur_dotprods, nongeno_pred_ct * sizeof(double));
+    const GlmErr glm_err = LinearSemicomputedRegression(covarx_dotprod_inv, corr_inv, xt_y, predictor_ct, 0, sample_ct, pheno_ssq, max_corr, vif_thresh, xtx_inv, fitted_coefs, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, inverse_corr_buf);
+    double* beta_se = pending[pending_idx].beta_se;
+    if (!glm_err) {
+      beta_se[0] = fitted_coefs[1];
+      beta_se[1] = dbl_2d_buf[1];
+    } else {
+      memcpy(beta_se, &glm_err, 8);
+      beta_se[1] = -9.0;
+    }
+  }
+}
+
 typedef struct GlmLinearCtxStruct {
   GlmCtx* common;
 
@@ -6675,10 +8001,42 @@ typedef struct GlmLinearCtxStruct {
   double* covars_cmaj_y_d;
   double* local_covars_vcmaj_d[2];
   LinearAuxResult* block_aux;
+  // --glm loco-ridge: phenotype minus offset (sample_ct doubles per
+  // loco_chr_fo_slots value), and the corresponding xt_y_image rows
+  const double* loco_pheno_d;
+  const double* loco_xt_y_images;
 
   uint32_t subbatch_size;
+  // GlmLinear() only; 0 if GlmLinearGemmFlush() is never used
+  uint32_t gemm_block_size;
 } GlmLinearCtx;
 
+// Rare variants in hardcall-only .pgen files are mostly stored as difflists
+// against a hom-ref background.  When the sparse_optimization dot-product
+// path applies, the linear threads consume these directly, so per-variant
+// work is O(carriers) instead of O(samples); anything denser than
+// sample_ct / kGlmLinearDifflistDivisor is expanded to a genovec as before.
+CONSTI32(kGlmLinearDifflistDivisor, 32);
+
+uintptr_t GetLinearDifflistCachelineCt(uint32_t raw_sample_ct) {
+  const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+  // +2 for the top-level pointer arrays
+  return NypCtToCachelineCt(max_returned_difflist_len) + Int32CtToCachelineCt(max_returned_difflist_len) + 2;
+}
+
+// Space must have been reserved via GetLinearDifflistCachelineCt().
+void AllocLinearDifflistBufs(uint32_t raw_sample_ct, uint32_t calc_thread_ct, GlmCtx* common) {
+  const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+  const uintptr_t raregeno_alloc = NypCtToCachelineCt(max_returned_difflist_len) * kCacheline;
+  const uintptr_t difflist_sample_ids_alloc = Int32CtToCachelineCt(max_returned_difflist_len) * kCacheline;
+  common->raregenos = S_CAST(uintptr_t**, bigstack_alloc_raw_rd(calc_thread_ct * sizeof(intptr_t)));
+  common->difflist_sample_id_bufs = S_CAST(uint32_t**, bigstack_alloc_raw_rd(calc_thread_ct * sizeof(intptr_t)));
+  for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+    common->raregenos[tidx] = S_CAST(uintptr_t*, bigstack_alloc_raw(raregeno_alloc));
+    common->difflist_sample_id_bufs[tidx] = S_CAST(uint32_t*, bigstack_alloc_raw(difflist_sample_ids_alloc));
+  }
+}
+
 // possible todo: delete this, and GlmLinear(), if GlmLinearBatchThread is good
 // enough at the same job.
 THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
@@ -6696,6 +8054,12 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
     pgv.dosage_present = common->dosage_presents[tidx];
     pgv.dosage_main = common->dosage_mains[tidx];
   }
+  uintptr_t* raregeno = nullptr;
+  uint32_t* difflist_sample_ids = nullptr;
+  if (common->raregenos) {
+    raregeno = common->raregenos[tidx];
+    difflist_sample_ids = common->difflist_sample_id_bufs[tidx];
+  }
   unsigned char* workspace_buf = common->workspace_bufs[tidx];
   const uintptr_t* variant_include = common->variant_include;
   const uintptr_t* allele_idx_offsets = common->allele_idx_offsets;
@@ -6724,6 +8088,7 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
   const uintptr_t local_covar_ct = common->local_covar_ct;
   const uint32_t max_extra_allele_ct = common->max_extra_allele_ct;
   const uint32_t beta_se_multiallelic_fused = (!domdev_present) && (!model_dominant) && (!model_recessive) && (!common->tests_flag) && (!add_interactions);
+  const uint32_t gemm_block_size = ctx->gemm_block_size;
   uintptr_t max_sample_ct = MAXV(common->sample_ct, common->sample_ct_x);
   if (max_sample_ct < common->sample_ct_y) {
     max_sample_ct = common->sample_ct_y;
@@ -6795,6 +8160,7 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
       const double* cur_covars_cmaj;
       const uintptr_t* cur_parameter_subset;
       const uintptr_t* cur_joint_test_params;
+      const double* loco_xt_y_image = nullptr;
       uint32_t cur_sample_ct;
       uint32_t cur_covar_ct;
       uint32_t cur_constraint_ct;
@@ -6831,6 +8197,11 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
         cur_sample_ct = common->sample_ct;
         cur_covar_ct = common->covar_ct;
         cur_constraint_ct = common->constraint_ct;
+        if (ctx->loco_pheno_d) {
+          const uintptr_t loco_slot = common->loco_chr_fo_slots[chr_fo_idx];
+          cur_pheno = &(ctx->loco_pheno_d[loco_slot * cur_sample_ct]);
+          loco_xt_y_image = &(ctx->loco_xt_y_images[loco_slot * (cur_covar_ct + domdev_present + 2)]);
+        }
       }
       const uint32_t sample_ctl = BitCtToWordCt(cur_sample_ct);
       const uint32_t sample_ctl2 = NypCtToWordCt(cur_sample_ct);
@@ -6903,11 +8274,18 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
         // Rest of this matrix must be updated later, since cur_predictor_ct
         // changes at multiallelic variants.
       }
-      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLinearWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted));
+      double* gemm_geno_block = nullptr;
+      double* gemm_dotprods = nullptr;
+      LinearGemmPending* gemm_pending = nullptr;
+      if (gemm_block_size) {
+        gemm_geno_block = S_CAST(double*, arena_alloc_raw_rd(S_CAST(uintptr_t, gemm_block_size) * cur_sample_ct * sizeof(double), &workspace_iter));
+        gemm_dotprods = S_CAST(double*, arena_alloc_raw_rd(gemm_block_size * cur_biallelic_predictor_ct * sizeof(double), &workspace_iter));
+        gemm_pending = S_CAST(LinearGemmPending*, arena_alloc_raw_rd(gemm_block_size * sizeof(LinearGemmPending), &workspace_iter));
+      }
+      assert(S_CAST(uintptr_t, workspace_iter - workspace_buf) == GetLinearWorkspaceSize(cur_sample_ct, cur_biallelic_predictor_ct, max_extra_allele_ct, cur_constraint_ct, main_mutated + main_omitted, gemm_block_size));
       const double pheno_ssq_base = DotprodD(cur_pheno, cur_pheno, cur_sample_ct);
-      const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
-      const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
       const uint32_t sparse_optimization_eligible = (!is_x) && nm_precomp;
+      const uint32_t max_simple_difflist_len = (sparse_optimization_eligible && raregeno)? (cur_sample_ct / kGlmLinearDifflistDivisor) : 0;
       double geno_d_lookup[2];
       if (sparse_optimization_eligible) {
         geno_d_lookup[1] = 1.0;
@@ -6934,7 +8312,7 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
         const uintptr_t nonintercept_biallelic_pred_ct = cur_biallelic_predictor_ct - 1;
         memcpy(semicomputed_biallelic_corr_matrix, nm_precomp->corr_image, nonintercept_biallelic_pred_ct * nonintercept_biallelic_pred_ct * sizeof(double));
         memcpy(&(semicomputed_biallelic_inv_corr_sqrts[domdev_present_p1]), nm_precomp->corr_inv_sqrts, nongeno_pred_ct * sizeof(double));
-        xt_y_image = nm_precomp->xt_y_image;
+        xt_y_image = loco_xt_y_image? loco_xt_y_image : nm_precomp->xt_y_image;
       }
       PgrSampleSubsetIndex pssi;
       PgrSetSampleSubsetIndex(cur_sample_include_cumulative_popcounts, pgrp, &pssi);
@@ -6943,6 +8321,10 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
       // may be able to skip reinitialization of most of
       // nm_predictors_pmaj_buf.
       uint32_t prev_nm = 0;
+      // GlmLinear() already verified that only the main genotype predictor is
+      // reported, etc.
+      const uint32_t gemm_ok = gemm_block_size && xtx_image && (!main_omitted) && (!cur_constraint_ct);
+      uint32_t gemm_pending_ct = 0;
 
       STD_ARRAY_DECL(uint32_t, 4, genocounts);
       for (; variant_bidx != cur_variant_bidx_end; ++variant_bidx) {
@@ -6956,8 +8338,18 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
         const uint32_t allele_ct_m2 = allele_ct - 2;
         const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
         PglErr reterr;
+        // difflist_common_geno is 0 iff the current variant is held in
+        // raregeno/difflist_sample_ids instead of pgv.genovec; this only
+        // happens when sparse_optimization will be used.
+        uint32_t difflist_common_geno = UINT32_MAX;
+        uint32_t difflist_len = 0;
         if (!allele_ct_m2) {
-          reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          if (max_simple_difflist_len && prev_nm && ((!omitted_alleles) || (!omitted_alleles[variant_uidx]))) {
+            reterr = PgrGetDifflistOrGenovec(cur_sample_include, pssi, cur_sample_ct, max_simple_difflist_len, variant_uidx, pgrp, pgv.genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+            pgv.dosage_ct = 0;
+          } else {
+            reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          }
         } else {
           reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
           // todo: proper multiallelic dosage support
@@ -6966,8 +8358,21 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
           new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
           goto GlmLinearThread_err;
         }
-        ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-        GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+        if (difflist_common_geno != UINT32_MAX) {
+          ZeroTrailingNyps(difflist_len, raregeno);
+          GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
+          if (difflist_common_geno || (difflist_len > max_simple_difflist_len) || genocounts[3]) {
+            // LD-compressed, or has missing calls; fall back to dense path
+            PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, cur_sample_ct, difflist_len, pgv.genovec);
+            difflist_common_geno = UINT32_MAX;
+          } else {
+            genocounts[0] += cur_sample_ct - difflist_len;
+          }
+        }
+        if (difflist_common_geno == UINT32_MAX) {
+          ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+          GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+        }
         uint32_t missing_ct = genocounts[3];
         if (!missing_ct) {
           SetAllBits(cur_sample_ct, sample_nm);
@@ -7407,6 +8812,11 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
             // only need to do this part once per variant in multiallelic case
             double* nm_predictors_pmaj_iter = &(nm_predictors_pmaj_buf[nm_sample_ct * (parameter_uidx - main_omitted)]);
             if (missing_ct || (!prev_nm)) {
+              if (gemm_pending_ct) {
+                // about to overwrite the predictors these were queued with
+                GlmLinearGemmFlush(nm_predictors_pmaj_buf, nm_pheno_buf, gemm_geno_block, gemm_pending, xtx_image, xt_y_image, covarx_dotprod_inv, corr_inv, gemm_pending_ct, cur_sample_ct, cur_biallelic_predictor_ct, pheno_ssq_base, max_corr, vif_thresh, gemm_dotprods, xtx_inv, xt_y, fitted_coefs, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, inverse_corr_buf);
+                gemm_pending_ct = 0;
+              }
               // fill phenotype
               sample_midx_base = 0;
               uintptr_t sample_nm_bits = sample_nm[0];
@@ -7566,6 +8976,21 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
             // bugfix (12 Sep 2017): forgot to implement per-variant VIF and
             // max-corr checks
             if (xtx_image && prev_nm && (!allele_ct_m2)) {
+              if (gemm_ok && (!sparse_optimization)) {
+                // missing_ct is zero here, and nm_sample_ct == cur_sample_ct.
+                memcpy(&(gemm_geno_block[gemm_pending_ct * S_CAST(uintptr_t, cur_sample_ct)]), genotype_vals, cur_sample_ct * sizeof(double));
+                LinearGemmPending* cur_pending = &(gemm_pending[gemm_pending_ct]);
+                cur_pending->beta_se = beta_se_iter;
+                cur_pending->main_dosage_sum = main_dosage_sum;
+                cur_pending->main_dosage_ssq = main_dosage_ssq;
+                ++gemm_pending_ct;
+                if (gemm_pending_ct == gemm_block_size) {
+                  GlmLinearGemmFlush(nm_predictors_pmaj_buf, nm_pheno_buf, gemm_geno_block, gemm_pending, xtx_image, xt_y_image, covarx_dotprod_inv, corr_inv, gemm_pending_ct, cur_sample_ct, cur_biallelic_predictor_ct, pheno_ssq_base, max_corr, vif_thresh, gemm_dotprods, xtx_inv, xt_y, fitted_coefs, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, inverse_corr_buf);
+                  gemm_pending_ct = 0;
+                }
+                beta_se_iter = &(beta_se_iter[2 * max_reported_test_ct]);
+                continue;
+              }
               // only need to fill in additive and possibly domdev dot
               // products
               memcpy(xtx_inv, xtx_image, cur_predictor_ct * cur_predictor_ct * sizeof(double));
@@ -7577,8 +9002,18 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
                 double domdev_geno_prod = 0.0;
                 double* geno_dotprod_row = &(xtx_inv[cur_predictor_ct]);
                 double* domdev_dotprod_row = &(xtx_inv[2 * cur_predictor_ct]);
-                for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-                  uintptr_t geno_word = pgv.genovec[widx];
+                // In the difflist case, iterate over raregeno instead and map
+                // each position back through difflist_sample_ids.
+                const uintptr_t* geno_words = pgv.genovec;
+                const uint32_t* sample_idx_map = nullptr;
+                uint32_t geno_word_ct = sample_ctl2;
+                if (difflist_common_geno != UINT32_MAX) {
+                  geno_words = raregeno;
+                  sample_idx_map = difflist_sample_ids;
+                  geno_word_ct = NypCtToWordCt(difflist_len);
+                }
+                for (uint32_t widx = 0; widx != geno_word_ct; ++widx) {
+                  uintptr_t geno_word = geno_words[widx];
                   if (geno_word) {
                     const uint32_t sample_idx_base = widx * kBitsPerWordD2;
                     do {
@@ -7586,7 +9021,10 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
                       // since there are no missing values, we have a het if
                       // (lowest_set_bit & 1) is zero, and a hom-alt when
                       // it's one.
-                      const uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
+                      uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
+                      if (sample_idx_map) {
+                        sample_idx = sample_idx_map[sample_idx];
+                      }
                       const double geno_d = geno_d_lookup[lowest_set_bit & 1];
                       const double cur_pheno_val = nm_pheno_buf[sample_idx];
                       geno_pheno_prod += geno_d * cur_pheno_val;
@@ -7639,31 +9077,7 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
                   xtx_inv[cur_predictor_ct + 2] = xtx_inv[2 * cur_predictor_ct + 1];
                 }
               }
-              glm_err = CheckMaxCorrAndVifNm(xtx_inv, corr_inv, cur_predictor_ct, domdev_present_p1, cur_sample_ct_recip, cur_sample_ct_m1_recip, max_corr, vif_thresh, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, &(dbl_2d_buf[2 * cur_predictor_ct]), &(dbl_2d_buf[3 * cur_predictor_ct]));
-              if (glm_err) {
-                goto GlmLinearThread_skip_regression;
-              }
-              const double geno_ssq = xtx_inv[1 + cur_predictor_ct];
-              if (!domdev_present) {
-                xtx_inv[1 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
-                if (InvertRank1Symm(covarx_dotprod_inv, &(xtx_inv[1 + cur_predictor_ct]), cur_predictor_ct - 1, 1, geno_ssq, dbl_2d_buf, inverse_corr_buf)) {
-                  glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
-                  goto GlmLinearThread_skip_regression;
-                }
-              } else {
-                const double domdev_geno_prod = xtx_inv[2 + cur_predictor_ct];
-                const double domdev_ssq = xtx_inv[2 + 2 * cur_predictor_ct];
-                xtx_inv[2 + cur_predictor_ct] = xtx_inv[cur_predictor_ct];
-                xtx_inv[2 + 2 * cur_predictor_ct] = xtx_inv[2 * cur_predictor_ct];
-                if (InvertRank2Symm(covarx_dotprod_inv, &(xtx_inv[2 + cur_predictor_ct]), cur_predictor_ct - 2, cur_predictor_ct, 1, geno_ssq, domdev_geno_prod, domdev_ssq, dbl_2d_buf, inverse_corr_buf, &(inverse_corr_buf[2 * (cur_predictor_ct - 2)]))) {
-                  glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
-                  goto GlmLinearThread_skip_regression;
-                }
-              }
-              // need to make sure xtx_inv remains reflected in NOLAPACK case
-              memcpy(xtx_inv, dbl_2d_buf, cur_predictor_ct * cur_predictor_ct * sizeof(double));
-              ReflectMatrix(cur_predictor_ct, xtx_inv);
-              ColMajorVectorMatrixMultiplyStrided(xt_y, xtx_inv, cur_predictor_ct, cur_predictor_ct, cur_predictor_ct, fitted_coefs);
+              glm_err = LinearSemicomputedRegression(covarx_dotprod_inv, corr_inv, xt_y, cur_predictor_ct, domdev_present, cur_sample_ct, cur_pheno_ssq, max_corr, vif_thresh, xtx_inv, fitted_coefs, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, inverse_corr_buf);
             } else {
               // generic case
               // major categorical optimization possible here, some
@@ -7681,47 +9095,12 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
                 glm_err = SetGlmErr0(kGlmErrcodeRankDeficient);
                 goto GlmLinearThread_skip_regression;
               }
+              glm_err = LinearScaleVcovAndCheck(xt_y, fitted_coefs, cur_pheno_ssq, nm_sample_ct, cur_predictor_ct, xtx_inv, dbl_2d_buf);
+            }
+            if (glm_err) {
+              goto GlmLinearThread_skip_regression;
             }
             {
-              // RSS = y^T y - y^T X (X^T X)^{-1} X^T y
-              //     = cur_pheno_ssq - xt_y * fitted_coefs
-              // s^2 = RSS / df
-              // possible todo: improve numerical stability of this computation
-              // in non-mean-centered phenotype case
-              const double sigma = (cur_pheno_ssq - DotprodxD(xt_y, fitted_coefs, cur_predictor_ct)) / u31tod(nm_sample_ct - cur_predictor_ct);
-              for (uint32_t uii = 0; uii != cur_predictor_ct; ++uii) {
-                double* s_iter = &(xtx_inv[uii * cur_predictor_ct]);
-#ifdef NOLAPACK
-                for (uint32_t ujj = 0; ujj != cur_predictor_ct; ++ujj) {
-                  s_iter[ujj] *= sigma;
-                }
-#else
-                for (uint32_t ujj = 0; ujj <= uii; ++ujj) {
-                  s_iter[ujj] *= sigma;
-                }
-#endif
-              }
-              // validParameters() check
-              for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
-                const double xtx_inv_diag_element = xtx_inv[pred_uidx * (cur_predictor_ct + 1)];
-                if (xtx_inv_diag_element < 1e-20) {
-                  glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                  goto GlmLinearThread_skip_regression;
-                }
-                // use dbl_2d_buf[] to store diagonal square roots
-                dbl_2d_buf[pred_uidx] = sqrt(xtx_inv_diag_element);
-              }
-              dbl_2d_buf[0] = sqrt(xtx_inv[0]);
-              for (uint32_t pred_uidx = 1; pred_uidx != cur_predictor_ct; ++pred_uidx) {
-                const double cur_xtx_inv_diag_sqrt = 0.99999 * dbl_2d_buf[pred_uidx];
-                const double* xtx_inv_row = &(xtx_inv[pred_uidx * cur_predictor_ct]);
-                for (uint32_t pred_uidx2 = 0; pred_uidx2 != pred_uidx; ++pred_uidx2) {
-                  if (xtx_inv_row[pred_uidx2] > cur_xtx_inv_diag_sqrt * dbl_2d_buf[pred_uidx2]) {
-                    glm_err = SetGlmErr0(kGlmErrcodeInvalidResult);
-                    goto GlmLinearThread_skip_regression;
-                  }
-                }
-              }
               double* beta_se_iter2 = beta_se_iter;
               for (uint32_t pred_uidx = reported_pred_uidx_start; pred_uidx != reported_pred_uidx_biallelic_end; ++pred_uidx) {
                 // In the multiallelic-fused case, if the first allele is
@@ -7851,6 +9230,9 @@ THREAD_FUNC_DECL GlmLinearThread(void* raw_arg) {
           local_covars_iter = &(local_covars_iter[local_covar_ct * max_sample_ct]);
         }
       }
+      if (gemm_pending_ct) {
+        GlmLinearGemmFlush(nm_predictors_pmaj_buf, nm_pheno_buf, gemm_geno_block, gemm_pending, xtx_image, xt_y_image, covarx_dotprod_inv, corr_inv, gemm_pending_ct, cur_sample_ct, cur_biallelic_predictor_ct, pheno_ssq_base, max_corr, vif_thresh, gemm_dotprods, xtx_inv, xt_y, fitted_coefs, semicomputed_biallelic_corr_matrix, semicomputed_biallelic_inv_corr_sqrts, dbl_2d_buf, inverse_corr_buf);
+      }
     }
     while (0) {
     GlmLinearThread_err:
@@ -7869,8 +9251,10 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
   PglErr reterr = kPglRetSuccess;
   CompressStreamState css;
   ThreadGroup tg;
+  PgenPrefetch prefetch;
   PreinitCstream(&css);
   PreinitThreads(&tg);
+  PreinitPgenPrefetch(&prefetch);
   {
     GlmCtx* common = ctx->common;
     const uintptr_t* variant_include = common->variant_include;
@@ -7926,8 +9310,8 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
 
     const GlmFlags glm_flags = glm_info_ptr->flags;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
-    // forced-singlethreaded
-    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    // forced-singlethreaded; --glm resume appends to the truncated output file
+    reterr = InitCstreamAlloc(outname, common->ckpt_skip_variant_ct != 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
     if (unlikely(reterr)) {
       goto GlmLinear_ret_1;
     }
@@ -8025,15 +9409,20 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
 
     const uint32_t main_omitted = (parameter_subset && (!IsSet(parameter_subset, 1)));
     const uint32_t xmain_ct = main_mutated + main_omitted;
-    uintptr_t workspace_alloc = GetLinearWorkspaceSize(sample_ct, biallelic_predictor_ct, max_extra_allele_ct, constraint_ct, xmain_ct);
+    uint32_t gemm_block_size = 0;
+    if (hide_covar && (!include_intercept) && (!domdev_present) && (!main_mutated) && (!add_interactions) && (!local_covar_ct)) {
+      gemm_block_size = GetLinearGemmBlockSize(max_sample_ct);
+    }
+    ctx->gemm_block_size = gemm_block_size;
+    uintptr_t workspace_alloc = GetLinearWorkspaceSize(sample_ct, biallelic_predictor_ct, max_extra_allele_ct, constraint_ct, xmain_ct, gemm_block_size);
     if (sample_ct_x) {
-      const uintptr_t workspace_alloc_x = GetLinearWorkspaceSize(sample_ct_x, biallelic_predictor_ct_x, max_extra_allele_ct, constraint_ct_x, xmain_ct);
+      const uintptr_t workspace_alloc_x = GetLinearWorkspaceSize(sample_ct_x, biallelic_predictor_ct_x, max_extra_allele_ct, constraint_ct_x, xmain_ct, gemm_block_size);
       if (workspace_alloc_x > workspace_alloc) {
         workspace_alloc = workspace_alloc_x;
       }
     }
     if (sample_ct_y) {
-      const uintptr_t workspace_alloc_y = GetLinearWorkspaceSize(sample_ct_y, biallelic_predictor_ct_y, max_extra_allele_ct, constraint_ct_y, xmain_ct);
+      const uintptr_t workspace_alloc_y = GetLinearWorkspaceSize(sample_ct_y, biallelic_predictor_ct_y, max_extra_allele_ct, constraint_ct_y, xmain_ct, gemm_block_size);
       if (workspace_alloc_y > workspace_alloc) {
         workspace_alloc = workspace_alloc_y;
       }
@@ -8041,6 +9430,9 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     // +1 is for top-level common->workspace_bufs
     const uint32_t dosage_is_present = pgfip->gflags & kfPgenGlobalDosagePresent;
     uintptr_t thread_xalloc_cacheline_ct = (workspace_alloc / kCacheline) + 1;
+    if (!dosage_is_present) {
+      thread_xalloc_cacheline_ct += GetLinearDifflistCachelineCt(pgfip->raw_sample_ct);
+    }
 
     uintptr_t per_variant_xalloc_byte_ct = max_sample_ct * local_covar_ct * sizeof(double);
     uintptr_t per_alt_allele_xalloc_byte_ct = sizeof(LinearAuxResult);
@@ -8092,6 +9484,9 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
       common->workspace_bufs[tidx] = S_CAST(unsigned char*, bigstack_alloc_raw(workspace_alloc));
     }
+    if (!dosage_is_present) {
+      AllocLinearDifflistBufs(pgfip->raw_sample_ct, calc_thread_ct, common);
+    }
     common->err_info = (~0LLU) << 32;
     SetThreadFuncAndData(GlmLinearThread, ctx, &tg);
 
@@ -8182,6 +9577,10 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
       cswritep = strcpya_k(cswritep, "\tERRCODE");
     }
     AppendBinaryEoln(&cswritep);
+    if (common->ckpt_skip_variant_ct) {
+      // header line was already written by the earlier run
+      cswritep = css.overflow_buf;
+    }
 
     // Main workflow:
     // 1. Set n=0, load/skip block 0
@@ -8215,11 +9614,18 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     uint32_t allele_ct = 2;
     uint32_t omitted_allele_idx = 0;
     uintptr_t valid_allele_ct = 0;
+    reterr = PgenPrefetchStart(variant_include, raw_variant_ct, variant_ct, read_block_size, main_loadbufs, pgfip, &prefetch);
+    if (unlikely(reterr)) {
+      if (reterr == kPglRetNomem) {
+        goto GlmLinear_ret_NOMEM;
+      }
+      goto GlmLinear_ret_THREAD_CREATE_FAIL;
+    }
     logprintfww5("--glm linear regression on phenotype '%s': ", cur_pheno_name);
     fputs("0%", stdout);
     fflush(stdout);
     for (uint32_t variant_idx = 0; ; ) {
-      const uint32_t cur_block_variant_ct = MultireadNonempty(variant_include, &tg, raw_variant_ct, read_block_size, pgfip, &read_block_idx, &reterr);
+      const uint32_t cur_block_variant_ct = MultireadNonemptyP(variant_include, &tg, raw_variant_ct, read_block_size, &prefetch, pgfip, &read_block_idx, &reterr);
       if (unlikely(reterr)) {
         goto GlmLinear_ret_PGR_FAIL;
       }
@@ -8337,6 +9743,23 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
             variant_is_valid |= allele_is_valid;
             {
               const LinearAuxResult* auxp = &(cur_block_aux[allele_bidx]);
+              if (common->hits && allele_is_valid) {
+                double hit_ln_pval;
+                if (!cur_constraint_ct) {
+                  if (primary_beta == 0.0) {
+                    hit_ln_pval = 0.0;
+                  } else if (primary_se == 0.0) {
+                    hit_ln_pval = -DBL_MAX;
+                  } else {
+                    hit_ln_pval = TstatToLnP(primary_beta / primary_se, auxp->sample_obs_ct - cur_biallelic_predictor_ct - extra_allele_ct);
+                  }
+                } else {
+                  hit_ln_pval = FstatToLnP(primary_se / u31tod(cur_constraint_ct), cur_constraint_ct, auxp->sample_obs_ct);
+                }
+                if (unlikely(GlmHitsAdd(write_variant_uidx, cip->chr_file_order[chr_fo_idx], a1_allele_idx, auxp->sample_obs_ct, cur_constraint_ct != 0, primary_beta, primary_se, hit_ln_pval, common->hits))) {
+                  goto GlmLinear_ret_WRITE_FAIL;
+                }
+              }
               if (ln_pfilter <= 0.0) {
                 if (!allele_is_valid) {
                   goto GlmLinear_allele_iterate;
@@ -8630,6 +10053,12 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
             ClearBit(write_variant_uidx, valid_variants);
           }
         }
+        if (common->ckpt_fname) {
+          reterr = GlmCheckpointUpdate(common, variant_idx, &css, &cswritep);
+          if (unlikely(reterr)) {
+            goto GlmLinear_ret_1;
+          }
+        }
       }
       if (variant_idx == variant_ct) {
         break;
@@ -8682,6 +10111,7 @@ PglErr GlmLinear(const char* cur_pheno_name, const char* const* test_names, cons
     break;
   }
  GlmLinear_ret_1:
+  CleanupPgenPrefetch(&prefetch);
   CleanupThreads(&tg);
   CswriteCloseCond(&css, cswritep);
   BigstackReset(bigstack_mark);
@@ -8758,6 +10188,12 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
     pgv.dosage_present = common->dosage_presents[tidx];
     pgv.dosage_main = common->dosage_mains[tidx];
   }
+  uintptr_t* raregeno = nullptr;
+  uint32_t* difflist_sample_ids = nullptr;
+  if (common->raregenos) {
+    raregeno = common->raregenos[tidx];
+    difflist_sample_ids = common->difflist_sample_id_bufs[tidx];
+  }
   unsigned char* workspace_buf = common->workspace_bufs[tidx];
   const uintptr_t* variant_include = common->variant_include;
   const uintptr_t* allele_idx_offsets = common->allele_idx_offsets;
@@ -8978,6 +10414,7 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
       const double cur_sample_ct_recip = 1.0 / u31tod(cur_sample_ct);
       const double cur_sample_ct_m1_recip = 1.0 / u31tod(cur_sample_ct - 1);
       const uint32_t sparse_optimization_eligible = (!is_x) && nm_precomp;
+      const uint32_t max_simple_difflist_len = (sparse_optimization_eligible && raregeno)? (cur_sample_ct / kGlmLinearDifflistDivisor) : 0;
       double geno_d_lookup[2];
       if (sparse_optimization_eligible) {
         geno_d_lookup[1] = 1.0;
@@ -9026,8 +10463,18 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
         const uint32_t allele_ct_m2 = allele_ct - 2;
         const uint32_t expected_predictor_ct = cur_biallelic_predictor_ct + allele_ct_m2;
         PglErr reterr;
+        // difflist_common_geno is 0 iff the current variant is held in
+        // raregeno/difflist_sample_ids instead of pgv.genovec; this only
+        // happens when sparse_optimization will be used.
+        uint32_t difflist_common_geno = UINT32_MAX;
+        uint32_t difflist_len = 0;
         if (!allele_ct_m2) {
-          reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          if (max_simple_difflist_len && prev_nm && ((!omitted_alleles) || (!omitted_alleles[variant_uidx]))) {
+            reterr = PgrGetDifflistOrGenovec(cur_sample_include, pssi, cur_sample_ct, max_simple_difflist_len, variant_uidx, pgrp, pgv.genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+            pgv.dosage_ct = 0;
+          } else {
+            reterr = PgrGetD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, pgv.genovec, pgv.dosage_present, pgv.dosage_main, &(pgv.dosage_ct));
+          }
         } else {
           reterr = PgrGetMD(cur_sample_include, pssi, cur_sample_ct, variant_uidx, pgrp, &pgv);
           // todo: proper multiallelic dosage support
@@ -9036,8 +10483,21 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
           new_err_info = (S_CAST(uint64_t, variant_uidx) << 32) | S_CAST(uint32_t, reterr);
           goto GlmLinearSubbatchThread_err;
         }
-        ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
-        GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+        if (difflist_common_geno != UINT32_MAX) {
+          ZeroTrailingNyps(difflist_len, raregeno);
+          GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
+          if (difflist_common_geno || (difflist_len > max_simple_difflist_len) || genocounts[3]) {
+            // LD-compressed, or has missing calls; fall back to dense path
+            PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, cur_sample_ct, difflist_len, pgv.genovec);
+            difflist_common_geno = UINT32_MAX;
+          } else {
+            genocounts[0] += cur_sample_ct - difflist_len;
+          }
+        }
+        if (difflist_common_geno == UINT32_MAX) {
+          ZeroTrailingNyps(cur_sample_ct, pgv.genovec);
+          GenoarrCountFreqsUnsafe(pgv.genovec, cur_sample_ct, genocounts);
+        }
         uint32_t missing_ct = genocounts[3];
         if (!missing_ct) {
           SetAllBits(cur_sample_ct, sample_nm);
@@ -9647,8 +11107,18 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
                 double domdev_geno_prod = 0.0;
                 double* geno_dotprod_row = &(xtx_inv[cur_predictor_ct]);
                 double* domdev_dotprod_row = &(xtx_inv[2 * cur_predictor_ct]);
-                for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-                  uintptr_t geno_word = pgv.genovec[widx];
+                // In the difflist case, iterate over raregeno instead and map
+                // each position back through difflist_sample_ids.
+                const uintptr_t* geno_words = pgv.genovec;
+                const uint32_t* sample_idx_map = nullptr;
+                uint32_t geno_word_ct = sample_ctl2;
+                if (difflist_common_geno != UINT32_MAX) {
+                  geno_words = raregeno;
+                  sample_idx_map = difflist_sample_ids;
+                  geno_word_ct = NypCtToWordCt(difflist_len);
+                }
+                for (uint32_t widx = 0; widx != geno_word_ct; ++widx) {
+                  uintptr_t geno_word = geno_words[widx];
                   if (geno_word) {
                     const uint32_t sample_idx_base = widx * kBitsPerWordD2;
                     do {
@@ -9656,7 +11126,10 @@ THREAD_FUNC_DECL GlmLinearSubbatchThread(void* raw_arg) {
                       // since there are no missing values, we have a het if
                       // (lowest_set_bit & 1) is zero, and a hom-alt when
                       // it's one.
-                      const uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
+                      uint32_t sample_idx = sample_idx_base + (lowest_set_bit / 2);
+                      if (sample_idx_map) {
+                        sample_idx = sample_idx_map[sample_idx];
+                      }
                       const double geno_d = geno_d_lookup[lowest_set_bit & 1];
                       for (uintptr_t pred_idx = domdev_present + 2; pred_idx != cur_predictor_ct; ++pred_idx) {
                         geno_dotprod_row[pred_idx] += geno_d * nm_predictors_pmaj_buf[pred_idx * nm_sample_ct + sample_idx];
@@ -9985,7 +11458,9 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
   uint32_t subbatch_size = 0;
   PglErr reterr = kPglRetSuccess;
   ThreadGroup tg;
+  PgenPrefetch prefetch;
   PreinitThreads(&tg);
+  PreinitPgenPrefetch(&prefetch);
   {
     GlmCtx* common = ctx->common;
     const uintptr_t* variant_include = common->variant_include;
@@ -10212,6 +11687,9 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
         }
       }
       uintptr_t thread_xalloc_cacheline_ct = (workspace_alloc / kCacheline) + 1;
+      if (!dosage_is_present) {
+        thread_xalloc_cacheline_ct += GetLinearDifflistCachelineCt(pgfip->raw_sample_ct);
+      }
       uintptr_t per_variant_xalloc_byte_ct = max_sample_ct * local_covar_ct * sizeof(double);
       uintptr_t per_alt_allele_xalloc_byte_ct = sizeof(LinearAuxResult);
       if (beta_se_multiallelic_fused) {
@@ -10263,6 +11741,9 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
     for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
       common->workspace_bufs[tidx] = S_CAST(unsigned char*, bigstack_alloc_raw(workspace_alloc));
     }
+    if (!dosage_is_present) {
+      AllocLinearDifflistBufs(pgfip->raw_sample_ct, calc_thread_ct, common);
+    }
     common->err_info = (~0LLU) << 32;
     SetThreadFuncAndData(GlmLinearSubbatchThread, ctx, &tg);
 
@@ -10287,6 +11768,9 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
     if (ci_col) {
       ci_zt = QuantileToZscore((ci_size + 1.0) * 0.5);
     }
+    // Output-stream and --pgen-prefetch buffers are allocated per subbatch,
+    // and released at the end of it.
+    unsigned char* bigstack_mark3 = g_bigstack_base;
     for (uint32_t subbatch_idx = 0; subbatch_idx != subbatch_ct; ++subbatch_idx) {
       const uint32_t pheno_uidx_start = IdxToUidxBasic(pheno_batch, subbatch_idx * subbatch_size);
       if (subbatch_idx == subbatch_ct - 1) {
@@ -10423,6 +11907,13 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
       uint32_t next_print_variant_idx = variant_ct / 100;
       uint32_t allele_ct = 2;
       uint32_t omitted_allele_idx = 0;
+      reterr = PgenPrefetchStart(variant_include, raw_variant_ct, variant_ct, read_block_size, main_loadbufs, pgfip, &prefetch);
+      if (unlikely(reterr)) {
+        if (reterr == kPglRetNomem) {
+          goto GlmLinearBatch_ret_NOMEM;
+        }
+        goto GlmLinearBatch_ret_THREAD_CREATE_FAIL;
+      }
       if (subbatch_size > 1) {
         logprintfww5("--glm linear regression on quantitative phenotypes #%u-%u: ", completed_pheno_ct + 1, completed_pheno_ct + subbatch_size);
       } else {
@@ -10434,7 +11925,7 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
       pgfip->block_base = main_loadbufs[0];
       ReinitThreads(&tg);
       for (uint32_t variant_idx = 0; ; ) {
-        const uint32_t cur_block_variant_ct = MultireadNonempty(variant_include, &tg, raw_variant_ct, read_block_size, pgfip, &read_block_idx, &reterr);
+        const uint32_t cur_block_variant_ct = MultireadNonemptyP(variant_include, &tg, raw_variant_ct, read_block_size, &prefetch, pgfip, &read_block_idx, &reterr);
         if (unlikely(reterr)) {
           goto GlmLinearBatch_ret_PGR_FAIL;
         }
@@ -10849,56 +12340,1556 @@ PglErr GlmLinearBatch(const uintptr_t* pheno_batch, const PhenoCol* pheno_cols,
           fflush(stdout);
           next_print_variant_idx = (pct * S_CAST(uint64_t, variant_ct)) / 100;
         }
-        ++read_block_idx;
-        prev_block_variant_ct = cur_block_variant_ct;
-        variant_idx += cur_block_variant_ct;
-        // crucially, this is independent of the PgenReader block_base
-        // pointers
-        pgfip->block_base = main_loadbufs[parity];
+        ++read_block_idx;
+        prev_block_variant_ct = cur_block_variant_ct;
+        variant_idx += cur_block_variant_ct;
+        // crucially, this is independent of the PgenReader block_base
+        // pointers
+        pgfip->block_base = main_loadbufs[parity];
+      }
+      for (uintptr_t fidx = 0; fidx != subbatch_size; ++fidx) {
+        if (unlikely(CswriteCloseNull(&(css_arr[fidx]), cswritep_arr[fidx]))) {
+          goto GlmLinearBatch_ret_WRITE_FAIL;
+        }
+      }
+      if (pct > 10) {
+        putc_unlocked('\b', stdout);
+      }
+      fputs("\b\b", stdout);
+      CleanupPgenPrefetch(&prefetch);
+      BigstackReset(bigstack_mark3);
+      logputs("done.\n");
+      // bugfix (12 May 2019): added batch_size instead of subbatch_size here
+      completed_pheno_ct += subbatch_size;
+    }
+    outname_end[1] = '\0';
+    logprintfww("Results written to %s<phenotype name>.glm.linear%s .\n", outname, output_zst? ".zst" : "");
+  }
+  while (0) {
+  GlmLinearBatch_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  GlmLinearBatch_ret_TSTREAM_FAIL:
+    TextStreamErrPrint("--glm local-covar= file", local_covar_txsp);
+    break;
+  GlmLinearBatch_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  GlmLinearBatch_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  GlmLinearBatch_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  GlmLinearBatch_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  }
+ GlmLinearBatch_ret_1:
+  CleanupPgenPrefetch(&prefetch);
+  CleanupThreads(&tg);
+  if (css_arr) {
+    for (uintptr_t fidx = 0; fidx != subbatch_size; ++fidx) {
+      CswriteCloseCond(&(css_arr[fidx]), cswritep_arr[fidx]);
+    }
+  }
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+// Upper bound on --glm stepwise= signal count per phenotype; this bounds the
+// per-candidate predictor cross-product cache.
+CONSTI32(kGlmStepwiseMaxSignalCt, 256);
+
+typedef struct GlmStepwiseUpdateCtxStruct {
+  const float* geno_cache;
+  const double* new_geno_d;
+  uint32_t sample_ct;
+  uint32_t cand_ct;
+  uint32_t max_pred_ct;
+
+  uint32_t cur_pred_ct;
+
+  double* cand_qt_dotprods;
+} GlmStepwiseUpdateCtx;
+
+// Fills in every candidate's dot product with the newly selected variant.
+// Each thread owns a fixed contiguous candidate range, and the summation order
+// doesn't depend on the thread count.
+THREAD_FUNC_DECL GlmStepwiseUpdateThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  GlmStepwiseUpdateCtx* ctx = S_CAST(GlmStepwiseUpdateCtx*, arg->sharedp->context);
+  const uint32_t thread_ct = GetThreadCt(arg->sharedp);
+  const float* geno_cache = ctx->geno_cache;
+  const double* new_geno_d = ctx->new_geno_d;
+  const uintptr_t sample_ct = ctx->sample_ct;
+  const uint32_t cand_ct = ctx->cand_ct;
+  const uintptr_t max_pred_ct = ctx->max_pred_ct;
+  double* cand_qt_dotprods = ctx->cand_qt_dotprods;
+  const uint32_t cand_idx_start = (S_CAST(uint64_t, cand_ct) * tidx) / thread_ct;
+  const uint32_t cand_idx_end = (S_CAST(uint64_t, cand_ct) * (tidx + 1)) / thread_ct;
+  do {
+    const uint32_t cur_pred_ct = ctx->cur_pred_ct;
+    for (uint32_t cand_idx = cand_idx_start; cand_idx != cand_idx_end; ++cand_idx) {
+      const float* cur_geno = &(geno_cache[cand_idx * sample_ct]);
+      double dotprod = 0.0;
+      for (uintptr_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        dotprod += new_geno_d[sample_idx] * S_CAST(double, cur_geno[sample_idx]);
+      }
+      cand_qt_dotprods[cand_idx * max_pred_ct + cur_pred_ct] = dotprod;
+    }
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// --glm stepwise=: forward stepwise conditional analysis of one quantitative
+// phenotype.  Every eligible variant's mean-imputed, mean-centered A1 dosage
+// vector is loaded once into a float cache.  Each step then scores all
+// remaining candidates against the current predictor set Q = [intercept,
+// covariates, selected variants] via (Q^T Q)^{-1} and the cached Q^T g / g^T g
+// / g^T y products, adds the best one if its conditional p-value passes the
+// threshold, and extends (Q^T Q)^{-1} with InvertRank1Symm().  Only one new
+// dot product per candidate is needed per step.
+PglErr GlmLinearStepwise(const char* cur_pheno_name, const uint32_t* variant_bps, const char* const* variant_ids, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const char* outname, uint32_t raw_sample_ct, uint32_t max_chr_blen, double output_min_ln, uint32_t max_thread_ct, uintptr_t overflow_buf_size, PgenReader* simple_pgrp, GlmLinearCtx* ctx) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  char* cswritep = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  CompressStreamState css;
+  ThreadGroup tg;
+  PreinitCstream(&css);
+  PreinitThreads(&tg);
+  {
+    GlmCtx* common = ctx->common;
+    const uintptr_t* variant_include = common->variant_include;
+    const ChrInfo* cip = common->cip;
+    const uintptr_t* allele_idx_offsets = common->allele_idx_offsets;
+    const AlleleCode* omitted_alleles = common->omitted_alleles;
+    const uintptr_t* sample_include = common->sample_include;
+    const uint32_t sample_ct = common->sample_ct;
+    const uint32_t covar_ct = common->covar_ct;
+    const uint32_t variant_ct = common->variant_ct;
+    const double* pheno_d = ctx->pheno_d;
+    const double* covars_cmaj_d = ctx->covars_cmaj_d;
+    const GlmFlags glm_flags = glm_info_ptr->flags;
+    const double ln_thresh = glm_info_ptr->stepwise_ln_thresh;
+    // a candidate is skipped when its VIF w.r.t. the current predictors
+    // exceeds this
+    const double vif_thresh = common->vif_thresh;
+    const uint32_t base_pred_ct = covar_ct + 1;
+
+    // 1. Identify candidates: biallelic variants on diploid autosomes.
+    uint32_t* cand_vidxs;
+    if (unlikely(bigstack_alloc_u32(variant_ct, &cand_vidxs))) {
+      goto GlmLinearStepwise_ret_NOMEM;
+    }
+    uint32_t cand_ct = 0;
+    {
+      uintptr_t variant_uidx_base = 0;
+      uintptr_t cur_bits = variant_include[0];
+      uint32_t chr_end = 0;
+      uint32_t chr_is_eligible = 0;
+      for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+        const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+        if (variant_uidx >= chr_end) {
+          const uint32_t chr_fo_idx = GetVariantChrFoIdx(cip, variant_uidx);
+          const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+          chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+          chr_is_eligible = chr_idx && (chr_idx <= cip->autosome_ct) && (!IsSet(cip->haploid_mask, chr_idx));
+        }
+        if ((!chr_is_eligible) || (allele_idx_offsets && (allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx] != 2))) {
+          continue;
+        }
+        cand_vidxs[cand_ct++] = variant_uidx;
+      }
+    }
+    BigstackShrinkTop(cand_vidxs, cand_ct * sizeof(int32_t));
+    if (cand_ct != variant_ct) {
+      logerrprintfww("Warning: --glm stepwise= only considers biallelic variants on diploid autosomes; skipping %u other variant%s.\n", variant_ct - cand_ct, (variant_ct - cand_ct == 1)? "" : "s");
+    }
+    if (unlikely(!cand_ct)) {
+      logerrputs("Error: No eligible variants for --glm stepwise=.\n");
+      goto GlmLinearStepwise_ret_DEGENERATE_DATA;
+    }
+    uint32_t max_signal_ct = MINV(cand_ct, kGlmStepwiseMaxSignalCt);
+    if (sample_ct < base_pred_ct + max_signal_ct + 2) {
+      if (unlikely(sample_ct < base_pred_ct + 3)) {
+        logerrputs("Error: Too few samples for --glm stepwise=.\n");
+        goto GlmLinearStepwise_ret_DEGENERATE_DATA;
+      }
+      max_signal_ct = sample_ct - base_pred_ct - 2;
+    }
+    const uintptr_t max_pred_ct = base_pred_ct + max_signal_ct;
+
+    // 2. Load the genotype cache.
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+    PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
+    float* geno_cache;
+    double* cand_ssqs;
+    double* cand_y_dotprods;
+    double* cand_qt_dotprods;
+    double* base_preds_pmaj;
+    double* qtq_invs[2];
+    double* qt_y;
+    double* ainv_b_buf;
+    double* cur_geno_d;
+    uintptr_t* selected;
+    uint32_t* signal_cand_idxs;
+    double* signal_stats;
+    MatrixInvertBuf1* inv_1d_buf;
+    double* dbl_2d_buf;
+    if (unlikely(BigstackAllocPgv(sample_ct, 0, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
+                 bigstack_alloc_d(cand_ct, &cand_ssqs) ||
+                 bigstack_alloc_d(cand_ct, &cand_y_dotprods) ||
+                 bigstack_alloc_d(max_pred_ct * cand_ct, &cand_qt_dotprods) ||
+                 bigstack_alloc_d(base_pred_ct * S_CAST(uintptr_t, sample_ct), &base_preds_pmaj) ||
+                 bigstack_alloc_d(max_pred_ct * max_pred_ct, &(qtq_invs[0])) ||
+                 bigstack_alloc_d(max_pred_ct * max_pred_ct, &(qtq_invs[1])) ||
+                 bigstack_alloc_d(max_pred_ct, &qt_y) ||
+                 bigstack_alloc_d(max_pred_ct, &ainv_b_buf) ||
+                 bigstack_alloc_d(sample_ct, &cur_geno_d) ||
+                 bigstack_calloc_w(BitCtToWordCt(cand_ct), &selected) ||
+                 bigstack_alloc_u32(max_signal_ct, &signal_cand_idxs) ||
+                 bigstack_alloc_d(3 * max_signal_ct, &signal_stats) ||
+                 BIGSTACK_ALLOC_X(MatrixInvertBuf1, base_pred_ct * kMatrixInvertBuf1CheckedAlloc, &inv_1d_buf) ||
+                 bigstack_alloc_d(base_pred_ct * MAXV(base_pred_ct, 7), &dbl_2d_buf) ||
+                 bigstack_alloc_f(S_CAST(uintptr_t, cand_ct) * sample_ct, &geno_cache))) {
+      goto GlmLinearStepwise_ret_NOMEM;
+    }
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      base_preds_pmaj[sample_idx] = 1.0;
+    }
+    if (covar_ct) {
+      memcpy(&(base_preds_pmaj[sample_ct]), covars_cmaj_d, covar_ct * S_CAST(uintptr_t, sample_ct) * sizeof(double));
+    }
+    logprintfww5("--glm stepwise=: Loading %u variant%s for phenotype '%s'... ", cand_ct, (cand_ct == 1)? "" : "s", cur_pheno_name);
+    fputs("0%", stdout);
+    fflush(stdout);
+    PgrSampleSubsetIndex pssi;
+    PgrSetSampleSubsetIndex(common->sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+    uint32_t pct = 0;
+    uint32_t next_print_cand_idx = cand_ct / 100;
+    for (uint32_t cand_idx = 0; cand_idx != cand_ct; ++cand_idx) {
+      const uint32_t variant_uidx = cand_vidxs[cand_idx];
+      // A1 is the non-omitted allele.
+      const uint32_t a1_is_ref = omitted_alleles && omitted_alleles[variant_uidx];
+      float* cur_geno = &(geno_cache[cand_idx * S_CAST(uintptr_t, sample_ct)]);
+      uint32_t missing_ct;
+      reterr = PgrGetDenseDosageF(sample_include, pssi, sample_ct, variant_uidx, a1_is_ref? -1.0 : 1.0, a1_is_ref? 2.0 : 0.0, -9.0, simple_pgrp, pgv.genovec, raregeno_buf, difflist_sample_ids_buf, pgv.dosage_present, pgv.dosage_main, &missing_ct, cur_geno);
+      if (unlikely(reterr)) {
+        goto GlmLinearStepwise_ret_PGR_FAIL;
+      }
+      double geno_sum = 0.0;
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        const double dxx = cur_geno[sample_idx];
+        if (dxx >= 0.0) {
+          geno_sum += dxx;
+        }
+      }
+      const double geno_mean = (missing_ct == sample_ct)? 0.0 : (geno_sum / u31tod(sample_ct - missing_ct));
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        const double dxx = cur_geno[sample_idx];
+        const double centered = (dxx >= 0.0)? (dxx - geno_mean) : 0.0;
+        cur_geno[sample_idx] = S_CAST(float, centered);
+        cur_geno_d[sample_idx] = centered;
+      }
+      cand_ssqs[cand_idx] = DotprodD(cur_geno_d, cur_geno_d, sample_ct);
+      cand_y_dotprods[cand_idx] = DotprodD(cur_geno_d, pheno_d, sample_ct);
+      RowMajorMatrixMultiply(base_preds_pmaj, cur_geno_d, base_pred_ct, 1, sample_ct, &(cand_qt_dotprods[cand_idx * max_pred_ct]));
+      if (cand_idx >= next_print_cand_idx) {
+        if (pct > 10) {
+          putc_unlocked('\b', stdout);
+        }
+        pct = (cand_idx * 100LLU) / cand_ct;
+        printf("\b\b%u%%", pct++);
+        fflush(stdout);
+        next_print_cand_idx = (pct * S_CAST(uint64_t, cand_ct)) / 100;
+      }
+    }
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\b", stdout);
+    logputs("done.\n");
+
+    // 3. Base model.
+    uint32_t cur_pred_ct = base_pred_ct;
+    double* qtq_inv = qtq_invs[0];
+    MultiplySelfTranspose(base_preds_pmaj, base_pred_ct, sample_ct, qtq_inv);
+    if (unlikely(InvertSymmdefMatrixChecked(base_pred_ct, qtq_inv, inv_1d_buf, dbl_2d_buf))) {
+      logerrputs("Error: --glm stepwise= covariate matrix inversion failed.\n");
+      goto GlmLinearStepwise_ret_DEGENERATE_DATA;
+    }
+    ReflectMatrix(base_pred_ct, qtq_inv);
+    RowMajorMatrixMultiply(base_preds_pmaj, pheno_d, base_pred_ct, 1, sample_ct, qt_y);
+    const double y_ssq = DotprodD(pheno_d, pheno_d, sample_ct);
+
+    // 4. Forward selection.
+    GlmStepwiseUpdateCtx update_ctx;
+    update_ctx.geno_cache = geno_cache;
+    update_ctx.new_geno_d = cur_geno_d;
+    update_ctx.sample_ct = sample_ct;
+    update_ctx.cand_ct = cand_ct;
+    update_ctx.max_pred_ct = max_pred_ct;
+    update_ctx.cand_qt_dotprods = cand_qt_dotprods;
+    if (unlikely(SetThreadCt(MINV(max_thread_ct, cand_ct), &tg))) {
+      goto GlmLinearStepwise_ret_NOMEM;
+    }
+    SetThreadFuncAndData(GlmStepwiseUpdateThread, &update_ctx, &tg);
+    uint32_t signal_ct = 0;
+    while (signal_ct != max_signal_ct) {
+      // residual y sum of squares under the current model
+      RowMajorMatrixMultiply(qtq_inv, qt_y, cur_pred_ct, 1, cur_pred_ct, ainv_b_buf);
+      const double resid_y_ssq = y_ssq - DotprodD(qt_y, ainv_b_buf, cur_pred_ct);
+      const uint32_t df = sample_ct - cur_pred_ct - 1;
+      double best_ln_pval = 0.0;
+      double best_abs_tstat = -1.0;
+      uint32_t best_cand_idx = UINT32_MAX;
+      double best_beta = 0.0;
+      double best_se = 0.0;
+      for (uint32_t cand_idx = 0; cand_idx != cand_ct; ++cand_idx) {
+        if (IsSet(selected, cand_idx)) {
+          continue;
+        }
+        const double* cur_qt_g = &(cand_qt_dotprods[cand_idx * max_pred_ct]);
+        const double geno_ssq = cand_ssqs[cand_idx];
+        // ainv_b_buf := (Q^T Q)^{-1} Q^T g
+        RowMajorMatrixMultiply(qtq_inv, cur_qt_g, cur_pred_ct, 1, cur_pred_ct, ainv_b_buf);
+        const double resid_geno_ssq = geno_ssq - DotprodD(cur_qt_g, ainv_b_buf, cur_pred_ct);
+        if ((!(resid_geno_ssq > 0.0)) || (geno_ssq > vif_thresh * resid_geno_ssq)) {
+          continue;
+        }
+        const double resid_gy = cand_y_dotprods[cand_idx] - DotprodD(qt_y, ainv_b_buf, cur_pred_ct);
+        const double beta = resid_gy / resid_geno_ssq;
+        const double rss = resid_y_ssq - beta * resid_gy;
+        if (!(rss > 0.0)) {
+          continue;
+        }
+        const double se = sqrt(rss / (u31tod(df) * resid_geno_ssq));
+        const double abs_tstat = fabs(beta / se);
+        if (abs_tstat > best_abs_tstat) {
+          best_abs_tstat = abs_tstat;
+          best_cand_idx = cand_idx;
+          best_beta = beta;
+          best_se = se;
+        }
+      }
+      if (best_cand_idx == UINT32_MAX) {
+        break;
+      }
+      best_ln_pval = TstatToLnP(best_abs_tstat, df);
+      if (best_ln_pval > ln_thresh) {
+        break;
+      }
+      SetBit(best_cand_idx, selected);
+      signal_cand_idxs[signal_ct] = best_cand_idx;
+      signal_stats[3 * signal_ct] = best_beta;
+      signal_stats[3 * signal_ct + 1] = best_se;
+      signal_stats[3 * signal_ct + 2] = best_ln_pval;
+      ++signal_ct;
+      if (signal_ct == max_signal_ct) {
+        break;
+      }
+      // Extend (Q^T Q)^{-1}, Q^T y, and every candidate's Q^T g.
+      double* new_qtq_inv = (qtq_inv == qtq_invs[0])? qtq_invs[1] : qtq_invs[0];
+      if (unlikely(InvertRank1Symm(qtq_inv, &(cand_qt_dotprods[best_cand_idx * max_pred_ct]), cur_pred_ct, cur_pred_ct, cand_ssqs[best_cand_idx], new_qtq_inv, ainv_b_buf))) {
+        // shouldn't be possible given the VIF check
+        break;
+      }
+      ReflectMatrix(cur_pred_ct + 1, new_qtq_inv);
+      qtq_inv = new_qtq_inv;
+      qt_y[cur_pred_ct] = cand_y_dotprods[best_cand_idx];
+      const float* new_geno = &(geno_cache[best_cand_idx * S_CAST(uintptr_t, sample_ct)]);
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        cur_geno_d[sample_idx] = S_CAST(double, new_geno[sample_idx]);
+      }
+      update_ctx.cur_pred_ct = cur_pred_ct;
+      if (unlikely(SpawnThreads(&tg))) {
+        goto GlmLinearStepwise_ret_THREAD_CREATE_FAIL;
+      }
+      JoinThreads(&tg);
+      cand_qt_dotprods[best_cand_idx * max_pred_ct + cur_pred_ct] = cand_ssqs[best_cand_idx];
+      ++cur_pred_ct;
+    }
+
+    // 5. Report selected signals, in selection order.
+    const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    if (unlikely(reterr)) {
+      goto GlmLinearStepwise_ret_1;
+    }
+    const uint32_t report_neglog10p = (glm_flags / kfGlmLog10) & 1;
+    cswritep = strcpya_k(cswritep, "#STEP\tCHROM\tPOS\tID\tREF\tALT\tA1\tOBS_CT\tBETA\tSE\tT_STAT\t");
+    if (report_neglog10p) {
+      cswritep = strcpya_k(cswritep, "LOG10_");
+    }
+    *cswritep++ = 'P';
+    AppendBinaryEoln(&cswritep);
+    char* chr_buf;
+    if (unlikely(bigstack_alloc_c(max_chr_blen, &chr_buf))) {
+      goto GlmLinearStepwise_ret_NOMEM;
+    }
+    for (uint32_t signal_idx = 0; signal_idx != signal_ct; ++signal_idx) {
+      const uint32_t variant_uidx = cand_vidxs[signal_cand_idxs[signal_idx]];
+      const uintptr_t allele_idx_offset_base = allele_idx_offsets? allele_idx_offsets[variant_uidx] : (2 * variant_uidx);
+      const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+      cswritep = u32toa_x(signal_idx + 1, '\t', cswritep);
+      char* chr_name_end = chrtoa(cip, GetVariantChr(cip, variant_uidx), chr_buf);
+      cswritep = memcpyax(cswritep, chr_buf, chr_name_end - chr_buf, '\t');
+      cswritep = u32toa_x(variant_bps[variant_uidx], '\t', cswritep);
+      cswritep = strcpyax(cswritep, variant_ids[variant_uidx], '\t');
+      cswritep = strcpyax(cswritep, cur_alleles[0], '\t');
+      cswritep = strcpyax(cswritep, cur_alleles[1], '\t');
+      const uint32_t a1_is_ref = omitted_alleles && omitted_alleles[variant_uidx];
+      cswritep = strcpyax(cswritep, cur_alleles[1 - a1_is_ref], '\t');
+      cswritep = u32toa_x(sample_ct, '\t', cswritep);
+      const double beta = signal_stats[3 * signal_idx];
+      const double se = signal_stats[3 * signal_idx + 1];
+      const double ln_pval = signal_stats[3 * signal_idx + 2];
+      cswritep = dtoa_g(beta, cswritep);
+      *cswritep++ = '\t';
+      cswritep = dtoa_g(se, cswritep);
+      *cswritep++ = '\t';
+      cswritep = dtoa_g(beta / se, cswritep);
+      *cswritep++ = '\t';
+      if (report_neglog10p) {
+        cswritep = dtoa_g((-kRecipLn10) * ln_pval, cswritep);
+      } else {
+        cswritep = lntoa_g(MAXV(ln_pval, output_min_ln), cswritep);
+      }
+      AppendBinaryEoln(&cswritep);
+      if (unlikely(Cswrite(&css, &cswritep))) {
+        goto GlmLinearStepwise_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(CswriteCloseNull(&css, cswritep))) {
+      goto GlmLinearStepwise_ret_WRITE_FAIL;
+    }
+    logprintfww("--glm stepwise=: %u independent signal%s found for phenotype '%s'%s.\n", signal_ct, (signal_ct == 1)? "" : "s", cur_pheno_name, (signal_ct == max_signal_ct)? " (limit reached)" : "");
+    logprintf("Results written to %s .\n", outname);
+  }
+  while (0) {
+  GlmLinearStepwise_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  GlmLinearStepwise_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  GlmLinearStepwise_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  GlmLinearStepwise_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  GlmLinearStepwise_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  }
+ GlmLinearStepwise_ret_1:
+  CleanupThreads(&tg);
+  CswriteCloseCond(&css, cswritep);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+// --glm set-test-bed{0,1}= rare-variant set tests.
+//
+// Per-variant score statistics U_j = g_j^T (y - mu) and their null covariance
+// Sigma = phi * (G^T W G - G^T W X (X^T W X)^{-1} X^T W G) are computed once
+// per phenotype; every set test is then a function of (w o U, diag(w) Sigma
+// diag(w)) restricted to the set's variants, where w are the Beta(1,25)
+// MAF weights.  Genotypes are kept as sparse minor-allele carrier lists, so
+// building a set's Sigma block only touches carriers.
+CONSTI32(kGlmSetDifflistDivisor, 16);
+CONSTI32(kGlmSetRhoCt, 7);
+static const double kGlmSetRhos[kGlmSetRhoCt] = {0.0, 0.01, 0.04, 0.09, 0.25, 0.5, 1.0};
+// the SKAT-O mixture integral is evaluated over chisq(1) values in [0, 40]
+CONSTI32(kGlmSetSkatoPanelCt, 256);
+
+ENUM_U31_DEF_START()
+  kGlmSetResultBurdenZ,
+  kGlmSetResultBurdenLnP,
+  kGlmSetResultSkatQ,
+  kGlmSetResultSkatLnP,
+  kGlmSetResultSkatoRho,
+  kGlmSetResultSkatoLnP,
+
+  kGlmSetResultCt
+ENUM_U31_DEF_END(GlmSetResultIdx);
+
+typedef struct GlmSetTestCtxStruct {
+  // Carriers of variant k start at carriers[carrier_starts[k]]: hets, then
+  // minor-allele homozygotes, then missing calls, with counts in
+  // carrier_cts[3k..3k+2].
+  const uintptr_t* carrier_starts;
+  const uint32_t* carrier_cts;
+  const uint32_t* carriers;
+  // per-sample null-model weights; nullptr means all 1
+  const double* ww;
+  const double* missing_vals;
+  const double* var_weights;
+  const double* var_scores;
+  // pred_ct values per variant: G^T W X, and (X^T W X)^{-1} X^T W G
+  const double* var_gwx;
+  const double* var_ainv_gwx;
+  const uint32_t* set_vidx_starts;
+  const uint32_t* set_vidxs;
+  const uint32_t* set_order;
+  double** scatter_bufs;
+  double** mat_bufs;
+  double phi;
+  uint32_t pred_ct;
+  uint32_t max_set_vct;
+  uint32_t nonempty_set_ct;
+
+  uint32_t next_order_idx;
+  double* results;
+} GlmSetTestCtx;
+
+// Returns sum_i g_i * vals[i] over the variant's carriers.
+static inline double GlmSetCarrierDot(const uint32_t* carriers, const uint32_t* cts, double missing_val, const double* vals) {
+  double het_sum = 0.0;
+  for (uint32_t uii = 0; uii != cts[0]; ++uii) {
+    het_sum += vals[*carriers++];
+  }
+  double hom_sum = 0.0;
+  for (uint32_t uii = 0; uii != cts[1]; ++uii) {
+    hom_sum += vals[*carriers++];
+  }
+  double missing_sum = 0.0;
+  for (uint32_t uii = 0; uii != cts[2]; ++uii) {
+    missing_sum += vals[*carriers++];
+  }
+  return het_sum + 2 * hom_sum + missing_val * missing_sum;
+}
+
+// Liu et al. (2009) central chi-square approximation with matched kurtosis,
+// given c1 = tr(M), c2 = tr(M^2), c4 = tr(M^4).  Returns the p-value and sets
+// *df_ptr.
+static double GlmSetLiuP(double qq, double c1, double c2, double c4, double* df_ptr) {
+  if ((!(c2 > 0.0)) || (!(c4 > 0.0))) {
+    *df_ptr = 0.0;
+    return 1.0;
+  }
+  const double df = c2 * c2 / c4;
+  *df_ptr = df;
+  return ChisqRealDfToP((qq - c1) * sqrt(df / c2) + df, df);
+}
+
+// Fills results[] for one set of vct variants.  scatter must be zeroed on
+// entry, and is zeroed on exit.
+static void GlmSetTestCompute(const GlmSetTestCtx* ctx, const uint32_t* vidxs, uint32_t vct, double* scatter, double* zz, double* mm, double* mm2, double* row_sums, double* results) {
+  const uintptr_t* carrier_starts = ctx->carrier_starts;
+  const uint32_t* carrier_cts = ctx->carrier_cts;
+  const uint32_t* carriers = ctx->carriers;
+  const double* ww = ctx->ww;
+  const double* missing_vals = ctx->missing_vals;
+  const double* var_weights = ctx->var_weights;
+  const double* var_gwx = ctx->var_gwx;
+  const double* var_ainv_gwx = ctx->var_ainv_gwx;
+  const uint32_t pred_ct = ctx->pred_ct;
+  const double phi = ctx->phi;
+  // 1. Z := diag(w) Sigma diag(w).  The rows of W * G are scattered into a
+  //    dense sample-length buffer one at a time.
+  for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+    const uint32_t vidx1 = vidxs[row_idx];
+    const uint32_t* cur_carriers = &(carriers[carrier_starts[vidx1]]);
+    const uint32_t* cur_cts = &(carrier_cts[3 * vidx1]);
+    const uint32_t cur_carrier_ct = cur_cts[0] + cur_cts[1] + cur_cts[2];
+    const double missing_val = missing_vals[vidx1];
+    for (uint32_t uii = 0; uii != cur_carrier_ct; ++uii) {
+      const uint32_t sample_idx = cur_carriers[uii];
+      double val = (uii < cur_cts[0])? 1.0 : ((uii < cur_cts[0] + cur_cts[1])? 2.0 : missing_val);
+      if (ww) {
+        val *= ww[sample_idx];
+      }
+      scatter[sample_idx] = val;
+    }
+    const double* gwx1 = &(var_gwx[vidx1 * S_CAST(uintptr_t, pred_ct)]);
+    const double weight1 = var_weights[vidx1];
+    double* zz_row = &(zz[row_idx * S_CAST(uintptr_t, vct)]);
+    for (uint32_t col_idx = 0; col_idx <= row_idx; ++col_idx) {
+      const uint32_t vidx2 = vidxs[col_idx];
+      const double gwg = GlmSetCarrierDot(&(carriers[carrier_starts[vidx2]]), &(carrier_cts[3 * vidx2]), missing_vals[vidx2], scatter);
+      const double sigma = phi * (gwg - DotprodD(gwx1, &(var_ainv_gwx[vidx2 * S_CAST(uintptr_t, pred_ct)]), pred_ct));
+      zz_row[col_idx] = sigma * weight1 * var_weights[vidx2];
+    }
+    for (uint32_t uii = 0; uii != cur_carrier_ct; ++uii) {
+      scatter[cur_carriers[uii]] = 0.0;
+    }
+  }
+  ReflectMatrix(vct, zz);
+
+  // 2. Burden and SKAT statistics.
+  double tt = 0.0;
+  double q_skat = 0.0;
+  double ss = 0.0;
+  double tot = 0.0;
+  for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+    const uint32_t vidx = vidxs[row_idx];
+    const double wu = var_weights[vidx] * ctx->var_scores[vidx];
+    tt += wu;
+    q_skat += wu * wu;
+    const double* zz_row = &(zz[row_idx * S_CAST(uintptr_t, vct)]);
+    double row_sum = 0.0;
+    for (uint32_t col_idx = 0; col_idx != vct; ++col_idx) {
+      row_sum += zz_row[col_idx];
+    }
+    row_sums[row_idx] = row_sum;
+    ss += row_sum * row_sum;
+    tot += row_sum;
+  }
+  for (uint32_t result_idx = 0; result_idx != kGlmSetResultCt; ++result_idx) {
+    results[result_idx] = -DBL_MAX;
+  }
+  if (!(tot > 0.0)) {
+    return;
+  }
+  results[kGlmSetResultBurdenZ] = tt / sqrt(tot);
+  results[kGlmSetResultBurdenLnP] = ChisqToLnP(tt * tt / tot, 1);
+
+  // 3. Per-rho Liu p-values, for Q_rho = (1 - rho) * Q_skat + rho * T^2.
+  //    Q_rho's null distribution is a mixture of chisq(1)s weighted by the
+  //    eigenvalues of M_rho := (1 - rho) * Z + rho * Z 1 1^T.
+  double rho_pvals[kGlmSetRhoCt];
+  double rho_c1s[kGlmSetRhoCt];
+  double rho_c2s[kGlmSetRhoCt];
+  double rho_dfs[kGlmSetRhoCt];
+  double pmin = 1.0;
+  uint32_t pmin_rho_idx = 0;
+  const uintptr_t vct_sq = S_CAST(uintptr_t, vct) * vct;
+  for (uint32_t rho_idx = 0; rho_idx != kGlmSetRhoCt; ++rho_idx) {
+    // rho=1 is replaced with 0.999 to keep the SKAT-O integrand defined
+    const double rho = MINV(kGlmSetRhos[rho_idx], 0.999);
+    const double rho_c = 1.0 - rho;
+    for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+      const double* zz_row = &(zz[row_idx * S_CAST(uintptr_t, vct)]);
+      double* mm_row = &(mm[row_idx * S_CAST(uintptr_t, vct)]);
+      const double rho_row_sum = rho * row_sums[row_idx];
+      for (uint32_t col_idx = 0; col_idx != vct; ++col_idx) {
+        mm_row[col_idx] = rho_c * zz_row[col_idx] + rho_row_sum;
+      }
+    }
+    double c1 = 0.0;
+    double c2 = 0.0;
+    for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+      c1 += mm[row_idx * S_CAST(uintptr_t, vct) + row_idx];
+      for (uint32_t col_idx = 0; col_idx != vct; ++col_idx) {
+        c2 += mm[row_idx * S_CAST(uintptr_t, vct) + col_idx] * mm[col_idx * S_CAST(uintptr_t, vct) + row_idx];
+      }
+    }
+    RowMajorMatrixMultiply(mm, mm, vct, vct, vct, mm2);
+    double c4 = 0.0;
+    for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+      for (uint32_t col_idx = 0; col_idx != vct; ++col_idx) {
+        c4 += mm2[row_idx * S_CAST(uintptr_t, vct) + col_idx] * mm2[col_idx * S_CAST(uintptr_t, vct) + row_idx];
+      }
+    }
+    const double q_rho = rho_c * q_skat + rho * tt * tt;
+    const double pval = GlmSetLiuP(q_rho, c1, c2, c4, &(rho_dfs[rho_idx]));
+    rho_pvals[rho_idx] = pval;
+    rho_c1s[rho_idx] = c1;
+    rho_c2s[rho_idx] = c2;
+    if (pval < pmin) {
+      pmin = pval;
+      pmin_rho_idx = rho_idx;
+    }
+  }
+  results[kGlmSetResultSkatQ] = q_skat;
+  results[kGlmSetResultSkatLnP] = (rho_pvals[0] > 0.0)? log(rho_pvals[0]) : -DBL_MAX;
+  results[kGlmSetResultSkatoRho] = kGlmSetRhos[pmin_rho_idx];
+
+  // 4. SKAT-O (Lee et al. 2012): Q_rho = (1 - rho) * kappa + tau_rho * eta,
+  //    where eta ~ chisq(1) is the burden component and kappa is independent
+  //    of it, with kappa's distribution approximated by matching the
+  //    mean/variance/kurtosis of B := Z - s s^T / S (s = Z 1, S = 1^T Z 1).
+  double skato_pval = pmin;
+  if ((vct > 1) && (pmin < 1.0)) {
+    double mu_q = 0.0;
+    double b_ssq = 0.0;
+    for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+      const double* zz_row = &(zz[row_idx * S_CAST(uintptr_t, vct)]);
+      double* mm_row = &(mm[row_idx * S_CAST(uintptr_t, vct)]);
+      const double row_mult = row_sums[row_idx] / tot;
+      for (uint32_t col_idx = 0; col_idx != vct; ++col_idx) {
+        const double bval = zz_row[col_idx] - row_mult * row_sums[col_idx];
+        mm_row[col_idx] = bval;
+        b_ssq += bval * bval;
+      }
+      mu_q += mm_row[row_idx];
+    }
+    RowMajorMatrixMultiply(mm, mm, vct, vct, vct, mm2);
+    double b2_ssq = 0.0;
+    for (uintptr_t ulii = 0; ulii != vct_sq; ++ulii) {
+      b2_ssq += mm2[ulii] * mm2[ulii];
+    }
+    // s^T Z s
+    double szs = 0.0;
+    for (uint32_t row_idx = 0; row_idx != vct; ++row_idx) {
+      szs += row_sums[row_idx] * DotprodD(&(zz[row_idx * S_CAST(uintptr_t, vct)]), row_sums, vct);
+    }
+    if ((b2_ssq > 0.0) && (b_ssq > kSmallEpsilon * tot * tot)) {
+      const double var_q = 2 * b_ssq + 4 * (szs - ss * ss / tot) / tot;
+      const double skato_df = b_ssq * b_ssq / b2_ssq;
+      double rho_qmins[kGlmSetRhoCt];
+      double rho_taus[kGlmSetRhoCt];
+      for (uint32_t rho_idx = 0; rho_idx != kGlmSetRhoCt; ++rho_idx) {
+        const double rho = MINV(kGlmSetRhos[rho_idx], 0.999);
+        const double df = rho_dfs[rho_idx];
+        if (df > 0.0) {
+          rho_qmins[rho_idx] = (PToChisqRealDf(pmin, df) - df) * sqrt(rho_c2s[rho_idx] / df) + rho_c1s[rho_idx];
+        } else {
+          rho_qmins[rho_idx] = DBL_MAX;
+        }
+        rho_taus[rho_idx] = rho * tot + (1.0 - rho) * ss / tot;
+      }
+      if (var_q > 0.0) {
+        const double q_scale = sqrt(2 * skato_df / var_q);
+        // Integrate P(kappa > min_rho (q_rho - tau_rho * x) / (1 - rho))
+        // against the chisq(1) density over x = t^2, t in [0, sqrt(40)],
+        // with Simpson's rule.
+        const double t_max = sqrt(40.0);
+        const double hh = t_max / kGlmSetSkatoPanelCt;
+        double integral = 0.0;
+        for (uint32_t pt_idx = 0; pt_idx <= kGlmSetSkatoPanelCt; ++pt_idx) {
+          const double cur_t = pt_idx * hh;
+          const double xx = cur_t * cur_t;
+          double temp_min = DBL_MAX;
+          for (uint32_t rho_idx = 0; rho_idx != kGlmSetRhoCt; ++rho_idx) {
+            const double rho = MINV(kGlmSetRhos[rho_idx], 0.999);
+            const double cur_val = (rho_qmins[rho_idx] - rho_taus[rho_idx] * xx) / (1.0 - rho);
+            if (cur_val < temp_min) {
+              temp_min = cur_val;
+            }
+          }
+          const double temp_q = (temp_min - mu_q) * q_scale + skato_df;
+          const double upper = (temp_q > 0.0)? ChisqRealDfToP(temp_q, skato_df) : 1.0;
+          const double simpson_mult = ((!pt_idx) || (pt_idx == kGlmSetSkatoPanelCt))? 1.0 : ((pt_idx & 1)? 4.0 : 2.0);
+          integral += simpson_mult * upper * exp(-0.5 * xx);
+        }
+        // 2 * phi(t) dt, with phi the standard normal density
+        integral *= (hh / 3) * 2 / sqrt(2 * kPi);
+        skato_pval = integral + ChisqToP(40.0, 1);
+        // min-p is a lower bound; Bonferroni over the rho grid is an upper
+        // bound
+        const double pmax = MINV(pmin * kGlmSetRhoCt, 1.0);
+        if (!(skato_pval >= pmin)) {
+          skato_pval = pmin;
+        } else if (skato_pval > pmax) {
+          skato_pval = pmax;
+        }
+      }
+    }
+  }
+  results[kGlmSetResultSkatoLnP] = (skato_pval > 0.0)? log(skato_pval) : -DBL_MAX;
+}
+
+THREAD_FUNC_DECL GlmSetTestThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uint32_t tidx = arg->tidx;
+  GlmSetTestCtx* ctx = S_CAST(GlmSetTestCtx*, arg->sharedp->context);
+  const uint32_t* set_vidx_starts = ctx->set_vidx_starts;
+  const uint32_t* set_vidxs = ctx->set_vidxs;
+  const uint32_t* set_order = ctx->set_order;
+  const uint32_t nonempty_set_ct = ctx->nonempty_set_ct;
+  const uintptr_t max_set_vct = ctx->max_set_vct;
+  const uintptr_t max_set_vct_sq = max_set_vct * max_set_vct;
+  double* scatter = ctx->scatter_bufs[tidx];
+  double* zz = ctx->mat_bufs[tidx];
+  double* mm = &(zz[max_set_vct_sq]);
+  double* mm2 = &(mm[max_set_vct_sq]);
+  double* row_sums = &(mm2[max_set_vct_sq]);
+  // Sets were sorted in decreasing-size order, and are handed out one at a
+  // time, so the largest ones don't end up bunched at the end.
+  while (1) {
+    const uint32_t order_idx = __atomic_fetch_add(&(ctx->next_order_idx), 1, __ATOMIC_RELAXED);
+    if (order_idx >= nonempty_set_ct) {
+      break;
+    }
+    const uint32_t set_idx = set_order[order_idx];
+    const uint32_t vidx_start = set_vidx_starts[set_idx];
+    GlmSetTestCompute(ctx, &(set_vidxs[vidx_start]), set_vidx_starts[set_idx + 1] - vidx_start, scatter, zz, mm, mm2, row_sums, &(ctx->results[set_idx * kGlmSetResultCt]));
+  }
+  THREAD_RETURN;
+}
+
+// Sorts and merges one set's [uidx_start, uidx_end) ranges, saving them as
+// (uidx_start << 32) | uidx_end in range_sort_buf.  Returns the merged range
+// count.
+static uint32_t GlmSetMergeRanges(const MakeSetRange* msr, uint64_t* range_sort_buf) {
+  uint32_t range_ct = 0;
+  for (; msr; msr = msr->next) {
+    range_sort_buf[range_ct++] = (S_CAST(uint64_t, msr->uidx_start) << 32) | msr->uidx_end;
+  }
+  if (!range_ct) {
+    return 0;
+  }
+  STD_SORT(range_ct, u64cmp, range_sort_buf);
+  uint32_t write_idx = 0;
+  for (uint32_t read_idx = 1; read_idx != range_ct; ++read_idx) {
+    const uint64_t cur_range = range_sort_buf[read_idx];
+    const uint32_t prev_end = S_CAST(uint32_t, range_sort_buf[write_idx]);
+    if ((cur_range >> 32) <= prev_end) {
+      if (S_CAST(uint32_t, cur_range) > prev_end) {
+        range_sort_buf[write_idx] = (range_sort_buf[write_idx] & 0xffffffff00000000LLU) | S_CAST(uint32_t, cur_range);
+      }
+    } else {
+      range_sort_buf[++write_idx] = cur_range;
+    }
+  }
+  return write_idx + 1;
+}
+
+// --glm set-test-bed{0,1}=: burden, SKAT, and SKAT-O tests for each set in the
+// interval-BED file, for one phenotype.  Exactly one of pheno_d/pheno_f (and
+// covars_cmaj_d/covars_cmaj_f) is non-null.
+PglErr GlmSetTest(const char* cur_pheno_name, const double* pheno_d, const double* covars_cmaj_d, const float* pheno_f, const float* covars_cmaj_f, const uint32_t* variant_bps, const GlmInfo* glm_info_ptr, const char* outname, uint32_t raw_sample_ct, uint32_t raw_variant_ct, double output_min_ln, uint32_t max_thread_ct, uintptr_t overflow_buf_size, PgenReader* simple_pgrp, GlmCtx* common) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  const char* fname_txs = nullptr;
+  char* cswritep = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  TextStream txs;
+  PreinitTextStream(&txs);
+  CompressStreamState css;
+  PreinitCstream(&css);
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  {
+    const uintptr_t* variant_include = common->variant_include;
+    const ChrInfo* cip = common->cip;
+    const uintptr_t* allele_idx_offsets = common->allele_idx_offsets;
+    const uintptr_t* sample_include = common->sample_include;
+    const uint32_t sample_ct = common->sample_ct;
+    const uint32_t covar_ct = common->covar_ct;
+    const uint32_t variant_ct = common->variant_ct;
+    const GlmFlags glm_flags = glm_info_ptr->flags;
+    const double max_maf = glm_info_ptr->set_max_maf;
+    const uintptr_t pred_ct = covar_ct + 1;
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    if (unlikely(sample_ct <= pred_ct + 1)) {
+      logerrputs("Error: Too few samples for --glm set-test-bed{0,1}=.\n");
+      goto GlmSetTest_ret_DEGENERATE_DATA;
+    }
+
+    // 1. Candidates: biallelic variants on diploid autosomes.
+    uintptr_t* cand_include;
+    if (unlikely(bigstack_alloc_w(raw_variant_ctl, &cand_include))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    memcpy(cand_include, variant_include, raw_variant_ctl * sizeof(intptr_t));
+    uint32_t cand_ct = variant_ct;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != cip->chr_ct; ++chr_fo_idx) {
+      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+      if (chr_idx && (chr_idx <= cip->autosome_ct) && (!IsSet(cip->haploid_mask, chr_idx))) {
+        continue;
+      }
+      const uint32_t chr_start = cip->chr_fo_vidx_start[chr_fo_idx];
+      const uint32_t chr_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+      if (chr_end > chr_start) {
+        cand_ct -= PopcountBitRange(cand_include, chr_start, chr_end);
+        ClearBitsNz(chr_start, chr_end, cand_include);
+      }
+    }
+    if (allele_idx_offsets) {
+      uintptr_t variant_uidx_base = 0;
+      uintptr_t cur_bits = cand_include[0];
+      const uint32_t orig_cand_ct = cand_ct;
+      for (uint32_t cand_idx = 0; cand_idx != orig_cand_ct; ++cand_idx) {
+        const uintptr_t variant_uidx = BitIter1(cand_include, &variant_uidx_base, &cur_bits);
+        if (allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx] != 2) {
+          ClearBit(variant_uidx, cand_include);
+          --cand_ct;
+        }
+      }
+    }
+    if (cand_ct != variant_ct) {
+      logerrprintfww("Warning: --glm set-test-bed{0,1}= only considers biallelic variants on diploid autosomes; skipping %u other variant%s.\n", variant_ct - cand_ct, (variant_ct - cand_ct == 1)? "" : "s");
+    }
+
+    // 2. Load sets.
+    const char* set_fname = glm_info_ptr->set_test_fname;
+    fname_txs = set_fname;
+    reterr = InitTextStream(set_fname, kTextStreamBlenFast, MAXV(max_thread_ct - 1, 1), &txs);
+    if (unlikely(reterr)) {
+      goto GlmSetTest_ret_TSTREAM_FAIL;
+    }
+    uintptr_t set_ct = 0;
+    char* set_names = nullptr;
+    uintptr_t max_set_id_blen = 0;
+    uint64_t* range_sort_buf = nullptr;
+    MakeSetRange** range_arr = nullptr;
+    reterr = LoadIntervalBed(cip, variant_bps, nullptr, set_fname, (glm_flags / kfGlmSetTestBed0) & 1, 1, 0, 0, 0, 0, 0, &txs, &set_ct, &set_names, &max_set_id_blen, &range_sort_buf, &range_arr);
+    if (unlikely(reterr)) {
+      goto GlmSetTest_ret_1;
+    }
+    if (unlikely(!set_ct)) {
+      logerrputs("Error: No sets defined by --glm set-test-bed{0,1}= file.\n");
+      goto GlmSetTest_ret_INCONSISTENT_INPUT;
+    }
+    fname_txs = nullptr;
+    if (unlikely(CleanupTextStream2(set_fname, &txs, &reterr))) {
+      goto GlmSetTest_ret_1;
+    }
+    // Upper bound on each set's variant count, and the union of all sets.
+    uint32_t* set_vidx_starts;
+    uintptr_t* needed_include;
+    if (unlikely(bigstack_alloc_u32(set_ct + 1, &set_vidx_starts) ||
+                 bigstack_calloc_w(raw_variant_ctl, &needed_include))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    uintptr_t set_vidx_tot_bound = 0;
+    for (uintptr_t set_idx = 0; set_idx != set_ct; ++set_idx) {
+      const uint32_t merged_range_ct = GlmSetMergeRanges(range_arr[set_idx], range_sort_buf);
+      uintptr_t cur_ct = 0;
+      for (uint32_t range_idx = 0; range_idx != merged_range_ct; ++range_idx) {
+        const uint64_t cur_range = range_sort_buf[range_idx];
+        const uint32_t range_start = cur_range >> 32;
+        const uint32_t range_end = S_CAST(uint32_t, cur_range);
+        cur_ct += PopcountBitRange(cand_include, range_start, range_end);
+        FillBitsNz(range_start, range_end, needed_include);
+      }
+      set_vidx_tot_bound += cur_ct;
+    }
+    BitvecAnd(cand_include, raw_variant_ctl, needed_include);
+    const uint32_t needed_ct = PopcountWords(needed_include, raw_variant_ctl);
+    uint32_t* set_vidxs;
+    if (unlikely(bigstack_alloc_u32(set_vidx_tot_bound, &set_vidxs))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+
+    // 3. Null model.  resid = y - mu, and wx_smaj is W * X in sample-major
+    //    order.
+    double* resid;
+    double* wx_smaj;
+    double* xtwx_inv;
+    double* ww = nullptr;
+    double phi = 1.0;
+    if (unlikely(bigstack_alloc_d(sample_ct, &resid) ||
+                 bigstack_alloc_d(pred_ct * sample_ct, &wx_smaj) ||
+                 bigstack_alloc_d(pred_ct * pred_ct, &xtwx_inv))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    if (pheno_f) {
+      const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+      LogisticScoreScreen* null_fit;
+      if (unlikely(bigstack_alloc_d(sample_ct, &ww) ||
+                   BIGSTACK_ALLOC_X(LogisticScoreScreen, 1, &null_fit) ||
+                   bigstack_alloc_f((pred_ct + 1) * sample_ctav, &(null_fit->resid_wx_pmaj)))) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      null_fit->mu = nullptr;
+      null_fit->xtwx_inv = xtwx_inv;
+      null_fit->predictor_ct = pred_ct;
+      unsigned char* fit_mark = g_bigstack_base;
+      if (unlikely(LogisticScoreScreenFit(pheno_f, covars_cmaj_f, sample_ct, &null_fit))) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      BigstackReset(fit_mark);
+      if (!null_fit) {
+        logerrprintfww("Warning: Skipping --glm set-test-bed{0,1}= for phenotype '%s' since null model fit failed.\n", cur_pheno_name);
+        goto GlmSetTest_ret_1;
+      }
+      const float* resid_f = null_fit->resid_wx_pmaj;
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        resid[sample_idx] = S_CAST(double, resid_f[sample_idx]);
+        ww[sample_idx] = S_CAST(double, resid_f[sample_ctav + sample_idx]);
+      }
+      for (uintptr_t pred_idx = 0; pred_idx != pred_ct; ++pred_idx) {
+        const float* wx_row = &(resid_f[(pred_idx + 1) * sample_ctav]);
+        for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+          wx_smaj[sample_idx * pred_ct + pred_idx] = S_CAST(double, wx_row[sample_idx]);
+        }
+      }
+    } else {
+      unsigned char* fit_mark = g_bigstack_base;
+      double* preds_pmaj;
+      double* beta;
+      MatrixInvertBuf1* inv_1d_buf;
+      double* dbl_2d_buf;
+      if (unlikely(bigstack_alloc_d(pred_ct * sample_ct, &preds_pmaj) ||
+                   bigstack_alloc_d(pred_ct * 2, &beta) ||
+                   BIGSTACK_ALLOC_X(MatrixInvertBuf1, pred_ct * kMatrixInvertBuf1CheckedAlloc, &inv_1d_buf) ||
+                   bigstack_alloc_d(pred_ct * MAXV(pred_ct, 7), &dbl_2d_buf))) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        preds_pmaj[sample_idx] = 1.0;
+      }
+      if (covar_ct) {
+        memcpy(&(preds_pmaj[sample_ct]), covars_cmaj_d, covar_ct * S_CAST(uintptr_t, sample_ct) * sizeof(double));
+      }
+      MultiplySelfTranspose(preds_pmaj, pred_ct, sample_ct, xtwx_inv);
+      if (unlikely(InvertSymmdefMatrixChecked(pred_ct, xtwx_inv, inv_1d_buf, dbl_2d_buf))) {
+        logerrputs("Error: --glm set-test-bed{0,1}= covariate matrix inversion failed.\n");
+        goto GlmSetTest_ret_DEGENERATE_DATA;
+      }
+      ReflectMatrix(pred_ct, xtwx_inv);
+      double* xt_y = &(beta[pred_ct]);
+      RowMajorMatrixMultiply(preds_pmaj, pheno_d, pred_ct, 1, sample_ct, xt_y);
+      RowMajorMatrixMultiply(xtwx_inv, xt_y, pred_ct, 1, pred_ct, beta);
+      double rss = 0.0;
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        double fitted = 0.0;
+        for (uintptr_t pred_idx = 0; pred_idx != pred_ct; ++pred_idx) {
+          const double xval = preds_pmaj[pred_idx * sample_ct + sample_idx];
+          fitted += beta[pred_idx] * xval;
+          wx_smaj[sample_idx * pred_ct + pred_idx] = xval;
+        }
+        const double cur_resid = pheno_d[sample_idx] - fitted;
+        resid[sample_idx] = cur_resid;
+        rss += cur_resid * cur_resid;
+      }
+      phi = rss / u31tod(sample_ct - pred_ct);
+      BigstackReset(fit_mark);
+    }
+
+    // 4. Load minor-allele carriers of every needed variant with MAF <=
+    //    max_maf, along with per-variant scores and covariate projections.
+    uintptr_t* kept_include;
+    uintptr_t* carrier_starts;
+    uint32_t* carrier_cts;
+    uint32_t* var_macs;
+    double* missing_vals;
+    double* var_weights;
+    double* var_scores;
+    double* var_gwx;
+    double* var_ainv_gwx;
+    uintptr_t* genovec;
+    uintptr_t* raregeno;
+    uint32_t* difflist_sample_ids;
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+    if (unlikely(bigstack_calloc_w(raw_variant_ctl, &kept_include) ||
+                 bigstack_alloc_w(needed_ct + 1, &carrier_starts) ||
+                 bigstack_alloc_u32(3 * S_CAST(uintptr_t, needed_ct), &carrier_cts) ||
+                 bigstack_alloc_u32(needed_ct, &var_macs) ||
+                 bigstack_alloc_d(needed_ct, &missing_vals) ||
+                 bigstack_alloc_d(needed_ct, &var_weights) ||
+                 bigstack_alloc_d(needed_ct, &var_scores) ||
+                 bigstack_alloc_d(needed_ct * pred_ct, &var_gwx) ||
+                 bigstack_alloc_d(needed_ct * pred_ct, &var_ainv_gwx) ||
+                 bigstack_alloc_w(NypCtToWordCt(sample_ct), &genovec) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    const uint32_t max_simple_difflist_len = sample_ct / kGlmSetDifflistDivisor;
+    const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
+    // grows from g_bigstack_base until finalized
+    uint32_t* carriers = R_CAST(uint32_t*, g_bigstack_base);
+    const uintptr_t carrier_capacity = bigstack_left() / sizeof(int32_t);
+    uintptr_t carrier_ct = 0;
+    uint32_t kept_ct = 0;
+    logprintfww5("--glm set-test-bed{0,1}=: Loading %u variant%s for phenotype '%s'... ", needed_ct, (needed_ct == 1)? "" : "s", cur_pheno_name);
+    fputs("0%", stdout);
+    fflush(stdout);
+    PgrSampleSubsetIndex pssi;
+    PgrSetSampleSubsetIndex(common->sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+    uint32_t pct = 0;
+    uint32_t next_print_idx = needed_ct / 100;
+    uintptr_t variant_uidx_base = 0;
+    uintptr_t cur_bits = needed_include[0];
+    for (uint32_t needed_idx = 0; needed_idx != needed_ct; ++needed_idx) {
+      const uint32_t variant_uidx = BitIter1(needed_include, &variant_uidx_base, &cur_bits);
+      if (needed_idx >= next_print_idx) {
+        if (pct > 10) {
+          putc_unlocked('\b', stdout);
+        }
+        pct = (needed_idx * 100LLU) / needed_ct;
+        printf("\b\b%u%%", pct++);
+        fflush(stdout);
+        next_print_idx = (pct * S_CAST(uint64_t, needed_ct)) / 100;
       }
-      for (uintptr_t fidx = 0; fidx != subbatch_size; ++fidx) {
-        if (unlikely(CswriteCloseNull(&(css_arr[fidx]), cswritep_arr[fidx]))) {
-          goto GlmLinearBatch_ret_WRITE_FAIL;
+      uint32_t difflist_common_geno = UINT32_MAX;
+      uint32_t difflist_len = 0;
+      if (max_simple_difflist_len) {
+        reterr = PgrGetDifflistOrGenovec(sample_include, pssi, sample_ct, max_simple_difflist_len, variant_uidx, simple_pgrp, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
+      } else {
+        reterr = PgrGet(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, genovec);
+      }
+      if (unlikely(reterr)) {
+        goto GlmSetTest_ret_PGR_FAIL;
+      }
+      STD_ARRAY_DECL(uint32_t, 4, genocounts);
+      if (difflist_common_geno != UINT32_MAX) {
+        ZeroTrailingNyps(difflist_len, raregeno);
+        GenoarrCountFreqsUnsafe(raregeno, difflist_len, genocounts);
+        if (difflist_common_geno || (difflist_len > max_simple_difflist_len)) {
+          PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, difflist_common_geno, sample_ct, difflist_len, genovec);
+          difflist_common_geno = UINT32_MAX;
+        } else {
+          genocounts[0] += sample_ct - difflist_len;
         }
       }
-      if (pct > 10) {
-        putc_unlocked('\b', stdout);
+      if (difflist_common_geno == UINT32_MAX) {
+        ZeroTrailingNyps(sample_ct, genovec);
+        GenoarrCountFreqsUnsafe(genovec, sample_ct, genocounts);
       }
-      fputs("\b\b", stdout);
+      const uint32_t nm_ct = sample_ct - genocounts[3];
+      const uint32_t alt_ct = genocounts[1] + 2 * genocounts[2];
+      const uint32_t ref_is_minor = (alt_ct > nm_ct);
+      const uint32_t mac = ref_is_minor? (2 * nm_ct - alt_ct) : alt_ct;
+      if (!mac) {
+        continue;
+      }
+      const double maf = u31tod(mac) / (2.0 * u31tod(nm_ct));
+      if (maf > max_maf) {
+        continue;
+      }
+      const uint32_t het_ct = genocounts[1];
+      const uint32_t hom_ct = ref_is_minor? genocounts[0] : genocounts[2];
+      const uint32_t missing_ct = genocounts[3];
+      if (unlikely(carrier_capacity - carrier_ct < het_ct + hom_ct + missing_ct)) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      uint32_t* write_iters[4];
+      write_iters[1] = &(carriers[carrier_ct]);
+      write_iters[2] = &(write_iters[1][het_ct]);
+      write_iters[3] = &(write_iters[2][hom_ct]);
+      if (difflist_common_geno == 0) {
+        if (ref_is_minor) {
+          // shouldn't happen with a short difflist, but play it safe
+          PgrDifflistToGenovecUnsafe(raregeno, difflist_sample_ids, 0, sample_ct, difflist_len, genovec);
+          ZeroTrailingNyps(sample_ct, genovec);
+          difflist_common_geno = UINT32_MAX;
+        } else {
+          for (uint32_t diff_idx = 0; diff_idx != difflist_len; ++diff_idx) {
+            const uint32_t cur_geno = GetNyparrEntry(raregeno, diff_idx);
+            *(write_iters[cur_geno])++ = difflist_sample_ids[diff_idx];
+          }
+        }
+      }
+      if (difflist_common_geno == UINT32_MAX) {
+        for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
+          uintptr_t geno_word = genovec[widx];
+          if (ref_is_minor) {
+            // swap 0 and 2, leave 1 and 3 alone
+            geno_word ^= ((~geno_word) & kMask5555) << 1;
+            if (widx == sample_ctl2 - 1) {
+              geno_word = bzhi_max(geno_word, 2 * ModNz(sample_ct, kBitsPerWordD2));
+            }
+          }
+          const uint32_t sample_idx_base = widx * kBitsPerWordD2;
+          while (geno_word) {
+            const uint32_t shift = ctzw(geno_word) & (~1);
+            *(write_iters[(geno_word >> shift) & 3])++ = sample_idx_base + (shift / 2);
+            geno_word &= ~((3 * k1LU) << shift);
+          }
+        }
+      }
+      const uint32_t* cur_carriers = &(carriers[carrier_ct]);
+      uint32_t* cur_cts = &(carrier_cts[3 * kept_ct]);
+      cur_cts[0] = het_ct;
+      cur_cts[1] = hom_ct;
+      cur_cts[2] = missing_ct;
+      const double missing_val = 2 * maf;
+      carrier_starts[kept_ct] = carrier_ct;
+      var_macs[kept_ct] = mac;
+      missing_vals[kept_ct] = missing_val;
+      // Beta(1, 25) density, up to a constant factor
+      const double maf_c = 1.0 - maf;
+      const double maf_c2 = maf_c * maf_c;
+      const double maf_c4 = maf_c2 * maf_c2;
+      const double maf_c8 = maf_c4 * maf_c4;
+      var_weights[kept_ct] = 25 * maf_c8 * maf_c8 * maf_c8;
+      var_scores[kept_ct] = GlmSetCarrierDot(cur_carriers, cur_cts, missing_val, resid);
+      double* cur_gwx = &(var_gwx[kept_ct * pred_ct]);
+      ZeroDArr(pred_ct, cur_gwx);
+      const uint32_t cur_carrier_ct = het_ct + hom_ct + missing_ct;
+      for (uint32_t uii = 0; uii != cur_carrier_ct; ++uii) {
+        const uint32_t sample_idx = cur_carriers[uii];
+        const double val = (uii < het_ct)? 1.0 : ((uii < het_ct + hom_ct)? 2.0 : missing_val);
+        const double* wx_row = &(wx_smaj[sample_idx * pred_ct]);
+        for (uintptr_t pred_idx = 0; pred_idx != pred_ct; ++pred_idx) {
+          cur_gwx[pred_idx] += val * wx_row[pred_idx];
+        }
+      }
+      RowMajorMatrixMultiply(xtwx_inv, cur_gwx, pred_ct, 1, pred_ct, &(var_ainv_gwx[kept_ct * pred_ct]));
+      carrier_ct += cur_carrier_ct;
+      SetBit(variant_uidx, kept_include);
+      ++kept_ct;
+    }
+    carrier_starts[kept_ct] = carrier_ct;
+    BigstackFinalizeU32(carriers, carrier_ct);
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\b", stdout);
+    logprintf("done (%u with MAF <= %g).\n", kept_ct, max_maf);
+
+    // 5. Per-set variant lists, in terms of kept-variant indexes.
+    uint32_t* kept_cumulative_popcounts;
+    uint64_t* set_sort_buf;
+    if (unlikely(bigstack_alloc_u32(raw_variant_ctl, &kept_cumulative_popcounts) ||
+                 bigstack_alloc_u64(set_ct, &set_sort_buf))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    FillCumulativePopcounts(kept_include, raw_variant_ctl, kept_cumulative_popcounts);
+    const uint32_t set_max_vct = glm_info_ptr->set_max_vct;
+    uint32_t set_vidx_ct = 0;
+    uint32_t nonempty_set_ct = 0;
+    uint32_t oversized_set_ct = 0;
+    uint32_t max_set_vct = 0;
+    for (uintptr_t set_idx = 0; set_idx != set_ct; ++set_idx) {
+      set_vidx_starts[set_idx] = set_vidx_ct;
+      const uint32_t merged_range_ct = GlmSetMergeRanges(range_arr[set_idx], range_sort_buf);
+      for (uint32_t range_idx = 0; range_idx != merged_range_ct; ++range_idx) {
+        const uint64_t cur_range = range_sort_buf[range_idx];
+        const uint32_t range_end = S_CAST(uint32_t, cur_range);
+        for (uint32_t variant_uidx = AdvBoundedTo1Bit(kept_include, cur_range >> 32, range_end); variant_uidx != range_end; variant_uidx = AdvBoundedTo1Bit(kept_include, variant_uidx + 1, range_end)) {
+          set_vidxs[set_vidx_ct++] = RawToSubsettedPos(kept_include, kept_cumulative_popcounts, variant_uidx);
+        }
+      }
+      const uint32_t cur_vct = set_vidx_ct - set_vidx_starts[set_idx];
+      if (cur_vct > set_max_vct) {
+        // reported with NA statistics
+        ++oversized_set_ct;
+      } else if (cur_vct) {
+        // decreasing size, then increasing set index
+        set_sort_buf[nonempty_set_ct++] = (S_CAST(uint64_t, UINT32_MAX - cur_vct) << 32) | set_idx;
+        if (cur_vct > max_set_vct) {
+          max_set_vct = cur_vct;
+        }
+      }
+    }
+    set_vidx_starts[set_ct] = set_vidx_ct;
+    if (oversized_set_ct) {
+      logerrprintfww("Warning: %u set%s with more than %u qualifying variants skipped by --glm set-test-bed{0,1}= (reported with NA statistics).  Use 'set-test-max-vct=' to raise this limit.\n", oversized_set_ct, (oversized_set_ct == 1)? "" : "s", set_max_vct);
+    }
+    STD_SORT(nonempty_set_ct, u64cmp, set_sort_buf);
+    uint32_t* set_order = R_CAST(uint32_t*, set_sort_buf);
+    for (uint32_t order_idx = 0; order_idx != nonempty_set_ct; ++order_idx) {
+      set_order[order_idx] = S_CAST(uint32_t, set_sort_buf[order_idx]);
+    }
+
+    // 6. Run the tests.
+    GlmSetTestCtx ctx;
+    ctx.carrier_starts = carrier_starts;
+    ctx.carrier_cts = carrier_cts;
+    ctx.carriers = carriers;
+    ctx.ww = ww;
+    ctx.missing_vals = missing_vals;
+    ctx.var_weights = var_weights;
+    ctx.var_scores = var_scores;
+    ctx.var_gwx = var_gwx;
+    ctx.var_ainv_gwx = var_ainv_gwx;
+    ctx.set_vidx_starts = set_vidx_starts;
+    ctx.set_vidxs = set_vidxs;
+    ctx.set_order = set_order;
+    ctx.phi = phi;
+    ctx.pred_ct = pred_ct;
+    ctx.max_set_vct = max_set_vct;
+    ctx.nonempty_set_ct = nonempty_set_ct;
+    ctx.next_order_idx = 0;
+    if (unlikely(bigstack_alloc_d(set_ct * kGlmSetResultCt, &ctx.results))) {
+      goto GlmSetTest_ret_NOMEM;
+    }
+    if (oversized_set_ct) {
+      for (uintptr_t ulii = 0; ulii != set_ct * kGlmSetResultCt; ++ulii) {
+        ctx.results[ulii] = -DBL_MAX;
+      }
+    }
+    if (nonempty_set_ct) {
+      uint32_t calc_thread_ct = MINV(max_thread_ct, nonempty_set_ct);
+      const uintptr_t scatter_alloc = RoundUpPow2(sample_ct * sizeof(double), kCacheline);
+      const uintptr_t mat_alloc = RoundUpPow2((3 * S_CAST(uintptr_t, max_set_vct) + 1) * max_set_vct * sizeof(double), kCacheline);
+      const uintptr_t per_thread_alloc = scatter_alloc + mat_alloc;
+      if (unlikely(bigstack_alloc_dp(calc_thread_ct, &ctx.scatter_bufs) ||
+                   bigstack_alloc_dp(calc_thread_ct, &ctx.mat_bufs))) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      const uintptr_t thread_ct_limit = bigstack_left() / per_thread_alloc;
+      if (calc_thread_ct > thread_ct_limit) {
+        if (unlikely(!thread_ct_limit)) {
+          logerrprintfww("Error: Out of memory.  --glm set-test-bed{0,1}= needs at least %" PRIu64 " MiB of workspace for its largest set (%u variants).\n", (S_CAST(uint64_t, per_thread_alloc) + 0xfffff) >> 20, max_set_vct);
+          reterr = kPglRetNomem;
+          goto GlmSetTest_ret_1;
+        }
+        calc_thread_ct = thread_ct_limit;
+      }
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        ctx.scatter_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(scatter_alloc));
+        ctx.mat_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(mat_alloc));
+        ZeroDArr(sample_ct, ctx.scatter_bufs[tidx]);
+      }
+      if (unlikely(SetThreadCt(calc_thread_ct, &tg))) {
+        goto GlmSetTest_ret_NOMEM;
+      }
+      logprintfww5("--glm set-test-bed{0,1}=: Testing %u set%s (%u thread%s)... ", nonempty_set_ct, (nonempty_set_ct == 1)? "" : "s", calc_thread_ct, (calc_thread_ct == 1)? "" : "s");
+      fflush(stdout);
+      SetThreadFuncAndData(GlmSetTestThread, &ctx, &tg);
+      DeclareLastThreadBlock(&tg);
+      if (unlikely(SpawnThreads(&tg))) {
+        goto GlmSetTest_ret_THREAD_CREATE_FAIL;
+      }
+      JoinThreads(&tg);
       logputs("done.\n");
-      // bugfix (12 May 2019): added batch_size instead of subbatch_size here
-      completed_pheno_ct += subbatch_size;
     }
-    outname_end[1] = '\0';
-    logprintfww("Results written to %s<phenotype name>.glm.linear%s .\n", outname, output_zst? ".zst" : "");
+
+    // 7. Report, in set ID order.
+    const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
+    reterr = InitCstreamAlloc(outname, 0, output_zst, 1, overflow_buf_size, &css, &cswritep);
+    if (unlikely(reterr)) {
+      goto GlmSetTest_ret_1;
+    }
+    const uint32_t report_neglog10p = (glm_flags / kfGlmLog10) & 1;
+    const char* p_prefix = report_neglog10p? "LOG10_" : "";
+    cswritep = strcpya_k(cswritep, "#SET\tNVAR\tMAC\tBURDEN_Z\t");
+    cswritep = strcpya(cswritep, p_prefix);
+    cswritep = strcpya_k(cswritep, "BURDEN_P\tSKAT_Q\t");
+    cswritep = strcpya(cswritep, p_prefix);
+    cswritep = strcpya_k(cswritep, "SKAT_P\tSKATO_RHO\t");
+    cswritep = strcpya(cswritep, p_prefix);
+    cswritep = strcpya_k(cswritep, "SKATO_P");
+    AppendBinaryEoln(&cswritep);
+    for (uintptr_t set_idx = 0; set_idx != set_ct; ++set_idx) {
+      const uint32_t vidx_start = set_vidx_starts[set_idx];
+      const uint32_t vidx_end = set_vidx_starts[set_idx + 1];
+      if (vidx_start == vidx_end) {
+        continue;
+      }
+      cswritep = strcpyax(cswritep, &(set_names[set_idx * max_set_id_blen]), '\t');
+      cswritep = u32toa_x(vidx_end - vidx_start, '\t', cswritep);
+      uintptr_t mac_sum = 0;
+      for (uint32_t uii = vidx_start; uii != vidx_end; ++uii) {
+        mac_sum += var_macs[set_vidxs[uii]];
+      }
+      cswritep = wtoa(mac_sum, cswritep);
+      const double* cur_results = &(ctx.results[set_idx * kGlmSetResultCt]);
+      for (uint32_t result_idx = 0; result_idx != kGlmSetResultCt; ++result_idx) {
+        *cswritep++ = '\t';
+        const double cur_result = cur_results[result_idx];
+        if (cur_result == -DBL_MAX) {
+          cswritep = strcpya_k(cswritep, "NA");
+        } else if ((result_idx == kGlmSetResultBurdenLnP) || (result_idx == kGlmSetResultSkatLnP) || (result_idx == kGlmSetResultSkatoLnP)) {
+          const double ln_pval = MAXV(cur_result, output_min_ln);
+          if (report_neglog10p) {
+            cswritep = dtoa_g((-kRecipLn10) * ln_pval, cswritep);
+          } else {
+            cswritep = lntoa_g(ln_pval, cswritep);
+          }
+        } else {
+          cswritep = dtoa_g(cur_result, cswritep);
+        }
+      }
+      AppendBinaryEoln(&cswritep);
+      if (unlikely(Cswrite(&css, &cswritep))) {
+        goto GlmSetTest_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(CswriteCloseNull(&css, cswritep))) {
+      goto GlmSetTest_ret_WRITE_FAIL;
+    }
+    if (nonempty_set_ct != set_ct) {
+      logprintf("--glm set-test-bed{0,1}=: %" PRIuPTR " set%s without qualifying variants skipped.\n", set_ct - nonempty_set_ct, (set_ct - nonempty_set_ct == 1)? "" : "s");
+    }
+    logprintf("Results written to %s .\n", outname);
   }
   while (0) {
-  GlmLinearBatch_ret_NOMEM:
+  GlmSetTest_ret_NOMEM:
     reterr = kPglRetNomem;
     break;
-  GlmLinearBatch_ret_TSTREAM_FAIL:
-    TextStreamErrPrint("--glm local-covar= file", local_covar_txsp);
+  GlmSetTest_ret_TSTREAM_FAIL:
+    TextStreamErrPrint(fname_txs, &txs);
     break;
-  GlmLinearBatch_ret_PGR_FAIL:
+  GlmSetTest_ret_PGR_FAIL:
     PgenErrPrintN(reterr);
     break;
-  GlmLinearBatch_ret_WRITE_FAIL:
+  GlmSetTest_ret_WRITE_FAIL:
     reterr = kPglRetWriteFail;
     break;
-  GlmLinearBatch_ret_INCONSISTENT_INPUT:
+  GlmSetTest_ret_INCONSISTENT_INPUT:
     reterr = kPglRetInconsistentInput;
     break;
-  GlmLinearBatch_ret_THREAD_CREATE_FAIL:
+  GlmSetTest_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  GlmSetTest_ret_THREAD_CREATE_FAIL:
     reterr = kPglRetThreadCreateFail;
     break;
   }
- GlmLinearBatch_ret_1:
+ GlmSetTest_ret_1:
   CleanupThreads(&tg);
-  if (css_arr) {
-    for (uintptr_t fidx = 0; fidx != subbatch_size; ++fidx) {
-      CswriteCloseCond(&(css_arr[fidx]), cswritep_arr[fidx]);
+  CswriteCloseCond(&css, cswritep);
+  if (fname_txs) {
+    CleanupTextStream2(fname_txs, &txs, &reterr);
+  }
+  BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
+  return reterr;
+}
+
+// --glm loco-ridge preprocessing: regresses the intercept and covariates out
+// of the phenotype, then fits the whole-genome ridge model to the residual.
+// Exactly one of pheno_d/pheno_f and one of covars_cmaj_d/covars_cmaj_f is
+// non-null; the float versions have stride RoundUpPow2(sample_ct,
+// kFloatPerFVec).  loco_preds rows are on the phenotype scale.
+PglErr GlmLocoRidgePrep(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, const double* pheno_d, const float* pheno_f, const double* covars_cmaj_d, const float* covars_cmaj_f, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t covar_ct, uint32_t max_allele_ct, double h2, uint32_t fold_seed, PgenReader* simple_pgrp, uint32_t** chr_fo_slots_ptr, uint32_t* loco_slot_ct_ptr, double** loco_preds_ptr) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+    const uint32_t pred_ct = covar_ct + 1;
+    uint32_t* chr_fo_slots;
+    double* resid_pheno;
+    if (unlikely(bigstack_alloc_u32(cip->chr_ct, &chr_fo_slots) ||
+                 bigstack_alloc_d(sample_ct, &resid_pheno))) {
+      goto GlmLocoRidgePrep_ret_NOMEM;
+    }
+    unsigned char* bigstack_mark2 = g_bigstack_base;
+    double* predictors_pmaj;
+    double* xtx_inv;
+    double* xt_y;
+    double* covar_coefs;
+    MatrixInvertBuf1* inv_1d_buf;
+    double* dbl_2d_buf;
+    if (unlikely(bigstack_alloc_d(S_CAST(uintptr_t, pred_ct) * sample_ct, &predictors_pmaj) ||
+                 bigstack_alloc_d(pred_ct * pred_ct, &xtx_inv) ||
+                 bigstack_alloc_d(pred_ct, &xt_y) ||
+                 bigstack_alloc_d(pred_ct, &covar_coefs) ||
+                 BIGSTACK_ALLOC_X(MatrixInvertBuf1, pred_ct * kMatrixInvertBuf1CheckedAlloc, &inv_1d_buf) ||
+                 bigstack_alloc_d(pred_ct * MAXV(pred_ct, 7), &dbl_2d_buf))) {
+      goto GlmLocoRidgePrep_ret_NOMEM;
+    }
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      predictors_pmaj[sample_idx] = 1.0;
+      resid_pheno[sample_idx] = pheno_d? pheno_d[sample_idx] : S_CAST(double, pheno_f[sample_idx]);
+    }
+    for (uint32_t covar_idx = 0; covar_idx != covar_ct; ++covar_idx) {
+      double* predictor_row = &(predictors_pmaj[(covar_idx + 1) * S_CAST(uintptr_t, sample_ct)]);
+      if (covars_cmaj_d) {
+        memcpy(predictor_row, &(covars_cmaj_d[covar_idx * S_CAST(uintptr_t, sample_ct)]), sample_ct * sizeof(double));
+      } else {
+        const float* covar_col = &(covars_cmaj_f[covar_idx * sample_ctav]);
+        for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+          predictor_row[sample_idx] = S_CAST(double, covar_col[sample_idx]);
+        }
+      }
+    }
+    MultiplySelfTranspose(predictors_pmaj, pred_ct, sample_ct, xtx_inv);
+    // covariate VIF/correlation checks have already passed
+    if (unlikely(InvertSymmdefMatrixChecked(pred_ct, xtx_inv, inv_1d_buf, dbl_2d_buf))) {
+      logerrputs("Error: --glm loco-ridge covariate matrix inversion failed.\n");
+      goto GlmLocoRidgePrep_ret_DEGENERATE_DATA;
     }
+    ReflectMatrix(pred_ct, xtx_inv);
+    RowMajorMatrixMultiply(predictors_pmaj, resid_pheno, pred_ct, 1, sample_ct, xt_y);
+    RowMajorMatrixMultiply(xtx_inv, xt_y, pred_ct, 1, pred_ct, covar_coefs);
+    for (uint32_t pred_idx = 0; pred_idx != pred_ct; ++pred_idx) {
+      const double cur_coef = covar_coefs[pred_idx];
+      const double* predictor_row = &(predictors_pmaj[pred_idx * S_CAST(uintptr_t, sample_ct)]);
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        resid_pheno[sample_idx] -= cur_coef * predictor_row[sample_idx];
+      }
+    }
+    BigstackReset(bigstack_mark2);
+    reterr = CalcLocoRidgePreds(sample_include, sample_include_cumulative_popcounts, variant_include, cip, allele_idx_offsets, allele_freqs, resid_pheno, raw_sample_ct, sample_ct, max_allele_ct, h2, fold_seed, simple_pgrp, chr_fo_slots, loco_slot_ct_ptr, loco_preds_ptr);
+    if (unlikely(reterr)) {
+      goto GlmLocoRidgePrep_ret_1;
+    }
+    *chr_fo_slots_ptr = chr_fo_slots;
+  }
+  while (0) {
+  GlmLocoRidgePrep_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  GlmLocoRidgePrep_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+ GlmLocoRidgePrep_ret_1:
+  if (reterr) {
+    BigstackReset(bigstack_mark);
+  }
+  return reterr;
+}
+
+// Writes the --glm loco-ridge offsets actually used (loco_preds rows times
+// offset_scale) to outname: one row per sample, one column per left-out
+// autosome.
+PglErr WriteLocoOffsets(const uintptr_t* sample_include, const SampleIdInfo* siip, const ChrInfo* cip, const uint32_t* chr_fo_slots, const double* loco_preds, uint32_t sample_ct, uint32_t loco_slot_ct, double offset_scale, const char* outname) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  FILE* outfile = nullptr;
+  PglErr reterr = kPglRetSuccess;
+  {
+    // the last slot is the all-autosome prediction
+    const uint32_t autosome_slot_ct = loco_slot_ct - 1;
+    uint32_t* slot_chr_idxs;
+    if (unlikely(bigstack_alloc_u32(autosome_slot_ct, &slot_chr_idxs))) {
+      goto WriteLocoOffsets_ret_NOMEM;
+    }
+    const uint32_t chr_ct = cip->chr_ct;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      const uint32_t slot_idx = chr_fo_slots[chr_fo_idx];
+      if (slot_idx != autosome_slot_ct) {
+        slot_chr_idxs[slot_idx] = cip->chr_file_order[chr_fo_idx];
+      }
+    }
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
+      goto WriteLocoOffsets_ret_OPEN_FAIL;
+    }
+    const uint32_t write_fid = FidColIsRequired(siip, 1);
+    const char* sample_ids = siip->sample_ids;
+    const char* sids = siip->sids;
+    const uintptr_t max_sample_id_blen = siip->max_sample_id_blen;
+    const uintptr_t max_sid_blen = siip->max_sid_blen;
+    char* write_iter = g_textbuf;
+    char* textbuf_flush = &(write_iter[kMaxMediumLine]);
+    *write_iter++ = '#';
+    if (write_fid) {
+      write_iter = strcpya_k(write_iter, "FID\t");
+    }
+    write_iter = strcpya_k(write_iter, "IID");
+    if (sids) {
+      write_iter = strcpya_k(write_iter, "\tSID");
+    }
+    for (uint32_t slot_idx = 0; slot_idx != autosome_slot_ct; ++slot_idx) {
+      *write_iter++ = '\t';
+      write_iter = chrtoa(cip, slot_chr_idxs[slot_idx], write_iter);
+    }
+    AppendBinaryEoln(&write_iter);
+    uintptr_t sample_uidx_base = 0;
+    uintptr_t sample_include_bits = sample_include[0];
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      const uintptr_t sample_uidx = BitIter1(sample_include, &sample_uidx_base, &sample_include_bits);
+      const char* cur_sample_id = &(sample_ids[max_sample_id_blen * sample_uidx]);
+      if (!write_fid) {
+        cur_sample_id = AdvPastDelim(cur_sample_id, '\t');
+      }
+      write_iter = strcpya(write_iter, cur_sample_id);
+      if (sids) {
+        *write_iter++ = '\t';
+        write_iter = strcpya(write_iter, &(sids[max_sid_blen * sample_uidx]));
+      }
+      for (uint32_t slot_idx = 0; slot_idx != autosome_slot_ct; ++slot_idx) {
+        *write_iter++ = '\t';
+        write_iter = dtoa_g(loco_preds[slot_idx * S_CAST(uintptr_t, sample_ct) + sample_idx] * offset_scale, write_iter);
+      }
+      AppendBinaryEoln(&write_iter);
+      if (unlikely(fwrite_ck(textbuf_flush, outfile, &write_iter))) {
+        goto WriteLocoOffsets_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(fclose_flush_null(textbuf_flush, write_iter, &outfile))) {
+      goto WriteLocoOffsets_ret_WRITE_FAIL;
+    }
+    logprintfww("--glm loco-ridge: Offsets written to %s .\n", outname);
+  }
+  while (0) {
+  WriteLocoOffsets_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  WriteLocoOffsets_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  WriteLocoOffsets_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
   }
+  fclose_cond(outfile);
   BigstackReset(bigstack_mark);
   return reterr;
 }
@@ -10923,7 +13914,7 @@ void SexInteractionReshuffle(uint32_t first_interaction_pred_uidx, uint32_t raw_
   memcpy(parameters_or_tests, parameter_subset_reshuffle_buf, biallelic_raw_predictor_ctl * sizeof(intptr_t));
 }
 
-PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const PhenoCol* covar_cols, const char* covar_names, const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const AlleleCode* maj_alleles, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const AdjustInfo* adjust_info_ptr, const APerm* aperm_ptr, const char* local_covar_fname, const char* local_pvar_fname, const char* local_psam_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t orig_covar_ct, uintptr_t max_covar_name_blen, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t xchr_model, double ci_size, double vif_thresh, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end) {
+PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const PhenoCol* covar_cols, const char* covar_names, const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const AlleleCode* maj_alleles, const double* allele_freqs, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const AdjustInfo* adjust_info_ptr, const APerm* aperm_ptr, const char* local_covar_fname, const char* local_pvar_fname, const char* local_psam_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t orig_covar_ct, uintptr_t max_covar_name_blen, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t xchr_model, double ci_size, double vif_thresh, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, sfmt_t* sfmtp, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   unsigned char* bigstack_end_mark = g_bigstack_end;
   PglErr reterr = kPglRetSuccess;
@@ -10934,8 +13925,12 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
   GlmCtx common;
   GlmLogisticCtx logistic_ctx;
   GlmLinearCtx linear_ctx;
+  GlmHits hits;
+  PreinitCstream(&hits.bin_css);
+  hits.bin_writep = nullptr;
   logistic_ctx.common = &common;
   linear_ctx.common = &common;
+  common.hits = nullptr;
   {
     if (unlikely(!pheno_ct)) {
       logerrputs("Error: No phenotypes loaded.\n");
@@ -10965,6 +13960,8 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     common.glm_flags = glm_flags;
     common.dosage_presents = nullptr;
     common.dosage_mains = nullptr;
+    common.raregenos = nullptr;
+    common.difflist_sample_id_bufs = nullptr;
     const uint32_t output_zst = (glm_flags / kfGlmZs) & 1;
     const uint32_t perm_adapt = (glm_flags / kfGlmPerm) & 1;
     const uint32_t perms_total = perm_adapt? aperm_ptr->max : glm_info_ptr->mperm_ct;
@@ -10973,6 +13970,11 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     if (perms_total) {
       pheno_name_blen_capacity -= 6 - perm_adapt;
     }
+    if (glm_flags & kfGlmSumstatsBin) {
+      pheno_name_blen_capacity -= 13;
+    } else if (glm_flags & kfGlmHits) {
+      pheno_name_blen_capacity -= 5;
+    }
     if (unlikely(max_pheno_name_blen > pheno_name_blen_capacity)) {
       logerrputs("Error: Phenotype name and/or --out argument too long.\n");
       goto GlmMain_ret_INCONSISTENT_INPUT;
@@ -11103,6 +14105,8 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     }
     common.sex_male_collapsed = sex_male_collapsed_buf;
     common.omitted_alleles = (glm_flags & kfGlmOmitRef)? nullptr : maj_alleles;
+    common.ckpt_fname = nullptr;
+    common.ckpt_skip_variant_ct = 0;
     uint32_t raw_covar_ct = orig_covar_ct + local_covar_ct;
     if (glm_info_ptr->condition_varname || glm_info_ptr->condition_list_fname || local_covar_ct || add_sex_covar) {
       uint32_t condition_ct = 0;
@@ -11641,12 +14645,19 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     const uint32_t glm_pos_col = glm_info_ptr->cols & kfGlmColPos;
     const uint32_t gcount_cc_col = glm_info_ptr->cols & kfGlmColGcountcc;
     const uint32_t xtx_state = (add_interactions || local_covar_ct)? 0 : domdev_present_p1;
+    // Case/control phenotypes can share a GlmLogistic() pass when nothing
+    // phenotype-specific beyond the phenotype vector itself is precomputed.
+    const uint32_t logistic_subbatch_ok = (!report_adjust) && (!perms_total) && (!local_covar_ct) && (!(glm_flags & (kfGlmFirthResidualize | kfGlmCcResidualize | kfGlmScoreScreen | kfGlmLocoRidge | kfGlmCheckpoint | kfGlmSetTest | kfGlmHits | kfGlmSumstatsBin)));
 
     const uintptr_t raw_allele_ct = allele_idx_offsets? allele_idx_offsets[raw_variant_ct] : (2 * raw_variant_ct);
     const uintptr_t raw_allele_ctl = BitCtToWordCt(raw_allele_ct);
 
     common.max_extra_allele_ct = max_extra_allele_ct;
 
+    // Drawn once so that every phenotype gets the same --glm loco-ridge
+    // cross-validation folds.
+    const uint32_t loco_fold_seed = (glm_flags & kfGlmLocoRidge)? sfmt_genrand_uint32(sfmtp) : 0;
+
     const uint32_t pheno_ctl = BitCtToWordCt(pheno_ct);
     uintptr_t* pheno_include;
     if (unlikely(bigstack_alloc_w(pheno_ctl, &pheno_include))) {
@@ -11663,7 +14674,9 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
         goto GlmMain_ret_NOMEM;
       }
       bigstack_mark2 = g_bigstack_base;
-    } else if (pheno_ct > 1) {
+    } else if ((pheno_ct > 1) && (!(glm_flags & (kfGlmLocoRidge | kfGlmStepwise | kfGlmCheckpoint | kfGlmSetTest | kfGlmHits | kfGlmSumstatsBin)))) {
+      // (--glm loco-ridge offsets are phenotype-specific, so they don't fit
+      // in the batch.)
       // When there are multiple quantitative phenotypes with the same
       // missingness pattern, they can be processed more efficiently together.
       uintptr_t* pheno_batch;
@@ -12202,6 +15215,10 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
 
       BitvecAndCopy(orig_sample_include, cur_pheno_col->nonmiss, raw_sample_ctl, cur_sample_include);
       const uint32_t is_logistic = (dtype_code == kPhenoDtypeCc);
+      if (is_logistic && (glm_flags & kfGlmStepwise)) {
+        logerrprintfww("Warning: Skipping case/control phenotype '%s' since --glm stepwise= only supports quantitative phenotypes.\n", cur_pheno_name);
+        continue;
+      }
       uint32_t sample_ct = PopcountWords(cur_sample_include, raw_sample_ctl);
       if (is_logistic) {
         const uint32_t initial_case_ct = PopcountWordsIntersect(cur_sample_include, cur_pheno_col->data.cc, raw_sample_ctl);
@@ -12555,10 +15572,11 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       logistic_ctx.pheno_f = nullptr;
       logistic_ctx.covars_cmaj_f = nullptr;
       logistic_ctx.cc_residualize = nullptr;
+      logistic_ctx.score_screen = nullptr;
       linear_ctx.pheno_d = nullptr;
       linear_ctx.covars_cmaj_d = nullptr;
       if (is_logistic) {
-        if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include, cur_pheno_col->data.cc, covar_include, covar_cols, covar_names, sample_ct, domdev_present_p1, covar_ct, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec) : nullptr, &pheno_f, &common.nm_precomp, &covars_cmaj_f, &logistic_ctx.cc_residualize, &cur_covar_names, &glm_err))) {
+        if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include, cur_pheno_col->data.cc, covar_include, covar_cols, covar_names, sample_ct, domdev_present_p1, covar_ct, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec) : nullptr, &pheno_f, &common.nm_precomp, &covars_cmaj_f, &logistic_ctx.cc_residualize, &logistic_ctx.score_screen, &cur_covar_names, &glm_err))) {
           goto GlmMain_ret_NOMEM;
         }
       } else {
@@ -12580,11 +15598,12 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       logistic_ctx.pheno_x_f = nullptr;
       logistic_ctx.covars_cmaj_x_f = nullptr;
       logistic_ctx.cc_residualize_x = nullptr;
+      logistic_ctx.score_screen_x = nullptr;
       linear_ctx.pheno_x_d = nullptr;
       linear_ctx.covars_cmaj_x_d = nullptr;
       if (sample_ct_x) {
         if (is_logistic) {
-          if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include_x, cur_pheno_col->data.cc, covar_include_x, covar_cols, covar_names, sample_ct_x, domdev_present_p1, covar_ct_x, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct_x, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_x_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec_x) : nullptr, &logistic_ctx.pheno_x_f, &common.nm_precomp_x, &logistic_ctx.covars_cmaj_x_f, &logistic_ctx.cc_residualize_x, &cur_covar_names_x, &glm_err))) {
+          if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include_x, cur_pheno_col->data.cc, covar_include_x, covar_cols, covar_names, sample_ct_x, domdev_present_p1, covar_ct_x, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct_x, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_x_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec_x) : nullptr, &logistic_ctx.pheno_x_f, &common.nm_precomp_x, &logistic_ctx.covars_cmaj_x_f, &logistic_ctx.cc_residualize_x, &logistic_ctx.score_screen_x, &cur_covar_names_x, &glm_err))) {
             goto GlmMain_ret_NOMEM;
           }
         } else {
@@ -12607,11 +15626,12 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       logistic_ctx.pheno_y_f = nullptr;
       logistic_ctx.covars_cmaj_y_f = nullptr;
       logistic_ctx.cc_residualize_y = nullptr;
+      logistic_ctx.score_screen_y = nullptr;
       linear_ctx.pheno_y_d = nullptr;
       linear_ctx.covars_cmaj_y_d = nullptr;
       if (sample_ct_y) {
         if (is_logistic) {
-          if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include_y, cur_pheno_col->data.cc, covar_include_y, covar_cols, covar_names, sample_ct_y, domdev_present_p1, covar_ct_y, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct_y, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_y_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec_y) : nullptr, &logistic_ctx.pheno_y_f, &common.nm_precomp_y, &logistic_ctx.covars_cmaj_y_f, &logistic_ctx.cc_residualize_y, &cur_covar_names_y, &glm_err))) {
+          if (unlikely(GlmAllocFillAndTestPhenoCovarsCc(cur_sample_include_y, cur_pheno_col->data.cc, covar_include_y, covar_cols, covar_names, sample_ct_y, domdev_present_p1, covar_ct_y, local_covar_ct, covar_max_nonnull_cat_ct, extra_cat_ct_y, max_covar_name_blen, common.max_corr, vif_thresh, xtx_state, glm_flags, &logistic_ctx.pheno_y_cc, gcount_cc_col? (&logistic_ctx.gcount_case_interleaved_vec_y) : nullptr, &logistic_ctx.pheno_y_f, &common.nm_precomp_y, &logistic_ctx.covars_cmaj_y_f, &logistic_ctx.cc_residualize_y, &logistic_ctx.score_screen_y, &cur_covar_names_y, &glm_err))) {
             goto GlmMain_ret_NOMEM;
           }
         } else {
@@ -12627,6 +15647,143 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
           sample_ct_y = 0;
         }
       }
+      // Gather later case/control phenotypes which end up with exactly the
+      // same samples and covariates (on chrX and chrY as well).
+      uint32_t subbatch_size = 1;
+      uint32_t* subbatch_pheno_uidxs = nullptr;
+      if (is_logistic && logistic_subbatch_ok && (!logistic_ctx.separation_found) && ((!cur_sample_include_x) || (sample_ct_x && (!logistic_ctx.separation_found_x))) && ((!cur_sample_include_y) || (sample_ct_y && (!logistic_ctx.separation_found_y)))) {
+        // output stream buffers, and collapsed phenotype vectors for up to 3
+        // sample sets
+        uintptr_t subbatch_member_byte_ct = RoundUpPow2(overflow_buf_size, kCacheline) + 3 * (2 * BitCtToVecCt(sample_ct) * kBytesPerVec + RoundUpPow2(RoundUpPow2(sample_ct, kFloatPerFVec) * sizeof(float), kCacheline) + 3 * kCacheline);
+        if (output_zst) {
+          subbatch_member_byte_ct += RoundUpPow2(CstreamWkspaceReq(overflow_buf_size), kCacheline);
+        }
+        uint32_t max_subbatch_size = MINV(kMaxLogisticSubbatchSize, pheno_ct - pheno_uidx);
+        if (S_CAST(uint64_t, max_subbatch_size) * subbatch_member_byte_ct * 4 > bigstack_left()) {
+          max_subbatch_size = 1 + bigstack_left() / (subbatch_member_byte_ct * 4);
+        }
+        uintptr_t* cand_sample_include;
+        uintptr_t* cand_covar_include = nullptr;
+        if (unlikely(bigstack_alloc_u32(max_subbatch_size, &subbatch_pheno_uidxs) ||
+                     bigstack_alloc_w(raw_sample_ctl, &cand_sample_include) ||
+                     (raw_covar_ctl && bigstack_alloc_w(raw_covar_ctl, &cand_covar_include)))) {
+          goto GlmMain_ret_NOMEM;
+        }
+        subbatch_pheno_uidxs[0] = pheno_uidx;
+        for (uint32_t pheno_uidx2 = pheno_uidx + 1; (pheno_uidx2 != pheno_ct) && (subbatch_size != max_subbatch_size); ++pheno_uidx2) {
+          const PhenoCol* cand_pheno_col = &(pheno_cols[pheno_uidx2]);
+          if ((!IsSet(pheno_include, pheno_uidx2)) || (cand_pheno_col->type_code != kPhenoDtypeCc)) {
+            continue;
+          }
+          const uintptr_t* cand_pheno_cc = cand_pheno_col->data.cc;
+          uint32_t is_match;
+          BitvecAndCopy(orig_sample_include, cand_pheno_col->nonmiss, raw_sample_ctl, cand_sample_include);
+          if (unlikely(GlmCcSubbatchMatch(cand_pheno_cc, initial_covar_include, covar_cols, cur_sample_include, covar_include, raw_sample_ct, raw_covar_ctl, initial_nonx_covar_ct, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, sample_ct, covar_ct, extra_cat_ct, cand_sample_include, cand_covar_include, &is_match))) {
+            goto GlmMain_ret_NOMEM;
+          }
+          if ((!is_match) || (!cur_sample_include_x_buf)) {
+            // chrX is the same as the rest of the genome for everyone if
+            // cur_sample_include_x_buf is null
+          } else {
+            BitvecAndCopy(orig_sample_include, cand_pheno_col->nonmiss, raw_sample_ctl, cand_sample_include);
+            if (cur_sample_include_x) {
+              if (unlikely(GlmCcSubbatchMatch(cand_pheno_cc, initial_covar_include, covar_cols, cur_sample_include_x, covar_include_x, raw_sample_ct, raw_covar_ctl, initial_nonx_covar_ct + 1, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, sample_ct_x, covar_ct_x, extra_cat_ct_x, cand_sample_include, cand_covar_include, &is_match))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            } else {
+              if (unlikely(GlmCcSubbatchMatch(cand_pheno_cc, initial_covar_include, covar_cols, cur_sample_include, covar_include, raw_sample_ct, raw_covar_ctl, initial_nonx_covar_ct + 1, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, sample_ct, covar_ct, extra_cat_ct, cand_sample_include, cand_covar_include, &is_match))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            }
+          }
+          if (is_match && cur_sample_include_y_buf) {
+            BitvecAndCopy(orig_sample_include, sex_male, raw_sample_ctl, cand_sample_include);
+            BitvecAnd(cand_pheno_col->nonmiss, raw_sample_ctl, cand_sample_include);
+            if (cur_sample_include_y) {
+              if (unlikely(GlmCcSubbatchMatch(cand_pheno_cc, initial_covar_include, covar_cols, cur_sample_include_y, covar_include_y, raw_sample_ct, raw_covar_ctl, initial_y_covar_ct, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, sample_ct_y, covar_ct_y, extra_cat_ct_y, cand_sample_include, cand_covar_include, &is_match))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            } else {
+              if (unlikely(GlmCcSubbatchMatch(cand_pheno_cc, initial_covar_include, covar_cols, cur_sample_include, covar_include, raw_sample_ct, raw_covar_ctl, initial_y_covar_ct, covar_max_nonnull_cat_ct, is_sometimes_firth, is_always_firth, sample_ct, covar_ct, extra_cat_ct, cand_sample_include, cand_covar_include, &is_match))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            }
+          }
+          if (!is_match) {
+            continue;
+          }
+          subbatch_pheno_uidxs[subbatch_size++] = pheno_uidx2;
+          const uint32_t cand_case_ct = PopcountWordsIntersect(cur_sample_include, cand_pheno_cc, raw_sample_ctl);
+          if (MINV(cand_case_ct, sample_ct - cand_case_ct) < 10 * biallelic_predictor_ct) {
+            logerrprintfww("Warning: --glm remaining %s count is less than 10x predictor count for phenotype '%s'.\n", (cand_case_ct * 2 < sample_ct)? "case" : "control", &(pheno_names[pheno_uidx2 * max_pheno_name_blen]));
+          }
+        }
+        BigstackReset(cand_sample_include);
+        if (subbatch_size == 1) {
+          BigstackReset(subbatch_pheno_uidxs);
+          subbatch_pheno_uidxs = nullptr;
+        } else {
+          // Phenotype 0's vectors were already filled by
+          // GlmAllocFillAndTestPhenoCovarsCc(); rebuild them in the subbatch
+          // layout.
+          const uintptr_t pheno_cc_stride = BitCtToVecCt(sample_ct) * kWordsPerVec;
+          const uintptr_t pheno_cc_stride_x = BitCtToVecCt(sample_ct_x) * kWordsPerVec;
+          const uintptr_t pheno_cc_stride_y = BitCtToVecCt(sample_ct_y) * kWordsPerVec;
+          const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+          const uintptr_t sample_ctav_x = RoundUpPow2(sample_ct_x, kFloatPerFVec);
+          const uintptr_t sample_ctav_y = RoundUpPow2(sample_ct_y, kFloatPerFVec);
+          if (unlikely(bigstack_alloc_w(pheno_cc_stride * subbatch_size, &logistic_ctx.pheno_cc) ||
+                       bigstack_alloc_f(sample_ctav * subbatch_size, &pheno_f))) {
+            goto GlmMain_ret_NOMEM;
+          }
+          if (gcount_cc_col) {
+            if (unlikely(bigstack_alloc_w(pheno_cc_stride * subbatch_size, &logistic_ctx.gcount_case_interleaved_vec))) {
+              goto GlmMain_ret_NOMEM;
+            }
+          }
+          if (sample_ct_x) {
+            if (unlikely(bigstack_alloc_w(pheno_cc_stride_x * subbatch_size, &logistic_ctx.pheno_x_cc) ||
+                         bigstack_alloc_f(sample_ctav_x * subbatch_size, &logistic_ctx.pheno_x_f))) {
+              goto GlmMain_ret_NOMEM;
+            }
+            if (gcount_cc_col) {
+              if (unlikely(bigstack_alloc_w(pheno_cc_stride_x * subbatch_size, &logistic_ctx.gcount_case_interleaved_vec_x))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            }
+          }
+          if (sample_ct_y) {
+            if (unlikely(bigstack_alloc_w(pheno_cc_stride_y * subbatch_size, &logistic_ctx.pheno_y_cc) ||
+                         bigstack_alloc_f(sample_ctav_y * subbatch_size, &logistic_ctx.pheno_y_f))) {
+              goto GlmMain_ret_NOMEM;
+            }
+            if (gcount_cc_col) {
+              if (unlikely(bigstack_alloc_w(pheno_cc_stride_y * subbatch_size, &logistic_ctx.gcount_case_interleaved_vec_y))) {
+                goto GlmMain_ret_NOMEM;
+              }
+            }
+          }
+          for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+            const uintptr_t* member_pheno_cc = pheno_cols[subbatch_pheno_uidxs[fidx]].data.cc;
+            FillPhenoCcSubbatchMember(cur_sample_include, member_pheno_cc, sample_ct, &(logistic_ctx.pheno_cc[fidx * pheno_cc_stride]), gcount_cc_col? (&(logistic_ctx.gcount_case_interleaved_vec[fidx * pheno_cc_stride])) : nullptr, &(pheno_f[fidx * sample_ctav]));
+            if (sample_ct_x) {
+              FillPhenoCcSubbatchMember(cur_sample_include_x, member_pheno_cc, sample_ct_x, &(logistic_ctx.pheno_x_cc[fidx * pheno_cc_stride_x]), gcount_cc_col? (&(logistic_ctx.gcount_case_interleaved_vec_x[fidx * pheno_cc_stride_x])) : nullptr, &(logistic_ctx.pheno_x_f[fidx * sample_ctav_x]));
+            }
+            if (sample_ct_y) {
+              FillPhenoCcSubbatchMember(cur_sample_include_y, member_pheno_cc, sample_ct_y, &(logistic_ctx.pheno_y_cc[fidx * pheno_cc_stride_y]), gcount_cc_col? (&(logistic_ctx.gcount_case_interleaved_vec_y[fidx * pheno_cc_stride_y])) : nullptr, &(logistic_ctx.pheno_y_f[fidx * sample_ctav_y]));
+            }
+            if (fidx) {
+              ClearBit(subbatch_pheno_uidxs[fidx], pheno_include);
+            }
+          }
+        }
+      }
+      logistic_ctx.subbatch_size = subbatch_size;
+      if (is_logistic && (glm_flags & kfGlmScoreScreen)) {
+        if ((!logistic_ctx.score_screen) || (sample_ct_x && (!logistic_ctx.score_screen_x)) || (sample_ct_y && (!logistic_ctx.score_screen_y))) {
+          logerrprintfww("Warning: Covariate-only logistic regression failed for phenotype '%s'; --glm score-screen= screening disabled for the affected variants.\n", cur_pheno_name);
+        }
+      }
       const char** cur_test_names = nullptr;
       const char** cur_test_names_x = nullptr;
       const char** cur_test_names_y = nullptr;
@@ -12760,62 +15917,198 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       }
       common.variant_include = cur_variant_include;
       common.variant_ct = cur_variant_ct;
-      // this is safe, see pheno_name_blen_capacity check above
-      char* outname_end2 = strcpya(&(outname_end[1]), cur_pheno_name);
       if (is_logistic) {
         logistic_ctx.pheno_f = pheno_f;
         logistic_ctx.covars_cmaj_f = covars_cmaj_f;
-        if (is_always_firth) {
-          outname_end2 = strcpya_k(outname_end2, ".glm.firth");
-        } else if (is_sometimes_firth) {
-          outname_end2 = strcpya_k(outname_end2, ".glm.logistic.hybrid");
-        } else {
-          outname_end2 = strcpya_k(outname_end2, ".glm.logistic");
-        }
       } else {
         linear_ctx.covars_cmaj_d = covars_cmaj_d;
-        outname_end2 = strcpya_k(outname_end2, ".glm.linear");
       }
-      // write IDs
-      if (glm_flags & kfGlmPhenoIds) {
-        snprintf(outname_end2, 22, ".id");
-        reterr = WriteSampleIds(cur_sample_include, siip, outname, sample_ct);
+      common.loco_chr_fo_slots = nullptr;
+      logistic_ctx.loco_offsets_f = nullptr;
+      logistic_ctx.loco_slot_ct = 0;
+      linear_ctx.loco_pheno_d = nullptr;
+      linear_ctx.loco_xt_y_images = nullptr;
+      if (glm_flags & kfGlmLocoRidge) {
+        uint32_t* loco_chr_fo_slots;
+        uint32_t loco_slot_ct;
+        double* loco_preds;
+#ifdef USE_MTBLAS
+        BLAS_SET_NUM_THREADS(max_thread_ct);
+#endif
+        reterr = GlmLocoRidgePrep(cur_sample_include, common.sample_include_cumulative_popcounts, early_variant_include, cip, allele_idx_offsets, allele_freqs, is_logistic? nullptr : linear_ctx.pheno_d, pheno_f, covars_cmaj_d, covars_cmaj_f, raw_sample_ct, sample_ct, common.covar_ct, PgrGetMaxAlleleCt(simple_pgrp), glm_info_ptr->loco_ridge_h2, loco_fold_seed, simple_pgrp, &loco_chr_fo_slots, &loco_slot_ct, &loco_preds);
+        BLAS_SET_NUM_THREADS(1);
         if (unlikely(reterr)) {
           goto GlmMain_ret_1;
         }
-        if (sample_ct_x && x_samples_are_different) {
-          // quasi-bugfix (7 Jan 2017): use ".x.id" suffix instead of ".id.x",
-          // since the last part of the file extension should indicate format
-          snprintf(outname_end2, 22, ".x.id");
-          reterr = WriteSampleIds(cur_sample_include_x, siip, outname, sample_ct_x);
-          if (unlikely(reterr)) {
-            goto GlmMain_ret_1;
+        common.loco_chr_fo_slots = loco_chr_fo_slots;
+        // Linearize around the case fraction: a shift of delta on the
+        // phenotype scale is roughly delta / (p(1-p)) on the logit scale.
+        double logit_scale = 1.0;
+        if (is_logistic) {
+          const double case_frac = u31tod(PopcountWords(logistic_ctx.pheno_cc, BitCtToWordCt(sample_ct))) / u31tod(sample_ct);
+          logit_scale = 1.0 / (case_frac * (1.0 - case_frac));
+        }
+        snprintf(strcpya(&(outname_end[1]), cur_pheno_name), 22, ".glm.loco");
+        reterr = WriteLocoOffsets(cur_sample_include, siip, cip, loco_chr_fo_slots, loco_preds, sample_ct, loco_slot_ct, logit_scale, outname);
+        if (unlikely(reterr)) {
+          goto GlmMain_ret_1;
+        }
+        if (is_logistic) {
+          const uintptr_t sample_ctav = RoundUpPow2(sample_ct, kFloatPerFVec);
+          float* loco_offsets_f;
+          if (unlikely(bigstack_calloc_f(loco_slot_ct * sample_ctav, &loco_offsets_f))) {
+            goto GlmMain_ret_NOMEM;
+          }
+          for (uintptr_t slot_idx = 0; slot_idx != loco_slot_ct; ++slot_idx) {
+            const double* cur_preds = &(loco_preds[slot_idx * sample_ct]);
+            float* cur_offsets = &(loco_offsets_f[slot_idx * sample_ctav]);
+            for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+              cur_offsets[sample_idx] = S_CAST(float, cur_preds[sample_idx] * logit_scale);
+            }
+          }
+          logistic_ctx.loco_offsets_f = loco_offsets_f;
+          logistic_ctx.loco_slot_ct = loco_slot_ct;
+        } else {
+          // Subtract the offsets in place; loco_preds isn't needed afterward.
+          const double* pheno_d = linear_ctx.pheno_d;
+          for (uintptr_t slot_idx = 0; slot_idx != loco_slot_ct; ++slot_idx) {
+            double* cur_pheno = &(loco_preds[slot_idx * sample_ct]);
+            for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+              cur_pheno[sample_idx] = pheno_d[sample_idx] - cur_pheno[sample_idx];
+            }
+          }
+          linear_ctx.loco_pheno_d = loco_preds;
+          if (common.nm_precomp && common.nm_precomp->xt_y_image) {
+            const uintptr_t xt_y_image_size = 1 + domdev_present_p1 + common.covar_ct;
+            double* loco_xt_y_images;
+            if (unlikely(bigstack_alloc_d(loco_slot_ct * xt_y_image_size, &loco_xt_y_images))) {
+              goto GlmMain_ret_NOMEM;
+            }
+            for (uintptr_t slot_idx = 0; slot_idx != loco_slot_ct; ++slot_idx) {
+              const double* cur_pheno = &(loco_preds[slot_idx * sample_ct]);
+              double* cur_xt_y_image = &(loco_xt_y_images[slot_idx * xt_y_image_size]);
+              double pheno_sum = 0.0;
+              for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+                pheno_sum += cur_pheno[sample_idx];
+              }
+              cur_xt_y_image[0] = pheno_sum;
+              ZeroDArr(domdev_present_p1, &(cur_xt_y_image[1]));
+              ColMajorVectorMatrixMultiplyStrided(cur_pheno, covars_cmaj_d, sample_ct, sample_ct, common.covar_ct, &(cur_xt_y_image[1 + domdev_present_p1]));
+            }
+            linear_ctx.loco_xt_y_images = loco_xt_y_images;
+          }
+        }
+      }
+      const char** subbatch_pheno_names;
+      const char** subbatch_outnames;
+      if (unlikely(bigstack_alloc_kcp(subbatch_size, &subbatch_pheno_names) ||
+                   bigstack_alloc_kcp(subbatch_size, &subbatch_outnames))) {
+        goto GlmMain_ret_NOMEM;
+      }
+      char* outname_end2 = nullptr;
+      for (uint32_t fidx = 0; fidx != subbatch_size; ++fidx) {
+        const char* member_pheno_name = fidx? (&(pheno_names[subbatch_pheno_uidxs[fidx] * max_pheno_name_blen])) : cur_pheno_name;
+        subbatch_pheno_names[fidx] = member_pheno_name;
+        // this is safe, see pheno_name_blen_capacity check above
+        outname_end2 = strcpya(&(outname_end[1]), member_pheno_name);
+        if (glm_flags & kfGlmSetTest) {
+          outname_end2 = strcpya_k(outname_end2, ".glm.sets");
+        } else if (is_logistic) {
+          if (is_always_firth) {
+            outname_end2 = strcpya_k(outname_end2, ".glm.firth");
+          } else if (is_sometimes_firth) {
+            outname_end2 = strcpya_k(outname_end2, ".glm.logistic.hybrid");
+          } else {
+            outname_end2 = strcpya_k(outname_end2, ".glm.logistic");
           }
+        } else if (glm_flags & kfGlmStepwise) {
+          outname_end2 = strcpya_k(outname_end2, ".glm.stepwise");
+        } else {
+          outname_end2 = strcpya_k(outname_end2, ".glm.linear");
         }
-        if (sample_ct_y && y_samples_are_different) {
-          snprintf(outname_end2, 22, ".y.id");
-          reterr = WriteSampleIds(cur_sample_include_y, siip, outname, sample_ct_y);
+        // write IDs
+        if (glm_flags & kfGlmPhenoIds) {
+          snprintf(outname_end2, 22, ".id");
+          reterr = WriteSampleIds(cur_sample_include, siip, outname, sample_ct);
           if (unlikely(reterr)) {
             goto GlmMain_ret_1;
           }
+          if (sample_ct_x && x_samples_are_different) {
+            // quasi-bugfix (7 Jan 2017): use ".x.id" suffix instead of
+            // ".id.x", since the last part of the file extension should
+            // indicate format
+            snprintf(outname_end2, 22, ".x.id");
+            reterr = WriteSampleIds(cur_sample_include_x, siip, outname, sample_ct_x);
+            if (unlikely(reterr)) {
+              goto GlmMain_ret_1;
+            }
+          }
+          if (sample_ct_y && y_samples_are_different) {
+            snprintf(outname_end2, 22, ".y.id");
+            reterr = WriteSampleIds(cur_sample_include_y, siip, outname, sample_ct_y);
+            if (unlikely(reterr)) {
+              goto GlmMain_ret_1;
+            }
+          }
         }
-      }
 
-      if (output_zst) {
-        snprintf(outname_end2, 22, ".zst");
-      } else {
-        *outname_end2 = '\0';
+        if (output_zst) {
+          snprintf(outname_end2, 22, ".zst");
+        } else {
+          *outname_end2 = '\0';
+        }
+        if (subbatch_size == 1) {
+          subbatch_outnames[0] = outname;
+        } else {
+          const uint32_t outname_blen = 1 + strlen(outname);
+          char* outname_copy;
+          if (unlikely(bigstack_alloc_c(outname_blen, &outname_copy))) {
+            goto GlmMain_ret_NOMEM;
+          }
+          memcpy(outname_copy, outname, outname_blen);
+          subbatch_outnames[fidx] = outname_copy;
+        }
       }
 
+      if (glm_flags & kfGlmCheckpoint) {
+        uint32_t is_complete;
+        reterr = GlmCheckpointInit(outname, cip, raw_variant_ct, (glm_flags / kfGlmResume) & 1, &common, &is_complete);
+        if (unlikely(reterr)) {
+          goto GlmMain_ret_1;
+        }
+        if (is_complete) {
+          continue;
+        }
+      }
+      unsigned char* hits_bigstack_mark = g_bigstack_base;
+      if (glm_flags & (kfGlmHits | kfGlmSumstatsBin)) {
+        reterr = GlmHitsStart(cur_variant_include, allele_idx_offsets, variant_bps, glm_info_ptr, raw_variant_ct, cur_variant_ct, outname, outname_end2, &hits);
+        if (unlikely(reterr)) {
+          goto GlmMain_ret_1;
+        }
+        common.hits = &hits;
+      }
       uintptr_t valid_allele_ct = 0;
-      if (is_logistic) {
-        reterr = GlmLogistic(cur_pheno_name, cur_test_names, cur_test_names_x, cur_test_names_y, glm_pos_col? variant_bps : nullptr, variant_ids, allele_storage, glm_info_ptr, local_sample_uidx_order, cur_local_variant_include, outname, raw_variant_ct, max_chr_blen, ci_size, ln_pfilter, output_min_ln, max_thread_ct, pgr_alloc_cacheline_ct, overflow_buf_size, local_sample_ct, pgfip, &logistic_ctx, &local_covar_txs, valid_variants, valid_alleles, orig_ln_pvals, orig_permstat, &valid_allele_ct);
+      if (glm_flags & kfGlmSetTest) {
+        reterr = GlmSetTest(cur_pheno_name, is_logistic? nullptr : linear_ctx.pheno_d, is_logistic? nullptr : linear_ctx.covars_cmaj_d, is_logistic? logistic_ctx.pheno_f : nullptr, is_logistic? logistic_ctx.covars_cmaj_f : nullptr, variant_bps, glm_info_ptr, outname, raw_sample_ct, raw_variant_ct, output_min_ln, max_thread_ct, overflow_buf_size, simple_pgrp, &common);
+      } else if (is_logistic) {
+        reterr = GlmLogistic(subbatch_pheno_names, cur_test_names, cur_test_names_x, cur_test_names_y, glm_pos_col? variant_bps : nullptr, variant_ids, allele_storage, glm_info_ptr, local_sample_uidx_order, cur_local_variant_include, subbatch_outnames, raw_variant_ct, max_chr_blen, ci_size, ln_pfilter, output_min_ln, max_thread_ct, pgr_alloc_cacheline_ct, overflow_buf_size, local_sample_ct, pgfip, &logistic_ctx, &local_covar_txs, valid_variants, valid_alleles, orig_ln_pvals, orig_permstat, &valid_allele_ct);
+      } else if (glm_flags & kfGlmStepwise) {
+        reterr = GlmLinearStepwise(cur_pheno_name, variant_bps, variant_ids, allele_storage, glm_info_ptr, outname, raw_sample_ct, max_chr_blen, output_min_ln, max_thread_ct, overflow_buf_size, simple_pgrp, &linear_ctx);
       } else {
         reterr = GlmLinear(cur_pheno_name, cur_test_names, cur_test_names_x, cur_test_names_y, glm_pos_col? variant_bps : nullptr, variant_ids, allele_storage, glm_info_ptr, local_sample_uidx_order, cur_local_variant_include, outname, raw_variant_ct, max_chr_blen, ci_size, ln_pfilter, output_min_ln, max_thread_ct, pgr_alloc_cacheline_ct, overflow_buf_size, local_sample_ct, pgfip, &linear_ctx, &local_covar_txs, valid_variants, valid_alleles, orig_ln_pvals, &valid_allele_ct);
       }
       if (unlikely(reterr)) {
         goto GlmMain_ret_1;
       }
+      if (common.hits) {
+        common.hits = nullptr;
+        reterr = GlmHitsFinish(cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, glm_flags, is_logistic && (!(glm_info_ptr->cols & kfGlmColBeta)), output_min_ln, overflow_buf_size, outname, outname_end2, &hits);
+        if (unlikely(reterr)) {
+          goto GlmMain_ret_1;
+        }
+        BigstackReset(hits_bigstack_mark);
+      }
       if (report_adjust) {
         reterr = Multcomp(valid_variants, cip, nullptr, variant_bps, variant_ids, valid_alleles, allele_idx_offsets, allele_storage, nullptr, adjust_info_ptr, orig_ln_pvals, nullptr, valid_allele_ct, max_allele_slen, ln_pfilter, output_min_ln, joint_test, max_thread_ct, outname, outname_end2);
         if (unlikely(reterr)) {
@@ -12855,6 +16148,7 @@ PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     break;
   }
  GlmMain_ret_1:
+  CswriteCloseCond(&hits.bin_css, hits.bin_writep);
   CleanupTokenStream2("--condition-list file", &tks, &reterr);
   CleanupTextStream2(local_covar_fname, &local_covar_txs, &reterr);
   BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
@@ -19,12 +19,13 @@
 
 
 #include "plink2_adjust.h"
+#include "include/SFMT.h"
 
 #ifdef __cplusplus
 namespace plink2 {
 #endif
 
-FLAGSET_DEF_START()
+FLAGSET64_DEF_START()
   kfGlm0,
   kfGlmZs = (1 << 0),
 
@@ -59,8 +60,19 @@ FLAGSET_DEF_START()
   kfGlmLocalHaps = (1 << 23),
   kfGlmLocalCats1based = (1 << 24),
   kfGlmFirthResidualize = (1 << 25),
-  kfGlmCcResidualize = (1 << 26)
-FLAGSET_DEF_END(GlmFlags);
+  kfGlmCcResidualize = (1 << 26),
+  kfGlmScoreScreen = (1 << 27),
+  kfGlmScoreScreenSpa = (1 << 28),
+  kfGlmLocoRidge = (1 << 29),
+  kfGlmStepwise = (1 << 30),
+  kfGlmCheckpoint = (1U << 31),
+  kfGlmResume = (1LLU << 32),
+  kfGlmSetTest = (1LLU << 33),
+  kfGlmSetTestBed0 = (1LLU << 34),
+  kfGlmHits = (1LLU << 35),
+  kfGlmSumstatsBin = (1LLU << 36),
+  kfGlmFirthWarmStart = (1LLU << 37)
+FLAGSET64_DEF_END(GlmFlags);
 
 FLAGSET_DEF_START()
   kfGlmCol0,
@@ -79,18 +91,19 @@ FLAGSET_DEF_START()
   kfGlmColA1freqcc = (1 << 12),
   kfGlmColMachR2 = (1 << 13),
   kfGlmColFirthYn = (1 << 14),
-  kfGlmColTest = (1 << 15),
-  kfGlmColNobs = (1 << 16),
+  kfGlmColScreenYn = (1 << 15),
+  kfGlmColTest = (1 << 16),
+  kfGlmColNobs = (1 << 17),
 
   // if beta specified, ignore orbeta
-  kfGlmColBeta = (1 << 17),
-  kfGlmColOrbeta = (1 << 18),
-
-  kfGlmColSe = (1 << 19),
-  kfGlmColCi = (1 << 20),
-  kfGlmColTz = (1 << 21),
-  kfGlmColP = (1 << 22),
-  kfGlmColErr = (1 << 23),
+  kfGlmColBeta = (1 << 18),
+  kfGlmColOrbeta = (1 << 19),
+
+  kfGlmColSe = (1 << 20),
+  kfGlmColCi = (1 << 21),
+  kfGlmColTz = (1 << 22),
+  kfGlmColP = (1 << 23),
+  kfGlmColErr = (1 << 24),
   kfGlmColDefault = (kfGlmColChrom | kfGlmColPos | kfGlmColRef | kfGlmColAlt | kfGlmColFirthYn | kfGlmColTest | kfGlmColNobs | kfGlmColOrbeta | kfGlmColSe | kfGlmColCi | kfGlmColTz | kfGlmColP | kfGlmColErr)
 FLAGSET_DEF_END(GlmColFlags);
 
@@ -105,6 +118,22 @@ typedef struct GlmInfoStruct {
   uint32_t local_bp_col;
   uint32_t local_first_covar_col;
   double max_corr;
+  // natural log of score-screen= p-value threshold
+  double score_screen_ln_thresh;
+  // loco-ridge= heritability; determines the ridge penalty
+  double loco_ridge_h2;
+  // natural log of stepwise= p-value threshold
+  double stepwise_ln_thresh;
+  // set-test-max-maf=; only variants with minor allele frequency at or below
+  // this enter the set-based tests
+  double set_max_maf;
+  // set-test-max-vct=; larger sets are skipped, since each set-test thread
+  // needs 3 * <ct>^2 doubles of workspace
+  uint32_t set_max_vct;
+  // hits= limit (0 = no count limit) and natural log of hits-p= threshold
+  uint32_t hits_max_ct;
+  double hits_ln_thresh;
+  char* set_test_fname;
   char* condition_varname;
   char* condition_list_fname;
   RangeList parameters_range_list;
@@ -115,7 +144,7 @@ void InitGlm(GlmInfo* glm_info_ptr);
 
 void CleanupGlm(GlmInfo* glm_info_ptr);
 
-PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const PhenoCol* covar_cols, const char* covar_names, const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const AlleleCode* maj_alleles, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const AdjustInfo* adjust_info_ptr, const APerm* aperm_ptr, const char* local_covar_fname, const char* local_pvar_fname, const char* local_psam_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t orig_covar_ct, uintptr_t max_covar_name_blen, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t xchr_model, double ci_size, double vif_thresh, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, char* outname, char* outname_end);
+PglErr GlmMain(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* sex_nm, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const PhenoCol* covar_cols, const char* covar_names, const uintptr_t* orig_variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const AlleleCode* maj_alleles, const double* allele_freqs, const char* const* allele_storage, const GlmInfo* glm_info_ptr, const AdjustInfo* adjust_info_ptr, const APerm* aperm_ptr, const char* local_covar_fname, const char* local_pvar_fname, const char* local_psam_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t orig_covar_ct, uintptr_t max_covar_name_blen, uint32_t raw_variant_ct, uint32_t orig_variant_ct, uint32_t max_variant_id_slen, uint32_t max_allele_slen, uint32_t xchr_model, double ci_size, double vif_thresh, double ln_pfilter, double output_min_ln, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, sfmt_t* sfmtp, char* outname, char* outname_end);
 
 #ifdef __cplusplus
 }  // namespace plink2
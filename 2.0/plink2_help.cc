@@ -281,10 +281,12 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
               );
     HelpPrint("make-pgen\0make-bpgen\0make-bed\0make-just-pvar\0make-just-psam\0", &help_ctrl, 1,
 "  --make-pgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"              ['erase-dosage'] ['fill-missing-from-dosage']\n"
-"              ['pvar-cols='<col set desc>] ['psam-cols='<col set desc>]\n"
+"              ['erase-dosage'] ['fill-missing-from-dosage'] ['smaj'] ['vidx']\n"
+"              ['cksum'] ['pvar-cols='<col set desc>]\n"
+"              ['psam-cols='<col set desc>]\n"
 "  --make-bpgen ['vzs'] ['format='<code>] ['trim-alts'] ['erase-phase']\n"
-"               ['erase-dosage'] ['fill-missing-from-dosage']\n"
+"               ['erase-dosage'] ['fill-missing-from-dosage'] ['smaj']\n"
+"               ['cksum']\n"
 "  --make-bed ['vzs'] ['trim-alts']\n"
                /*
 "  --make-pgen ['vzs'] ['format='<code>] [{trim-alts | erase-alt2+}]\n"
@@ -325,6 +327,18 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    * When a hardcall is missing but the corresponding dosage is present,\n"
 "      'fill-missing-from-dosage' causes the (Euclidean-)nearest hardcall to be\n"
 "      filled in, with ties broken in favor of the lower-index allele.\n"
+"    * 'smaj' additionally writes a sample-major copy of the hardcalls to\n"
+"      .pgen.smaj.  This is stored uncompressed (about the size of a .bed), but\n"
+"      lets per-sample queries over a variant range read only the relevant\n"
+"      bytes.\n"
+"    * 'vidx' (implies 'vzs') writes the .pvar.zst as a series of independently\n"
+"      decodable frames, plus a .pvar.zst.vidx index of their chromosomes and\n"
+"      position ranges.  Later runs with --chr/--not-chr/--from-bp/--to-bp etc.\n"
+"      then skip decompression of excluded frames.  The index is ignored once\n"
+"      the .pvar.zst's size, modification time, or first/last 64 KiB change.\n"
+"    * 'cksum' additionally writes .pgen.cksum, containing a CRC32C checksum of\n"
+"      every 64Ki-variant block.  --validate and --pgen-verify use it to detect\n"
+"      corruption (e.g. from a bad copy) with one parallel pass over the file.\n"
                /*
 "    * The 'multiallelics=' modifier (alias: 'm=') specifies a join or split\n"
 "      mode.  The following modes are currently supported:\n"
@@ -403,7 +417,7 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      The default is maybefid,maybesid,maybeparents,sex,phenos.\n\n"
               );
     HelpPrint("make-just-pvar\0make-just-psam\0make-just-bim\0make-just-fam\0write-cluster\n\0", &help_ctrl, 1,
-"  --make-just-pvar ['zs'] ['cols='<column set descriptor>]\n"
+"  --make-just-pvar ['zs'] ['vidx'] ['cols='<column set descriptor>]\n"
 "  --make-just-psam ['cols='<column set descriptor>]\n"
 "  --make-just-bim ['zs']\n"
 "  --make-just-fam\n"
@@ -945,7 +959,7 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    hethet/ibs0/ibs1 values are proportions unless the 'counts' modifier is\n"
 "    present.  If id is omitted, a .kin0.id file is also written.\n\n"
                );
-    HelpPrint("make-rel\0make-grm\0make-grm-bin\0make-grm-list\0make-grm-gz\0", &help_ctrl, 1,
+    HelpPrint("make-rel\0make-grm\0make-grm-bin\0make-grm-list\0make-grm-gz\0make-grm-sparse\0", &help_ctrl, 1,
 "  --make-rel ['cov'] ['meanimpute'] [{square | square0 | triangle}]\n"
 "             [{zs | bin | bin4}]\n"
 "    Write a lower-triangular variance-standardized relationship matrix to\n"
@@ -967,7 +981,14 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "    them in GCTA 1.1+'s single-precision triangular binary format.  Note that\n"
 "    these formats explicitly report the number of valid observations (where\n"
 "    neither sample has a missing call) for each pair, which is useful input for\n"
-"    some scripts.\n\n"
+"    some scripts.\n"
+"  --make-grm-sparse ['cutoff='<val>] ['cov'] ['meanimpute'] ['zs']\n"
+"                    [{id-header | iid-only}]\n"
+"    Write only the diagonal and the off-diagonal relationships greater than the\n"
+"    cutoff (default 0.05) to <output prefix>.grm.sp, in GCTA's sparse format\n"
+"    (0-based sample indices and value, sorted by row and then column).  The\n"
+"    matrix is computed in row tiles sized to the available workspace, so the\n"
+"    full dense matrix is never held in memory; --parallel is also supported.\n\n"
                );
 #ifndef NOLAPACK
     // GRM, PCA, etc. based on major vs. nonmajor alleles
@@ -978,6 +999,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "  --pca [count] [{approx | meanimpute}] ['scols='<col set descriptor>]\n"
 "  --pca [{allele-wts | biallelic-var-wts}] [count] [{approx | meanimpute}]\n"
 "        ['vzs'] ['scols='<col set descriptor>] ['vcols='<col set descriptor>]\n"
+"  --pca [count] model ...\n"
+"  --pca [count] stream ['iters='<ct>] ['block-size='<ct>] ...\n"
 "    Extracts top principal components from the variance-standardized\n"
 "    relationship matrix.\n"
 "    * It is usually best to perform this calculation on a variant set in\n"
@@ -992,6 +1015,15 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      Price AL (2016) Fast Principal-Component Analysis Reveals Convergent\n"
 "      Evolution of ADH1B in Europe and East Asia.  This can be a good idea when\n"
 "      you have >5k samples, and is almost required with >50k.\n"
+"    * The 'stream' modifier selects a randomized subspace iteration which only\n"
+"      keeps a (sample count) x (block size) basis in memory between passes\n"
+"      over the genotype file, so memory usage does not grow with the number of\n"
+"      variants, and the 100-PC limit of 'approx' does not apply.  'iters='\n"
+"      sets the number of power iterations (default 10; each costs one more\n"
+"      pass), and 'block-size=' sets the subspace dimension (default\n"
+"      max(2 * count, count + 10)).  The largest relative eigenvector residual\n"
+"      is logged after every pass as a convergence diagnostic.  Other --pca\n"
+"      modifiers (e.g. allele-wts) can be combined with 'stream'.\n"
 "    * The randomized algorithm always uses mean imputation for missing genotype\n"
 "      calls.  For comparison purposes, you can use the 'meanimpute' modifier to\n"
 "      request this behavior for the standard computation.\n"
@@ -1028,9 +1060,28 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "        nonmaj: Minor allele.\n"
 "        (PCs are always present, and positioned here.  Signs are w.r.t. the\n"
 "        major, not necessarily reference, allele.)\n"
-"      Default is chrom,maj,nonmaj.\n\n"
+"      Default is chrom,maj,nonmaj.\n"
+"    * The 'model' modifier writes a binary <output prefix>.eigenvec.model file\n"
+"      with the variant IDs, allele codes and frequencies, allele weights, and\n"
+"      eigenvalues needed by --pca-project.\n\n"
                );
 #endif
+    HelpPrint("pca-project\0pca\0", &help_ctrl, 1,
+"  --pca-project <.eigenvec.model file> ['shrinkage'] ['scols='<col set desc.>]\n"
+"    Project the current samples onto the PCs stored in a \"--pca model\" file,\n"
+"    in a single pass over the genotype data.  Variants are matched by ID, and\n"
+"    allele codes must match as a set (REF/ALT swaps are ok).  Model variants\n"
+"    absent from the current dataset are skipped, and the remaining weights are\n"
+"    rescaled to compensate.  Results are written to\n"
+"    <output prefix>.proj.eigenvec, on the same scale as the reference\n"
+"    .eigenvec.\n"
+"    * Projected PC scores of samples outside the reference are shrunk toward\n"
+"      zero when there are more variants than reference samples.  'shrinkage'\n"
+"      applies the asymptotic correction from Lee S, Zou F, Wright FA (2010)\n"
+"      Convergence and prediction of principal component scores in\n"
+"      high-dimensional settings.\n"
+"    * 'scols=' works the same way as for --pca.\n\n"
+               );
     HelpPrint("king-cutoff\0make-king\0make-king-table\0rel-cutoff\0grm-cutoff\0", &help_ctrl, 1,
 "  --king-cutoff [.king.bin + .king.id fileset prefix] <threshold>\n"
 "    Exclude one member of each pair of samples with KING-robust kinship greater\n"
@@ -1127,7 +1178,13 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "        [{genotypic | hethom | dominant | recessive}] ['interaction']\n"
 "        ['hide-covar'] ['skip-invalid-pheno'] ['allow-no-covars']\n"
 "        [{intercept | cc-residualize | firth-residualize}]\n"
-"        [{no-firth | firth-fallback | firth}] ['cols='<col set desc>]\n"
+"        [{no-firth | firth-fallback | firth}] ['firth-warm-start']\n"
+"        ['score-screen='<p> ['spa']]\n"
+"        ['loco-ridge[='<h2>]] ['stepwise='<p>] [{checkpoint | resume}]\n"
+"        ['set-test-bed0='<file> | 'set-test-bed1='<file>]\n"
+"        ['set-test-max-maf='<x>] ['set-test-max-vct='<ct>]\n"
+"        ['hits='<ct>] ['hits-p='<p>] ['sumstats-bin']\n"
+"        ['cols='<col set desc>]\n"
 "        ['local-covar='<file>] ['local-psam='<file>]\n"
 "        ['local-pos-cols='<key col #s> | 'local-pvar='<file>] ['local-haps']\n"
 "        ['local-omit-last' | 'local-cats[0]='<category ct>]\n"
@@ -1187,6 +1244,12 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "        regression whenever the logistic regression fails to converge.  This is\n"
 "        now the default.\n"
 "      * 'firth' requests Firth regression all the time.\n"
+"      'firth-warm-start' starts each Firth regression from the covariate-only\n"
+"      model's fit instead of from zero, which usually saves iterations.  The\n"
+"      iteration still stops at the same convergence tolerance, but from a\n"
+"      different starting point, so ORs and SEs can differ from the default in\n"
+"      the 4th or 5th significant digit.  (This has no effect with local\n"
+"      covariates or --parameters.)\n"
 "    * Firth regression can be slow.  To trade off some accuracy for speed, you\n"
 "      can use the 'firth-residualize' modifier, which implements the shortcut\n"
 "      described in Mbatchou J et al. (2020) Computationally efficient whole\n"
@@ -1195,6 +1258,78 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      regression as well.)\n"
 "      * This must be used with 'hide-covar', and disables some other --glm\n"
 "        features.\n"
+"    * For large case/control analyses, 'score-screen='<p> fits the\n"
+"      covariate-only model once per phenotype, and computes a score test for\n"
+"      each biallelic variant against it.  Only variants with score-test p-value\n"
+"      < <p> go through the full logistic/Firth regression; for the rest, the\n"
+"      reported BETA/OR and SE are only approximate one-step score estimates,\n"
+"      with the SE scaled to reproduce the score-test p-value.  These rows are\n"
+"      marked in the SCREENED? column (add 'cols=+screen'); .hits and\n"
+"      .sumstats.bin records don't carry the marker.\n"
+"      * Add 'spa' to apply a saddlepoint approximation to the score-test\n"
+"        p-value when |Z| > 2; this is much better calibrated for unbalanced\n"
+"        case/control ratios and rare variants.\n"
+"      * This must be used with 'hide-covar', and cannot be combined with\n"
+"        alternate genotype models, 'interaction', 'intercept', local\n"
+"        covariates, --parameters, or --tests.  It has no effect on\n"
+"        quantitative phenotypes.\n"
+"    * 'loco-ridge' fits a block-wise whole-genome ridge regression of each\n"
+"      (covariate-adjusted) phenotype on the diploid autosomes, and includes the\n"
+"      leave-one-chromosome-out polygenic prediction as a fixed offset in every\n"
+"      regression.  <h2> (default 0.5) centers the grid of ridge penalties;\n"
+"      the penalty is cross-validated per autosome over randomly assigned\n"
+"      sample folds (see --seed).  The offsets (on the linear predictor scale,\n"
+"      one column per left-out autosome) are written to\n"
+"      <output prefix>.<pheno name>.glm.loco .\n"
+"      * This requires decent allele frequency estimates, and cannot be combined\n"
+"        with 'cc-residualize', 'firth-residualize', 'score-screen=', or local\n"
+"        covariates.  When chrX/chrY samples differ from the autosomal sample\n"
+"        set, those chromosomes are analyzed without the offset.\n"
+"    * 'stepwise=' switches to forward stepwise conditional analysis of each\n"
+"      quantitative phenotype: the diploid autosomal biallelic variants passing\n"
+"      all filters (use e.g. --chr/--from-bp/--to-bp to define a region) are\n"
+"      loaded into memory once, and the variant with the smallest conditional\n"
+"      p-value is repeatedly added to the model as long as that p-value is below\n"
+"      the given threshold.  The selected independent signals are written, in\n"
+"      selection order and with their conditional statistics at entry, to\n"
+"      <output prefix>.<pheno name>.glm.stepwise .  Missing dosages are\n"
+"      mean-imputed.  Case/control phenotypes are skipped.\n"
+"    * 'checkpoint' maintains a small <output filename>.ckpt journal recording\n"
+"      how many variants' results have been flushed to each output file.  After\n"
+"      an interrupted run, rerun the same command with 'resume' instead:\n"
+"      completed output files are left alone, and partial ones are truncated to\n"
+"      the last checkpoint and extended from there.  (Phenotypes are then\n"
+"      processed one at a time.)  This cannot be combined with 'stepwise=',\n"
+"      local covariates, or --adjust, and requires --seed with 'loco-ridge'.\n"
+"    * 'set-test-bed0='/'set-test-bed1=' switches to rare-variant set tests.\n"
+"      The file is a 0-based/1-based interval-BED file with set IDs in column\n"
+"      4; for each set, the diploid autosomal biallelic variants it contains\n"
+"      with minor allele frequency <= 'set-test-max-maf=' (default 0.01) are\n"
+"      jointly tested with burden, SKAT, and SKAT-O score tests, using\n"
+"      Beta(1,25) weights and a covariate-only null model.  Hardcalls are used,\n"
+"      with missing calls mean-imputed.  Results are written to\n"
+"      <output prefix>.<pheno name>.glm.sets .  SKAT p-values use a kurtosis-\n"
+"      matched chi-square approximation, so they're less accurate than\n"
+"      Davies's method far out in the tail.  Sets with more than\n"
+"      'set-test-max-vct=' (default 2000) qualifying variants are skipped, with\n"
+"      a warning and NA statistics, since each thread needs 24 * <ct>^2 bytes\n"
+"      of workspace for the largest set.\n"
+"    * 'hits='/'hits-p=' additionally write the <ct> strongest associations\n"
+"      and/or all associations with p-value <= the given threshold, sorted by\n"
+"      p-value, to <output filename>.hits (before any .zst suffix).  The full\n"
+"      output isn't reread, and memory usage is bounded: with 'hits-p=' alone,\n"
+"      at most 1000000 hits are retained (with a warning if more pass the\n"
+"      threshold); add 'hits=' to change this limit.\n"
+"    * 'sumstats-bin' writes a compact binary record for each primary test to\n"
+"      <output filename>.sumstats.bin (before any .zst suffix): a 16-byte\n"
+"      header ('PLKGLMSS', format version, record size), then one 32-byte\n"
+"      native-byte-order record per test (variant index, position, chromosome\n"
+"      code, A1 allele index, OBS_CT, float BETA, float SE, float -log10(P),\n"
+"      flags).  NA tests and covariate rows are omitted and --pfilter is not\n"
+"      applied, so records don't correspond 1:1 to main output lines.  Without\n"
+"      'zs', the file can be memory-mapped directly.\n"
+"      These three modifiers can't be combined with 'stepwise=',\n"
+"      'set-test-bed{0,1}=', or 'checkpoint'/'resume'.\n"
 "    * To add covariates which are not constant across all variants, add the\n"
 "      'local-covar=' and 'local-psam=' modifiers, use full filenames for each,\n"
 "      and use either 'local-pvar=' or 'local-pos-cols=' to provide variant ID\n"
@@ -1245,6 +1380,8 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "      a1freqcc: A1 frequency in cases, then controls (case/control only).\n"
 "      machr2: Unphased MaCH imputation quality (frequently labeled 'INFO').\n"
 "      firth: Reports whether Firth regression was used (firth-fallback only).\n"
+"      screen: Reports whether only the one-step score-screen estimate is\n"
+"              reported (score-screen= only).\n"
 "      test: Test identifier.  (Required unless only one test is run.)\n"
 "      nobs: Number of samples in the regression.\n"
 "      beta: Regression coefficient (for A1 if additive test).\n"
@@ -1394,7 +1531,9 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
                );
     HelpPrint("validate\0", &help_ctrl, 1,
 "  --validate\n"
-"    Validates all variant records in a .pgen file.\n\n"
+"    Validates all variant records in a .pgen file.  If a .pgen.cksum file\n"
+"    (see --make-pgen 'cksum') is present, the block checksums are verified\n"
+"    first, with multiple threads.\n\n"
                );
     HelpPrint("zst-decompress\0zd\0", &help_ctrl, 1,
 "  --zst-decompress <.zst file> [output filename]\n"
@@ -2181,6 +2320,19 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
 "                                   sample pairs with kinship >= that threshold\n"
 "                                   (in the input .kin0) are processed.\n"
                );
+    HelpPrint("make-king-table\0king-cutoff\0king-table-filter\0king-screen\0", &help_ctrl, 0,
+"  --king-screen ['max-carriers='<n>] ['min-shared='<n>] :\n"
+"    Two-stage --make-king-table/--king-cutoff.  Candidate pairs are first found\n"
+"    by counting shared minor-allele carriers at autosomal variants with\n"
+"    2..max-carriers (default 20) carriers; a pair is kept if it shares at least\n"
+"    min-shared (default 2) of them, and at least <k> times the smaller of the\n"
+"    two samples' rare-carrier totals.  Exact KING-robust estimates are then\n"
+"    only computed for the candidates.\n"
+"    * With --make-king-table, --king-table-filter is required; <k> is the\n"
+"      lower of that and the --king-cutoff threshold.\n"
+"    * This depends on rare variants (e.g. sequencing data), and can miss\n"
+"      relationships involving samples which carry few of them.\n"
+               );
     HelpPrint("glm\0linear\0logistic\0condition\0condition-list\0parameters\0tests\0", &help_ctrl, 0,
 "  --condition <variant ID> [{dominant | recessive}] ['multiallelic']\n"
 "  --condition-list <fname> [{dominant | recessive}] ['multiallelic'] :\n"
@@ -2316,6 +2468,38 @@ PglErr DispHelp(const char* const* argvk, uint32_t param_ct) {
     HelpPrint("threads\0num_threads\0thread-num\0seed\0", &help_ctrl, 0,
 "  --threads <val>    : Set maximum number of compute threads.\n"
                );
+    HelpPrint("pgen-prefetch\0threads\0memory\0glm\0linear\0logistic\0", &help_ctrl, 0,
+"  --pgen-prefetch [n] : Read .pgen variant blocks ahead of the compute threads\n"
+"                        in a separate I/O thread, keeping up to n (default 4,\n"
+"                        minimum 3) blocks in flight.  Currently used by --glm.\n"
+"                        Extra blocks are taken from leftover workspace memory.\n"
+               );
+    HelpPrint("pgen-mmap\0pgen-prefetch\0memory\0", &help_ctrl, 0,
+"  --pgen-mmap        : Memory-map the main .pgen/.bed file, and have the\n"
+"                       compute threads decode straight from it instead of\n"
+"                       from workspace read buffers.  This reduces memory\n"
+"                       usage, and lets concurrent jobs on the same file share\n"
+"                       the OS page cache.  Supersedes --pgen-prefetch.  Not\n"
+"                       available on Windows or 32-bit builds.\n"
+               );
+    HelpPrint("pgen-verify\0validate\0make-pgen\0", &help_ctrl, 0,
+"  --pgen-verify      : Before anything else, check the main .pgen against its\n"
+"                       .pgen.cksum file (erroring out if it's missing), using\n"
+"                       up to --threads reader threads.\n"
+               );
+    HelpPrint("pvar-cache\0pvar\0pfile\0bfile\0", &help_ctrl, 0,
+"  --pvar-cache ['full-hash'] :\n"
+"    Write a binary <.pvar/.bim filename>.pcache next to the main variant file,\n"
+"    so that later runs can skip parsing its variant lines.  An existing .pcache\n"
+"    is used automatically whenever it still matches the file.  Only written\n"
+"    when the load excludes nothing (e.g. no --chr or --snps-only).\n"
+"    By default, 'matches' means the same size, modification time, and first\n"
+"    and last 64 KiB.  This is a weak check: a same-size edit in the middle of\n"
+"    the file, with the modification time restored, goes undetected.  With\n"
+"    'full-hash', a CRC-32 of the entire file is stored as well, and every\n"
+"    later run using the .pcache rereads the file to verify it (this is still\n"
+"    much faster than parsing it).\n"
+               );
     HelpPrint("d\0covar-name\0exclude-snps\0pheno-name\0snps", &help_ctrl, 0,
 "  --d <char>         : Change variant/covariate range delimiter (normally '-').\n"
               );
@@ -786,6 +786,30 @@ void ColMajorVectorMatrixMultiplyStrided(const double* in_dvec1, const double* i
 #endif  // !NOLAPACK
 }
 
+void ColMajorMatrixTransposeMultiplyStrided(const double* inmatrix1, const double* inmatrix2, __CLPK_integer row1_ct, __CLPK_integer stride1, __CLPK_integer col2_ct, __CLPK_integer stride2, __CLPK_integer common_ct, __CLPK_integer stride3, double* outmatrix) {
+#ifdef NOLAPACK
+  const uintptr_t row1_ct_l = row1_ct;
+  const uintptr_t col2_ct_l = col2_ct;
+  for (uintptr_t col_idx = 0; col_idx != col2_ct_l; ++col_idx) {
+    const double* col2 = &(inmatrix2[col_idx * stride2]);
+    double* outmatrix_col_iter = &(outmatrix[col_idx * stride3]);
+    for (uintptr_t row_idx = 0; row_idx != row1_ct_l; ++row_idx) {
+      *outmatrix_col_iter++ = DotprodD(&(inmatrix1[row_idx * stride1]), col2, common_ct);
+    }
+  }
+#else
+#  ifndef USE_CBLAS_XGEMM
+  char transa = 'T';
+  char transb = 'N';
+  double alpha = 1;
+  double beta = 0;
+  dgemm_(&transa, &transb, &row1_ct, &col2_ct, &common_ct, &alpha, K_CAST(double*, inmatrix1), &stride1, K_CAST(double*, inmatrix2), &stride2, &beta, outmatrix, &stride3);
+#  else
+  cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, row1_ct, col2_ct, common_ct, 1.0, inmatrix1, stride1, inmatrix2, stride2, 0.0, outmatrix, stride3);
+#  endif  // USE_CBLAS_XGEMM
+#endif  // !NOLAPACK
+}
+
 // er, should make this _addassign for consistency...
 void ColMajorFmatrixMultiplyStrided(const float* inmatrix1, const float* inmatrix2, __CLPK_integer row1_ct, __CLPK_integer stride1, __CLPK_integer col2_ct, __CLPK_integer stride2, __CLPK_integer common_ct, __CLPK_integer stride3, float* outmatrix) {
 #ifdef NOLAPACK
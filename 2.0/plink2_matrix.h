@@ -395,6 +395,11 @@ HEADER_INLINE void RowMajorMatrixMultiplyStridedIncr(const double* inmatrix1, co
 // out := M^T * V
 void ColMajorVectorMatrixMultiplyStrided(const double* in_dvec1, const double* inmatrix2, __CLPK_integer common_ct, __CLPK_integer stride2, __CLPK_integer col2_ct, double* out_dvec);
 
+// out := M1^T * M2, where M1 is common_ct x row1_ct and M2 is common_ct x
+// col2_ct.  With M1 = predictors and M2 = a block of genotype columns, this
+// evaluates all predictor x genotype dot products with a single dgemm call.
+void ColMajorMatrixTransposeMultiplyStrided(const double* inmatrix1, const double* inmatrix2, __CLPK_integer row1_ct, __CLPK_integer stride1, __CLPK_integer col2_ct, __CLPK_integer stride2, __CLPK_integer common_ct, __CLPK_integer stride3, double* outmatrix);
+
 void ColMajorFmatrixMultiplyStrided(const float* inmatrix1, const float* inmatrix2, __CLPK_integer row1_ct, __CLPK_integer stride1, __CLPK_integer col2_ct, __CLPK_integer stride2, __CLPK_integer common_ct, __CLPK_integer stride3, float* outmatrix);
 
 HEADER_INLINE void RowMajorFmatrixMultiply(const float* inmatrix1, const float* inmatrix2, __CLPK_integer row1_ct, __CLPK_integer col2_ct, __CLPK_integer common_ct, float* outmatrix) {
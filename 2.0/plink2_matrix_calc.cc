@@ -919,83 +919,215 @@ THREAD_FUNC_DECL CalcKingSparseThread(void* raw_arg) {
 #ifdef USE_SSE42
 CONSTI32(kKingMultiplex, 1024);
 CONSTI32(kKingMultiplexWords, kKingMultiplex / kBitsPerWord);
-void IncrKing(const uintptr_t* smaj_hom, const uintptr_t* smaj_ref2het, uint32_t start_idx, uint32_t end_idx, uint32_t* king_counts_iter) {
-  // Tried adding another level of blocking, but couldn't get it to make a
-  // difference.
-  for (uint32_t second_idx = start_idx; second_idx != end_idx; ++second_idx) {
-    // technically overflows for huge sample_ct
-    const uint32_t second_offset = second_idx * kKingMultiplexWords;
-    const uintptr_t* second_hom = &(smaj_hom[second_offset]);
-    const uintptr_t* second_ref2het = &(smaj_ref2het[second_offset]);
-    const uintptr_t* first_hom_iter = smaj_hom;
-    const uintptr_t* first_ref2het_iter = smaj_ref2het;
-    while (first_hom_iter < second_hom) {
-      uint32_t acc_ibs0 = 0;
-      uint32_t acc_hethet = 0;
-      uint32_t acc_het2hom1 = 0;
-      uint32_t acc_het1hom2 = 0;
-      for (uint32_t widx = 0; widx != kKingMultiplexWords; ++widx) {
-        const uintptr_t hom1 = first_hom_iter[widx];
-        const uintptr_t hom2 = second_hom[widx];
-        const uintptr_t ref2het1 = first_ref2het_iter[widx];
-        const uintptr_t ref2het2 = second_ref2het[widx];
-        const uintptr_t homhom = hom1 & hom2;
-        const uintptr_t het1 = ref2het1 & (~hom1);
-        const uintptr_t het2 = ref2het2 & (~hom2);
-        acc_ibs0 += PopcountWord((ref2het1 ^ ref2het2) & homhom);
-        acc_hethet += PopcountWord(het1 & het2);
-        acc_het2hom1 += PopcountWord(hom1 & het2);
-        acc_het1hom2 += PopcountWord(hom2 & het1);
-      }
-      king_counts_iter[kKingOffsetIbs0] += acc_ibs0;
-      king_counts_iter[kKingOffsetHethet] += acc_hethet;
-      king_counts_iter[kKingOffsetHet2Hom1] += acc_het2hom1;
-      king_counts_iter[kKingOffsetHet1Hom2] += acc_het1hom2;
-      king_counts_iter = &(king_counts_iter[4]);
 
-      first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
-      first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
+// IncrKing() and IncrKingHomhom() sweep a kKingFirstTile-row tile of both bit
+// planes (64 KiB) against every second row in the thread's range before moving
+// on to the next tile, so the tile is reread from L2 instead of main memory.
+// Without this, the entire lower part of smaj_hom/smaj_ref2het was streamed
+// once per second row, which dominates at biobank sample counts.
+CONSTI32(kKingFirstTile, 256);
+
+// Each KingRow...() function processes one second row against
+// [first_hom_iter, first_hom_stop).
+void KingRow(const uintptr_t* first_hom_iter, const uintptr_t* first_ref2het_iter, const uintptr_t* first_hom_stop, const uintptr_t* second_hom, const uintptr_t* second_ref2het, uint32_t* king_counts_iter) {
+  while (first_hom_iter < first_hom_stop) {
+    uint32_t acc_ibs0 = 0;
+    uint32_t acc_hethet = 0;
+    uint32_t acc_het2hom1 = 0;
+    uint32_t acc_het1hom2 = 0;
+    for (uint32_t widx = 0; widx != kKingMultiplexWords; ++widx) {
+      const uintptr_t hom1 = first_hom_iter[widx];
+      const uintptr_t hom2 = second_hom[widx];
+      const uintptr_t ref2het1 = first_ref2het_iter[widx];
+      const uintptr_t ref2het2 = second_ref2het[widx];
+      const uintptr_t homhom = hom1 & hom2;
+      const uintptr_t het1 = ref2het1 & (~hom1);
+      const uintptr_t het2 = ref2het2 & (~hom2);
+      acc_ibs0 += PopcountWord((ref2het1 ^ ref2het2) & homhom);
+      acc_hethet += PopcountWord(het1 & het2);
+      acc_het2hom1 += PopcountWord(hom1 & het2);
+      acc_het1hom2 += PopcountWord(hom2 & het1);
     }
+    king_counts_iter[kKingOffsetIbs0] += acc_ibs0;
+    king_counts_iter[kKingOffsetHethet] += acc_hethet;
+    king_counts_iter[kKingOffsetHet2Hom1] += acc_het2hom1;
+    king_counts_iter[kKingOffsetHet1Hom2] += acc_het1hom2;
+    king_counts_iter = &(king_counts_iter[4]);
+
+    first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
+    first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
   }
 }
 
-void IncrKingHomhom(const uintptr_t* smaj_hom, const uintptr_t* smaj_ref2het, uint32_t start_idx, uint32_t end_idx, uint32_t* king_counts_iter) {
-  for (uint32_t second_idx = start_idx; second_idx != end_idx; ++second_idx) {
-    // technically overflows for huge sample_ct
-    const uint32_t second_offset = second_idx * kKingMultiplexWords;
-    const uintptr_t* second_hom = &(smaj_hom[second_offset]);
-    const uintptr_t* second_ref2het = &(smaj_ref2het[second_offset]);
-    const uintptr_t* first_hom_iter = smaj_hom;
-    const uintptr_t* first_ref2het_iter = smaj_ref2het;
-    while (first_hom_iter < second_hom) {
-      uint32_t acc_homhom = 0;
-      uint32_t acc_ibs0 = 0;
-      uint32_t acc_hethet = 0;
-      uint32_t acc_het2hom1 = 0;
-      uint32_t acc_het1hom2 = 0;
-      for (uint32_t widx = 0; widx != kKingMultiplexWords; ++widx) {
-        const uintptr_t hom1 = first_hom_iter[widx];
-        const uintptr_t hom2 = second_hom[widx];
-        const uintptr_t ref2het1 = first_ref2het_iter[widx];
-        const uintptr_t ref2het2 = second_ref2het[widx];
-        const uintptr_t homhom = hom1 & hom2;
-        const uintptr_t het1 = ref2het1 & (~hom1);
-        const uintptr_t het2 = ref2het2 & (~hom2);
-        acc_homhom += PopcountWord(homhom);
-        acc_ibs0 += PopcountWord((ref2het1 ^ ref2het2) & homhom);
-        acc_hethet += PopcountWord(het1 & het2);
-        acc_het2hom1 += PopcountWord(hom1 & het2);
-        acc_het1hom2 += PopcountWord(hom2 & het1);
-      }
-      king_counts_iter[kKingOffsetIbs0] += acc_ibs0;
-      king_counts_iter[kKingOffsetHethet] += acc_hethet;
-      king_counts_iter[kKingOffsetHet2Hom1] += acc_het2hom1;
-      king_counts_iter[kKingOffsetHet1Hom2] += acc_het1hom2;
-      king_counts_iter[kKingOffsetHomhom] += acc_homhom;
-      king_counts_iter = &(king_counts_iter[5]);
+void KingRowHomhom(const uintptr_t* first_hom_iter, const uintptr_t* first_ref2het_iter, const uintptr_t* first_hom_stop, const uintptr_t* second_hom, const uintptr_t* second_ref2het, uint32_t* king_counts_iter) {
+  while (first_hom_iter < first_hom_stop) {
+    uint32_t acc_homhom = 0;
+    uint32_t acc_ibs0 = 0;
+    uint32_t acc_hethet = 0;
+    uint32_t acc_het2hom1 = 0;
+    uint32_t acc_het1hom2 = 0;
+    for (uint32_t widx = 0; widx != kKingMultiplexWords; ++widx) {
+      const uintptr_t hom1 = first_hom_iter[widx];
+      const uintptr_t hom2 = second_hom[widx];
+      const uintptr_t ref2het1 = first_ref2het_iter[widx];
+      const uintptr_t ref2het2 = second_ref2het[widx];
+      const uintptr_t homhom = hom1 & hom2;
+      const uintptr_t het1 = ref2het1 & (~hom1);
+      const uintptr_t het2 = ref2het2 & (~hom2);
+      acc_homhom += PopcountWord(homhom);
+      acc_ibs0 += PopcountWord((ref2het1 ^ ref2het2) & homhom);
+      acc_hethet += PopcountWord(het1 & het2);
+      acc_het2hom1 += PopcountWord(hom1 & het2);
+      acc_het1hom2 += PopcountWord(hom2 & het1);
+    }
+    king_counts_iter[kKingOffsetIbs0] += acc_ibs0;
+    king_counts_iter[kKingOffsetHethet] += acc_hethet;
+    king_counts_iter[kKingOffsetHet2Hom1] += acc_het2hom1;
+    king_counts_iter[kKingOffsetHet1Hom2] += acc_het1hom2;
+    king_counts_iter[kKingOffsetHomhom] += acc_homhom;
+    king_counts_iter = &(king_counts_iter[5]);
+
+    first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
+    first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
+  }
+}
+
+#  if defined(USE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+// AVX-512 VPOPCNTDQ versions.  The rest of the program is only built for
+// AVX2, so these are compiled with a function-level target attribute and
+// selected at runtime when the CPU (and OS) support them.
+#    define KING_VPOPCNT_TARGET __attribute__((target("avx512f,avx512vpopcntdq")))
+
+// Each per-pair count is bounded by kKingMultiplex, so the four basic counts
+// share one 64-bit lane as 16-bit fields, and only one horizontal reduction is
+// needed per pair.
+static_assert(kKingMultiplex < 65536, "KingRowVpopcnt() requires kKingMultiplex < 2^16.");
+static_assert(!(kKingMultiplexWords % 8), "KingRowVpopcnt() requires kKingMultiplexWords to be divisible by 8.");
+
+// (GCC 12's _mm512_reduce_add_epi64() and other undefined-passthrough
+// intrinsics trigger spurious -Wmaybe-uninitialized warnings, so vector
+// extension operators are used here instead.)
+KING_VPOPCNT_TARGET static inline uint64_t KingHsum(__m512i vv) {
+  return vv[0] + vv[1] + vv[2] + vv[3] + vv[4] + vv[5] + vv[6] + vv[7];
+}
+
+KING_VPOPCNT_TARGET static inline void KingFlushPacked(__m512i acc_ibs0, __m512i acc_hethet, __m512i acc_het2hom1, __m512i acc_het1hom2, uint32_t* king_counts_iter) {
+  const __m512i packed = acc_ibs0 + (acc_hethet << 16) + (acc_het2hom1 << 32) + (acc_het1hom2 << 48);
+  const uint64_t packed_sum = KingHsum(packed);
+  king_counts_iter[kKingOffsetIbs0] += packed_sum & 0xffff;
+  king_counts_iter[kKingOffsetHethet] += (packed_sum >> 16) & 0xffff;
+  king_counts_iter[kKingOffsetHet2Hom1] += (packed_sum >> 32) & 0xffff;
+  king_counts_iter[kKingOffsetHet1Hom2] += packed_sum >> 48;
+}
+
+KING_VPOPCNT_TARGET void KingRowVpopcnt(const uintptr_t* first_hom_iter, const uintptr_t* first_ref2het_iter, const uintptr_t* first_hom_stop, const uintptr_t* second_hom, const uintptr_t* second_ref2het, uint32_t* king_counts_iter) {
+  while (first_hom_iter < first_hom_stop) {
+    __m512i acc_ibs0 = _mm512_setzero_si512();
+    __m512i acc_hethet = _mm512_setzero_si512();
+    __m512i acc_het2hom1 = _mm512_setzero_si512();
+    __m512i acc_het1hom2 = _mm512_setzero_si512();
+    for (uint32_t widx = 0; widx != kKingMultiplexWords; widx += 8) {
+      const __m512i hom1 = _mm512_loadu_si512(&(first_hom_iter[widx]));
+      const __m512i hom2 = _mm512_loadu_si512(&(second_hom[widx]));
+      const __m512i ref2het1 = _mm512_loadu_si512(&(first_ref2het_iter[widx]));
+      const __m512i ref2het2 = _mm512_loadu_si512(&(second_ref2het[widx]));
+      const __m512i homhom = hom1 & hom2;
+      const __m512i het1 = (~hom1) & ref2het1;
+      const __m512i het2 = (~hom2) & ref2het2;
+      acc_ibs0 += _mm512_popcnt_epi64((ref2het1 ^ ref2het2) & homhom);
+      acc_hethet += _mm512_popcnt_epi64(het1 & het2);
+      acc_het2hom1 += _mm512_popcnt_epi64(hom1 & het2);
+      acc_het1hom2 += _mm512_popcnt_epi64(hom2 & het1);
+    }
+    KingFlushPacked(acc_ibs0, acc_hethet, acc_het2hom1, acc_het1hom2, king_counts_iter);
+    king_counts_iter = &(king_counts_iter[4]);
+
+    first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
+    first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
+  }
+}
+
+KING_VPOPCNT_TARGET void KingRowHomhomVpopcnt(const uintptr_t* first_hom_iter, const uintptr_t* first_ref2het_iter, const uintptr_t* first_hom_stop, const uintptr_t* second_hom, const uintptr_t* second_ref2het, uint32_t* king_counts_iter) {
+  while (first_hom_iter < first_hom_stop) {
+    __m512i acc_homhom = _mm512_setzero_si512();
+    __m512i acc_ibs0 = _mm512_setzero_si512();
+    __m512i acc_hethet = _mm512_setzero_si512();
+    __m512i acc_het2hom1 = _mm512_setzero_si512();
+    __m512i acc_het1hom2 = _mm512_setzero_si512();
+    for (uint32_t widx = 0; widx != kKingMultiplexWords; widx += 8) {
+      const __m512i hom1 = _mm512_loadu_si512(&(first_hom_iter[widx]));
+      const __m512i hom2 = _mm512_loadu_si512(&(second_hom[widx]));
+      const __m512i ref2het1 = _mm512_loadu_si512(&(first_ref2het_iter[widx]));
+      const __m512i ref2het2 = _mm512_loadu_si512(&(second_ref2het[widx]));
+      const __m512i homhom = hom1 & hom2;
+      const __m512i het1 = (~hom1) & ref2het1;
+      const __m512i het2 = (~hom2) & ref2het2;
+      acc_homhom += _mm512_popcnt_epi64(homhom);
+      acc_ibs0 += _mm512_popcnt_epi64((ref2het1 ^ ref2het2) & homhom);
+      acc_hethet += _mm512_popcnt_epi64(het1 & het2);
+      acc_het2hom1 += _mm512_popcnt_epi64(hom1 & het2);
+      acc_het1hom2 += _mm512_popcnt_epi64(hom2 & het1);
+    }
+    KingFlushPacked(acc_ibs0, acc_hethet, acc_het2hom1, acc_het1hom2, king_counts_iter);
+    king_counts_iter[kKingOffsetHomhom] += KingHsum(acc_homhom);
+    king_counts_iter = &(king_counts_iter[5]);
+
+    first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
+    first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
+  }
+}
+
+static inline uint32_t KingVpopcntSupported() {
+  return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+}
+#  else
+static inline uint32_t KingVpopcntSupported() {
+  return 0;
+}
+#  endif
+
+// king_counts_iter points to the (start_idx, 0) entry; entries are ordered by
+// second (larger) index, then first index.
+void IncrKing(const uintptr_t* smaj_hom, const uintptr_t* smaj_ref2het, uint32_t start_idx, uint32_t end_idx, uint32_t* king_counts_iter) {
+  const uint32_t use_vpopcnt = KingVpopcntSupported();
+  const uint64_t tri_base = (S_CAST(uint64_t, start_idx) * (start_idx - 1)) / 2;
+  for (uint32_t first_tile_start = 0; first_tile_start + 1 < end_idx; first_tile_start += kKingFirstTile) {
+    const uint32_t first_tile_end = first_tile_start + kKingFirstTile;
+    const uintptr_t* first_hom_tile = &(smaj_hom[S_CAST(uintptr_t, first_tile_start) * kKingMultiplexWords]);
+    const uintptr_t* first_ref2het_tile = &(smaj_ref2het[S_CAST(uintptr_t, first_tile_start) * kKingMultiplexWords]);
+    for (uint32_t second_idx = MAXV(start_idx, first_tile_start + 1); second_idx != end_idx; ++second_idx) {
+      const uintptr_t second_offset = S_CAST(uintptr_t, second_idx) * kKingMultiplexWords;
+      const uintptr_t* first_hom_stop = &(smaj_hom[S_CAST(uintptr_t, MINV(first_tile_end, second_idx)) * kKingMultiplexWords]);
+      uint32_t* king_counts_row = &(king_counts_iter[((S_CAST(uint64_t, second_idx) * (second_idx - 1)) / 2 - tri_base + first_tile_start) * 4]);
+#  ifdef KING_VPOPCNT_TARGET
+      if (use_vpopcnt) {
+        KingRowVpopcnt(first_hom_tile, first_ref2het_tile, first_hom_stop, &(smaj_hom[second_offset]), &(smaj_ref2het[second_offset]), king_counts_row);
+        continue;
+      }
+#  endif
+      KingRow(first_hom_tile, first_ref2het_tile, first_hom_stop, &(smaj_hom[second_offset]), &(smaj_ref2het[second_offset]), king_counts_row);
+    }
+  }
+}
 
-      first_hom_iter = &(first_hom_iter[kKingMultiplexWords]);
-      first_ref2het_iter = &(first_ref2het_iter[kKingMultiplexWords]);
+void IncrKingHomhom(const uintptr_t* smaj_hom, const uintptr_t* smaj_ref2het, uint32_t start_idx, uint32_t end_idx, uint32_t* king_counts_iter) {
+  const uint32_t use_vpopcnt = KingVpopcntSupported();
+  const uint64_t tri_base = (S_CAST(uint64_t, start_idx) * (start_idx - 1)) / 2;
+  for (uint32_t first_tile_start = 0; first_tile_start + 1 < end_idx; first_tile_start += kKingFirstTile) {
+    const uint32_t first_tile_end = first_tile_start + kKingFirstTile;
+    const uintptr_t* first_hom_tile = &(smaj_hom[S_CAST(uintptr_t, first_tile_start) * kKingMultiplexWords]);
+    const uintptr_t* first_ref2het_tile = &(smaj_ref2het[S_CAST(uintptr_t, first_tile_start) * kKingMultiplexWords]);
+    for (uint32_t second_idx = MAXV(start_idx, first_tile_start + 1); second_idx != end_idx; ++second_idx) {
+      const uintptr_t second_offset = S_CAST(uintptr_t, second_idx) * kKingMultiplexWords;
+      const uintptr_t* first_hom_stop = &(smaj_hom[S_CAST(uintptr_t, MINV(first_tile_end, second_idx)) * kKingMultiplexWords]);
+      uint32_t* king_counts_row = &(king_counts_iter[((S_CAST(uint64_t, second_idx) * (second_idx - 1)) / 2 - tri_base + first_tile_start) * 5]);
+#  ifdef KING_VPOPCNT_TARGET
+      if (use_vpopcnt) {
+        KingRowHomhomVpopcnt(first_hom_tile, first_ref2het_tile, first_hom_stop, &(smaj_hom[second_offset]), &(smaj_ref2het[second_offset]), king_counts_row);
+        continue;
+      }
+#  endif
+      KingRowHomhom(first_hom_tile, first_ref2het_tile, first_hom_stop, &(smaj_hom[second_offset]), &(smaj_ref2het[second_offset]), king_counts_row);
     }
   }
 }
@@ -2625,8 +2757,27 @@ void GetRelCheckPairs(const char* nsorted_xidbox, const uint32_t* xid_map, uintp
   fpip->idx2 = idx2;
 }
 
-PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end) {
-  // subset_fname permitted to be nullptr when rel_check is true.
+void GetKingScreenPairs(const uint64_t* screen_pairs, uintptr_t screen_pair_ct, uint32_t is_first_parallel_scan, uint64_t pair_idx_start, uint64_t pair_idx_stop, uint64_t* pair_idx_ptr, uint32_t* loaded_sample_idx_pairs) {
+  // --king-screen candidate list is already in memory, with the higher
+  // sample_uidx in the high 32 bits of each key.
+  if (pair_idx_stop > screen_pair_ct) {
+    pair_idx_stop = screen_pair_ct;
+  }
+  uint32_t* loaded_sample_idx_pairs_iter = loaded_sample_idx_pairs;
+  for (uint64_t pair_idx = pair_idx_start; pair_idx < pair_idx_stop; ++pair_idx) {
+    const uint64_t cur_key = screen_pairs[pair_idx];
+    *loaded_sample_idx_pairs_iter++ = cur_key >> 32;
+    *loaded_sample_idx_pairs_iter++ = S_CAST(uint32_t, cur_key);
+  }
+  *pair_idx_ptr = is_first_parallel_scan? screen_pair_ct : pair_idx_stop;
+}
+
+PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, const uint64_t* screen_pairs, uintptr_t screen_pair_ct, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, uintptr_t* kinship_table, char* outname, char* outname_end) {
+  // subset_fname permitted to be nullptr when rel_check is true, or when
+  // screen_pairs is provided.
+  // If kinship_table is non-null, pairs with kinship > king_cutoff are marked
+  // in it (indexed by position in orig_sample_include), and the .kin0 is only
+  // written if a --make-king-table column was requested.
   unsigned char* bigstack_mark = g_bigstack_base;
   FILE* outfile = nullptr;
   char* cswritep = nullptr;
@@ -2670,6 +2821,8 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
     uint32_t sample_ctaw = BitCtToAlignedWordCt(orig_sample_ct);
     uint32_t sample_ctaw2 = NypCtToAlignedWordCt(orig_sample_ct);
     uint32_t king_bufsizew = kKingMultiplexWords * orig_sample_ct;
+    const uintptr_t orig_sample_ctl = BitCtToWordCt(orig_sample_ct);
+    const uint32_t write_table = (king_flags & kfKingColAll)? 1 : 0;
     uintptr_t* cur_sample_include;
     uint32_t* sample_include_cumulative_popcounts;
     uintptr_t* loadbuf;
@@ -2690,6 +2843,15 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
                  bigstack_alloc_v(kPglBitTransposeBufvecs, &vecaligned_buf))) {
       goto CalcKingTableSubset_ret_NOMEM;
     }
+    uint32_t* orig_sample_include_cumulative_popcounts = nullptr;
+    uint32_t* cur_sample_orig_idxs = nullptr;
+    if (kinship_table) {
+      if (unlikely(bigstack_alloc_u32(raw_sample_ctl, &orig_sample_include_cumulative_popcounts) ||
+                   bigstack_alloc_u32(orig_sample_ct, &cur_sample_orig_idxs))) {
+        goto CalcKingTableSubset_ret_NOMEM;
+      }
+      FillCumulativePopcounts(orig_sample_include, raw_sample_ctl, orig_sample_include_cumulative_popcounts);
+    }
     SetKingTableFname(king_flags, parallel_idx, parallel_tot, outname_end);
     if (subset_fname) {
       uint32_t fname_slen;
@@ -2717,13 +2879,15 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
     }
 
     // Safe to "write" the header line now, if necessary.
-    reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingTableZs, max_thread_ct, kMaxMediumLine + kCompressStreamBlock, &css, &cswritep);
-    if (unlikely(reterr)) {
-      goto CalcKingTableSubset_ret_1;
+    if (write_table) {
+      reterr = InitCstreamAlloc(outname, 0, king_flags & kfKingTableZs, max_thread_ct, kMaxMediumLine + kCompressStreamBlock, &css, &cswritep);
+      if (unlikely(reterr)) {
+        goto CalcKingTableSubset_ret_1;
+      }
     }
     const uint32_t king_col_fid = FidColIsRequired(siip, king_flags / kfKingColMaybefid);
     const uint32_t king_col_sid = SidColIsRequired(siip->sids, king_flags / kfKingColMaybesid);
-    if (!parallel_idx) {
+    if (write_table && (!parallel_idx)) {
       cswritep = AppendKingTableHeader(king_flags, king_col_fid, king_col_sid, cswritep);
     }
     const uintptr_t max_sample_fmtid_blen = GetMaxSampleFmtidBlen(siip, king_col_fid, king_col_sid);
@@ -2838,17 +3002,19 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       }
     }
 
-    uint32_t* xid_map;  // IDs not collapsed
-    char* sorted_xidbox;
-    uintptr_t max_xid_blen;
-    // may as well use natural-sort order in rel-check-only case
-    reterr = SortedXidboxInitAlloc(orig_sample_include, siip, orig_sample_ct, 0, xid_mode, (!subset_fname), &sorted_xidbox, &xid_map, &max_xid_blen);
-    if (unlikely(reterr)) {
-      goto CalcKingTableSubset_ret_1;
-    }
-    char* idbuf;
-    if (unlikely(bigstack_alloc_c(max_xid_blen, &idbuf))) {
-      goto CalcKingTableSubset_ret_NOMEM;
+    uint32_t* xid_map = nullptr;  // IDs not collapsed
+    char* sorted_xidbox = nullptr;
+    uintptr_t max_xid_blen = 0;
+    char* idbuf = nullptr;
+    if (!screen_pairs) {
+      // may as well use natural-sort order in rel-check-only case
+      reterr = SortedXidboxInitAlloc(orig_sample_include, siip, orig_sample_ct, 0, xid_mode, (!subset_fname), &sorted_xidbox, &xid_map, &max_xid_blen);
+      if (unlikely(reterr)) {
+        goto CalcKingTableSubset_ret_1;
+      }
+      if (unlikely(bigstack_alloc_c(max_xid_blen, &idbuf))) {
+        goto CalcKingTableSubset_ret_NOMEM;
+      }
     }
 
     ctx.homhom_needed = (king_flags & kfKingColNsnp) || ((!(king_flags & kfKingCounts)) && (king_flags & (kfKingColHethet | kfKingColIbs0 | kfKingColIbs1)));
@@ -2872,7 +3038,9 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
     InitFidPairIterator(&fpi);
 
     uint64_t pair_idx = 0;
-    if (!subset_fname) {
+    if (screen_pairs) {
+      GetKingScreenPairs(screen_pairs, screen_pair_ct, (parallel_tot != 1), 0, pair_buf_capacity, &pair_idx, ctx.loaded_sample_idx_pairs);
+    } else if (!subset_fname) {
       GetRelCheckPairs(sorted_xidbox, xid_map, max_xid_blen, orig_sample_ct, (parallel_tot != 1), 0, pair_buf_capacity, &fpi, &pair_idx, ctx.loaded_sample_idx_pairs, idbuf);
     } else {
       fputs("Scanning --king-table-subset file...", stdout);
@@ -2891,7 +3059,9 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       if (pair_idx > pair_buf_capacity) {
         // may as well document possible overflow
         if (unlikely(parallel_pair_ct > ((~0LLU) / kParallelMax))) {
-          if (!subset_fname) {
+          if (screen_pairs) {
+            logerrputs("Error: Too many --king-screen candidate pairs for this " PROG_NAME_STR " build.\n");
+          } else if (!subset_fname) {
             // This is easy to support if there's ever a need, of course.
             logerrputs("Error: Too many \"--make-king-table rel-check\" sample pairs for this " PROG_NAME_STR "\nbuild.\n");
           } else {
@@ -2903,7 +3073,9 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
         if (pair_idx_global_stop > pair_buf_capacity) {
           // large --parallel job
           pair_idx = 0;
-          if (!subset_fname) {
+          if (screen_pairs) {
+            GetKingScreenPairs(screen_pairs, screen_pair_ct, 0, pair_idx_global_start, MINV(pair_idx_global_stop, pair_idx_global_start + pair_buf_capacity), &pair_idx, ctx.loaded_sample_idx_pairs);
+          } else if (!subset_fname) {
             InitFidPairIterator(&fpi);
             GetRelCheckPairs(sorted_xidbox, xid_map, max_xid_blen, orig_sample_ct, 0, pair_idx_global_start, MINV(pair_idx_global_stop, pair_idx_global_start + pair_buf_capacity), &fpi, &pair_idx, ctx.loaded_sample_idx_pairs, idbuf);
           } else {
@@ -2950,6 +3122,14 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       const uint32_t cur_sample_ct = sample_include_cumulative_popcounts[raw_sample_ctl - 1] + PopcountWord(cur_sample_include[raw_sample_ctl - 1]);
       const uint32_t cur_sample_ctaw = BitCtToAlignedWordCt(cur_sample_ct);
       const uint32_t cur_sample_ctaw2 = NypCtToAlignedWordCt(cur_sample_ct);
+      if (kinship_table) {
+        uintptr_t sample_uidx_base = 0;
+        uintptr_t sample_include_bits = cur_sample_include[0];
+        for (uint32_t sample_idx = 0; sample_idx != cur_sample_ct; ++sample_idx) {
+          const uintptr_t sample_uidx = BitIter1(cur_sample_include, &sample_uidx_base, &sample_include_bits);
+          cur_sample_orig_idxs[sample_idx] = RawToSubsettedPos(orig_sample_include, orig_sample_include_cumulative_popcounts, sample_uidx);
+        }
+      }
       if (cur_sample_ct != raw_sample_ct) {
         for (uintptr_t ulii = 0; ulii != cur_pair_ct_x2; ++ulii) {
           ctx.loaded_sample_idx_pairs[ulii] = RawToSubsettedPos(cur_sample_include, sample_include_cumulative_popcounts, ctx.loaded_sample_idx_pairs[ulii]);
@@ -3084,12 +3264,21 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
         const uint32_t het1hom2_ct = results_iter[kKingOffsetHet1Hom2];
         const intptr_t smaller_het_ct = hethet_ct + MINV(het1hom2_ct, het2hom1_ct);
         const double kinship_coeff = 0.5 - (S_CAST(double, 4 * S_CAST(intptr_t, ibs0_ct) + het1hom2_ct + het2hom1_ct) / S_CAST(double, 4 * smaller_het_ct));
+        const uint32_t sample_idx1 = ctx.loaded_sample_idx_pairs[2 * cur_pair_idx];
+        const uint32_t sample_idx2 = ctx.loaded_sample_idx_pairs[2 * cur_pair_idx + 1];
+        if (kinship_table && (kinship_coeff > king_cutoff)) {
+          const uintptr_t orig_sample_idx1 = cur_sample_orig_idxs[sample_idx1];
+          const uintptr_t orig_sample_idx2 = cur_sample_orig_idxs[sample_idx2];
+          SetBit(orig_sample_idx2, &(kinship_table[orig_sample_idx1 * orig_sample_ctl]));
+          SetBit(orig_sample_idx1, &(kinship_table[orig_sample_idx2 * orig_sample_ctl]));
+        }
         if ((king_table_filter != -DBL_MAX) && (kinship_coeff < king_table_filter)) {
           ++king_table_filter_ct;
           continue;
         }
-        const uint32_t sample_idx1 = ctx.loaded_sample_idx_pairs[2 * cur_pair_idx];
-        const uint32_t sample_idx2 = ctx.loaded_sample_idx_pairs[2 * cur_pair_idx + 1];
+        if (!write_table) {
+          continue;
+        }
         if (king_col_id) {
           cswritep = strcpyax(cswritep, &(collapsed_sample_fmtids[max_sample_fmtid_blen * sample_idx1]), '\t');
           cswritep = strcpyax(cswritep, &(collapsed_sample_fmtids[max_sample_fmtid_blen * sample_idx2]), '\t');
@@ -3144,11 +3333,13 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       putc_unlocked('\r', stdout);
       const uint64_t pair_complete_ct = pair_idx - pair_idx_global_start;
       logprintf("Subsetted --make-king-table: %" PRIu64 " pair%s complete.\n", pair_complete_ct, (pair_complete_ct == 1)? "" : "s");
-      if (TextEof(&txs) || (pair_idx == pair_idx_global_stop)) {
+      if ((screen_pairs? (pair_idx == screen_pair_ct) : TextEof(&txs)) || (pair_idx == pair_idx_global_stop)) {
         break;
       }
       pair_idx_cur_start = pair_idx;
-      if (!subset_fname) {
+      if (screen_pairs) {
+        GetKingScreenPairs(screen_pairs, screen_pair_ct, 0, pair_idx_cur_start, MINV(pair_idx_global_stop, pair_idx_cur_start + pair_buf_capacity), &pair_idx, ctx.loaded_sample_idx_pairs);
+      } else if (!subset_fname) {
         GetRelCheckPairs(sorted_xidbox, xid_map, max_xid_blen, orig_sample_ct, 0, pair_idx_global_start, MINV(pair_idx_global_stop, pair_idx_global_start + pair_buf_capacity), &fpi, &pair_idx, ctx.loaded_sample_idx_pairs, idbuf);
       } else {
         fputs("Scanning --king-table-subset file...", stdout);
@@ -3160,13 +3351,15 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
       }
       ++pass_idx;
     }
-    if (unlikely(CswriteCloseNull(&css, cswritep))) {
-      goto CalcKingTableSubset_ret_WRITE_FAIL;
-    }
-    logprintfww("Results written to %s .\n", outname);
-    if (king_table_filter != -DBL_MAX) {
-      const uint64_t reported_ct = pair_idx - pair_idx_global_start - king_table_filter_ct;
-      logprintf("--king-table-filter: %" PRIu64 " relationship%s reported (%" PRIu64 " filtered out).\n", reported_ct, (reported_ct == 1)? "" : "s", king_table_filter_ct);
+    if (write_table) {
+      if (unlikely(CswriteCloseNull(&css, cswritep))) {
+        goto CalcKingTableSubset_ret_WRITE_FAIL;
+      }
+      logprintfww("Results written to %s .\n", outname);
+      if (king_table_filter != -DBL_MAX) {
+        const uint64_t reported_ct = pair_idx - pair_idx_global_start - king_table_filter_ct;
+        logprintf("--king-table-filter: %" PRIu64 " relationship%s reported (%" PRIu64 " filtered out).\n", reported_ct, (reported_ct == 1)? "" : "s", king_table_filter_ct);
+      }
     }
   }
   while (0) {
@@ -3209,137 +3402,396 @@ PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdI
   return reterr;
 }
 
-// assumes trailing bits of genovec are zeroed out
-PglErr ExpandCenteredVarmaj(const uintptr_t* genovec, const uintptr_t* dosage_present, const Dosage* dosage_main, uint32_t variance_standardize, uint32_t is_haploid, uint32_t sample_ct, uint32_t dosage_ct, double ref_freq, double* normed_dosages) {
-  const double alt_freq = 1.0 - ref_freq;
-  double inv_stdev;
-  if (variance_standardize) {
-    const double variance = 2 * ref_freq * alt_freq;
-    if (!(variance > kSmallEpsilon)) {
-      // See LoadMultiallelicCenteredVarmaj().  This check was tightened up in
-      // alpha 3 to reject all-het and monomorphic-wrong-allele variants.
-      STD_ARRAY_DECL(uint32_t, 4, genocounts);
-      GenoarrCountFreqsUnsafe(genovec, sample_ct, genocounts);
-      if (unlikely(dosage_ct || genocounts[1])) {
-        return kPglRetDegenerateData;
-      }
-      if (variance != variance) {
-        if (unlikely(genocounts[0] || genocounts[2])) {
-          return kPglRetDegenerateData;
-        }
-      } else {
-        if (ref_freq > 0.5) {
-          if (unlikely(genocounts[2])) {
-            return kPglRetDegenerateData;
-          }
-        } else {
-          if (unlikely(genocounts[0])) {
-            return kPglRetDegenerateData;
-          }
-        }
-      }
-      ZeroDArr(sample_ct, normed_dosages);
-      return kPglRetSuccess;
-    }
-    inv_stdev = 1.0 / sqrt(variance);
-    if (is_haploid) {
-      // For our purposes, variance is doubled in haploid case.
-      inv_stdev *= (1.0 / kSqrt2);
+// Writes the sample_uidxs of minor-allele carriers in genovec, in increasing
+// order.  Trailing entries must be missing.
+void KingScreenFillCarriers(const uintptr_t* genovec, const uint32_t* sample_uidxs, uint32_t sample_ct, uint32_t ref_minor, uint32_t* carrier_uidxs_iter) {
+  const uint32_t word_ct = NypCtToWordCt(sample_ct);
+  for (uint32_t widx = 0; widx != word_ct; ++widx) {
+    const uintptr_t geno_word = genovec[widx];
+    // alt carriers are 0b01 and 0b10; ref carriers are 0b00 and 0b01
+    uintptr_t carrier_bits = ref_minor? ((~geno_word) >> 1) : (geno_word ^ (geno_word >> 1));
+    carrier_bits &= kMask5555;
+    if (carrier_bits) {
+      const uint32_t* cur_sample_uidxs = &(sample_uidxs[widx * kBitsPerWordD2]);
+      do {
+        *carrier_uidxs_iter++ = cur_sample_uidxs[ctzw(carrier_bits) / 2];
+        carrier_bits &= carrier_bits - 1;
+      } while (carrier_bits);
     }
-    // possible todo:
-    // * Could use one inv_stdev for males and one for nonmales for chrX
-    //   --score (while still leaving that out of GRM... or just leave males
-    //   out there?).  This depends on dosage compensation model; discussed in
-    //   e.g. GCTA paper.
-  } else {
-    // Extra factor of 2 removed from haploid 'cov' formula in alpha 3.
-    inv_stdev = is_haploid? 0.5 : 1.0;
   }
-  PopulateRescaledDosage(genovec, dosage_present, dosage_main, inv_stdev, -2 * alt_freq * inv_stdev, 0.0, sample_ct, dosage_ct, normed_dosages);
-  return kPglRetSuccess;
 }
 
-// This breaks the "don't pass pssi between functions" rule since it's a thin
-// wrapper around PgrGetInv1D().
-PglErr LoadBiallelicCenteredVarmaj(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, uint32_t variance_standardize, uint32_t is_haploid, uint32_t sample_ct, uint32_t variant_uidx, double ref_freq, PgenReader* simple_pgrp, uint32_t* missing_presentp, double* normed_dosages, uintptr_t* genovec_buf, uintptr_t* dosage_present_buf, Dosage* dosage_main_buf) {
-  uint32_t dosage_ct;
-  PglErr reterr = PgrGetD(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, genovec_buf, dosage_present_buf, dosage_main_buf, &dosage_ct);
+// Loads the next screening variant, returning its minor-allele carrier count
+// (0 if it isn't usable for screening).
+PglErr KingScreenLoad(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, const uint32_t* sample_uidxs, uint32_t sample_ct, uint32_t variant_uidx, uint32_t max_carrier_ct, PgenReader* simple_pgrp, uintptr_t* genovec, uint32_t* carrier_uidxs, uint32_t* carrier_ct_ptr) {
+  PglErr reterr = PgrGet(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, genovec);
   if (unlikely(reterr)) {
-    // don't print malformed-.pgen error message here, since this is called
-    // from multithreaded loops
     return reterr;
   }
-  ZeroTrailingNyps(sample_ct, genovec_buf);
-  if (missing_presentp) {
-    // missing_present assumed to be initialized to 0
-    // this should probably be a library function...
-    const uint32_t sample_ctl2 = NypCtToWordCt(sample_ct);
-    if (!dosage_ct) {
-      for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-        const uintptr_t detect_11 = Word11(genovec_buf[widx]);
-        if (detect_11) {
-          *missing_presentp = 1;
+  STD_ARRAY_DECL(uint32_t, 4, genocounts);
+  GenoarrCountFreqsUnsafe(genovec, sample_ct, genocounts);
+  const uint32_t alt_carrier_ct = genocounts[1] + genocounts[2];
+  const uint32_t ref_carrier_ct = genocounts[0] + genocounts[1];
+  const uint32_t ref_minor = (ref_carrier_ct < alt_carrier_ct);
+  const uint32_t carrier_ct = ref_minor? ref_carrier_ct : alt_carrier_ct;
+  if ((carrier_ct < 2) || (carrier_ct > max_carrier_ct)) {
+    *carrier_ct_ptr = 0;
+    return kPglRetSuccess;
+  }
+  SetTrailingNyps(sample_ct, genovec);
+  KingScreenFillCarriers(genovec, sample_uidxs, sample_ct, ref_minor, carrier_uidxs);
+  *carrier_ct_ptr = carrier_ct;
+  return kPglRetSuccess;
+}
+
+// Candidate pairs are those sharing at least min_shared_ct rare-allele
+// carriers, and at least screen_thresh times the smaller of their two rare
+// carrier totals.  (A relative with kinship phi is expected to carry ~2*phi of
+// a sample's rare alleles, so this is half the expectation at the threshold.)
+// Pair counting is exact, just restricted to variants with 2..max_carrier_ct
+// minor-allele carriers; if there are too many carrier pairs to sort at once,
+// the variants are rescanned once per range of higher sample_uidxs.
+// On success, the sorted pair keys (higher sample_uidx in the high 32 bits)
+// are left at the bottom of the bigstack.
+PglErr KingScreenCandidates(const uintptr_t* sample_include, const uintptr_t* variant_include, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_carrier_ct, uint32_t min_shared_ct, double screen_thresh, PgenReader* simple_pgrp, uint64_t** screen_pairs_ptr, uintptr_t* screen_pair_ct_ptr) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  unsigned char* bigstack_end_mark = g_bigstack_end;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    uint32_t* sample_include_cumulative_popcounts;
+    uint32_t* sample_uidxs;
+    uintptr_t* genovec;
+    uint32_t* carrier_uidxs;
+    uint32_t* rare_cts;
+    uint64_t* hi_pair_cts;
+    uintptr_t* screen_variant_include;
+    if (unlikely(bigstack_end_alloc_u32(raw_sample_ctl, &sample_include_cumulative_popcounts) ||
+                 bigstack_end_alloc_u32(sample_ct, &sample_uidxs) ||
+                 bigstack_end_alloc_w(NypCtToAlignedWordCt(sample_ct), &genovec) ||
+                 bigstack_end_alloc_u32(max_carrier_ct, &carrier_uidxs) ||
+                 bigstack_end_calloc_u32(raw_sample_ct, &rare_cts) ||
+                 bigstack_end_calloc_u64(raw_sample_ct, &hi_pair_cts) ||
+                 bigstack_end_calloc_w(raw_variant_ctl, &screen_variant_include))) {
+      goto KingScreenCandidates_ret_NOMEM;
+    }
+    FillCumulativePopcounts(sample_include, raw_sample_ctl, sample_include_cumulative_popcounts);
+    uintptr_t sample_uidx_base = 0;
+    uintptr_t sample_include_bits = sample_include[0];
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      sample_uidxs[sample_idx] = BitIter1(sample_include, &sample_uidx_base, &sample_include_bits);
+    }
+    PgrSampleSubsetIndex pssi;
+    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+
+    // First scan: find the screening variants, and count each sample's rare
+    // alleles and the number of carrier pairs it's the higher-uidx member of.
+    fputs("--king-screen: Counting rare-allele carriers...", stdout);
+    fflush(stdout);
+    uint32_t screen_variant_ct = 0;
+    uintptr_t variant_uidx_base = 0;
+    uintptr_t cur_bits = variant_include[0];
+    for (uint32_t variant_idx = 0; variant_idx != variant_ct; ++variant_idx) {
+      const uint32_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+      uint32_t carrier_ct;
+      reterr = KingScreenLoad(sample_include, pssi, sample_uidxs, sample_ct, variant_uidx, max_carrier_ct, simple_pgrp, genovec, carrier_uidxs, &carrier_ct);
+      if (unlikely(reterr)) {
+        goto KingScreenCandidates_ret_PGR_FAIL;
+      }
+      if (!carrier_ct) {
+        continue;
+      }
+      SetBit(variant_uidx, screen_variant_include);
+      ++screen_variant_ct;
+      for (uint32_t carrier_idx = 0; carrier_idx != carrier_ct; ++carrier_idx) {
+        const uint32_t sample_uidx = carrier_uidxs[carrier_idx];
+        rare_cts[sample_uidx] += 1;
+        hi_pair_cts[sample_uidx] += carrier_idx;
+      }
+    }
+    putc_unlocked('\r', stdout);
+    if (unlikely(!screen_variant_ct)) {
+      logerrprintf("Error: --king-screen: No autosomal variants with 2..%u minor-allele carriers.\n", max_carrier_ct);
+      goto KingScreenCandidates_ret_DEGENERATE_DATA;
+    }
+
+    // Second scan(s): materialize and sort pair keys, keeping the candidates
+    // at the front of the same buffer.
+    uint64_t* pair_keys = R_CAST(uint64_t*, g_bigstack_base);
+    const uintptr_t key_capacity = bigstack_left() / sizeof(int64_t);
+    uintptr_t candidate_ct = 0;
+    uint64_t carrier_pair_ct = 0;
+    uint32_t pass_ct = 0;
+    for (uint32_t pass_start_uidx = 0; pass_start_uidx != raw_sample_ct; ) {
+      const uintptr_t cur_key_capacity = key_capacity - candidate_ct;
+      uint64_t pass_key_ct = 0;
+      uint32_t pass_end_uidx = pass_start_uidx;
+      for (; pass_end_uidx != raw_sample_ct; ++pass_end_uidx) {
+        const uint64_t cur_pair_ct = hi_pair_cts[pass_end_uidx];
+        if (pass_key_ct + cur_pair_ct > cur_key_capacity) {
           break;
         }
+        pass_key_ct += cur_pair_ct;
       }
-    } else {
-      Halfword* dosage_present_alias = R_CAST(Halfword*, dosage_present_buf);
-      for (uint32_t widx = 0; widx != sample_ctl2; ++widx) {
-        const uintptr_t detect_11 = Word11(genovec_buf[widx]);
-        if (detect_11) {
-          if (PackWordToHalfword(detect_11) & (~dosage_present_alias[widx])) {
-            *missing_presentp = 1;
+      if (!pass_key_ct) {
+        if (unlikely(pass_end_uidx != raw_sample_ct)) {
+          goto KingScreenCandidates_ret_NOMEM;
+        }
+        break;
+      }
+      ++pass_ct;
+      printf("\r--king-screen pass %u: Collecting carrier pairs...", pass_ct);
+      fflush(stdout);
+      uint64_t* pass_keys = &(pair_keys[candidate_ct]);
+      uint64_t* pass_keys_iter = pass_keys;
+      variant_uidx_base = 0;
+      cur_bits = screen_variant_include[0];
+      for (uint32_t variant_idx = 0; variant_idx != screen_variant_ct; ++variant_idx) {
+        const uint32_t variant_uidx = BitIter1(screen_variant_include, &variant_uidx_base, &cur_bits);
+        uint32_t carrier_ct;
+        reterr = KingScreenLoad(sample_include, pssi, sample_uidxs, sample_ct, variant_uidx, max_carrier_ct, simple_pgrp, genovec, carrier_uidxs, &carrier_ct);
+        if (unlikely(reterr)) {
+          goto KingScreenCandidates_ret_PGR_FAIL;
+        }
+        for (uint32_t carrier_idx = 1; carrier_idx != carrier_ct; ++carrier_idx) {
+          const uint64_t hi_uidx = carrier_uidxs[carrier_idx];
+          if (hi_uidx < pass_start_uidx) {
+            continue;
+          }
+          if (hi_uidx >= pass_end_uidx) {
             break;
           }
+          const uint64_t key_base = hi_uidx << 32;
+          for (uint32_t lo_idx = 0; lo_idx != carrier_idx; ++lo_idx) {
+            *pass_keys_iter++ = key_base | carrier_uidxs[lo_idx];
+          }
+        }
+      }
+      STD_SORT(pass_key_ct, u64cmp, pass_keys);
+      carrier_pair_ct += pass_key_ct;
+      const uint64_t* pass_keys_end = &(pass_keys[pass_key_ct]);
+      for (const uint64_t* read_iter = pass_keys; read_iter != pass_keys_end; ) {
+        const uint64_t cur_key = *read_iter;
+        const uint64_t* run_start = read_iter;
+        do {
+          ++read_iter;
+        } while ((read_iter != pass_keys_end) && (*read_iter == cur_key));
+        const uint32_t shared_ct = read_iter - run_start;
+        if (shared_ct < min_shared_ct) {
+          continue;
+        }
+        const uint32_t hi_rare_ct = rare_cts[cur_key >> 32];
+        const uint32_t lo_rare_ct = rare_cts[S_CAST(uint32_t, cur_key)];
+        if (u31tod(shared_ct) >= screen_thresh * u31tod(MINV(hi_rare_ct, lo_rare_ct))) {
+          pair_keys[candidate_ct++] = cur_key;
         }
       }
+      pass_start_uidx = pass_end_uidx;
     }
+    putc_unlocked('\r', stdout);
+    const uint64_t all_pair_ct = (S_CAST(uint64_t, sample_ct) * (sample_ct - 1)) / 2;
+    logprintf("--king-screen: %u variant%s with 2..%u minor-allele carriers, %" PRIu64 " carrier pair%s; %" PRIuPTR " candidate pair%s (of %" PRIu64 ").\n", screen_variant_ct, (screen_variant_ct == 1)? "" : "s", max_carrier_ct, carrier_pair_ct, (carrier_pair_ct == 1)? "" : "s", candidate_ct, (candidate_ct == 1)? "" : "s", all_pair_ct);
+    BigstackShrinkTop(pair_keys, candidate_ct * sizeof(int64_t));
+    *screen_pairs_ptr = pair_keys;
+    *screen_pair_ct_ptr = candidate_ct;
   }
-  return ExpandCenteredVarmaj(genovec_buf, dosage_present_buf, dosage_main_buf, variance_standardize, is_haploid, sample_ct, dosage_ct, ref_freq, normed_dosages);
-}
-
-double ComputeDiploidMultiallelicVariance(const double* cur_allele_freqs, uint32_t cur_allele_ct) {
-  const uint32_t cur_allele_ct_m1 = cur_allele_ct - 1;
-  double variance = 0.0;
-  double freq_sum = 0.0;
-  for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct_m1; ++allele_idx) {
-    const double cur_allele_freq = cur_allele_freqs[allele_idx];
-    variance += cur_allele_freq * (1.0 - cur_allele_freq);
-    freq_sum += cur_allele_freq;
+  while (0) {
+  KingScreenCandidates_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  KingScreenCandidates_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  KingScreenCandidates_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
   }
-  if (freq_sum < 1.0 - kSmallEpsilon) {
-    const double last_allele_freq = 1.0 - freq_sum;
-    variance += freq_sum * last_allele_freq;
+  if (reterr) {
+    BigstackReset(bigstack_mark);
   }
-  return variance;
+  BigstackEndReset(bigstack_end_mark);
+  return reterr;
 }
 
-// Assumes trailing bits of pgvp->genovec have been zeroed out.
-BoolErr CheckMultiallelicDegenVariance(const PgenVariant* pgvp, const double* cur_allele_freqs, uint32_t sample_ct, uint32_t cur_allele_ct, double variance) {
-  // One allele has 100% frequency (or all frequencies are NaN).
-  // If it's the REF allele, error out unless all nonmissing genotypes are
-  // homozygous-ref, in which case this row can be filled with zeroes (or
-  // omitted).
-  // If it's ALT1, error out unless all nonmissing genotypes are hom-ALT1, etc.
-  const uintptr_t* genovec_buf = pgvp->genovec;
-  STD_ARRAY_DECL(uint32_t, 4, genocounts);
-  GenoarrCountFreqsUnsafe(genovec_buf, sample_ct, genocounts);
-  if (unlikely(pgvp->dosage_ct || genocounts[1])) {
-    return 1;
-  }
-  const uint32_t nm_sample_ct = genocounts[2];
-  if (variance != variance) {
-    // NaN frequency is possible when all founder genotypes/dosages are
-    // missing.  Error out in this case unless all other genotypes/dosages are
-    // also missing.
-    return (genocounts[0] || nm_sample_ct);
-  }
-  if (cur_allele_freqs[0] > 0.5) {
-    return (nm_sample_ct != 0);
-  }
-  if (unlikely(genocounts[0])) {
-    return 1;
-  }
+PglErr CalcKingScreen(const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, uint32_t max_carrier_ct, uint32_t min_shared_ct, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  {
+    const char* flagname = (king_flags & kfKingColAll)? "--make-king-table" : "--king-cutoff";
+    if (unlikely(IsSet(cip->haploid_mask, 0))) {
+      logerrprintf("Error: %s cannot be used on haploid genomes.\n", flagname);
+      goto CalcKingScreen_ret_INCONSISTENT_INPUT;
+    }
+    const uint32_t sample_ct = *sample_ct_ptr;
+    if (unlikely(sample_ct < 2)) {
+      logerrprintf("Error: %s requires at least 2 samples.\n", flagname);
+      goto CalcKingScreen_ret_DEGENERATE_DATA;
+    }
+    reterr = ConditionalAllocateNonAutosomalVariants(cip, "KING-robust calculation", raw_variant_ct, &variant_include, &variant_ct);
+    if (unlikely(reterr)) {
+      goto CalcKingScreen_ret_1;
+    }
+    // Screen at the more permissive of the two thresholds.
+    double screen_thresh = king_table_filter;
+    if ((king_cutoff != -1) && ((king_table_filter == -DBL_MAX) || (king_cutoff < king_table_filter))) {
+      screen_thresh = king_cutoff;
+    }
+    uint64_t* screen_pairs;
+    uintptr_t screen_pair_ct;
+    reterr = KingScreenCandidates(sample_include, variant_include, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, max_carrier_ct, min_shared_ct, screen_thresh, simple_pgrp, &screen_pairs, &screen_pair_ct);
+    if (unlikely(reterr)) {
+      goto CalcKingScreen_ret_1;
+    }
+    uintptr_t* kinship_table = nullptr;
+    if (king_cutoff != -1) {
+      const uintptr_t sample_ctl = BitCtToWordCt(sample_ct);
+      if (unlikely(bigstack_calloc_w(sample_ct * sample_ctl, &kinship_table))) {
+        goto CalcKingScreen_ret_NOMEM;
+      }
+    }
+    reterr = CalcKingTableSubset(sample_include, siip, variant_include, cip, nullptr, screen_pairs, screen_pair_ct, raw_sample_ct, sample_ct, raw_variant_ct, variant_ct, king_cutoff, king_table_filter, -DBL_MAX, 0, king_flags, parallel_idx, parallel_tot, max_thread_ct, simple_pgrp, kinship_table, outname, outname_end);
+    if (unlikely(reterr)) {
+      goto CalcKingScreen_ret_1;
+    }
+    if (kinship_table) {
+      if (unlikely(KinshipPruneDestructive(kinship_table, sample_include, sample_ct_ptr))) {
+        goto CalcKingScreen_ret_NOMEM;
+      }
+    }
+  }
+  while (0) {
+  CalcKingScreen_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  CalcKingScreen_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  CalcKingScreen_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+ CalcKingScreen_ret_1:
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
+// Assumes variance isn't degenerate when variance_standardize is set.
+double BiallelicCenteredInvStdev(uint32_t variance_standardize, uint32_t is_haploid, double ref_freq) {
+  if (!variance_standardize) {
+    // Extra factor of 2 removed from haploid 'cov' formula in alpha 3.
+    return is_haploid? 0.5 : 1.0;
+  }
+  const double variance = 2 * ref_freq * (1.0 - ref_freq);
+  double inv_stdev = 1.0 / sqrt(variance);
+  if (is_haploid) {
+    // For our purposes, variance is doubled in haploid case.
+    inv_stdev *= (1.0 / kSqrt2);
+  }
+  // possible todo:
+  // * Could use one inv_stdev for males and one for nonmales for chrX
+  //   --score (while still leaving that out of GRM... or just leave males
+  //   out there?).  This depends on dosage compensation model; discussed in
+  //   e.g. GCTA paper.
+  return inv_stdev;
+}
+
+// This breaks the "don't pass pssi between functions" rule since it's a thin
+// wrapper around PgrGetDenseDosageD().
+PglErr LoadBiallelicCenteredVarmaj(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, uint32_t variance_standardize, uint32_t is_haploid, uint32_t sample_ct, uint32_t variant_uidx, double ref_freq, PgenReader* simple_pgrp, uint32_t* missing_presentp, double* normed_dosages, uintptr_t* genovec_buf, uintptr_t* raregeno_buf, uint32_t* difflist_sample_ids_buf, uintptr_t* dosage_present_buf, Dosage* dosage_main_buf) {
+  const double alt_freq = 1.0 - ref_freq;
+  if (variance_standardize && (!(2 * ref_freq * alt_freq > kSmallEpsilon))) {
+    // See LoadMultiallelicCenteredVarmaj().  This check was tightened up in
+    // alpha 3 to reject all-het and monomorphic-wrong-allele variants.
+    uint32_t dosage_ct;
+    PglErr reterr = PgrGetD(sample_include, pssi, sample_ct, variant_uidx, simple_pgrp, genovec_buf, dosage_present_buf, dosage_main_buf, &dosage_ct);
+    if (unlikely(reterr)) {
+      // don't print malformed-.pgen error message here, since this is called
+      // from multithreaded loops
+      return reterr;
+    }
+    ZeroTrailingNyps(sample_ct, genovec_buf);
+    STD_ARRAY_DECL(uint32_t, 4, genocounts);
+    GenoarrCountFreqsUnsafe(genovec_buf, sample_ct, genocounts);
+    if (unlikely(dosage_ct || genocounts[1])) {
+      return kPglRetDegenerateData;
+    }
+    if (ref_freq != ref_freq) {
+      if (unlikely(genocounts[0] || genocounts[2])) {
+        return kPglRetDegenerateData;
+      }
+    } else {
+      if (ref_freq > 0.5) {
+        if (unlikely(genocounts[2])) {
+          return kPglRetDegenerateData;
+        }
+      } else {
+        if (unlikely(genocounts[0])) {
+          return kPglRetDegenerateData;
+        }
+      }
+    }
+    if (missing_presentp && genocounts[3]) {
+      *missing_presentp = 1;
+    }
+    ZeroDArr(sample_ct, normed_dosages);
+    return kPglRetSuccess;
+  }
+  const double inv_stdev = BiallelicCenteredInvStdev(variance_standardize, is_haploid, ref_freq);
+  uint32_t missing_ct;
+  PglErr reterr = PgrGetDenseDosageD(sample_include, pssi, sample_ct, variant_uidx, inv_stdev, -2 * alt_freq * inv_stdev, 0.0, simple_pgrp, genovec_buf, raregeno_buf, difflist_sample_ids_buf, dosage_present_buf, dosage_main_buf, missing_presentp? (&missing_ct) : nullptr, normed_dosages);
+  if (unlikely(reterr)) {
+    return reterr;
+  }
+  if (missing_presentp && missing_ct) {
+    // missing_present assumed to be initialized to 0
+    *missing_presentp = 1;
+  }
+  return kPglRetSuccess;
+}
+
+double ComputeDiploidMultiallelicVariance(const double* cur_allele_freqs, uint32_t cur_allele_ct) {
+  const uint32_t cur_allele_ct_m1 = cur_allele_ct - 1;
+  double variance = 0.0;
+  double freq_sum = 0.0;
+  for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct_m1; ++allele_idx) {
+    const double cur_allele_freq = cur_allele_freqs[allele_idx];
+    variance += cur_allele_freq * (1.0 - cur_allele_freq);
+    freq_sum += cur_allele_freq;
+  }
+  if (freq_sum < 1.0 - kSmallEpsilon) {
+    const double last_allele_freq = 1.0 - freq_sum;
+    variance += freq_sum * last_allele_freq;
+  }
+  return variance;
+}
+
+// Assumes trailing bits of pgvp->genovec have been zeroed out.
+BoolErr CheckMultiallelicDegenVariance(const PgenVariant* pgvp, const double* cur_allele_freqs, uint32_t sample_ct, uint32_t cur_allele_ct, double variance) {
+  // One allele has 100% frequency (or all frequencies are NaN).
+  // If it's the REF allele, error out unless all nonmissing genotypes are
+  // homozygous-ref, in which case this row can be filled with zeroes (or
+  // omitted).
+  // If it's ALT1, error out unless all nonmissing genotypes are hom-ALT1, etc.
+  const uintptr_t* genovec_buf = pgvp->genovec;
+  STD_ARRAY_DECL(uint32_t, 4, genocounts);
+  GenoarrCountFreqsUnsafe(genovec_buf, sample_ct, genocounts);
+  if (unlikely(pgvp->dosage_ct || genocounts[1])) {
+    return 1;
+  }
+  const uint32_t nm_sample_ct = genocounts[2];
+  if (variance != variance) {
+    // NaN frequency is possible when all founder genotypes/dosages are
+    // missing.  Error out in this case unless all other genotypes/dosages are
+    // also missing.
+    return (genocounts[0] || nm_sample_ct);
+  }
+  if (cur_allele_freqs[0] > 0.5) {
+    return (nm_sample_ct != 0);
+  }
+  if (unlikely(genocounts[0])) {
+    return 1;
+  }
   if (cur_allele_freqs[1] > 0.5) {
     return (pgvp->patch_10_ct != 0);
   }
@@ -3566,7 +4018,7 @@ PglErr LoadMultiallelicCenteredVarmaj(const uintptr_t* sample_include, PgrSample
   return kPglRetSuccess;
 }
 
-PglErr LoadCenteredVarmajBlock(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t variance_standardize, uint32_t is_haploid, uint32_t sample_ct, uint32_t variant_ct, PgenReader* simple_pgrp, double* normed_vmaj_iter, uintptr_t* variant_include_has_missing, uint32_t* cur_batch_sizep, uint32_t* variant_idxp, uintptr_t* variant_uidxp, uintptr_t* allele_idx_basep, uint32_t* cur_allele_ctp, uint32_t* incomplete_allele_idxp, PgenVariant* pgvp, double* allele_1copy_buf) {
+PglErr LoadCenteredVarmajBlock(const uintptr_t* sample_include, PgrSampleSubsetIndex pssi, const uintptr_t* variant_include, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t variance_standardize, uint32_t is_haploid, uint32_t sample_ct, uint32_t variant_ct, PgenReader* simple_pgrp, double* normed_vmaj_iter, uintptr_t* variant_include_has_missing, uint32_t* cur_batch_sizep, uint32_t* variant_idxp, uintptr_t* variant_uidxp, uintptr_t* allele_idx_basep, uint32_t* cur_allele_ctp, uint32_t* incomplete_allele_idxp, PgenVariant* pgvp, uintptr_t* raregeno_buf, uint32_t* difflist_sample_ids_buf, double* allele_1copy_buf) {
   const uint32_t std_batch_size = *cur_batch_sizep;
   uint32_t variant_idx = *variant_idxp;
   uintptr_t variant_uidx = *variant_uidxp;
@@ -3594,7 +4046,7 @@ PglErr LoadCenteredVarmajBlock(const uintptr_t* sample_include, PgrSampleSubsetI
     if (cur_allele_ct == 2) {
       allele_idx_stop = 1;
       allele_idx_end = 1;
-      reterr = LoadBiallelicCenteredVarmaj(sample_include, pssi, variance_standardize, is_haploid, sample_ct, variant_uidx, allele_freqs[allele_idx_base], simple_pgrp, variant_include_has_missing? (&missing_present) : nullptr, normed_vmaj_iter, pgvp->genovec, pgvp->dosage_present, pgvp->dosage_main);
+      reterr = LoadBiallelicCenteredVarmaj(sample_include, pssi, variance_standardize, is_haploid, sample_ct, variant_uidx, allele_freqs[allele_idx_base], simple_pgrp, variant_include_has_missing? (&missing_present) : nullptr, normed_vmaj_iter, pgvp->genovec, raregeno_buf, difflist_sample_ids_buf, pgvp->dosage_present, pgvp->dosage_main);
     } else {
       allele_idx_end = cur_allele_ct;
       allele_idx_stop = std_batch_size + incomplete_allele_idx - allele_bidx;
@@ -3765,7 +4217,7 @@ THREAD_FUNC_DECL CalcDblMissingThread(void* raw_arg) {
   THREAD_RETURN;
 }
 
-PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, uint32_t sample_ct, uint32_t variant_ct, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t row_start_idx, uintptr_t row_end_idx, uint32_t max_thread_ct, PgenReader* simple_pgrp, uint32_t** missing_cts_ptr, uint32_t** missing_dbl_exclude_cts_ptr) {
+PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, uint32_t variant_ct, uint32_t row_start_idx, uintptr_t row_end_idx, uint32_t max_thread_ct, PgenReader* simple_pgrp, uint32_t** missing_cts_ptr, uint32_t** missing_dbl_exclude_cts_ptr) {
   unsigned char* bigstack_mark = g_bigstack_base;
   ThreadGroup tg;
   PreinitThreads(&tg);
@@ -3799,9 +4251,7 @@ PglErr CalcMissingMatrix(const uintptr_t* sample_include, const uint32_t* sample
     // note that this ctx.thread_start[] may have different values than the one
     // computed by CalcGrm(), since calc_thread_ct changes in the MTBLAS and
     // OS X cases.
-    TriangleFill(sample_ct, calc_thread_ct, parallel_idx, parallel_tot, 0, 1, ctx.thread_start);
-    assert(ctx.thread_start[0] == row_start_idx);
-    assert(ctx.thread_start[calc_thread_ct] == row_end_idx);
+    TriangleLoadBalance(calc_thread_ct, row_start_idx, row_end_idx, 0, ctx.thread_start);
     SetThreadFuncAndData(CalcDblMissingThread, &ctx, &tg);
     const uint32_t sample_transpose_batch_ct_m1 = (row_end_idx - 1) / kPglBitTransposeBatch;
 
@@ -4008,9 +4458,14 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     ctx.grm = grm;
     uint32_t* sample_include_cumulative_popcounts;
     PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
     double* allele_1copy_buf;
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
     if (unlikely(bigstack_alloc_u32(raw_sample_ctl, &sample_include_cumulative_popcounts) ||
                  BigstackAllocPgv(row_end_idx, allele_idx_offsets != nullptr, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
                  bigstack_alloc_d(max_allele_ct, &allele_1copy_buf))) {
       goto CalcGrm_ret_NOMEM;
     }
@@ -4075,7 +4530,7 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
     while (1) {
       if (!IsLastBlock(&tg)) {
         double* normed_vmaj = ctx.normed_dosage_vmaj_bufs[parity];
-        reterr = LoadCenteredVarmajBlock(sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, variance_standardize, is_haploid, row_end_idx, variant_ct, simple_pgrp, normed_vmaj, variant_include_has_missing, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, allele_1copy_buf);
+        reterr = LoadCenteredVarmajBlock(sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, variance_standardize, is_haploid, row_end_idx, variant_ct, simple_pgrp, normed_vmaj, variant_include_has_missing, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
         if (unlikely(reterr)) {
           goto CalcGrm_ret_PGR_FAIL;
         }
@@ -4124,7 +4579,7 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
       // if no missing calls at all, act as if meanimpute was on
       if (variant_ct_with_missing) {
         logputs("Correcting for missingness... ");
-        reterr = CalcMissingMatrix(sample_include, sample_include_cumulative_popcounts, variant_include_has_missing, sample_ct, variant_ct_with_missing, parallel_idx, parallel_tot, row_start_idx, row_end_idx, max_thread_ct, simple_pgrp, &missing_cts, &missing_dbl_exclude_cts);
+        reterr = CalcMissingMatrix(sample_include, sample_include_cumulative_popcounts, variant_include_has_missing, variant_ct_with_missing, row_start_idx, row_end_idx, max_thread_ct, simple_pgrp, &missing_cts, &missing_dbl_exclude_cts);
         if (unlikely(reterr)) {
           goto CalcGrm_ret_1;
         }
@@ -4530,147 +4985,688 @@ PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, c
   return reterr;
 }
 
-// should be able to remove NOLAPACK later since we already have a non-LAPACK
-// SVD implementation
-#ifndef NOLAPACK
-// this seems to be better than 256 (due to avoidance of cache critical
-// stride?)
-// (still want this to be a multiple of 8, for cleaner multithreading)
-CONSTI32(kPcaVariantBlockSize, 240);
-
-typedef struct CalcPcaCtxStruct {
-  uint32_t sample_ct;
-  uint32_t pc_ct;
-
-  double* yy_bufs[2];
-
-  uint32_t cur_batch_size;
-
-  double* g1;
-  double* qq;
-  double** y_transpose_bufs;
-  double** g2_bb_part_bufs;
-} CalcPcaCtx;
-
-THREAD_FUNC_DECL CalcPcaXtxaThread(void* raw_arg) {
-  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
-  const uintptr_t tidx = arg->tidx;
-  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
-
-  const uint32_t sample_ct = ctx->sample_ct;
-  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
-  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
-  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
-  const double* g1 = ctx->g1;
-  double* qq_iter = ctx->qq;
-  double* y_transpose_buf = ctx->y_transpose_bufs[tidx];
-  double* g2_part_buf = ctx->g2_bb_part_bufs[tidx];
-  uint32_t parity = 0;
-  do {
-    const uint32_t cur_batch_size = ctx->cur_batch_size;
-    if (vidx_offset < cur_batch_size) {
-      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
-      if (cur_thread_batch_size > kPcaVariantBlockSize) {
-        cur_thread_batch_size = kPcaVariantBlockSize;
-      }
-      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
-      double* cur_qq = &(qq_iter[vidx_offset * qq_col_ct]);
-      RowMajorMatrixMultiplyStrided(yy_buf, g1, cur_thread_batch_size, sample_ct, pc_ct_x2, pc_ct_x2, sample_ct, qq_col_ct, cur_qq);
-      MatrixTransposeCopy(yy_buf, cur_thread_batch_size, sample_ct, y_transpose_buf);
-      RowMajorMatrixMultiplyStridedIncr(y_transpose_buf, cur_qq, sample_ct, cur_thread_batch_size, pc_ct_x2, qq_col_ct, cur_thread_batch_size, pc_ct_x2, g2_part_buf);
-      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
+// --make-grm-sparse.  The (--parallel-restricted) lower triangle is computed
+// one row tile at a time, with the tile size chosen to fit in the remaining
+// workspace; genotypes are reread on each pass, so the dense matrix is never
+// fully materialized.  Only the diagonal and the off-diagonal entries greater
+// than cutoff are written, as GCTA-style sorted (row, column, value) triplets
+// with 0-based sample indices.
+PglErr CalcGrmSparse(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, double cutoff, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  char* cswritep = nullptr;
+  CompressStreamState css;
+  ThreadGroup tg;
+  PglErr reterr = kPglRetSuccess;
+  PreinitCstream(&css);
+  PreinitThreads(&tg);
+  {
+    assert(variant_ct);
+    if (unlikely(sample_ct < 2)) {
+      logerrputs("Error: GRM construction requires at least two samples.\n");
+      goto CalcGrmSparse_ret_DEGENERATE_DATA;
     }
-    parity = 1 - parity;
-  } while (!THREAD_BLOCK_FINISH(arg));
-  THREAD_RETURN;
-}
-
-THREAD_FUNC_DECL CalcPcaXaThread(void* raw_arg) {
-  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
-  const uintptr_t tidx = arg->tidx;
-  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
-
-  const uint32_t sample_ct = ctx->sample_ct;
-  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
-  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
-  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
-  const double* g1 = ctx->g1;
-  double* qq_iter = ctx->qq;
-  uint32_t parity = 0;
-  do {
-    const uint32_t cur_batch_size = ctx->cur_batch_size;
-    if (vidx_offset < cur_batch_size) {
-      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
-      if (cur_thread_batch_size > kPcaVariantBlockSize) {
-        cur_thread_batch_size = kPcaVariantBlockSize;
+#if defined(__APPLE__) || defined(USE_MTBLAS)
+    uint32_t calc_thread_ct = 1;
+#else
+    uint32_t calc_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+    if (calc_thread_ct * parallel_tot > sample_ct / 32) {
+      calc_thread_ct = sample_ct / (32 * parallel_tot);
+      if (!calc_thread_ct) {
+        calc_thread_ct = 1;
       }
-      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
-      double* cur_qq = &(qq_iter[vidx_offset * qq_col_ct]);
-      RowMajorMatrixMultiplyStrided(yy_buf, g1, cur_thread_batch_size, sample_ct, pc_ct_x2, pc_ct_x2, sample_ct, qq_col_ct, cur_qq);
-      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
     }
-    parity = 1 - parity;
-  } while (!THREAD_BLOCK_FINISH(arg));
-  THREAD_RETURN;
-}
-
-THREAD_FUNC_DECL CalcPcaXtbThread(void* raw_arg) {
-  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
-  const uintptr_t tidx = arg->tidx;
-  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
-
-  const uint32_t sample_ct = ctx->sample_ct;
-  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
-  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
-  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
-  const double* qq_iter = &(ctx->qq[vidx_offset * qq_col_ct]);
-  double* y_transpose_buf = ctx->y_transpose_bufs[tidx];
-  double* bb_part_buf = ctx->g2_bb_part_bufs[tidx];
-  uint32_t parity = 0;
-  do {
-    const uint32_t cur_batch_size = ctx->cur_batch_size;
-    if (vidx_offset < cur_batch_size) {
-      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
-      if (cur_thread_batch_size > kPcaVariantBlockSize) {
-        cur_thread_batch_size = kPcaVariantBlockSize;
+#endif
+    int32_t grand_row_start_idx;
+    int32_t grand_row_end_idx;
+    ParallelBounds(sample_ct, 0, parallel_idx, parallel_tot, &grand_row_start_idx, &grand_row_end_idx);
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    CalcGrmPartCtx ctx;
+    uintptr_t* cur_sample_include;
+    uint32_t* sample_include_cumulative_popcounts;
+    PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
+    double* allele_1copy_buf;
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+    if (unlikely(SetThreadCt(calc_thread_ct, &tg) ||
+                 bigstack_alloc_u32(calc_thread_ct + 1, &ctx.thread_start) ||
+                 bigstack_alloc_w(raw_sample_ctl, &cur_sample_include) ||
+                 bigstack_alloc_u32(raw_sample_ctl, &sample_include_cumulative_popcounts) ||
+                 BigstackAllocPgv(grand_row_end_idx, allele_idx_offsets != nullptr, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
+                 bigstack_alloc_d(max_allele_ct, &allele_1copy_buf) ||
+                 bigstack_alloc_d(grand_row_end_idx * kGrmVariantBlockSize, &ctx.normed_dosage_vmaj_bufs[0]) ||
+                 bigstack_alloc_d(grand_row_end_idx * kGrmVariantBlockSize, &ctx.normed_dosage_vmaj_bufs[1]) ||
+                 bigstack_alloc_d(grand_row_end_idx * kGrmVariantBlockSize, &ctx.normed_dosage_smaj_bufs[0]) ||
+                 bigstack_alloc_d(grand_row_end_idx * kGrmVariantBlockSize, &ctx.normed_dosage_smaj_bufs[1]))) {
+      goto CalcGrmSparse_ret_NOMEM;
+    }
+    reterr = ConditionalAllocateNonAutosomalVariants(cip, "GRM construction", raw_variant_ct, &variant_include, &variant_ct);
+    if (unlikely(reterr)) {
+      goto CalcGrmSparse_ret_1;
+    }
+    uintptr_t* variant_include_has_missing = nullptr;
+    if (!(grm_flags & kfGrmMeanimpute)) {
+      if (unlikely(bigstack_alloc_w(raw_variant_ctl, &variant_include_has_missing))) {
+        goto CalcGrmSparse_ret_NOMEM;
       }
-      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
-      MatrixTransposeCopy(yy_buf, cur_thread_batch_size, sample_ct, y_transpose_buf);
-      RowMajorMatrixMultiplyIncr(y_transpose_buf, qq_iter, sample_ct, qq_col_ct, cur_thread_batch_size, bb_part_buf);
-      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
     }
-    parity = 1 - parity;
-  } while (!THREAD_BLOCK_FINISH(arg));
-  THREAD_RETURN;
+    char* outname_end2 = strcpya_k(outname_end, ".grm.sp");
+    if (parallel_tot != 1) {
+      *outname_end2++ = '.';
+      outname_end2 = u32toa(parallel_idx + 1, outname_end2);
+    }
+    const uint32_t output_zst = (grm_flags / kfGrmSparseZs) & 1;
+    if (output_zst) {
+      outname_end2 = strcpya_k(outname_end2, ".zst");
+    }
+    *outname_end2 = '\0';
+    reterr = InitCstreamAlloc(outname, 0, output_zst, max_thread_ct, kCompressStreamBlock + kMaxMediumLine, &css, &cswritep);
+    if (unlikely(reterr)) {
+      goto CalcGrmSparse_ret_1;
+    }
+
+    // Each pass needs a (row_ct x row_end_idx) block of doubles, which is at
+    // most twice the number of lower-triangle cells it covers, plus
+    // CalcMissingMatrix()'s uint32 triangle and O(row_end_idx) buffers.
+    const uintptr_t per_cell_bytes = 2 * sizeof(double) + (variant_include_has_missing? sizeof(int32_t) : 0);
+    const uintptr_t reserved_bytes = 64 * RoundUpPow2(grand_row_end_idx, kCacheline) + kPglBitTransposeBufbytes + 16 * kCacheline;
+    uintptr_t cells_avail = bigstack_left();
+    cells_avail = (cells_avail > reserved_bytes)? ((cells_avail - reserved_bytes) / per_cell_bytes) : 0;
+    const uint32_t pass_ct = CountTrianglePasses(grand_row_start_idx, grand_row_end_idx, 0, cells_avail);
+    if (unlikely(!pass_ct)) {
+      goto CalcGrmSparse_ret_NOMEM;
+    }
+    SetThreadFuncAndData(CalcGrmPartThread, &ctx, &tg);
+#ifdef USE_MTBLAS
+    const uint32_t blas_thread_ct = (max_thread_ct > 2)? (max_thread_ct - 1) : max_thread_ct;
+    BLAS_SET_NUM_THREADS(blas_thread_ct);
+#endif
+    const uint32_t variance_standardize = !(grm_flags & kfGrmCov);
+    const uint32_t is_haploid = cip->haploid_mask[0] & 1;
+    unsigned char* pass_bigstack_mark = g_bigstack_base;
+    uintptr_t offdiag_written_ct = 0;
+    uint32_t row_end_idx = grand_row_start_idx;
+    for (uint32_t pass_idx_p1 = 1; pass_idx_p1 <= pass_ct; ++pass_idx_p1) {
+      const uint32_t row_start_idx = row_end_idx;
+      row_end_idx = NextTrianglePass(row_start_idx, grand_row_end_idx, 0, cells_avail);
+      TriangleLoadBalance(calc_thread_ct, row_start_idx, row_end_idx, 0, ctx.thread_start);
+      memcpy(cur_sample_include, orig_sample_include, raw_sample_ctl * sizeof(intptr_t));
+      if (row_end_idx < sample_ct) {
+        const uint32_t sample_uidx_end = 1 + IdxToUidxBasic(orig_sample_include, row_end_idx - 1);
+        ClearBitsNz(sample_uidx_end, raw_sample_ctl * kBitsPerWord, cur_sample_include);
+      }
+      FillCumulativePopcounts(cur_sample_include, raw_sample_ctl, sample_include_cumulative_popcounts);
+      if (variant_include_has_missing) {
+        ZeroWArr(raw_variant_ctl, variant_include_has_missing);
+      }
+      double* grm;
+      if (unlikely(bigstack_calloc_d(S_CAST(uintptr_t, row_end_idx - row_start_idx) * row_end_idx, &grm))) {
+        goto CalcGrmSparse_ret_NOMEM;
+      }
+      ctx.sample_ct = row_end_idx;
+      ctx.grm = grm;
+      if (pass_idx_p1 != 1) {
+        ReinitThreads(&tg);
+      }
+      uint32_t cur_batch_size = kGrmVariantBlockSize;
+      uint32_t variant_idx_start = 0;
+      uint32_t variant_idx = 0;
+      uintptr_t variant_uidx = 0;
+      uintptr_t allele_idx_base = 0;
+      uint32_t cur_allele_ct = 2;
+      uint32_t incomplete_allele_idx = 0;
+      uint32_t parity = 0;
+      uint32_t is_not_first_block = 0;
+      uint32_t pct = 0;
+      uint32_t next_print_variant_idx = variant_ct / 100;
+      logprintf("--make-grm-sparse pass %u/%u: Constructing GRM... ", pass_idx_p1, pass_ct);
+      fputs("0%", stdout);
+      fflush(stdout);
+      PgrSampleSubsetIndex pssi;
+      PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+      while (1) {
+        if (!IsLastBlock(&tg)) {
+          double* normed_vmaj = ctx.normed_dosage_vmaj_bufs[parity];
+          reterr = LoadCenteredVarmajBlock(cur_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, variance_standardize, is_haploid, row_end_idx, variant_ct, simple_pgrp, normed_vmaj, variant_include_has_missing, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
+          if (unlikely(reterr)) {
+            goto CalcGrmSparse_ret_PGR_FAIL;
+          }
+          MatrixTransposeCopy(normed_vmaj, cur_batch_size, row_end_idx, ctx.normed_dosage_smaj_bufs[parity]);
+        }
+        if (is_not_first_block) {
+          JoinThreads(&tg);
+          // CalcGrmPartThread() never errors out
+          if (IsLastBlock(&tg)) {
+            break;
+          }
+          if (variant_idx_start >= next_print_variant_idx) {
+            if (pct > 10) {
+              putc_unlocked('\b', stdout);
+            }
+            pct = (variant_idx_start * 100LLU) / variant_ct;
+            printf("\b\b%u%%", pct++);
+            fflush(stdout);
+            next_print_variant_idx = (pct * S_CAST(uint64_t, variant_ct)) / 100;
+          }
+        }
+        ctx.cur_batch_size = cur_batch_size;
+        if (variant_idx == variant_ct) {
+          DeclareLastThreadBlock(&tg);
+          cur_batch_size = 0;
+        }
+        if (unlikely(SpawnThreads(&tg))) {
+          goto CalcGrmSparse_ret_THREAD_CREATE_FAIL;
+        }
+        is_not_first_block = 1;
+        variant_idx_start = variant_idx;
+        parity = 1 - parity;
+      }
+      if (pct > 10) {
+        putc_unlocked('\b', stdout);
+      }
+      fputs("\b\b", stdout);
+      logputs("done.\n");
+      uint32_t* missing_cts = nullptr;
+      uint32_t* missing_dbl_exclude_cts = nullptr;
+      if (variant_include_has_missing) {
+        const uint32_t variant_ct_with_missing = PopcountWords(variant_include_has_missing, raw_variant_ctl);
+        if (variant_ct_with_missing) {
+          logputs("Correcting for missingness... ");
+          reterr = CalcMissingMatrix(cur_sample_include, sample_include_cumulative_popcounts, variant_include_has_missing, variant_ct_with_missing, row_start_idx, row_end_idx, max_thread_ct, simple_pgrp, &missing_cts, &missing_dbl_exclude_cts);
+          if (unlikely(reterr)) {
+            goto CalcGrmSparse_ret_1;
+          }
+        }
+      }
+      const double variant_ct_recip = 1.0 / u31tod(variant_ct);
+      const uint32_t* missing_dbl_exclude_iter = missing_dbl_exclude_cts;
+      for (uintptr_t row_idx = row_start_idx; row_idx != row_end_idx; ++row_idx) {
+        const double* grm_row = &(grm[(row_idx - row_start_idx) * row_end_idx]);
+        uint32_t variant_ct_base = variant_ct;
+        if (missing_cts) {
+          variant_ct_base -= missing_cts[row_idx];
+        }
+        for (uint32_t col_idx = 0; col_idx != row_idx; ++col_idx) {
+          double cur_val;
+          if (missing_cts) {
+            cur_val = grm_row[col_idx] / u31tod(variant_ct_base - missing_cts[col_idx] + (*missing_dbl_exclude_iter++));
+          } else {
+            cur_val = grm_row[col_idx] * variant_ct_recip;
+          }
+          if (cur_val > cutoff) {
+            cswritep = u32toa_x(row_idx, '\t', cswritep);
+            cswritep = u32toa_x(col_idx, '\t', cswritep);
+            cswritep = dtoa_g(cur_val, cswritep);
+            AppendBinaryEoln(&cswritep);
+            if (unlikely(Cswrite(&css, &cswritep))) {
+              goto CalcGrmSparse_ret_WRITE_FAIL;
+            }
+            ++offdiag_written_ct;
+          }
+        }
+        cswritep = u32toa_x(row_idx, '\t', cswritep);
+        cswritep = u32toa_x(row_idx, '\t', cswritep);
+        cswritep = dtoa_g(grm_row[row_idx] / u31tod(variant_ct_base), cswritep);
+        AppendBinaryEoln(&cswritep);
+        if (unlikely(Cswrite(&css, &cswritep))) {
+          goto CalcGrmSparse_ret_WRITE_FAIL;
+        }
+      }
+      BigstackReset(pass_bigstack_mark);
+    }
+    BLAS_SET_NUM_THREADS(1);
+    if (unlikely(CswriteCloseNull(&css, cswritep))) {
+      goto CalcGrmSparse_ret_WRITE_FAIL;
+    }
+    char* log_write_iter = strcpya_k(g_logbuf, "--make-grm-sparse: ");
+    log_write_iter = wtoa(offdiag_written_ct, log_write_iter);
+    log_write_iter = strcpya_k(log_write_iter, " off-diagonal entr");
+    log_write_iter = strcpya(log_write_iter, (offdiag_written_ct == 1)? "y" : "ies");
+    log_write_iter = strcpya_k(log_write_iter, " > ");
+    log_write_iter = dtoa_g(cutoff, log_write_iter);
+    log_write_iter = strcpya_k(log_write_iter, " (plus diagonal) written to ");
+    log_write_iter = strcpya(log_write_iter, outname);
+    if (!parallel_idx) {
+      SampleIdFlags id_print_flags = siip->flags & kfSampleIdFidPresent;
+      if (grm_flags & kfGrmNoIdHeader) {
+        id_print_flags |= kfSampleIdNoIdHeader;
+        if (grm_flags & kfGrmNoIdHeaderIidOnly) {
+          id_print_flags |= kfSampleIdNoIdHeaderIidOnly;
+        }
+      }
+      snprintf(&(outname_end[4]), kMaxOutfnameExtBlen - 4, ".id");
+      reterr = WriteSampleIdsOverride(orig_sample_include, siip, outname, sample_ct, id_print_flags);
+      if (unlikely(reterr)) {
+        goto CalcGrmSparse_ret_1;
+      }
+      log_write_iter = strcpya_k(log_write_iter, " , and IDs to ");
+      log_write_iter = strcpya(log_write_iter, outname);
+    }
+    snprintf(log_write_iter, kLogbufSize - 2 * kPglFnamesize - 256, " .\n");
+    WordWrapB(0);
+    logputsb();
+  }
+  while (0) {
+  CalcGrmSparse_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  CalcGrmSparse_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  CalcGrmSparse_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  CalcGrmSparse_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  CalcGrmSparse_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+ CalcGrmSparse_ret_1:
+  CswriteCloseCond(&css, cswritep);
+  CleanupThreads(&tg);
+  BLAS_SET_NUM_THREADS(1);
+  BigstackReset(bigstack_mark);
+  return reterr;
 }
 
-typedef struct CalcPcaVarWtsCtxStruct {
+// Small enough that a block of centered dosages stays resident alongside the
+// GEMM workspace for biobank-scale sample counts.
+CONSTI32(kLocoRidgeVariantBlockSize, 128);
+
+// Level-0 predictions are out-of-fold, since in-sample ridge predictions with
+// more allele columns than samples would absorb most of the phenotype.
+CONSTI32(kLocoRidgeFoldCt, 5);
+
+// Penalty grid, as multiples of the h2-derived lambda.  The out-of-fold
+// predictions double as the cross-validation for choosing among these, so the
+// grid costs only a few more 128x128 inversions per block.
+static const double kLocoRidgeLambdaMults[] = {0.0625, 0.25, 1.0, 4.0, 16.0};
+CONSTI32(kLocoRidgeLambdaCt, sizeof(kLocoRidgeLambdaMults) / sizeof(double));
+CONSTI32(kLocoRidgeLambdaDefaultIdx, 2);
+
+PglErr CalcLocoRidgePreds(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, const double* resid_pheno, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t max_allele_ct, double h2, uint32_t fold_seed, PgenReader* simple_pgrp, uint32_t* chr_fo_slots, uint32_t* loco_slot_ct_ptr, double** loco_preds_ptr) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  PglErr reterr = kPglRetSuccess;
+  {
+    // Level 0: ridge regression of the (standardized) phenotype on each block
+    // of kLocoRidgeVariantBlockSize variance-standardized allele columns
+    // within an autosome, with lambda = M(1 - h2) / h2 for M total allele
+    // columns times each kLocoRidgeLambdaMults[] entry.  Samples are assigned
+    // to kLocoRidgeFoldCt folds by a random permutation (seeded by fold_seed,
+    // so every phenotype sees the same folds), and each fold is predicted from
+    // a fit on the other folds.  Block predictions are summed per chromosome
+    // and penalty; each chromosome then keeps the penalty whose out-of-fold
+    // prediction has the highest R^2 against the phenotype.
+    // Level 1: for each left-out chromosome, the sum of the other
+    // chromosomes' predictions is rescaled by its least-squares coefficient
+    // against the phenotype, clamped to [0, 1].
+    const uint32_t chr_ct = cip->chr_ct;
+    uint32_t autosome_slot_ct = 0;
+    uintptr_t allele_col_ct = 0;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      const uint32_t chr_idx = cip->chr_file_order[chr_fo_idx];
+      chr_fo_slots[chr_fo_idx] = UINT32_MAX;
+      if ((!chr_idx) || (chr_idx > cip->autosome_ct) || IsSet(cip->haploid_mask, chr_idx)) {
+        continue;
+      }
+      const uint32_t variant_uidx_start = cip->chr_fo_vidx_start[chr_fo_idx];
+      const uint32_t variant_uidx_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+      const uint32_t cur_variant_ct = PopcountBitRange(variant_include, variant_uidx_start, variant_uidx_end);
+      if (!cur_variant_ct) {
+        continue;
+      }
+      allele_col_ct += cur_variant_ct;
+      if (allele_idx_offsets) {
+        uintptr_t variant_uidx_base;
+        uintptr_t cur_bits;
+        BitIter1Start(variant_include, variant_uidx_start, &variant_uidx_base, &cur_bits);
+        for (uint32_t uii = 0; uii != cur_variant_ct; ++uii) {
+          const uintptr_t variant_uidx = BitIter1(variant_include, &variant_uidx_base, &cur_bits);
+          const uint32_t cur_allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
+          if (cur_allele_ct != 2) {
+            // LoadMultiallelicCenteredVarmaj() emits one column per allele
+            allele_col_ct += cur_allele_ct - 1;
+          }
+        }
+      }
+      chr_fo_slots[chr_fo_idx] = autosome_slot_ct++;
+    }
+    if (unlikely(sample_ct < 2 * kLocoRidgeFoldCt)) {
+      logerrprintf("Error: --glm loco-ridge requires at least %u samples.\n", 2 * kLocoRidgeFoldCt);
+      goto CalcLocoRidgePreds_ret_DEGENERATE_DATA;
+    }
+    if (unlikely(!autosome_slot_ct)) {
+      logerrputs("Error: --glm loco-ridge requires at least one diploid autosomal variant.\n");
+      goto CalcLocoRidgePreds_ret_DEGENERATE_DATA;
+    }
+    // everything outside the autosomes uses the all-autosome prediction
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      if (chr_fo_slots[chr_fo_idx] == UINT32_MAX) {
+        chr_fo_slots[chr_fo_idx] = autosome_slot_ct;
+      }
+    }
+    const uint32_t slot_ct = autosome_slot_ct + 1;
+    double* loco_preds;
+    if (unlikely(bigstack_calloc_d(S_CAST(uintptr_t, slot_ct) * sample_ct, &loco_preds))) {
+      goto CalcLocoRidgePreds_ret_NOMEM;
+    }
+    unsigned char* bigstack_mark2 = g_bigstack_base;
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+    PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
+    double* allele_1copy_buf;
+    uint32_t* fold_perm;
+    double* yy;
+    double* yy_perm;
+    double* chr_preds;
+    double* lambda_preds;
+    double* normed_vmaj;
+    double* fold_vmaj;
+    double* xxt_all;
+    double* xty_all;
+    double* xxt_train;
+    double* xxt;
+    double* xty;
+    double* block_coefs;
+    MatrixInvertBuf1* mi_buf;
+    double* dbl_2d_buf;
+    if (unlikely(BigstackAllocPgv(sample_ct, allele_idx_offsets != nullptr, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
+                 bigstack_alloc_d(max_allele_ct, &allele_1copy_buf) ||
+                 bigstack_alloc_u32(sample_ct, &fold_perm) ||
+                 bigstack_alloc_d(sample_ct, &yy) ||
+                 bigstack_alloc_d(sample_ct, &yy_perm) ||
+                 bigstack_alloc_d(S_CAST(uintptr_t, autosome_slot_ct) * sample_ct, &chr_preds) ||
+                 bigstack_alloc_d(S_CAST(uintptr_t, kLocoRidgeLambdaCt) * sample_ct, &lambda_preds) ||
+                 bigstack_alloc_d(S_CAST(uintptr_t, kLocoRidgeVariantBlockSize) * sample_ct, &normed_vmaj) ||
+                 bigstack_alloc_d(S_CAST(uintptr_t, kLocoRidgeVariantBlockSize) * (1 + sample_ct / kLocoRidgeFoldCt), &fold_vmaj) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize * kLocoRidgeVariantBlockSize, &xxt_all) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize, &xty_all) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize * kLocoRidgeVariantBlockSize, &xxt_train) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize * kLocoRidgeVariantBlockSize, &xxt) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize, &xty) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize, &block_coefs) ||
+                 BIGSTACK_ALLOC_X(MatrixInvertBuf1, kLocoRidgeVariantBlockSize * kMatrixInvertBuf1CheckedAlloc, &mi_buf) ||
+                 bigstack_alloc_d(kLocoRidgeVariantBlockSize * kLocoRidgeVariantBlockSize, &dbl_2d_buf))) {
+      goto CalcLocoRidgePreds_ret_NOMEM;
+    }
+    double pheno_ssq = 0.0;
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      pheno_ssq += resid_pheno[sample_idx] * resid_pheno[sample_idx];
+    }
+    if (unlikely(!(pheno_ssq > kSmallEpsilon))) {
+      logerrputs("Error: --glm loco-ridge phenotype is constant after covariate adjustment.\n");
+      goto CalcLocoRidgePreds_ret_DEGENERATE_DATA;
+    }
+    const double pheno_stdev = sqrt(pheno_ssq / u31tod(sample_ct));
+    const double pheno_stdev_recip = 1.0 / pheno_stdev;
+    // Fisher-Yates shuffle; fold k is fold_perm[] positions [k * sample_ct /
+    // kLocoRidgeFoldCt, (k + 1) * sample_ct / kLocoRidgeFoldCt), and
+    // yy_perm[] and lambda_preds[] are in fold_perm[] order.
+    {
+      sfmt_t fold_sfmt;
+      sfmt_init_gen_rand(&fold_sfmt, fold_seed);
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        fold_perm[sample_idx] = sample_idx;
+      }
+      for (uint32_t sample_idx = sample_ct - 1; sample_idx; --sample_idx) {
+        const uint32_t swap_idx = (S_CAST(uint64_t, sfmt_genrand_uint32(&fold_sfmt)) * (sample_idx + 1)) >> 32;
+        const uint32_t tmp_idx = fold_perm[swap_idx];
+        fold_perm[swap_idx] = fold_perm[sample_idx];
+        fold_perm[sample_idx] = tmp_idx;
+      }
+    }
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      yy[sample_idx] = resid_pheno[sample_idx] * pheno_stdev_recip;
+    }
+    for (uint32_t perm_idx = 0; perm_idx != sample_ct; ++perm_idx) {
+      yy_perm[perm_idx] = yy[fold_perm[perm_idx]];
+    }
+    const double lambda_base = u63tod(allele_col_ct) * (1.0 - h2) / h2;
+    uint32_t lambda_chosen_cts[kLocoRidgeLambdaCt];
+    ZeroU32Arr(kLocoRidgeLambdaCt, lambda_chosen_cts);
+    PgrSampleSubsetIndex pssi;
+    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+    logprintf("--glm loco-ridge: Fitting %" PRIuPTR " allele column%s on %u autosome%s (lambda %g..%g)... ", allele_col_ct, (allele_col_ct == 1)? "" : "s", autosome_slot_ct, (autosome_slot_ct == 1)? "" : "s", lambda_base * kLocoRidgeLambdaMults[0], lambda_base * kLocoRidgeLambdaMults[kLocoRidgeLambdaCt - 1]);
+    fputs("0%", stdout);
+    fflush(stdout);
+    uintptr_t allele_cols_done = 0;
+    uint32_t pct = 0;
+    uintptr_t next_print_col_idx = allele_col_ct / 100;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != chr_ct; ++chr_fo_idx) {
+      const uint32_t slot_idx = chr_fo_slots[chr_fo_idx];
+      if (slot_idx == autosome_slot_ct) {
+        continue;
+      }
+      double* cur_chr_preds = &(chr_preds[S_CAST(uintptr_t, slot_idx) * sample_ct]);
+      const uint32_t variant_uidx_start = cip->chr_fo_vidx_start[chr_fo_idx];
+      const uint32_t cur_variant_ct = PopcountBitRange(variant_include, variant_uidx_start, cip->chr_fo_vidx_start[chr_fo_idx + 1]);
+      uint32_t variant_idx = 0;
+      uintptr_t variant_uidx = variant_uidx_start;
+      uintptr_t allele_idx_base = 0;
+      uint32_t cur_allele_ct = 2;
+      uint32_t incomplete_allele_idx = 0;
+      ZeroDArr(S_CAST(uintptr_t, kLocoRidgeLambdaCt) * sample_ct, lambda_preds);
+      do {
+        uint32_t cur_batch_size = kLocoRidgeVariantBlockSize;
+        reterr = LoadCenteredVarmajBlock(sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, 0, sample_ct, cur_variant_ct, simple_pgrp, normed_vmaj, nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
+        if (unlikely(reterr)) {
+          goto CalcLocoRidgePreds_ret_PGR_FAIL;
+        }
+        // beta = (X X^T + lambda I)^{-1} X y over the training samples, where
+        // X is row-major (allele column-major); the training-set products are
+        // the full-sample products minus the held-out fold's.
+        MultiplySelfTranspose(normed_vmaj, cur_batch_size, sample_ct, xxt_all);
+        RowMajorMatrixMultiply(normed_vmaj, yy, cur_batch_size, 1, sample_ct, xty_all);
+        const uintptr_t batch_sq = cur_batch_size * cur_batch_size;
+        for (uint32_t fold_idx = 0; fold_idx != kLocoRidgeFoldCt; ++fold_idx) {
+          const uint32_t fold_start = (fold_idx * S_CAST(uint64_t, sample_ct)) / kLocoRidgeFoldCt;
+          const uint32_t fold_size = (((fold_idx + 1) * S_CAST(uint64_t, sample_ct)) / kLocoRidgeFoldCt) - fold_start;
+          const uint32_t* fold_sample_idxs = &(fold_perm[fold_start]);
+          for (uint32_t uii = 0; uii != cur_batch_size; ++uii) {
+            const double* normed_row = &(normed_vmaj[uii * S_CAST(uintptr_t, sample_ct)]);
+            double* fold_row = &(fold_vmaj[uii * S_CAST(uintptr_t, fold_size)]);
+            for (uint32_t fold_sample_idx = 0; fold_sample_idx != fold_size; ++fold_sample_idx) {
+              fold_row[fold_sample_idx] = normed_row[fold_sample_idxs[fold_sample_idx]];
+            }
+          }
+          MultiplySelfTranspose(fold_vmaj, cur_batch_size, fold_size, xxt_train);
+          RowMajorMatrixMultiply(fold_vmaj, &(yy_perm[fold_start]), cur_batch_size, 1, fold_size, xty);
+          for (uintptr_t ulii = 0; ulii != batch_sq; ++ulii) {
+            xxt_train[ulii] = xxt_all[ulii] - xxt_train[ulii];
+          }
+          for (uint32_t uii = 0; uii != cur_batch_size; ++uii) {
+            xty[uii] = xty_all[uii] - xty[uii];
+          }
+          for (uint32_t lambda_idx = 0; lambda_idx != kLocoRidgeLambdaCt; ++lambda_idx) {
+            const double lambda = lambda_base * kLocoRidgeLambdaMults[lambda_idx];
+            memcpy(xxt, xxt_train, batch_sq * sizeof(double));
+            for (uint32_t uii = 0; uii != cur_batch_size; ++uii) {
+              xxt[uii * (cur_batch_size + 1)] += lambda;
+            }
+            if (unlikely(InvertSymmdefMatrix(cur_batch_size, xxt, mi_buf, dbl_2d_buf))) {
+              logputs("\n");
+              logerrputs("Error: --glm loco-ridge block matrix inversion failed.\n");
+              goto CalcLocoRidgePreds_ret_DEGENERATE_DATA;
+            }
+            ReflectMatrix(cur_batch_size, xxt);
+            RowMajorMatrixMultiply(xxt, xty, cur_batch_size, 1, cur_batch_size, block_coefs);
+            RowMajorMatrixMultiplyIncr(block_coefs, fold_vmaj, 1, fold_size, cur_batch_size, &(lambda_preds[lambda_idx * S_CAST(uintptr_t, sample_ct) + fold_start]));
+          }
+        }
+        allele_cols_done += cur_batch_size;
+        if (allele_cols_done >= next_print_col_idx) {
+          if (pct > 10) {
+            putc_unlocked('\b', stdout);
+          }
+          pct = (allele_cols_done * 100LLU) / allele_col_ct;
+          printf("\b\b%u%%", pct++);
+          fflush(stdout);
+          next_print_col_idx = (pct * S_CAST(uint64_t, allele_col_ct)) / 100;
+        }
+      } while (variant_idx != cur_variant_ct);
+      // Cross-validation: keep the penalty with the best out-of-fold R^2
+      // (under the nonnegative rescaling level 1 applies), falling back to the
+      // h2-derived lambda when no prediction correlates positively.
+      uint32_t best_lambda_idx = kLocoRidgeLambdaDefaultIdx;
+      double best_r2_numer = 0.0;
+      for (uint32_t lambda_idx = 0; lambda_idx != kLocoRidgeLambdaCt; ++lambda_idx) {
+        const double* cur_lambda_preds = &(lambda_preds[lambda_idx * S_CAST(uintptr_t, sample_ct)]);
+        const double pred_ssq = DotprodD(cur_lambda_preds, cur_lambda_preds, sample_ct);
+        const double pred_y_dotprod = DotprodD(cur_lambda_preds, yy_perm, sample_ct);
+        if ((pred_ssq > kSmallEpsilon) && (pred_y_dotprod > 0.0)) {
+          // R^2 = (p.y)^2 / ((p.p)(y.y)), and y.y is the same for every lambda
+          const double r2_numer = pred_y_dotprod * pred_y_dotprod / pred_ssq;
+          if (r2_numer > best_r2_numer) {
+            best_r2_numer = r2_numer;
+            best_lambda_idx = lambda_idx;
+          }
+        }
+      }
+      lambda_chosen_cts[best_lambda_idx] += 1;
+      const double* best_lambda_preds = &(lambda_preds[best_lambda_idx * S_CAST(uintptr_t, sample_ct)]);
+      for (uint32_t perm_idx = 0; perm_idx != sample_ct; ++perm_idx) {
+        cur_chr_preds[fold_perm[perm_idx]] = best_lambda_preds[perm_idx];
+      }
+    }
+    if (pct > 10) {
+      putc_unlocked('\b', stdout);
+    }
+    fputs("\b\b", stdout);
+    logputs("done.\n");
+    {
+      char* write_iter = strcpya_k(g_logbuf, "--glm loco-ridge: Cross-validated lambda");
+      char sep = ':';
+      for (uint32_t lambda_idx = 0; lambda_idx != kLocoRidgeLambdaCt; ++lambda_idx) {
+        const uint32_t chosen_ct = lambda_chosen_cts[lambda_idx];
+        if (chosen_ct) {
+          *write_iter++ = sep;
+          *write_iter++ = ' ';
+          sep = ',';
+          write_iter = dtoa_g(lambda_base * kLocoRidgeLambdaMults[lambda_idx], write_iter);
+          write_iter = strcpya_k(write_iter, " (");
+          write_iter = u32toa(chosen_ct, write_iter);
+          write_iter = strcpya_k(write_iter, " autosome");
+          if (chosen_ct != 1) {
+            *write_iter++ = 's';
+          }
+          *write_iter++ = ')';
+        }
+      }
+      strcpy_k(write_iter, ".\n");
+      WordWrapB(0);
+      logputsb();
+    }
+
+    // Level 1.  Row autosome_slot_ct of loco_preds temporarily holds the sum
+    // over all autosomes.
+    double* all_preds = &(loco_preds[S_CAST(uintptr_t, autosome_slot_ct) * sample_ct]);
+    for (uint32_t slot_idx = 0; slot_idx != autosome_slot_ct; ++slot_idx) {
+      const double* cur_chr_preds = &(chr_preds[S_CAST(uintptr_t, slot_idx) * sample_ct]);
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        all_preds[sample_idx] += cur_chr_preds[sample_idx];
+      }
+    }
+    for (uint32_t slot_idx = 0; slot_idx <= autosome_slot_ct; ++slot_idx) {
+      double* cur_loco_preds = &(loco_preds[S_CAST(uintptr_t, slot_idx) * sample_ct]);
+      if (slot_idx != autosome_slot_ct) {
+        const double* cur_chr_preds = &(chr_preds[S_CAST(uintptr_t, slot_idx) * sample_ct]);
+        for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+          cur_loco_preds[sample_idx] = all_preds[sample_idx] - cur_chr_preds[sample_idx];
+        }
+      }
+      const double pred_ssq = DotprodD(cur_loco_preds, cur_loco_preds, sample_ct);
+      double scale = 0.0;
+      if (pred_ssq > kSmallEpsilon) {
+        scale = DotprodD(cur_loco_preds, yy, sample_ct) / pred_ssq;
+        if (scale < 0.0) {
+          scale = 0.0;
+        } else if (scale > 1.0) {
+          scale = 1.0;
+        }
+      }
+      scale *= pheno_stdev;
+      for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+        cur_loco_preds[sample_idx] *= scale;
+      }
+    }
+    *loco_slot_ct_ptr = slot_ct;
+    *loco_preds_ptr = loco_preds;
+    BigstackReset(bigstack_mark2);
+  }
+  while (0) {
+  CalcLocoRidgePreds_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  CalcLocoRidgePreds_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  CalcLocoRidgePreds_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+  if (reterr) {
+    BigstackReset(bigstack_mark);
+  }
+  return reterr;
+}
+
+// .eigenvec.model layout (native byte order):
+//   8-byte magic, then uint32s pc_ct, variant_ct, row_ct, sample_ct, flags
+//   (bit 0 = haploid), and 4 bytes of padding;
+//   double eigvals[pc_ct], score_scales[pc_ct];
+//   then one record per variant: uint32 allele_ct, uint32 key_blen, the key
+//   (variant ID and allele codes, each null-terminated, zero-padded to a
+//   multiple of 8 bytes), double allele_freqs[allele_ct], and
+//   double loadings[row_ct][pc_ct], where row_ct is 1 for biallelic variants
+//   (ALT dosage) and allele_ct otherwise.
+// Loadings are in LoadCenteredVarmajBlock() units; a projection is the
+// loading-weighted sum of variance-standardized dosages times score_scales[].
+static const char kPcaModelMagic[8] = {'P', 'L', '2', 'P', 'C', 'A', 'M', 1};
+CONSTI32(kPcaModelHeaderSize, 32);
+
+// should be able to remove NOLAPACK later since we already have a non-LAPACK
+// SVD implementation
+#ifndef NOLAPACK
+// this seems to be better than 256 (due to avoidance of cache critical
+// stride?)
+// (still want this to be a multiple of 8, for cleaner multithreading)
+CONSTI32(kPcaVariantBlockSize, 240);
+
+typedef struct CalcPcaCtxStruct {
   uint32_t sample_ct;
   uint32_t pc_ct;
 
-  double* sample_wts_smaj;
-
   double* yy_bufs[2];
 
   uint32_t cur_batch_size;
 
-  double* var_wts;
-} CalcPcaVarWtsCtx;
+  double* g1;
+  double* qq;
+  double** y_transpose_bufs;
+  double** g2_bb_part_bufs;
+} CalcPcaCtx;
 
-THREAD_FUNC_DECL CalcPcaVarWtsThread(void* raw_arg) {
+THREAD_FUNC_DECL CalcPcaXtxaThread(void* raw_arg) {
   ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
   const uintptr_t tidx = arg->tidx;
-  CalcPcaVarWtsCtx* ctx = S_CAST(CalcPcaVarWtsCtx*, arg->sharedp->context);
+  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
 
   const uint32_t sample_ct = ctx->sample_ct;
-  const uint32_t pc_ct = ctx->pc_ct;
+  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
+  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
   const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
-
-  // either first batch size is calc_thread_ct * kPcaVariantBlockSize, or there
-  // is only one batch
-  const uintptr_t var_wts_part_size = S_CAST(uintptr_t, pc_ct) * ctx->cur_batch_size;
-
-  const double* sample_wts = ctx->sample_wts_smaj;  // sample-major, pc_ct columns
+  const double* g1 = ctx->g1;
+  double* qq_iter = ctx->qq;
+  double* y_transpose_buf = ctx->y_transpose_bufs[tidx];
+  double* g2_part_buf = ctx->g2_bb_part_bufs[tidx];
   uint32_t parity = 0;
   do {
     const uint32_t cur_batch_size = ctx->cur_batch_size;
@@ -4680,8 +5676,162 @@ THREAD_FUNC_DECL CalcPcaVarWtsThread(void* raw_arg) {
         cur_thread_batch_size = kPcaVariantBlockSize;
       }
       const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
-      // Variant weight matrix = X^T * S * D^{-1/2}, where X^T is the
-      // variance-standardized genotype matrix, S is the sample weight matrix,
+      double* cur_qq = &(qq_iter[vidx_offset * qq_col_ct]);
+      RowMajorMatrixMultiplyStrided(yy_buf, g1, cur_thread_batch_size, sample_ct, pc_ct_x2, pc_ct_x2, sample_ct, qq_col_ct, cur_qq);
+      MatrixTransposeCopy(yy_buf, cur_thread_batch_size, sample_ct, y_transpose_buf);
+      RowMajorMatrixMultiplyStridedIncr(y_transpose_buf, cur_qq, sample_ct, cur_thread_batch_size, pc_ct_x2, qq_col_ct, cur_thread_batch_size, pc_ct_x2, g2_part_buf);
+      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+THREAD_FUNC_DECL CalcPcaXaThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
+
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
+  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
+  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
+  const double* g1 = ctx->g1;
+  double* qq_iter = ctx->qq;
+  uint32_t parity = 0;
+  do {
+    const uint32_t cur_batch_size = ctx->cur_batch_size;
+    if (vidx_offset < cur_batch_size) {
+      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
+      if (cur_thread_batch_size > kPcaVariantBlockSize) {
+        cur_thread_batch_size = kPcaVariantBlockSize;
+      }
+      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
+      double* cur_qq = &(qq_iter[vidx_offset * qq_col_ct]);
+      RowMajorMatrixMultiplyStrided(yy_buf, g1, cur_thread_batch_size, sample_ct, pc_ct_x2, pc_ct_x2, sample_ct, qq_col_ct, cur_qq);
+      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+THREAD_FUNC_DECL CalcPcaXtbThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  CalcPcaCtx* ctx = S_CAST(CalcPcaCtx*, arg->sharedp->context);
+
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t pc_ct_x2 = ctx->pc_ct * 2;
+  const uintptr_t qq_col_ct = (ctx->pc_ct + 1) * pc_ct_x2;
+  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
+  const double* qq_iter = &(ctx->qq[vidx_offset * qq_col_ct]);
+  double* y_transpose_buf = ctx->y_transpose_bufs[tidx];
+  double* bb_part_buf = ctx->g2_bb_part_bufs[tidx];
+  uint32_t parity = 0;
+  do {
+    const uint32_t cur_batch_size = ctx->cur_batch_size;
+    if (vidx_offset < cur_batch_size) {
+      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
+      if (cur_thread_batch_size > kPcaVariantBlockSize) {
+        cur_thread_batch_size = kPcaVariantBlockSize;
+      }
+      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
+      MatrixTransposeCopy(yy_buf, cur_thread_batch_size, sample_ct, y_transpose_buf);
+      RowMajorMatrixMultiplyIncr(y_transpose_buf, qq_iter, sample_ct, qq_col_ct, cur_thread_batch_size, bb_part_buf);
+      qq_iter = &(qq_iter[cur_batch_size * qq_col_ct]);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+// Streaming subspace iteration: unlike the Krylov path above, the per-variant
+// projections are discarded after each block, so memory use is independent of
+// variant count.
+typedef struct CalcPcaStreamCtxStruct {
+  uint32_t sample_ct;
+  uint32_t block_size;
+
+  double* yy_bufs[2];
+
+  uint32_t cur_batch_size;
+
+  double* qq;
+  double** y_transpose_bufs;
+  double** yq_bufs;
+  double** hh_part_bufs;
+} CalcPcaStreamCtx;
+
+THREAD_FUNC_DECL CalcPcaStreamThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  CalcPcaStreamCtx* ctx = S_CAST(CalcPcaStreamCtx*, arg->sharedp->context);
+
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t block_size = ctx->block_size;
+  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
+  const double* qq = ctx->qq;
+  double* y_transpose_buf = ctx->y_transpose_bufs[tidx];
+  double* yq_buf = ctx->yq_bufs[tidx];
+  double* hh_part_buf = ctx->hh_part_bufs[tidx];
+  uint32_t parity = 0;
+  do {
+    const uint32_t cur_batch_size = ctx->cur_batch_size;
+    if (vidx_offset < cur_batch_size) {
+      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
+      if (cur_thread_batch_size > kPcaVariantBlockSize) {
+        cur_thread_batch_size = kPcaVariantBlockSize;
+      }
+      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
+      // hh_part += Y^T (Y Q)
+      RowMajorMatrixMultiply(yy_buf, qq, cur_thread_batch_size, block_size, sample_ct, yq_buf);
+      MatrixTransposeCopy(yy_buf, cur_thread_batch_size, sample_ct, y_transpose_buf);
+      RowMajorMatrixMultiplyIncr(y_transpose_buf, yq_buf, sample_ct, block_size, cur_thread_batch_size, hh_part_buf);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+typedef struct CalcPcaVarWtsCtxStruct {
+  uint32_t sample_ct;
+  uint32_t pc_ct;
+
+  double* sample_wts_smaj;
+
+  double* yy_bufs[2];
+
+  uint32_t cur_batch_size;
+
+  double* var_wts;
+} CalcPcaVarWtsCtx;
+
+THREAD_FUNC_DECL CalcPcaVarWtsThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  const uintptr_t tidx = arg->tidx;
+  CalcPcaVarWtsCtx* ctx = S_CAST(CalcPcaVarWtsCtx*, arg->sharedp->context);
+
+  const uint32_t sample_ct = ctx->sample_ct;
+  const uint32_t pc_ct = ctx->pc_ct;
+  const uint32_t vidx_offset = tidx * kPcaVariantBlockSize;
+
+  // either first batch size is calc_thread_ct * kPcaVariantBlockSize, or there
+  // is only one batch
+  const uintptr_t var_wts_part_size = S_CAST(uintptr_t, pc_ct) * ctx->cur_batch_size;
+
+  const double* sample_wts = ctx->sample_wts_smaj;  // sample-major, pc_ct columns
+  uint32_t parity = 0;
+  do {
+    const uint32_t cur_batch_size = ctx->cur_batch_size;
+    if (vidx_offset < cur_batch_size) {
+      uint32_t cur_thread_batch_size = cur_batch_size - vidx_offset;
+      if (cur_thread_batch_size > kPcaVariantBlockSize) {
+        cur_thread_batch_size = kPcaVariantBlockSize;
+      }
+      const double* yy_buf = &(ctx->yy_bufs[parity][S_CAST(uintptr_t, vidx_offset) * sample_ct]);
+      // Variant weight matrix = X^T * S * D^{-1/2}, where X^T is the
+      // variance-standardized genotype matrix, S is the sample weight matrix,
       // and D is a diagonal eigenvalue matrix.
       // We postpone the D^{-1/2} part for now, but it's straightforward to
       // switch to using precomputed (S * D^{-1/2}).
@@ -4928,9 +6078,79 @@ PglErr FlushAlleleWts(const uintptr_t* variant_include, const ChrInfo* cip, cons
   return kPglRetSuccess;
 }
 
-PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* maj_alleles, const double* allele_freqs, uint32_t raw_sample_ct, uintptr_t pca_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t pc_ct, PcaFlags pca_flags, uint32_t max_thread_ct, PgenReader* simple_pgrp, sfmt_t* sfmtp, double* grm, char* outname, char* outname_end) {
+// Appends the model records covering the next batch_size loading rows.  A
+// variant's key and frequencies are written when its first row is reached,
+// since multiallelic variants can straddle batches.
+PglErr FlushPcaModelRows(const uintptr_t* variant_include, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const double* allele_freqs, const double* var_wts_iter, uint32_t batch_size, uint32_t pc_ct, FILE* modelfile, char* key_buf, double* freq_buf, double* wts_sumsq, uint32_t* variant_idxp, uintptr_t* variant_uidxp, uint32_t* cur_allele_ctp, uint32_t* row_idxp) {
+  uint32_t variant_idx = *variant_idxp;
+  uintptr_t variant_uidx = *variant_uidxp;
+  uint32_t cur_allele_ct = *cur_allele_ctp;
+  uint32_t row_idx = *row_idxp;
+  for (uint32_t bidx = 0; bidx != batch_size; ) {
+    if (!row_idx) {
+      variant_uidx = AdvTo1Bit(variant_include, variant_uidx);
+      uintptr_t allele_idx_offset_base = variant_uidx * 2;
+      if (allele_idx_offsets) {
+        allele_idx_offset_base = allele_idx_offsets[variant_uidx];
+        cur_allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
+      }
+      const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+      char* key_iter = strcpyax(key_buf, variant_ids[variant_uidx], '\0');
+      for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct; ++allele_idx) {
+        key_iter = strcpyax(key_iter, cur_alleles[allele_idx], '\0');
+      }
+      const uint32_t key_blen = RoundUpPow2(S_CAST(uintptr_t, key_iter - key_buf), 8);
+      memset(key_iter, 0, key_blen - S_CAST(uintptr_t, key_iter - key_buf));
+      const double* cur_allele_freqs = &(allele_freqs[allele_idx_offset_base - variant_uidx]);
+      const uint32_t cur_allele_ct_m1 = cur_allele_ct - 1;
+      double last_freq = 1.0;
+      for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct_m1; ++allele_idx) {
+        freq_buf[allele_idx] = cur_allele_freqs[allele_idx];
+        last_freq -= cur_allele_freqs[allele_idx];
+      }
+      freq_buf[cur_allele_ct_m1] = last_freq;
+      const uint32_t record_header[2] = {cur_allele_ct, key_blen};
+      if (unlikely(fwrite_checked(record_header, 2 * sizeof(int32_t), modelfile) ||
+                   fwrite_checked(key_buf, key_blen, modelfile) ||
+                   fwrite_checked(freq_buf, cur_allele_ct * sizeof(double), modelfile))) {
+        return kPglRetWriteFail;
+      }
+    }
+    const uint32_t row_ct = (cur_allele_ct == 2)? 1 : cur_allele_ct;
+    uint32_t row_stop = row_idx + batch_size - bidx;
+    if (row_stop > row_ct) {
+      row_stop = row_ct;
+    }
+    const uint32_t cur_row_ct = row_stop - row_idx;
+    if (unlikely(fwrite_checked(var_wts_iter, S_CAST(uintptr_t, cur_row_ct) * pc_ct * sizeof(double), modelfile))) {
+      return kPglRetWriteFail;
+    }
+    for (uint32_t uii = 0; uii != cur_row_ct; ++uii) {
+      for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+        const double cur_wt = *var_wts_iter++;
+        wts_sumsq[pc_idx] += cur_wt * cur_wt;
+      }
+    }
+    bidx += cur_row_ct;
+    if (row_stop == row_ct) {
+      row_idx = 0;
+      ++variant_idx;
+      ++variant_uidx;
+    } else {
+      row_idx = row_stop;
+    }
+  }
+  *variant_idxp = variant_idx;
+  *variant_uidxp = variant_uidx;
+  *cur_allele_ctp = cur_allele_ct;
+  *row_idxp = row_idx;
+  return kPglRetSuccess;
+}
+
+PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* maj_alleles, const double* allele_freqs, uint32_t raw_sample_ct, uintptr_t pca_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t pc_ct, PcaFlags pca_flags, uint32_t pca_iter_ct, uint32_t pca_block_size, uint32_t max_thread_ct, PgenReader* simple_pgrp, sfmt_t* sfmtp, double* grm, char* outname, char* outname_end) {
   unsigned char* bigstack_mark = g_bigstack_base;
   FILE* outfile = nullptr;
+  FILE* modelfile = nullptr;
   char* cswritep = nullptr;
   CompressStreamState css;
   ThreadGroup tg;
@@ -4945,6 +6165,8 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
     const uintptr_t max_sid_blen = siip->max_sid_blen;
     const uint32_t write_sid = SidColIsRequired(sids, pca_flags / kfPcaScolMaybesid);
     const uint32_t is_approx = (pca_flags / kfPcaApprox) & 1;
+    const uint32_t is_stream = (pca_flags / kfPcaStream) & 1;
+    const char* flag_suffix = is_stream? " stream" : (is_approx? " approx" : "");
     reterr = ConditionalAllocateNonAutosomalVariants(cip, is_approx? "PCA approximation" : "PCA", raw_variant_ct, &variant_include, &variant_ct);
     if (unlikely(reterr)) {
       goto CalcPca_ret_1;
@@ -4968,14 +6190,19 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
       // minor update (alpha 3): just error out here instead of trying to
       // auto-adjust PC count, number of .eigenvec output columns should be
       // easily predictable
-      logerrprintf("Error: Too few samples to compute %u PCs with \"--pca approx\".\n", pc_ct);
+      logerrprintf("Error: Too few samples to compute %u PCs with \"--pca%s\".\n", pc_ct, flag_suffix);
       goto CalcPca_ret_DEGENERATE_DATA;
     }
-    const uint32_t wts_requested = ((pca_flags & (kfPcaAlleleWts | kfPcaBiallelicVarWts)) != 0);
+    const uint32_t text_wts_requested = ((pca_flags & (kfPcaAlleleWts | kfPcaBiallelicVarWts)) != 0);
+    const uint32_t write_model = (pca_flags / kfPcaModel) & 1;
+    const uint32_t wts_requested = text_wts_requested || write_model;
     const uint32_t biallelic_variant_ct = CountBiallelicVariants(variant_include, allele_idx_offsets, variant_ct);
     double* cur_var_wts = nullptr;
     double* eigval_inv_sqrts = nullptr;
     char* chr_buf = nullptr;
+    char* model_key_buf = nullptr;
+    double* model_freq_buf = nullptr;
+    double* model_wts_sumsq = nullptr;
     uintptr_t overflow_buf_size = 3 * kMaxMediumLine;
     if (wts_requested) {
       if (pca_flags & kfPcaBiallelicVarWts) {
@@ -4988,6 +6215,13 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
                    bigstack_alloc_d(pc_ct, &eigval_inv_sqrts))) {
         goto CalcPca_ret_NOMEM;
       }
+      if (write_model) {
+        if (unlikely(bigstack_alloc_c(kMaxIdSlen + 8 + max_allele_ct * S_CAST(uintptr_t, max_allele_slen + 1), &model_key_buf) ||
+                     bigstack_alloc_d(max_allele_ct, &model_freq_buf) ||
+                     bigstack_calloc_d(pc_ct, &model_wts_sumsq))) {
+          goto CalcPca_ret_NOMEM;
+        }
+      }
       uint32_t max_chr_blen = 0;
       if (pca_flags & kfPcaVcolChrom) {
         max_chr_blen = GetMaxChrSlen(cip) + 1;
@@ -5010,11 +6244,16 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
     const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
     uint32_t* pca_sample_include_cumulative_popcounts;
     PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
     double* allele_1copy_buf;
     double* eigvals;
     CalcPcaCtx ctx;
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
     if (unlikely(bigstack_alloc_u32(raw_sample_ctl, &pca_sample_include_cumulative_popcounts) ||
                  BigstackAllocPgv(pca_sample_ct, allele_idx_offsets != nullptr, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
                  bigstack_alloc_d(max_allele_ct, &allele_1copy_buf) ||
                  bigstack_alloc_d(pc_ct, &eigvals) ||
                  SetThreadCt(calc_thread_ct, &tg))) {
@@ -5031,70 +6270,87 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
     double* qq = nullptr;
     double* eigvecs_smaj;
     char* writebuf;
-    if (is_approx) {
+    if (is_stream) {
       if (pca_sample_ct <= 5000) {
-        logerrputs("Warning: \"--pca approx\" is only recommended for analysis of >5000 samples.\n");
-      }
-      if (pca_row_ct > 5000000) {
-        logerrputs("Warning: Use of \"--pca approx\" on >5m rows is not advisable.  Apply a MAF\nfilter if you haven't done so yet, and consider LD-pruning your variant set as\nwell.\n");
+        logerrputs("Warning: \"--pca stream\" is only recommended for analysis of >5000 samples.\n");
+      }
+      // Randomized subspace iteration (Halko N, Martinsson P, Tropp J (2011)
+      // Finding Structure with Randomness, algorithm 4.4) with a
+      // Rayleigh-Ritz step after every pass.  Only the sample-side basis is
+      // retained between passes, so unlike the Krylov path, memory usage is
+      // O(sample_ct * block_size) no matter how many variants there are.
+      if (unlikely(pc_ct > pca_row_ct)) {
+        logerrprintf("Error: Too few variants to compute %u PCs with \"--pca stream\".\n", pc_ct);
+        goto CalcPca_ret_DEGENERATE_DATA;
       }
-      // This is ported from EIGENSOFT 6 src/ksrc/kjg_fpca.c , which is in turn
-      // primarily based on Halko N, Martinsson P, Shkolnisky Y, Tygert M
-      // (2011) An Algorithm for the Principal Component Analysis of Large Data
-      // Sets.
-      const uintptr_t pc_ct_x2 = pc_ct * 2;
-      const uintptr_t qq_col_ct = (pc_ct + 1) * pc_ct_x2;
-      // bugfix (30 Jan 2019): First SvdRect() call returns min(variant_ct,
-      // qq_col_ct) singular vectors; this was previously assumed to always be
-      // qq_col_ct, and very inaccurate results were produced when the
-      // assumption wasn't true.
-      // Simplest solution is to force the user to request fewer PCs, since the
-      // final PCs wouldn't be accurate anyway.
-      if (qq_col_ct > variant_ct) {
-        logerrprintfww("Error: Too few variants to compute %u PCs with \"--pca approx\" (%u required).\n", pc_ct, qq_col_ct);
+      uint32_t block_size = pca_block_size;
+      if (!block_size) {
+        block_size = MAXV(2 * pc_ct, pc_ct + 10);
+        if (block_size > pca_sample_ct) {
+          block_size = pca_sample_ct;
+        }
+        if (block_size > pca_row_ct) {
+          block_size = pca_row_ct;
+        }
+      } else if (unlikely((block_size > pca_sample_ct) || (block_size > pca_row_ct))) {
+        logerrputs("Error: --pca block-size= value cannot exceed the number of samples or variants.\n");
         goto CalcPca_ret_DEGENERATE_DATA;
       }
+      const uintptr_t basis_size = pca_sample_ct * block_size;
 #ifndef LAPACK_ILP64
-      if (unlikely((pca_row_ct * S_CAST(uint64_t, qq_col_ct)) > 0x7effffff)) {
-        logerrputs("Error: \"--pca approx\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
+      if (unlikely(basis_size > 0x7effffff)) {
+        logerrputs("Error: \"--pca stream\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
         goto CalcPca_ret_INCONSISTENT_INPUT;
       }
 #endif
       const double variant_ct_recip = 1.0 / u31tod(variant_ct);
-
-      const uintptr_t gg_size = pca_sample_ct * pc_ct_x2;
       __CLPK_integer svd_rect_lwork;
-#ifdef LAPACK_ILP64
-      GetSvdRectLwork(MAXV(pca_sample_ct, pca_row_ct), qq_col_ct, &svd_rect_lwork);
-#else
-      if (unlikely(GetSvdRectLwork(MAXV(pca_sample_ct, pca_row_ct), qq_col_ct, &svd_rect_lwork))) {
-        logerrputs("Error: \"--pca approx\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
+      if (unlikely(GetSvdRectLwork(pca_sample_ct, block_size, &svd_rect_lwork))) {
+        logerrputs("Error: \"--pca stream\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
         goto CalcPca_ret_INCONSISTENT_INPUT;
       }
-#endif
-      uintptr_t svd_rect_wkspace_size = (svd_rect_lwork + qq_col_ct * qq_col_ct) * sizeof(double);
-      if (svd_rect_wkspace_size < writebuf_alloc) {
+      __CLPK_integer eig_lwork;
+      __CLPK_integer eig_liwork;
+      uintptr_t lapack_wkspace_size;
+      if (unlikely(GetExtractEigvecsLworks(block_size, pc_ct, &eig_lwork, &eig_liwork, &lapack_wkspace_size))) {
+        goto CalcPca_ret_NOMEM;
+      }
+      const uintptr_t svd_rect_wkspace_size = (svd_rect_lwork + S_CAST(uintptr_t, block_size) * block_size) * sizeof(double);
+      if (lapack_wkspace_size < svd_rect_wkspace_size) {
+        lapack_wkspace_size = svd_rect_wkspace_size;
+      }
+      if (lapack_wkspace_size < writebuf_alloc) {
         // used as writebuf later
-        svd_rect_wkspace_size = writebuf_alloc;
+        lapack_wkspace_size = writebuf_alloc;
       }
-
-      unsigned char* svd_rect_wkspace;
+      const uintptr_t small_size = S_CAST(uintptr_t, block_size) * block_size;
+      CalcPcaStreamCtx sctx;
+      unsigned char* lapack_wkspace;
       double* ss;
-      double* g1;
-      if (unlikely(bigstack_alloc_d(qq_col_ct, &ss) ||
-                   bigstack_alloc_d(pca_row_ct * qq_col_ct, &qq) ||
-                   bigstack_alloc_dp(calc_thread_ct, &ctx.y_transpose_bufs) ||
-                   bigstack_alloc_dp(calc_thread_ct, &ctx.g2_bb_part_bufs) ||
-                   bigstack_alloc_uc(svd_rect_wkspace_size, &svd_rect_wkspace) ||
-                   bigstack_alloc_d(gg_size, &g1))) {
+      double* hh;
+      double* tt;
+      double* hth;
+      double* reverse_ritz_vecs;
+      // FillGaussianDArr() fills an even number of entries; bigstack
+      // allocations are rounded up to a cacheline, so the extra entry for odd
+      // basis_size is still in bounds.
+      if (unlikely(bigstack_alloc_d(block_size, &ss) ||
+                   bigstack_alloc_d(basis_size, &sctx.qq) ||
+                   bigstack_alloc_d(basis_size, &hh) ||
+                   bigstack_alloc_d(small_size, &tt) ||
+                   bigstack_alloc_d(small_size, &hth) ||
+                   bigstack_alloc_d(pc_ct * S_CAST(uintptr_t, block_size), &reverse_ritz_vecs) ||
+                   bigstack_alloc_dp(calc_thread_ct, &sctx.y_transpose_bufs) ||
+                   bigstack_alloc_dp(calc_thread_ct, &sctx.yq_bufs) ||
+                   bigstack_alloc_dp(calc_thread_ct, &sctx.hh_part_bufs) ||
+                   bigstack_alloc_uc(lapack_wkspace_size, &lapack_wkspace))) {
         goto CalcPca_ret_NOMEM;
       }
+      double* qq_basis = sctx.qq;
       const uintptr_t yy_alloc_incr = RoundUpPow2(kPcaVariantBlockSize * pca_sample_ct * sizeof(double), kCacheline);
-      const uintptr_t b_size = pca_sample_ct * qq_col_ct;
-      const uintptr_t g2_bb_part_alloc = RoundUpPow2(b_size * sizeof(double), kCacheline);
-      // bugfix (16 Jan 2020)
-      const uintptr_t per_thread_alloc = 3 * yy_alloc_incr + g2_bb_part_alloc;
-
+      const uintptr_t yq_alloc = RoundUpPow2(kPcaVariantBlockSize * block_size * sizeof(double), kCacheline);
+      const uintptr_t hh_part_alloc = RoundUpPow2(basis_size * sizeof(double), kCacheline);
+      const uintptr_t per_thread_alloc = 3 * yy_alloc_incr + yq_alloc + hh_part_alloc;
       const uintptr_t bigstack_avail = bigstack_left();
       if (per_thread_alloc * calc_thread_ct > bigstack_avail) {
         if (unlikely(bigstack_avail < per_thread_alloc)) {
@@ -5103,43 +6359,40 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         calc_thread_ct = bigstack_avail / per_thread_alloc;
       }
       const uintptr_t yy_main_alloc = RoundUpPow2(kPcaVariantBlockSize * calc_thread_ct * pca_sample_ct * sizeof(double), kCacheline);
-      ctx.yy_bufs[0] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
-      ctx.yy_bufs[1] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
+      sctx.yy_bufs[0] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
+      sctx.yy_bufs[1] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
       for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
-        ctx.y_transpose_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(yy_alloc_incr));
-        ctx.g2_bb_part_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(g2_bb_part_alloc));
+        sctx.y_transpose_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(yy_alloc_incr));
+        sctx.yq_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(yq_alloc));
+        sctx.hh_part_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(hh_part_alloc));
+      }
+      sctx.sample_ct = pca_sample_ct;
+      sctx.block_size = block_size;
+      FillGaussianDArr((basis_size + 1) / 2, max_thread_ct, sfmtp, qq_basis);
+      BLAS_SET_NUM_THREADS(max_thread_ct);
+      IntErr svd_rect_err = SvdRect(pca_sample_ct, block_size, svd_rect_lwork, qq_basis, ss, lapack_wkspace);
+      BLAS_SET_NUM_THREADS(1);
+      if (unlikely(svd_rect_err)) {
+        snprintf(g_logbuf, kLogbufSize, "Error: Failed to orthonormalize random starting matrix (DGESVD info=%d).\n", S_CAST(int32_t, svd_rect_err));
+        goto CalcPca_ret_DEGENERATE_DATA_2;
       }
-      FillGaussianDArr(gg_size / 2, max_thread_ct, sfmtp, g1);
-      ctx.g1 = g1;
 #ifdef __APPLE__
-      fputs("Projecting random vectors... ", stdout);
+      logprintf("--pca stream: block size %u, %u power iteration%s.\n", block_size, pca_iter_ct, (pca_iter_ct == 1)? "" : "s");
 #else
-      printf("Projecting random vectors (%u compute thread%s)... ", calc_thread_ct, (calc_thread_ct == 1)? "" : "s");
+      logprintf("--pca stream: block size %u, %u power iteration%s, %u compute thread%s.\n", block_size, pca_iter_ct, (pca_iter_ct == 1)? "" : "s", calc_thread_ct, (calc_thread_ct == 1)? "" : "s");
 #endif
-      fflush(stdout);
-      for (uint32_t iter_idx = 0; iter_idx <= pc_ct; ++iter_idx) {
-        // kjg_fpca_XTXA(), kjg_fpca_XA()
-        if (iter_idx < pc_ct) {
-          SetThreadFuncAndData(CalcPcaXtxaThread, &ctx, &tg);
-        } else {
-          SetThreadFuncAndData(CalcPcaXaThread, &ctx, &tg);
-        }
+      const uint32_t pass_ct = pca_iter_ct + 1;
+      double max_rel_resid = 0.0;
+      uint32_t max_rel_resid_pc_idx = 0;
+      for (uint32_t pass_idx = 0; pass_idx != pass_ct; ++pass_idx) {
+        SetThreadFuncAndData(CalcPcaStreamThread, &sctx, &tg);
         for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
-          ZeroDArr(gg_size, ctx.g2_bb_part_bufs[tidx]);
+          ZeroDArr(basis_size, sctx.hh_part_bufs[tidx]);
         }
-        double* qq_iter = &(qq[iter_idx * pc_ct_x2]);  // offset on first row
-        ctx.qq = qq_iter;
-
-        // Main workflow:
-        // 1. Set n=0, load batch 0
-        //
-        // 2. Spawn threads processing batch n
-        // 3. Increment n by 1
-        // 4. Load batch n unless eof
-        // 5. Join threads
-        // 6. Goto step 2 unless eof
-        //
-        // 7. Assemble next g1 by summing g2_parts
+        printf("--pca stream: pass %u/%u...", pass_idx + 1, pass_ct);
+        fflush(stdout);
+        // Same double-buffered workflow as the Krylov path: block n+1 is
+        // loaded while the compute threads process block n.
         uint32_t cur_batch_size = calc_thread_ct * kPcaVariantBlockSize;
         uint32_t variant_idx = 0;
         uintptr_t variant_uidx = 0;
@@ -5149,7 +6402,237 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         uint32_t is_not_first_block = 0;
         while (1) {
           if (!IsLastBlock(&tg)) {
-            reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, ctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, allele_1copy_buf);
+            reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, sctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
+            if (unlikely(reterr)) {
+              if (pass_idx) {
+                goto CalcPca_ret_REWIND_FAIL;
+              }
+              goto CalcPca_ret_PGR_FAIL;
+            }
+          }
+          if (is_not_first_block) {
+            JoinThreads(&tg);
+            if (IsLastBlock(&tg)) {
+              break;
+            }
+          }
+          sctx.cur_batch_size = cur_batch_size;
+          if (variant_idx == variant_ct) {
+            DeclareLastThreadBlock(&tg);
+            cur_batch_size = 0;
+          }
+          if (unlikely(SpawnThreads(&tg))) {
+            goto CalcPca_ret_THREAD_CREATE_FAIL;
+          }
+          is_not_first_block = 1;
+          parity = 1 - parity;
+        }
+        memcpy(hh, sctx.hh_part_bufs[0], basis_size * sizeof(double));
+        for (uint32_t tidx = 1; tidx != calc_thread_ct; ++tidx) {
+          const double* cur_hh_part = sctx.hh_part_bufs[tidx];
+          for (uintptr_t ulii = 0; ulii != basis_size; ++ulii) {
+            hh[ulii] += cur_hh_part[ulii];
+          }
+        }
+        for (uintptr_t ulii = 0; ulii != basis_size; ++ulii) {
+          hh[ulii] *= variant_ct_recip;
+        }
+
+        // Rayleigh-Ritz: with H = AQ, the Ritz pairs are the eigenpairs
+        // (lambda, w) of T = Q^T H, and the residual ||AQw - lambda Qw||^2
+        // equals w^T (H^T H) w - lambda^2 since Q is orthonormal.
+        // hh_part_bufs[0] is free until the next pass, so it's used for the
+        // transposes.
+        double* transpose_buf = sctx.hh_part_bufs[0];
+        BLAS_SET_NUM_THREADS(max_thread_ct);
+        MatrixTransposeCopy(qq_basis, pca_sample_ct, block_size, transpose_buf);
+        RowMajorMatrixMultiply(transpose_buf, hh, block_size, block_size, pca_sample_ct, tt);
+        MatrixTransposeCopy(hh, pca_sample_ct, block_size, transpose_buf);
+        RowMajorMatrixMultiply(transpose_buf, hh, block_size, block_size, pca_sample_ct, hth);
+        if (unlikely(ExtractEigvecs(block_size, pc_ct, eig_lwork, eig_liwork, tt, eigvals, reverse_ritz_vecs, lapack_wkspace))) {
+          logputs("\n");
+          logerrputs("Error: Failed to extract Ritz vectors in \"--pca stream\" pass.\n");
+          goto CalcPca_ret_DEGENERATE_DATA;
+        }
+        max_rel_resid = 0.0;
+        max_rel_resid_pc_idx = 0;
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+          const uint32_t rev_idx = pc_ct - 1 - pc_idx;
+          const double cur_eigval = eigvals[rev_idx];
+          const double* cur_ritz_vec = &(reverse_ritz_vecs[rev_idx * S_CAST(uintptr_t, block_size)]);
+          double quad = 0.0;
+          for (uint32_t uii = 0; uii != block_size; ++uii) {
+            quad += cur_ritz_vec[uii] * DotprodD(&(hth[uii * S_CAST(uintptr_t, block_size)]), cur_ritz_vec, block_size);
+          }
+          double rel_resid = 1.0;
+          if (cur_eigval > 0.0) {
+            const double rel_resid_sq = quad / (cur_eigval * cur_eigval) - 1.0;
+            rel_resid = (rel_resid_sq > 0.0)? sqrt(rel_resid_sq) : 0.0;
+          }
+          if (rel_resid > max_rel_resid) {
+            max_rel_resid = rel_resid;
+            max_rel_resid_pc_idx = pc_idx;
+          }
+        }
+        if (pass_idx + 1 != pass_ct) {
+          memcpy(qq_basis, hh, basis_size * sizeof(double));
+          svd_rect_err = SvdRect(pca_sample_ct, block_size, svd_rect_lwork, qq_basis, ss, lapack_wkspace);
+          if (unlikely(svd_rect_err)) {
+            logputs("\n");
+            snprintf(g_logbuf, kLogbufSize, "Error: Failed to orthonormalize subspace (DGESVD info=%d).\n", S_CAST(int32_t, svd_rect_err));
+            goto CalcPca_ret_DEGENERATE_DATA_2;
+          }
+        }
+        BLAS_SET_NUM_THREADS(1);
+        putc_unlocked('\r', stdout);
+        logprintf("--pca stream: pass %u/%u, max relative residual %g (PC%u).\n", pass_idx + 1, pass_ct, max_rel_resid, max_rel_resid_pc_idx + 1);
+      }
+      if (max_rel_resid > 0.01) {
+        logerrputs("Warning: \"--pca stream\" has not fully converged.  Consider increasing iters=\nand/or block-size=.\n");
+      }
+      // eigvals[] and reverse_ritz_vecs[] are in increasing-eigenvalue order;
+      // eigenvectors are Q times the Ritz vectors, which we assemble into a
+      // (block_size x pc_ct) matrix in hth[].
+      const uint32_t pc_ct_m1 = pc_ct - 1;
+      const uint32_t pc_ct_div2 = pc_ct / 2;
+      for (uint32_t pc_idx = 0; pc_idx != pc_ct_div2; ++pc_idx) {
+        double tmp_eigval = eigvals[pc_idx];
+        eigvals[pc_idx] = eigvals[pc_ct_m1 - pc_idx];
+        eigvals[pc_ct_m1 - pc_idx] = tmp_eigval;
+      }
+      for (uint32_t uii = 0; uii != block_size; ++uii) {
+        double* wmat_row = &(hth[uii * S_CAST(uintptr_t, pc_ct)]);
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+          wmat_row[pc_idx] = reverse_ritz_vecs[(pc_ct_m1 - pc_idx) * S_CAST(uintptr_t, block_size) + uii];
+        }
+      }
+      eigvecs_smaj = hh;
+      RowMajorMatrixMultiply(qq_basis, hth, pca_sample_ct, pc_ct, block_size, eigvecs_smaj);
+      if (is_haploid) {
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+          eigvals[pc_idx] *= 0.5;
+        }
+      }
+      writebuf = R_CAST(char*, lapack_wkspace);
+    } else if (is_approx) {
+      if (pca_sample_ct <= 5000) {
+        logerrputs("Warning: \"--pca approx\" is only recommended for analysis of >5000 samples.\n");
+      }
+      if (pca_row_ct > 5000000) {
+        logerrputs("Warning: Use of \"--pca approx\" on >5m rows is not advisable.  Apply a MAF\nfilter if you haven't done so yet, and consider LD-pruning your variant set as\nwell.\n");
+      }
+      // This is ported from EIGENSOFT 6 src/ksrc/kjg_fpca.c , which is in turn
+      // primarily based on Halko N, Martinsson P, Shkolnisky Y, Tygert M
+      // (2011) An Algorithm for the Principal Component Analysis of Large Data
+      // Sets.
+      const uintptr_t pc_ct_x2 = pc_ct * 2;
+      const uintptr_t qq_col_ct = (pc_ct + 1) * pc_ct_x2;
+      // bugfix (30 Jan 2019): First SvdRect() call returns min(variant_ct,
+      // qq_col_ct) singular vectors; this was previously assumed to always be
+      // qq_col_ct, and very inaccurate results were produced when the
+      // assumption wasn't true.
+      // Simplest solution is to force the user to request fewer PCs, since the
+      // final PCs wouldn't be accurate anyway.
+      if (qq_col_ct > variant_ct) {
+        logerrprintfww("Error: Too few variants to compute %u PCs with \"--pca approx\" (%u required).\n", pc_ct, qq_col_ct);
+        goto CalcPca_ret_DEGENERATE_DATA;
+      }
+#ifndef LAPACK_ILP64
+      if (unlikely((pca_row_ct * S_CAST(uint64_t, qq_col_ct)) > 0x7effffff)) {
+        logerrputs("Error: \"--pca approx\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
+        goto CalcPca_ret_INCONSISTENT_INPUT;
+      }
+#endif
+      const double variant_ct_recip = 1.0 / u31tod(variant_ct);
+
+      const uintptr_t gg_size = pca_sample_ct * pc_ct_x2;
+      __CLPK_integer svd_rect_lwork;
+#ifdef LAPACK_ILP64
+      GetSvdRectLwork(MAXV(pca_sample_ct, pca_row_ct), qq_col_ct, &svd_rect_lwork);
+#else
+      if (unlikely(GetSvdRectLwork(MAXV(pca_sample_ct, pca_row_ct), qq_col_ct, &svd_rect_lwork))) {
+        logerrputs("Error: \"--pca approx\" problem instance too large for this " PROG_NAME_STR " build.  If\nthis is really the computation you want, use a " PROG_NAME_STR " build with large-matrix\nsupport.\n");
+        goto CalcPca_ret_INCONSISTENT_INPUT;
+      }
+#endif
+      uintptr_t svd_rect_wkspace_size = (svd_rect_lwork + qq_col_ct * qq_col_ct) * sizeof(double);
+      if (svd_rect_wkspace_size < writebuf_alloc) {
+        // used as writebuf later
+        svd_rect_wkspace_size = writebuf_alloc;
+      }
+
+      unsigned char* svd_rect_wkspace;
+      double* ss;
+      double* g1;
+      if (unlikely(bigstack_alloc_d(qq_col_ct, &ss) ||
+                   bigstack_alloc_d(pca_row_ct * qq_col_ct, &qq) ||
+                   bigstack_alloc_dp(calc_thread_ct, &ctx.y_transpose_bufs) ||
+                   bigstack_alloc_dp(calc_thread_ct, &ctx.g2_bb_part_bufs) ||
+                   bigstack_alloc_uc(svd_rect_wkspace_size, &svd_rect_wkspace) ||
+                   bigstack_alloc_d(gg_size, &g1))) {
+        goto CalcPca_ret_NOMEM;
+      }
+      const uintptr_t yy_alloc_incr = RoundUpPow2(kPcaVariantBlockSize * pca_sample_ct * sizeof(double), kCacheline);
+      const uintptr_t b_size = pca_sample_ct * qq_col_ct;
+      const uintptr_t g2_bb_part_alloc = RoundUpPow2(b_size * sizeof(double), kCacheline);
+      // bugfix (16 Jan 2020)
+      const uintptr_t per_thread_alloc = 3 * yy_alloc_incr + g2_bb_part_alloc;
+
+      const uintptr_t bigstack_avail = bigstack_left();
+      if (per_thread_alloc * calc_thread_ct > bigstack_avail) {
+        if (unlikely(bigstack_avail < per_thread_alloc)) {
+          goto CalcPca_ret_NOMEM;
+        }
+        calc_thread_ct = bigstack_avail / per_thread_alloc;
+      }
+      const uintptr_t yy_main_alloc = RoundUpPow2(kPcaVariantBlockSize * calc_thread_ct * pca_sample_ct * sizeof(double), kCacheline);
+      ctx.yy_bufs[0] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
+      ctx.yy_bufs[1] = S_CAST(double*, bigstack_alloc_raw(yy_main_alloc));
+      for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+        ctx.y_transpose_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(yy_alloc_incr));
+        ctx.g2_bb_part_bufs[tidx] = S_CAST(double*, bigstack_alloc_raw(g2_bb_part_alloc));
+      }
+      FillGaussianDArr(gg_size / 2, max_thread_ct, sfmtp, g1);
+      ctx.g1 = g1;
+#ifdef __APPLE__
+      fputs("Projecting random vectors... ", stdout);
+#else
+      printf("Projecting random vectors (%u compute thread%s)... ", calc_thread_ct, (calc_thread_ct == 1)? "" : "s");
+#endif
+      fflush(stdout);
+      for (uint32_t iter_idx = 0; iter_idx <= pc_ct; ++iter_idx) {
+        // kjg_fpca_XTXA(), kjg_fpca_XA()
+        if (iter_idx < pc_ct) {
+          SetThreadFuncAndData(CalcPcaXtxaThread, &ctx, &tg);
+        } else {
+          SetThreadFuncAndData(CalcPcaXaThread, &ctx, &tg);
+        }
+        for (uint32_t tidx = 0; tidx != calc_thread_ct; ++tidx) {
+          ZeroDArr(gg_size, ctx.g2_bb_part_bufs[tidx]);
+        }
+        double* qq_iter = &(qq[iter_idx * pc_ct_x2]);  // offset on first row
+        ctx.qq = qq_iter;
+
+        // Main workflow:
+        // 1. Set n=0, load batch 0
+        //
+        // 2. Spawn threads processing batch n
+        // 3. Increment n by 1
+        // 4. Load batch n unless eof
+        // 5. Join threads
+        // 6. Goto step 2 unless eof
+        //
+        // 7. Assemble next g1 by summing g2_parts
+        uint32_t cur_batch_size = calc_thread_ct * kPcaVariantBlockSize;
+        uint32_t variant_idx = 0;
+        uintptr_t variant_uidx = 0;
+        uintptr_t allele_idx_base = 0;
+        uint32_t incomplete_allele_idx = 0;
+        uint32_t parity = 0;
+        uint32_t is_not_first_block = 0;
+        while (1) {
+          if (!IsLastBlock(&tg)) {
+            reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, ctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
             if (unlikely(reterr)) {
               goto CalcPca_ret_PGR_FAIL;
             }
@@ -5219,7 +6702,7 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
       uint32_t is_not_first_block = 0;
       while (1) {
         if (!IsLastBlock(&tg)) {
-          reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, ctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, allele_1copy_buf);
+          reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, ctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
           if (unlikely(reterr)) {
             // this error *didn't* happen on an earlier pass, so assign blame
             // to I/O instead
@@ -5341,52 +6824,68 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
 
       const uint32_t allele_wts = (pca_flags / kfPcaAlleleWts) & 1;
       const uint32_t output_zst = (pca_flags / kfPcaVarZs) & 1;
-      if (allele_wts) {
-        OutnameZstSet(".eigenvec.allele", output_zst, outname_end);
-      } else {
-        OutnameZstSet(".eigenvec.var", output_zst, outname_end);
-      }
-      reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, writebuf, R_CAST(unsigned char*, &(writebuf[overflow_buf_size])), &css);
-      if (unlikely(reterr)) {
-        goto CalcPca_ret_1;
-      }
-      cswritep = writebuf;
-      *cswritep++ = '#';
-      if (chr_buf) {
-        cswritep = strcpya_k(cswritep, "CHROM\t");
-      }
-      if (pca_flags & kfPcaVcolPos) {
-        cswritep = strcpya_k(cswritep, "POS\t");
-      } else {
-        variant_bps = nullptr;
-      }
-      cswritep = strcpya_k(cswritep, "ID");
-      if (pca_flags & kfPcaVcolRef) {
-        cswritep = strcpya_k(cswritep, "\tREF");
-      }
-      if (pca_flags & kfPcaVcolAlt1) {
-        cswritep = strcpya_k(cswritep, "\tALT1");
-      }
-      if (pca_flags & kfPcaVcolAlt) {
-        cswritep = strcpya_k(cswritep, "\tALT");
-      }
-      if (allele_wts) {
-        cswritep = strcpya_k(cswritep, "\tA1");
-      }
-      if (pca_flags & kfPcaVcolAx) {
-        cswritep = strcpya_k(cswritep, "\tAX");
-      }
-      if (pca_flags & kfPcaVcolMaj) {
-        cswritep = strcpya_k(cswritep, "\tMAJ");
-      }
-      if (pca_flags & kfPcaVcolNonmaj) {
-        cswritep = strcpya_k(cswritep, "\tNONMAJ");
-      }
-      for (uint32_t pc_idx = 1; pc_idx <= pc_ct; ++pc_idx) {
-        cswritep = strcpya_k(cswritep, "\tPC");
-        cswritep = u32toa(pc_idx, cswritep);
+      if (write_model) {
+        snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenvec.model");
+        if (unlikely(fopen_checked(outname, FOPEN_WB, &modelfile))) {
+          goto CalcPca_ret_OPEN_FAIL;
+        }
+        // score_scales[] is filled in after all the loadings are known
+        const uint32_t model_header[6] = {pc_ct, variant_ct, S_CAST(uint32_t, pca_row_ct), S_CAST(uint32_t, pca_sample_ct), is_haploid, 0};
+        if (unlikely(fwrite_checked(kPcaModelMagic, 8, modelfile) ||
+                     fwrite_checked(model_header, 6 * sizeof(int32_t), modelfile) ||
+                     fwrite_checked(eigvals, pc_ct * sizeof(double), modelfile) ||
+                     fwrite_checked(model_wts_sumsq, pc_ct * sizeof(double), modelfile))) {
+          goto CalcPca_ret_WRITE_FAIL;
+        }
+      }
+      if (text_wts_requested) {
+        if (allele_wts) {
+          OutnameZstSet(".eigenvec.allele", output_zst, outname_end);
+        } else {
+          OutnameZstSet(".eigenvec.var", output_zst, outname_end);
+        }
+        reterr = InitCstream(outname, 0, output_zst, max_thread_ct, overflow_buf_size, writebuf, R_CAST(unsigned char*, &(writebuf[overflow_buf_size])), &css);
+        if (unlikely(reterr)) {
+          goto CalcPca_ret_1;
+        }
+        cswritep = writebuf;
+        *cswritep++ = '#';
+        if (chr_buf) {
+          cswritep = strcpya_k(cswritep, "CHROM\t");
+        }
+        if (pca_flags & kfPcaVcolPos) {
+          cswritep = strcpya_k(cswritep, "POS\t");
+        } else {
+          variant_bps = nullptr;
+        }
+        cswritep = strcpya_k(cswritep, "ID");
+        if (pca_flags & kfPcaVcolRef) {
+          cswritep = strcpya_k(cswritep, "\tREF");
+        }
+        if (pca_flags & kfPcaVcolAlt1) {
+          cswritep = strcpya_k(cswritep, "\tALT1");
+        }
+        if (pca_flags & kfPcaVcolAlt) {
+          cswritep = strcpya_k(cswritep, "\tALT");
+        }
+        if (allele_wts) {
+          cswritep = strcpya_k(cswritep, "\tA1");
+        }
+        if (pca_flags & kfPcaVcolAx) {
+          cswritep = strcpya_k(cswritep, "\tAX");
+        }
+        if (pca_flags & kfPcaVcolMaj) {
+          cswritep = strcpya_k(cswritep, "\tMAJ");
+        }
+        if (pca_flags & kfPcaVcolNonmaj) {
+          cswritep = strcpya_k(cswritep, "\tNONMAJ");
+        }
+        for (uint32_t pc_idx = 1; pc_idx <= pc_ct; ++pc_idx) {
+          cswritep = strcpya_k(cswritep, "\tPC");
+          cswritep = u32toa(pc_idx, cswritep);
+        }
+        AppendBinaryEoln(&cswritep);
       }
-      AppendBinaryEoln(&cswritep);
 
       // Main workflow:
       // 1. Set n=0, load batch 0
@@ -5413,13 +6912,14 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
         vwctx.yy_bufs[1] = ctx.yy_bufs[1];
         vwctx.var_wts = ctx.qq;
       } else {
-        // non-approximate PCA, some buffers have not been allocated yet
+        // non-approximate or streaming PCA, some buffers have not been
+        // allocated yet
 
         // if grm[] (which we no longer need) has at least as much remaining
         // space as bigstack, allocate from grm
         unsigned char* arena_bottom = R_CAST(unsigned char*, grm);
         unsigned char* arena_top = bigstack_mark;
-        uintptr_t arena_avail = arena_top - arena_bottom;
+        uintptr_t arena_avail = grm? S_CAST(uintptr_t, arena_top - arena_bottom) : 0;
         if (arena_avail < bigstack_left()) {
           arena_bottom = g_bigstack_base;
           arena_top = g_bigstack_end;
@@ -5469,11 +6969,16 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
       uint32_t chr_end = 0;
       uint32_t chr_buf_blen = 0;
 
+      uint32_t variant_idx_model = 0;
+      uintptr_t variant_uidx_model = 0;
+      uint32_t cur_allele_ct_model = 2;
+      uint32_t row_idx_model = 0;
+
       uint32_t parity = 0;
       uint32_t is_not_first_block = 0;
       while (1) {
         if (!IsLastBlock(&tg)) {
-          reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, vwctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx_load, &variant_uidx_load, &allele_idx_base_load, &cur_allele_ct_load, &incomplete_allele_idx_load, &pgv, allele_1copy_buf);
+          reterr = LoadCenteredVarmajBlock(pca_sample_include, pssi, variant_include, allele_idx_offsets, allele_freqs, 1, is_haploid, pca_sample_ct, variant_ct, simple_pgrp, vwctx.yy_bufs[parity], nullptr, &cur_batch_size, &variant_idx_load, &variant_uidx_load, &allele_idx_base_load, &cur_allele_ct_load, &incomplete_allele_idx_load, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
           if (unlikely(reterr)) {
             goto CalcPca_ret_PGR_FAIL;
           }
@@ -5495,9 +7000,18 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
           // write *previous* block results
           const double* var_wts_iter = &(var_wts[parity * var_wts_part_size]);
           // (todo: update projection here)
+          if (write_model) {
+            reterr = FlushPcaModelRows(variant_include, variant_ids, allele_idx_offsets, allele_storage, allele_freqs, var_wts_iter, prev_batch_size, pc_ct, modelfile, model_key_buf, model_freq_buf, model_wts_sumsq, &variant_idx_model, &variant_uidx_model, &cur_allele_ct_model, &row_idx_model);
+            if (unlikely(reterr)) {
+              goto CalcPca_ret_WRITE_FAIL;
+            }
+            if (!text_wts_requested) {
+              variant_idx_write = variant_idx_model;
+            }
+          }
           if (allele_wts) {
             reterr = FlushAlleleWts(variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, var_wts_iter, eigval_inv_sqrts, prev_batch_size, pc_ct, pca_flags, &css, &cswritep, chr_buf, &variant_idx_write, &variant_uidx_write, &allele_idx_offset_write, &cur_allele_ct, &incomplete_allele_idx_write, &chr_fo_idx, &chr_end, &chr_buf_blen);
-          } else {
+          } else if (text_wts_requested) {
             reterr = FlushBiallelicVarWts(variant_include, cip, variant_bps, variant_ids, allele_idx_offsets, allele_storage, maj_alleles, var_wts_iter, eigval_inv_sqrts, prev_batch_size, pc_ct, pca_flags, &css, &cswritep, chr_buf, &variant_idx_write, &variant_uidx_write, &chr_fo_idx, &chr_end, &chr_buf_blen);
           }
           if (unlikely(reterr)) {
@@ -5508,19 +7022,616 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
             break;
           }
         }
-        is_not_first_block = 1;
-        prev_batch_size = cur_batch_size;
+        is_not_first_block = 1;
+        prev_batch_size = cur_batch_size;
+      }
+      if (text_wts_requested) {
+        if (unlikely(CswriteCloseNull(&css, cswritep))) {
+          goto CalcPca_ret_WRITE_FAIL;
+        }
+        logprintfww("--pca%s: %s weights written to %s .\n", flag_suffix, allele_wts? "Allele" : "Variant", outname);
+      }
+      if (write_model) {
+        // score_scales[j] = 1 / sum of squared PC j loadings, so that the
+        // reference samples project back onto their own eigenvectors.
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+          model_wts_sumsq[pc_idx] = 1.0 / model_wts_sumsq[pc_idx];
+        }
+        if (unlikely(fseeko(modelfile, kPcaModelHeaderSize + pc_ct * sizeof(double), SEEK_SET) ||
+                     fwrite_checked(model_wts_sumsq, pc_ct * sizeof(double), modelfile) ||
+                     fclose_null(&modelfile))) {
+          goto CalcPca_ret_WRITE_FAIL;
+        }
+        snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenvec.model");
+        logprintfww("--pca%s: Projection model written to %s .\n", flag_suffix, outname);
+      }
+    }
+
+    snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenvec");
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
+      goto CalcPca_ret_OPEN_FAIL;
+    }
+    char* write_iter = writebuf;
+    *write_iter++ = '#';
+    if (write_fid) {
+      write_iter = strcpya_k(write_iter, "FID\t");
+    }
+    write_iter = strcpya_k(write_iter, "IID");
+    if (write_sid) {
+      write_iter = strcpya_k(write_iter, "\tSID");
+    }
+    for (uint32_t pc_idx = 1; pc_idx <= pc_ct; ++pc_idx) {
+      write_iter = strcpya_k(write_iter, "\tPC");
+      write_iter = u32toa(pc_idx, write_iter);
+    }
+    AppendBinaryEoln(&write_iter);
+    const uint32_t sample_ct = pca_sample_ct;
+    uintptr_t sample_uidx_base = 0;
+    uintptr_t sample_include_bits = sample_include[0];
+    for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+      const uintptr_t sample_uidx = BitIter1(sample_include, &sample_uidx_base, &sample_include_bits);
+      const char* cur_sample_id = &(sample_ids[max_sample_id_blen * sample_uidx]);
+      if (!write_fid) {
+        cur_sample_id = AdvPastDelim(cur_sample_id, '\t');
+      }
+      write_iter = strcpya(write_iter, cur_sample_id);
+      if (write_sid) {
+        *write_iter++ = '\t';
+        if (sids) {
+          write_iter = strcpya(write_iter, &(sids[max_sid_blen * sample_uidx]));
+        } else {
+          *write_iter++ = '0';
+        }
+      }
+      double* sample_wts_iter = &(eigvecs_smaj[sample_idx * pc_ct]);
+      // todo: read from proj_sample_wts instead when pca_sample_include bit
+      // not set
+      for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+        *write_iter++ = '\t';
+        write_iter = dtoa_g(*sample_wts_iter++, write_iter);
+      }
+      AppendBinaryEoln(&write_iter);
+      if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+        goto CalcPca_ret_WRITE_FAIL;
+      }
+    }
+    if (unlikely(fclose_flush_null(writebuf_flush, write_iter, &outfile))) {
+      goto CalcPca_ret_WRITE_FAIL;
+    }
+
+    snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenval");
+    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
+      goto CalcPca_ret_OPEN_FAIL;
+    }
+    write_iter = writebuf;
+    for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+      write_iter = dtoa_g(eigvals[pc_idx], write_iter);
+      AppendBinaryEoln(&write_iter);
+    }
+    if (unlikely(fclose_flush_null(writebuf_flush, write_iter, &outfile))) {
+      goto CalcPca_ret_WRITE_FAIL;
+    }
+    *outname_end = '\0';
+    logprintfww("--pca%s: Eigenvector%s written to %s.eigenvec , and eigenvalue%s written to %s.eigenval .\n", flag_suffix, (pc_ct == 1)? "" : "s", outname, (pc_ct == 1)? "" : "s", outname);
+  }
+  while (0) {
+  CalcPca_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  CalcPca_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  CalcPca_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
+    break;
+  CalcPca_ret_REWIND_FAIL:
+    logerrprintfww(kErrprintfRewind, ".pgen file");
+    break;
+  CalcPca_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  CalcPca_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  CalcPca_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
+    break;
+  CalcPca_ret_DEGENERATE_DATA_2:
+    logerrputsb();
+  CalcPca_ret_DEGENERATE_DATA:
+    reterr = kPglRetDegenerateData;
+    break;
+  }
+ CalcPca_ret_1:
+  CleanupThreads(&tg);
+  BLAS_SET_NUM_THREADS(1);
+  CswriteCloseCond(&css, cswritep);
+  fclose_cond(outfile);
+  fclose_cond(modelfile);
+  if (grm) {
+    // nothing after --pca in the plink2 order of operations uses grm[]
+    BigstackReset(grm);
+  } else {
+    BigstackReset(bigstack_mark);
+  }
+  return reterr;
+}
+#endif
+
+// to test: do we actually want cur_dosage_ints to be uint64_t* instead of
+// uint32_t*?
+// also, should this be moved to plink2_common?
+void FillCurDdosageInts(const uintptr_t* genovec_buf, const uintptr_t* dosage_present, const Dosage* dosage_main_buf, uint32_t sample_ct, uint32_t dosage_ct, uint32_t is_diploid_p1, uint64_t* cur_ddosage_ints) {
+  uint64_t lookup_table[32] ALIGNV16;
+  lookup_table[0] = 0;
+  lookup_table[2] = is_diploid_p1 * kDosageMid;
+  lookup_table[4] = is_diploid_p1 * kDosageMax;
+  lookup_table[6] = 0;
+  InitLookup16x8bx2(lookup_table);
+  GenoarrLookup16x8bx2(genovec_buf, lookup_table, sample_ct, cur_ddosage_ints);
+  if (!dosage_ct) {
+    return;
+  }
+  uintptr_t sample_idx_base = 0;
+  uintptr_t cur_bits = dosage_present[0];
+  for (uint32_t dosage_idx = 0; dosage_idx != dosage_ct; ++dosage_idx) {
+    const uintptr_t sample_idx = BitIter1(dosage_present, &sample_idx_base, &cur_bits);
+    cur_ddosage_ints[sample_idx] = dosage_main_buf[dosage_idx] * is_diploid_p1;
+  }
+}
+
+CONSTI32(kScoreVariantBlockSize, 240);
+
+// Hardcall-only variants whose nonreference calls fit in a difflist of at most
+// sample_ct / kScoreDifflistDivisor entries bypass the dense matrix multiply.
+CONSTI32(kScoreDifflistDivisor, 32);
+
+// Adds one hardcall-only difflist variant's contributions to sparse_scores
+// and ddosage_sums.  score_coefs has stride kScoreVariantBlockSize.  Missing
+// calls go through the usual missing_bitvec -> missing_accx path when
+// is_new_variant is set; VerticalCounterUpdate() is skipped when there are
+// none, since it's a no-op for an all-zero vector.
+void ScoreDifflistUpdate(const uintptr_t* raregeno, const uint32_t* difflist_sample_ids, const double* score_coefs, uint32_t difflist_len, uint32_t score_final_col_ct, uint32_t sample_ct, uint32_t model_dominant, uint32_t domrec, uint32_t se_mode, uint32_t is_new_variant, double geno_slope, double missing_effect, uint64_t* ddosage_sums, double* sparse_scores, uintptr_t* missing_bitvec, uint32_t* variant_ct_rems, VecW* missing_accx) {
+  const uint32_t acc1_vec_ct = BitCtToVecCt(sample_ct);
+  uint32_t missing_ct = 0;
+  for (uint32_t difflist_idx = 0; difflist_idx != difflist_len; ++difflist_idx) {
+    const uint32_t sample_idx = difflist_sample_ids[difflist_idx];
+    const uintptr_t cur_geno = GetNyparrEntry(raregeno, difflist_idx);
+    double cur_val;
+    if (cur_geno == 3) {
+      if (!missing_ct) {
+        ZeroWArr(acc1_vec_ct * kWordsPerVec, missing_bitvec);
+      }
+      SetBit(sample_idx, missing_bitvec);
+      ++missing_ct;
+      cur_val = missing_effect;
+    } else {
+      uint64_t cur_ddosage_incr = cur_geno * kDosageMax;
+      if (model_dominant) {
+        if (cur_ddosage_incr > kDosageMax) {
+          cur_ddosage_incr = kDosageMax;
+        }
+      } else if (domrec) {
+        cur_ddosage_incr = (cur_ddosage_incr > kDosageMax)? (cur_ddosage_incr - kDosageMax) : 0;
+      }
+      ddosage_sums[sample_idx] += cur_ddosage_incr;
+      cur_val = u63tod(cur_ddosage_incr) * geno_slope;
+    }
+    if (se_mode) {
+      cur_val *= cur_val;
+    }
+    const double* coef_iter = score_coefs;
+    double* sparse_scores_iter = &(sparse_scores[sample_idx]);
+    for (uint32_t score_final_col_idx = 0; score_final_col_idx != score_final_col_ct; ++score_final_col_idx) {
+      double cur_coef = *coef_iter;
+      if (se_mode) {
+        cur_coef *= cur_coef;
+      }
+      *sparse_scores_iter += cur_coef * cur_val;
+      coef_iter = &(coef_iter[kScoreVariantBlockSize]);
+      sparse_scores_iter = &(sparse_scores_iter[sample_ct]);
+    }
+  }
+  if (missing_ct && is_new_variant) {
+    VerticalCounterUpdate(missing_bitvec, acc1_vec_ct, variant_ct_rems, missing_accx);
+  }
+}
+
+typedef struct CalcScoreCtxStruct {
+  uint32_t score_final_col_ct;
+  uint32_t sample_ct;
+
+  double* dosages_vmaj[2];
+  double* score_coefs_cmaj[2];
+
+  uint32_t cur_batch_size;
+
+  double* final_scores_cmaj;
+} CalcScoreCtx;
+
+THREAD_FUNC_DECL CalcScoreThread(void* raw_arg) {
+  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
+  // don't bother to explicitly multithread for now
+  assert(!arg->tidx);
+  CalcScoreCtx* ctx = S_CAST(CalcScoreCtx*, arg->sharedp->context);
+
+  double* final_scores_cmaj = ctx->final_scores_cmaj;
+  const uint32_t score_final_col_ct = ctx->score_final_col_ct;
+  const uint32_t sample_ct = ctx->sample_ct;
+  uint32_t parity = 0;
+  do {
+    const uint32_t cur_batch_size = ctx->cur_batch_size;
+    if (cur_batch_size) {
+      RowMajorMatrixMultiplyStridedIncr(ctx->score_coefs_cmaj[parity], ctx->dosages_vmaj[parity], score_final_col_ct, kScoreVariantBlockSize, sample_ct, sample_ct, cur_batch_size, sample_ct, final_scores_cmaj);
+    }
+    parity = 1 - parity;
+  } while (!THREAD_BLOCK_FINISH(arg));
+  THREAD_RETURN;
+}
+
+PglErr PcaProject(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const char* model_fname, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_variant_id_slen, PcaProjFlags flags, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  FILE* infile = nullptr;
+  FILE* outfile = nullptr;
+  ThreadGroup tg;
+  PreinitThreads(&tg);
+  PglErr reterr = kPglRetSuccess;
+  {
+    if (unlikely(fopen_checked(model_fname, FOPEN_RB, &infile))) {
+      goto PcaProject_ret_OPEN_FAIL;
+    }
+    if (unlikely(fseeko(infile, 0, SEEK_END))) {
+      goto PcaProject_ret_READ_FAIL;
+    }
+    const uint64_t fsize = ftello(infile);
+    rewind(infile);
+    char magic[8];
+    uint32_t model_header[6];
+    if (unlikely((fsize < S_CAST(uint64_t, kPcaModelHeaderSize)) ||
+                 fread_checked(magic, 8, infile) ||
+                 fread_checked(model_header, 6 * sizeof(int32_t), infile) ||
+                 (!memequal(magic, kPcaModelMagic, 8)))) {
+      goto PcaProject_ret_MALFORMED_HEADER;
+    }
+    const uint32_t pc_ct = model_header[0];
+    const uint32_t model_variant_ct = model_header[1];
+    const uint32_t model_row_ct = model_header[2];
+    const uint32_t model_sample_ct = model_header[3];
+    const uint32_t model_is_haploid = model_header[4] & 1;
+    if (unlikely((!pc_ct) || (!model_variant_ct) || (model_row_ct < model_variant_ct) || (!model_sample_ct) || (fsize < kPcaModelHeaderSize + 2 * sizeof(double) * S_CAST(uint64_t, pc_ct)))) {
+      goto PcaProject_ret_MALFORMED_HEADER;
+    }
+    const uint32_t is_haploid = cip->haploid_mask[0] & 1;
+    if (unlikely(is_haploid != model_is_haploid)) {
+      logerrprintfww("Error: --pca-project model was computed from %s data, but the current dataset is %s.\n", model_is_haploid? "haploid" : "diploid", is_haploid? "haploid" : "diploid");
+      goto PcaProject_ret_INCONSISTENT_INPUT;
+    }
+    const uintptr_t body_size = fsize - kPcaModelHeaderSize - 2 * sizeof(double) * pc_ct;
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    uintptr_t raw_allele_ct = 2 * raw_variant_ct;
+    if (allele_idx_offsets) {
+      raw_allele_ct = allele_idx_offsets[raw_variant_ct];
+    }
+    const uintptr_t loading_row_size = pc_ct * sizeof(double);
+    double* model_eigvals;
+    double* score_scales;
+    double* model_body;
+    double* proj_allele_freqs;
+    uintptr_t* proj_variant_include;
+    uintptr_t* loading_offsets;
+    uint32_t* allele_perm;
+    double* row_buf;
+    double* matched_sumsq;
+    if (unlikely(bigstack_alloc_d(pc_ct, &model_eigvals) ||
+                 bigstack_alloc_d(pc_ct, &score_scales) ||
+                 bigstack_alloc_d(body_size / sizeof(double) + 1, &model_body) ||
+                 bigstack_alloc_d(raw_allele_ct - raw_variant_ct, &proj_allele_freqs) ||
+                 bigstack_calloc_w(raw_variant_ctl, &proj_variant_include) ||
+                 bigstack_alloc_w(raw_variant_ct, &loading_offsets) ||
+                 bigstack_alloc_u32(max_allele_ct, &allele_perm) ||
+                 bigstack_alloc_d(max_allele_ct * pc_ct, &row_buf) ||
+                 bigstack_calloc_d(pc_ct, &matched_sumsq))) {
+      goto PcaProject_ret_NOMEM;
+    }
+    if (unlikely(fread_checked(model_eigvals, loading_row_size, infile) ||
+                 fread_checked(score_scales, loading_row_size, infile) ||
+                 fread_checked(model_body, body_size, infile))) {
+      goto PcaProject_ret_READ_FAIL;
+    }
+    if (unlikely(fclose_null(&infile))) {
+      goto PcaProject_ret_READ_FAIL;
+    }
+
+    uint32_t* variant_id_htable = nullptr;
+    uint32_t variant_id_htable_size;
+    reterr = AllocAndPopulateIdHtableMt(variant_include, variant_ids, variant_ct, 0, max_thread_ct, &variant_id_htable, nullptr, &variant_id_htable_size, nullptr);
+    if (unlikely(reterr)) {
+      goto PcaProject_ret_1;
+    }
+    // Match model records to the current dataset by variant ID, then bring
+    // each matched record into the dataset's allele order in place.
+    const unsigned char* body_iter = R_CAST(const unsigned char*, model_body);
+    const unsigned char* body_end = &(body_iter[body_size]);
+    uint32_t proj_variant_ct = 0;
+    uintptr_t proj_row_ct = 0;
+    uint32_t missing_var_id_ct = 0;
+    uint32_t duplicated_var_id_ct = 0;
+    uint32_t allele_mismatch_ct = 0;
+    uint32_t monomorphic_ct = 0;
+    for (uint32_t model_variant_idx = 0; model_variant_idx != model_variant_ct; ++model_variant_idx) {
+      if (unlikely(S_CAST(uintptr_t, body_end - body_iter) < 2 * sizeof(int32_t))) {
+        goto PcaProject_ret_MALFORMED_BODY;
+      }
+      uint32_t record_header[2];
+      memcpy(record_header, body_iter, 2 * sizeof(int32_t));
+      body_iter = &(body_iter[2 * sizeof(int32_t)]);
+      const uint32_t model_allele_ct = record_header[0];
+      const uint32_t key_blen = record_header[1];
+      if (unlikely((model_allele_ct < 2) || (model_allele_ct > kPglMaxAlleleCt) || (key_blen % 8))) {
+        goto PcaProject_ret_MALFORMED_BODY;
+      }
+      const uint32_t row_ct = (model_allele_ct == 2)? 1 : model_allele_ct;
+      const uintptr_t record_blen = key_blen + model_allele_ct * sizeof(double) + row_ct * loading_row_size;
+      if (unlikely((S_CAST(uintptr_t, body_end - body_iter) < record_blen) || (!key_blen) || body_iter[key_blen - 1])) {
+        goto PcaProject_ret_MALFORMED_BODY;
+      }
+      const char* key = R_CAST(const char*, body_iter);
+      double* model_freqs = R_CAST(double*, K_CAST(unsigned char*, &(body_iter[key_blen])));
+      double* model_loadings = &(model_freqs[model_allele_ct]);
+      body_iter = &(body_iter[record_blen]);
+
+      const uint32_t variant_id_slen = strlen(key);
+      const uint32_t variant_uidx = VariantIdDupflagHtableFind(key, variant_ids, variant_id_htable, variant_id_slen, variant_id_htable_size, max_variant_id_slen);
+      if (variant_uidx >> 31) {
+        if (variant_uidx != UINT32_MAX) {
+          ++duplicated_var_id_ct;
+        } else {
+          ++missing_var_id_ct;
+        }
+        continue;
+      }
+      if (unlikely(IsSet(proj_variant_include, variant_uidx))) {
+        snprintf(g_logbuf, kLogbufSize, "Error: Variant ID '%s' appears multiple times in --pca-project model.\n", key);
+        goto PcaProject_ret_MALFORMED_INPUT_WW;
+      }
+      uintptr_t allele_idx_offset_base = variant_uidx * 2;
+      uint32_t cur_allele_ct = 2;
+      if (allele_idx_offsets) {
+        allele_idx_offset_base = allele_idx_offsets[variant_uidx];
+        cur_allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
+      }
+      if (cur_allele_ct != model_allele_ct) {
+        ++allele_mismatch_ct;
+        continue;
+      }
+      // allele_perm[dataset allele index] = model allele index
+      const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+      SetAllU32Arr(cur_allele_ct, allele_perm);
+      const char* model_allele_iter = &(key[variant_id_slen + 1]);
+      uint32_t model_allele_idx = 0;
+      for (; model_allele_idx != model_allele_ct; ++model_allele_idx) {
+        if (unlikely(model_allele_iter >= R_CAST(const char*, model_freqs))) {
+          goto PcaProject_ret_MALFORMED_BODY;
+        }
+        const uint32_t model_allele_slen = strlen(model_allele_iter);
+        uint32_t allele_idx = 0;
+        for (; allele_idx != cur_allele_ct; ++allele_idx) {
+          if ((!strcmp(model_allele_iter, cur_alleles[allele_idx])) && (allele_perm[allele_idx] == UINT32_MAX)) {
+            break;
+          }
+        }
+        if (allele_idx == cur_allele_ct) {
+          break;
+        }
+        allele_perm[allele_idx] = model_allele_idx;
+        model_allele_iter = &(model_allele_iter[model_allele_slen + 1]);
+      }
+      if (model_allele_idx != model_allele_ct) {
+        ++allele_mismatch_ct;
+        continue;
+      }
+      double* cur_proj_freqs = &(proj_allele_freqs[allele_idx_offset_base - variant_uidx]);
+      for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct - 1; ++allele_idx) {
+        cur_proj_freqs[allele_idx] = model_freqs[allele_perm[allele_idx]];
+      }
+      if (!(ComputeDiploidMultiallelicVariance(cur_proj_freqs, cur_allele_ct) > kSmallEpsilon)) {
+        // loadings are all zero
+        ++monomorphic_ct;
+        continue;
+      }
+      if (cur_allele_ct == 2) {
+        // single row = ALT dosage; it flips sign when the current ALT is the
+        // model REF (allele_perm[1] == 0)
+        if (!allele_perm[1]) {
+          for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+            model_loadings[pc_idx] = -model_loadings[pc_idx];
+          }
+        }
+      } else {
+        memcpy(row_buf, model_loadings, cur_allele_ct * loading_row_size);
+        for (uint32_t allele_idx = 0; allele_idx != cur_allele_ct; ++allele_idx) {
+          memcpy(&(model_loadings[allele_idx * pc_ct]), &(row_buf[allele_perm[allele_idx] * pc_ct]), loading_row_size);
+        }
+      }
+      for (uint32_t uii = 0; uii != row_ct * pc_ct; ) {
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx, ++uii) {
+          matched_sumsq[pc_idx] += model_loadings[uii] * model_loadings[uii];
+        }
+      }
+      SetBit(variant_uidx, proj_variant_include);
+      loading_offsets[variant_uidx] = model_loadings - model_body;
+      ++proj_variant_ct;
+      proj_row_ct += row_ct;
+    }
+    if (unlikely(body_iter != body_end)) {
+      goto PcaProject_ret_MALFORMED_BODY;
+    }
+    BigstackReset(variant_id_htable);
+    if (missing_var_id_ct || duplicated_var_id_ct || allele_mismatch_ct) {
+      logerrprintfww("Warning: %u --pca-project model variant%s skipped (%u missing from the current dataset, %u with duplicate IDs, %u with mismatching allele codes).\n", missing_var_id_ct + duplicated_var_id_ct + allele_mismatch_ct, (missing_var_id_ct + duplicated_var_id_ct + allele_mismatch_ct == 1)? " was" : "s were", missing_var_id_ct, duplicated_var_id_ct, allele_mismatch_ct);
+    }
+    if (unlikely(!proj_variant_ct)) {
+      logerrputs("Error: No --pca-project model variants are present in the current dataset.\n");
+      goto PcaProject_ret_INCONSISTENT_INPUT;
+    }
+    logprintfww("--pca-project: %u/%u model variant%s matched (%u monomorphic in the reference skipped), %u PC%s.\n", proj_variant_ct, model_variant_ct, (model_variant_ct == 1)? "" : "s", monomorphic_ct, pc_ct, (pc_ct == 1)? "" : "s");
+
+    // score_scales[] in the model file are the reciprocals of the full
+    // loading sums of squares.
+    if (flags & kfPcaProjShrink) {
+      // Lee, Zou & Wright (2010): with gamma = rows / reference samples, a
+      // sample eigenvalue d (in noise-variance units) above the
+      // (1 + sqrt(gamma))^2 threshold corresponds to a population spike
+      // lambda, and new-sample scores shrink by
+      // rho = (lambda - 1) / (lambda + gamma - 1).
+      // Noise variance is the mean per-row variance of the standardized
+      // reference data matrix.  A biallelic variant's single row has
+      // variance 1, and the allele rows of a multiallelic variant have
+      // variances summing to 1, so every variant contributes 1.
+      const double noise_variance = u31tod(model_variant_ct) / u31tod(model_row_ct);
+      const double gamma = u31tod(model_row_ct) / u31tod(model_sample_ct);
+      const double bbp_threshold = (1.0 + sqrt(gamma)) * (1.0 + sqrt(gamma));
+      char* write_iter = strcpya_k(g_logbuf, "--pca-project: Shrinkage factors:");
+      uint32_t subthreshold_ct = 0;
+      for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+        const double dd = 1.0 / (score_scales[pc_idx] * u31tod(model_sample_ct) * noise_variance);
+        double rho = 1.0;
+        if (dd > bbp_threshold) {
+          const double bb = dd + 1.0 - gamma;
+          const double lambda = 0.5 * (bb + sqrt(bb * bb - 4 * dd));
+          rho = (lambda - 1.0) / (lambda + gamma - 1.0);
+        } else {
+          ++subthreshold_ct;
+        }
+        // stash 1/rho in model_eigvals[], which isn't needed after this
+        model_eigvals[pc_idx] = 1.0 / rho;
+        *write_iter++ = ' ';
+        write_iter = dtoa_g(rho, write_iter);
+      }
+      strcpy_k(write_iter, "\n");
+      WordWrapB(0);
+      logputsb();
+      if (subthreshold_ct) {
+        logerrprintfww("Warning: %u PC%s at or below the random-matrix detection threshold, and %s not shrinkage-corrected.\n", subthreshold_ct, (subthreshold_ct == 1)? " is" : "s are", (subthreshold_ct == 1)? "was" : "were");
+      }
+    } else {
+      for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+        model_eigvals[pc_idx] = 1.0;
+      }
+    }
+    // Renormalize over the matched variants, so that missing variants don't
+    // uniformly shrink the projections toward zero.
+    for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+      if (unlikely(!(matched_sumsq[pc_idx] * score_scales[pc_idx] > kSmallEpsilon))) {
+        logerrprintf("Error: No matched --pca-project model variant has a nonzero PC%u loading.\n", pc_idx + 1);
+        goto PcaProject_ret_INCONSISTENT_INPUT;
+      }
+      score_scales[pc_idx] = model_eigvals[pc_idx] / matched_sumsq[pc_idx];
+    }
+
+    // Single pass over the matched variants.  Everything is allocated up
+    // front; each block of kScoreVariantBlockSize rows is loaded and
+    // standardized with the model's allele frequencies while the previous
+    // block is multiplied into final_scores_cmaj.
+    const uint32_t raw_sample_ctl = BitCtToWordCt(raw_sample_ct);
+    const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+    const char* sample_ids = siip->sample_ids;
+    const char* sids = siip->sids;
+    const uintptr_t max_sample_id_blen = siip->max_sample_id_blen;
+    const uintptr_t max_sid_blen = siip->max_sid_blen;
+    uint32_t* sample_include_cumulative_popcounts;
+    PgenVariant pgv;
+    uintptr_t* raregeno_buf;
+    uint32_t* difflist_sample_ids_buf;
+    double* allele_1copy_buf;
+    char* writebuf;
+    CalcScoreCtx ctx;
+    ctx.score_final_col_ct = pc_ct;
+    ctx.sample_ct = sample_ct;
+    if (unlikely(bigstack_alloc_u32(raw_sample_ctl, &sample_include_cumulative_popcounts) ||
+                 BigstackAllocPgv(sample_ct, allele_idx_offsets != nullptr, PgrGetGflags(simple_pgrp), &pgv) ||
+                 bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+                 bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
+                 bigstack_alloc_d(max_allele_ct, &allele_1copy_buf) ||
+                 bigstack_alloc_d((kScoreVariantBlockSize * k1LU) * sample_ct, &(ctx.dosages_vmaj[0])) ||
+                 bigstack_alloc_d((kScoreVariantBlockSize * k1LU) * sample_ct, &(ctx.dosages_vmaj[1])) ||
+                 bigstack_alloc_d(kScoreVariantBlockSize * pc_ct, &(ctx.score_coefs_cmaj[0])) ||
+                 bigstack_alloc_d(kScoreVariantBlockSize * pc_ct, &(ctx.score_coefs_cmaj[1])) ||
+                 bigstack_calloc_d(pc_ct * S_CAST(uintptr_t, sample_ct), &ctx.final_scores_cmaj) ||
+                 bigstack_alloc_c(kMaxMediumLine + max_sample_id_blen + max_sid_blen + 32 * pc_ct, &writebuf) ||
+                 SetThreadCt(1, &tg))) {
+      goto PcaProject_ret_NOMEM;
+    }
+    FillCumulativePopcounts(sample_include, raw_sample_ctl, sample_include_cumulative_popcounts);
+    PgrSampleSubsetIndex pssi;
+    PgrSetSampleSubsetIndex(sample_include_cumulative_popcounts, simple_pgrp, &pssi);
+    SetThreadFuncAndData(CalcScoreThread, &ctx, &tg);
+#ifdef USE_MTBLAS
+    const uint32_t matrix_multiply_thread_ct = (max_thread_ct > 1)? (max_thread_ct - 1) : 1;
+    BLAS_SET_NUM_THREADS(matrix_multiply_thread_ct);
+#endif
+    fputs("--pca-project: Projecting samples... ", stdout);
+    fflush(stdout);
+    uint32_t variant_idx = 0;
+    uintptr_t variant_uidx = 0;
+    uintptr_t allele_idx_base = 0;
+    uint32_t cur_allele_ct = 2;
+    uint32_t incomplete_allele_idx = 0;
+    uintptr_t coef_variant_uidx = 0;
+    uint32_t coef_rows_left = 0;
+    const double* coef_iter = nullptr;
+    uint32_t parity = 0;
+    while (1) {
+      uint32_t cur_batch_size = kScoreVariantBlockSize;
+      reterr = LoadCenteredVarmajBlock(sample_include, pssi, proj_variant_include, allele_idx_offsets, proj_allele_freqs, 1, is_haploid, sample_ct, proj_variant_ct, simple_pgrp, ctx.dosages_vmaj[parity], nullptr, &cur_batch_size, &variant_idx, &variant_uidx, &allele_idx_base, &cur_allele_ct, &incomplete_allele_idx, &pgv, raregeno_buf, difflist_sample_ids_buf, allele_1copy_buf);
+      if (unlikely(reterr)) {
+        goto PcaProject_ret_PGR_FAIL;
+      }
+      double* cur_score_coefs_cmaj = ctx.score_coefs_cmaj[parity];
+      for (uint32_t bidx = 0; bidx != cur_batch_size; ++bidx) {
+        if (!coef_rows_left) {
+          coef_variant_uidx = AdvTo1Bit(proj_variant_include, coef_variant_uidx);
+          coef_iter = &(model_body[loading_offsets[coef_variant_uidx]]);
+          coef_rows_left = 1;
+          if (allele_idx_offsets) {
+            const uint32_t coef_allele_ct = allele_idx_offsets[coef_variant_uidx + 1] - allele_idx_offsets[coef_variant_uidx];
+            if (coef_allele_ct != 2) {
+              coef_rows_left = coef_allele_ct;
+            }
+          }
+          ++coef_variant_uidx;
+        }
+        for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
+          cur_score_coefs_cmaj[pc_idx * kScoreVariantBlockSize + bidx] = *coef_iter++;
+        }
+        --coef_rows_left;
       }
-      if (unlikely(CswriteCloseNull(&css, cswritep))) {
-        goto CalcPca_ret_WRITE_FAIL;
+      if (ThreadsAreActive(&tg)) {
+        JoinThreads(&tg);
+        // CalcScoreThread() never errors out
+      }
+      ctx.cur_batch_size = cur_batch_size;
+      if (variant_idx == proj_variant_ct) {
+        DeclareLastThreadBlock(&tg);
+      }
+      if (unlikely(SpawnThreads(&tg))) {
+        goto PcaProject_ret_THREAD_CREATE_FAIL;
+      }
+      parity = 1 - parity;
+      if (variant_idx == proj_variant_ct) {
+        break;
       }
-      logprintfww("--pca%s: %s weights written to %s .\n", is_approx? " approx" : "", allele_wts? "Allele" : "Variant", outname);
     }
+    JoinThreads(&tg);
+    fputs("done.\n", stdout);
 
-    snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenvec");
+    snprintf(outname_end, kMaxOutfnameExtBlen, ".proj.eigenvec");
     if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
-      goto CalcPca_ret_OPEN_FAIL;
+      goto PcaProject_ret_OPEN_FAIL;
     }
+    const uint32_t write_fid = FidColIsRequired(siip, flags / kfPcaProjScolMaybefid);
+    const uint32_t write_sid = SidColIsRequired(sids, flags / kfPcaProjScolMaybesid);
+    char* writebuf_flush = &(writebuf[kMaxMediumLine]);
     char* write_iter = writebuf;
     *write_iter++ = '#';
     if (write_fid) {
@@ -5535,7 +7646,6 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
       write_iter = u32toa(pc_idx, write_iter);
     }
     AppendBinaryEoln(&write_iter);
-    const uint32_t sample_ct = pca_sample_ct;
     uintptr_t sample_uidx_base = 0;
     uintptr_t sample_include_bits = sample_include[0];
     for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
@@ -5553,135 +7663,65 @@ PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const
           *write_iter++ = '0';
         }
       }
-      double* sample_wts_iter = &(eigvecs_smaj[sample_idx * pc_ct]);
-      // todo: read from proj_sample_wts instead when pca_sample_include bit
-      // not set
+      const double* final_scores_iter = &(ctx.final_scores_cmaj[sample_idx]);
       for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
         *write_iter++ = '\t';
-        write_iter = dtoa_g(*sample_wts_iter++, write_iter);
+        write_iter = dtoa_g(final_scores_iter[pc_idx * S_CAST(uintptr_t, sample_ct)] * score_scales[pc_idx], write_iter);
       }
       AppendBinaryEoln(&write_iter);
       if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
-        goto CalcPca_ret_WRITE_FAIL;
+        goto PcaProject_ret_WRITE_FAIL;
       }
     }
     if (unlikely(fclose_flush_null(writebuf_flush, write_iter, &outfile))) {
-      goto CalcPca_ret_WRITE_FAIL;
-    }
-
-    snprintf(outname_end, kMaxOutfnameExtBlen, ".eigenval");
-    if (unlikely(fopen_checked(outname, FOPEN_WB, &outfile))) {
-      goto CalcPca_ret_OPEN_FAIL;
-    }
-    write_iter = writebuf;
-    for (uint32_t pc_idx = 0; pc_idx != pc_ct; ++pc_idx) {
-      write_iter = dtoa_g(eigvals[pc_idx], write_iter);
-      AppendBinaryEoln(&write_iter);
-    }
-    if (unlikely(fclose_flush_null(writebuf_flush, write_iter, &outfile))) {
-      goto CalcPca_ret_WRITE_FAIL;
+      goto PcaProject_ret_WRITE_FAIL;
     }
-    *outname_end = '\0';
-    logprintfww("--pca%s: Eigenvector%s written to %s.eigenvec , and eigenvalue%s written to %s.eigenval .\n", is_approx? " approx" : "", (pc_ct == 1)? "" : "s", outname, (pc_ct == 1)? "" : "s", outname);
+    logprintfww("--pca-project: Projections for %u sample%s written to %s .\n", sample_ct, (sample_ct == 1)? "" : "s", outname);
   }
   while (0) {
-  CalcPca_ret_NOMEM:
+  PcaProject_ret_NOMEM:
     reterr = kPglRetNomem;
     break;
-  CalcPca_ret_OPEN_FAIL:
+  PcaProject_ret_OPEN_FAIL:
     reterr = kPglRetOpenFail;
     break;
-  CalcPca_ret_PGR_FAIL:
-    PgenErrPrintN(reterr);
+  PcaProject_ret_READ_FAIL:
+    reterr = kPglRetReadFail;
     break;
-  CalcPca_ret_REWIND_FAIL:
-    logerrprintfww(kErrprintfRewind, ".pgen file");
+  PcaProject_ret_PGR_FAIL:
+    PgenErrPrintN(reterr);
     break;
-  CalcPca_ret_WRITE_FAIL:
+  PcaProject_ret_WRITE_FAIL:
     reterr = kPglRetWriteFail;
     break;
-  CalcPca_ret_INCONSISTENT_INPUT:
-    reterr = kPglRetInconsistentInput;
+  PcaProject_ret_MALFORMED_HEADER:
+    logerrprintfww("Error: %s is not a valid --pca-project model file.\n", model_fname);
+    reterr = kPglRetMalformedInput;
     break;
-  CalcPca_ret_THREAD_CREATE_FAIL:
-    reterr = kPglRetThreadCreateFail;
+  PcaProject_ret_MALFORMED_BODY:
+    logerrprintfww("Error: %s is truncated or corrupted.\n", model_fname);
+    reterr = kPglRetMalformedInput;
     break;
-  CalcPca_ret_DEGENERATE_DATA_2:
+  PcaProject_ret_MALFORMED_INPUT_WW:
+    WordWrapB(0);
     logerrputsb();
-  CalcPca_ret_DEGENERATE_DATA:
-    reterr = kPglRetDegenerateData;
+    reterr = kPglRetMalformedInput;
+    break;
+  PcaProject_ret_INCONSISTENT_INPUT:
+    reterr = kPglRetInconsistentInput;
+    break;
+  PcaProject_ret_THREAD_CREATE_FAIL:
+    reterr = kPglRetThreadCreateFail;
     break;
   }
- CalcPca_ret_1:
+ PcaProject_ret_1:
   CleanupThreads(&tg);
   BLAS_SET_NUM_THREADS(1);
-  CswriteCloseCond(&css, cswritep);
+  fclose_cond(infile);
   fclose_cond(outfile);
-  if (grm) {
-    // nothing after --pca in the plink2 order of operations uses grm[]
-    BigstackReset(grm);
-  } else {
-    BigstackReset(bigstack_mark);
-  }
+  BigstackReset(bigstack_mark);
   return reterr;
 }
-#endif
-
-// to test: do we actually want cur_dosage_ints to be uint64_t* instead of
-// uint32_t*?
-// also, should this be moved to plink2_common?
-void FillCurDdosageInts(const uintptr_t* genovec_buf, const uintptr_t* dosage_present, const Dosage* dosage_main_buf, uint32_t sample_ct, uint32_t dosage_ct, uint32_t is_diploid_p1, uint64_t* cur_ddosage_ints) {
-  uint64_t lookup_table[32] ALIGNV16;
-  lookup_table[0] = 0;
-  lookup_table[2] = is_diploid_p1 * kDosageMid;
-  lookup_table[4] = is_diploid_p1 * kDosageMax;
-  lookup_table[6] = 0;
-  InitLookup16x8bx2(lookup_table);
-  GenoarrLookup16x8bx2(genovec_buf, lookup_table, sample_ct, cur_ddosage_ints);
-  if (!dosage_ct) {
-    return;
-  }
-  uintptr_t sample_idx_base = 0;
-  uintptr_t cur_bits = dosage_present[0];
-  for (uint32_t dosage_idx = 0; dosage_idx != dosage_ct; ++dosage_idx) {
-    const uintptr_t sample_idx = BitIter1(dosage_present, &sample_idx_base, &cur_bits);
-    cur_ddosage_ints[sample_idx] = dosage_main_buf[dosage_idx] * is_diploid_p1;
-  }
-}
-
-CONSTI32(kScoreVariantBlockSize, 240);
-
-typedef struct CalcScoreCtxStruct {
-  uint32_t score_final_col_ct;
-  uint32_t sample_ct;
-
-  double* dosages_vmaj[2];
-  double* score_coefs_cmaj[2];
-
-  uint32_t cur_batch_size;
-
-  double* final_scores_cmaj;
-} CalcScoreCtx;
-
-THREAD_FUNC_DECL CalcScoreThread(void* raw_arg) {
-  ThreadGroupFuncArg* arg = S_CAST(ThreadGroupFuncArg*, raw_arg);
-  // don't bother to explicitly multithread for now
-  assert(!arg->tidx);
-  CalcScoreCtx* ctx = S_CAST(CalcScoreCtx*, arg->sharedp->context);
-
-  double* final_scores_cmaj = ctx->final_scores_cmaj;
-  const uint32_t score_final_col_ct = ctx->score_final_col_ct;
-  const uint32_t sample_ct = ctx->sample_ct;
-  uint32_t parity = 0;
-  do {
-    const uint32_t cur_batch_size = ctx->cur_batch_size;
-    if (cur_batch_size) {
-      RowMajorMatrixMultiplyStridedIncr(ctx->score_coefs_cmaj[parity], ctx->dosages_vmaj[parity], score_final_col_ct, kScoreVariantBlockSize, sample_ct, sample_ct, cur_batch_size, sample_ct, final_scores_cmaj);
-    }
-    parity = 1 - parity;
-  } while (!THREAD_BLOCK_FINISH(arg));
-  THREAD_RETURN;
-}
 
 typedef struct ParsedQscoreRangeStruct {
   char* range_name;
@@ -6161,6 +8201,29 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
                  bigstack_alloc_c(overflow_buf_alloc, &overflow_buf))) {
       goto ScoreReport_ret_NOMEM;
     }
+    // Rare variants are mostly stored as difflists against a hom-ref
+    // background.  When scores are not centered, their contributions are
+    // accumulated directly into sparse_scores_cmaj at O(carriers) cost instead
+    // of going through the dense dosage matrix.  This is a separate buffer
+    // since CalcScoreThread() may be updating final_scores_cmaj concurrently.
+    uintptr_t* raregeno_buf = nullptr;
+    uint32_t* difflist_sample_ids_buf = nullptr;
+    double* sparse_scores_cmaj = nullptr;
+    uint32_t max_simple_difflist_len = 0;
+    if ((!qsr_ct) && (!(flags & (kfScoreCenter | kfScoreVarianceStandardize))) && (!(PgrGetGflags(simple_pgrp) & kfPgenGlobalDosagePresent))) {
+      const uint32_t max_returned_difflist_len = 2 * (raw_sample_ct / kPglMaxDifflistLenDivisor);
+      unsigned char* sparse_alloc_start = g_bigstack_base;
+      if (bigstack_alloc_w(NypCtToWordCt(max_returned_difflist_len), &raregeno_buf) ||
+          bigstack_alloc_u32(max_returned_difflist_len, &difflist_sample_ids_buf) ||
+          bigstack_calloc_d(score_final_col_ct * sample_ct, &sparse_scores_cmaj)) {
+        // not worth failing over
+        BigstackReset(sparse_alloc_start);
+        g_failed_alloc_attempt_size = 0;
+        sparse_scores_cmaj = nullptr;
+      } else {
+        max_simple_difflist_len = sample_ct / kScoreDifflistDivisor;
+      }
+    }
     SetThreadFuncAndData(CalcScoreThread, &ctx, &tg);
 
     for (uintptr_t qsr_idx = 0; qsr_idx != qsr_ct_nz; ++qsr_idx) {
@@ -6295,11 +8358,6 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
       // okay, the variant and allele are in our dataset.  Load it.
       // (possible todo: avoid reloading the same variant multiple times in a
       // row.)
-      uint32_t dosage_ct;
-      reterr = PgrGet1D(sample_include, pssi, sample_ct, variant_uidx, cur_allele_idx, simple_pgrp, genovec_buf, dosage_present_buf, dosage_main_buf, &dosage_ct);
-      if (unlikely(reterr)) {
-        goto ScoreReport_ret_PGR_FAIL;
-      }
       const uint32_t chr_idx = GetVariantChr(cip, variant_uidx);
       uint32_t is_nonx_haploid = IsSet(cip->haploid_mask, chr_idx);
       if (unlikely(domrec && is_nonx_haploid)) {
@@ -6317,6 +8375,83 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
       is_relevant_x = is_relevant_x && xchr_model;
 
       const uint32_t is_y = (chr_idx == y_code);
+      uint32_t dosage_ct;
+      // difflist_common_geno is 0 iff the variant was loaded as a difflist and
+      // the sparse path below applies.
+      uint32_t difflist_common_geno = UINT32_MAX;
+      uint32_t difflist_len = 0;
+      if (max_simple_difflist_len && (cur_allele_ct == 2) && (cur_allele_idx == 1) && (!is_nonx_haploid) && (!is_relevant_x)) {
+        reterr = PgrGetDifflistOrGenovec(sample_include, pssi, sample_ct, max_simple_difflist_len, variant_uidx, simple_pgrp, genovec_buf, &difflist_common_geno, raregeno_buf, difflist_sample_ids_buf, &difflist_len);
+        dosage_ct = 0;
+        if ((!reterr) && (difflist_common_geno != UINT32_MAX) && (difflist_common_geno || (difflist_len > max_simple_difflist_len))) {
+          PgrDifflistToGenovecUnsafe(raregeno_buf, difflist_sample_ids_buf, difflist_common_geno, sample_ct, difflist_len, genovec_buf);
+          difflist_common_geno = UINT32_MAX;
+        }
+      } else {
+        reterr = PgrGet1D(sample_include, pssi, sample_ct, variant_uidx, cur_allele_idx, simple_pgrp, genovec_buf, dosage_present_buf, dosage_main_buf, &dosage_ct);
+      }
+      if (unlikely(reterr)) {
+        goto ScoreReport_ret_PGR_FAIL;
+      }
+
+      *allele_end = allele_end_char;
+      double* cur_score_coefs_iter = &(cur_score_coefs_cmaj[block_vidx]);
+      const char* read_iter = line_start;
+      for (uint32_t score_col_idx = 0; score_col_idx != score_col_ct; ++score_col_idx) {
+        read_iter = NextTokenMult0(read_iter, score_col_idx_deltas[score_col_idx]);
+        if (unlikely(!read_iter)) {
+          goto ScoreReport_ret_MISSING_TOKENS;
+        }
+        double raw_coef;
+        const char* token_end = ScantokDouble(read_iter, &raw_coef);
+        if (unlikely(!token_end)) {
+          snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of --score file has an invalid coefficient.\n", line_idx);
+          goto ScoreReport_ret_MALFORMED_INPUT_2;
+        }
+        if (!qsr_ct) {
+          *cur_score_coefs_iter = raw_coef;
+          cur_score_coefs_iter = &(cur_score_coefs_iter[kScoreVariantBlockSize]);
+        } else {
+          const uintptr_t bit_idx_base = RawToSubsettedPos(variant_include, variant_include_cumulative_popcounts, variant_uidx) * qsr_ct;
+          for (uintptr_t qsr_idx = 0; qsr_idx != qsr_ct; ++qsr_idx) {
+            double cur_coef = raw_coef * u31tod(IsSet(qsr_include, qsr_idx + bit_idx_base));
+            *cur_score_coefs_iter = cur_coef;
+            cur_score_coefs_iter = &(cur_score_coefs_iter[kScoreVariantBlockSize]);
+          }
+        }
+        read_iter = token_end;
+      }
+      if (is_new_variant) {
+        if (list_variants) {
+          cswritep = strcpya(cswritep, variant_ids[variant_uidx]);
+          AppendBinaryEoln(&cswritep);
+          if (unlikely(Cswrite(&css, &cswritep))) {
+            goto ScoreReport_ret_WRITE_FAIL;
+          }
+        }
+        ++valid_variant_ct;
+        if (!(valid_variant_ct % 10000)) {
+          printf("\r--score: %uk variants loaded.", valid_variant_ct / 1000);
+          fflush(stdout);
+        }
+      }
+      if (difflist_common_geno != UINT32_MAX) {
+        // Only het, hom-alt, and missing calls contribute.  The coefficients
+        // were just written to the current block slot, which is left free for
+        // the next variant.
+        if (is_new_variant) {
+          allele_ct_bases[0] += 2;
+        }
+        if (allele_freqs) {
+          cur_allele_freq = GetAlleleFreq(&(allele_freqs[allele_idx_offset_base - variant_uidx]), cur_allele_idx, cur_allele_ct);
+        }
+        double missing_effect = 0.0;
+        if (!no_meanimpute) {
+          missing_effect = kDosageMax * cur_allele_freq * geno_slope * (domrec? 1.0 : 2.0);
+        }
+        ScoreDifflistUpdate(raregeno_buf, difflist_sample_ids_buf, &(cur_score_coefs_cmaj[block_vidx]), difflist_len, score_final_col_ct, sample_ct, model_dominant, domrec, se_mode, is_new_variant, geno_slope, missing_effect, ddosage_sums, sparse_scores_cmaj, missing_bitvec, variant_ct_rems, missing_accx);
+        continue;
+      }
       ZeroTrailingNyps(sample_ct, genovec_buf);
       GenoarrToMissingnessUnsafe(genovec_buf, sample_ct, missing_bitvec);
       if (dosage_ct) {
@@ -6544,48 +8679,6 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
         }
       }
       cur_dosages_vmaj_iter = &(cur_dosages_vmaj_iter[sample_ct]);
-
-      *allele_end = allele_end_char;
-      double* cur_score_coefs_iter = &(cur_score_coefs_cmaj[block_vidx]);
-      const char* read_iter = line_start;
-      for (uint32_t score_col_idx = 0; score_col_idx != score_col_ct; ++score_col_idx) {
-        read_iter = NextTokenMult0(read_iter, score_col_idx_deltas[score_col_idx]);
-        if (unlikely(!read_iter)) {
-          goto ScoreReport_ret_MISSING_TOKENS;
-        }
-        double raw_coef;
-        const char* token_end = ScantokDouble(read_iter, &raw_coef);
-        if (unlikely(!token_end)) {
-          snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of --score file has an invalid coefficient.\n", line_idx);
-          goto ScoreReport_ret_MALFORMED_INPUT_2;
-        }
-        if (!qsr_ct) {
-          *cur_score_coefs_iter = raw_coef;
-          cur_score_coefs_iter = &(cur_score_coefs_iter[kScoreVariantBlockSize]);
-        } else {
-          const uintptr_t bit_idx_base = RawToSubsettedPos(variant_include, variant_include_cumulative_popcounts, variant_uidx) * qsr_ct;
-          for (uintptr_t qsr_idx = 0; qsr_idx != qsr_ct; ++qsr_idx) {
-            double cur_coef = raw_coef * u31tod(IsSet(qsr_include, qsr_idx + bit_idx_base));
-            *cur_score_coefs_iter = cur_coef;
-            cur_score_coefs_iter = &(cur_score_coefs_iter[kScoreVariantBlockSize]);
-          }
-        }
-        read_iter = token_end;
-      }
-      if (is_new_variant) {
-        if (list_variants) {
-          cswritep = strcpya(cswritep, variant_ids[variant_uidx]);
-          AppendBinaryEoln(&cswritep);
-          if (unlikely(Cswrite(&css, &cswritep))) {
-            goto ScoreReport_ret_WRITE_FAIL;
-          }
-        }
-        ++valid_variant_ct;
-        if (!(valid_variant_ct % 10000)) {
-          printf("\r--score: %uk variants loaded.", valid_variant_ct / 1000);
-          fflush(stdout);
-        }
-      }
       ++block_vidx;
       if (block_vidx == kScoreVariantBlockSize) {
         if (se_mode) {
@@ -6644,14 +8737,13 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
         logerrputs("(Add the 'list-variants' modifier to see which variants were actually used for\nscoring.)\n");
       }
     }
-    if (block_vidx) {
-      if (is_not_first_block) {
-        JoinThreads(&tg);
-      }
-    } else if (unlikely(!valid_variant_ct)) {
+    if (unlikely(!valid_variant_ct)) {
       logerrputs("Error: No valid variants in --score file.\n");
       goto ScoreReport_ret_DEGENERATE_DATA;
-    } else {
+    }
+    // With the sparse path, block_vidx == 0 no longer implies that a block was
+    // just dispatched.
+    if (is_not_first_block) {
       JoinThreads(&tg);
     }
     DeclareLastThreadBlock(&tg);
@@ -6668,6 +8760,11 @@ PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, co
       goto ScoreReport_ret_THREAD_CREATE_FAIL;
     }
     JoinThreads(&tg);
+    if (sparse_scores_cmaj) {
+      for (uintptr_t ulii = 0; ulii != sample_ct * score_final_col_ct; ++ulii) {
+        ctx.final_scores_cmaj[ulii] += sparse_scores_cmaj[ulii];
+      }
+    }
     if (se_mode) {
       // sample_ct * score_final_col_ct
       for (uintptr_t ulii = 0; ulii != sample_ct * score_final_col_ct; ++ulii) {
@@ -7360,7 +9457,7 @@ THREAD_FUNC_DECL VscoreThread(void* raw_arg) {
       cur_bidxs[row_idx] = variant_bidx;
       if (single_prec) {
         float* cur_row = &(dosage_f_vmaj[row_idx * sample_ct]);
-        PopulateRescaledDosageF(genovec, dosage_present, dosage_main, S_CAST(float, slope), S_CAST(float, 0.0), S_CAST(float, missing_val), sample_ct, dosage_ct, cur_row);
+        Dosage16ToFloatsRescaled(genovec, dosage_present, dosage_main, S_CAST(float, slope), S_CAST(float, 0.0), S_CAST(float, missing_val), sample_ct, dosage_ct, cur_row);
         if (is_x_or_y) {
           // Instead of doing this for every variant, we could precompute
           // chrX/chrY weight matrices with male weights halved/nonmale weights
@@ -7386,7 +9483,7 @@ THREAD_FUNC_DECL VscoreThread(void* raw_arg) {
         }
       } else {
         double* cur_row = &(dosage_d_vmaj[row_idx * sample_ct]);
-        PopulateRescaledDosage(genovec, dosage_present, dosage_main, slope, 0.0, missing_val, sample_ct, dosage_ct, cur_row);
+        Dosage16ToDoublesRescaled(genovec, dosage_present, dosage_main, slope, 0.0, missing_val, sample_ct, dosage_ct, cur_row);
         if (is_x_or_y) {
           // Instead of doing this for every variant, we could precompute
           // chrX/chrY weight matrices with male weights halved/nonmale weights
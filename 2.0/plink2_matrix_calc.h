@@ -51,7 +51,9 @@ FLAGSET_DEF_START()
   kfKingColIbs1 = (1 << 17),
   kfKingColKinship = (1 << 18),
   kfKingColDefault = (kfKingColMaybefid | kfKingColId | kfKingColMaybesid | kfKingColNsnp | kfKingColHethet | kfKingColIbs0 | kfKingColKinship),
-  kfKingColAll = ((kfKingColKinship * 2) - kfKingColMaybefid)
+  kfKingColAll = ((kfKingColKinship * 2) - kfKingColMaybefid),
+
+  kfKingScreen = (1 << 19)
 FLAGSET_DEF_END(KingFlags);
 
 FLAGSET_DEF_START()
@@ -72,7 +74,10 @@ FLAGSET_DEF_START()
   kfGrmMeanimpute = (1 << 9),
   kfGrmCov = (1 << 10),
   kfGrmNoIdHeader = (1 << 11),
-  kfGrmNoIdHeaderIidOnly = (1 << 12)
+  kfGrmNoIdHeaderIidOnly = (1 << 12),
+
+  kfGrmSparse = (1 << 13),
+  kfGrmSparseZs = (1 << 14)
 FLAGSET_DEF_END(GrmFlags);
 
 FLAGSET_DEF_START()
@@ -100,9 +105,24 @@ FLAGSET_DEF_START()
   kfPcaVcolNonmaj = (1 << 16),
   kfPcaVcolDefaultA = (kfPcaVcolChrom | kfPcaVcolRef | kfPcaVcolAlt),
   kfPcaVcolDefaultB = (kfPcaVcolChrom | kfPcaVcolMaj | kfPcaVcolNonmaj),
-  kfPcaVcolAll = ((kfPcaVcolNonmaj * 2) - kfPcaVcolChrom)
+  kfPcaVcolAll = ((kfPcaVcolNonmaj * 2) - kfPcaVcolChrom),
+
+  kfPcaStream = (1 << 17),
+  kfPcaModel = (1 << 18)
 FLAGSET_DEF_END(PcaFlags);
 
+FLAGSET_DEF_START()
+  kfPcaProj0,
+  kfPcaProjShrink = (1 << 0),
+
+  kfPcaProjScolMaybefid = (1 << 1),
+  kfPcaProjScolFid = (1 << 2),
+  kfPcaProjScolMaybesid = (1 << 3),
+  kfPcaProjScolSid = (1 << 4),
+  kfPcaProjScolDefault = (kfPcaProjScolMaybefid | kfPcaProjScolMaybesid),
+  kfPcaProjScolAll = ((kfPcaProjScolSid * 2) - kfPcaProjScolMaybefid)
+FLAGSET_DEF_END(PcaProjFlags);
+
 FLAGSET_DEF_START()
   kfScore0,
   kfScoreHeaderIgnore = (1 << 0),
@@ -178,14 +198,37 @@ PglErr KingCutoffBatch(const SampleIdInfo* siip, uint32_t raw_sample_ct, double
 
 PglErr CalcKing(const SampleIdInfo* siip, const uintptr_t* variant_include_orig, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end);
 
-PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
+PglErr CalcKingTableSubset(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* subset_fname, const uint64_t* screen_pairs, uintptr_t screen_pair_ct, uint32_t raw_sample_ct, uint32_t orig_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, double king_table_subset_thresh, uint32_t rel_check, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, uintptr_t* kinship_table, char* outname, char* outname_end);
+
+// Two-stage --make-king-table/--king-cutoff: candidate pairs are first
+// screened by shared rare-allele carrier counts, then only those pairs get the
+// exact KING-robust computation.
+PglErr CalcKingScreen(const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, uint32_t raw_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, double king_cutoff, double king_table_filter, uint32_t max_carrier_ct, uint32_t min_shared_ct, KingFlags king_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, uintptr_t* sample_include, uint32_t* sample_ct_ptr, char* outname, char* outname_end);
 
 PglErr CalcGrm(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end, double** grm_ptr);
 
+PglErr CalcGrmSparse(const uintptr_t* orig_sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, GrmFlags grm_flags, double cutoff, uint32_t parallel_idx, uint32_t parallel_tot, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
+
+// Block-wise whole-genome ridge regression of resid_pheno (already
+// covariate-residualized, over sample_include) on the diploid autosomes.
+// chr_fo_slots[] receives the loco_preds row for each chromosome file
+// position; row (*loco_slot_ct_ptr - 1) is the all-autosome prediction, used
+// for chromosomes that aren't left out.  loco_preds is allocated on the
+// bigstack.  fold_seed determines the cross-validation fold assignment.  The
+// caller is responsible for the BLAS thread count.
+PglErr CalcLocoRidgePreds(const uintptr_t* sample_include, const uint32_t* sample_include_cumulative_popcounts, const uintptr_t* variant_include, const ChrInfo* cip, const uintptr_t* allele_idx_offsets, const double* allele_freqs, const double* resid_pheno, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t max_allele_ct, double h2, uint32_t fold_seed, PgenReader* simple_pgrp, uint32_t* chr_fo_slots, uint32_t* loco_slot_ct_ptr, double** loco_preds_ptr);
+
 #ifndef NOLAPACK
-PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* maj_alleles, const double* allele_freqs, uint32_t raw_sample_ct, uintptr_t pca_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t pc_ct, PcaFlags pca_flags, uint32_t max_thread_ct, PgenReader* simple_pgrp, sfmt_t* sfmtp, double* grm, char* outname, char* outname_end);
+// pca_iter_ct and pca_block_size are only referenced when kfPcaStream is set.
+// kfPcaModel additionally writes a binary .eigenvec.model file which
+// PcaProject() can read.
+PglErr CalcPca(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const AlleleCode* maj_alleles, const double* allele_freqs, uint32_t raw_sample_ct, uintptr_t pca_sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_allele_slen, uint32_t pc_ct, PcaFlags pca_flags, uint32_t pca_iter_ct, uint32_t pca_block_size, uint32_t max_thread_ct, PgenReader* simple_pgrp, sfmt_t* sfmtp, double* grm, char* outname, char* outname_end);
 #endif
 
+// Projects the current samples onto the PCs stored in a .eigenvec.model file
+// written by "--pca model", matching variants by ID and allele codes.
+PglErr PcaProject(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* variant_include, const ChrInfo* cip, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const char* model_fname, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_allele_ct, uint32_t max_variant_id_slen, PcaProjFlags flags, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
+
 PglErr ScoreReport(const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* sex_male, const PhenoCol* pheno_cols, const char* pheno_names, const uintptr_t* variant_include, const ChrInfo* cip, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const double* allele_freqs, const ScoreInfo* score_info_ptr, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t pheno_ct, uintptr_t max_pheno_name_blen, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t max_variant_id_slen, uint32_t xchr_model, uint32_t max_thread_ct, PgenReader* simple_pgrp, char* outname, char* outname_end);
 
 PglErr Vscore(const uintptr_t* variant_include, const ChrInfo* cip, const uint32_t* variant_bps, const char* const* variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const uintptr_t* sample_include, const SampleIdInfo* siip, const uintptr_t* sex_male, const double* allele_freqs, const char* in_fname, const RangeList* col_idx_range_listp, uint32_t raw_variant_ct, uint32_t variant_ct, uint32_t raw_sample_ct, uint32_t sample_ct, uint32_t max_allele_slen, VscoreFlags flags, uint32_t xchr_model, uint32_t max_thread_ct, uintptr_t pgr_alloc_cacheline_ct, PgenFileInfo* pgfip, char* outname, char* outname_end);
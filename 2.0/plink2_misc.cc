@@ -9868,6 +9868,14 @@ typedef struct FstCtxStruct {
   uint32_t sample_ct;
   uint32_t pop_ct;
 
+  // If non-null, biallelic variants are counted with PgrGetCountsMulti().
+  // The subsets are the populations, and if sex_male_collapsed is non-null,
+  // the nonmales of each population are followed by the males, matching the
+  // pop_geno_bufs[] layout.
+  const uintptr_t* pop_subset_masks;
+  const uintptr_t* pop_subset_interleaved_vecs;
+  const uint32_t* pop_subset_sizes;
+
   PgenReader** pgr_ptrs;
   uintptr_t** genovecs;
   uintptr_t** thread_read_mhc;
@@ -9923,6 +9931,10 @@ THREAD_FUNC_DECL FstThread(void* raw_arg) {
   uint32_t* difflist_sample_ids = ctx->difflist_sample_id_bufs[tidx];
   uint32_t* pop_geno_buf = ctx->pop_geno_bufs[tidx];
   const uintptr_t pop_geno_buf_size = pop_ct_x4 << haploid_present;
+  const uintptr_t* pop_subset_masks = ctx->pop_subset_masks;
+  const uintptr_t* pop_subset_interleaved_vecs = ctx->pop_subset_interleaved_vecs;
+  const uint32_t* pop_subset_sizes = ctx->pop_subset_sizes;
+  const uint32_t pop_subset_ct = pop_ct << haploid_present;
 
   // todo: tune this threshold
   const uint32_t max_simple_difflist_len = sample_ct / 32;
@@ -9970,16 +9982,25 @@ THREAD_FUNC_DECL FstThread(void* raw_arg) {
       if (allele_idx_offsets) {
         allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offsets[variant_uidx];
       }
-      ZeroU32Arr(pop_geno_buf_size, pop_geno_buf);
-      uint32_t difflist_common_geno = UINT32_MAX;
-      if (allele_ct == 2) {
+      uint32_t genovec_scatter_needed = 0;
+      if ((allele_ct == 2) && pop_subset_masks) {
+        PglErr reterr = PgrGetCountsMulti(sample_include, pssi, sample_ct, pop_subset_masks, pop_subset_interleaved_vecs, pop_subset_sizes, pop_subset_ct, variant_uidx, pgrp, genovec, raregeno, difflist_sample_ids, pop_geno_buf);
+        if (unlikely(reterr)) {
+          ctx->reterr = reterr;
+          break;
+        }
+      } else if (allele_ct == 2) {
+        ZeroU32Arr(pop_geno_buf_size, pop_geno_buf);
+        uint32_t difflist_common_geno;
         uint32_t difflist_len;
         PglErr reterr = PgrGetDifflistOrGenovec(sample_include, pssi, sample_ct, max_simple_difflist_len, variant_uidx, pgrp, genovec, &difflist_common_geno, raregeno, difflist_sample_ids, &difflist_len);
         if (unlikely(reterr)) {
           ctx->reterr = reterr;
           break;
         }
-        if (difflist_common_geno != UINT32_MAX) {
+        if (difflist_common_geno == UINT32_MAX) {
+          genovec_scatter_needed = 1;
+        } else {
           const uint32_t word_ct = NypCtToWordCt(difflist_len);
           if (word_ct) {
             const uint32_t word_ct_m1 = word_ct - 1;
@@ -10032,13 +10053,15 @@ THREAD_FUNC_DECL FstThread(void* raw_arg) {
           }
         }
       } else {
+        ZeroU32Arr(pop_geno_buf_size, pop_geno_buf);
         PglErr reterr = PgrGetM(sample_include, pssi, sample_ct, variant_uidx, pgrp, &pgv);
         if (unlikely(reterr)) {
           ctx->reterr = reterr;
           break;
         }
+        genovec_scatter_needed = 1;
       }
-      if (difflist_common_geno == UINT32_MAX) {
+      if (genovec_scatter_needed) {
         uint32_t loop_len = kBitsPerWordD2;
         for (uint32_t widx = 0; ; ++widx) {
           if (widx >= sample_ctl2_m1) {
@@ -10700,6 +10723,43 @@ PglErr FstReport(const uintptr_t* orig_sample_include, const uintptr_t* sex_male
         continue;
       }
       ctx.cur_variant_include = cur_variant_include;
+      ctx.pop_subset_masks = nullptr;
+      ctx.pop_subset_interleaved_vecs = nullptr;
+      ctx.pop_subset_sizes = nullptr;
+      const uint32_t pop_subset_ct = pop_ct << (ctx.sex_male_collapsed != nullptr);
+      // Per-subset popcounts beat the scalar scatter when there are few
+      // populations.  todo: tune this threshold
+      if (pop_subset_ct <= 64) {
+        const uint32_t sample_ctaw = BitCtToAlignedWordCt(sample_ct);
+        const uint32_t sample_ctv = BitCtToVecCt(sample_ct);
+        uintptr_t* pop_subset_masks;
+        uintptr_t* pop_subset_interleaved_vecs;
+        uint32_t* pop_subset_sizes;
+        if (unlikely(bigstack_calloc_w(pop_subset_ct * sample_ctaw, &pop_subset_masks) ||
+                     bigstack_alloc_w(pop_subset_ct * sample_ctaw, &pop_subset_interleaved_vecs) ||
+                     bigstack_alloc_u32(pop_subset_ct, &pop_subset_sizes))) {
+          goto FstReport_ret_NOMEM;
+        }
+        const uint32_t* sample_to_pop_idx = ctx.sample_to_pop_idx;
+        const uintptr_t* sex_male_collapsed = ctx.sex_male_collapsed;
+        for (uint32_t sample_idx = 0; sample_idx != sample_ct; ++sample_idx) {
+          uint32_t subset_idx = sample_to_pop_idx[sample_idx];
+          if (sex_male_collapsed && IsSet(sex_male_collapsed, sample_idx)) {
+            subset_idx += pop_ct;
+          }
+          SetBit(sample_idx, &(pop_subset_masks[subset_idx * sample_ctaw]));
+        }
+        for (uint32_t subset_idx = 0; subset_idx != pop_subset_ct; ++subset_idx) {
+          FillInterleavedMaskVec(&(pop_subset_masks[subset_idx * sample_ctaw]), sample_ctv, &(pop_subset_interleaved_vecs[subset_idx * sample_ctaw]));
+        }
+        memcpy(pop_subset_sizes, ctx.diploid_pop_sizes, pop_ct * sizeof(int32_t));
+        if (sex_male_collapsed) {
+          memcpy(&(pop_subset_sizes[pop_ct]), ctx.haploid_pop_sizes, pop_ct * sizeof(int32_t));
+        }
+        ctx.pop_subset_masks = pop_subset_masks;
+        ctx.pop_subset_interleaved_vecs = pop_subset_interleaved_vecs;
+        ctx.pop_subset_sizes = pop_subset_sizes;
+      }
       const uintptr_t pop_geno_vec_ct = DivUp(pop_ct * (4 << (ctx.sex_male_collapsed != nullptr)), kInt32PerVec);
       const uintptr_t thread_xalloc_vec_ct = raregeno_vec_ct + difflist_sample_id_vec_ct + pop_geno_vec_ct;
       const uintptr_t thread_xalloc_cacheline_ct = DivUp(thread_xalloc_vec_ct, kVecsPerCacheline);
@@ -16,6 +16,9 @@
 
 #include "plink2_pvar.h"
 
+#include <sys/types.h>  // stat()
+#include <sys/stat.h>  // stat()
+
 #ifdef __cplusplus
 namespace plink2 {
 #endif
@@ -796,8 +799,1105 @@ PglErr SplitPar(const uint32_t* variant_bps, UnsortedVar vpos_sortstatus, uint32
   return kPglRetSuccess;
 }
 
+void PreinitPvarFileKey(PvarFileKey* keyp) {
+  keyp->fsize = 0;
+  keyp->mtime = 0;
+  keyp->head_hash = 0;
+  keyp->tail_hash = 0;
+}
+
+BoolErr PvarFileKeyInit(const char* fname, PvarFileKey* keyp) {
+  struct stat statbuf;
+  if (stat(fname, &statbuf) || (!S_ISREG(statbuf.st_mode))) {
+    return 1;
+  }
+  keyp->fsize = statbuf.st_size;
+  keyp->mtime = statbuf.st_mtime;
+  FILE* ff = fopen(fname, FOPEN_RB);
+  if (!ff) {
+    return 1;
+  }
+  const uint32_t span = MINV(keyp->fsize, S_CAST(uint64_t, kPvarFileKeyHashSpan));
+  unsigned char* hashbuf = R_CAST(unsigned char*, g_textbuf);
+  if (fread_checked(hashbuf, span, ff)) {
+    fclose(ff);
+    return 1;
+  }
+  keyp->head_hash = Hash32(hashbuf, span);
+  if (fseeko(ff, keyp->fsize - span, SEEK_SET) ||
+      fread_checked(hashbuf, span, ff)) {
+    fclose(ff);
+    return 1;
+  }
+  keyp->tail_hash = Hash32(hashbuf, span);
+  fclose(ff);
+  return 0;
+}
+
+void PvarFileKeySerialize(const PvarFileKey* keyp, unsigned char* dst) {
+  memcpy(dst, &keyp->fsize, sizeof(int64_t));
+  memcpy(&(dst[8]), &keyp->mtime, sizeof(int64_t));
+  memcpy(&(dst[16]), &keyp->head_hash, sizeof(int32_t));
+  memcpy(&(dst[20]), &keyp->tail_hash, sizeof(int32_t));
+}
+
+uint32_t PvarFileKeyMatch(const unsigned char* serialized, const PvarFileKey* keyp) {
+  unsigned char cur_serialized[kPvarFileKeyBlen];
+  PvarFileKeySerialize(keyp, cur_serialized);
+  return memequal(serialized, cur_serialized, kPvarFileKeyBlen);
+}
+
+typedef struct PvarVidxStruct {
+  NONCOPYABLE(PvarVidxStruct);
+  // frame_ct + 1 entries; the last is a sentinel with fpos == .pvar.zst size
+  // and variant_idx_start == variant_ct
+  PvarVidxFrame* frames;
+  const char** chr_names;
+  uint32_t* multiallelic_buf;
+  uint64_t multiallelic_fpos;
+  uint32_t variant_ct;
+  uint32_t frame_ct;
+  uint32_t chr_name_ct;
+  uint32_t bp_sorted;
+} PvarVidx;
+
+static void PreinitPvarVidx(PvarVidx* pvp) {
+  pvp->frames = nullptr;
+  pvp->chr_names = nullptr;
+  pvp->multiallelic_buf = nullptr;
+  pvp->multiallelic_fpos = 0;
+  pvp->variant_ct = 0;
+  pvp->frame_ct = 0;
+  pvp->chr_name_ct = 0;
+  pvp->bp_sorted = 0;
+}
+
+// Loads <pvarname>.vidx, if it exists and matches the .pvar.zst.  On success,
+// *vidx_ffp is left open (for later multiallelic-entry reads) iff the index
+// is usable.
+static PglErr PvarVidxInit(const char* pvarname, unsigned char* arena_end, unsigned char** arena_base_ptr, FILE** vidx_ffp, PvarVidx* pvp) {
+  char* fname_end = strcpya(g_textbuf, pvarname);
+  snprintf(fname_end, kMaxOutfnameExtBlen, ".vidx");
+  FILE* vidx_ff = fopen(g_textbuf, FOPEN_RB);
+  if (!vidx_ff) {
+    return kPglRetSuccess;
+  }
+  *vidx_ffp = vidx_ff;
+  unsigned char header[kPvarVidxHeaderSize];
+  uint64_t vidx_fsize;
+  PvarFileKey pvar_key;
+  if (unlikely(fseeko(vidx_ff, 0, SEEK_END))) {
+    goto PvarVidxInit_ret_READ_FAIL;
+  }
+  vidx_fsize = ftello(vidx_ff);
+  rewind(vidx_ff);
+  if ((vidx_fsize < kPvarVidxHeaderSize) || (!fread_unlocked(header, kPvarVidxHeaderSize, 1, vidx_ff)) || (!memequal_k(header, "\x6c\x1b\x31", 3)) || (header[3] != 1)) {
+    logerrprintfww("Warning: Ignoring %s, since it is not a valid .vidx file.\n", g_textbuf);
+    goto PvarVidxInit_ret_IGNORE;
+  }
+  {
+    PreinitPvarFileKey(&pvar_key);
+    const BoolErr key_fail = PvarFileKeyInit(pvarname, &pvar_key);
+    // PvarFileKeyInit() clobbers g_textbuf.
+    snprintf(strcpya(g_textbuf, pvarname), kMaxOutfnameExtBlen, ".vidx");
+    if (key_fail || (!PvarFileKeyMatch(&(header[24]), &pvar_key))) {
+      logerrprintfww("Warning: Ignoring %s, since it doesn't match the current %s.\n", g_textbuf, pvarname);
+      goto PvarVidxInit_ret_IGNORE;
+    }
+  }
+  memcpy(&pvp->variant_ct, &(header[4]), sizeof(int32_t));
+  memcpy(&pvp->frame_ct, &(header[8]), sizeof(int32_t));
+  memcpy(&pvp->chr_name_ct, &(header[12]), sizeof(int32_t));
+  uint32_t multiallelic_tot;
+  memcpy(&multiallelic_tot, &(header[20]), sizeof(int32_t));
+  {
+    uint32_t index_flags;
+    memcpy(&index_flags, &(header[16]), sizeof(int32_t));
+    pvp->bp_sorted = index_flags & 1;
+  }
+  {
+    const uint32_t frame_ct = pvp->frame_ct;
+    const uint32_t variant_ct = pvp->variant_ct;
+    pvp->multiallelic_fpos = kPvarVidxHeaderSize;
+    const uint64_t frames_fpos = kPvarVidxHeaderSize + multiallelic_tot * S_CAST(uint64_t, sizeof(int32_t));
+    const uint64_t chr_names_fpos = frames_fpos + frame_ct * S_CAST(uint64_t, sizeof(PvarVidxFrame));
+    if (unlikely(vidx_fsize <= chr_names_fpos)) {
+      goto PvarVidxInit_ret_MALFORMED;
+    }
+    pvp->frames = S_CAST(PvarVidxFrame*, arena_alloc(arena_end, (frame_ct + 1) * sizeof(PvarVidxFrame), arena_base_ptr));
+    if (unlikely(!pvp->frames ||
+                 arena_alloc_u32(arena_end, kPvarVidxFrameVariantCt, arena_base_ptr, &pvp->multiallelic_buf))) {
+      goto PvarVidxInit_ret_NOMEM;
+    }
+    PvarVidxFrame* frames = pvp->frames;
+    if (unlikely(fseeko(vidx_ff, frames_fpos, SEEK_SET) ||
+                 (frame_ct && (!fread_unlocked(frames, frame_ct * sizeof(PvarVidxFrame), 1, vidx_ff))))) {
+      goto PvarVidxInit_ret_READ_FAIL;
+    }
+    frames[frame_ct].fpos = pvar_key.fsize;
+    frames[frame_ct].variant_idx_start = variant_ct;
+    frames[frame_ct].chr_name_idx = UINT32_MAX;
+    frames[frame_ct].multiallelic_ct = 0;
+    frames[frame_ct].flags = kfPvarVidxFrameNoSkip;
+    if (unlikely(frame_ct && frames[0].variant_idx_start)) {
+      goto PvarVidxInit_ret_MALFORMED;
+    }
+    uintptr_t multiallelic_ct_sum = 0;
+    for (uint32_t frame_idx = 0; frame_idx != frame_ct; ++frame_idx) {
+      const PvarVidxFrame* cur_frame = &(frames[frame_idx]);
+      const uint32_t frame_variant_ct = frames[frame_idx + 1].variant_idx_start - cur_frame->variant_idx_start;
+      if (unlikely((frame_variant_ct - 1 >= S_CAST(uint32_t, kPvarVidxFrameVariantCt)) || (cur_frame->multiallelic_ct > frame_variant_ct) || (cur_frame->chr_name_idx >= pvp->chr_name_ct) || (cur_frame->fpos >= frames[frame_idx + 1].fpos))) {
+        goto PvarVidxInit_ret_MALFORMED;
+      }
+      multiallelic_ct_sum += cur_frame->multiallelic_ct;
+    }
+    if (unlikely(multiallelic_ct_sum != multiallelic_tot)) {
+      goto PvarVidxInit_ret_MALFORMED;
+    }
+    const uintptr_t chr_names_blen = vidx_fsize - chr_names_fpos;
+    const uint32_t chr_name_ct = pvp->chr_name_ct;
+    char* chr_names_buf;
+    if (unlikely(arena_alloc_c(arena_end, chr_names_blen, arena_base_ptr, &chr_names_buf) ||
+                 arena_alloc_kcp(arena_end, chr_name_ct, arena_base_ptr, &pvp->chr_names))) {
+      goto PvarVidxInit_ret_NOMEM;
+    }
+    if (unlikely(fseeko(vidx_ff, chr_names_fpos, SEEK_SET) ||
+                 (!fread_unlocked(chr_names_buf, chr_names_blen, 1, vidx_ff)))) {
+      goto PvarVidxInit_ret_READ_FAIL;
+    }
+    if (unlikely(chr_names_buf[chr_names_blen - 1])) {
+      goto PvarVidxInit_ret_MALFORMED;
+    }
+    const char* chr_names_end = &(chr_names_buf[chr_names_blen]);
+    const char* chr_names_iter = chr_names_buf;
+    for (uint32_t chr_name_idx = 0; chr_name_idx != chr_name_ct; ++chr_name_idx) {
+      if (unlikely(chr_names_iter == chr_names_end)) {
+        goto PvarVidxInit_ret_MALFORMED;
+      }
+      pvp->chr_names[chr_name_idx] = chr_names_iter;
+      chr_names_iter = &(chr_names_iter[strlen(chr_names_iter) + 1]);
+    }
+  }
+  return kPglRetSuccess;
+ PvarVidxInit_ret_IGNORE:
+  fclose(vidx_ff);
+  *vidx_ffp = nullptr;
+  return kPglRetSuccess;
+ PvarVidxInit_ret_READ_FAIL:
+  if (feof_unlocked(vidx_ff)) {
+    errno = 0;
+  }
+  logerrprintfww(kErrprintfFread, g_textbuf, rstrerror(errno));
+  return kPglRetReadFail;
+ PvarVidxInit_ret_MALFORMED:
+  logerrprintfww("Error: %s is corrupt. (Delete it, or regenerate it with --make-just-pvar zs vidx.)\n", g_textbuf);
+  return kPglRetMalformedInput;
+ PvarVidxInit_ret_NOMEM:
+  return kPglRetNomem;
+}
+
+// Keeps the --set-{missing,all}-var-ids templates in sync with the current
+// chromosome.
+static void VaridTemplatesSetChr(const ChrInfo* cip, uint32_t chr_code, char* chr_output_name_buf, VaridTemplate* varid_templatep, VaridTemplate* varid_multi_templatep, VaridTemplate* varid_multi_nonsnp_templatep, uint32_t* max_chr_slen_ptr) {
+  char* chr_name_end = chrtoa(cip, chr_code, chr_output_name_buf);
+  const uint32_t chr_slen = chr_name_end - chr_output_name_buf;
+  if (chr_slen > (*max_chr_slen_ptr)) {
+    *max_chr_slen_ptr = chr_slen;
+  }
+  const int32_t chr_slen_delta = chr_slen - varid_templatep->chr_slen;
+  varid_templatep->chr_slen = chr_slen;
+  varid_templatep->base_len += chr_slen_delta;
+  if (varid_multi_templatep) {
+    varid_multi_templatep->chr_slen = chr_slen;
+    varid_multi_templatep->base_len += chr_slen_delta;
+  }
+  if (varid_multi_nonsnp_templatep) {
+    varid_multi_nonsnp_templatep->chr_slen = chr_slen;
+    varid_multi_nonsnp_templatep->base_len += chr_slen_delta;
+  }
+}
+
+// .pcache binary sidecar (written by --pvar-cache).  Everything LoadPvar()
+// extracts from the variant lines of a .pvar is stored in columnar form, so
+// later runs against an unchanged .pvar can skip the text parse; the header
+// lines are still parsed normally.
+// Layout (little-endian):
+//   bytes 0-2: magic {0x6c, 0x1b, 0x32}
+//   byte 3: format version (currently 0)
+//   bytes 4-7: raw_variant_ct
+//   bytes 8-11: run_ct (number of chromosomes)
+//   bytes 12-15: PvarCacheFlags
+//   bytes 16-19: maximum INFO length
+//   bytes 20-23: hash of the chromosome-set settings the stored codes depend
+//                on
+//   bytes 24-31: .pvar byte size
+//   bytes 32-39: .pvar modification time
+//   bytes 40-43: hash of the first kPvarFileKeyHashSpan bytes of the .pvar
+//   bytes 44-47: hash of the last kPvarFileKeyHashSpan bytes of the .pvar
+//   bytes 48-55: allele_idx_end
+//   bytes 56-63: long-allele blob length
+//   bytes 64-71: variant ID blob length
+//   bytes 72-79: FILTER blob length
+//   bytes 80-87: chromosome name blob length
+//   bytes 88-91: CRC-32 of the entire .pvar (if kfPvarCacheFullHash)
+//   bytes 92-95: reserved (zero)
+//   then run_ct PvarCacheRun records
+//   then the chromosome name blob: null-terminated names of the nonstandard
+//     chromosomes, in file order
+//   then variant_include (bitarrays are rounded up to a whole byte)
+//   then raw_variant_ct uint32 bp coordinates
+//   then raw_variant_ct + 1 uint64 allele_idx_offsets (if multiallelic)
+//   then the QUAL-present bitarray and raw_variant_ct floats (if QUAL)
+//   then the FILTER-present and FILTER-nonpass bitarrays (if FILTER)
+//   then the INFO/PR bitarray (if INFO/PR header line)
+//   then raw_variant_ct doubles (if any CM value is nonzero)
+//   then allele_idx_end bytes: the allele code if it's a single character, 0
+//     if it's in the long-allele blob
+//   then the long-allele, variant ID, and non-PASS FILTER blobs, each a
+//     sequence of null-terminated strings in variant order
+CONSTI32(kPvarCacheHeaderSize, 96);
+
+FLAGSET_DEF_START()
+  kfPvarCache0,
+  kfPvarCacheQual = (1 << 0),
+  kfPvarCacheFilter = (1 << 1),
+  kfPvarCacheInfo = (1 << 2),
+  kfPvarCacheNonref = (1 << 3),
+  kfPvarCacheCm = (1 << 4),
+  kfPvarCacheMultiallelic = (1 << 5),
+  kfPvarCacheFullHash = (1 << 6)
+FLAGSET_DEF_END(PvarCacheFlags);
+
+FLAGSET_DEF_START()
+  kfPvarCacheRun0,
+  kfPvarCacheRunUnsortedBp = (1 << 0),
+  kfPvarCacheRunUnsortedCm = (1 << 1),
+  kfPvarCacheRunNzeroCm = (1 << 2),
+  kfPvarCacheRunNpass = (1 << 3)
+FLAGSET_DEF_END(PvarCacheRunFlags);
+
+// One record per chromosome, in file order.  The maxima let a --chr/--not-chr
+// load report the same values as the text parse.
+typedef struct PvarCacheRunStruct {
+  uint32_t variant_idx_start;
+  // UINT32_MAX for a nonstandard chromosome, whose name is then the next one
+  // in the name blob
+  uint32_t chr_code;
+  uint32_t max_allele_slen;
+  uint32_t max_variant_id_slen;
+  uint32_t max_extra_alt_ct;
+  uint32_t max_filter_slen;
+  uint32_t flags;
+  uint32_t reserved;
+} PvarCacheRun;
+
+static_assert(sizeof(PvarCacheRun) == 32, "PvarCacheRun must be 32 bytes.");
+
+// The default key (the PvarFileKey) is cheap to compute on every run, but
+// it's weak: a same-size edit in the middle of the file that also preserves
+// the mtime goes undetected.  "--pvar-cache full-hash" adds a CRC-32 of the
+// entire file, which every later load through that .pcache then recomputes.
+typedef struct PvarCacheKeyStruct {
+  PvarFileKey file;
+  uint32_t chrset_hash;
+  uint32_t full_hash;
+  uint32_t full_hash_present;
+} PvarCacheKey;
+
+static void PreinitPvarCacheKey(PvarCacheKey* keyp) {
+  PreinitPvarFileKey(&keyp->file);
+  keyp->chrset_hash = 0;
+  keyp->full_hash = 0;
+  keyp->full_hash_present = 0;
+}
+
+typedef struct PvarCacheStruct {
+  uint64_t allele_idx_end;
+  uint64_t long_allele_blen;
+  uint64_t id_blen;
+  uint64_t filter_blen;
+  uint64_t chr_names_blen;
+
+  // filled by PvarCacheLayoutInit()
+  uint64_t include_fpos;
+  uint64_t bps_fpos;
+  uint64_t allele_idx_offsets_fpos;
+  uint64_t qual_fpos;
+  uint64_t filter_fpos;
+  uint64_t nonref_fpos;
+  uint64_t cms_fpos;
+  uint64_t allele_chars_fpos;
+  uint64_t long_alleles_fpos;
+  uint64_t ids_fpos;
+  uint64_t filter_strs_fpos;
+  uint64_t fsize;
+
+  uint32_t raw_variant_ct;
+  uint32_t run_ct;
+  PvarCacheFlags flags;
+  uint32_t info_max_slen;
+} PvarCache;
+
+static void PvarCacheLayoutInit(PvarCache* pcp) {
+  const uint64_t raw_variant_ct = pcp->raw_variant_ct;
+  const uint64_t bitarr_blen = DivUp(raw_variant_ct, CHAR_BIT);
+  const PvarCacheFlags flags = pcp->flags;
+  uint64_t fpos = kPvarCacheHeaderSize + pcp->run_ct * S_CAST(uint64_t, sizeof(PvarCacheRun)) + pcp->chr_names_blen;
+  pcp->include_fpos = fpos;
+  fpos += bitarr_blen;
+  pcp->bps_fpos = fpos;
+  fpos += raw_variant_ct * sizeof(int32_t);
+  pcp->allele_idx_offsets_fpos = fpos;
+  if (flags & kfPvarCacheMultiallelic) {
+    fpos += (raw_variant_ct + 1) * sizeof(int64_t);
+  }
+  pcp->qual_fpos = fpos;
+  if (flags & kfPvarCacheQual) {
+    fpos += bitarr_blen + raw_variant_ct * sizeof(float);
+  }
+  pcp->filter_fpos = fpos;
+  if (flags & kfPvarCacheFilter) {
+    fpos += 2 * bitarr_blen;
+  }
+  pcp->nonref_fpos = fpos;
+  if (flags & kfPvarCacheNonref) {
+    fpos += bitarr_blen;
+  }
+  pcp->cms_fpos = fpos;
+  if (flags & kfPvarCacheCm) {
+    fpos += raw_variant_ct * sizeof(double);
+  }
+  pcp->allele_chars_fpos = fpos;
+  fpos += pcp->allele_idx_end;
+  pcp->long_alleles_fpos = fpos;
+  fpos += pcp->long_allele_blen;
+  pcp->ids_fpos = fpos;
+  fpos += pcp->id_blen;
+  pcp->filter_strs_fpos = fpos;
+  pcp->fsize = fpos + pcp->filter_blen;
+}
+
+// Fills keyp->full_hash.  Clobbers g_textbuf.
+static BoolErr PvarCacheFullHash(const char* pvarname, PvarCacheKey* keyp) {
+  FILE* pvar_ff = fopen(pvarname, FOPEN_RB);
+  if (!pvar_ff) {
+    return 1;
+  }
+  unsigned char* hashbuf = R_CAST(unsigned char*, g_textbuf);
+  uint32_t crc = 0;
+  for (uint64_t bytes_left = keyp->file.fsize; bytes_left; ) {
+    const uint32_t cur_blen = MINV(bytes_left, S_CAST(uint64_t, kTextbufMainSize));
+    if (fread_checked(hashbuf, cur_blen, pvar_ff)) {
+      fclose(pvar_ff);
+      return 1;
+    }
+    crc = libdeflate_crc32(crc, hashbuf, cur_blen);
+    bytes_left -= cur_blen;
+  }
+  fclose(pvar_ff);
+  keyp->full_hash = crc;
+  keyp->full_hash_present = 1;
+  return 0;
+}
+
+// Returns 1 if the .pvar can't be cached (e.g. it's a named pipe).
+// Clobbers g_textbuf.
+static BoolErr PvarCacheKeyInit(const char* pvarname, const ChrInfo* cip, uint32_t full_hash, PvarCacheKey* keyp) {
+  if (PvarFileKeyInit(pvarname, &keyp->file)) {
+    return 1;
+  }
+  uint32_t chrset_key[5 + kChrOffsetCt];
+  chrset_key[0] = cip->autosome_ct;
+  chrset_key[1] = cip->max_numeric_code;
+  chrset_key[2] = cip->max_code;
+  chrset_key[3] = cip->zero_extra_chrs;
+  chrset_key[4] = ctou32(*g_input_missing_geno_ptr);
+  memcpy(&(chrset_key[5]), &(cip->xymt_codes[0]), kChrOffsetCt * sizeof(int32_t));
+  keyp->chrset_hash = Hash32(chrset_key, sizeof(chrset_key));
+  return full_hash && PvarCacheFullHash(pvarname, keyp);
+}
+
+// Opens cache_fname if it exists and matches the key.  *cache_ffp is left at
+// nullptr if there's no usable cache.  If the .pcache was written with
+// 'full-hash', the whole .pvar is hashed here (filling keyp->full_hash) when
+// the key doesn't have that yet; conversely, a .pcache without a full hash
+// isn't usable when keyp has one.
+static PglErr PvarCacheOpen(const char* cache_fname, const char* pvarname, PvarCacheKey* keyp, FILE** cache_ffp, PvarCache* pcp) {
+  FILE* cache_ff = fopen(cache_fname, FOPEN_RB);
+  if (!cache_ff) {
+    return kPglRetSuccess;
+  }
+  unsigned char header[kPvarCacheHeaderSize];
+  uint64_t cache_fsize;
+  if (unlikely(fseeko(cache_ff, 0, SEEK_END))) {
+    goto PvarCacheOpen_ret_READ_FAIL;
+  }
+  cache_fsize = ftello(cache_ff);
+  rewind(cache_ff);
+  if ((cache_fsize < kPvarCacheHeaderSize) || (!fread_unlocked(header, kPvarCacheHeaderSize, 1, cache_ff)) || (!memequal_k(header, "\x6c\x1b\x32", 3))) {
+    logerrprintfww("Warning: Ignoring %s, since it is not a valid .pcache file.\n", cache_fname);
+    goto PvarCacheOpen_ret_IGNORE;
+  }
+  if (header[3]) {
+    // written by a later format version; --pvar-cache replaces it
+    goto PvarCacheOpen_ret_IGNORE;
+  }
+  {
+    uint32_t chrset_hash;
+    memcpy(&chrset_hash, &(header[20]), sizeof(int32_t));
+    if (!PvarFileKeyMatch(&(header[24]), &keyp->file)) {
+      logerrprintfww("Warning: Ignoring %s, since it doesn't match the current %s.\n", cache_fname, pvarname);
+      goto PvarCacheOpen_ret_IGNORE;
+    }
+    if (chrset_hash != keyp->chrset_hash) {
+      logerrprintfww("Warning: Ignoring %s, since it was generated under different chromosome-set settings.\n", cache_fname);
+      goto PvarCacheOpen_ret_IGNORE;
+    }
+  }
+  memcpy(&pcp->raw_variant_ct, &(header[4]), sizeof(int32_t));
+  memcpy(&pcp->run_ct, &(header[8]), sizeof(int32_t));
+  {
+    uint32_t cache_flags;
+    memcpy(&cache_flags, &(header[12]), sizeof(int32_t));
+    pcp->flags = S_CAST(PvarCacheFlags, cache_flags);
+  }
+  if (pcp->flags & kfPvarCacheFullHash) {
+    if ((!keyp->full_hash_present) && PvarCacheFullHash(pvarname, keyp)) {
+      goto PvarCacheOpen_ret_IGNORE;
+    }
+    uint32_t full_hash;
+    memcpy(&full_hash, &(header[88]), sizeof(int32_t));
+    if (full_hash != keyp->full_hash) {
+      logerrprintfww("Warning: Ignoring %s, since it doesn't match the current %s.\n", cache_fname, pvarname);
+      goto PvarCacheOpen_ret_IGNORE;
+    }
+  } else if (keyp->full_hash_present) {
+    // --pvar-cache full-hash replaces it
+    goto PvarCacheOpen_ret_IGNORE;
+  }
+  memcpy(&pcp->info_max_slen, &(header[16]), sizeof(int32_t));
+  memcpy(&pcp->allele_idx_end, &(header[48]), sizeof(int64_t));
+  memcpy(&pcp->long_allele_blen, &(header[56]), sizeof(int64_t));
+  memcpy(&pcp->id_blen, &(header[64]), sizeof(int64_t));
+  memcpy(&pcp->filter_blen, &(header[72]), sizeof(int64_t));
+  memcpy(&pcp->chr_names_blen, &(header[80]), sizeof(int64_t));
+  PvarCacheLayoutInit(pcp);
+  if (unlikely(pcp->fsize != cache_fsize)) {
+    logerrprintfww("Error: %s is corrupt. (Delete it, or regenerate it with --pvar-cache.)\n", cache_fname);
+    fclose(cache_ff);
+    return kPglRetMalformedInput;
+  }
+  *cache_ffp = cache_ff;
+  return kPglRetSuccess;
+ PvarCacheOpen_ret_IGNORE:
+  fclose(cache_ff);
+  return kPglRetSuccess;
+ PvarCacheOpen_ret_READ_FAIL:
+  logerrprintfww(kErrprintfFread, cache_fname, rstrerror(errno));
+  fclose(cache_ff);
+  return kPglRetReadFail;
+}
+
+static BoolErr PvarCacheReadBitarr(uint32_t bit_ct, FILE* cache_ff, uintptr_t* bitarr) {
+  const uint32_t word_ct = BitCtToWordCt(bit_ct);
+  if (word_ct) {
+    bitarr[word_ct - 1] = 0;
+  }
+  if (unlikely(fread_checked(bitarr, DivUp(bit_ct, CHAR_BIT), cache_ff))) {
+    return 1;
+  }
+  ZeroTrailingBits(bit_ct, bitarr);
+  return 0;
+}
+
+// Fills in the LoadPvar() variant arrays from an open .pcache.  Return arrays
+// are allocated in the same order as by the text parse.  Variants on
+// chromosomes excluded by cip->chr_mask are cleared from variant_include, but
+// (unlike the text parse) otherwise keep their stored values.
+static PglErr PvarCacheLoad(const char* cache_fname, const PvarCache* pcp, uint32_t qual_wanted, uint32_t filter_wanted, uint32_t info_pr_present, uint32_t allow_extra_chrs, FILE* cache_ff, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uint32_t* max_filter_slen_ptr) {
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t raw_variant_ct = pcp->raw_variant_ct;
+    const uint32_t run_ct = pcp->run_ct;
+    const PvarCacheFlags flags = pcp->flags;
+    const uintptr_t allele_idx_end = pcp->allele_idx_end;
+    const uint32_t is_multiallelic = (allele_idx_end > 2 * S_CAST(uintptr_t, raw_variant_ct));
+    // QUAL and FILTER are always stored when the column is present, so a
+    // mismatch means the .pcache doesn't belong to this header.
+    if (unlikely((run_ct > raw_variant_ct) || ((!run_ct) != (!raw_variant_ct)) || (allele_idx_end < 2 * S_CAST(uintptr_t, raw_variant_ct)) || (is_multiallelic != ((flags / kfPvarCacheMultiallelic) & 1)) || (info_pr_present != ((flags / kfPvarCacheNonref) & 1)) || (qual_wanted && (!(flags & kfPvarCacheQual))) || (filter_wanted && (!(flags & kfPvarCacheFilter))))) {
+      goto PvarCacheLoad_ret_MALFORMED;
+    }
+    // Strings stay at the end of the workspace, as with the text parse.
+    char* long_alleles;
+    char* ids_blob;
+    char* filter_strs = nullptr;
+    if (unlikely(bigstack_end_alloc_c(pcp->long_allele_blen, &long_alleles) ||
+                 bigstack_end_alloc_c(pcp->id_blen, &ids_blob) ||
+                 (filter_wanted && bigstack_end_alloc_c(pcp->filter_blen, &filter_strs)))) {
+      goto PvarCacheLoad_ret_NOMEM;
+    }
+    unsigned char* tmp_alloc_end = g_bigstack_end;
+    PvarCacheRun* runs = S_CAST(PvarCacheRun*, bigstack_end_alloc(run_ct * sizeof(PvarCacheRun)));
+    char* chr_names;
+    uintptr_t* loaded_chr_mask;
+    if (unlikely((!runs) ||
+                 bigstack_end_alloc_c(pcp->chr_names_blen, &chr_names) ||
+                 bigstack_end_alloc_w(kChrMaskWords, &loaded_chr_mask))) {
+      goto PvarCacheLoad_ret_NOMEM;
+    }
+    ZeroWArr(kChrMaskWords, loaded_chr_mask);
+    if (unlikely(fseeko(cache_ff, kPvarCacheHeaderSize, SEEK_SET) ||
+                 fread_checked(runs, run_ct * sizeof(PvarCacheRun), cache_ff) ||
+                 fread_checked(chr_names, pcp->chr_names_blen, cache_ff))) {
+      goto PvarCacheLoad_ret_READ_FAIL;
+    }
+    if (unlikely(pcp->chr_names_blen && chr_names[pcp->chr_names_blen - 1])) {
+      goto PvarCacheLoad_ret_MALFORMED;
+    }
+    const char* chr_names_iter = chr_names;
+    const char* chr_names_end = &(chr_names[pcp->chr_names_blen]);
+    const uintptr_t* chr_mask = cip->chr_mask;
+    uint32_t max_variant_id_slen = *max_variant_id_slen_ptr;
+    uint32_t max_extra_alt_ct = 0;
+    uint32_t max_allele_slen = 1;
+    uint32_t max_filter_slen = 0;
+    uint32_t included_run_flags = 0;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != run_ct; ++chr_fo_idx) {
+      const PvarCacheRun* cur_run = &(runs[chr_fo_idx]);
+      const uint32_t variant_uidx_start = cur_run->variant_idx_start;
+      if (unlikely(chr_fo_idx? (variant_uidx_start <= runs[chr_fo_idx - 1].variant_idx_start) : variant_uidx_start)) {
+        goto PvarCacheLoad_ret_MALFORMED;
+      }
+      uint32_t chr_code = cur_run->chr_code;
+      if (chr_code == UINT32_MAX) {
+        if (unlikely(chr_names_iter == chr_names_end)) {
+          goto PvarCacheLoad_ret_MALFORMED;
+        }
+        const uint32_t name_slen = strlen(chr_names_iter);
+        reterr = GetOrAddChrCode(chr_names_iter, cache_fname, 0, name_slen, allow_extra_chrs, cip, &chr_code);
+        if (unlikely(reterr)) {
+          goto PvarCacheLoad_ret_1;
+        }
+        chr_names_iter = &(chr_names_iter[name_slen + 1]);
+      } else if (unlikely(chr_code > cip->max_code)) {
+        goto PvarCacheLoad_ret_MALFORMED;
+      }
+      if (unlikely(IsSet(loaded_chr_mask, chr_code))) {
+        goto PvarCacheLoad_ret_MALFORMED;
+      }
+      SetBit(chr_code, loaded_chr_mask);
+      cip->chr_file_order[chr_fo_idx] = chr_code;
+      cip->chr_fo_vidx_start[chr_fo_idx] = variant_uidx_start;
+      cip->chr_idx_to_foidx[chr_code] = chr_fo_idx;
+      const uint32_t is_included = IsSet(chr_mask, chr_code);
+      if ((is_included || info_pr_present) && (cur_run->max_extra_alt_ct > max_extra_alt_ct)) {
+        max_extra_alt_ct = cur_run->max_extra_alt_ct;
+      }
+      if (is_included) {
+        if (cur_run->max_allele_slen > max_allele_slen) {
+          max_allele_slen = cur_run->max_allele_slen;
+        }
+        if (cur_run->max_variant_id_slen > max_variant_id_slen) {
+          max_variant_id_slen = cur_run->max_variant_id_slen;
+        }
+        if (filter_wanted && (cur_run->max_filter_slen > max_filter_slen)) {
+          max_filter_slen = cur_run->max_filter_slen;
+        }
+        included_run_flags |= cur_run->flags;
+      }
+    }
+    if (unlikely((chr_names_iter != chr_names_end) || (run_ct && (runs[run_ct - 1].variant_idx_start >= raw_variant_ct)) || (max_extra_alt_ct >= kPglMaxAltAlleleCt) || (max_variant_id_slen > kMaxIdSlen))) {
+      goto PvarCacheLoad_ret_MALFORMED;
+    }
+    cip->chr_fo_vidx_start[run_ct] = raw_variant_ct;
+    cip->chr_ct = run_ct;
+    UnsortedVar vpos_sortstatus = kfUnsortedVar0;
+    if (included_run_flags & kfPvarCacheRunUnsortedBp) {
+      vpos_sortstatus |= kfUnsortedVarBp;
+    }
+    if (included_run_flags & kfPvarCacheRunUnsortedCm) {
+      vpos_sortstatus |= kfUnsortedVarCm;
+    }
+    const uint32_t filter_storage_needed = filter_wanted && (included_run_flags & kfPvarCacheRunNpass);
+
+    const uint32_t raw_variant_ctl = BitCtToWordCt(raw_variant_ct);
+    const char** allele_storage;
+    if (unlikely(bigstack_alloc_kcp(allele_idx_end, &allele_storage) ||
+                 bigstack_alloc_w(raw_variant_ctl, variant_include_ptr) ||
+                 bigstack_alloc_u32(raw_variant_ct, variant_bps_ptr) ||
+                 bigstack_alloc_cp(raw_variant_ct, variant_ids_ptr))) {
+      goto PvarCacheLoad_ret_NOMEM;
+    }
+    uintptr_t* variant_include = *variant_include_ptr;
+    char** variant_ids = *variant_ids_ptr;
+    if (unlikely(fseeko(cache_ff, pcp->include_fpos, SEEK_SET) ||
+                 PvarCacheReadBitarr(raw_variant_ct, cache_ff, variant_include) ||
+                 fread_checked(*variant_bps_ptr, raw_variant_ct * sizeof(int32_t), cache_ff))) {
+      goto PvarCacheLoad_ret_READ_FAIL;
+    }
+    uintptr_t* qual_present = nullptr;
+    if (qual_wanted) {
+      if (unlikely(bigstack_alloc_w(raw_variant_ctl, qual_present_ptr) ||
+                   bigstack_alloc_f(raw_variant_ct, quals_ptr))) {
+        goto PvarCacheLoad_ret_NOMEM;
+      }
+      qual_present = *qual_present_ptr;
+      if (unlikely(fseeko(cache_ff, pcp->qual_fpos, SEEK_SET) ||
+                   PvarCacheReadBitarr(raw_variant_ct, cache_ff, qual_present) ||
+                   fread_checked(*quals_ptr, raw_variant_ct * sizeof(float), cache_ff))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+    }
+    uintptr_t* filter_present = nullptr;
+    uintptr_t* filter_npass = nullptr;
+    if (filter_wanted) {
+      if (unlikely(bigstack_alloc_w(raw_variant_ctl, filter_present_ptr) ||
+                   bigstack_alloc_w(raw_variant_ctl, filter_npass_ptr))) {
+        goto PvarCacheLoad_ret_NOMEM;
+      }
+      filter_present = *filter_present_ptr;
+      filter_npass = *filter_npass_ptr;
+      if (unlikely(fseeko(cache_ff, pcp->filter_fpos, SEEK_SET) ||
+                   PvarCacheReadBitarr(raw_variant_ct, cache_ff, filter_present) ||
+                   PvarCacheReadBitarr(raw_variant_ct, cache_ff, filter_npass))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+      if (filter_storage_needed) {
+        if (unlikely(bigstack_alloc_cp(raw_variant_ct, filter_storage_ptr))) {
+          goto PvarCacheLoad_ret_NOMEM;
+        }
+        char** filter_storage = *filter_storage_ptr;
+        if (unlikely(fseeko(cache_ff, pcp->filter_strs_fpos, SEEK_SET) ||
+                     fread_checked(filter_strs, pcp->filter_blen, cache_ff))) {
+          goto PvarCacheLoad_ret_READ_FAIL;
+        }
+        if (unlikely((!pcp->filter_blen) || filter_strs[pcp->filter_blen - 1])) {
+          goto PvarCacheLoad_ret_MALFORMED;
+        }
+        const char* filter_strs_end = &(filter_strs[pcp->filter_blen]);
+        char* filter_strs_iter = filter_strs;
+        uintptr_t variant_uidx_base = 0;
+        uintptr_t cur_bits = filter_npass[0];
+        const uint32_t npass_ct = PopcountWords(filter_npass, raw_variant_ctl);
+        for (uint32_t npass_idx = 0; npass_idx != npass_ct; ++npass_idx) {
+          const uintptr_t variant_uidx = BitIter1(filter_npass, &variant_uidx_base, &cur_bits);
+          if (unlikely(filter_strs_iter == filter_strs_end)) {
+            goto PvarCacheLoad_ret_MALFORMED;
+          }
+          filter_storage[variant_uidx] = filter_strs_iter;
+          filter_strs_iter = &(filter_strs_iter[strlen(filter_strs_iter) + 1]);
+        }
+      }
+    }
+    if (info_pr_present) {
+      if (unlikely(bigstack_alloc_w(raw_variant_ctl, nonref_flags_ptr))) {
+        goto PvarCacheLoad_ret_NOMEM;
+      }
+      if (unlikely(fseeko(cache_ff, pcp->nonref_fpos, SEEK_SET) ||
+                   PvarCacheReadBitarr(raw_variant_ct, cache_ff, *nonref_flags_ptr))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+    }
+    if (is_multiallelic) {
+      if (unlikely(bigstack_alloc_w(raw_variant_ct + 1, allele_idx_offsets_ptr))) {
+        goto PvarCacheLoad_ret_NOMEM;
+      }
+      uintptr_t* allele_idx_offsets = *allele_idx_offsets_ptr;
+      if (unlikely(fseeko(cache_ff, pcp->allele_idx_offsets_fpos, SEEK_SET))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+#ifdef __LP64__
+      if (unlikely(fread_checked(allele_idx_offsets, (raw_variant_ct + 1) * sizeof(int64_t), cache_ff))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+#else
+      for (uint32_t variant_uidx = 0; variant_uidx <= raw_variant_ct; ++variant_uidx) {
+        uint64_t cur_offset;
+        if (unlikely(!fread_unlocked(&cur_offset, sizeof(int64_t), 1, cache_ff))) {
+          goto PvarCacheLoad_ret_READ_FAIL;
+        }
+        allele_idx_offsets[variant_uidx] = cur_offset;
+      }
+#endif
+      if (unlikely(allele_idx_offsets[0] || (allele_idx_offsets[raw_variant_ct] != allele_idx_end))) {
+        goto PvarCacheLoad_ret_MALFORMED;
+      }
+    }
+    if (included_run_flags & kfPvarCacheRunNzeroCm) {
+      if (unlikely(!(flags & kfPvarCacheCm))) {
+        goto PvarCacheLoad_ret_MALFORMED;
+      }
+      if (unlikely(bigstack_alloc_d(raw_variant_ct, variant_cms_ptr))) {
+        goto PvarCacheLoad_ret_NOMEM;
+      }
+      if (unlikely(fseeko(cache_ff, pcp->cms_fpos, SEEK_SET) ||
+                   fread_checked(*variant_cms_ptr, raw_variant_ct * sizeof(double), cache_ff))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+    } else {
+      *variant_cms_ptr = nullptr;
+    }
+
+    // Single-character alleles point into g_one_char_strs[], as with the text
+    // parse.
+    if (unlikely(fseeko(cache_ff, pcp->long_alleles_fpos, SEEK_SET) ||
+                 fread_checked(long_alleles, pcp->long_allele_blen, cache_ff) ||
+                 fread_checked(ids_blob, pcp->id_blen, cache_ff))) {
+      goto PvarCacheLoad_ret_READ_FAIL;
+    }
+    if (unlikely((pcp->long_allele_blen && long_alleles[pcp->long_allele_blen - 1]) || (!pcp->id_blen) || ids_blob[pcp->id_blen - 1])) {
+      goto PvarCacheLoad_ret_MALFORMED;
+    }
+    {
+      const char* long_alleles_end = &(long_alleles[pcp->long_allele_blen]);
+      const char* long_alleles_iter = long_alleles;
+      unsigned char* allele_chars = R_CAST(unsigned char*, g_textbuf);
+      if (unlikely(fseeko(cache_ff, pcp->allele_chars_fpos, SEEK_SET))) {
+        goto PvarCacheLoad_ret_READ_FAIL;
+      }
+      for (uintptr_t allele_idx_base = 0; allele_idx_base < allele_idx_end; allele_idx_base += kTextbufMainSize) {
+        const uintptr_t cur_allele_ct = MINV(allele_idx_end - allele_idx_base, S_CAST(uintptr_t, kTextbufMainSize));
+        if (unlikely(fread_checked(allele_chars, cur_allele_ct, cache_ff))) {
+          goto PvarCacheLoad_ret_READ_FAIL;
+        }
+        const char** allele_storage_iter = &(allele_storage[allele_idx_base]);
+        for (uintptr_t uii = 0; uii != cur_allele_ct; ++uii) {
+          const uint32_t allele_char = allele_chars[uii];
+          if (allele_char) {
+            allele_storage_iter[uii] = &(g_one_char_strs[2 * allele_char]);
+          } else {
+            if (unlikely(long_alleles_iter == long_alleles_end)) {
+              goto PvarCacheLoad_ret_MALFORMED;
+            }
+            allele_storage_iter[uii] = long_alleles_iter;
+            long_alleles_iter = &(long_alleles_iter[strlen(long_alleles_iter) + 1]);
+          }
+        }
+      }
+      const char* ids_end = &(ids_blob[pcp->id_blen]);
+      char* ids_iter = ids_blob;
+      for (uint32_t variant_uidx = 0; variant_uidx != raw_variant_ct; ++variant_uidx) {
+        if (unlikely(ids_iter == ids_end)) {
+          goto PvarCacheLoad_ret_MALFORMED;
+        }
+        variant_ids[variant_uidx] = ids_iter;
+        ids_iter = &(ids_iter[strlen(ids_iter) + 1]);
+      }
+    }
+
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != run_ct; ++chr_fo_idx) {
+      if (!IsSet(chr_mask, cip->chr_file_order[chr_fo_idx])) {
+        const uint32_t variant_uidx_start = cip->chr_fo_vidx_start[chr_fo_idx];
+        const uint32_t variant_uidx_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+        ClearBitsNz(variant_uidx_start, variant_uidx_end, variant_include);
+        if (qual_present) {
+          ClearBitsNz(variant_uidx_start, variant_uidx_end, qual_present);
+        }
+        if (filter_present) {
+          ClearBitsNz(variant_uidx_start, variant_uidx_end, filter_present);
+          ClearBitsNz(variant_uidx_start, variant_uidx_end, filter_npass);
+        }
+      }
+    }
+    const uint32_t chr_word_ct = BitCtToWordCt(cip->max_code + cip->name_ct + 1);
+    BitvecAnd(loaded_chr_mask, chr_word_ct, cip->chr_mask);
+    BigstackEndReset(tmp_alloc_end);
+    *max_variant_id_slen_ptr = max_variant_id_slen;
+    *vpos_sortstatus_ptr = vpos_sortstatus;
+    *allele_storage_ptr = allele_storage;
+    *raw_variant_ct_ptr = raw_variant_ct;
+    *variant_ct_ptr = PopcountWords(variant_include, raw_variant_ctl);
+    *max_allele_ct_ptr = max_extra_alt_ct + 2;
+    *max_allele_slen_ptr = max_allele_slen;
+    *max_filter_slen_ptr = max_filter_slen;
+  }
+  while (0) {
+  PvarCacheLoad_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  PvarCacheLoad_ret_READ_FAIL:
+    if (feof_unlocked(cache_ff)) {
+      errno = 0;
+    }
+    logerrprintfww(kErrprintfFread, cache_fname, rstrerror(errno));
+    reterr = kPglRetReadFail;
+    break;
+  PvarCacheLoad_ret_MALFORMED:
+    logerrprintfww("Error: %s is corrupt. (Delete it, or regenerate it with --pvar-cache.)\n", cache_fname);
+    reterr = kPglRetMalformedInput;
+    break;
+  }
+ PvarCacheLoad_ret_1:
+  return reterr;
+}
+
+// Writes cache_fname from the arrays of a LoadPvar() text parse which didn't
+// exclude anything.  unsorted_cm_fos has a bit set for each chromosome (in
+// file order) where the parse saw a decreasing centimorgan position.
+static PglErr PvarCacheWrite(const char* cache_fname, const PvarCacheKey* keyp, const ChrInfo* cip, const uintptr_t* variant_include, const uint32_t* variant_bps, char** variant_ids, const uintptr_t* allele_idx_offsets, const char* const* allele_storage, const uintptr_t* qual_present, const float* quals, const uintptr_t* filter_present, const uintptr_t* filter_npass, char** filter_storage, const uintptr_t* nonref_flags, const double* variant_cms, const uintptr_t* unsorted_cm_fos, uint32_t raw_variant_ct, uintptr_t allele_idx_end, uint32_t info_col_present, uint32_t info_max_slen) {
+  unsigned char* bigstack_mark = g_bigstack_base;
+  FILE* outfile = nullptr;
+  char tmp_fname[kPglFnamesize + kMaxOutfnameExtBlen + 4];
+  PglErr reterr = kPglRetSuccess;
+  {
+    const uint32_t run_ct = cip->chr_ct;
+    PvarCacheRun* runs;
+    if (unlikely(BIGSTACK_ALLOC_X(PvarCacheRun, run_ct, &runs))) {
+      goto PvarCacheWrite_ret_NOMEM;
+    }
+    uint64_t chr_names_blen = 0;
+    uint64_t long_allele_blen = 0;
+    uint64_t id_blen = 0;
+    uint64_t filter_blen = 0;
+    uint32_t max_str_slen = kMaxIdSlen;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != run_ct; ++chr_fo_idx) {
+      PvarCacheRun* cur_run = &(runs[chr_fo_idx]);
+      const uint32_t chr_code = cip->chr_file_order[chr_fo_idx];
+      const uint32_t variant_uidx_start = cip->chr_fo_vidx_start[chr_fo_idx];
+      const uint32_t variant_uidx_end = cip->chr_fo_vidx_start[chr_fo_idx + 1];
+      cur_run->variant_idx_start = variant_uidx_start;
+      cur_run->chr_code = chr_code;
+      if (chr_code > cip->max_code) {
+        cur_run->chr_code = UINT32_MAX;
+        chr_names_blen += strlen(cip->nonstd_names[chr_code]) + 1;
+      }
+      uint32_t max_allele_slen = 1;
+      uint32_t max_variant_id_slen = 0;
+      uint32_t max_extra_alt_ct = 0;
+      uint32_t max_filter_slen = 0;
+      PvarCacheRunFlags run_flags = kfPvarCacheRun0;
+      if (IsSet(unsorted_cm_fos, chr_fo_idx)) {
+        run_flags |= kfPvarCacheRunUnsortedCm;
+      }
+      uint32_t last_bp = 0;
+      for (uint32_t variant_uidx = variant_uidx_start; variant_uidx != variant_uidx_end; ++variant_uidx) {
+        const uint32_t cur_bp = variant_bps[variant_uidx];
+        if (cur_bp < last_bp) {
+          run_flags |= kfPvarCacheRunUnsortedBp;
+        }
+        last_bp = cur_bp;
+        uintptr_t allele_idx_offset_base = variant_uidx * S_CAST(uintptr_t, 2);
+        uint32_t allele_ct = 2;
+        if (allele_idx_offsets) {
+          allele_idx_offset_base = allele_idx_offsets[variant_uidx];
+          allele_ct = allele_idx_offsets[variant_uidx + 1] - allele_idx_offset_base;
+          if (allele_ct - 2 > max_extra_alt_ct) {
+            max_extra_alt_ct = allele_ct - 2;
+          }
+        }
+        const char* const* cur_alleles = &(allele_storage[allele_idx_offset_base]);
+        for (uint32_t allele_idx = 0; allele_idx != allele_ct; ++allele_idx) {
+          const char* cur_allele = cur_alleles[allele_idx];
+          if (cur_allele[1]) {
+            const uint32_t allele_slen = strlen(cur_allele);
+            long_allele_blen += allele_slen + 1;
+            if (allele_slen > max_allele_slen) {
+              max_allele_slen = allele_slen;
+            }
+          }
+        }
+        const uint32_t id_slen = strlen(variant_ids[variant_uidx]);
+        id_blen += id_slen + 1;
+        if (id_slen > max_variant_id_slen) {
+          max_variant_id_slen = id_slen;
+        }
+        if (variant_cms && (variant_cms[variant_uidx] != 0.0)) {
+          run_flags |= kfPvarCacheRunNzeroCm;
+        }
+        if (filter_storage && IsSet(filter_npass, variant_uidx)) {
+          const uint32_t filter_slen = strlen(filter_storage[variant_uidx]);
+          filter_blen += filter_slen + 1;
+          if (filter_slen > max_filter_slen) {
+            max_filter_slen = filter_slen;
+          }
+          run_flags |= kfPvarCacheRunNpass;
+        }
+      }
+      cur_run->max_allele_slen = max_allele_slen;
+      cur_run->max_variant_id_slen = max_variant_id_slen;
+      cur_run->max_extra_alt_ct = max_extra_alt_ct;
+      cur_run->max_filter_slen = max_filter_slen;
+      cur_run->flags = S_CAST(uint32_t, run_flags);
+      cur_run->reserved = 0;
+      if (max_allele_slen > max_str_slen) {
+        max_str_slen = max_allele_slen;
+      }
+      if (max_filter_slen > max_str_slen) {
+        max_str_slen = max_filter_slen;
+      }
+    }
+    PvarCacheFlags cache_flags = kfPvarCache0;
+    if (qual_present) {
+      cache_flags |= kfPvarCacheQual;
+    }
+    if (filter_present) {
+      cache_flags |= kfPvarCacheFilter;
+    }
+    if (info_col_present) {
+      cache_flags |= kfPvarCacheInfo;
+    }
+    if (nonref_flags) {
+      cache_flags |= kfPvarCacheNonref;
+    }
+    if (variant_cms) {
+      cache_flags |= kfPvarCacheCm;
+    }
+    if (allele_idx_offsets) {
+      cache_flags |= kfPvarCacheMultiallelic;
+    }
+    if (keyp->full_hash_present) {
+      cache_flags |= kfPvarCacheFullHash;
+    }
+    unsigned char header[kPvarCacheHeaderSize];
+    memcpy_k(header, "\x6c\x1b\x32\x00", 4);
+    memcpy(&(header[4]), &raw_variant_ct, sizeof(int32_t));
+    memcpy(&(header[8]), &run_ct, sizeof(int32_t));
+    {
+      const uint32_t cache_flags_u32 = S_CAST(uint32_t, cache_flags);
+      memcpy(&(header[12]), &cache_flags_u32, sizeof(int32_t));
+    }
+    memcpy(&(header[16]), &info_max_slen, sizeof(int32_t));
+    memcpy(&(header[20]), &keyp->chrset_hash, sizeof(int32_t));
+    PvarFileKeySerialize(&keyp->file, &(header[24]));
+    {
+      const uint64_t allele_idx_end_u64 = allele_idx_end;
+      memcpy(&(header[48]), &allele_idx_end_u64, sizeof(int64_t));
+    }
+    memcpy(&(header[56]), &long_allele_blen, sizeof(int64_t));
+    memcpy(&(header[64]), &id_blen, sizeof(int64_t));
+    memcpy(&(header[72]), &filter_blen, sizeof(int64_t));
+    memcpy(&(header[80]), &chr_names_blen, sizeof(int64_t));
+    memcpy(&(header[88]), &keyp->full_hash, sizeof(int32_t));
+    memset(&(header[92]), 0, 4);
+
+    char* writebuf;
+    if (unlikely(bigstack_alloc_c(kMaxMediumLine + max_str_slen + 1, &writebuf))) {
+      goto PvarCacheWrite_ret_NOMEM;
+    }
+    char* writebuf_flush = &(writebuf[kMaxMediumLine]);
+    char* tmp_fname_end = strcpya(tmp_fname, cache_fname);
+    strcpy_k(tmp_fname_end, ".tmp");
+    if (unlikely(fopen_checked(tmp_fname, FOPEN_WB, &outfile))) {
+      goto PvarCacheWrite_ret_OPEN_FAIL;
+    }
+    if (unlikely(fwrite_checked(header, kPvarCacheHeaderSize, outfile) ||
+                 fwrite_checked(runs, run_ct * sizeof(PvarCacheRun), outfile))) {
+      goto PvarCacheWrite_ret_WRITE_FAIL;
+    }
+    char* write_iter = writebuf;
+    for (uint32_t chr_fo_idx = 0; chr_fo_idx != run_ct; ++chr_fo_idx) {
+      if (runs[chr_fo_idx].chr_code == UINT32_MAX) {
+        write_iter = strcpyax(write_iter, cip->nonstd_names[cip->chr_file_order[chr_fo_idx]], '\0');
+        if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+          goto PvarCacheWrite_ret_WRITE_FAIL;
+        }
+      }
+    }
+    const uintptr_t bitarr_blen = DivUp(raw_variant_ct, CHAR_BIT);
+    if (unlikely(fwrite_flush2(writebuf_flush, outfile, &write_iter) ||
+                 fwrite_checked(variant_include, bitarr_blen, outfile) ||
+                 fwrite_checked(variant_bps, raw_variant_ct * sizeof(int32_t), outfile))) {
+      goto PvarCacheWrite_ret_WRITE_FAIL;
+    }
+    if (allele_idx_offsets) {
+#ifdef __LP64__
+      if (unlikely(fwrite_checked(allele_idx_offsets, (raw_variant_ct + 1) * sizeof(int64_t), outfile))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+#else
+      for (uint32_t variant_uidx = 0; variant_uidx <= raw_variant_ct; ++variant_uidx) {
+        const uint64_t cur_offset = allele_idx_offsets[variant_uidx];
+        write_iter = memcpya(write_iter, &cur_offset, sizeof(int64_t));
+        if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+          goto PvarCacheWrite_ret_WRITE_FAIL;
+        }
+      }
+      if (unlikely(fwrite_flush2(writebuf_flush, outfile, &write_iter))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+#endif
+    }
+    if (qual_present) {
+      if (unlikely(fwrite_checked(qual_present, bitarr_blen, outfile) ||
+                   fwrite_checked(quals, raw_variant_ct * sizeof(float), outfile))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    if (filter_present) {
+      if (unlikely(fwrite_checked(filter_present, bitarr_blen, outfile) ||
+                   fwrite_checked(filter_npass, bitarr_blen, outfile))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    if (nonref_flags) {
+      if (unlikely(fwrite_checked(nonref_flags, bitarr_blen, outfile))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    if (variant_cms) {
+      if (unlikely(fwrite_checked(variant_cms, raw_variant_ct * sizeof(double), outfile))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    for (uintptr_t allele_idx = 0; allele_idx != allele_idx_end; ++allele_idx) {
+      const char* cur_allele = allele_storage[allele_idx];
+      *write_iter++ = cur_allele[1]? '\0' : cur_allele[0];
+      if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    for (uintptr_t allele_idx = 0; allele_idx != allele_idx_end; ++allele_idx) {
+      const char* cur_allele = allele_storage[allele_idx];
+      if (cur_allele[1]) {
+        write_iter = strcpyax(write_iter, cur_allele, '\0');
+        if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+          goto PvarCacheWrite_ret_WRITE_FAIL;
+        }
+      }
+    }
+    for (uint32_t variant_uidx = 0; variant_uidx != raw_variant_ct; ++variant_uidx) {
+      write_iter = strcpyax(write_iter, variant_ids[variant_uidx], '\0');
+      if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+        goto PvarCacheWrite_ret_WRITE_FAIL;
+      }
+    }
+    if (filter_storage) {
+      for (uint32_t variant_uidx = 0; variant_uidx != raw_variant_ct; ++variant_uidx) {
+        if (IsSet(filter_npass, variant_uidx)) {
+          write_iter = strcpyax(write_iter, filter_storage[variant_uidx], '\0');
+          if (unlikely(fwrite_ck(writebuf_flush, outfile, &write_iter))) {
+            goto PvarCacheWrite_ret_WRITE_FAIL;
+          }
+        }
+      }
+    }
+    if (unlikely(fclose_flush_null(writebuf_flush, write_iter, &outfile))) {
+      goto PvarCacheWrite_ret_WRITE_FAIL;
+    }
+    if (unlikely(rename(tmp_fname, cache_fname))) {
+      logerrprintfww("Error: Failed to rename %s to %s.\n", tmp_fname, cache_fname);
+      goto PvarCacheWrite_ret_WRITE_FAIL;
+    }
+    logprintfww("--pvar-cache: %s written.\n", cache_fname);
+  }
+  while (0) {
+  PvarCacheWrite_ret_NOMEM:
+    reterr = kPglRetNomem;
+    break;
+  PvarCacheWrite_ret_OPEN_FAIL:
+    reterr = kPglRetOpenFail;
+    break;
+  PvarCacheWrite_ret_WRITE_FAIL:
+    reterr = kPglRetWriteFail;
+    break;
+  }
+  fclose_cond(outfile);
+  BigstackReset(bigstack_mark);
+  return reterr;
+}
+
 static_assert((!(kMaxIdSlen % kCacheline)), "LoadPvar() must be updated.");
-PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
+PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, int32_t from_bp, int32_t to_bp, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr) {
   // chr_info, max_variant_id_slen, and info_reload_slen are in/out; just
   // outparameters after them.  (Due to its large size in some VCFs, INFO is
   // not kept in memory for now.  This has a speed penalty, of course; maybe
@@ -832,6 +1932,8 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
   uint32_t max_extra_alt_ct = 0;
   uint32_t max_allele_slen = 1;
   PglErr reterr = kPglRetSuccess;
+  FILE* vidx_ff = nullptr;
+  FILE* pcache_ff = nullptr;
   TextStream pvar_txs;
   PreinitTextStream(&pvar_txs);
   {
@@ -939,6 +2041,24 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       BigstackBaseSet(xheader_end);
     }
     FinalizeChrset(misc_flags, cip);
+
+    // The .pcache sidecar only covers loads which don't filter on variant
+    // contents.  When --pvar-cache is about to (re)write it, every stored
+    // column is parsed regardless of whether this run needs it.
+    char pcache_fname[kPglFnamesize + kMaxOutfnameExtBlen];
+    PvarCacheKey pcache_key;
+    PreinitPvarCacheKey(&pcache_key);
+    PvarCache pcache;
+    uint32_t pvar_cache_write = 0;
+    if ((!varid_template_str) && (!require_info_flattened) && (!require_no_info_flattened) && (!extract_if_info_exprp->pheno_name) && (!exclude_if_info_exprp->pheno_name) && (var_min_qual == -1) && (!(misc_flags & (kfMiscExcludePvarFilterFail | kfMiscMergePar | kfMiscMergeX))) && (!splitpar_bound2) && (!snps_only) && (!filter_min_allele_ct) && (filter_max_allele_ct > kPglMaxAltAlleleCt) && (!PvarCacheKeyInit(pvarname, cip, (misc_flags / kfMiscPvarCacheFullHash) & 1, &pcache_key))) {
+      char* fname_end = strcpya(pcache_fname, pvarname);
+      snprintf(fname_end, kMaxOutfnameExtBlen, ".pcache");
+      reterr = PvarCacheOpen(pcache_fname, pvarname, &pcache_key, &pcache_ff, &pcache);
+      if (unlikely(reterr)) {
+        goto LoadPvar_ret_1;
+      }
+      pvar_cache_write = (!pcache_ff) && (misc_flags & kfMiscPvarCache);
+    }
     const char** allele_storage = R_CAST(const char**, g_bigstack_base);
     const char** allele_storage_iter = allele_storage;
 
@@ -951,6 +2071,8 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     uint32_t load_filter_col = 0;
     uint32_t info_col_present = 0;
     uint32_t cm_col_present = 0;
+    const uint32_t qual_wanted = (pvar_psam_flags & (kfPvarColMaybequal | kfPvarColQual)) || qualfilter_needed;
+    const uint32_t filter_wanted = (pvar_psam_flags & (kfPvarColMaybefilter | kfPvarColFilter)) || qualfilter_needed;
     if (line_start[0] == '#') {
       *info_flags_ptr = S_CAST(InfoFlags, (info_pr_present * kfInfoPrFlagPresent) | (info_pr_nonflag_present * kfInfoPrNonflagPresent) | (info_nonpr_present * kfInfoNonprPresent));
       // parse header
@@ -1004,7 +2126,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
             continue;
           }
         } else if (strequal_k(linebuf_iter, "QUAL", token_slen)) {
-          load_qual_col = 2 * ((pvar_psam_flags & (kfPvarColMaybequal | kfPvarColQual)) || qualfilter_needed) + (var_min_qual != -1);
+          load_qual_col = 2 * (qual_wanted || pvar_cache_write) + (var_min_qual != -1);
           if (!load_qual_col) {
             continue;
           }
@@ -1014,7 +2136,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           info_col_present = 1;
         } else if (token_slen == 6) {
           if (memequal_k(linebuf_iter, "FILTER", 6)) {
-            load_filter_col = 2 * ((pvar_psam_flags & (kfPvarColMaybefilter | kfPvarColFilter)) || qualfilter_needed) + ((misc_flags / kfMiscExcludePvarFilterFail) & 1);
+            load_filter_col = 2 * (filter_wanted || pvar_cache_write) + ((misc_flags / kfMiscExcludePvarFilterFail) & 1);
             if (!load_filter_col) {
               continue;
             }
@@ -1117,6 +2239,15 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
 
     uintptr_t* loaded_chr_mask = R_CAST(uintptr_t*, tmp_alloc_base);
     unsigned char* tmp_alloc_end = bigstack_end_mark;
+    // Decreasing-CM flags for the .pcache, indexed by chromosome file order.
+    // This is kept at the top of the end-allocated strings, so it's still
+    // intact when the return arrays are complete.
+    uintptr_t* pcache_unsorted_cm_fos = nullptr;
+    if (pvar_cache_write) {
+      tmp_alloc_end -= RoundUpPow2(kChrMaskWords * sizeof(intptr_t), kCacheline);
+      pcache_unsorted_cm_fos = R_CAST(uintptr_t*, tmp_alloc_end);
+      ZeroWArr(kChrMaskWords, pcache_unsorted_cm_fos);
+    }
     // guaranteed to succeed since max_line_blen > 128k, etc.
     /*
     if ((uintptr_t)(tmp_alloc_end - tmp_alloc_base) < RoundUpPow2(kChrMaskWords * sizeof(intptr_t), kCacheline)) {
@@ -1160,6 +2291,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
         goto LoadPvar_ret_1;
       }
     }
+    const uint32_t info_col_in_header = info_col_present;
     if (!info_col_present) {
       if (unlikely(require_info_flattened)) {
         logerrputs("Error: --require-info used on a variant file with no INFO column.\n");
@@ -1174,6 +2306,37 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     } else if ((!info_pr_present) && (!info_reload_slen) && (!info_existp) && (!info_nonexistp) && (!info_keep.prekey) && (!info_remove.prekey)) {
       info_col_present = 0;
     }
+    const uint32_t info_slen_wanted = info_col_present;
+    if (pvar_cache_write) {
+      // .pcache stores the maximum INFO length
+      info_col_present = info_col_in_header;
+    }
+
+    if (pcache_ff) {
+      if (unlikely(CleanupTextStream2(pvarname, &pvar_txs, &reterr))) {
+        goto LoadPvar_ret_1;
+      }
+      reterr = PvarCacheLoad(pcache_fname, &pcache, load_qual_col > 1, load_filter_col > 1, info_pr_present, (misc_flags / kfMiscAllowExtraChrs) & 1, pcache_ff, cip, max_variant_id_slen_ptr, vpos_sortstatus_ptr, variant_include_ptr, variant_bps_ptr, variant_ids_ptr, allele_idx_offsets_ptr, allele_storage_ptr, qual_present_ptr, quals_ptr, filter_present_ptr, filter_npass_ptr, filter_storage_ptr, nonref_flags_ptr, variant_cms_ptr, raw_variant_ct_ptr, variant_ct_ptr, max_allele_ct_ptr, max_allele_slen_ptr, max_filter_slen_ptr);
+      if (unlikely(reterr)) {
+        goto LoadPvar_ret_1;
+      }
+      if (info_slen_wanted && (pcache.info_max_slen > info_reload_slen)) {
+        info_reload_slen = pcache.info_max_slen;
+      }
+      if (!(info_nonpr_present || info_pr_nonflag_present)) {
+        info_reload_slen = 0;
+      }
+      if (info_reload_slen) {
+        if (unlikely(ForceNonFifo(pvarname))) {
+          logerrprintfww(kErrprintfRewind, pvarname);
+          reterr = kPglRetRewindFail;
+          goto LoadPvar_ret_1;
+        }
+      }
+      *info_reload_slen_ptr = info_reload_slen;
+      logprintfww("Variant records loaded from %s.\n", pcache_fname);
+      goto LoadPvar_ret_1;
+    }
 
     uint32_t fexcept_ct = 0;
     uintptr_t max_fexcept_blen = 2;
@@ -1220,6 +2383,15 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       }
     }
 
+    PvarVidx pvar_vidx;
+    PreinitPvarVidx(&pvar_vidx);
+    if ((!splitpar_bound2) && (!(misc_flags & (kfMiscMergePar | kfMiscMergeX))) && TextIsSeekable(&pvar_txs)) {
+      reterr = PvarVidxInit(pvarname, tmp_alloc_end, &tmp_alloc_base, &vidx_ff, &pvar_vidx);
+      if (unlikely(reterr)) {
+        goto LoadPvar_ret_1;
+      }
+    }
+
     // prevent later return-array allocations from overlapping with temporary
     // storage
     g_bigstack_end = tmp_alloc_base;
@@ -1308,10 +2480,90 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     } else {
       line_iter = line_start;
     }
-    for (; TextGetUnsafe2(&pvar_txs, &line_iter); ++line_iter, ++line_idx) {
-      if (unlikely(line_iter[0] == '#')) {
-        snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of %s starts with a '#'. (This is only permitted before the first nonheader line, and if a #CHROM header line is present it must denote the end of the header block.)\n", line_idx, pvarname);
-        goto LoadPvar_ret_MALFORMED_INPUT_WW;
+    // .vidx frame-skipping state.  Skipped variants get the same placeholder
+    // entries as other excluded variants, so allele_idx_offsets[] etc. still
+    // line up with the .pgen.
+    uint32_t vidx_next_frame_vidx = vidx_ff? 0 : UINT32_MAX;
+    uint32_t vidx_frame_idx = 0;
+    uint32_t vidx_frame_vidx_start = 0;
+    uint32_t vidx_skip_end = 0;
+    uint32_t vidx_seek_needed = 0;
+    uint32_t vidx_skipped_frame_ct = 0;
+    uintptr_t vidx_multiallelic_idx = 0;
+    const uint32_t* vidx_multiallelic_iter = nullptr;
+    const uint32_t* vidx_multiallelic_end = nullptr;
+    for (; ; ++line_iter, ++line_idx) {
+      if (raw_variant_ct == vidx_next_frame_vidx) {
+        const PvarVidxFrame* cur_frame = &(pvar_vidx.frames[vidx_frame_idx]);
+        if (vidx_frame_idx == pvar_vidx.frame_ct) {
+          vidx_next_frame_vidx = UINT32_MAX;
+        } else {
+          vidx_next_frame_vidx = cur_frame[1].variant_idx_start;
+          vidx_frame_vidx_start = raw_variant_ct;
+          // A frame can be skipped when every variant in it would be excluded
+          // anyway, and skipping doesn't hide an error or INFO/PR data.
+          uint32_t frame_chr_code = UINT32_MAX;
+          uint32_t skip_frame = 0;
+          const uint32_t frame_flags = cur_frame->flags;
+          if ((!is_split_chr) && (!(frame_flags & kfPvarVidxFrameNoSkip)) && ((!info_pr_present) || (!(frame_flags & kfPvarVidxFramePr)))) {
+            const char* frame_chr_name = pvar_vidx.chr_names[cur_frame->chr_name_idx];
+            frame_chr_code = GetChrCode(frame_chr_name, cip, strlen(frame_chr_name));
+            if ((!IsI32Neg(frame_chr_code)) && ((frame_chr_code == prev_chr_code) || (!IsSet(loaded_chr_mask, frame_chr_code)))) {
+              if ((!IsSet(chr_mask, frame_chr_code)) || (cur_frame->bp_min > cur_frame->bp_max)) {
+                skip_frame = 1;
+              } else if (pvar_vidx.bp_sorted) {
+                skip_frame = ((from_bp != -1) && (cur_frame->bp_max < S_CAST(uint32_t, from_bp))) || ((to_bp != -1) && (cur_frame->bp_min > S_CAST(uint32_t, to_bp)));
+              }
+            }
+          }
+          if (skip_frame) {
+            if (frame_chr_code != prev_chr_code) {
+              // same bookkeeping as the non-split-chromosome path below
+              prev_chr_code = frame_chr_code;
+              cip->chr_file_order[++chrs_encountered_m1] = frame_chr_code;
+              cip->chr_fo_vidx_start[chrs_encountered_m1] = raw_variant_ct;
+              cip->chr_idx_to_foidx[frame_chr_code] = chrs_encountered_m1;
+              last_cm = -DBL_MAX;
+              last_bp = 0;
+              SetBit(frame_chr_code, loaded_chr_mask);
+              if (chr_output_name_buf) {
+                VaridTemplatesSetChr(cip, frame_chr_code, chr_output_name_buf, varid_templatep, varid_multi_templatep, varid_multi_nonsnp_templatep, &max_chr_slen);
+              }
+            }
+            const uint32_t multiallelic_ct = cur_frame->multiallelic_ct;
+            if (multiallelic_ct) {
+              if (unlikely(fseeko(vidx_ff, pvar_vidx.multiallelic_fpos + vidx_multiallelic_idx * sizeof(int32_t), SEEK_SET) ||
+                           (!fread_unlocked(pvar_vidx.multiallelic_buf, multiallelic_ct * sizeof(int32_t), 1, vidx_ff)))) {
+                goto LoadPvar_ret_VIDX_READ_FAIL;
+              }
+            }
+            vidx_multiallelic_iter = pvar_vidx.multiallelic_buf;
+            vidx_multiallelic_end = &(pvar_vidx.multiallelic_buf[multiallelic_ct]);
+            vidx_skip_end = vidx_next_frame_vidx;
+            vidx_seek_needed = 1;
+            ++vidx_skipped_frame_ct;
+          }
+          vidx_multiallelic_idx += cur_frame->multiallelic_ct;
+          ++vidx_frame_idx;
+        }
+        if (vidx_seek_needed && (raw_variant_ct >= vidx_skip_end)) {
+          // at the sentinel, this seeks to EOF
+          reterr = TextSeek(cur_frame->fpos, &pvar_txs);
+          if (unlikely(reterr)) {
+            goto LoadPvar_ret_TSTREAM_FAIL;
+          }
+          line_iter = TextLineEnd(&pvar_txs);
+          vidx_seek_needed = 0;
+        }
+      }
+      if (raw_variant_ct >= vidx_skip_end) {
+        if (!TextGetUnsafe2(&pvar_txs, &line_iter)) {
+          break;
+        }
+        if (unlikely(line_iter[0] == '#')) {
+          snprintf(g_logbuf, kLogbufSize, "Error: Line %" PRIuPTR " of %s starts with a '#'. (This is only permitted before the first nonheader line, and if a #CHROM header line is present it must denote the end of the header block.)\n", line_idx, pvarname);
+          goto LoadPvar_ret_MALFORMED_INPUT_WW;
+        }
       }
 #ifdef __LP64__
       // maximum prime < 2^32 is 4294967291; quadratic hashing guarantee
@@ -1370,6 +2622,24 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
           tmp_alloc_base = R_CAST(unsigned char*, &(cur_chr_idxs[kLoadPvarBlockSize]));
         }
       }
+      if (raw_variant_ct < vidx_skip_end) {
+        cur_allele_idxs[variant_idx_lowbits] = allele_storage_iter - allele_storage;
+        uint32_t extra_alt_ct = 0;
+        if ((vidx_multiallelic_iter != vidx_multiallelic_end) && (((*vidx_multiallelic_iter) >> 16) == raw_variant_ct - vidx_frame_vidx_start)) {
+          extra_alt_ct = (*vidx_multiallelic_iter++) & 65535;
+        }
+        ++exclude_ct;
+        ClearBit(variant_idx_lowbits, cur_include);
+        cur_bps[variant_idx_lowbits] = last_bp;
+        if (PtrCheck(allele_storage_limit, allele_storage_iter, (2 + extra_alt_ct) * sizeof(intptr_t))) {
+          goto LoadPvar_ret_NOMEM;
+        }
+        for (uint32_t uii = 0; uii != extra_alt_ct + 2; ++uii) {
+          *allele_storage_iter++ = missing_allele_str;
+        }
+        ++raw_variant_ct;
+        continue;
+      }
       char* linebuf_iter = CurTokenEnd(line_iter);
       // #CHROM
       if (unlikely(*linebuf_iter == '\n')) {
@@ -1424,22 +2694,7 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
 
         SetBit(cur_chr_code, loaded_chr_mask);
         if (chr_output_name_buf) {
-          char* chr_name_end = chrtoa(cip, cur_chr_code, chr_output_name_buf);
-          const uint32_t chr_slen = chr_name_end - chr_output_name_buf;
-          if (chr_slen > max_chr_slen) {
-            max_chr_slen = chr_slen;
-          }
-          const int32_t chr_slen_delta = chr_slen - varid_templatep->chr_slen;
-          varid_templatep->chr_slen = chr_slen;
-          varid_templatep->base_len += chr_slen_delta;
-          if (varid_multi_templatep) {
-            varid_multi_templatep->chr_slen = chr_slen;
-            varid_multi_templatep->base_len += chr_slen_delta;
-          }
-          if (varid_multi_nonsnp_templatep) {
-            varid_multi_nonsnp_templatep->chr_slen = chr_slen;
-            varid_multi_nonsnp_templatep->base_len += chr_slen_delta;
-          }
+          VaridTemplatesSetChr(cip, cur_chr_code, chr_output_name_buf, varid_templatep, varid_multi_templatep, varid_multi_nonsnp_templatep, &max_chr_slen);
         }
       }
       *linebuf_iter = '\t';
@@ -1758,6 +3013,9 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
             }
             if (cur_cm < last_cm) {
               vpos_sortstatus |= kfUnsortedVarCm;
+              if (pcache_unsorted_cm_fos) {
+                SetBit(chrs_encountered_m1, pcache_unsorted_cm_fos);
+              }
             } else {
               last_cm = cur_cm;
             }
@@ -1818,6 +3076,10 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
       goto LoadPvar_ret_TSTREAM_FAIL;
     }
     reterr = kPglRetSuccess;
+    if (unlikely(vidx_skipped_frame_ct && (raw_variant_ct != pvar_vidx.variant_ct))) {
+      snprintf(g_logbuf, kLogbufSize, "Error: %s.vidx does not match %s. (Delete the index, or regenerate it with --make-just-pvar zs vidx.)\n", pvarname, pvarname);
+      goto LoadPvar_ret_MALFORMED_INPUT_WW;
+    }
     if (unlikely(max_variant_id_slen > kMaxIdSlen)) {
       logerrputs("Error: Variant names are limited to " MAX_ID_SLEN_STR " characters.\n");
       goto LoadPvar_ret_MALFORMED_INPUT;
@@ -2091,6 +3353,33 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     *variant_ct_ptr = raw_variant_ct - exclude_ct;
     *vpos_sortstatus_ptr = vpos_sortstatus;
     *allele_storage_ptr = allele_storage;
+    if (pvar_cache_write) {
+      if (exclude_ct || is_split_chr || (!raw_variant_ct)) {
+        pvar_cache_write = 0;
+      } else {
+        reterr = PvarCacheWrite(pcache_fname, &pcache_key, cip, variant_include, variant_bps, variant_ids, allele_idx_offsets, allele_storage, qual_present, quals, filter_present, filter_npass, filter_storage, nonref_flags, *variant_cms_ptr, pcache_unsorted_cm_fos, raw_variant_ct, allele_idx_end, info_col_present, info_reload_slen);
+        if (unlikely(reterr)) {
+          goto LoadPvar_ret_1;
+        }
+      }
+      // undo the forced column loads
+      if (!qual_wanted) {
+        *qual_present_ptr = nullptr;
+        *quals_ptr = nullptr;
+      }
+      if (!filter_wanted) {
+        *filter_present_ptr = nullptr;
+        *filter_npass_ptr = nullptr;
+        *filter_storage_ptr = nullptr;
+        *max_filter_slen_ptr = 0;
+      }
+      if (!info_slen_wanted) {
+        info_reload_slen = 0;
+      }
+    }
+    if ((misc_flags & kfMiscPvarCache) && (!pvar_cache_write)) {
+      logerrputs("Warning: --pvar-cache only writes a .pcache when nothing is excluded while\nloading the .pvar, and no variant-content filters (e.g. --snps-only) are active.\n");
+    }
     // if only INFO/PR flag present, no need to reload
     if (!(info_nonpr_present || info_pr_nonflag_present)) {
       info_reload_slen = 0;
@@ -2113,6 +3402,13 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
   LoadPvar_ret_TSTREAM_FAIL:
     TextStreamErrPrint(pvarname, &pvar_txs);
     break;
+  LoadPvar_ret_VIDX_READ_FAIL:
+    if (feof_unlocked(vidx_ff)) {
+      errno = 0;
+    }
+    logerrprintfww("Error: %s.vidx read failure: %s.\n", pvarname, rstrerror(errno));
+    reterr = kPglRetReadFail;
+    break;
   LoadPvar_ret_EMPTY_ALLELE_CODE:
     snprintf(g_logbuf, kLogbufSize, "Error: Empty allele code on line %" PRIuPTR " of %s.\n", line_idx, pvarname);
   LoadPvar_ret_MALFORMED_INPUT_WW:
@@ -2136,6 +3432,8 @@ PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattene
     break;
   }
  LoadPvar_ret_1:
+  fclose_cond(vidx_ff);
+  fclose_cond(pcache_ff);
   CleanupTextStream2(pvarname, &pvar_txs, &reterr);
   if (reterr) {
     BigstackDoubleReset(bigstack_mark, bigstack_end_mark);
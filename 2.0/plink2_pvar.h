@@ -89,9 +89,84 @@ uint32_t PrInInfo(uint32_t info_slen, char* info_token);
 
 char* InfoPrStart(uint32_t info_slen, char* info_token);
 
+// Identifies one version of a .pvar[.zst], for the .vidx and .pcache
+// stale-index checks: byte size, modification time, and hashes of the first
+// and last kPvarFileKeyHashSpan bytes.  Serialized as 24 bytes (little-endian
+// size, mtime, head hash, tail hash).
+CONSTI32(kPvarFileKeyHashSpan, 65536);
+CONSTI32(kPvarFileKeyBlen, 24);
+
+typedef struct PvarFileKeyStruct {
+  uint64_t fsize;
+  int64_t mtime;
+  uint32_t head_hash;
+  uint32_t tail_hash;
+} PvarFileKey;
+
+void PreinitPvarFileKey(PvarFileKey* keyp);
+
+// Returns 1 if the file can't be keyed (e.g. it's a named pipe).  Clobbers
+// g_textbuf.
+BoolErr PvarFileKeyInit(const char* fname, PvarFileKey* keyp);
+
+void PvarFileKeySerialize(const PvarFileKey* keyp, unsigned char* dst);
+
+uint32_t PvarFileKeyMatch(const unsigned char* serialized, const PvarFileKey* keyp);
+
+// .pvar.zst.vidx frame index (written by --make-pgen/--make-just-pvar 'vidx').
+// The companion .pvar.zst is written as a header frame, followed by frames of
+// at most kPvarVidxFrameVariantCt variants which never span a chromosome
+// boundary; each frame is independently decodable, so LoadPvar() can seek
+// past frames which --chr/--not-chr/--from-bp/--to-bp would exclude.
+// Layout (little-endian):
+//   bytes 0-2: magic {0x6c, 0x1b, 0x31}
+//   byte 3: format version (currently 1; version 0 indexes lacked the full
+//           file key and are ignored)
+//   bytes 4-7: variant_ct
+//   bytes 8-11: frame_ct
+//   bytes 12-15: chr_name_ct
+//   bytes 16-19: flags (bit 0 set iff bp coordinates are nondecreasing within
+//                each chromosome)
+//   bytes 20-23: multiallelic_ct
+//   bytes 24-47: PvarFileKey of the .pvar.zst (stale-index check)
+//   then multiallelic_ct uint32s, one per multiallelic variant in variant
+//     order: (variant index within frame << 16) | extra_alt_ct
+//   then frame_ct PvarVidxFrame records
+//   then chr_name_ct null-terminated chromosome names, in order of first
+//     appearance; PvarVidxFrame.chr_name_idx refers to this list
+CONSTI32(kPvarVidxFrameVariantCt, 65536);
+CONSTI32(kPvarVidxHeaderSize, 48);
+
+FLAGSET_DEF_START()
+  kfPvarVidxFrame0,
+  // at least one variant has INFO/PR set
+  kfPvarVidxFramePr = (1 << 0),
+  // placeholder entries can't be reconstructed from the index (e.g. extra ALT
+  // count too large for the packed representation), so the frame must always
+  // be parsed
+  kfPvarVidxFrameNoSkip = (1 << 1)
+FLAGSET_DEF_END(PvarVidxFrameFlags);
+
+typedef struct PvarVidxFrameStruct {
+  uint64_t fpos;
+  uint32_t variant_idx_start;
+  uint32_t chr_name_idx;
+  // bp_min > bp_max if no variant in frame has a nonnegative coordinate
+  uint32_t bp_min;
+  uint32_t bp_max;
+  uint32_t multiallelic_ct;
+  uint32_t flags;
+} PvarVidxFrame;
+
+static_assert(sizeof(PvarVidxFrame) == 32, "PvarVidxFrame must be 32 bytes.");
+
 // cip, max_variant_id_slen, and info_reload are in/out parameters.
-// Chromosome filtering is performed if cip requests it.
-PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr);
+// Chromosome filtering is performed if cip requests it, and frames of a
+// seekable .pvar.zst are skipped when a current .vidx index permits.
+// If <pvarname>.pcache exists and matches the file, the variant lines aren't
+// parsed at all; kfMiscPvarCache causes a missing or stale .pcache to be
+// written.
+PglErr LoadPvar(const char* pvarname, const char* var_filter_exceptions_flattened, const char* varid_template_str, const char* varid_multi_template_str, const char* varid_multi_nonsnp_template_str, const char* missing_varid_match, const char* require_info_flattened, const char* require_no_info_flattened, const CmpExpr* extract_if_info_exprp, const CmpExpr* exclude_if_info_exprp, MiscFlags misc_flags, PvarPsamFlags pvar_psam_flags, uint32_t xheader_needed, uint32_t qualfilter_needed, float var_min_qual, uint32_t splitpar_bound1, uint32_t splitpar_bound2, int32_t from_bp, int32_t to_bp, uint32_t new_variant_id_max_allele_slen, uint32_t snps_only, uint32_t split_chr_ok, uint32_t filter_min_allele_ct, uint32_t filter_max_allele_ct, uint32_t max_thread_ct, ChrInfo* cip, uint32_t* max_variant_id_slen_ptr, uint32_t* info_reload_slen_ptr, UnsortedVar* vpos_sortstatus_ptr, char** xheader_ptr, uintptr_t** variant_include_ptr, uint32_t** variant_bps_ptr, char*** variant_ids_ptr, uintptr_t** allele_idx_offsets_ptr, const char*** allele_storage_ptr, uintptr_t** qual_present_ptr, float** quals_ptr, uintptr_t** filter_present_ptr, uintptr_t** filter_npass_ptr, char*** filter_storage_ptr, uintptr_t** nonref_flags_ptr, double** variant_cms_ptr, ChrIdx** chr_idxs_ptr, uint32_t* raw_variant_ct_ptr, uint32_t* variant_ct_ptr, uint32_t* max_allele_ct_ptr, uint32_t* max_allele_slen_ptr, uintptr_t* xheader_blen_ptr, InfoFlags* info_flags_ptr, uint32_t* max_filter_slen_ptr);
 
 PglErr LoadAlleleIdxOffsetsFromPvar(const char* pvarname, const char* file_descrip, uint32_t max_thread_ct, uint32_t* raw_variant_ctp, uint32_t* max_allele_slenp, uint32_t* max_observed_line_blenp, uintptr_t** allele_idx_offsets_ptr, uint32_t* max_allele_ctp);
 
@@ -21,13 +21,6 @@
 namespace plink2 {
 #endif
 
-typedef struct MakeSetRangeStruct {
-  NONCOPYABLE(MakeSetRangeStruct);
-  struct MakeSetRangeStruct* next;
-  uint32_t uidx_start;
-  uint32_t uidx_end;
-} MakeSetRange;
-
 static_assert(kMaxChrCodeDigits == 5, "LoadIntervalBed() must be updated.");
 PglErr LoadIntervalBed(const ChrInfo* cip, const uint32_t* variant_bps, const char* sorted_subset_ids, const char* file_descrip, uint32_t zero_based, uint32_t track_set_names, uint32_t border_extend, uint32_t fail_on_no_sets, uint32_t c_prefix, uintptr_t subset_ct, uintptr_t max_subset_id_blen, TextStream* txsp, uintptr_t* set_ct_ptr, char** set_names_ptr, uintptr_t* max_set_id_blen_ptr, uint64_t** range_sort_buf_ptr, MakeSetRange*** make_set_range_arr_ptr) {
   // In plink 1.9, this was named load_range_list() and called directly by
@@ -47,7 +40,7 @@ PglErr LoadIntervalBed(const ChrInfo* cip, const uint32_t* variant_bps, const ch
     // if we need to track set names, put together a sorted list
     if (track_set_names) {
       uintptr_t line_idx = 1;
-      for (char* line_iter = TextLineEnd(txsp); TextGetUnsafe(txsp, &line_iter); ++line_idx) {
+      for (char* line_iter = TextLineEnd(txsp); TextGetUnsafe2(txsp, &line_iter); ++line_idx) {
         char* line_start = line_iter;
         char* first_token_end = CurTokenEnd(line_start);
         char* cur_set_id = NextTokenMult(first_token_end, 3);
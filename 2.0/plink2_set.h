@@ -24,6 +24,20 @@
 namespace plink2 {
 #endif
 
+typedef struct MakeSetRangeStruct {
+  NONCOPYABLE(MakeSetRangeStruct);
+  struct MakeSetRangeStruct* next;
+  uint32_t uidx_start;
+  uint32_t uidx_end;
+} MakeSetRange;
+
+// Parses a UCSC interval-BED file.  When track_set_names is set, column 4 is
+// the set ID; *set_names_ptr is then a natural-sorted strbox of the set IDs
+// (allocated at the bottom of bigstack), and (*make_set_range_arr_ptr)[i] is
+// the linked list of [uidx_start, uidx_end) variant ranges for set i
+// (allocated at the top).  Assumes caller will reset g_bigstack_end later.
+PglErr LoadIntervalBed(const ChrInfo* cip, const uint32_t* variant_bps, const char* sorted_subset_ids, const char* file_descrip, uint32_t zero_based, uint32_t track_set_names, uint32_t border_extend, uint32_t fail_on_no_sets, uint32_t c_prefix, uintptr_t subset_ct, uintptr_t max_subset_id_blen, TextStream* txsp, uintptr_t* set_ct_ptr, char** set_names_ptr, uintptr_t* max_set_id_blen_ptr, uint64_t** range_sort_buf_ptr, MakeSetRange*** make_set_range_arr_ptr);
+
 PglErr ExtractExcludeRange(const char* fnames, const ChrInfo* cip, const uint32_t* variant_bps, uint32_t raw_variant_ct, VfilterType vft, uint32_t zero_based, uint32_t bed_border_bp, uint32_t max_thread_ct, uintptr_t* variant_include, uint32_t* variant_ct_ptr);
 
 #ifdef __cplusplus